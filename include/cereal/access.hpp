@@ -99,6 +99,7 @@ namespace cereal
   // forward decl for construct
   //! @cond PRIVATE_NEVERDEFINED
   namespace memory_detail{ template <class Ar, class T> struct LoadAndConstructLoadWrapper; }
+  namespace detail{ template <class T, class Ar> struct LoadAndConstructValue; }
   //! @endcond
 
   //! Used to construct types with no default constructor
@@ -192,6 +193,7 @@ namespace cereal
 
     private:
       template <class A, class B> friend struct ::cereal::memory_detail::LoadAndConstructLoadWrapper;
+      template <class A, class B> friend struct ::cereal::detail::LoadAndConstructValue;
 
       construct( T * p ) : itsPtr( p ), itsValid( false ) {}
       construct( construct const & ) = delete;
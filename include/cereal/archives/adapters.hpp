@@ -31,10 +31,385 @@
 #define CEREAL_ARCHIVES_ADAPTERS_HPP_
 
 #include <cereal/details/helpers.hpp>
+#include <cereal/details/util.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <typeindex>
 #include <utility>
+#include <vector>
 
 namespace cereal
 {
+  namespace detail
+  {
+    template <class Stream> class ProfileRecorder;
+  }
+
+  // ######################################################################
+  //! Bytes and time attributed to the values serialized through ProfilingAdapter
+  /*! Values are attributed to the path of names that leads to them, such as
+      root.orders[].legs[].price, and to their type.  A name-value pair adds its
+      name to the path.  An unnamed value inside another value, such as an element
+      of a container, adds [] to the path of the value around it, so all elements
+      of a container share one path.  An unnamed value at the top level is named
+      after its type.
+
+      Each path and type records how many values had it, and the bytes and time
+      spent serializing them, including the values inside them.  A type that
+      contains itself counts the inner values twice.  One profile can collect
+      from many archives, aggregating over all of them.
+
+      @ingroup Utility */
+  class Profile
+  {
+    public:
+      //! What was attributed to a path or a type
+      struct Entry
+      {
+        std::uint64_t count = 0; //!< The number of values
+        std::uint64_t bytes = 0; //!< Bytes written or read while serializing them
+        double seconds = 0;      //!< Time spent serializing them
+
+        void add( Entry const & other )
+        {
+          count += other.count;
+          bytes += other.bytes;
+          seconds += other.seconds;
+        }
+      };
+
+      //! One name in a path, with what was attributed to it and the names that follow it
+      struct Node
+      {
+        std::string name;                           //!< The name, or [] for unnamed values
+        Entry entry;                                //!< Attributed to the path ending here
+        std::vector<std::unique_ptr<Node>> children; //!< In the order they were first seen
+
+        //! Gets the child with a name, creating it if needed
+        /*! A node rarely has more than a few dozen children, so they are searched linearly */
+        Node & child( char const * childName )
+        {
+          for( auto & c : children )
+            if( c->name == childName )
+              return *c;
+
+          children.emplace_back( new Node() );
+          children.back()->name = childName;
+          return *children.back();
+        }
+
+        //! The entry of this node minus those of its children
+        Entry self() const
+        {
+          Entry e = entry;
+          for( auto const & c : children )
+          {
+            e.bytes -= std::min( e.bytes, c->entry.bytes );
+            e.seconds = std::max( 0.0, e.seconds - c->entry.seconds );
+          }
+          return e;
+        }
+      };
+
+      //! The metric written by writeFoldedStacks
+      enum class Metric { bytes, microseconds };
+
+      //! The root of all paths, which has no name of its own
+      Node const & root() const { return itsRoot; }
+
+      //! What was attributed to each type
+      std::map<std::type_index, Entry> const & types() const { return itsTypes; }
+
+      //! Forgets everything attributed so far
+      void clear()
+      {
+        itsRoot.children.clear();
+        itsTypes.clear();
+      }
+
+      //! Writes a table of every path, then of every type from the most bytes to the fewest
+      void report( std::ostream & os ) const
+      {
+        char line[1024];
+        std::snprintf( line, sizeof(line), "%-60s %12s %14s %14s %12s %12s\n",
+                       "path", "count", "bytes", "self bytes", "ms", "self ms" );
+        os << line;
+        for( auto const & c : itsRoot.children )
+          reportNode( os, *c, c->name );
+
+        std::vector<std::pair<std::string, Entry>> types;
+        for( auto const & t : itsTypes )
+          types.emplace_back( util::demangle( t.first.name() ), t.second );
+        std::sort( types.begin(), types.end(), []( std::pair<std::string, Entry> const & a, std::pair<std::string, Entry> const & b )
+                   { return a.second.bytes != b.second.bytes ? a.second.bytes > b.second.bytes : a.second.seconds > b.second.seconds; } );
+
+        std::snprintf( line, sizeof(line), "\n%-60s %12s %14s %12s\n", "type", "count", "bytes", "ms" );
+        os << line;
+        for( auto const & t : types )
+        {
+          std::snprintf( line, sizeof(line), "%-60s %12llu %14llu %12.3f\n", t.first.c_str(),
+                         static_cast<unsigned long long>( t.second.count ), static_cast<unsigned long long>( t.second.bytes ),
+                         t.second.seconds * 1e3 );
+          os << line;
+        }
+      }
+
+      //! Writes the paths as folded stacks, one line per path with its own bytes or microseconds
+      /*! This is the input format of flamegraph.pl and compatible tools, with the names
+          of a path separated by semicolons. */
+      void writeFoldedStacks( std::ostream & os, Metric metric ) const
+      {
+        for( auto const & c : itsRoot.children )
+          foldNode( os, *c, c->name, metric );
+      }
+
+    private:
+      template <class Stream> friend class detail::ProfileRecorder;
+
+      void reportNode( std::ostream & os, Node const & node, std::string const & path ) const
+      {
+        Entry const self = node.self();
+        char line[1024];
+        std::snprintf( line, sizeof(line), "%-60s %12llu %14llu %14llu %12.3f %12.3f\n", path.c_str(),
+                       static_cast<unsigned long long>( node.entry.count ), static_cast<unsigned long long>( node.entry.bytes ),
+                       static_cast<unsigned long long>( self.bytes ), node.entry.seconds * 1e3, self.seconds * 1e3 );
+        os << line;
+
+        for( auto const & c : node.children )
+          reportNode( os, *c, c->name == "[]" ? path + "[]" : path + "." + c->name );
+      }
+
+      void foldNode( std::ostream & os, Node const & node, std::string const & stack, Metric metric ) const
+      {
+        Entry const self = node.self();
+        auto const value = metric == Metric::bytes ? self.bytes : static_cast<std::uint64_t>( self.seconds * 1e6 );
+        if( value > 0 )
+          os << stack << ' ' << value << '\n';
+
+        for( auto const & c : node.children )
+          foldNode( os, *c, c->name == "[]" ? stack + "[]" : stack + ";" + c->name, metric );
+      }
+
+      Node itsRoot;
+      std::map<std::type_index, Entry> itsTypes;
+  };
+
+  namespace detail
+  {
+    //! Forwards to another stream buffer, counting the bytes that pass through it
+    class CountingStreamBuffer : public std::streambuf
+    {
+      public:
+        explicit CountingStreamBuffer( std::streambuf * target ) : itsTarget( target ), itsCount( 0 ) {}
+
+        //! The bytes written or read so far
+        std::uint64_t count() const { return itsCount; }
+
+      protected:
+        int_type overflow( int_type c ) override
+        {
+          if( traits_type::eq_int_type( c, traits_type::eof() ) )
+            return traits_type::not_eof( c );
+
+          ++itsCount;
+          return itsTarget->sputc( traits_type::to_char_type( c ) );
+        }
+
+        std::streamsize xsputn( char const * s, std::streamsize n ) override
+        {
+          auto const written = itsTarget->sputn( s, n );
+          itsCount += static_cast<std::uint64_t>( written );
+          return written;
+        }
+
+        int_type underflow() override
+        {
+          return itsTarget->sgetc();
+        }
+
+        int_type uflow() override
+        {
+          auto const c = itsTarget->sbumpc();
+          if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+            ++itsCount;
+          return c;
+        }
+
+        std::streamsize xsgetn( char * s, std::streamsize n ) override
+        {
+          auto const read = itsTarget->sgetn( s, n );
+          itsCount += static_cast<std::uint64_t>( read );
+          return read;
+        }
+
+        int_type pbackfail( int_type c ) override
+        {
+          auto const result = traits_type::eq_int_type( c, traits_type::eof() ) ? itsTarget->sungetc()
+                                                                                : itsTarget->sputbackc( traits_type::to_char_type( c ) );
+          if( !traits_type::eq_int_type( result, traits_type::eof() ) && itsCount > 0 )
+            --itsCount;
+          return result;
+        }
+
+        std::streamsize showmanyc() override { return itsTarget->in_avail(); }
+        int sync() override { return itsTarget->pubsync(); }
+
+        pos_type seekoff( off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which ) override
+        { return itsTarget->pubseekoff( off, dir, which ); }
+
+        pos_type seekpos( pos_type pos, std::ios_base::openmode which ) override
+        { return itsTarget->pubseekpos( pos, which ); }
+
+      private:
+        std::streambuf * itsTarget;
+        std::uint64_t itsCount;
+    };
+
+    //! Counts the bytes of a stream and attributes them and the time spent to a Profile
+    /*! This is a base of ProfilingAdapter, so that the stream is counted before the
+        archive is constructed and until it has been destroyed. */
+    template <class Stream>
+    class ProfileRecorder : public ArchiveObserver
+    {
+      protected:
+        ProfileRecorder( Profile & profile, Stream & stream ) :
+          itsProfile( profile ), itsStream( stream ), itsPrevious( stream.rdbuf() ), itsBuffer( itsPrevious )
+        {
+          itsStream.rdbuf( &itsBuffer );
+        }
+
+        ~ProfileRecorder()
+        {
+          itsStream.rdbuf( itsPrevious );
+        }
+
+      public:
+        void enter( char const * name, std::type_info const & type, bool wrapper ) override
+        {
+          Frame frame;
+          frame.type = wrapper ? nullptr : &type;
+          frame.ownsNode = !wrapper;
+          frame.wrapper = wrapper;
+          frame.named = name != nullptr;
+          frame.valueSeen = false;
+
+          Frame * parent = itsFrames.empty() ? nullptr : &itsFrames.back();
+          Profile::Node & around = parent ? *parent->node : itsProfile.itsRoot;
+
+          if( wrapper || ( parent && !name && ( parent->wrapper || ( parent->named && !parent->valueSeen ) ) ) )
+          {
+            // Wrappers, the values inside them, and the value of a name-value pair
+            // belong to the value around them
+            if( parent && parent->named && !wrapper )
+              parent->valueSeen = true;
+            frame.node = &around;
+            frame.ownsNode = false;
+          }
+          else if( name )
+            frame.node = &around.child( name );
+          else if( parent )
+            frame.node = &around.child( "[]" );
+          else
+            frame.node = &around.child( util::demangle( type.name() ).c_str() );
+
+          frame.bytes = itsBuffer.count();
+          frame.start = std::chrono::steady_clock::now();
+          itsFrames.push_back( frame );
+        }
+
+        void leave() override
+        {
+          auto const end = std::chrono::steady_clock::now();
+          Frame const frame = itsFrames.back();
+          itsFrames.pop_back();
+
+          Profile::Entry entry;
+          entry.count = 1;
+          entry.bytes = itsBuffer.count() - frame.bytes;
+          entry.seconds = std::chrono::duration<double>( end - frame.start ).count();
+          if( frame.ownsNode )
+            frame.node->entry.add( entry );
+          if( frame.type && !( frame.named && frame.valueSeen ) )
+            itsProfile.itsTypes[std::type_index( *frame.type )].add( entry );
+        }
+
+      private:
+        //! A value being serialized
+        struct Frame
+        {
+          Profile::Node * node;         //!< Where the value is attributed
+          std::type_info const * type;  //!< Its type, or nullptr for a wrapper
+          bool ownsNode;                //!< Whether the value is attributed to the node, or the value around it is
+          bool wrapper;                 //!< Whether it is one of cereal's own wrappers
+          bool named;                   //!< Whether it is a name-value pair
+          bool valueSeen;               //!< Whether the value of the pair has been entered
+          std::uint64_t bytes;          //!< The byte count when it was entered
+          std::chrono::steady_clock::time_point start;
+        };
+
+        Profile & itsProfile;
+        Stream & itsStream;
+        std::streambuf * itsPrevious;
+        CountingStreamBuffer itsBuffer;
+        std::vector<Frame> itsFrames;
+    };
+  } // namespace detail
+
+  //! Wraps an archive and attributes the bytes and time of everything it serializes to a Profile
+  /*! The adapter takes the profile and the stream of the archive, followed by any
+      further arguments to the constructor of the archive.  It is used exactly like the
+      archive it wraps:
+
+      @code{.cpp}
+      cereal::Profile profile;
+      {
+        cereal::ProfilingAdapter<cereal::BinaryOutputArchive> ar( profile, os );
+        ar( CEREAL_NVP(root) );
+      }
+      profile.report( std::cout );
+      @endcode
+
+      Bytes are counted as they pass through the stream, which the adapter wraps for
+      the lifetime of the archive.  This bypasses any fast paths an archive has for
+      particular stream buffers.  Bytes are exact for the binary archives.  The JSON
+      output archive writes in chunks, so its bytes land on whichever values happen
+      to fill a chunk, and archives that write or read their stream all at once, such
+      as the XML archives and the JSON input archive, attribute no bytes at all.
+      Time is attributed for every archive.
+
+      @tparam Archive The archive to wrap */
+  template <class Archive>
+  class ProfilingAdapter :
+    public detail::ProfileRecorder<typename std::conditional<std::is_base_of<detail::OutputArchiveBase, Archive>::value,
+                                                             std::ostream, std::istream>::type>,
+    public Archive
+  {
+      typedef typename std::conditional<std::is_base_of<detail::OutputArchiveBase, Archive>::value,
+                                        std::ostream, std::istream>::type StreamType;
+
+    public:
+      //! Constructs the archive on a stream, recording into a profile
+      /*! @param profile Where bytes and time are attributed, which must outlive the adapter
+          @param stream The stream of the archive
+          @param args Any further arguments to the constructor of the archive */
+      template <class ... Args>
+      ProfilingAdapter( Profile & profile, StreamType & stream, Args && ... args ) :
+        detail::ProfileRecorder<StreamType>( profile, stream ),
+        Archive( stream, std::forward<Args>( args )... )
+      {
+        this->setObserver( this );
+      }
+  };
+
   #ifdef CEREAL_FUTURE_EXPERIMENTAL
 
   // Forward declaration for friend access
@@ -120,7 +495,9 @@ namespace cereal
       UserDataAdapter( UserData & ud, Args && ... args ) :
         Archive( std::forward<Args>( args )... ),
         userdata( ud )
-      { }
+      {
+        this->setUserData( &userdata );
+      }
 
     private:
       //! Overload the rtti function to enable dynamic_cast
@@ -134,6 +511,11 @@ namespace cereal
       some archive wrapped by UserDataAdapter.  If this is used on
       an archive that is not wrapped, a run-time exception will occur.
 
+      The adapter attaches its data with the archive's setUserData, so this
+      is a lookup in the archive rather than a dynamic_cast, and also finds
+      data attached that way without an adapter.  Code that can handle a
+      missing value may call getUserData on the archive directly.
+
       @note This feature is experimental and may be altered or removed in a future release. See issue #46.
 
       @note The correct use of this function cannot be enforced at compile
@@ -148,14 +530,11 @@ namespace cereal
   template <class UserData, class Archive>
   UserData & get_user_data( Archive & ar )
   {
-    try
-    {
-      return dynamic_cast<UserDataAdapter<UserData, Archive> &>( ar ).userdata;
-    }
-    catch( std::bad_cast const & )
-    {
+    UserData * data = ar.template getUserData<UserData>();
+    if( !data )
       throw ::cereal::Exception("Attempting to get user data from archive not wrapped in UserDataAdapter");
-    }
+
+    return *data;
   }
   #endif // CEREAL_FUTURE_EXPERIMENTAL
 } // namespace cereal
@@ -0,0 +1,335 @@
+/*! \file async_binary.hpp
+    \brief Binary output archive that writes to its stream from a background thread */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_ASYNC_BINARY_HPP_
+#define CEREAL_ARCHIVES_ASYNC_BINARY_HPP_
+
+#include <cereal/cereal.hpp>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace cereal
+{
+  // ######################################################################
+  //! An output archive that overlaps serialization with writing to the stream
+  /*! This archive produces exactly the same data as BinaryOutputArchive and can be
+      loaded with BinaryInputArchive.  Instead of writing to the stream directly,
+      saveBinary fills an in-memory buffer.  Full buffers are handed to a background
+      thread which performs the actual writes, while the serializing thread carries
+      on filling the next buffer.  The serializing thread only blocks when every
+      buffer is waiting to be written.
+
+      The stream must not be used by anything else until the archive has been
+      destroyed or wait() has returned.
+
+      Errors encountered by the writer thread are rethrown on the serializing thread
+      by the next call to saveBinary, flush, or wait.  If no such call is made, the
+      error is thrown from the destructor, unless the destructor runs during stack
+      unwinding.  Call wait() before the archive goes out of scope to handle errors
+      without relying on a throwing destructor.
+
+      \ingroup Archives */
+  class AsyncBinaryOutputArchive : public OutputArchive<AsyncBinaryOutputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! A class containing various advanced options for the async binary archive
+      class Options
+      {
+        public:
+          //! Default options, two buffers of 1MB each
+          static Options Default(){ return Options(); }
+
+          //! Specify specific options for the AsyncBinaryOutputArchive
+          /*! @param bufferSize The size of each buffer.  Data is written to the stream in chunks of this size.
+              @param bufferCount The number of buffers, at least two.  More buffers absorb larger bursts
+                                 of serialization at the cost of memory. */
+          explicit Options( std::size_t bufferSize = 1 << 20, std::size_t bufferCount = 2 ) :
+            itsBufferSize( bufferSize > 0 ? bufferSize : 1 ),
+            itsBufferCount( bufferCount > 2 ? bufferCount : 2 ) { }
+
+        private:
+          friend class AsyncBinaryOutputArchive;
+          std::size_t itsBufferSize;
+          std::size_t itsBufferCount;
+      };
+
+      //! Construct, outputting to the provided stream
+      /*! @param stream The stream to output to.  It is only written to by the background thread.
+          @param options The async binary specific options to use.  See the Options struct
+                         for the values of default parameters */
+      AsyncBinaryOutputArchive(std::ostream & stream, Options const & options = Options::Default()) :
+        OutputArchive<AsyncBinaryOutputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream),
+        itsBuffers(options.itsBufferCount),
+        itsCurrent(0),
+        itsUsed(0),
+        itsWriting(false),
+        itsStop(false),
+        itsErrorReported(false)
+      {
+        for( auto & buffer : itsBuffers )
+          buffer.data.resize( options.itsBufferSize );
+
+        for( std::size_t i = 1; i < itsBuffers.size(); ++i )
+          itsFree.push_back( i );
+
+        itsWriter = std::thread( &AsyncBinaryOutputArchive::writerLoop, this );
+      }
+
+      //! Writes out all buffered data and stops the writer thread
+      /*! @throw Exception, or whatever the stream threw, if writing failed and the error has not
+                 already been reported through saveBinary, flush, or wait */
+      ~AsyncBinaryOutputArchive() noexcept(false)
+      {
+        auto const reported = itsErrorReported;
+        std::exception_ptr error;
+        try
+        {
+          flush();
+          waitForWriter();
+        }
+        catch( ... ) { }
+
+        {
+          std::lock_guard<std::mutex> lock( itsMutex );
+          itsStop = true;
+          if( !reported )
+            error = itsError;
+        }
+        itsCondition.notify_all();
+        itsWriter.join();
+
+        if( error && !std::uncaught_exception() )
+          std::rethrow_exception( error );
+      }
+
+      //! Buffers size bytes of data, handing full buffers to the writer thread
+      void saveBinary( const void * data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        // fast path: fits in the current buffer
+        auto & buffer = itsBuffers[itsCurrent].data;
+        if( buffer.size() - itsUsed >= size )
+        {
+          std::memcpy( buffer.data() + itsUsed, data, size );
+          itsUsed += size;
+          return;
+        }
+
+        auto src = static_cast<const char *>( data );
+        while( size > 0 )
+        {
+          auto & current = itsBuffers[itsCurrent].data;
+          auto const n = std::min( size, current.size() - itsUsed );
+          std::memcpy( current.data() + itsUsed, src, n );
+          itsUsed += n;
+          src += n;
+          size -= n;
+
+          if( itsUsed == current.size() )
+            flush();
+        }
+      }
+
+      //! Hands any buffered data to the writer thread without waiting for it to be written
+      /*! @throw The error from the writer thread, if one occurred */
+      void flush()
+      {
+        std::unique_lock<std::mutex> lock( itsMutex );
+        rethrowError();
+
+        if( itsUsed == 0 )
+          return;
+
+        itsBuffers[itsCurrent].size = itsUsed;
+        itsPending.push_back( itsCurrent );
+        itsCondition.notify_all();
+
+        // acquire the next buffer to fill, waiting for the writer to release one if needed
+        itsCondition.wait( lock, [this]{ return !itsFree.empty() || itsError; } );
+        rethrowError();
+
+        itsCurrent = itsFree.front();
+        itsFree.pop_front();
+        itsUsed = 0;
+      }
+
+      //! Blocks until all data saved so far has been written to the stream
+      /*! The stream itself is flushed once all buffers have been written.
+          @throw The error from the writer thread, if one occurred */
+      void wait()
+      {
+        flush();
+        waitForWriter();
+
+        std::lock_guard<std::mutex> lock( itsMutex );
+        rethrowError();
+      }
+
+    private:
+      //! A buffer along with the number of bytes it holds
+      struct Buffer
+      {
+        Buffer() : size(0) {}
+        std::vector<char> data;
+        std::size_t size;
+      };
+
+      //! Waits until the writer thread has no pending buffers, then flushes the stream
+      void waitForWriter()
+      {
+        std::unique_lock<std::mutex> lock( itsMutex );
+        itsCondition.wait( lock, [this]{ return (itsPending.empty() && !itsWriting) || itsError; } );
+        if( itsError )
+          return;
+
+        lock.unlock();
+        try
+        {
+          if( !itsStream.flush() )
+            throw Exception("Failed to flush output stream");
+        }
+        catch( ... )
+        {
+          lock.lock();
+          itsError = std::current_exception();
+        }
+      }
+
+      //! Rethrows an error from the writer thread, must be called with itsMutex held
+      void rethrowError()
+      {
+        if( itsError )
+        {
+          itsErrorReported = true;
+          std::rethrow_exception( itsError );
+        }
+      }
+
+      //! The body of the writer thread
+      void writerLoop()
+      {
+        std::unique_lock<std::mutex> lock( itsMutex );
+        for( ;; )
+        {
+          itsCondition.wait( lock, [this]{ return !itsPending.empty() || itsStop; } );
+          if( itsPending.empty() )
+            return;
+
+          auto const index = itsPending.front();
+          itsPending.pop_front();
+          itsWriting = true;
+          auto const failed = static_cast<bool>( itsError );
+          lock.unlock();
+
+          // once a write has failed, remaining buffers are discarded
+          std::exception_ptr error;
+          if( !failed )
+          {
+            try
+            {
+              auto const & buffer = itsBuffers[index];
+              auto const writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( buffer.data.data(), buffer.size ) );
+
+              if(writtenSize != buffer.size)
+                throw Exception("Failed to write " + std::to_string(buffer.size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+            }
+            catch( ... )
+            {
+              error = std::current_exception();
+            }
+          }
+
+          lock.lock();
+          if( error )
+            itsError = error;
+          itsWriting = false;
+          itsFree.push_back( index );
+          itsCondition.notify_all();
+        }
+      }
+
+      std::ostream & itsStream;
+      std::vector<Buffer> itsBuffers;
+      std::size_t itsCurrent;          //!< index of the buffer being filled, owned by the serializing thread
+      std::size_t itsUsed;             //!< bytes of the current buffer holding data
+
+      std::mutex itsMutex;             //!< guards everything below
+      std::condition_variable itsCondition;
+      std::deque<std::size_t> itsFree;    //!< buffers available to be filled
+      std::deque<std::size_t> itsPending; //!< buffers waiting to be written, in order
+      bool itsWriting;                 //!< whether the writer thread is writing a buffer
+      bool itsStop;
+      std::exception_ptr itsError;     //!< the first error raised while writing
+      bool itsErrorReported;           //!< whether itsError has been thrown to the user
+      std::thread itsWriter;
+  };
+
+  // ######################################################################
+  // Common AsyncBinaryArchive serialization functions
+
+  //! Saving for POD types to async binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(AsyncBinaryOutputArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to async binary
+  template <class T> inline
+  void CEREAL_SERIALIZE_FUNCTION_NAME( AsyncBinaryOutputArchive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Serializing SizeTags to async binary
+  template <class T> inline
+  void CEREAL_SERIALIZE_FUNCTION_NAME( AsyncBinaryOutputArchive & ar, SizeTag<T> & t )
+  {
+    ar( t.size );
+  }
+
+  //! Saving binary data to async binary
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(AsyncBinaryOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::AsyncBinaryOutputArchive)
+
+#endif // CEREAL_ARCHIVES_ASYNC_BINARY_HPP_
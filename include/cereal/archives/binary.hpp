@@ -30,10 +30,45 @@
 #define CEREAL_ARCHIVES_BINARY_HPP_
 
 #include <cereal/cereal.hpp>
+#include <cereal/details/crc32c.hpp>
+#include <algorithm>
+#include <cstring>
 #include <sstream>
+#include <vector>
 
 namespace cereal
 {
+  namespace binary_detail
+  {
+    //! Whether T is a class serialized with a version, whose body is length prefixed by skippable archives
+    /*! @internal */
+    template <class T, class Archive>
+    struct is_versioned_output_class : std::integral_constant<bool,
+      traits::has_member_versioned_serialize<T, Archive>::value || traits::has_non_member_versioned_serialize<T, Archive>::value ||
+      traits::has_member_versioned_save<T, Archive>::value || traits::has_non_member_versioned_save<T, Archive>::value> {};
+
+    //! Whether T is a class loaded with a version, whose body is length prefixed by skippable archives
+    /*! @internal */
+    template <class T, class Archive>
+    struct is_versioned_input_class : std::integral_constant<bool,
+      traits::has_member_versioned_serialize<T, Archive>::value || traits::has_non_member_versioned_serialize<T, Archive>::value ||
+      traits::has_member_versioned_load<T, Archive>::value || traits::has_non_member_versioned_load<T, Archive>::value> {};
+  } // namespace binary_detail
+
+  //! The first error met by a binary archive using sticky errors
+  /*! @relates BinaryOutputArchive
+      @relates BinaryInputArchive */
+  enum class BinaryError : std::uint8_t
+  {
+    none,                //!< Nothing has failed
+    write_failed,        //!< The stream did not accept all of the data written to it
+    read_failed,         //!< The stream ended before all of the data requested from it
+    past_end_of_body,    //!< A skippable class body was read beyond its length
+    invalid_body_length, //!< A skippable class body is longer than the class containing it
+    skip_failed,         //!< The stream ended while skipping the rest of a class body
+    checksum_mismatch    //!< A checksummed block is corrupt
+  };
+
   // ######################################################################
   //! An output archive designed to save data in a compact binary representation
   /*! This archive outputs data to a stream in an extremely compact binary
@@ -47,29 +82,222 @@ namespace cereal
       std::ios::binary format flag to avoid having your data altered
       inadvertently.
 
+      Optionally, the body of every class serialized with a version can be prefixed
+      by its length in bytes (see Options::Skippable).  A reader can then evolve
+      independently of the writer: whatever part of a body it does not load, such as
+      fields added by a newer writer, or everything after a header that a filter rejected,
+      is skipped.  Data saved this way must be loaded by an archive using the same option.
+
+      With Options::StickyErrors, a failed write does not throw.  The archive instead
+      records the first failure as a BinaryError and ignores everything written after
+      it, so that error() can be checked once when saving is done.
+
+      With Options::Checksummed, data is collected into blocks, and each block is
+      written preceded by its size and followed by its CRC32C checksum, so that the
+      integrity of the data is checked as it is loaded rather than in a separate pass
+      over the file.  The last block is written when the archive is flushed, reset or
+      destroyed.
+
       \ingroup Archives */
-  class BinaryOutputArchive : public OutputArchive<BinaryOutputArchive, AllowEmptyClassElision>
+  class BinaryOutputArchive : public OutputArchive<BinaryOutputArchive, AllowEmptyClassElision | CoalesceArithmetic>
   {
     public:
+      //! A class containing various advanced options for the binary output archive
+      class Options
+      {
+        public:
+          //! Default options
+          static Options Default(){ return Options(); }
+
+          //! Prefix the body of every versioned class with its length, so readers can skip what they do not load
+          static Options Skippable(){ return Options( true ); }
+
+          //! Record failures in error() instead of throwing
+          static Options StickyErrors(){ return Options( false, true ); }
+
+          //! Write data in blocks of the given size, each followed by its CRC32C checksum
+          static Options Checksummed( std::size_t blockSize = 1 << 16 ){ return Options( false, false, blockSize ); }
+
+          //! Specify specific options for the BinaryOutputArchive
+          /*! @param skippable Whether to prefix versioned class bodies with their length.
+                               Top level objects containing such classes are then built in
+                               memory before being written, so the stream need not be seekable
+              @param stickyErrors Whether a failed write is recorded in error(), turning
+                                  later writes into no-ops, instead of throwing an Exception
+              @param checksumBlockSize If nonzero, the size of the blocks that are written
+                                       with a checksum */
+          explicit Options( bool skippable = false, bool stickyErrors = false, std::size_t checksumBlockSize = 0 ) :
+            itsSkippable( skippable ), itsStickyErrors( stickyErrors ),
+            itsChecksumBlockSize( checksumBlockSize ) { }
+
+        private:
+          friend class BinaryOutputArchive;
+          bool itsSkippable;
+          bool itsStickyErrors;
+          std::size_t itsChecksumBlockSize;
+      };
+
       //! Construct, outputting to the provided stream
       /*! @param stream The stream to output to.  Can be a stringstream, a file stream, or
-                        even cout! */
-      BinaryOutputArchive(std::ostream & stream) :
-        OutputArchive<BinaryOutputArchive, AllowEmptyClassElision>(this),
-        itsStream(stream)
-      { }
+                        even cout!
+          @param options The binary specific options to use.  See the Options struct
+                         for the values of default parameters */
+      BinaryOutputArchive(std::ostream & stream, Options const & options = Options::Default()) :
+        OutputArchive<BinaryOutputArchive, AllowEmptyClassElision | CoalesceArithmetic>(this),
+        itsStream(&stream),
+        itsSkippable(options.itsSkippable),
+        itsStickyErrors(options.itsStickyErrors),
+        itsError(BinaryError::none),
+        itsChecksumBlockSize(options.itsChecksumBlockSize)
+      {
+        itsBlock.reserve( itsChecksumBlockSize );
+      }
+
+      //! Writes the last checksummed block, if any
+      /*! Errors cannot be reported here, so call flush first to find out whether the
+          last block was written */
+      ~BinaryOutputArchive()
+      {
+        try { flush(); } catch( ... ) {}
+      }
+
+      //! Rebinds the archive to a new stream, forgetting all tracked pointers and types
+      /*! Memory used for tracking is kept, so one archive can cheaply save many independent
+          messages.  Each message can be loaded by a new or reset BinaryInputArchive.
+          @param stream The stream to output to from now on */
+      void reset( std::ostream & stream )
+      {
+        flush();
+        OutputArchive<BinaryOutputArchive, AllowEmptyClassElision | CoalesceArithmetic>::reset();
+        itsStream = &stream;
+        itsBodies.clear();
+        itsBuffer.clear();
+        itsError = BinaryError::none;
+      }
+
+      //! The first failure since construction or the last reset, when using sticky errors
+      BinaryError error() const
+      {
+        return itsError;
+      }
 
       //! Writes size bytes of data to the output stream
       void saveBinary( const void * data, std::size_t size )
       {
-        auto const writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
+        this->statisticsCounter().binary( size );
+        if( !itsBodies.empty() )
+        {
+          auto const bytes = reinterpret_cast<const char *>( data );
+          itsBuffer.insert( itsBuffer.end(), bytes, bytes + size );
+          return;
+        }
+
+        write( data, size );
+      }
+
+      //! Starts the body of a versioned class, leaving room for its length if skippable
+      /*! @internal */
+      void startBody()
+      {
+        if( !itsSkippable )
+          return;
+
+        itsBodies.push_back( itsBuffer.size() );
+        itsBuffer.resize( itsBuffer.size() + sizeof(std::uint64_t) );
+      }
+
+      //! Finishes the body of a versioned class, filling in its length if skippable
+      /*! @internal */
+      void finishBody()
+      {
+        if( !itsSkippable )
+          return;
+
+        auto const start = itsBodies.back();
+        itsBodies.pop_back();
+
+        std::uint64_t const length = itsBuffer.size() - start - sizeof(std::uint64_t);
+        std::memcpy( &itsBuffer[start], &length, sizeof(length) );
+
+        if( itsBodies.empty() )
+        {
+          write( itsBuffer.data(), itsBuffer.size() );
+          itsBuffer.clear();
+        }
+      }
+
+      //! Writes any data collected for a checksummed block as a block of its own
+      /*! This does nothing unless Options::Checksummed is used.  The destructor also
+          flushes, but can not report errors, so call this once everything is saved to
+          find out whether the output is complete.  A block that fails to be written is
+          dropped rather than written again.
+          @throws Exception if the block can not be written, unless using sticky errors */
+      void flush()
+      {
+        if( itsBlock.empty() )
+          return;
+
+        std::uint32_t const size = static_cast<std::uint32_t>( itsBlock.size() );
+        std::uint32_t const checksum = crc32c_detail::update( 0, itsBlock.data(), itsBlock.size() );
+
+        std::vector<char> block;
+        block.swap( itsBlock );
+        writeStream( &size, sizeof(size) );
+        writeStream( block.data(), size );
+        writeStream( &checksum, sizeof(checksum) );
+
+        block.clear();
+        itsBlock.swap( block ); // keeps the capacity of the block
+      }
+
+    private:
+      //! Writes size bytes of data to the output stream, through a checksummed block if enabled
+      void write( const void * data, std::size_t size )
+      {
+        if( !itsChecksumBlockSize )
+          return writeStream( data, size );
+
+        auto src = static_cast<const char *>( data );
+        while( size > 0 )
+        {
+          auto const n = std::min( size, itsChecksumBlockSize - itsBlock.size() );
+          itsBlock.insert( itsBlock.end(), src, src + n );
+          src += n;
+          size -= n;
+
+          if( itsBlock.size() == itsChecksumBlockSize )
+            flush();
+        }
+      }
+
+      //! Writes size bytes of data directly to the output stream
+      void writeStream( const void * data, std::size_t size )
+      {
+        if( itsError != BinaryError::none )
+          return;
+
+        auto const writtenSize = static_cast<std::size_t>( itsStream->rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
 
         if(writtenSize != size)
+        {
+          if( itsStickyErrors )
+          {
+            itsError = BinaryError::write_failed;
+            return;
+          }
+
           throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+        }
       }
 
-    private:
-      std::ostream & itsStream;
+      std::ostream * itsStream;
+      bool itsSkippable;                  //!< Whether versioned class bodies are length prefixed
+      bool itsStickyErrors;               //!< Whether failures are recorded instead of thrown
+      BinaryError itsError;               //!< The first failure, when using sticky errors
+      std::vector<std::size_t> itsBodies; //!< Where the bodies being saved start in itsBuffer
+      std::vector<char> itsBuffer;        //!< Holds data while a length prefixed body is saved
+      std::size_t itsChecksumBlockSize;   //!< The size of checksummed blocks, or zero
+      std::vector<char> itsBlock;         //!< Collects data for the next checksummed block
   };
 
   // ######################################################################
@@ -82,27 +310,264 @@ namespace cereal
       std::ios::binary format flag to avoid having your data altered
       inadvertently.
 
+      With Options::StickyErrors, malformed or truncated data does not throw.  The
+      archive instead records the first failure as a BinaryError, and from then on
+      every read yields zeroes without touching the stream.  Containers therefore load
+      as empty and loading winds down quickly, so that error() can be checked once at
+      the end.  Errors raised outside of the archive, such as by an unregistered
+      polymorphic type, are still thrown.
+
+      With Options::Checksummed, each block of data is checked against its checksum
+      before any of it is handed out, so corrupt data is reported as
+      BinaryError::checksum_mismatch instead of being loaded.
+
       \ingroup Archives */
-  class BinaryInputArchive : public InputArchive<BinaryInputArchive, AllowEmptyClassElision>
+  class BinaryInputArchive : public InputArchive<BinaryInputArchive, AllowEmptyClassElision | CoalesceArithmetic>
   {
     public:
+      //! A class containing various advanced options for the binary input archive
+      class Options
+      {
+        public:
+          //! Default options
+          static Options Default(){ return Options(); }
+
+          //! Load data saved with BinaryOutputArchive::Options::Skippable
+          static Options Skippable(){ return Options( true ); }
+
+          //! Record failures in error() instead of throwing
+          static Options StickyErrors(){ return Options( false, true ); }
+
+          //! Load data saved with BinaryOutputArchive::Options::Checksummed, verifying each block
+          static Options Checksummed( std::size_t blockSize = 1 << 16 ){ return Options( false, false, blockSize ); }
+
+          //! Specify specific options for the BinaryInputArchive
+          /*! @param skippable Whether versioned class bodies are prefixed with their length.
+                               Any part of a body that is not loaded is then skipped
+              @param stickyErrors Whether a failed read is recorded in error(), turning
+                                  later reads into zeroes, instead of throwing an Exception
+              @param checksumBlockSize If nonzero, the block size the data was saved with.
+                                       Larger blocks are rejected as corrupt */
+          explicit Options( bool skippable = false, bool stickyErrors = false, std::size_t checksumBlockSize = 0 ) :
+            itsSkippable( skippable ), itsStickyErrors( stickyErrors ), itsChecksumBlockSize( checksumBlockSize ) { }
+
+        private:
+          friend class BinaryInputArchive;
+          bool itsSkippable;
+          bool itsStickyErrors;
+          std::size_t itsChecksumBlockSize;
+      };
+
       //! Construct, loading from the provided stream
-      BinaryInputArchive(std::istream & stream) :
-        InputArchive<BinaryInputArchive, AllowEmptyClassElision>(this),
-        itsStream(stream)
+      /*! @param stream The stream to read from
+          @param options The binary specific options to use, which must match those the data was saved with */
+      BinaryInputArchive(std::istream & stream, Options const & options = Options::Default()) :
+        InputArchive<BinaryInputArchive, AllowEmptyClassElision | CoalesceArithmetic>(this),
+        itsStream(&stream),
+        itsSkippable(options.itsSkippable),
+        itsStickyErrors(options.itsStickyErrors),
+        itsError(BinaryError::none),
+        itsPosition(0),
+        itsChecksumBlockSize(options.itsChecksumBlockSize),
+        itsBlockUsed(0)
     { }
 
+      //! Rebinds the archive to a new stream, forgetting all tracked pointers and types
+      /*! @param stream The stream to read from from now on */
+      void reset( std::istream & stream )
+      {
+        InputArchive<BinaryInputArchive, AllowEmptyClassElision | CoalesceArithmetic>::reset();
+        itsStream = &stream;
+        itsBodyEnds.clear();
+        itsError = BinaryError::none;
+        itsBlock.clear();
+        itsBlockUsed = 0;
+      }
+
+      //! The first failure since construction or the last reset, when using sticky errors
+      BinaryError error() const
+      {
+        return itsError;
+      }
+
       //! Reads size bytes of data from the input stream
       void loadBinary( void * const data, std::size_t size )
       {
-        auto const readSize = static_cast<std::size_t>( itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size ) );
+        this->statisticsCounter().binary( size );
+        if( itsError != BinaryError::none )
+          return fail( itsError, data, size );
+
+        if( !itsBodyEnds.empty() && size > itsBodyEnds.back() - itsPosition )
+        {
+          if( itsStickyErrors )
+            return fail( BinaryError::past_end_of_body, data, size );
+
+          throw Exception("Failed to read " + std::to_string(size) + " bytes - only " +
+                          std::to_string(itsBodyEnds.back() - itsPosition) + " remain in the class being loaded");
+        }
+
+        auto const readSize = read( data, size );
+        itsPosition += readSize;
 
         if(readSize != size)
+        {
+          if( itsError != BinaryError::none )
+            return fail( itsError, data, size );
+
+          if( itsStickyErrors )
+            return fail( BinaryError::read_failed, data, size );
+
           throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+        }
+      }
+
+      //! Starts the body of a versioned class, reading its length if skippable
+      /*! @internal */
+      void startBody()
+      {
+        if( !itsSkippable )
+          return;
+
+        std::uint64_t length;
+        loadBinary( &length, sizeof(length) );
+        if( !itsBodyEnds.empty() && length > itsBodyEnds.back() - itsPosition )
+        {
+          if( !itsStickyErrors )
+            throw Exception("Invalid class length - it exceeds the class containing it");
+
+          itsError = BinaryError::invalid_body_length;
+          length = 0;
+        }
+
+        itsBodyEnds.push_back( itsPosition + length );
+      }
+
+      //! Finishes the body of a versioned class, skipping whatever was not loaded if skippable
+      /*! @internal */
+      void finishBody()
+      {
+        if( !itsSkippable )
+          return;
+
+        auto const end = itsBodyEnds.back();
+        itsBodyEnds.pop_back();
+        if( end == itsPosition || itsError != BinaryError::none )
+          return;
+
+        // seek past the rest where possible, otherwise read through it
+        auto const remaining = end - itsPosition;
+        if( !itsChecksumBlockSize &&
+            itsStream->rdbuf()->pubseekoff( static_cast<std::streamoff>( remaining ), std::ios::cur, std::ios::in ) != std::streampos(-1) )
+        {
+          itsPosition = end;
+          return;
+        }
+
+        char discard[4096];
+        while( itsPosition != end )
+        {
+          auto const size = static_cast<std::size_t>( std::min<std::uint64_t>( end - itsPosition, sizeof(discard) ) );
+          auto const readSize = read( discard, size );
+          itsPosition += readSize;
+          if( readSize != size )
+          {
+            if( itsError != BinaryError::none )
+              return;
+
+            if( itsStickyErrors )
+            {
+              itsError = BinaryError::skip_failed;
+              return;
+            }
+
+            throw Exception("Failed to skip the rest of a class - the stream ended");
+          }
+        }
       }
 
     private:
-      std::istream & itsStream;
+      //! Reads up to size bytes of data, through checksummed blocks if enabled
+      /*! @return The number of bytes read, which is less than size if the stream ended
+                  or a block was corrupt */
+      std::size_t read( void * const data, std::size_t size )
+      {
+        if( !itsChecksumBlockSize )
+          return static_cast<std::size_t>( itsStream->rdbuf()->sgetn( reinterpret_cast<char*>( data ), size ) );
+
+        auto dst = static_cast<char *>( data );
+        std::size_t readSize = 0;
+        while( readSize < size )
+        {
+          if( itsBlockUsed == itsBlock.size() && !readBlock() )
+            break;
+
+          auto const n = std::min( size - readSize, itsBlock.size() - itsBlockUsed );
+          std::memcpy( dst + readSize, itsBlock.data() + itsBlockUsed, n );
+          itsBlockUsed += n;
+          readSize += n;
+        }
+
+        return readSize;
+      }
+
+      //! Reads the next checksummed block and verifies it
+      /*! @return Whether a block was read.  A corrupt block is recorded in itsError,
+                  or thrown without sticky errors */
+      bool readBlock()
+      {
+        itsBlock.clear();
+        itsBlockUsed = 0;
+
+        auto buffer = itsStream->rdbuf();
+        std::uint32_t size;
+        if( buffer->sgetn( reinterpret_cast<char *>( &size ), sizeof(size) ) != sizeof(size) )
+          return false;
+
+        if( size == 0 || size > itsChecksumBlockSize )
+          return corrupt();
+
+        itsBlock.resize( size );
+        std::uint32_t checksum;
+        if( static_cast<std::size_t>( buffer->sgetn( itsBlock.data(), size ) ) != size ||
+            buffer->sgetn( reinterpret_cast<char *>( &checksum ), sizeof(checksum) ) != sizeof(checksum) )
+        {
+          itsBlock.clear();
+          return false;
+        }
+
+        if( crc32c_detail::update( 0, itsBlock.data(), size ) != checksum )
+          return corrupt();
+
+        return true;
+      }
+
+      //! Handles a block that failed verification
+      bool corrupt()
+      {
+        itsBlock.clear();
+        if( !itsStickyErrors )
+          throw Exception("Checksum mismatch - the data being loaded is corrupt");
+
+        itsError = BinaryError::checksum_mismatch;
+        return false;
+      }
+
+      //! Records the first failure and zeroes the data that could not be read
+      void fail( BinaryError error, void * const data, std::size_t size )
+      {
+        itsError = error;
+        std::memset( data, 0, size );
+      }
+
+      std::istream * itsStream;
+      bool itsSkippable;                      //!< Whether versioned class bodies are length prefixed
+      bool itsStickyErrors;                   //!< Whether failures are recorded instead of thrown
+      BinaryError itsError;                   //!< The first failure, when using sticky errors
+      std::uint64_t itsPosition;              //!< Bytes of data loaded, excluding any block framing
+      std::vector<std::uint64_t> itsBodyEnds; //!< Where the bodies being loaded end, by itsPosition
+      std::size_t itsChecksumBlockSize;       //!< The largest valid checksummed block, or zero
+      std::vector<char> itsBlock;             //!< The verified block being loaded from
+      std::size_t itsBlockUsed;               //!< Bytes of itsBlock already loaded
   };
 
   // ######################################################################
@@ -153,6 +618,37 @@ namespace cereal
   {
     ar.loadBinary(bd.data, static_cast<std::size_t>(bd.size));
   }
+
+  // ######################################################################
+  // BinaryArchive prologue and epilogue functions
+
+  //! Prologue for versioned classes, starting a length prefixed body when skippable
+  template <class T, traits::EnableIf<binary_detail::is_versioned_output_class<T, BinaryOutputArchive>::value> = traits::sfinae> inline
+  void prologue( BinaryOutputArchive & ar, T const & )
+  {
+    ar.startBody();
+  }
+
+  //! Prologue for versioned classes, starting a length prefixed body when skippable
+  template <class T, traits::EnableIf<binary_detail::is_versioned_input_class<T, BinaryInputArchive>::value> = traits::sfinae> inline
+  void prologue( BinaryInputArchive & ar, T const & )
+  {
+    ar.startBody();
+  }
+
+  //! Epilogue for versioned classes, finishing a length prefixed body when skippable
+  template <class T, traits::EnableIf<binary_detail::is_versioned_output_class<T, BinaryOutputArchive>::value> = traits::sfinae> inline
+  void epilogue( BinaryOutputArchive & ar, T const & )
+  {
+    ar.finishBody();
+  }
+
+  //! Epilogue for versioned classes, finishing a length prefixed body when skippable
+  template <class T, traits::EnableIf<binary_detail::is_versioned_input_class<T, BinaryInputArchive>::value> = traits::sfinae> inline
+  void epilogue( BinaryInputArchive & ar, T const & )
+  {
+    ar.finishBody();
+  }
 } // namespace cereal
 
 // register archives for polymorphic support
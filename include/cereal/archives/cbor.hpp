@@ -0,0 +1,1308 @@
+/*! \file cbor.hpp
+    \brief CBOR input and output archives */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_CBOR_HPP_
+#define CEREAL_ARCHIVES_CBOR_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/details/charconv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stack>
+#include <string>
+#include <vector>
+
+namespace cereal
+{
+  namespace cbor_detail
+  {
+    //! The major types of CBOR data items
+    /*! @internal */
+    enum Major : std::uint8_t
+    {
+      unsigned_integer = 0,
+      negative_integer = 1,
+      byte_string      = 2,
+      text_string      = 3,
+      array            = 4,
+      map              = 5,
+      tag              = 6,
+      simple           = 7
+    };
+
+    //! Additional information values with special meaning
+    /*! @internal */
+    enum Info : std::uint8_t
+    {
+      false_value = 20,
+      true_value  = 21,
+      float16     = 25,
+      float32     = 26,
+      float64     = 27,
+      indefinite  = 31
+    };
+
+    //! Ends an item of indefinite length
+    /*! @internal */
+    static const std::uint8_t break_code = 0xFF;
+
+    //! Marks an item as having no tag
+    /*! @internal */
+    static const std::uint64_t no_tag = ~std::uint64_t( 0 );
+
+    //! Returns true if the current machine is little endian
+    /*! @internal */
+    inline bool is_little_endian()
+    {
+      static std::int32_t test = 1;
+      return *reinterpret_cast<std::int8_t*>( &test ) == 1;
+    }
+
+    //! The element type of the data behind a BinaryData<T>
+    /*! @internal */
+    template <class T>
+    struct binary_element
+    {
+      using type = typename std::remove_cv<typename std::remove_pointer<typename std::decay<T>::type>::type>::type;
+    };
+
+    //! Whether elements of type T are written as arrays of bytes
+    /*! These are the element types of arithmetic vectors and of BinaryData.
+        @internal */
+    template <class T>
+    struct is_binary_element : std::integral_constant<bool,
+      ( std::is_arithmetic<T>::value && !std::is_same<T, bool>::value ) || std::is_void<T>::value> {};
+
+    //! The layout of the elements of an RFC 8746 typed array
+    /*! @internal */
+    struct TypedArray
+    {
+      bool floating;
+      bool isSigned;
+      bool littleEndian;
+      std::size_t size;
+    };
+
+    //! Describes the elements of a typed array from its tag
+    /*! @return false if the tag is not that of a typed array */
+    inline bool typed_array( std::uint64_t tag, TypedArray & layout )
+    {
+      // Tags 64 to 87 are 0b010fsell: floating point, signed, little endian, and length
+      if( tag < 64 || tag > 87 )
+        return false;
+
+      layout.floating = ( tag & 0x10 ) != 0;
+      layout.isSigned = ( tag & 0x08 ) != 0;
+      layout.littleEndian = ( tag & 0x04 ) != 0;
+      layout.size = layout.floating ? std::size_t( 2 ) << ( tag & 3 ) : std::size_t( 1 ) << ( tag & 3 );
+
+      // 68 holds clamped uint8, and 76 is unassigned
+      if( layout.size == 1 )
+      {
+        if( tag == 76 )
+          return false;
+        layout.littleEndian = false;
+      }
+
+      return true;
+    }
+
+    //! The tag of the typed array holding elements of type T in host byte order, or 0 for a plain byte string
+    /*! Characters, void, and floating point types that are not IEEE 754 binary32
+        or binary64, such as most long doubles, are written as plain byte strings.
+        @internal */
+    template <class T> inline
+    std::uint64_t typed_array_tag()
+    {
+      if( !std::is_arithmetic<T>::value || std::is_same<T, char>::value || std::is_same<T, bool>::value )
+        return 0;
+
+      std::uint64_t length;
+      if( std::is_floating_point<T>::value )
+      {
+        if( !std::numeric_limits<T>::is_iec559 || ( sizeof(T) != 4 && sizeof(T) != 8 ) )
+          return 0;
+        length = sizeof(T) == 4 ? 1 : 2;
+      }
+      else
+      {
+        switch( sizeof(T) )
+        {
+          case 1: length = 0; break;
+          case 2: length = 1; break;
+          case 4: length = 2; break;
+          case 8: length = 3; break;
+          default: return 0;
+        }
+      }
+
+      return 64 | ( std::is_floating_point<T>::value ? 0x10 : 0 ) |
+                  ( std::is_signed<T>::value && !std::is_floating_point<T>::value ? 0x08 : 0 ) |
+                  ( sizeof(T) > 1 && is_little_endian() ? 0x04 : 0 ) | length;
+    }
+
+    //! Decodes an IEEE 754 binary16 value
+    /*! @internal */
+    inline double half_to_double( std::uint16_t half )
+    {
+      int const exponent = ( half >> 10 ) & 0x1F;
+      int const mantissa = half & 0x3FF;
+
+      double value;
+      if( exponent == 0 )
+        value = std::ldexp( mantissa, -24 );
+      else if( exponent != 31 )
+        value = std::ldexp( mantissa + 1024, exponent - 25 );
+      else
+        value = mantissa == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+
+      return ( half & 0x8000 ) ? -value : value;
+    }
+
+    //! A data item parsed by CBORInputArchive
+    /*! @internal */
+    struct Item
+    {
+      std::uint8_t major;     //!< The major type
+      std::uint8_t info;      //!< The additional information, which tells the width of floating point values
+      std::uint64_t value;    //!< The value of integers, bits of floating point values, lengths of strings, or children of arrays and maps
+      std::uint64_t tag;      //!< The innermost tag of the item, or no_tag
+      std::size_t data;       //!< Where the content of a string is kept
+      std::size_t name;       //!< Where the null terminated key of a map member is kept, or npos
+      std::size_t nameSize;   //!< The length of the key
+      std::size_t end;        //!< The index just past the last item nested in this one
+    };
+  } // namespace cbor_detail
+
+  // ######################################################################
+  //! An output archive designed to save data in the CBOR format
+  /*! CBOR (RFC 8949) is a compact binary format with a data model like that of
+      JSON, so data saved with it can be read by libraries for most languages.
+      It is laid out as the JSON archive lays out JSON: the archive is a map, classes
+      are maps whose keys are the names given by name-value pairs, or value0,
+      value1, and so on for unnamed values, and dynamically sized containers are
+      arrays.  Unlike JSON, integers and floating point numbers are kept exactly.
+
+      Vectors and strings of arithmetic types other than char, as well as BinaryData,
+      are written as byte strings.  Where the element type is a standard integer or
+      an IEEE 754 float, the byte string is tagged as an RFC 8746 typed array in the
+      byte order of the machine, which libraries such as cbor2 for Python and
+      cbor-x for JavaScript decode as a typed array.
+
+      Classes and containers are written with CBOR's indefinite lengths, since their
+      number of members is not known ahead of time.  long double is written as a
+      double.
+
+      \ingroup Archives */
+  class CBOROutputArchive : public OutputArchive<CBOROutputArchive>
+  {
+    enum class NodeType { StartObject, InObject, StartArray, InArray };
+
+    public:
+      /*! @name Common Functionality
+          Common use cases for directly interacting with an CBOROutputArchive */
+      //! @{
+
+      //! Construct, outputting to the provided stream
+      /*! @param stream The stream to output to */
+      CBOROutputArchive( std::ostream & stream ) :
+        OutputArchive<CBOROutputArchive>( this ),
+        itsStream( stream ),
+        itsNextName( nullptr )
+      {
+        itsNameCounter.push( 0 );
+        itsNodeStack.push( NodeType::StartObject );
+      }
+
+      //! Destructor, finishes the enclosing map
+      ~CBOROutputArchive()
+      {
+        try
+        {
+          if( !itsNodeStack.empty() )
+            finishNode();
+        }
+        catch( ... )
+        { }
+      }
+
+      //! Saves some binary data as a byte string, with an optional name
+      void saveBinaryValue( const void * data, size_t size, const char * name = nullptr )
+      {
+        setNextName( name );
+        writeName();
+        saveBytes( data, size, 0 );
+      }
+
+      //! @}
+      /*! @name Internal Functionality
+          Functionality designed for use by those requiring control over the inner mechanisms of
+          the CBOROutputArchive */
+      //! @{
+
+      //! Starts a new node, which is a map unless made into an array
+      void startNode()
+      {
+        writeName();
+        itsNodeStack.push( NodeType::StartObject );
+        itsNameCounter.push( 0 );
+      }
+
+      //! Designates the most recently added node as finished
+      void finishNode()
+      {
+        switch( itsNodeStack.top() )
+        {
+          case NodeType::StartArray:  writeHead( cbor_detail::array, 0 ); break;
+          case NodeType::StartObject: writeHead( cbor_detail::map, 0 );   break;
+          case NodeType::InArray:
+          case NodeType::InObject:    writeByte( cbor_detail::break_code ); break;
+        }
+
+        itsNodeStack.pop();
+        itsNameCounter.pop();
+      }
+
+      //! Sets the name for the next node created with startNode
+      void setNextName( const char * name )
+      {
+        itsNextName = name;
+      }
+
+      //! Writes the key of the upcoming value, first opening the node it belongs to if needed
+      void writeName()
+      {
+        NodeType & nodeType = itsNodeStack.top();
+
+        if( nodeType == NodeType::StartArray )
+        {
+          writeByte( ( cbor_detail::array << 5 ) | cbor_detail::indefinite );
+          nodeType = NodeType::InArray;
+        }
+        else if( nodeType == NodeType::StartObject )
+        {
+          writeByte( ( cbor_detail::map << 5 ) | cbor_detail::indefinite );
+          nodeType = NodeType::InObject;
+        }
+
+        // Array elements have no keys
+        if( nodeType == NodeType::InArray )
+          return;
+
+        if( itsNextName == nullptr )
+        {
+          char name[charconv_detail::bufferSize] = "value";
+          auto const size = 5 + charconv_detail::toChars( name + 5, itsNameCounter.top()++ );
+          saveText( name, size );
+        }
+        else
+        {
+          saveText( itsNextName, std::strlen( itsNextName ) );
+          itsNextName = nullptr;
+        }
+      }
+
+      //! Designates that the current node should be output as an array, not a map
+      void makeArray()
+      {
+        itsNodeStack.top() = NodeType::StartArray;
+      }
+
+      //! Saves a bool
+      void saveValue( bool b )
+      {
+        writeHead( cbor_detail::simple, b ? cbor_detail::true_value : cbor_detail::false_value );
+      }
+
+      //! Saves an integer in its shortest encoding
+      template <class T, traits::EnableIf<std::is_integral<T>::value, !std::is_same<T, bool>::value> = traits::sfinae> inline
+      void saveValue( T t )
+      {
+        saveInteger( t, typename std::is_signed<T>::type() );
+      }
+
+      //! Saves a float as a binary32
+      void saveValue( float f )
+      {
+        std::uint32_t bits;
+        std::memcpy( &bits, &f, sizeof(bits) );
+        writeFloat( cbor_detail::float32, bits, 4 );
+      }
+
+      //! Saves a double as a binary64
+      void saveValue( double d )
+      {
+        std::uint64_t bits;
+        std::memcpy( &bits, &d, sizeof(bits) );
+        writeFloat( cbor_detail::float64, bits, 8 );
+      }
+
+      //! Saves a long double as a binary64
+      void saveValue( long double d )
+      {
+        saveValue( static_cast<double>( d ) );
+      }
+
+      //! Saves a string as a text string
+      void saveValue( std::string const & s )
+      {
+        saveText( s.data(), s.size() );
+      }
+
+      //! Saves characters as a text string
+      void saveText( const char * data, std::size_t size )
+      {
+        writeHead( cbor_detail::text_string, size );
+        write( data, size );
+      }
+
+      //! Saves an array of arithmetic values as a byte string, tagged as a typed array if possible
+      template <class T> inline
+      void saveTypedArray( T const * data, std::size_t count )
+      {
+        saveBytes( data, count * sizeof(T), cbor_detail::typed_array_tag<T>() );
+      }
+
+      //! @}
+
+    private:
+      template <class T> inline
+      void saveInteger( T t, std::true_type /* signed */ )
+      {
+        auto const value = static_cast<std::int64_t>( t );
+        if( value < 0 )
+          writeHead( cbor_detail::negative_integer, static_cast<std::uint64_t>( -( value + 1 ) ) );
+        else
+          writeHead( cbor_detail::unsigned_integer, static_cast<std::uint64_t>( value ) );
+      }
+
+      template <class T> inline
+      void saveInteger( T t, std::false_type /* signed */ )
+      {
+        writeHead( cbor_detail::unsigned_integer, static_cast<std::uint64_t>( t ) );
+      }
+
+      //! Writes a byte string, preceded by a tag unless it is 0
+      void saveBytes( const void * data, std::size_t size, std::uint64_t tag )
+      {
+        if( tag )
+          writeHead( cbor_detail::tag, tag );
+        writeHead( cbor_detail::byte_string, size );
+        write( data, size );
+      }
+
+      //! Writes the initial byte and argument of an item in the shortest form
+      void writeHead( std::uint8_t major, std::uint64_t value )
+      {
+        std::uint8_t head[9];
+        std::size_t size;
+        major = static_cast<std::uint8_t>( major << 5 );
+
+        if( value < 24 )
+        {
+          head[0] = static_cast<std::uint8_t>( major | value );
+          size = 1;
+        }
+        else
+        {
+          std::size_t const bytes = value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFF ? 4 : 8;
+          head[0] = static_cast<std::uint8_t>( major | ( bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27 ) );
+          for( std::size_t i = 0; i < bytes; ++i )
+            head[bytes - i] = static_cast<std::uint8_t>( value >> ( 8 * i ) );
+          size = bytes + 1;
+        }
+
+        write( head, size );
+      }
+
+      //! Writes a floating point value of the given width from its bits
+      void writeFloat( std::uint8_t info, std::uint64_t bits, std::size_t bytes )
+      {
+        std::uint8_t head[9];
+        head[0] = static_cast<std::uint8_t>( ( cbor_detail::simple << 5 ) | info );
+        for( std::size_t i = 0; i < bytes; ++i )
+          head[bytes - i] = static_cast<std::uint8_t>( bits >> ( 8 * i ) );
+        write( head, bytes + 1 );
+      }
+
+      void writeByte( std::uint8_t byte )
+      {
+        write( &byte, 1 );
+      }
+
+      void write( const void * data, std::size_t size )
+      {
+        auto const writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), static_cast<std::streamsize>( size ) ) );
+
+        if( writtenSize != size )
+          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+      }
+
+      std::ostream & itsStream;            //!< The stream written to
+      char const * itsNextName;            //!< The next name
+      std::stack<uint32_t, std::vector<uint32_t>> itsNameCounter; //!< Counter for creating unique names for unnamed nodes
+      std::stack<NodeType, std::vector<NodeType>> itsNodeStack;
+  }; // CBOROutputArchive
+
+  // ######################################################################
+  //! An input archive designed to load data saved in the CBOR format
+  /*! The archive reads a single CBOR map from the stream when it is constructed,
+      leaving the stream positioned right after it, so a stream may hold a
+      sequence of archives.
+
+      Like the JSONInputArchive, values can be loaded out of order using
+      name-value pairs: when the given name does not match the next key, the
+      current map is searched for it.  Data from other CBOR encoders can be loaded
+      as long as it has the layout written by the CBOROutputArchive, and arithmetic
+      vectors may also be given as arrays of numbers.  Integers are checked to fit
+      the type they are loaded into.
+
+      \ingroup Archives */
+  class CBORInputArchive : public InputArchive<CBORInputArchive>
+  {
+    public:
+      /*! @name Common Functionality
+          Common use cases for directly interacting with an CBORInputArchive */
+      //! @{
+
+      //! Construct, reading a CBOR map from the provided stream
+      /*! @param stream The stream to read from
+          @throws Exception if the stream does not hold a well formed CBOR map */
+      CBORInputArchive( std::istream & stream ) :
+        InputArchive<CBORInputArchive>( this ),
+        itsStream( stream ),
+        itsNextName( nullptr )
+      {
+        parse();
+        if( itsItems[0].major != cbor_detail::map )
+          throw Exception("CBOR Parsing failed - the archive must be a map");
+        itsIteratorStack.push_back( { 1, itsItems[0].end, 1 } );
+      }
+
+      //! Loads some binary data from a byte string
+      /*! This follows the same ordering rules as other values in regards to loading
+          in/out of order
+          @throws Exception if the size of the data does not match */
+      void loadBinaryValue( void * data, size_t size, const char * name = nullptr )
+      {
+        setNextName( name );
+        loadTypedArray<unsigned char>( [&]( std::size_t count )
+        {
+          if( count != size )
+            throw Exception("CBOR binary data size does not match specified size");
+          return static_cast<unsigned char *>( data );
+        } );
+      }
+
+      //! Loads a text string without copying it
+      /*! The string points into the archive and remains valid for as long as it.
+          It is not null terminated.
+
+          This follows the same ordering rules as other values in regards to loading
+          in/out of order
+
+          @param data Set to the first character of the string
+          @param size Set to the length of the string */
+      void loadStringRef( const char *& data, size_t & size, const char * name = nullptr )
+      {
+        if( name )
+          setNextName( name );
+        search();
+
+        auto const & item = current();
+        if( item.major != cbor_detail::text_string )
+          throw Exception("CBOR Parsing failed - expected a text string");
+        data = itsData.data() + item.data;
+        size = static_cast<std::size_t>( item.value );
+        advance();
+      }
+
+      //! @}
+      /*! @name Internal Functionality
+          Functionality designed for use by those requiring control over the inner mechanisms of
+          the CBORInputArchive */
+      //! @{
+
+      //! Starts a new node, going into the array or map that is next
+      void startNode()
+      {
+        search();
+
+        auto const index = itsIteratorStack.back().current;
+        auto const & item = current();
+        if( item.major != cbor_detail::array && item.major != cbor_detail::map )
+          throw Exception("CBOR Parsing failed - expected an array or map");
+
+        itsIteratorStack.push_back( { index + 1, item.end, index + 1 } );
+      }
+
+      //! Finishes the most recently started node
+      void finishNode()
+      {
+        itsIteratorStack.pop_back();
+        advance();
+      }
+
+      //! Retrieves the key of the next value
+      /*! @return nullptr if it has no key */
+      const char * getNodeName() const
+      {
+        auto const & it = itsIteratorStack.back();
+        if( it.current >= it.end || itsItems[it.current].name == std::string::npos )
+          return nullptr;
+        return &itsData[itsItems[it.current].name];
+      }
+
+      //! Sets the name for the next node created with startNode
+      void setNextName( const char * name )
+      {
+        itsNextName = name;
+      }
+
+      //! Loads a bool
+      void loadValue( bool & value )
+      {
+        search();
+        auto const & item = current();
+        if( item.major != cbor_detail::simple || ( item.value != cbor_detail::false_value && item.value != cbor_detail::true_value ) )
+          throw Exception("CBOR Parsing failed - expected a bool");
+        value = item.value == cbor_detail::true_value;
+        advance();
+      }
+
+      //! Loads an arithmetic value
+      template <class T, traits::EnableIf<std::is_arithmetic<T>::value, !std::is_same<T, bool>::value> = traits::sfinae> inline
+      void loadValue( T & value )
+      {
+        search();
+        value = convert<T>( current() );
+        advance();
+      }
+
+      //! Loads a string from a text string
+      void loadValue( std::string & value )
+      {
+        const char * data;
+        size_t size;
+        loadStringRef( data, size );
+        value.assign( data, size );
+      }
+
+      //! Loads a byte string or an array of numbers into elements of type T
+      /*! @param resize Called with the number of elements, returning where to put them */
+      template <class T, class Resize> inline
+      void loadTypedArray( Resize && resize )
+      {
+        search();
+        auto const & item = current();
+
+        if( item.major == cbor_detail::byte_string )
+        {
+          bool swap = false;
+          cbor_detail::TypedArray layout;
+          if( cbor_detail::typed_array( item.tag, layout ) )
+          {
+            if( layout.size != sizeof(T) || layout.floating != std::is_floating_point<T>::value ||
+                ( !layout.floating && sizeof(T) > 1 && layout.isSigned != std::is_signed<T>::value ) )
+              throw Exception("CBOR Parsing failed - typed array has the wrong element type");
+            swap = sizeof(T) > 1 && layout.littleEndian != cbor_detail::is_little_endian();
+          }
+          else if( cbor_detail::typed_array_tag<T>() != 0 && sizeof(T) > 1 )
+            throw Exception("CBOR Parsing failed - expected a typed array");
+
+          if( item.value % sizeof(T) )
+            throw Exception("CBOR Parsing failed - byte string does not hold whole elements");
+
+          auto const count = static_cast<std::size_t>( item.value / sizeof(T) );
+          auto const out = reinterpret_cast<char *>( resize( count ) );
+          if( count )
+            std::memcpy( out, &itsData[item.data], count * sizeof(T) );
+
+          if( swap )
+            for( std::size_t i = 0; i < count; ++i )
+              std::reverse( out + i * sizeof(T), out + ( i + 1 ) * sizeof(T) );
+        }
+        else if( item.major == cbor_detail::array )
+        {
+          auto const out = resize( static_cast<std::size_t>( item.value ) );
+          auto index = itsIteratorStack.back().current + 1;
+          for( std::size_t i = 0; i < item.value; ++i, index = itsItems[index].end )
+            out[i] = convert<T>( itsItems[index] );
+        }
+        else
+          throw Exception("CBOR Parsing failed - expected a byte string or array");
+
+        advance();
+      }
+
+      //! Loads the size for a SizeTag, the number of children of the current node
+      void loadSize( size_type & size )
+      {
+        auto const & parent = *( itsIteratorStack.rbegin() + 1 );
+        size = itsItems[parent.current].value;
+      }
+
+      //! @}
+
+    private:
+      //! The position within an array or map
+      struct Iterator
+      {
+        std::size_t begin;   //!< The first child
+        std::size_t end;     //!< Just past the last child
+        std::size_t current; //!< The child to be loaded next
+      };
+
+      //! The item to be loaded next
+      cbor_detail::Item const & current() const
+      {
+        auto const & it = itsIteratorStack.back();
+        if( it.current >= it.end )
+          throw Exception("CBOR Parsing failed - no more data in the current node");
+        return itsItems[it.current];
+      }
+
+      //! Moves on to the item after the current one, skipping its children
+      void advance()
+      {
+        auto & it = itsIteratorStack.back();
+        it.current = itsItems[it.current].end;
+      }
+
+      //! Moves to the item with the name set by setNextName, if it is not the current one
+      /*! @throws Exception if the name is not found */
+      void search()
+      {
+        if( !itsNextName )
+          return;
+
+        auto const name = itsNextName;
+        itsNextName = nullptr;
+
+        auto const actual = getNodeName();
+        if( actual && std::strcmp( name, actual ) == 0 )
+          return;
+
+        auto & it = itsIteratorStack.back();
+        auto const size = std::strlen( name );
+        for( auto index = it.begin; index < it.end; index = itsItems[index].end )
+        {
+          auto const & item = itsItems[index];
+          if( item.name != std::string::npos && item.nameSize == size && std::memcmp( &itsData[item.name], name, size ) == 0 )
+          {
+            it.current = index;
+            return;
+          }
+        }
+
+        throw Exception("CBOR Parsing failed - provided NVP (" + std::string(name) + ") not found");
+      }
+
+      //! Converts a number to an arithmetic type
+      template <class T> inline
+      typename std::enable_if<std::is_integral<T>::value, T>::type
+      convert( cbor_detail::Item const & item ) const
+      {
+        using Unsigned = typename std::make_unsigned<T>::type;
+        auto const max = static_cast<std::uint64_t>( static_cast<Unsigned>( (std::numeric_limits<T>::max)() ) );
+
+        if( item.major == cbor_detail::unsigned_integer && item.value <= max )
+          return static_cast<T>( item.value );
+
+        // -1 - value is at least the minimum when value is at most the maximum
+        if( item.major == cbor_detail::negative_integer && std::is_signed<T>::value && item.value <= max )
+          return static_cast<T>( -static_cast<std::int64_t>( item.value ) - 1 );
+
+        if( item.major == cbor_detail::unsigned_integer || item.major == cbor_detail::negative_integer )
+          throw Exception("CBOR Parsing failed - integer does not fit in the type it is loaded into");
+
+        throw Exception("CBOR Parsing failed - expected an integer");
+      }
+
+      //! Converts a number to a floating point type
+      template <class T> inline
+      typename std::enable_if<std::is_floating_point<T>::value, T>::type
+      convert( cbor_detail::Item const & item ) const
+      {
+        if( item.major == cbor_detail::unsigned_integer )
+          return static_cast<T>( item.value );
+        if( item.major == cbor_detail::negative_integer )
+          return -static_cast<T>( item.value ) - 1;
+
+        if( item.major == cbor_detail::simple )
+        {
+          if( item.info == cbor_detail::float16 )
+            return static_cast<T>( cbor_detail::half_to_double( static_cast<std::uint16_t>( item.value ) ) );
+
+          if( item.info == cbor_detail::float32 )
+          {
+            float f;
+            auto const bits = static_cast<std::uint32_t>( item.value );
+            std::memcpy( &f, &bits, sizeof(f) );
+            return static_cast<T>( f );
+          }
+
+          if( item.info == cbor_detail::float64 )
+          {
+            double d;
+            std::memcpy( &d, &item.value, sizeof(d) );
+            return static_cast<T>( d );
+          }
+        }
+
+        throw Exception("CBOR Parsing failed - expected a number");
+      }
+
+      //! Reads the data item at the start of the stream into itsItems
+      void parse()
+      {
+        // An array or map being parsed
+        struct Frame
+        {
+          std::size_t item;         //!< Its index in itsItems
+          std::uint64_t remaining;  //!< The number of children left, for definite lengths
+          bool indefinite;
+          bool isMap;
+          bool key;                 //!< Whether a map key is expected next
+          std::size_t name;         //!< The key of the next map value
+          std::size_t nameSize;
+        };
+
+        std::vector<Frame> frames;
+        std::uint64_t tag = cbor_detail::no_tag;
+
+        for( ;; )
+        {
+          auto const initial = readByte();
+
+          if( initial == cbor_detail::break_code )
+          {
+            if( frames.empty() || !frames.back().indefinite || tag != cbor_detail::no_tag || ( frames.back().isMap && !frames.back().key ) )
+              throw Exception("CBOR Parsing failed - unexpected break");
+          }
+          else
+          {
+            auto const major = static_cast<std::uint8_t>( initial >> 5 );
+            auto const info = static_cast<std::uint8_t>( initial & 0x1F );
+            auto const value = readArgument( major, info );
+
+            if( major == cbor_detail::tag )
+            {
+              tag = value;
+              continue;
+            }
+
+            if( !frames.empty() && frames.back().isMap && frames.back().key )
+            {
+              if( major != cbor_detail::text_string || tag != cbor_detail::no_tag )
+                throw Exception("CBOR Parsing failed - map keys must be text strings");
+
+              auto & frame = frames.back();
+              frame.name = readString( major, info, value, frame.nameSize );
+              itsData.push_back( '\0' );
+              frame.key = false;
+              continue;
+            }
+
+            cbor_detail::Item item;
+            item.major = major;
+            item.info = info;
+            item.value = value;
+            item.tag = tag;
+            item.data = 0;
+            item.name = std::string::npos;
+            item.nameSize = 0;
+            tag = cbor_detail::no_tag;
+
+            if( !frames.empty() && frames.back().isMap )
+            {
+              item.name = frames.back().name;
+              item.nameSize = frames.back().nameSize;
+            }
+
+            auto const index = itsItems.size();
+            item.end = index + 1;
+
+            if( major == cbor_detail::byte_string || major == cbor_detail::text_string )
+            {
+              std::size_t size;
+              item.data = readString( major, info, value, size );
+              item.value = size;
+            }
+
+            itsItems.push_back( item );
+
+            if( major == cbor_detail::array || major == cbor_detail::map )
+            {
+              itsItems.back().value = 0;
+              if( info == cbor_detail::indefinite || value != 0 )
+              {
+                frames.push_back( { index, value, info == cbor_detail::indefinite, major == cbor_detail::map, true, 0, 0 } );
+                continue;
+              }
+            }
+
+            if( frames.empty() )
+              return;
+          }
+
+          // An item is complete, possibly completing the arrays and maps it is in
+          for( bool closed = initial == cbor_detail::break_code; ; closed = true )
+          {
+            if( closed )
+            {
+              itsItems[frames.back().item].end = itsItems.size();
+              frames.pop_back();
+              if( frames.empty() )
+                return;
+            }
+
+            auto & frame = frames.back();
+            ++itsItems[frame.item].value;
+            frame.key = frame.isMap;
+            if( frame.indefinite || --frame.remaining != 0 )
+              break;
+          }
+        }
+      }
+
+      //! Reads the argument of an item, or its length if it is an indefinite array, map, or string
+      std::uint64_t readArgument( std::uint8_t major, std::uint8_t info )
+      {
+        if( info < 24 )
+          return info;
+
+        if( info == cbor_detail::indefinite )
+        {
+          if( major < cbor_detail::byte_string || major > cbor_detail::map )
+            throw Exception("CBOR Parsing failed - invalid indefinite length");
+          return 0;
+        }
+
+        if( info > 27 )
+          throw Exception("CBOR Parsing failed - reserved additional information");
+
+        std::uint8_t bytes[8];
+        std::size_t const size = std::size_t( 1 ) << ( info - 24 );
+        read( bytes, size );
+
+        std::uint64_t value = 0;
+        for( std::size_t i = 0; i < size; ++i )
+          value = ( value << 8 ) | bytes[i];
+        return value;
+      }
+
+      //! Reads the content of a string into itsData, joining the chunks of an indefinite length one
+      /*! @return Where the content starts in itsData */
+      std::size_t readString( std::uint8_t major, std::uint8_t info, std::uint64_t length, std::size_t & size )
+      {
+        auto const start = itsData.size();
+
+        if( info != cbor_detail::indefinite )
+          readData( length );
+        else
+        {
+          for( auto initial = readByte(); initial != cbor_detail::break_code; initial = readByte() )
+          {
+            auto const chunkInfo = static_cast<std::uint8_t>( initial & 0x1F );
+            if( ( initial >> 5 ) != major || chunkInfo == cbor_detail::indefinite )
+              throw Exception("CBOR Parsing failed - invalid chunk of an indefinite length string");
+            readData( readArgument( major, chunkInfo ) );
+          }
+        }
+
+        size = itsData.size() - start;
+        return start;
+      }
+
+      //! Appends size bytes from the stream to itsData
+      /*! Data is read in bounded chunks, so a corrupted length fails at the end of
+          the stream instead of allocating all of it up front */
+      void readData( std::uint64_t size )
+      {
+        while( size )
+        {
+          auto const chunk = static_cast<std::size_t>( std::min<std::uint64_t>( size, 64 * 1024 ) );
+          auto const start = itsData.size();
+          itsData.resize( start + chunk );
+          read( &itsData[start], chunk );
+          size -= chunk;
+        }
+      }
+
+      std::uint8_t readByte()
+      {
+        std::uint8_t byte;
+        read( &byte, 1 );
+        return byte;
+      }
+
+      void read( void * data, std::size_t size )
+      {
+        auto const readSize = static_cast<std::size_t>( itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), static_cast<std::streamsize>( size ) ) );
+
+        if( readSize != size )
+          throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+      }
+
+      std::istream & itsStream;                  //!< The stream read from
+      const char * itsNextName;                  //!< Next name set by NVP
+      std::vector<cbor_detail::Item> itsItems;   //!< Every item, in the order they appear
+      std::vector<char> itsData;                 //!< The contents of strings and keys
+      std::vector<Iterator> itsIteratorStack;    //!< The position within each node being loaded
+  };
+
+  // ######################################################################
+  // CBORArchive prologue and epilogue functions
+  // ######################################################################
+
+  // ######################################################################
+  //! Prologue for NVPs for CBOR archives
+  /*! NVPs do not start or finish nodes - they just set up the names */
+  template <class T> inline
+  void prologue( CBOROutputArchive &, NameValuePair<T> const & )
+  { }
+
+  //! Prologue for NVPs for CBOR archives
+  template <class T> inline
+  void prologue( CBORInputArchive &, NameValuePair<T> const & )
+  { }
+
+  // ######################################################################
+  //! Epilogue for NVPs for CBOR archives
+  template <class T> inline
+  void epilogue( CBOROutputArchive &, NameValuePair<T> const & )
+  { }
+
+  //! Epilogue for NVPs for CBOR archives
+  template <class T> inline
+  void epilogue( CBORInputArchive &, NameValuePair<T> const & )
+  { }
+
+  // ######################################################################
+  //! Prologue for SizeTags for CBOR archives
+  /*! SizeTags are not saved, they indicate that the current node should be made into an array */
+  template <class T> inline
+  void prologue( CBOROutputArchive & ar, SizeTag<T> const & )
+  {
+    ar.makeArray();
+  }
+
+  //! Prologue for SizeTags for CBOR archives
+  template <class T> inline
+  void prologue( CBORInputArchive &, SizeTag<T> const & )
+  { }
+
+  // ######################################################################
+  //! Epilogue for SizeTags for CBOR archives
+  template <class T> inline
+  void epilogue( CBOROutputArchive &, SizeTag<T> const & )
+  { }
+
+  //! Epilogue for SizeTags for CBOR archives
+  template <class T> inline
+  void epilogue( CBORInputArchive &, SizeTag<T> const & )
+  { }
+
+  // ######################################################################
+  //! Prologue for all other types for CBOR archives (except minimal types)
+  /*! Starts a new node, named either automatically or by some NVP,
+      that may be given data by the type about to be archived
+
+      Minimal types do not start or finish nodes */
+  template <class T, traits::DisableIf<std::is_arithmetic<T>::value ||
+                                       traits::has_minimal_base_class_serialization<T, traits::has_minimal_output_serialization, CBOROutputArchive>::value ||
+                                       traits::has_minimal_output_serialization<T, CBOROutputArchive>::value> = traits::sfinae>
+  inline void prologue( CBOROutputArchive & ar, T const & )
+  {
+    ar.startNode();
+  }
+
+  //! Prologue for all other types for CBOR archives
+  template <class T, traits::DisableIf<std::is_arithmetic<T>::value ||
+                                       traits::has_minimal_base_class_serialization<T, traits::has_minimal_input_serialization, CBORInputArchive>::value ||
+                                       traits::has_minimal_input_serialization<T, CBORInputArchive>::value> = traits::sfinae>
+  inline void prologue( CBORInputArchive & ar, T const & )
+  {
+    ar.startNode();
+  }
+
+  // ######################################################################
+  //! Epilogue for all other types other for CBOR archives (except minimal types)
+  /*! Finishes the node created in the prologue
+
+      Minimal types do not start or finish nodes */
+  template <class T, traits::DisableIf<std::is_arithmetic<T>::value ||
+                                       traits::has_minimal_base_class_serialization<T, traits::has_minimal_output_serialization, CBOROutputArchive>::value ||
+                                       traits::has_minimal_output_serialization<T, CBOROutputArchive>::value> = traits::sfinae>
+  inline void epilogue( CBOROutputArchive & ar, T const & )
+  {
+    ar.finishNode();
+  }
+
+  //! Epilogue for all other types other for CBOR archives
+  template <class T, traits::DisableIf<std::is_arithmetic<T>::value ||
+                                       traits::has_minimal_base_class_serialization<T, traits::has_minimal_input_serialization, CBORInputArchive>::value ||
+                                       traits::has_minimal_input_serialization<T, CBORInputArchive>::value> = traits::sfinae>
+  inline void epilogue( CBORInputArchive & ar, T const & )
+  {
+    ar.finishNode();
+  }
+
+  // ######################################################################
+  //! Prologue for arithmetic types for CBOR archives
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void prologue( CBOROutputArchive & ar, T const & )
+  {
+    ar.writeName();
+  }
+
+  //! Prologue for arithmetic types for CBOR archives
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void prologue( CBORInputArchive &, T const & )
+  { }
+
+  // ######################################################################
+  //! Epilogue for arithmetic types for CBOR archives
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void epilogue( CBOROutputArchive &, T const & )
+  { }
+
+  //! Epilogue for arithmetic types for CBOR archives
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void epilogue( CBORInputArchive &, T const & )
+  { }
+
+  // ######################################################################
+  //! Prologue for strings for CBOR archives
+  template<class CharT, class Traits, class Alloc> inline
+  void prologue( CBOROutputArchive & ar, std::basic_string<CharT, Traits, Alloc> const & )
+  {
+    ar.writeName();
+  }
+
+  //! Prologue for strings for CBOR archives
+  template<class CharT, class Traits, class Alloc> inline
+  void prologue( CBORInputArchive &, std::basic_string<CharT, Traits, Alloc> const & )
+  { }
+
+  // ######################################################################
+  //! Epilogue for strings for CBOR archives
+  template<class CharT, class Traits, class Alloc> inline
+  void epilogue( CBOROutputArchive &, std::basic_string<CharT, Traits, Alloc> const & )
+  { }
+
+  //! Epilogue for strings for CBOR archives
+  template<class CharT, class Traits, class Alloc> inline
+  void epilogue( CBORInputArchive &, std::basic_string<CharT, Traits, Alloc> const & )
+  { }
+
+  // ######################################################################
+  //! Prologue for arithmetic vectors for CBOR archives, which are single values
+  template <class T, class A, traits::EnableIf<cbor_detail::is_binary_element<T>::value> = traits::sfinae> inline
+  void prologue( CBOROutputArchive & ar, std::vector<T, A> const & )
+  {
+    ar.writeName();
+  }
+
+  //! Prologue for arithmetic vectors for CBOR archives
+  template <class T, class A, traits::EnableIf<cbor_detail::is_binary_element<T>::value> = traits::sfinae> inline
+  void prologue( CBORInputArchive &, std::vector<T, A> const & )
+  { }
+
+  // ######################################################################
+  //! Epilogue for arithmetic vectors for CBOR archives
+  template <class T, class A, traits::EnableIf<cbor_detail::is_binary_element<T>::value> = traits::sfinae> inline
+  void epilogue( CBOROutputArchive &, std::vector<T, A> const & )
+  { }
+
+  //! Epilogue for arithmetic vectors for CBOR archives
+  template <class T, class A, traits::EnableIf<cbor_detail::is_binary_element<T>::value> = traits::sfinae> inline
+  void epilogue( CBORInputArchive &, std::vector<T, A> const & )
+  { }
+
+  // ######################################################################
+  //! Prologue for BinaryData for CBOR archives, which is a single value
+  template <class T> inline
+  void prologue( CBOROutputArchive & ar, BinaryData<T> const & )
+  {
+    ar.writeName();
+  }
+
+  //! Prologue for BinaryData for CBOR archives
+  template <class T> inline
+  void prologue( CBORInputArchive &, BinaryData<T> const & )
+  { }
+
+  // ######################################################################
+  //! Epilogue for BinaryData for CBOR archives
+  template <class T> inline
+  void epilogue( CBOROutputArchive &, BinaryData<T> const & )
+  { }
+
+  //! Epilogue for BinaryData for CBOR archives
+  template <class T> inline
+  void epilogue( CBORInputArchive &, BinaryData<T> const & )
+  { }
+
+  // ######################################################################
+  // Common CBORArchive serialization functions
+  // ######################################################################
+  //! Serializing NVP types to CBOR
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( CBOROutputArchive & ar, NameValuePair<T> const & t )
+  {
+    ar.setNextName( t.name );
+    ar( t.value );
+  }
+
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( CBORInputArchive & ar, NameValuePair<T> & t )
+  {
+    ar.setNextName( t.name );
+    ar( t.value );
+  }
+
+  //! Saving for arithmetic to CBOR
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void CEREAL_SAVE_FUNCTION_NAME( CBOROutputArchive & ar, T const & t )
+  {
+    ar.saveValue( t );
+  }
+
+  //! Loading arithmetic from CBOR
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void CEREAL_LOAD_FUNCTION_NAME( CBORInputArchive & ar, T & t )
+  {
+    ar.loadValue( t );
+  }
+
+  //! Saving strings to CBOR, as text strings for char and typed arrays otherwise
+  template<class CharT, class Traits, class Alloc> inline
+  void CEREAL_SAVE_FUNCTION_NAME( CBOROutputArchive & ar, std::basic_string<CharT, Traits, Alloc> const & str )
+  {
+    ar.saveTypedArray( str.data(), str.size() );
+  }
+
+  //! Saving std::string to CBOR
+  template<class Traits, class Alloc> inline
+  void CEREAL_SAVE_FUNCTION_NAME( CBOROutputArchive & ar, std::basic_string<char, Traits, Alloc> const & str )
+  {
+    ar.saveText( str.data(), str.size() );
+  }
+
+  //! Loading strings from CBOR
+  template<class CharT, class Traits, class Alloc> inline
+  void CEREAL_LOAD_FUNCTION_NAME( CBORInputArchive & ar, std::basic_string<CharT, Traits, Alloc> & str )
+  {
+    ar.loadTypedArray<CharT>( [&]( std::size_t count )
+    {
+      str.resize( count );
+      return &str[0];
+    } );
+  }
+
+  //! Loading std::string from CBOR
+  template<class Traits, class Alloc> inline
+  void CEREAL_LOAD_FUNCTION_NAME( CBORInputArchive & ar, std::basic_string<char, Traits, Alloc> & str )
+  {
+    const char * data;
+    size_t size;
+    ar.loadStringRef( data, size );
+    str.assign( data, size );
+  }
+
+  //! Saving arithmetic vectors to CBOR as typed arrays
+  template <class T, class A, traits::EnableIf<cbor_detail::is_binary_element<T>::value> = traits::sfinae> inline
+  void CEREAL_SAVE_FUNCTION_NAME( CBOROutputArchive & ar, std::vector<T, A> const & vector )
+  {
+    ar.saveTypedArray( vector.data(), vector.size() );
+  }
+
+  //! Loading arithmetic vectors from CBOR typed arrays or arrays of numbers
+  template <class T, class A, traits::EnableIf<cbor_detail::is_binary_element<T>::value> = traits::sfinae> inline
+  void CEREAL_LOAD_FUNCTION_NAME( CBORInputArchive & ar, std::vector<T, A> & vector )
+  {
+    ar.loadTypedArray<T>( [&]( std::size_t count )
+    {
+      vector.resize( count );
+      return vector.data();
+    } );
+  }
+
+  //! Saving BinaryData to CBOR as a byte string, tagged as a typed array where possible
+  template <class T, traits::EnableIf<cbor_detail::is_binary_element<typename cbor_detail::binary_element<T>::type>::value> = traits::sfinae> inline
+  void CEREAL_SAVE_FUNCTION_NAME( CBOROutputArchive & ar, BinaryData<T> const & bd )
+  {
+    using Element = typename std::conditional<std::is_void<typename cbor_detail::binary_element<T>::type>::value,
+                                              unsigned char, typename cbor_detail::binary_element<T>::type>::type;
+    ar.saveTypedArray( static_cast<Element const *>( bd.data ), static_cast<std::size_t>( bd.size / sizeof(Element) ) );
+  }
+
+  //! Loading BinaryData from CBOR
+  template <class T, traits::EnableIf<cbor_detail::is_binary_element<typename cbor_detail::binary_element<T>::type>::value> = traits::sfinae> inline
+  void CEREAL_LOAD_FUNCTION_NAME( CBORInputArchive & ar, BinaryData<T> & bd )
+  {
+    using Element = typename std::conditional<std::is_void<typename cbor_detail::binary_element<T>::type>::value,
+                                              unsigned char, typename cbor_detail::binary_element<T>::type>::type;
+    ar.loadTypedArray<Element>( [&]( std::size_t count )
+    {
+      if( count * sizeof(Element) != bd.size )
+        throw Exception("CBOR binary data size does not match specified size");
+      return static_cast<Element *>( bd.data );
+    } );
+  }
+
+  // ######################################################################
+  //! Saving SizeTags to CBOR
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( CBOROutputArchive &, SizeTag<T> const & )
+  {
+    // nothing to do here, we don't explicitly save the size
+  }
+
+  //! Loading SizeTags from CBOR
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( CBORInputArchive & ar, SizeTag<T> & st )
+  {
+    ar.loadSize( st.size );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::CBORInputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::CBOROutputArchive)
+
+// tie input and output archives together
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::CBORInputArchive, cereal::CBOROutputArchive)
+
+#endif // CEREAL_ARCHIVES_CBOR_HPP_
@@ -0,0 +1,276 @@
+/*! \file chunked_output.hpp
+    \brief Output of serialized data in chunks of a fixed size, pushed to a callback or pulled by a consumer */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_CHUNKED_OUTPUT_HPP_
+#define CEREAL_ARCHIVES_CHUNKED_OUTPUT_HPP_
+
+#include <cereal/details/helpers.hpp>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+namespace cereal
+{
+  // ######################################################################
+  //! A stream buffer that hands its output to a callback in chunks of a fixed size
+  /*! Only one chunk is ever held in memory, so a message of any size can be sent
+      as it is serialized.  The callback sees each chunk once it is full, and any
+      partial chunk when the stream is flushed or finish() is called.  A callback
+      that blocks, such as one waiting for a socket to become writable, holds up
+      serialization until it returns.
+
+      @code{.cpp}
+      cereal::ChunkedOutputBuffer buffer( 64 * 1024, [&]( const char * data, std::size_t size )
+                                          { socket.send( data, size ); } );
+      std::ostream stream( &buffer );
+      {
+        cereal::BinaryOutputArchive ar( stream );
+        ar( message );
+      }
+      buffer.finish();
+      @endcode
+
+      @ingroup Utility */
+  class ChunkedOutputBuffer : public std::streambuf
+  {
+    public:
+      //! The callback for each chunk, whose data is only valid until it returns
+      using Callback = std::function<void( const char * data, std::size_t size )>;
+
+      //! Construct, handing chunks of chunkSize bytes to callback
+      ChunkedOutputBuffer( std::size_t chunkSize, Callback callback ) :
+        itsChunk( chunkSize > 0 ? chunkSize : 1 ),
+        itsCallback( std::move( callback ) )
+      {
+        setp( itsChunk.data(), itsChunk.data() + itsChunk.size() );
+      }
+
+      //! Hands any partial chunk to the callback
+      void finish()
+      {
+        emit();
+      }
+
+    protected:
+      //! Hands the full chunk to the callback and starts the next one
+      int_type overflow( int_type c ) override
+      {
+        emit();
+        if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+        {
+          *pptr() = traits_type::to_char_type( c );
+          pbump( 1 );
+        }
+        return traits_type::not_eof( c );
+      }
+
+      //! Hands any partial chunk to the callback
+      int sync() override
+      {
+        emit();
+        return 0;
+      }
+
+    private:
+      //! Calls the callback with the data in the chunk, if there is any, and empties it
+      void emit()
+      {
+        auto const size = static_cast<std::size_t>( pptr() - pbase() );
+        if( size == 0 )
+          return;
+
+        setp( itsChunk.data(), itsChunk.data() + itsChunk.size() );
+        itsCallback( itsChunk.data(), size );
+      }
+
+      std::vector<char> itsChunk;
+      Callback itsCallback;
+  };
+
+  // ######################################################################
+  //! Produces serialized data in chunks of a fixed size, as the consumer asks for them
+  /*! The save function is given a std::ostream, on which it creates whatever archive
+      it needs.  It runs on a separate thread started by the first call to next(),
+      and is suspended whenever a chunk is full until the consumer asks for the next
+      one.  A network layer can then pull data as its socket becomes writable.  Huge
+      messages stream through with one chunk of memory, and serialization runs no
+      further ahead than the consumer.
+
+      @code{.cpp}
+      cereal::ChunkedOutputGenerator generator( []( std::ostream & os )
+      {
+        cereal::BinaryOutputArchive ar( os );
+        ar( message );
+      } );
+
+      while( auto chunk = generator.next() )
+        socket.send( chunk.data, chunk.size ); // may wait for the socket to drain
+      @endcode
+
+      Serialization is suspended on its own thread rather than in a coroutine, as a
+      coroutine could not suspend from inside the nested save functions of an archive.
+
+      An exception thrown by the save function is rethrown by next().  A generator
+      destroyed before it is exhausted stops the save function by throwing an
+      Exception from the stream buffer, then waits for it to return.  Only archives
+      that write through the stream buffer directly, such as BinaryOutputArchive,
+      stop early.  Others run to the end with their output discarded.
+
+      @ingroup Utility */
+  class ChunkedOutputGenerator
+  {
+    public:
+      //! A chunk of output, which is only valid until the next call to next()
+      struct Chunk
+      {
+        const char * data; //!< pointer to the beginning of the chunk
+        std::size_t size;  //!< size in bytes, zero once all data has been produced
+
+        explicit operator bool() const { return size != 0; }
+      };
+
+      //! The function that saves the data to be produced
+      using SaveFunction = std::function<void( std::ostream & )>;
+
+      //! Construct, without running the save function yet
+      /*! @param save The function that saves the data
+          @param chunkSize The size of each chunk, except for the last one */
+      ChunkedOutputGenerator( SaveFunction save, std::size_t chunkSize = 64 * 1024 ) :
+        itsSave( std::move( save ) ),
+        itsChunkSize( chunkSize ),
+        itsChunk{ nullptr, 0 },
+        itsReady( false ),
+        itsDone( false ),
+        itsAbandoned( false )
+      { }
+
+      //! Stops the save function if it has not finished, and waits for it
+      ~ChunkedOutputGenerator()
+      {
+        if( !itsProducer.joinable() )
+          return;
+
+        {
+          std::lock_guard<std::mutex> lock( itsMutex );
+          itsAbandoned = true;
+        }
+        itsCondition.notify_all();
+        itsProducer.join();
+      }
+
+      ChunkedOutputGenerator( ChunkedOutputGenerator const & ) = delete;
+      ChunkedOutputGenerator & operator=( ChunkedOutputGenerator const & ) = delete;
+
+      //! Releases the previous chunk and waits for the next one
+      /*! @return The next chunk, or an empty chunk once all data has been produced
+          @throw Whatever the save function threw */
+      Chunk next()
+      {
+        std::unique_lock<std::mutex> lock( itsMutex );
+        if( !itsProducer.joinable() )
+          itsProducer = std::thread( &ChunkedOutputGenerator::produce, this );
+        else if( itsReady )
+        {
+          itsReady = false;
+          itsCondition.notify_all();
+        }
+
+        itsCondition.wait( lock, [this]{ return itsReady || itsDone; } );
+        if( itsReady )
+          return itsChunk;
+
+        if( itsError )
+        {
+          auto const error = itsError;
+          itsError = nullptr;
+          std::rethrow_exception( error );
+        }
+
+        return { nullptr, 0 };
+      }
+
+    private:
+      //! The body of the producer thread
+      void produce()
+      {
+        std::exception_ptr error;
+        try
+        {
+          ChunkedOutputBuffer buffer( itsChunkSize, [this]( const char * data, std::size_t size ){ handOff( data, size ); } );
+          std::ostream stream( &buffer );
+          itsSave( stream );
+          buffer.finish();
+        }
+        catch( ... )
+        {
+          error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock( itsMutex );
+        if( !itsAbandoned )
+          itsError = error;
+        itsDone = true;
+        itsCondition.notify_all();
+      }
+
+      //! Hands a chunk to the consumer and waits for it to be released
+      void handOff( const char * data, std::size_t size )
+      {
+        std::unique_lock<std::mutex> lock( itsMutex );
+        if( itsAbandoned )
+          throw Exception("Chunked output was abandoned by its consumer");
+
+        itsChunk = { data, size };
+        itsReady = true;
+        itsCondition.notify_all();
+
+        itsCondition.wait( lock, [this]{ return !itsReady || itsAbandoned; } );
+        if( itsAbandoned )
+          throw Exception("Chunked output was abandoned by its consumer");
+      }
+
+      SaveFunction itsSave;
+      std::size_t itsChunkSize;
+      std::thread itsProducer;
+
+      std::mutex itsMutex;         //!< guards everything below
+      std::condition_variable itsCondition;
+      Chunk itsChunk;              //!< the chunk held by the consumer
+      bool itsReady;               //!< whether itsChunk is held by the consumer
+      bool itsDone;                //!< whether the save function has returned
+      bool itsAbandoned;           //!< whether the consumer has gone away
+      std::exception_ptr itsError; //!< what the save function threw
+  };
+} // namespace cereal
+
+#endif // CEREAL_ARCHIVES_CHUNKED_OUTPUT_HPP_
@@ -0,0 +1,337 @@
+/*! \file compact_binary.hpp
+    \brief Binary input and output archives using variable length integers */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_COMPACT_BINARY_HPP_
+#define CEREAL_ARCHIVES_COMPACT_BINARY_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/details/varint.hpp>
+#include <sstream>
+#include <limits>
+
+namespace cereal
+{
+  namespace compact_binary_detail
+  {
+    using varint_detail::max_varint_size;
+    using varint_detail::encode_varint;
+    using varint_detail::zigzag_encode;
+    using varint_detail::zigzag_decode;
+
+    //! Flag in the archive header signifying that all integers are variable length encoded
+    /*! @ingroup Internal */
+    static const std::uint8_t encode_integers_flag = 0x01;
+
+    //! Checks if T is an integer type that may be variable length encoded
+    /*! Single byte types and bool gain nothing from encoding, so they are
+        always written as is.
+        @ingroup Internal */
+    template <class T>
+    struct is_varint_candidate : std::integral_constant<bool,
+      std::is_integral<T>::value && (sizeof(T) > 1) && !std::is_same<T, bool>::value> {};
+  } // namespace compact_binary_detail
+
+  // ######################################################################
+  //! An output archive designed to save data in a small binary representation
+  /*! This archive is identical to BinaryOutputArchive except that all size
+      metadata (see SizeTag), such as container and string lengths, is written
+      using unsigned LEB128 variable length encoding.  A container with fewer than
+      128 elements thus needs a single byte to store its size instead of eight.
+
+      Optionally, all integers larger than a byte can also be variable length encoded,
+      with signed integers first zigzag encoded so that small negative numbers stay
+      small.  Integers that are serialized as part of a block of binary data, such as
+      a std::vector<int>, are not affected and are still written as is.
+
+      A single byte header records which options were used, so CompactBinaryInputArchive
+      does not need to be told how the data was written.
+
+      This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      \ingroup Archives */
+  class CompactBinaryOutputArchive : public OutputArchive<CompactBinaryOutputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! A class containing various advanced options for the compact binary archive
+      class Options
+      {
+        public:
+          //! Default options, only size metadata is variable length encoded
+          static Options Default(){ return Options(); }
+
+          //! Variable length encode all integers larger than a byte
+          static Options AllIntegers(){ return Options( true ); }
+
+          //! Specify specific options for the CompactBinaryOutputArchive
+          /*! @param encodeIntegers Whether integers other than size metadata should be
+                                    variable length encoded */
+          explicit Options( bool encodeIntegers = false ) :
+            itsEncodeIntegers( encodeIntegers ) { }
+
+        private:
+          friend class CompactBinaryOutputArchive;
+          bool itsEncodeIntegers;
+      };
+
+      //! Construct, outputting to the provided stream
+      /*! @param stream The stream to output to.  Can be a stringstream, a file stream, or
+                        even cout!
+          @param options The compact binary specific options to use.  See the Options struct
+                         for the values of default parameters */
+      CompactBinaryOutputArchive(std::ostream & stream, Options const & options = Options::Default()) :
+        OutputArchive<CompactBinaryOutputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream),
+        itsEncodeIntegers(options.itsEncodeIntegers)
+      {
+        std::uint8_t const header = itsEncodeIntegers ? compact_binary_detail::encode_integers_flag : 0;
+        saveBinary( &header, sizeof(header) );
+      }
+
+      //! Writes size bytes of data to the output stream
+      void saveBinary( const void * data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        auto const writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
+
+        if(writtenSize != size)
+          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+      }
+
+      //! Writes a value using unsigned LEB128 encoding
+      void saveVarint( std::uint64_t value )
+      {
+        std::uint8_t buffer[compact_binary_detail::max_varint_size];
+        saveBinary( buffer, compact_binary_detail::encode_varint( value, buffer ) );
+      }
+
+      //! Whether integers other than size metadata are variable length encoded
+      bool encodesIntegers() const
+      {
+        return itsEncodeIntegers;
+      }
+
+    private:
+      std::ostream & itsStream;
+      bool itsEncodeIntegers;
+  };
+
+  // ######################################################################
+  //! An input archive designed to load data saved using CompactBinaryOutputArchive
+  /*! This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      \ingroup Archives */
+  class CompactBinaryInputArchive : public InputArchive<CompactBinaryInputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, loading from the provided stream
+      CompactBinaryInputArchive(std::istream & stream) :
+        InputArchive<CompactBinaryInputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream),
+        itsEncodeIntegers(false)
+      {
+        std::uint8_t header;
+        loadBinary( &header, sizeof(header) );
+        itsEncodeIntegers = ( header & compact_binary_detail::encode_integers_flag ) != 0;
+      }
+
+      //! Reads size bytes of data from the input stream
+      void loadBinary( void * const data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        auto const readSize = static_cast<std::size_t>( itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size ) );
+
+        if(readSize != size)
+          throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+      }
+
+      //! Reads an unsigned LEB128 encoded value
+      /*! Values smaller than 128, which make up the vast majority of size metadata,
+          take a single branch to decode. */
+      std::uint64_t loadVarint()
+      {
+        auto const c = itsStream.rdbuf()->sbumpc();
+
+        // end of file is negative and becomes very large, falling through to the slow path
+        if( static_cast<unsigned int>( c ) < 0x80 )
+          return static_cast<std::uint64_t>( c );
+
+        return loadVarintSlow( c );
+      }
+
+      //! Whether integers other than size metadata are variable length encoded
+      bool encodesIntegers() const
+      {
+        return itsEncodeIntegers;
+      }
+
+    private:
+      //! Decodes the remainder of a multi-byte varint
+      std::uint64_t loadVarintSlow( std::istream::int_type c )
+      {
+        using traits_type = std::istream::traits_type;
+
+        std::uint64_t value = 0;
+        for( unsigned int shift = 0; shift < 64; shift += 7 )
+        {
+          if( traits_type::eq_int_type( c, traits_type::eof() ) )
+            throw Exception("Failed to read variable length integer from input stream!");
+
+          value |= static_cast<std::uint64_t>( c & 0x7F ) << shift;
+          if( ( c & 0x80 ) == 0 )
+            return value;
+
+          c = itsStream.rdbuf()->sbumpc();
+        }
+
+        throw Exception("Variable length integer in input stream is longer than 64 bits!");
+      }
+
+      std::istream & itsStream;
+      bool itsEncodeIntegers;
+  };
+
+  // ######################################################################
+  // Common CompactBinaryArchive serialization functions
+
+  //! Saving for POD types that are never variable length encoded
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value && !compact_binary_detail::is_varint_candidate<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Loading for POD types that are never variable length encoded
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value && !compact_binary_detail::is_varint_candidate<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive & ar, T & t)
+  {
+    ar.loadBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Saving for unsigned integers, variable length encoded if requested
+  template<class T> inline
+  typename std::enable_if<compact_binary_detail::is_varint_candidate<T>::value && std::is_unsigned<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive & ar, T const & t)
+  {
+    if( ar.encodesIntegers() )
+      ar.saveVarint( static_cast<std::uint64_t>( t ) );
+    else
+      ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Loading for unsigned integers, variable length encoded if requested
+  template<class T> inline
+  typename std::enable_if<compact_binary_detail::is_varint_candidate<T>::value && std::is_unsigned<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive & ar, T & t)
+  {
+    if( ar.encodesIntegers() )
+    {
+      auto const value = ar.loadVarint();
+      if( value > std::numeric_limits<T>::max() )
+        throw Exception("Variable length integer in input stream is too large for its type!");
+      t = static_cast<T>( value );
+    }
+    else
+      ar.loadBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Saving for signed integers, zigzag and variable length encoded if requested
+  template<class T> inline
+  typename std::enable_if<compact_binary_detail::is_varint_candidate<T>::value && std::is_signed<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive & ar, T const & t)
+  {
+    if( ar.encodesIntegers() )
+      ar.saveVarint( compact_binary_detail::zigzag_encode( static_cast<std::int64_t>( t ) ) );
+    else
+      ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Loading for signed integers, zigzag and variable length encoded if requested
+  template<class T> inline
+  typename std::enable_if<compact_binary_detail::is_varint_candidate<T>::value && std::is_signed<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive & ar, T & t)
+  {
+    if( ar.encodesIntegers() )
+    {
+      auto const value = compact_binary_detail::zigzag_decode( ar.loadVarint() );
+      if( value > std::numeric_limits<T>::max() || value < std::numeric_limits<T>::min() )
+        throw Exception("Variable length integer in input stream is too large for its type!");
+      t = static_cast<T>( value );
+    }
+    else
+      ar.loadBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to compact binary
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(CompactBinaryInputArchive, CompactBinaryOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Saving SizeTags to compact binary, always variable length encoded
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive & ar, SizeTag<T> const & t)
+  {
+    ar.saveVarint( static_cast<std::uint64_t>( t.size ) );
+  }
+
+  //! Loading SizeTags from compact binary, always variable length encoded
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive & ar, SizeTag<T> & t)
+  {
+    t.size = static_cast<typename std::decay<T>::type>( ar.loadVarint() );
+  }
+
+  //! Saving binary data
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+
+  //! Loading binary data
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive & ar, BinaryData<T> & bd)
+  {
+    ar.loadBinary(bd.data, static_cast<std::size_t>(bd.size));
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::CompactBinaryOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::CompactBinaryInputArchive)
+
+// tie input and output archives together
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive)
+
+#endif // CEREAL_ARCHIVES_COMPACT_BINARY_HPP_
@@ -0,0 +1,825 @@
+/*! \file compressed_binary.hpp
+    \brief Binary input and output archives that compress their output in frames */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_COMPRESSED_BINARY_HPP_
+#define CEREAL_ARCHIVES_COMPRESSED_BINARY_HPP_
+
+#include <cereal/cereal.hpp>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace cereal
+{
+  // ######################################################################
+  //! Interface for the block compression used by the compressed binary archives
+  /*! A codec compresses and decompresses independent blocks of data.  The
+      archives call into the codec once per frame, so the cost of the virtual
+      dispatch is negligible.
+
+      To use a different compression library, such as zstd or the reference LZ4
+      implementation, derive from this class:
+
+      @code{.cpp}
+      struct ZstdCodec : public cereal::CompressionCodec
+      {
+        std::size_t maxCompressedSize( std::size_t size ) const override
+        { return ZSTD_compressBound( size ); }
+
+        std::size_t compress( const char * src, std::size_t srcSize, char * dst, std::size_t dstCapacity ) override
+        { return ZSTD_compress( dst, dstCapacity, src, srcSize, 3 ); }
+
+        void decompress( const char * src, std::size_t srcSize, char * dst, std::size_t dstSize ) override
+        {
+          if( ZSTD_decompress( dst, dstSize, src, srcSize ) != dstSize )
+            throw cereal::Exception("Corrupt zstd frame");
+        }
+      };
+      @endcode
+
+      A single codec instance is not required to be thread safe and should not be
+      shared between archives used concurrently.
+
+      @ingroup Utility */
+  class CompressionCodec
+  {
+    public:
+      virtual ~CompressionCodec() {}
+
+      //! Returns the largest number of bytes compress can produce for size bytes of input
+      virtual std::size_t maxCompressedSize( std::size_t size ) const = 0;
+
+      //! Compresses a block of data
+      /*! @param src The data to compress
+          @param srcSize The number of bytes to compress
+          @param dst The buffer to compress into, of at least maxCompressedSize( srcSize ) bytes
+          @param dstCapacity The size of dst
+          @return The compressed size, in bytes */
+      virtual std::size_t compress( const char * src, std::size_t srcSize, char * dst, std::size_t dstCapacity ) = 0;
+
+      //! Decompresses a block of data
+      /*! @param src The compressed data
+          @param srcSize The number of compressed bytes
+          @param dst The buffer to decompress into
+          @param dstSize The exact number of bytes the data decompresses to
+          @throw Exception if the data is corrupt */
+      virtual void decompress( const char * src, std::size_t srcSize, char * dst, std::size_t dstSize ) = 0;
+
+      //! Identifies the dictionary the codec compresses against, or 0 if it uses none
+      /*! The compressed binary archives record a nonzero id at the start of the stream,
+          and check that the codec loading it has the same one. */
+      virtual std::uint32_t dictionaryId() const { return 0; }
+  };
+
+  // ######################################################################
+  //! Content shared by both sides of a connection that small blocks are compressed against
+  /*! A block of a few hundred bytes holds too little repetition to compress well on its
+      own, but a stream of such blocks, like the messages of an RPC protocol, repeats the
+      same field layouts, names, and common values from one block to the next.  A
+      dictionary is a sample of that shared content.  Codecs that support it, such as
+      LZ4BlockCodec, compress each block as if it followed the dictionary, so that its
+      repeated parts become references into the dictionary.
+
+      A dictionary is built with train from a set of typical blocks, such as archives
+      saved by the application, and then distributed to readers and writers alike.  Its
+      id, which defaults to a hash of its contents, is recorded with compressed data so
+      that data is never decoded with the wrong dictionary.
+
+      @code{.cpp}
+      std::vector<std::string> samples = collectSampleMessages();
+      auto dictionary = std::make_shared<cereal::CompressionDictionary>( cereal::CompressionDictionary::train( samples ) );
+      store( dictionary->id(), dictionary->content() );
+
+      cereal::CompressedBinaryOutputArchive ar( stream,
+        cereal::CompressedBinaryOutputArchive::Options( std::make_shared<cereal::LZ4BlockCodec>( dictionary ) ) );
+      @endcode
+
+      @ingroup Utility */
+  class CompressionDictionary
+  {
+    public:
+      //! The largest useful dictionary, since LZ4 matches reach back at most this far
+      static const std::size_t max_size = 65535;
+
+      //! Creates a dictionary from its content
+      /*! @param content The dictionary, of which at most the last max_size bytes are used
+          @param id The id recorded with compressed data.  If 0, a hash of the content is used */
+      explicit CompressionDictionary( std::string content, std::uint32_t id = 0 ) :
+        itsContent( content.size() > max_size ? content.substr( content.size() - max_size ) : std::move( content ) ),
+        itsId( id ? id : hashId( itsContent ) )
+      { }
+
+      //! The bytes of the dictionary
+      std::string const & content() const { return itsContent; }
+
+      //! The id recorded with data compressed against the dictionary, never 0
+      std::uint32_t id() const { return itsId; }
+
+      //! Builds a dictionary from typical blocks of data
+      /*! Every sequence of 8 bytes is scored by the number of samples it occurs in, and
+          the segments of the samples with the highest total score are added to the
+          dictionary until it is full.  The sequences of a chosen segment no longer
+          count towards later ones, so the dictionary covers as much distinct shared
+          content as possible.  Content that is found in a single sample is never added.
+
+          A few hundred to a few thousand samples of the data to be compressed are
+          usually enough.
+
+          @param samples Typical blocks of data, such as saved archives
+          @param capacity The largest size of the dictionary, in bytes
+          @param id The id of the dictionary.  If 0, a hash of its content is used */
+      static CompressionDictionary train( std::vector<std::string> const & samples, std::size_t capacity = 16 * 1024, std::uint32_t id = 0 )
+      {
+        if( capacity > max_size )
+          capacity = max_size;
+
+        // Number every distinct sequence and count the samples holding each
+        std::unordered_map<std::uint64_t, std::uint32_t> indices;
+        std::vector<std::uint32_t> counts;
+        std::vector<std::vector<std::uint32_t>> sequences( samples.size() );
+        for( std::size_t s = 0; s < samples.size(); ++s )
+        {
+          auto const & sample = samples[s];
+          if( sample.size() < sequence_size )
+            continue;
+
+          std::unordered_set<std::uint32_t> seen;
+          for( std::size_t pos = 0; pos + sequence_size <= sample.size(); ++pos )
+          {
+            std::uint64_t key;
+            std::memcpy( &key, sample.data() + pos, sizeof(key) );
+
+            auto const index = indices.emplace( key, static_cast<std::uint32_t>( counts.size() ) ).first->second;
+            if( index == counts.size() )
+              counts.push_back( 0 );
+            if( seen.insert( index ).second )
+              ++counts[index];
+            sequences[s].push_back( index );
+          }
+        }
+
+        // Sequences held by a single sample are of no use to other blocks
+        for( auto & count : counts )
+          if( count < 2 )
+            count = 0;
+
+        std::string content;
+        while( content.size() + segment_size <= capacity )
+        {
+          std::uint64_t bestScore = 0;
+          std::size_t bestSample = 0, bestPos = 0;
+
+          for( std::size_t s = 0; s < samples.size(); ++s )
+          {
+            auto const & seq = sequences[s];
+            auto const window = std::min( seq.size(), segment_size - sequence_size + 1 );
+            if( window == 0 )
+              continue;
+
+            std::uint64_t score = 0;
+            for( std::size_t i = 0; i < window; ++i )
+              score += counts[seq[i]];
+
+            for( std::size_t pos = 0; ; ++pos )
+            {
+              if( score > bestScore )
+              {
+                bestScore = score;
+                bestSample = s;
+                bestPos = pos;
+              }
+
+              if( pos + window >= seq.size() )
+                break;
+              score += counts[seq[pos + window]];
+              score -= counts[seq[pos]];
+            }
+          }
+
+          if( bestScore == 0 )
+            break;
+
+          auto const & seq = sequences[bestSample];
+          auto const window = std::min( seq.size(), segment_size - sequence_size + 1 );
+          for( std::size_t i = bestPos; i < bestPos + window; ++i )
+            counts[seq[i]] = 0;
+
+          content.append( samples[bestSample], bestPos, window + sequence_size - 1 );
+        }
+
+        return CompressionDictionary( std::move( content ), id );
+      }
+
+    private:
+      static const std::size_t sequence_size = 8; //!< the length of the sequences that are scored
+      static const std::size_t segment_size = 64; //!< the length of the segments added to the dictionary
+
+      static std::uint32_t hashId( std::string const & content )
+      {
+        auto const hash = detail::hash_bytes( content.data(), content.size() );
+        auto const id = static_cast<std::uint32_t>( hash ^ ( hash >> 32 ) );
+        return id ? id : 1;
+      }
+
+      std::string itsContent;
+      std::uint32_t itsId;
+  };
+
+  // ######################################################################
+  //! A fast LZ77 codec producing the LZ4 block format
+  /*! This is a small, dependency free implementation of the LZ4 block format, so
+      frames it produces can also be decoded with LZ4_decompress_safe from the
+      reference LZ4 library.  It favors speed over compression ratio.
+
+      Given a CompressionDictionary, every block is compressed as if it followed the
+      dictionary, which is what LZ4_decompress_safe_usingDict expects.  The positions
+      of the dictionary are hashed once, when the codec is created.
+
+      @ingroup Utility */
+  class LZ4BlockCodec : public CompressionCodec
+  {
+    public:
+      //! Creates a codec, optionally compressing against a dictionary
+      explicit LZ4BlockCodec( std::shared_ptr<const CompressionDictionary> dictionary = nullptr ) :
+        itsTable( table_size ),
+        itsDictionary( std::move( dictionary ) )
+      {
+        if( !itsDictionary )
+          return;
+
+        auto const & content = itsDictionary->content();
+        itsWindow.assign( content.begin(), content.end() );
+
+        itsDictionaryTable.resize( table_size );
+        auto const in = reinterpret_cast<const std::uint8_t *>( content.data() );
+        for( std::size_t pos = 0; pos + sizeof(std::uint32_t) <= content.size(); ++pos )
+          itsDictionaryTable[hash( in + pos )] = static_cast<std::uint32_t>( pos );
+      }
+
+      std::uint32_t dictionaryId() const override
+      {
+        return itsDictionary ? itsDictionary->id() : 0;
+      }
+
+      std::size_t maxCompressedSize( std::size_t size ) const override
+      {
+        return size + size / 255 + 16;
+      }
+
+      std::size_t compress( const char * src, std::size_t srcSize, char * dst, std::size_t dstCapacity ) override
+      {
+        if( dstCapacity < maxCompressedSize( srcSize ) )
+          throw Exception("Insufficient space to compress block");
+
+        // With a dictionary, the block is compressed at the end of a window that starts with it
+        std::size_t start = 0;
+        if( itsDictionary )
+        {
+          start = itsDictionary->content().size();
+          itsWindow.resize( start + srcSize );
+          std::memcpy( itsWindow.data() + start, src, srcSize );
+          src = itsWindow.data();
+          srcSize += start;
+        }
+
+        auto const in = reinterpret_cast<const std::uint8_t *>( src );
+        auto out = reinterpret_cast<std::uint8_t *>( dst );
+
+        std::size_t anchor = start; // start of pending literals
+        if( srcSize - start >= min_input )
+        {
+          if( itsDictionary )
+            std::copy( itsDictionaryTable.begin(), itsDictionaryTable.end(), itsTable.begin() );
+          else
+            std::fill( itsTable.begin(), itsTable.end(), 0 );
+          std::uint32_t * const table = itsTable.data();
+
+          std::size_t const matchLimit = srcSize - last_literals;
+          std::size_t pos = start + 1;
+          table[hash( in + start )] = static_cast<std::uint32_t>( start );
+
+          while( pos < srcSize - min_input )
+          {
+            std::uint32_t const h = hash( in + pos );
+            std::size_t const candidate = table[h];
+            table[h] = static_cast<std::uint32_t>( pos );
+
+            if( pos - candidate > max_offset || read32( in + candidate ) != read32( in + pos ) )
+            {
+              ++pos;
+              continue;
+            }
+
+            // extend the match as far as allowed
+            std::size_t length = min_match;
+            while( pos + length < matchLimit && in[candidate + length] == in[pos + length] )
+              ++length;
+
+            out = writeSequence( out, in + anchor, pos - anchor, pos - candidate, length );
+            pos += length;
+            anchor = pos;
+
+            if( pos < srcSize - min_input )
+              table[hash( in + pos - 2 )] = static_cast<std::uint32_t>( pos - 2 );
+          }
+        }
+
+        // the final sequence is literals only
+        std::size_t const literals = srcSize - anchor;
+        out = writeLength( out, literals, 0 );
+        std::memcpy( out, in + anchor, literals );
+        out += literals;
+
+        return static_cast<std::size_t>( out - reinterpret_cast<std::uint8_t *>( dst ) );
+      }
+
+      void decompress( const char * src, std::size_t srcSize, char * dst, std::size_t dstSize ) override
+      {
+        if( !itsDictionary )
+        {
+          decompress( src, srcSize, reinterpret_cast<std::uint8_t *>( dst ), 0, dstSize );
+          return;
+        }
+
+        // Matches may reach back into the dictionary, which is kept at the start of the window
+        auto const start = itsDictionary->content().size();
+        itsWindow.resize( start + dstSize );
+        decompress( src, srcSize, reinterpret_cast<std::uint8_t *>( itsWindow.data() ), start, dstSize );
+        std::memcpy( dst, itsWindow.data() + start, dstSize );
+      }
+
+    private:
+      static const std::size_t table_bits = 12;
+      static const std::size_t table_size = std::size_t(1) << table_bits;
+      static const std::size_t min_match = 4;
+      static const std::size_t last_literals = 5;  //!< the block must end with at least this many literals
+      static const std::size_t min_input = 13;     //!< the last match must start this many bytes before the end
+      static const std::size_t max_offset = 65535;
+
+      //! Decompresses a block into a window, after start bytes that matches may refer to
+      void decompress( const char * src, std::size_t srcSize, std::uint8_t * window, std::size_t start, std::size_t dstSize )
+      {
+        auto in = reinterpret_cast<const std::uint8_t *>( src );
+        auto const inEnd = in + srcSize;
+        auto out = window + start;
+        auto const outBegin = window;
+        auto const outEnd = out + dstSize;
+
+        while( in < inEnd )
+        {
+          std::uint8_t const token = *in++;
+
+          std::size_t literals = token >> 4;
+          if( literals == 15 )
+            literals += readLength( in, inEnd );
+
+          if( static_cast<std::size_t>( inEnd - in ) < literals || static_cast<std::size_t>( outEnd - out ) < literals )
+            throw Exception("Corrupt LZ4 block: literals out of bounds");
+
+          std::memcpy( out, in, literals );
+          in += literals;
+          out += literals;
+
+          if( in == inEnd )
+            break; // last sequence has no match
+
+          if( inEnd - in < 2 )
+            throw Exception("Corrupt LZ4 block: truncated offset");
+
+          std::size_t const offset = static_cast<std::size_t>( in[0] ) | ( static_cast<std::size_t>( in[1] ) << 8 );
+          in += 2;
+
+          std::size_t length = token & 15;
+          if( length == 15 )
+            length += readLength( in, inEnd );
+          length += min_match;
+
+          if( offset == 0 || static_cast<std::size_t>( out - outBegin ) < offset || static_cast<std::size_t>( outEnd - out ) < length )
+            throw Exception("Corrupt LZ4 block: match out of bounds");
+
+          // matches may overlap their own output, so copy bytewise
+          const std::uint8_t * match = out - offset;
+          for( std::size_t i = 0; i < length; ++i )
+            out[i] = match[i];
+          out += length;
+        }
+
+        if( out != outEnd )
+          throw Exception("Corrupt LZ4 block: decompressed size mismatch");
+      }
+
+      static std::uint32_t read32( const std::uint8_t * p )
+      {
+        std::uint32_t v;
+        std::memcpy( &v, p, sizeof(v) );
+        return v;
+      }
+
+      static std::uint32_t hash( const std::uint8_t * p )
+      {
+        return ( read32( p ) * 2654435761U ) >> ( 32 - table_bits );
+      }
+
+      //! Writes the token and literals for a sequence followed by its match
+      static std::uint8_t * writeSequence( std::uint8_t * out, const std::uint8_t * literals, std::size_t numLiterals,
+                                           std::size_t offset, std::size_t matchLength )
+      {
+        std::uint8_t * token = out;
+        out = writeLength( out, numLiterals, 0 );
+        std::memcpy( out, literals, numLiterals );
+        out += numLiterals;
+
+        *out++ = static_cast<std::uint8_t>( offset & 0xFF );
+        *out++ = static_cast<std::uint8_t>( offset >> 8 );
+
+        std::size_t const length = matchLength - min_match;
+        if( length >= 15 )
+        {
+          *token |= 15;
+          out = writeExtraLength( out, length - 15 );
+        }
+        else
+          *token |= static_cast<std::uint8_t>( length );
+
+        return out;
+      }
+
+      //! Writes a token with the given literal count, followed by any extra length bytes
+      static std::uint8_t * writeLength( std::uint8_t * out, std::size_t literals, std::uint8_t low )
+      {
+        if( literals >= 15 )
+        {
+          *out++ = static_cast<std::uint8_t>( 15 << 4 | low );
+          return writeExtraLength( out, literals - 15 );
+        }
+
+        *out++ = static_cast<std::uint8_t>( literals << 4 | low );
+        return out;
+      }
+
+      static std::uint8_t * writeExtraLength( std::uint8_t * out, std::size_t length )
+      {
+        for( ; length >= 255; length -= 255 )
+          *out++ = 255;
+        *out++ = static_cast<std::uint8_t>( length );
+        return out;
+      }
+
+      static std::size_t readLength( const std::uint8_t * & in, const std::uint8_t * inEnd )
+      {
+        std::size_t length = 0;
+        std::uint8_t b;
+        do
+        {
+          if( in == inEnd )
+            throw Exception("Corrupt LZ4 block: truncated length");
+          b = *in++;
+          length += b;
+        } while( b == 255 );
+        return length;
+      }
+
+      std::vector<std::uint32_t> itsTable; //!< positions of recently seen 4 byte sequences
+      std::shared_ptr<const CompressionDictionary> itsDictionary; //!< the dictionary blocks follow, may be null
+      std::vector<std::uint32_t> itsDictionaryTable;              //!< positions of the sequences in the dictionary
+      std::vector<char> itsWindow;                                //!< the dictionary followed by the current block
+  };
+
+  namespace compressed_binary_detail
+  {
+    //! Header preceding every frame in a compressed binary archive
+    /*! A frame whose stored size equals its raw size holds uncompressed data.
+        Since frames are independent, a reader can skip through a stream using only
+        the headers and decompress frames in parallel.
+        @ingroup Internal */
+    struct FrameHeader
+    {
+      std::uint32_t rawSize;    //!< size of the frame once decompressed
+      std::uint32_t storedSize; //!< number of bytes following the header
+    };
+  }
+
+  // ######################################################################
+  //! An output archive that compresses the BinaryOutputArchive representation in frames
+  /*! Data passed to saveBinary is accumulated into a frame sized buffer.  Whenever
+      that buffer fills up (and when the archive is destroyed or flushed) it is
+      compressed with the archive's CompressionCodec and written to the stream as
+      a single independent frame, so the stream itself sees one large write per frame
+      rather than one small write per value.
+
+      Each frame is preceded by its uncompressed and compressed sizes.  Frames that do
+      not compress are stored as is.  If the codec compresses against a dictionary,
+      the stream starts with the id of the dictionary, as a 32 bit integer.
+
+      This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      \ingroup Archives */
+  class CompressedBinaryOutputArchive : public OutputArchive<CompressedBinaryOutputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! A class containing various advanced options for the compressed binary archive
+      class Options
+      {
+        public:
+          //! Default options, using LZ4BlockCodec with 1MB frames
+          static Options Default(){ return Options(); }
+
+          //! Specify specific options for the CompressedBinaryOutputArchive
+          /*! @param codec The codec to compress frames with.  If null, LZ4BlockCodec is used.
+              @param frameSize The amount of uncompressed data to accumulate per frame */
+          explicit Options( std::shared_ptr<CompressionCodec> codec = nullptr,
+                            std::size_t frameSize = 1 << 20 ) :
+            itsCodec( codec ? std::move( codec ) : std::make_shared<LZ4BlockCodec>() ),
+            itsFrameSize( std::max<std::size_t>( frameSize, 1 ) ) { }
+
+        private:
+          friend class CompressedBinaryOutputArchive;
+          std::shared_ptr<CompressionCodec> itsCodec;
+          std::size_t itsFrameSize;
+      };
+
+      //! Construct, outputting to the provided stream
+      /*! @param stream The stream to output to.
+          @param options The compressed binary specific options to use.  See the Options struct
+                         for the values of default parameters */
+      CompressedBinaryOutputArchive(std::ostream & stream, Options const & options = Options::Default()) :
+        OutputArchive<CompressedBinaryOutputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream),
+        itsCodec(options.itsCodec),
+        itsFrame(options.itsFrameSize),
+        itsFrameUsed(0)
+      {
+        std::uint32_t const dictionaryId = itsCodec->dictionaryId();
+        if( dictionaryId )
+          write( &dictionaryId, sizeof(dictionaryId) );
+      }
+
+      //! Compresses and writes any buffered data
+      /*! Errors cannot be reported here, so call flush first to find out whether the
+          last frame was written */
+      ~CompressedBinaryOutputArchive()
+      {
+        try { flush(); } catch( ... ) {}
+      }
+
+      //! Buffers size bytes of data, writing out frames as they fill
+      void saveBinary( const void * data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        // fast path: fits in the current frame
+        if( itsFrame.size() - itsFrameUsed >= size )
+        {
+          std::memcpy( itsFrame.data() + itsFrameUsed, data, size );
+          itsFrameUsed += size;
+          return;
+        }
+
+        auto src = static_cast<const char *>( data );
+        while( size > 0 )
+        {
+          auto const n = std::min( size, itsFrame.size() - itsFrameUsed );
+          std::memcpy( itsFrame.data() + itsFrameUsed, src, n );
+          itsFrameUsed += n;
+          src += n;
+          size -= n;
+
+          if( itsFrameUsed == itsFrame.size() )
+            flush();
+        }
+      }
+
+      //! Compresses and writes any buffered data as a frame
+      /*! The destructor also flushes, but can not report errors, so call this once
+          everything is saved to find out whether the output is complete.  A frame that
+          fails to be written is dropped rather than written again.
+          @throws Exception if the frame can not be compressed or written */
+      void flush()
+      {
+        if( itsFrameUsed == 0 )
+          return;
+
+        auto const used = itsFrameUsed;
+        itsFrameUsed = 0;
+
+        itsCompressed.resize( itsCodec->maxCompressedSize( used ) );
+        auto const compressedSize = itsCodec->compress( itsFrame.data(), used, itsCompressed.data(), itsCompressed.size() );
+
+        compressed_binary_detail::FrameHeader header;
+        header.rawSize = static_cast<std::uint32_t>( used );
+
+        if( compressedSize < used )
+        {
+          header.storedSize = static_cast<std::uint32_t>( compressedSize );
+          write( &header, sizeof(header) );
+          write( itsCompressed.data(), compressedSize );
+        }
+        else
+        {
+          header.storedSize = header.rawSize;
+          write( &header, sizeof(header) );
+          write( itsFrame.data(), used );
+        }
+      }
+
+    private:
+      void write( const void * data, std::size_t size )
+      {
+        auto const writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
+
+        if(writtenSize != size)
+          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+      }
+
+      std::ostream & itsStream;
+      std::shared_ptr<CompressionCodec> itsCodec;
+      std::vector<char> itsFrame;      //!< uncompressed data for the current frame
+      std::size_t itsFrameUsed;        //!< bytes of itsFrame holding data
+      std::vector<char> itsCompressed; //!< scratch space for compression
+  };
+
+  // ######################################################################
+  //! An input archive designed to load data saved using CompressedBinaryOutputArchive
+  /*! Frames are read and decompressed one at a time as data is requested.  The
+      codec must match the one used to write the data, including its dictionary.
+      A reader that holds several dictionaries can find the one a stream needs from
+      its first four bytes before creating the archive.
+
+      \ingroup Archives */
+  class CompressedBinaryInputArchive : public InputArchive<CompressedBinaryInputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, loading from the provided stream
+      /*! @param stream The stream to read from
+          @param codec The codec to decompress frames with.  If null, LZ4BlockCodec is used.
+          @throw Exception if the stream was written with a different dictionary */
+      CompressedBinaryInputArchive(std::istream & stream, std::shared_ptr<CompressionCodec> codec = nullptr) :
+        InputArchive<CompressedBinaryInputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream),
+        itsCodec( codec ? std::move( codec ) : std::make_shared<LZ4BlockCodec>() ),
+        itsFramePos(0)
+      {
+        std::uint32_t const expected = itsCodec->dictionaryId();
+        if( expected )
+        {
+          std::uint32_t dictionaryId;
+          read( &dictionaryId, sizeof(dictionaryId), sizeof(dictionaryId) );
+          if( dictionaryId != expected )
+            throw Exception("Compressed binary archive was written with dictionary " + std::to_string( dictionaryId ) +
+                            " but is loaded with dictionary " + std::to_string( expected ));
+        }
+      }
+
+      //! Reads size bytes of data, decompressing frames as needed
+      void loadBinary( void * const data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        // fast path: available in the current frame
+        if( itsFrame.size() - itsFramePos >= size )
+        {
+          std::memcpy( data, itsFrame.data() + itsFramePos, size );
+          itsFramePos += size;
+          return;
+        }
+
+        auto dst = static_cast<char *>( data );
+        while( size > 0 )
+        {
+          if( itsFramePos == itsFrame.size() )
+            readFrame( size );
+
+          auto const n = std::min( size, itsFrame.size() - itsFramePos );
+          std::memcpy( dst, itsFrame.data() + itsFramePos, n );
+          itsFramePos += n;
+          dst += n;
+          size -= n;
+        }
+      }
+
+    private:
+      //! Reads and decompresses the next frame
+      /*! @param wanted The number of bytes the caller is waiting on, for error reporting */
+      void readFrame( std::size_t wanted )
+      {
+        compressed_binary_detail::FrameHeader header;
+        read( &header, sizeof(header), wanted );
+
+        if( header.storedSize > header.rawSize || header.rawSize == 0 )
+          throw Exception("Corrupt frame header in compressed binary archive");
+
+        itsFrame.resize( header.rawSize );
+        itsFramePos = 0;
+
+        if( header.storedSize == header.rawSize )
+          read( itsFrame.data(), header.rawSize, wanted );
+        else
+        {
+          itsCompressed.resize( header.storedSize );
+          read( itsCompressed.data(), header.storedSize, wanted );
+          itsCodec->decompress( itsCompressed.data(), header.storedSize, itsFrame.data(), header.rawSize );
+        }
+      }
+
+      void read( void * data, std::size_t size, std::size_t wanted )
+      {
+        auto const readSize = static_cast<std::size_t>( itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size ) );
+
+        if(readSize != size)
+          throw Exception("Failed to read " + std::to_string(wanted) + " bytes from input stream! Frame is truncated or missing");
+      }
+
+      std::istream & itsStream;
+      std::shared_ptr<CompressionCodec> itsCodec;
+      std::vector<char> itsFrame;      //!< decompressed data for the current frame
+      std::size_t itsFramePos;         //!< next byte of itsFrame to be read
+      std::vector<char> itsCompressed; //!< scratch space for decompression
+  };
+
+  // ######################################################################
+  // Common CompressedBinaryArchive serialization functions
+
+  //! Saving for POD types to compressed binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(CompressedBinaryOutputArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Loading for POD types from compressed binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(CompressedBinaryInputArchive & ar, T & t)
+  {
+    ar.loadBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to compressed binary
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(CompressedBinaryInputArchive, CompressedBinaryOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Serializing SizeTags to compressed binary
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(CompressedBinaryInputArchive, CompressedBinaryOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, SizeTag<T> & t )
+  {
+    ar( t.size );
+  }
+
+  //! Saving binary data to compressed binary
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(CompressedBinaryOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+
+  //! Loading binary data from compressed binary
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(CompressedBinaryInputArchive & ar, BinaryData<T> & bd)
+  {
+    ar.loadBinary(bd.data, static_cast<std::size_t>(bd.size));
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::CompressedBinaryOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::CompressedBinaryInputArchive)
+
+// tie input and output archives together
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::CompressedBinaryInputArchive, cereal::CompressedBinaryOutputArchive)
+
+#endif // CEREAL_ARCHIVES_COMPRESSED_BINARY_HPP_
@@ -0,0 +1,646 @@
+/*! \file direct_file.hpp
+    \brief Stream buffers for reading and writing large files with unbuffered, overlapped I/O */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_DIRECT_FILE_HPP_
+#define CEREAL_ARCHIVES_DIRECT_FILE_HPP_
+
+#include <cereal/details/helpers.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <cerrno>
+  #include <fcntl.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace cereal
+{
+  namespace direct_file_detail
+  {
+    //! The alignment of buffers, file offsets and transfer sizes required for unbuffered I/O
+    /*! @ingroup Internal */
+    static const std::size_t alignment = 4096;
+
+    //! Rounds size up to a nonzero multiple of alignment
+    /*! @ingroup Internal */
+    inline std::size_t aligned_size( std::size_t size )
+    {
+      return size == 0 ? alignment : ( size + alignment - 1 ) / alignment * alignment;
+    }
+
+    //! Builds an error message for a failed file operation
+    /*! @ingroup Internal */
+    inline std::string error_message( std::string const & what, std::string const & path )
+    {
+      #ifdef _WIN32
+      return what + " '" + path + "' (error " + std::to_string( GetLastError() ) + ")";
+      #else
+      return what + " '" + path + "' (" + std::strerror( errno ) + ")";
+      #endif
+    }
+
+    //! A file that is read or written at explicit offsets, bypassing the page cache where possible
+    /*! Reads and writes may be issued from several threads at once.
+        @ingroup Internal */
+    class File
+    {
+      public:
+        //! Opens path for reading, or creates it for writing
+        /*! @param direct Whether to bypass the page cache.  Set to false if the file
+                          system does not support it, in which case normal I/O is used */
+        File( std::string const & path, bool write, bool & direct ) : itsOpen(false)
+        {
+          #ifdef _WIN32
+          DWORD const access = write ? GENERIC_WRITE : GENERIC_READ;
+          DWORD const creation = write ? CREATE_ALWAYS : OPEN_EXISTING;
+          itsFile = INVALID_HANDLE_VALUE;
+          if( direct )
+            itsFile = CreateFileA( path.c_str(), access, FILE_SHARE_READ, nullptr, creation, FILE_FLAG_NO_BUFFERING, nullptr );
+          if( itsFile == INVALID_HANDLE_VALUE )
+          {
+            direct = false;
+            itsFile = CreateFileA( path.c_str(), access, FILE_SHARE_READ, nullptr, creation, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+          }
+          if( itsFile == INVALID_HANDLE_VALUE )
+            throw Exception( error_message( "Failed to open", path ) );
+          #else
+          int const flags = write ? O_WRONLY | O_CREAT | O_TRUNC : O_RDONLY;
+          itsFile = -1;
+          #ifdef O_DIRECT
+          if( direct )
+            itsFile = ::open( path.c_str(), flags | O_DIRECT, 0644 );
+          #endif
+          if( itsFile < 0 )
+          {
+            // not every file system supports O_DIRECT, tmpfs for one
+            itsFile = ::open( path.c_str(), flags, 0644 );
+            #ifdef F_NOCACHE
+            if( itsFile >= 0 && direct )
+              direct = ::fcntl( itsFile, F_NOCACHE, 1 ) == 0;
+            #else
+            direct = false;
+            #endif
+          }
+          if( itsFile < 0 )
+            throw Exception( error_message( "Failed to open", path ) );
+          #endif
+          itsOpen = true;
+        }
+
+        ~File()
+        {
+          close();
+        }
+
+        File( File const & ) = delete;
+        File & operator=( File const & ) = delete;
+
+        //! The size of the file in bytes
+        std::uint64_t size() const
+        {
+          #ifdef _WIN32
+          LARGE_INTEGER size;
+          return GetFileSizeEx( itsFile, &size ) ? static_cast<std::uint64_t>( size.QuadPart ) : 0;
+          #else
+          struct stat info;
+          return ::fstat( itsFile, &info ) == 0 ? static_cast<std::uint64_t>( info.st_size ) : 0;
+          #endif
+        }
+
+        //! Writes all of size bytes at offset
+        bool write( const char * data, std::size_t size, std::uint64_t offset )
+        {
+          while( size > 0 )
+          {
+            #ifdef _WIN32
+            OVERLAPPED position = {};
+            position.Offset = static_cast<DWORD>( offset );
+            position.OffsetHigh = static_cast<DWORD>( offset >> 32 );
+            DWORD written = 0;
+            if( !WriteFile( itsFile, data, static_cast<DWORD>( size ), &written, &position ) || written == 0 )
+              return false;
+            #else
+            auto const written = ::pwrite( itsFile, data, size, static_cast<off_t>( offset ) );
+            if( written < 0 && errno == EINTR )
+              continue;
+            if( written <= 0 )
+              return false;
+            #endif
+            data += written;
+            size -= static_cast<std::size_t>( written );
+            offset += static_cast<std::uint64_t>( written );
+          }
+          return true;
+        }
+
+        //! Reads up to size bytes at offset
+        /*! @return The number of bytes read, which is less than size only at the end of
+                    the file, or -1 on an error */
+        std::ptrdiff_t read( char * data, std::size_t size, std::uint64_t offset )
+        {
+          std::size_t total = 0;
+          while( total < size )
+          {
+            #ifdef _WIN32
+            OVERLAPPED position = {};
+            position.Offset = static_cast<DWORD>( offset + total );
+            position.OffsetHigh = static_cast<DWORD>( ( offset + total ) >> 32 );
+            DWORD count = 0;
+            if( !ReadFile( itsFile, data + total, static_cast<DWORD>( size - total ), &count, &position ) )
+              return GetLastError() == ERROR_HANDLE_EOF ? static_cast<std::ptrdiff_t>( total ) : -1;
+            #else
+            auto const count = ::pread( itsFile, data + total, size - total, static_cast<off_t>( offset + total ) );
+            if( count < 0 && errno == EINTR )
+              continue;
+            if( count < 0 )
+              return -1;
+            #endif
+            if( count == 0 )
+              break;
+            total += static_cast<std::size_t>( count );
+          }
+          return static_cast<std::ptrdiff_t>( total );
+        }
+
+        //! Cuts the file down to size bytes, dropping the padding of the last block
+        bool truncate( std::uint64_t size )
+        {
+          #ifdef _WIN32
+          LARGE_INTEGER end;
+          end.QuadPart = static_cast<LONGLONG>( size );
+          return SetFilePointerEx( itsFile, end, nullptr, FILE_BEGIN ) && SetEndOfFile( itsFile );
+          #else
+          return ::ftruncate( itsFile, static_cast<off_t>( size ) ) == 0;
+          #endif
+        }
+
+        //! Closes the file, if it is open
+        void close()
+        {
+          if( !itsOpen )
+            return;
+
+          itsOpen = false;
+          #ifdef _WIN32
+          CloseHandle( itsFile );
+          #else
+          ::close( itsFile );
+          #endif
+        }
+
+      private:
+        #ifdef _WIN32
+        HANDLE itsFile;
+        #else
+        int itsFile;
+        #endif
+        bool itsOpen;
+    };
+
+    //! A ring of aligned buffers, each read or written by a pool of threads while the others are in use
+    /*! Buffers are submitted in order and complete in any order.  Keeping several
+        requests in flight lets the device work on them at the same time.
+        @ingroup Internal */
+    class IoQueue
+    {
+      public:
+        //! The state of one buffer
+        struct Buffer
+        {
+          char * data;           //!< aligned storage of the buffer size
+          std::uint64_t offset;  //!< where in the file the buffer is read or written
+          std::size_t size;      //!< bytes to transfer
+          std::ptrdiff_t result; //!< bytes transferred by the last request, or -1 on an error
+          bool busy;             //!< whether a request for the buffer is in flight
+        };
+
+        IoQueue( File & file, bool write, std::size_t bufferSize, std::size_t depth ) :
+          itsFile(file),
+          itsWrite(write),
+          itsStorage( bufferSize * depth + alignment ),
+          itsBuffers(depth),
+          itsStop(false)
+        {
+          auto const base = reinterpret_cast<std::uintptr_t>( itsStorage.data() );
+          auto const start = itsStorage.data() + ( alignment - base % alignment ) % alignment;
+          for( std::size_t i = 0; i < depth; ++i )
+            itsBuffers[i] = { start + i * bufferSize, 0, 0, 0, false };
+
+          for( std::size_t i = 0; i < depth; ++i )
+            itsWorkers.emplace_back( &IoQueue::workerLoop, this );
+        }
+
+        //! Waits for every request in flight, then stops the threads
+        ~IoQueue()
+        {
+          {
+            std::lock_guard<std::mutex> lock( itsMutex );
+            itsStop = true;
+          }
+          itsCondition.notify_all();
+          for( auto & worker : itsWorkers )
+            worker.join();
+        }
+
+        IoQueue( IoQueue const & ) = delete;
+        IoQueue & operator=( IoQueue const & ) = delete;
+
+        //! The aligned storage of a buffer, which must not be touched while it is busy
+        char * data( std::size_t index ) const
+        {
+          return itsBuffers[index].data;
+        }
+
+        //! Starts reading or writing size bytes of a buffer at offset
+        void submit( std::size_t index, std::uint64_t offset, std::size_t size )
+        {
+          {
+            std::lock_guard<std::mutex> lock( itsMutex );
+            auto & buffer = itsBuffers[index];
+            buffer.offset = offset;
+            buffer.size = size;
+            buffer.busy = true;
+            itsPending.push_back( index );
+          }
+          itsCondition.notify_all();
+        }
+
+        //! Waits for the request on a buffer to complete
+        /*! @return The number of bytes transferred by the request, or -1 on an error */
+        std::ptrdiff_t wait( std::size_t index )
+        {
+          std::unique_lock<std::mutex> lock( itsMutex );
+          itsCondition.wait( lock, [&]{ return !itsBuffers[index].busy; } );
+          return itsBuffers[index].result;
+        }
+
+      private:
+        //! The body of each thread
+        void workerLoop()
+        {
+          std::unique_lock<std::mutex> lock( itsMutex );
+          for( ;; )
+          {
+            itsCondition.wait( lock, [this]{ return !itsPending.empty() || itsStop; } );
+            if( itsPending.empty() )
+              return;
+
+            auto & buffer = itsBuffers[itsPending.front()];
+            itsPending.pop_front();
+            lock.unlock();
+
+            std::ptrdiff_t result;
+            if( itsWrite )
+              result = itsFile.write( buffer.data, buffer.size, buffer.offset ) ? static_cast<std::ptrdiff_t>( buffer.size ) : -1;
+            else
+              result = itsFile.read( buffer.data, buffer.size, buffer.offset );
+
+            lock.lock();
+            buffer.result = result;
+            buffer.busy = false;
+            itsCondition.notify_all();
+          }
+        }
+
+        File & itsFile;
+        bool itsWrite;
+        std::vector<char> itsStorage;       //!< holds all buffers, with room to align them
+        std::vector<Buffer> itsBuffers;
+
+        std::mutex itsMutex;                //!< guards the buffer states and everything below
+        std::condition_variable itsCondition;
+        std::deque<std::size_t> itsPending; //!< buffers waiting for a thread, in order
+        bool itsStop;
+        std::vector<std::thread> itsWorkers;
+    };
+  } // namespace direct_file_detail
+
+  // ######################################################################
+  //! A stream buffer that writes a file with unbuffered I/O and several writes in flight
+  /*! Writing a large checkpoint through a std::ofstream fills the page cache with data
+      that will not be read again, evicting the working set of the program, and issues
+      one write at a time.  This stream buffer instead opens the file with O_DIRECT
+      (FILE_FLAG_NO_BUFFERING on Windows, F_NOCACHE on macOS), fills aligned buffers,
+      and hands each full buffer to a pool of threads, so that up to queueDepth writes
+      are in flight while serialization carries on.
+
+      It can be used with any archive that writes to a std::ostream, such as
+      BinaryOutputArchive:
+
+      @code{.cpp}
+      cereal::DirectFileOutputBuffer buffer( "checkpoint.bin" );
+      std::ostream stream( &buffer );
+      {
+        cereal::BinaryOutputArchive ar( stream );
+        ar( state );
+      }
+      buffer.close(); // reports any error writing the file
+      @endcode
+
+      The last buffer is padded to the required alignment and the file is then cut back
+      to the size of the data.  If the file system does not support unbuffered I/O, such
+      as tmpfs, the file is written normally; direct() tells which was used.
+
+      Errors make the stream fail as soon as they are noticed, and are thrown by close().
+      The destructor closes the file but ignores errors.
+
+      @ingroup Utility */
+  class DirectFileOutputBuffer : public std::streambuf
+  {
+    public:
+      //! A class containing various advanced options for the direct file output buffer
+      class Options
+      {
+        public:
+          //! Default options, four buffers of 1MB each
+          static Options Default(){ return Options(); }
+
+          //! Specify specific options for the DirectFileOutputBuffer
+          /*! @param bufferSize The size of each write, rounded up to a multiple of 4096 bytes
+              @param queueDepth The number of buffers, and so the number of writes that can be in flight
+              @param direct Whether to bypass the page cache */
+          explicit Options( std::size_t bufferSize = 1 << 20, std::size_t queueDepth = 4, bool direct = true ) :
+            itsBufferSize( direct_file_detail::aligned_size( bufferSize ) ),
+            itsQueueDepth( queueDepth > 0 ? queueDepth : 1 ),
+            itsDirect( direct ) { }
+
+        private:
+          friend class DirectFileOutputBuffer;
+          friend class DirectFileInputBuffer;
+          std::size_t itsBufferSize;
+          std::size_t itsQueueDepth;
+          bool itsDirect;
+      };
+
+      //! Creates or truncates the file at path
+      /*! @throw Exception if the file cannot be opened */
+      DirectFileOutputBuffer( std::string const & path, Options const & options = Options::Default() ) :
+        itsPath( path ),
+        itsDirect( options.itsDirect ),
+        itsFile( path, true, itsDirect ),
+        itsQueue( itsFile, true, options.itsBufferSize, options.itsQueueDepth ),
+        itsBufferSize( options.itsBufferSize ),
+        itsQueueDepth( options.itsQueueDepth ),
+        itsCurrent( 0 ),
+        itsOffset( 0 ),
+        itsFailed( false ),
+        itsClosed( false )
+      {
+        setp( itsQueue.data( 0 ), itsQueue.data( 0 ) + itsBufferSize );
+      }
+
+      //! Writes out any buffered data and closes the file, ignoring errors
+      ~DirectFileOutputBuffer()
+      {
+        try
+        {
+          close();
+        }
+        catch( ... ) { }
+      }
+
+      //! Writes out any buffered data, waits for every write, and closes the file
+      /*! @throw Exception if any write failed */
+      void close()
+      {
+        if( itsClosed )
+          return;
+
+        itsClosed = true;
+        auto const used = static_cast<std::size_t>( pptr() - pbase() );
+        auto const size = itsOffset + used;
+        if( used && !itsFailed )
+        {
+          // unbuffered writes must be whole blocks, the padding is cut off below
+          auto const padded = itsDirect ? direct_file_detail::aligned_size( used ) : used;
+          std::memset( pptr(), 0, padded - used );
+          itsQueue.submit( itsCurrent, itsOffset, padded );
+        }
+        setp( nullptr, nullptr );
+
+        for( std::size_t i = 0; i < itsQueueDepth; ++i )
+          if( itsQueue.wait( i ) < 0 )
+            itsFailed = true;
+
+        if( !itsFailed && !itsFile.truncate( size ) )
+          itsFailed = true;
+        itsFile.close();
+
+        if( itsFailed )
+          throw Exception( "Failed to write '" + itsPath + "'" );
+      }
+
+      //! Whether the page cache is bypassed
+      bool direct() const
+      {
+        return itsDirect;
+      }
+
+    protected:
+      //! Hands the full buffer to the queue and continues in the next one
+      int_type overflow( int_type c ) override
+      {
+        if( itsClosed || itsFailed )
+          return traits_type::eof();
+
+        if( pptr() == epptr() )
+        {
+          itsQueue.submit( itsCurrent, itsOffset, itsBufferSize );
+          itsOffset += itsBufferSize;
+          itsCurrent = ( itsCurrent + 1 ) % itsQueueDepth;
+
+          // reuse the next buffer once its previous write is done
+          if( itsQueue.wait( itsCurrent ) < 0 )
+          {
+            itsFailed = true;
+            return traits_type::eof();
+          }
+          setp( itsQueue.data( itsCurrent ), itsQueue.data( itsCurrent ) + itsBufferSize );
+        }
+
+        if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+        {
+          *pptr() = traits_type::to_char_type( c );
+          pbump( 1 );
+        }
+        return traits_type::not_eof( c );
+      }
+
+    private:
+      std::string itsPath;
+      bool itsDirect;
+      direct_file_detail::File itsFile;
+      direct_file_detail::IoQueue itsQueue;
+      std::size_t itsBufferSize;
+      std::size_t itsQueueDepth;
+      std::size_t itsCurrent;  //!< index of the buffer being filled
+      std::uint64_t itsOffset; //!< where the buffer being filled goes in the file
+      bool itsFailed;
+      bool itsClosed;
+  };
+
+  // ######################################################################
+  //! A stream buffer that reads a file with unbuffered I/O, several reads ahead of the reader
+  /*! The counterpart of DirectFileOutputBuffer for restoring a checkpoint.  Up to
+      prefetchDepth buffers are read by a pool of threads ahead of the position being
+      loaded, so the device always has requests to work on, and the data does not
+      displace the page cache.
+
+      @code{.cpp}
+      cereal::DirectFileInputBuffer buffer( "checkpoint.bin" );
+      std::istream stream( &buffer );
+      cereal::BinaryInputArchive ar( stream );
+      ar( state );
+      @endcode
+
+      A read error ends the stream early, which archives report as a failed read.
+
+      @ingroup Utility */
+  class DirectFileInputBuffer : public std::streambuf
+  {
+    public:
+      //! A class containing various advanced options for the direct file input buffer
+      class Options
+      {
+        public:
+          //! Default options, four buffers of 1MB each
+          static Options Default(){ return Options(); }
+
+          //! Specify specific options for the DirectFileInputBuffer
+          /*! @param bufferSize The size of each read, rounded up to a multiple of 4096 bytes
+              @param prefetchDepth The number of buffers, and so the number of reads that can be in flight
+              @param direct Whether to bypass the page cache */
+          explicit Options( std::size_t bufferSize = 1 << 20, std::size_t prefetchDepth = 4, bool direct = true ) :
+            itsBufferSize( direct_file_detail::aligned_size( bufferSize ) ),
+            itsPrefetchDepth( prefetchDepth > 0 ? prefetchDepth : 1 ),
+            itsDirect( direct ) { }
+
+        private:
+          friend class DirectFileInputBuffer;
+          std::size_t itsBufferSize;
+          std::size_t itsPrefetchDepth;
+          bool itsDirect;
+      };
+
+      //! Opens the file at path and starts reading ahead
+      /*! @throw Exception if the file cannot be opened */
+      DirectFileInputBuffer( std::string const & path, Options const & options = Options::Default() ) :
+        itsDirect( options.itsDirect ),
+        itsFile( path, false, itsDirect ),
+        itsQueue( itsFile, false, options.itsBufferSize, options.itsPrefetchDepth ),
+        itsBufferSize( options.itsBufferSize ),
+        itsPrefetchDepth( options.itsPrefetchDepth ),
+        itsSize( itsFile.size() ),
+        itsCurrent( 0 ),
+        itsReadOffset( 0 ),
+        itsSubmitOffset( 0 ),
+        itsActive( false )
+      {
+        for( std::size_t i = 0; i < itsPrefetchDepth; ++i )
+          prefetch( i );
+      }
+
+      //! Whether the page cache is bypassed
+      bool direct() const
+      {
+        return itsDirect;
+      }
+
+    protected:
+      //! Moves on to the next buffer, reading ahead into the one just finished
+      int_type underflow() override
+      {
+        if( gptr() < egptr() )
+          return traits_type::to_int_type( *gptr() );
+
+        if( itsActive )
+        {
+          itsActive = false;
+          prefetch( itsCurrent );
+          itsCurrent = ( itsCurrent + 1 ) % itsPrefetchDepth;
+        }
+
+        if( itsReadOffset >= itsSize )
+          return traits_type::eof();
+
+        auto const result = itsQueue.wait( itsCurrent );
+        if( result <= 0 )
+        {
+          itsSize = itsReadOffset; // a failed read ends the stream
+          return traits_type::eof();
+        }
+
+        auto const data = itsQueue.data( itsCurrent );
+        setg( data, data, data + result );
+        itsReadOffset += static_cast<std::uint64_t>( result );
+        itsActive = true;
+        return traits_type::to_int_type( *gptr() );
+      }
+
+    private:
+      //! Starts reading the next part of the file into a buffer, if any is left
+      void prefetch( std::size_t index )
+      {
+        if( itsSubmitOffset >= itsSize )
+          return;
+
+        itsQueue.submit( index, itsSubmitOffset, itsBufferSize );
+        itsSubmitOffset += itsBufferSize;
+      }
+
+      bool itsDirect;
+      direct_file_detail::File itsFile;
+      direct_file_detail::IoQueue itsQueue;
+      std::size_t itsBufferSize;
+      std::size_t itsPrefetchDepth;
+      std::uint64_t itsSize;         //!< the size of the file
+      std::size_t itsCurrent;        //!< index of the buffer being read from
+      std::uint64_t itsReadOffset;   //!< where the next buffer to read from starts in the file
+      std::uint64_t itsSubmitOffset; //!< where the next read ahead starts in the file
+      bool itsActive;                //!< whether the get area holds the current buffer
+  };
+} // namespace cereal
+
+#endif // CEREAL_ARCHIVES_DIRECT_FILE_HPP_
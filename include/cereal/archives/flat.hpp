@@ -0,0 +1,409 @@
+/*! \file flat.hpp
+    \brief Position independent flat layouts that are used in place without loading */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_FLAT_HPP_
+#define CEREAL_ARCHIVES_FLAT_HPP_
+
+#include <cereal/cereal.hpp>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace cereal
+{
+  class FlatBuilder;
+
+  // ######################################################################
+  //! An array stored elsewhere in a flat layout, found relative to itself
+  /*! A flat_array is the member of a flat type standing in for a std::vector.  It
+      holds the distance from itself to its elements and their count, so it stays
+      valid wherever the layout is placed in memory, such as in a mapped file.
+      Its elements are set through FlatBuilder::link.
+
+      @tparam T A trivially copyable type, which may itself hold flat arrays
+      @ingroup Utility */
+  template <class T>
+  class flat_array
+  {
+    public:
+      static_assert( traits::detail::is_trivially_copyable<T>::value, "flat_array requires a trivially copyable type" );
+
+      flat_array() : itsOffset( 0 ), itsSize( 0 ) {}
+
+      //! The first element, or nullptr if the array is empty
+      const T * data() const
+      {
+        return itsSize ? reinterpret_cast<const T *>( reinterpret_cast<const char *>( this ) + itsOffset ) : nullptr;
+      }
+
+      //! The number of elements
+      std::size_t size() const { return static_cast<std::size_t>( itsSize ); }
+
+      //! Whether there are no elements
+      bool empty() const { return itsSize == 0; }
+
+      const T * begin() const { return data(); }
+      const T * end() const { return data() + size(); }
+
+      //! The element at index, which is not checked
+      const T & operator[]( std::size_t index ) const { return data()[index]; }
+
+    private:
+      friend class FlatBuilder;
+
+      std::int64_t itsOffset; //!< The distance in bytes from this to the first element
+      std::uint64_t itsSize;  //!< The number of elements
+  };
+
+  // ######################################################################
+  //! A string stored elsewhere in a flat layout, found relative to itself
+  /*! A flat_string is the member of a flat type standing in for a std::string.  Its
+      characters are followed by a null terminator that is not counted in its size.
+      Its characters are set through FlatBuilder::link.
+
+      @ingroup Utility */
+  class flat_string : public flat_array<char>
+  {
+    public:
+      //! The characters, null terminated
+      const char * c_str() const { return empty() ? "" : data(); }
+
+      //! Copies the characters into a std::string
+      std::string str() const { return std::string( c_str(), size() ); }
+  };
+
+  namespace flat_detail
+  {
+    //! Identifies a flat layout
+    /*! @internal */
+    static const std::uint32_t magic = 0x54414C46; // "FLAT"
+
+    //! Placed at the start of every flat layout
+    /*! @internal */
+    struct Header
+    {
+      std::uint32_t magic;     //!< flat_detail::magic
+      std::uint32_t alignment; //!< The strictest alignment of anything in the layout
+      std::uint64_t size;      //!< The size of the whole layout in bytes
+      std::uint64_t root;      //!< The position of the root object
+      std::uint64_t rootSize;  //!< The size of the root type, as a check that it is read as the right type
+      std::uint64_t links;     //!< The position of the link table
+      std::uint64_t linkCount; //!< The number of entries in the link table
+    };
+
+    //! An entry of the link table, describing one flat_array in the layout
+    /*! @internal */
+    struct Link
+    {
+      std::uint64_t field;            //!< The position of the flat_array
+      std::uint32_t elementSize;      //!< The size of its elements
+      std::uint32_t elementAlignment; //!< The alignment of its elements
+    };
+
+    //! Whether a position is a multiple of an alignment, a power of two
+    /*! @internal */
+    inline bool is_aligned( std::uint64_t position, std::uint64_t alignment )
+    {
+      return ( position & ( alignment - 1 ) ) == 0;
+    }
+  } // namespace flat_detail
+
+  // ######################################################################
+  //! The position of one or more objects being built in a FlatBuilder
+  /*! @relates FlatBuilder */
+  template <class T>
+  struct FlatRef
+  {
+    //! The element at index of an array
+    FlatRef at( std::size_t index ) const { return { position + index * sizeof(T), 1 }; }
+
+    std::size_t position; //!< Where the first object starts in the layout
+    std::size_t count;    //!< The number of objects
+  };
+
+  // ######################################################################
+  //! Builds a flat layout that can be used in place without loading
+  /*! A flat layout is made of trivially copyable types, whose variable length
+      members are flat_array and flat_string instead of std::vector and std::string.
+      Objects and arrays are created in the builder and then linked to the members
+      standing for them.  finish lays down a header and a table of every link, and
+      returns the layout.
+
+      Once written to a file, the layout can be mapped and read through a FlatView
+      immediately, since all of its references are relative.  There is no parse
+      step, and the cost of opening it does not depend on the amount of data.
+
+      @code{.cpp}
+      struct Entry { std::uint32_t id; cereal::flat_string name; };
+      struct Table { std::uint64_t version; cereal::flat_array<Entry> entries; };
+
+      cereal::FlatBuilder builder;
+      auto table = builder.create<Table>();
+      auto entries = builder.createArray<Entry>( names.size() );
+      for( std::size_t i = 0; i < names.size(); ++i )
+      {
+        builder.get( entries.at( i ) ).id = i;
+        builder.link( entries.at( i ), &Entry::name, builder.createString( names[i] ) );
+      }
+      builder.link( table, &Table::entries, entries );
+      std::vector<char> layout = builder.finish( table );
+      @endcode
+
+      This does nothing to ensure that the endianness and layout of types are the
+      same where the layout is built and where it is used.
+
+      \ingroup Archives */
+  class FlatBuilder
+  {
+    public:
+      FlatBuilder() : itsBuffer( sizeof(flat_detail::Header) ), itsAlignment( alignof(flat_detail::Header) ) {}
+
+      //! Appends a copy of value to the layout
+      template <class T> inline
+      FlatRef<T> create( T const & value = T() )
+      {
+        return createArray( &value, 1 );
+      }
+
+      //! Appends count value initialized objects to the layout
+      template <class T> inline
+      FlatRef<T> createArray( std::size_t count )
+      {
+        auto const ref = allocate<T>( count );
+        for( std::size_t i = 0; i < count; ++i )
+          new ( &itsBuffer[ref.position + i * sizeof(T)] ) T();
+        return ref;
+      }
+
+      //! Appends copies of count objects to the layout
+      template <class T> inline
+      FlatRef<T> createArray( T const * data, std::size_t count )
+      {
+        auto const ref = allocate<T>( count );
+        if( count )
+          std::memcpy( &itsBuffer[ref.position], data, count * sizeof(T) );
+        return ref;
+      }
+
+      //! Appends copies of the elements of a vector to the layout
+      template <class T, class A> inline
+      FlatRef<T> createArray( std::vector<T, A> const & vector )
+      {
+        return createArray( vector.data(), vector.size() );
+      }
+
+      //! Appends the characters of a string, followed by a null terminator, to the layout
+      FlatRef<char> createString( std::string const & str )
+      {
+        auto ref = createArray( str.c_str(), str.size() + 1 );
+        --ref.count;
+        return ref;
+      }
+
+      //! Accesses an object that was created in the layout
+      /*! The reference is only valid until the next object is created */
+      template <class T> inline
+      T & get( FlatRef<T> const & ref )
+      {
+        return *reinterpret_cast<T *>( &itsBuffer[ref.position] );
+      }
+
+      //! Points a flat_array member of object at target
+      template <class O, class T> inline
+      void link( FlatRef<O> const & object, flat_array<T> O::* member, FlatRef<T> const & target )
+      {
+        link( fieldPosition( object, member ), target );
+      }
+
+      //! Points a flat_string member of object at the characters of target
+      template <class O> inline
+      void link( FlatRef<O> const & object, flat_string O::* member, FlatRef<char> const & target )
+      {
+        link( fieldPosition( object, member ), target );
+      }
+
+      //! Points a flat_array, such as an element of an array of arrays, at target
+      template <class T> inline
+      void link( FlatRef<flat_array<T>> const & field, FlatRef<T> const & target )
+      {
+        link( field.position, target );
+      }
+
+      //! Points a flat_string, such as an element of an array of strings, at the characters of target
+      void link( FlatRef<flat_string> const & field, FlatRef<char> const & target )
+      {
+        link( field.position, target );
+      }
+
+      //! Finishes the layout with root as its root object, leaving the builder empty
+      /*! @return The layout, to be read through a FlatView<Root> */
+      template <class Root> inline
+      std::vector<char> finish( FlatRef<Root> const & root )
+      {
+        auto const links = allocate<flat_detail::Link>( itsLinks.size() );
+        if( !itsLinks.empty() )
+          std::memcpy( &itsBuffer[links.position], itsLinks.data(), itsLinks.size() * sizeof(flat_detail::Link) );
+
+        flat_detail::Header header;
+        header.magic     = flat_detail::magic;
+        header.alignment = static_cast<std::uint32_t>( itsAlignment );
+        header.size      = itsBuffer.size();
+        header.root      = root.position;
+        header.rootSize  = sizeof(Root);
+        header.links     = links.position;
+        header.linkCount = itsLinks.size();
+        std::memcpy( itsBuffer.data(), &header, sizeof(header) );
+
+        std::vector<char> result( sizeof(flat_detail::Header) );
+        result.swap( itsBuffer );
+        itsLinks.clear();
+        itsAlignment = alignof(flat_detail::Header);
+        return result;
+      }
+
+    private:
+      //! Makes room for count objects of type T, aligned for them
+      template <class T> inline
+      FlatRef<T> allocate( std::size_t count )
+      {
+        static_assert( traits::detail::is_trivially_copyable<T>::value, "flat layouts require trivially copyable types" );
+
+        itsAlignment = std::max( itsAlignment, alignof(T) );
+        auto const position = ( itsBuffer.size() + alignof(T) - 1 ) & ~( alignof(T) - 1 );
+        itsBuffer.resize( position + count * sizeof(T) );
+        return { position, count };
+      }
+
+      //! The position of a member of an object in the layout
+      template <class O, class M> inline
+      std::size_t fieldPosition( FlatRef<O> const & object, M O::* member )
+      {
+        return static_cast<std::size_t>( reinterpret_cast<char *>( &( get( object ).*member ) ) - itsBuffer.data() );
+      }
+
+      //! Points the flat_array at field to target, and records the link
+      template <class T> inline
+      void link( std::size_t field, FlatRef<T> const & target )
+      {
+        auto & array = *reinterpret_cast<flat_array<T> *>( &itsBuffer[field] );
+        array.itsOffset = static_cast<std::int64_t>( target.position ) - static_cast<std::int64_t>( field );
+        array.itsSize = target.count;
+
+        itsLinks.push_back( { field, static_cast<std::uint32_t>( sizeof(T) ), static_cast<std::uint32_t>( alignof(T) ) } );
+      }
+
+      std::vector<char> itsBuffer;                 //!< The layout so far, starting with room for the header
+      std::vector<flat_detail::Link> itsLinks;     //!< Every flat_array linked so far
+      std::size_t itsAlignment;                    //!< The strictest alignment of anything created so far
+  };
+
+  // ######################################################################
+  //! Reads a flat layout built by a FlatBuilder in place
+  /*! The header is checked when the view is opened, along with every link recorded
+      by the builder, so that every flat_array it set points at properly aligned
+      elements within the layout.  This guards against truncated and corrupted
+      layouts, but since the types of the layout are not known to it, not against
+      one crafted to contain arrays that the builder never linked.  Checking the
+      links can be turned off for trusted layouts, making opening constant time.
+
+      The memory must stay valid for as long as the view and anything reached
+      through it, and it must be aligned at least as strictly as the layout
+      requires, which a mapping of a file always is.
+
+      @tparam Root The type of the root object the layout was finished with
+      \ingroup Archives */
+  template <class Root>
+  class FlatView
+  {
+    public:
+      //! Opens a flat layout
+      /*! @param data The beginning of the layout
+          @param size The number of bytes available
+          @param verify Whether to check every link, rather than just the header
+          @throws Exception if the layout is invalid */
+      FlatView( const char * data, std::size_t size, bool verify = true )
+      {
+        flat_detail::Header header;
+        if( size < sizeof(header) )
+          throw Exception("Invalid flat layout - too small to hold its header");
+        std::memcpy( &header, data, sizeof(header) );
+
+        if( header.magic != flat_detail::magic )
+          throw Exception("Invalid flat layout - the header is missing");
+        if( header.size > size )
+          throw Exception("Invalid flat layout - it is truncated");
+        if( header.alignment == 0 || ( header.alignment & ( header.alignment - 1 ) ) != 0 ||
+            !flat_detail::is_aligned( reinterpret_cast<std::uintptr_t>( data ), header.alignment ) )
+          throw Exception("Flat layout is not aligned to " + std::to_string( header.alignment ) + " bytes in memory");
+        if( header.rootSize != sizeof(Root) || header.root > header.size - sizeof(Root) ||
+            !flat_detail::is_aligned( header.root, alignof(Root) ) )
+          throw Exception("Invalid flat layout - the root does not match the expected type");
+
+        itsRoot = reinterpret_cast<const Root *>( data + header.root );
+
+        if( !verify )
+          return;
+
+        if( header.links > header.size || header.linkCount > ( header.size - header.links ) / sizeof(flat_detail::Link) ||
+            !flat_detail::is_aligned( header.links, alignof(flat_detail::Link) ) )
+          throw Exception("Invalid flat layout - the link table does not fit");
+
+        auto const links = reinterpret_cast<const flat_detail::Link *>( data + header.links );
+        for( std::uint64_t i = 0; i < header.linkCount; ++i )
+        {
+          auto const & link = links[i];
+          if( link.field > header.size - sizeof(flat_array<char>) || !flat_detail::is_aligned( link.field, alignof(flat_array<char>) ) )
+            throw Exception("Invalid flat layout - link " + std::to_string( i ) + " is out of bounds");
+
+          struct { std::int64_t offset; std::uint64_t count; } array;
+          std::memcpy( &array, data + link.field, sizeof(array) );
+          if( array.count == 0 )
+            continue;
+
+          auto const target = static_cast<std::uint64_t>( static_cast<std::int64_t>( link.field ) + array.offset );
+          if( link.elementSize == 0 || link.elementAlignment == 0 || ( link.elementAlignment & ( link.elementAlignment - 1 ) ) != 0 ||
+              link.elementAlignment > header.alignment ||
+              target > header.size || array.count > ( header.size - target ) / link.elementSize ||
+              !flat_detail::is_aligned( target, link.elementAlignment ) )
+            throw Exception("Invalid flat layout - link " + std::to_string( i ) + " points outside of the layout");
+        }
+      }
+
+      //! The root object
+      Root const & root() const { return *itsRoot; }
+
+      //! Accesses the members of the root object
+      Root const * operator->() const { return itsRoot; }
+
+    private:
+      const Root * itsRoot;
+  };
+} // namespace cereal
+
+#endif // CEREAL_ARCHIVES_FLAT_HPP_
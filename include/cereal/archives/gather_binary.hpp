@@ -0,0 +1,273 @@
+/*! \file gather_binary.hpp
+    \brief A binary output archive that references large blocks of data for scatter-gather output */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_GATHER_BINARY_HPP_
+#define CEREAL_ARCHIVES_GATHER_BINARY_HPP_
+
+#include <cereal/cereal.hpp>
+#include <string>
+#include <vector>
+
+namespace cereal
+{
+  // ######################################################################
+  //! An output archive that produces a list of buffers for scatter-gather output
+  /*! This archive produces exactly the same representation as BinaryOutputArchive,
+      so anything it writes can be read back by a BinaryInputArchive, but instead of
+      writing to a stream it builds a list of segments.  Small writes are coalesced
+      into a buffer owned by the archive, while large blocks of data wrapped with
+      referenced() are not copied at all: their segments point straight at the
+      caller's memory.  The segments can then be handed to writev, sendmsg or
+      io_uring, so a message holding a large payload is sent without copying it.
+
+      @code{.cpp}
+      cereal::GatherBinaryOutputArchive ar;
+      ar( header, cereal::referenced( payload ) );
+
+      std::vector<iovec> iov;
+      for( auto const & s : ar.segments() )
+        iov.push_back( { const_cast<void *>( s.data ), s.size } );
+      writev( fd, iov.data(), static_cast<int>( iov.size() ) );
+      @endcode
+
+      Referenced memory must stay alive and unchanged until the segments have been
+      written out.  The segments themselves are valid until the next save or reset.
+
+      This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      \ingroup Archives */
+  class GatherBinaryOutputArchive : public OutputArchive<GatherBinaryOutputArchive, AllowEmptyClassElision | CoalesceArithmetic>
+  {
+    public:
+      //! A class containing various advanced options for the gather binary output archive
+      class Options
+      {
+        public:
+          //! Default options
+          static Options Default(){ return Options(); }
+
+          //! Specify specific options for the GatherBinaryOutputArchive
+          /*! @param referenceThreshold The smallest referenced block that is left in the
+                                        caller's memory.  Smaller blocks are copied, since
+                                        a segment of their own would cost more than the copy */
+          explicit Options( std::size_t referenceThreshold = 4096 ) :
+            itsReferenceThreshold( referenceThreshold ) { }
+
+        private:
+          friend class GatherBinaryOutputArchive;
+          std::size_t itsReferenceThreshold;
+      };
+
+      //! A block of output, with the same members as an iovec
+      struct Segment
+      {
+        const void * data; //!< pointer to the beginning of the block
+        std::size_t size;  //!< size in bytes
+      };
+
+      //! Construct, with no output so far
+      /*! @param options The gather binary specific options to use */
+      GatherBinaryOutputArchive(Options const & options = Options::Default()) :
+        OutputArchive<GatherBinaryOutputArchive, AllowEmptyClassElision | CoalesceArithmetic>(this),
+        itsReferenceThreshold(options.itsReferenceThreshold),
+        itsBytesWritten(0)
+      { }
+
+      //! Discards all output, forgetting all tracked pointers and types
+      /*! Memory used for tracking and for the owned buffer is kept, so one archive can
+          cheaply save many independent messages. */
+      void reset()
+      {
+        OutputArchive<GatherBinaryOutputArchive, AllowEmptyClassElision | CoalesceArithmetic>::reset();
+        itsBuffer.clear();
+        itsPieces.clear();
+        itsSegments.clear();
+        itsBytesWritten = 0;
+      }
+
+      //! Copies size bytes of data to the owned buffer
+      void saveBinary( const void * data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        if( size == 0 )
+          return;
+
+        if( itsPieces.empty() || itsPieces.back().external )
+          itsPieces.push_back( { nullptr, itsBuffer.size(), 0 } );
+
+        auto const bytes = static_cast<const char *>( data );
+        itsBuffer.insert( itsBuffer.end(), bytes, bytes + size );
+        itsPieces.back().size += size;
+        itsBytesWritten += size;
+      }
+
+      //! Outputs size bytes of the caller's data, referencing it rather than copying it if it is large
+      /*! @param data The data, which must stay alive and unchanged until the segments are written out */
+      void saveReference( const void * data, std::size_t size )
+      {
+        if( size < itsReferenceThreshold )
+          return saveBinary( data, size );
+
+        itsPieces.push_back( { static_cast<const char *>( data ), 0, size } );
+        itsBytesWritten += size;
+      }
+
+      //! The output so far, in order
+      /*! Segments in the owned buffer are only valid until the next save or reset */
+      std::vector<Segment> const & segments()
+      {
+        itsSegments.clear();
+        for( auto const & piece : itsPieces )
+          itsSegments.push_back( { piece.external ? piece.external : itsBuffer.data() + piece.offset, piece.size } );
+
+        return itsSegments;
+      }
+
+      //! Returns the number of bytes that have been output by this archive
+      std::size_t bytesWritten() const
+      {
+        return itsBytesWritten;
+      }
+
+      //! Returns the number of bytes that were copied to the owned buffer
+      std::size_t bytesCopied() const
+      {
+        return itsBuffer.size();
+      }
+
+    private:
+      //! A segment that is resolved to a pointer once the owned buffer has stopped growing
+      struct Piece
+      {
+        const char * external; //!< The caller's data, or nullptr for the owned buffer
+        std::size_t offset;    //!< Where the data starts in the owned buffer
+        std::size_t size;      //!< Size in bytes
+      };
+
+      std::size_t itsReferenceThreshold; //!< The smallest block that is referenced instead of copied
+      std::size_t itsBytesWritten;       //!< Total size of the output
+      std::vector<char> itsBuffer;       //!< Holds all copied data
+      std::vector<Piece> itsPieces;      //!< The output, in order
+      std::vector<Segment> itsSegments;  //!< The pieces resolved to pointers by segments()
+  };
+
+  // ######################################################################
+  //! A wrapper around a contiguous container whose data may be referenced instead of copied
+  /*! @relates referenced
+      @internal */
+  template <class T>
+  struct ReferencedWrapper
+  {
+    ReferencedWrapper( T & v ) : value( v ) {}
+    T & value;
+
+    ReferencedWrapper & operator=( ReferencedWrapper const & ) = delete;
+  };
+
+  //! Saves a vector or string so that its data can be left in place by a GatherBinaryOutputArchive
+  /*! When saved to a GatherBinaryOutputArchive, the contents of a large value are not
+      copied: the archive references them in its segments instead, and they must stay
+      alive and unchanged until the segments are written out.  With any other archive,
+      saving and loading through the wrapper is identical to serializing the value itself.
+
+      The value must be a std::vector, std::basic_string, or similar contiguous
+      container of trivially serializable elements.
+
+      @ingroup Utility */
+  template <class T> inline
+  ReferencedWrapper<T> referenced( T & value )
+  {
+    return {value};
+  }
+
+  // ######################################################################
+  // GatherBinaryArchive serialization functions
+
+  //! Saving for POD types to gather binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(GatherBinaryOutputArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to gather binary
+  template <class T> inline
+  void CEREAL_SERIALIZE_FUNCTION_NAME( GatherBinaryOutputArchive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Serializing SizeTags to gather binary
+  template <class T> inline
+  void CEREAL_SERIALIZE_FUNCTION_NAME( GatherBinaryOutputArchive & ar, SizeTag<T> & t )
+  {
+    ar( t.size );
+  }
+
+  //! Saving binary data to gather binary, which is always copied
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(GatherBinaryOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+
+  //! Saving for referenced values to gather binary, using the same representation as the value
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(GatherBinaryOutputArchive & ar, ReferencedWrapper<T> const & wrapper)
+  {
+    typedef typename std::remove_const<T>::type::value_type ValueT;
+    static_assert( traits::is_trivially_serializable<ValueT>::value && !std::is_same<ValueT, bool>::value,
+                   "referenced requires a contiguous container of trivially serializable elements" );
+
+    auto const & value = wrapper.value;
+    ar( make_size_tag( static_cast<size_type>( value.size() ) ) );
+    ar.saveReference( value.data(), value.size() * sizeof(ValueT) );
+  }
+
+  //! Saving for referenced values to other archives, which is the same as saving the value
+  template <class Archive, class T> inline
+  typename std::enable_if<!std::is_same<Archive, GatherBinaryOutputArchive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(Archive & ar, ReferencedWrapper<T> const & wrapper)
+  {
+    ar( wrapper.value );
+  }
+
+  //! Loading for referenced values, which is the same as loading the value
+  template <class Archive, class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(Archive & ar, ReferencedWrapper<T> & wrapper)
+  {
+    ar( wrapper.value );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::GatherBinaryOutputArchive)
+
+#endif // CEREAL_ARCHIVES_GATHER_BINARY_HPP_
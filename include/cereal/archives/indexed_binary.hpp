@@ -0,0 +1,527 @@
+/*! \file indexed_binary.hpp
+    \brief Binary archives with an index of their entries, for random access loading */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_INDEXED_BINARY_HPP_
+#define CEREAL_ARCHIVES_INDEXED_BINARY_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/archives/binary.hpp>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace cereal
+{
+  namespace indexed_binary_detail
+  {
+    //! Marks the end of an indexed binary archive
+    /*! @ingroup Internal */
+    static const std::uint32_t magic = 0x58444943; // "CIDX"
+
+    //! The size of the footer at the end of an indexed binary archive
+    /*! The footer holds the position of the entry index, the number of entries, and the magic number.
+        @ingroup Internal */
+    static const std::uint64_t footer_size = 2 * sizeof(std::uint64_t) + sizeof(std::uint32_t);
+  } // namespace indexed_binary_detail
+
+  template <class T> class indexed_vector;
+
+  // ######################################################################
+  //! An output archive that saves binary entries and an index allowing each to be loaded alone
+  /*! Data is saved by entries, each of which is serialized exactly as it would be
+      by BinaryOutputArchive.  Every entry starts with nothing tracked, so it does not
+      refer to shared pointers or type information saved by other entries.  When the
+      archive is finished, an index of the position of every entry is appended, so
+      IndexedBinaryInputArchive can seek directly to any of them.
+
+      Elements of an indexed_vector saved into this archive are indexed as well, so they
+      can be loaded one at a time on demand.
+
+      The stream must be seekable, such as a file or string stream, since the positions
+      of data are recorded and indexed vectors are patched once their elements are written.
+
+      This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      \ingroup Archives */
+  class IndexedBinaryOutputArchive : public OutputArchive<IndexedBinaryOutputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, outputting to the provided stream
+      /*! @param stream The stream to output to, which must be seekable and should be opened in binary mode.
+                        The archive begins at the current position of the stream. */
+      IndexedBinaryOutputArchive(std::ostream & stream) :
+        OutputArchive<IndexedBinaryOutputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream),
+        itsStart(stream.tellp()),
+        itsFinished(false)
+      {
+        if( itsStart == std::ostream::pos_type(-1) )
+          throw Exception("IndexedBinaryOutputArchive requires a seekable stream");
+      }
+
+      //! Destructor, finishes the archive if that was not done already
+      /*! Errors cannot be reported here, so call finish to find out whether the index was written */
+      ~IndexedBinaryOutputArchive()
+      {
+        if( !itsFinished )
+          try { finish(); } catch( ... ) {}
+      }
+
+      //! Saves a single entry holding the given data
+      template <class ... Types> inline
+      void writeEntry( Types && ... args )
+      {
+        if( itsFinished )
+          throw Exception("Can not write to an indexed archive after it is finished");
+
+        reset();
+        itsEntries.push_back( position() );
+        (*this)( std::forward<Types>( args )... );
+      }
+
+      //! Writes the index of all entries, after which no more can be written
+      void finish()
+      {
+        itsFinished = true;
+
+        std::uint64_t const index = position();
+        std::uint64_t const count = itsEntries.size();
+        saveBinary( itsEntries.data(), itsEntries.size() * sizeof(std::uint64_t) );
+        saveBinary( &index, sizeof(index) );
+        saveBinary( &count, sizeof(count) );
+        saveBinary( &indexed_binary_detail::magic, sizeof(indexed_binary_detail::magic) );
+      }
+
+      //! Writes size bytes of data to the output stream
+      void saveBinary( const void * data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        auto const writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
+
+        if(writtenSize != size)
+          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+      }
+
+      //! Saves an indexed vector, indexing each of its elements
+      /*! @internal */
+      template <class T> inline
+      void saveIndexedVector( indexed_vector<T> const & vector );
+
+    private:
+      //! The current position, relative to the start of the archive
+      std::uint64_t position()
+      {
+        return static_cast<std::uint64_t>( itsStream.tellp() - itsStart );
+      }
+
+      //! Moves to a position relative to the start of the archive
+      void seek( std::uint64_t pos )
+      {
+        if( !itsStream.seekp( itsStart + static_cast<std::streamoff>( pos ) ) )
+          throw Exception("Failed to seek in the output stream");
+      }
+
+      std::ostream & itsStream;
+      std::ostream::pos_type itsStart;       //!< Where the archive begins in the stream
+      std::vector<std::uint64_t> itsEntries; //!< Positions of the entries written so far
+      bool itsFinished;                      //!< Whether the index has been written
+  };
+
+  // ######################################################################
+  //! An input archive that loads entries saved by IndexedBinaryOutputArchive in any order
+  /*! The index is read when the archive is constructed, after which any entry can
+      be loaded with loadEntry, which seeks directly to it.
+
+      @code{.cpp}
+      cereal::IndexedBinaryInputArchive ar( file );
+      Entity entity;
+      ar.loadEntry( ar.entryCount() - 1, entity );
+      @endcode
+
+      \ingroup Archives */
+  class IndexedBinaryInputArchive : public InputArchive<IndexedBinaryInputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, reading the index from the provided stream
+      /*! @param stream The stream to read from, which must be seekable.  The archive
+                        begins at its current position and ends at the end of the stream.
+          @throws Exception if the stream does not end with a valid index */
+      IndexedBinaryInputArchive(std::istream & stream) :
+        InputArchive<IndexedBinaryInputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream),
+        itsStart(stream.tellg()),
+        itsIndex(0)
+      {
+        if( itsStart == std::istream::pos_type(-1) || !itsStream.seekg( 0, std::ios::end ) )
+          throw Exception("IndexedBinaryInputArchive requires a seekable stream");
+
+        auto const size = static_cast<std::uint64_t>( itsStream.tellg() - itsStart );
+        if( size < indexed_binary_detail::footer_size )
+          throw Exception("Invalid indexed archive - too small to hold an index");
+
+        std::uint64_t index, count;
+        std::uint32_t magic;
+        seek( size - indexed_binary_detail::footer_size );
+        loadBinary( &index, sizeof(index) );
+        loadBinary( &count, sizeof(count) );
+        loadBinary( &magic, sizeof(magic) );
+
+        if( magic != indexed_binary_detail::magic )
+          throw Exception("Invalid indexed archive - the index is missing");
+        if( index > size - indexed_binary_detail::footer_size ||
+            count > ( size - indexed_binary_detail::footer_size - index ) / sizeof(std::uint64_t) )
+          throw Exception("Invalid indexed archive - the index does not fit in the stream");
+
+        itsEntries.resize( static_cast<std::size_t>( count ) );
+        seek( index );
+        loadBinary( itsEntries.data(), itsEntries.size() * sizeof(std::uint64_t) );
+
+        for( auto const entry : itsEntries )
+          if( entry > index )
+            throw Exception("Invalid indexed archive - an entry is past the index");
+
+        itsIndex = index;
+        seek( 0 );
+      }
+
+      //! The number of entries in the archive
+      std::size_t entryCount() const { return itsEntries.size(); }
+
+      //! Loads the given data from an entry
+      /*! @param entry The index of the entry, in the order they were written
+          @throws Exception if the entry does not exist */
+      template <class ... Types> inline
+      void loadEntry( std::size_t entry, Types && ... args )
+      {
+        if( entry >= itsEntries.size() )
+          throw Exception("Entry " + std::to_string(entry) + " is out of range of the " + std::to_string(itsEntries.size()) + " entries");
+
+        reset();
+        seek( itsEntries[entry] );
+        (*this)( std::forward<Types>( args )... );
+      }
+
+      //! Reads size bytes of data from the input stream
+      void loadBinary( void * const data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        auto const readSize = static_cast<std::size_t>( itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size ) );
+
+        if(readSize != size)
+          throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+      }
+
+      //! Loads an indexed vector, reading only the positions of its elements
+      /*! @internal */
+      template <class T> inline
+      void loadIndexedVector( indexed_vector<T> & vector );
+
+    private:
+      //! The current position, relative to the start of the archive
+      std::uint64_t position()
+      {
+        return static_cast<std::uint64_t>( itsStream.tellg() - itsStart );
+      }
+
+      //! Moves to a position relative to the start of the archive
+      void seek( std::uint64_t pos )
+      {
+        if( !itsStream.seekg( itsStart + static_cast<std::streamoff>( pos ) ) )
+          throw Exception("Failed to seek in the input stream");
+      }
+
+      std::istream & itsStream;
+      std::istream::pos_type itsStart;       //!< Where the archive begins in the stream
+      std::uint64_t itsIndex;                //!< Position of the entry index, which all data precedes
+      std::vector<std::uint64_t> itsEntries; //!< Positions of the entries
+  };
+
+  // ######################################################################
+  //! A vector whose elements can be loaded one at a time
+  /*! When saved to an IndexedBinaryOutputArchive, each element is saved on its own
+      with BinaryOutputArchive and its position is indexed.  Loading it from an
+      IndexedBinaryInputArchive only reads that index: the vector is then lazy, and
+      each call to load seeks to an element and loads it from the stream.  This makes
+      a large container in a snapshot usable without loading all of it.
+
+      Since elements are saved independently, they do not share pointers or type
+      information with each other or with the rest of the archive.  A lazy vector
+      refers to the stream of the archive it was loaded from, which must outlive it
+      and must not be used from another thread while an element is loaded.
+
+      Other archives save and load the elements like a std::vector, and the result is
+      never lazy.
+
+      @code{.cpp}
+      struct Snapshot
+      {
+        cereal::indexed_vector<Entity> entities;
+
+        template <class Archive>
+        void serialize( Archive & ar ) { ar( entities ); }
+      };
+
+      Entity e = snapshot.entities.load( 42 ); // reads only this entity
+      @endcode
+
+      @ingroup Utility */
+  template <class T>
+  class indexed_vector
+  {
+    public:
+      //! Construct an empty vector
+      indexed_vector() : itsStream( nullptr ) {}
+
+      //! Construct holding the given values in memory
+      indexed_vector( std::vector<T> values ) : itsValues( std::move( values ) ), itsStream( nullptr ) {}
+
+      //! The number of elements
+      std::size_t size() const { return itsStream ? itsPositions.size() : itsValues.size(); }
+
+      //! Whether there are no elements
+      bool empty() const { return size() == 0; }
+
+      //! Whether the elements are loaded from a stream on demand
+      bool lazy() const { return itsStream != nullptr; }
+
+      //! The values held in memory, which is empty for a lazy vector
+      std::vector<T> const & values() const { return itsValues; }
+
+      //! Loads a single element
+      /*! For a lazy vector, this seeks to the element, loads it, and then restores the
+          position of the stream.
+          @throws Exception if the index is out of range or the element can not be loaded */
+      void load( std::size_t i, T & value ) const
+      {
+        if( i >= size() )
+          throw Exception("Element " + std::to_string(i) + " is out of range of the indexed vector of " + std::to_string(size()));
+
+        if( !itsStream )
+        {
+          value = itsValues[i];
+          return;
+        }
+
+        auto const previous = itsStream->tellg();
+        if( !itsStream->seekg( itsPositions[i] ) )
+          throw Exception("Failed to seek to an element of an indexed vector");
+
+        BinaryInputArchive ar( *itsStream );
+        ar( value );
+        itsStream->seekg( previous );
+      }
+
+      //! Loads a single element
+      T load( std::size_t i ) const
+      {
+        T value;
+        load( i, value );
+        return value;
+      }
+
+    private:
+      friend class IndexedBinaryInputArchive;
+
+      std::vector<T> itsValues;                         //!< The elements, if held in memory
+      std::istream * itsStream;                         //!< The stream elements are loaded from, if lazy
+      std::vector<std::istream::pos_type> itsPositions; //!< Where each element is in the stream, if lazy
+  };
+
+  template <class T> inline
+  void IndexedBinaryOutputArchive::saveIndexedVector( indexed_vector<T> const & vector )
+  {
+    std::uint64_t const count = vector.size();
+    (*this)( make_size_tag( static_cast<size_type>( count ) ) );
+
+    // the position of the element index is patched in once the elements are written
+    auto const patch = position();
+    std::uint64_t index = 0;
+    saveBinary( &index, sizeof(index) );
+
+    std::vector<std::uint64_t> positions;
+    positions.reserve( static_cast<std::size_t>( count ) );
+    T lazyValue;
+    for( std::size_t i = 0; i < count; ++i )
+    {
+      positions.push_back( position() );
+
+      BinaryOutputArchive ar( itsStream );
+      if( vector.lazy() )
+      {
+        vector.load( i, lazyValue );
+        ar( lazyValue );
+      }
+      else
+        ar( vector.values()[i] );
+    }
+
+    index = position();
+    saveBinary( positions.data(), positions.size() * sizeof(std::uint64_t) );
+    auto const end = position();
+
+    seek( patch );
+    saveBinary( &index, sizeof(index) );
+    seek( end );
+  }
+
+  template <class T> inline
+  void IndexedBinaryInputArchive::loadIndexedVector( indexed_vector<T> & vector )
+  {
+    size_type count;
+    (*this)( make_size_tag( count ) );
+
+    std::uint64_t index;
+    loadBinary( &index, sizeof(index) );
+
+    if( index < position() || index > itsIndex || count > ( itsIndex - index ) / sizeof(std::uint64_t) )
+      throw Exception("Invalid indexed vector - its index is out of place");
+
+    std::vector<std::uint64_t> positions( static_cast<std::size_t>( count ) );
+    seek( index );
+    loadBinary( positions.data(), positions.size() * sizeof(std::uint64_t) );
+    auto const end = position();
+
+    vector.itsValues.clear();
+    vector.itsPositions.clear();
+    vector.itsPositions.reserve( positions.size() );
+    for( auto const pos : positions )
+    {
+      if( pos >= index )
+        throw Exception("Invalid indexed vector - an element is past its index");
+      vector.itsPositions.push_back( itsStart + static_cast<std::streamoff>( pos ) );
+    }
+    vector.itsStream = &itsStream;
+
+    seek( end );
+  }
+
+  // ######################################################################
+  // Common IndexedBinaryArchive serialization functions
+
+  //! Saving for POD types to indexed binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(IndexedBinaryOutputArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Loading for POD types from indexed binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(IndexedBinaryInputArchive & ar, T & t)
+  {
+    ar.loadBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to indexed binary
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(IndexedBinaryInputArchive, IndexedBinaryOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Serializing SizeTags to indexed binary
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(IndexedBinaryInputArchive, IndexedBinaryOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, SizeTag<T> & t )
+  {
+    ar( t.size );
+  }
+
+  //! Saving binary data
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(IndexedBinaryOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+
+  //! Loading binary data
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(IndexedBinaryInputArchive & ar, BinaryData<T> & bd)
+  {
+    ar.loadBinary(bd.data, static_cast<std::size_t>(bd.size));
+  }
+
+  //! Saving indexed vectors to indexed binary, indexing each element
+  template <class Archive, class T> inline
+  typename std::enable_if<std::is_same<Archive, IndexedBinaryOutputArchive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, indexed_vector<T> const & vector )
+  {
+    ar.saveIndexedVector( vector );
+  }
+
+  //! Loading indexed vectors from indexed binary, leaving them lazy
+  template <class Archive, class T> inline
+  typename std::enable_if<std::is_same<Archive, IndexedBinaryInputArchive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, indexed_vector<T> & vector )
+  {
+    ar.loadIndexedVector( vector );
+  }
+
+  //! Saving indexed vectors to other archives, like a std::vector
+  template <class Archive, class T> inline
+  typename std::enable_if<!std::is_same<Archive, IndexedBinaryOutputArchive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, indexed_vector<T> const & vector )
+  {
+    ar( make_size_tag( static_cast<size_type>( vector.size() ) ) );
+    if( vector.lazy() )
+    {
+      for( std::size_t i = 0; i < vector.size(); ++i )
+        ar( vector.load( i ) );
+    }
+    else
+      for( auto const & v : vector.values() )
+        ar( v );
+  }
+
+  //! Loading indexed vectors from other archives, into memory
+  template <class Archive, class T> inline
+  typename std::enable_if<!std::is_same<Archive, IndexedBinaryInputArchive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, indexed_vector<T> & vector )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    std::vector<T> values( static_cast<std::size_t>( size ) );
+    for( auto & v : values )
+      ar( v );
+    vector = indexed_vector<T>( std::move( values ) );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::IndexedBinaryOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::IndexedBinaryInputArchive)
+
+// tie input and output archives together
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::IndexedBinaryInputArchive, cereal::IndexedBinaryOutputArchive)
+
+#endif // CEREAL_ARCHIVES_INDEXED_BINARY_HPP_
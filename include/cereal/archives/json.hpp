@@ -31,6 +31,8 @@
 
 #include <cereal/cereal.hpp>
 #include <cereal/details/util.hpp>
+#include <cereal/details/flat_map.hpp>
+#include <cereal/details/charconv.hpp>
 
 namespace cereal
 {
@@ -56,7 +58,122 @@ namespace cereal
 #include <sstream>
 #include <stack>
 #include <vector>
+#include <array>
 #include <string>
+#include <cstring>
+#include <algorithm>
+
+namespace cereal
+{
+  namespace json_detail
+  {
+    //! A rapidjson write stream that collects characters in a fixed size chunk
+    /*! The writer puts one character at a time, which is costly for a std::ostream.
+        The chunk is instead written with a single sputn, or appended to a string,
+        whenever it fills up and when flush is called.
+        @internal */
+    class WriteStream
+    {
+      public:
+        typedef char Ch;
+
+        //! Writes to the buffer of stream, setting badbit if that fails, or else appends to str
+        WriteStream( std::ostream * stream, std::string * str ) :
+          itsStream( stream ), itsString( str ), itsPosition( itsChunk ) {}
+
+        WriteStream( WriteStream const & ) = delete;
+        WriteStream & operator=( WriteStream const & ) = delete;
+
+        void Put( char c )
+        {
+          if( itsPosition == itsChunk + sizeof(itsChunk) )
+            flush();
+          *itsPosition++ = c;
+        }
+
+        void PutN( char c, std::size_t n )
+        {
+          while( n )
+          {
+            if( itsPosition == itsChunk + sizeof(itsChunk) )
+              flush();
+            auto const count = std::min<std::size_t>( n, static_cast<std::size_t>( itsChunk + sizeof(itsChunk) - itsPosition ) );
+            std::memset( itsPosition, c, count );
+            itsPosition += count;
+            n -= count;
+          }
+        }
+
+        //! Writes the chunk out and continues with a new stream or string
+        void rebind( std::ostream * stream, std::string * str )
+        {
+          flush();
+          itsStream = stream;
+          itsString = str;
+        }
+
+        //! Writes out the chunk
+        void flush()
+        {
+          auto const size = static_cast<std::size_t>( itsPosition - itsChunk );
+          itsPosition = itsChunk;
+          if( size == 0 ) // the target may no longer exist once an archive has finished
+            return;
+
+          if( itsString )
+            itsString->append( itsChunk, size );
+          else if( itsStream->rdbuf()->sputn( itsChunk, static_cast<std::streamsize>( size ) ) != static_cast<std::streamsize>( size ) )
+            itsStream->setstate( std::ios::badbit );
+        }
+
+      private:
+        std::ostream * itsStream; //!< The stream written to, if not a string
+        std::string * itsString;  //!< The string appended to, if not a stream
+        char * itsPosition;       //!< The next free character of itsChunk
+        char itsChunk[4096];      //!< Characters not yet written
+    };
+
+    //! Returns true if the current machine is little endian
+    /*! @internal */
+    inline bool is_little_endian()
+    {
+      static std::int32_t test = 1;
+      return *reinterpret_cast<std::int8_t*>( &test ) == 1;
+    }
+
+    //! Whether vectors and arrays of T can be saved as base64 blobs
+    /*! long double has no portable layout, and bool vectors are not contiguous
+        @internal */
+    template <class T>
+    struct is_blob_element : std::integral_constant<bool,
+      std::is_arithmetic<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, long double>::value> {};
+
+    //! The element type recorded with a base64 blob, such as f64, i32 or u8
+    /*! @internal */
+    template <class T> inline
+    std::string blob_type()
+    {
+      return ( std::is_floating_point<T>::value ? "f" : std::is_signed<T>::value ? "i" : "u" ) + std::to_string( sizeof(T) * 8 );
+    }
+
+    //! Reverses the bytes of each of count elements of the given size
+    /*! @internal */
+    inline void swap_elements( unsigned char * data, std::size_t size, std::size_t count )
+    {
+      for( std::size_t i = 0; i < count; ++i, data += size )
+        std::reverse( data, data + size );
+    }
+  } // namespace json_detail
+} // namespace cereal
+
+namespace rapidjson
+{
+  template<>
+  inline void PutN( ::cereal::json_detail::WriteStream & stream, char c, size_t n )
+  {
+    stream.PutN( c, n );
+  }
+}
 
 namespace cereal
 {
@@ -89,8 +206,9 @@ namespace cereal
   {
     enum class NodeType { StartObject, InObject, StartArray, InArray };
 
-    typedef rapidjson::GenericWriteStream WriteStream;
+    typedef json_detail::WriteStream WriteStream;
     typedef rapidjson::PrettyWriter<WriteStream> JSONWriter;
+    typedef JSONWriter::Base CompactWriter;
 
     public:
       /*! @name Common Functionality
@@ -107,6 +225,9 @@ namespace cereal
           //! Default options with no indentation
           static Options NoIndent(){ return Options( std::numeric_limits<double>::max_digits10, IndentChar::space, 0 ); }
 
+          //! Default options with no whitespace at all, for JSON that is not read by people
+          static Options Compact(){ return Options( std::numeric_limits<double>::max_digits10, IndentChar::space, 0, true ); }
+
           //! The character to use for indenting
           enum class IndentChar : char
           {
@@ -120,19 +241,31 @@ namespace cereal
           /*! @param precision The precision used for floating point numbers
               @param indentChar The type of character to indent with
               @param indentLength The number of indentChar to use for indentation
-                             (0 corresponds to no indentation) */
+                             (0 corresponds to no indentation)
+              @param compact Whether to write no whitespace at all, ignoring the indentation
+                             settings.  Without indentation, newlines are still written
+                             between values unless this is set
+              @param binaryArithmetic Whether to save std::vector and std::array of arithmetic
+                             types (except bool and long double) as base64 blobs rather than
+                             arrays of numbers.  Blobs are only read by JSONInputArchive */
           explicit Options( int precision = std::numeric_limits<double>::max_digits10,
                             IndentChar indentChar = IndentChar::space,
-                            unsigned int indentLength = 4 ) :
+                            unsigned int indentLength = 4,
+                            bool compact = false,
+                            bool binaryArithmetic = false ) :
             itsPrecision( precision ),
             itsIndentChar( static_cast<char>(indentChar) ),
-            itsIndentLength( indentLength ) { }
+            itsIndentLength( indentLength ),
+            itsCompact( compact ),
+            itsBinaryArithmetic( binaryArithmetic ) { }
 
         private:
           friend class JSONOutputArchive;
           int itsPrecision;
           char itsIndentChar;
           unsigned int itsIndentLength;
+          bool itsCompact;
+          bool itsBinaryArithmetic;
       };
 
       //! Construct, outputting to the provided stream
@@ -140,21 +273,54 @@ namespace cereal
           @param options The JSON specific options to use.  See the Options struct
                          for the values of default parameters */
       JSONOutputArchive(std::ostream & stream, Options const & options = Options::Default() ) :
-        OutputArchive<JSONOutputArchive>(this),
-        itsWriteStream(stream),
-        itsWriter(itsWriteStream, options.itsPrecision),
-        itsNextName(nullptr)
-      {
-        itsWriter.SetIndent( options.itsIndentChar, options.itsIndentLength );
-        itsNameCounter.push(0);
-        itsNodeStack.push(NodeType::StartObject);
-      }
+        JSONOutputArchive( &stream, nullptr, options, true )
+      { }
+
+      //! Construct, appending to the provided string
+      /*! This skips the overhead of a std::ostream entirely.  The output is complete
+          once the archive is destroyed.
+          @param str The string to append to.
+          @param options The JSON specific options to use.  See the Options struct
+                         for the values of default parameters */
+      JSONOutputArchive(std::string & str, Options const & options = Options::Default() ) :
+        JSONOutputArchive( nullptr, &str, options, true )
+      { }
 
       //! Destructor, flushes the JSON
+      /*! Output is collected in chunks, so it only reaches the stream in full here */
       ~JSONOutputArchive()
       {
-        if (itsNodeStack.top() == NodeType::InObject)
-          itsWriter.EndObject();
+        finish();
+      }
+
+      //! Completes the document and writes out everything held in the chunk
+      /*! Nothing more may be saved until the archive is reset. */
+      void finish()
+      {
+        if (!itsNodeStack.empty() && itsNodeStack.top() == NodeType::InObject)
+          endObject();
+        itsWriteStream.flush();
+        itsNodeStack = decltype(itsNodeStack)();
+        itsNameCounter = decltype(itsNameCounter)();
+      }
+
+      using OutputArchive<JSONOutputArchive>::reset;
+
+      //! Completes the document and starts a new one on another stream, forgetting all tracked pointers and types
+      /*! The options the archive was constructed with are kept.  Memory used by the
+          writer and for tracking is kept, so one archive can cheaply save many
+          independent documents.
+          @param stream The stream to output to from now on */
+      void reset( std::ostream & stream )
+      {
+        rebind( &stream, nullptr );
+      }
+
+      //! Completes the document and starts a new one appended to a string, forgetting all tracked pointers and types
+      /*! @param str The string to append to from now on */
+      void reset( std::string & str )
+      {
+        rebind( nullptr, &str );
       }
 
       //! Saves some binary data, encoded as a base64 string, with an optional name
@@ -165,10 +331,20 @@ namespace cereal
         setNextName( name );
         writeName();
 
-        auto base64string = base64::encode( reinterpret_cast<const unsigned char *>( data ), size );
-        saveValue( base64string );
+        // encoded into a buffer kept between calls, which the writer copies from
+        itsBinaryBuffer.resize( base64::encoded_size( size ) );
+        if( size )
+          base64::encode( reinterpret_cast<const unsigned char *>( data ), size, &itsBinaryBuffer[0] );
+        saveValue( itsBinaryBuffer );
       };
 
+      //! Whether arithmetic vectors and arrays are saved as base64 blobs
+      /*! See the binaryArithmetic parameter of Options */
+      bool binaryArithmetic() const
+      {
+        return itsBinaryArithmetic;
+      }
+
       //! @}
       /*! @name Internal Functionality
           Functionality designed for use by those requiring control over the inner mechanisms of
@@ -198,14 +374,14 @@ namespace cereal
         switch(itsNodeStack.top())
         {
           case NodeType::StartArray:
-            itsWriter.StartArray();
+            startArray();
           case NodeType::InArray:
-            itsWriter.EndArray();
+            endArray();
             break;
           case NodeType::StartObject:
-            itsWriter.StartObject();
+            startObject();
           case NodeType::InObject:
-            itsWriter.EndObject();
+            endObject();
             break;
         }
 
@@ -220,21 +396,25 @@ namespace cereal
       }
 
       //! Saves a bool to the current node
-      void saveValue(bool b)                { itsWriter.Bool_(b);                                                         }
+      void saveValue(bool b)                { if( itsCompact ) compactWriter().Bool_(b);   else itsWriter.Bool_(b);   }
       //! Saves an int to the current node
-      void saveValue(int i)                 { itsWriter.Int(i);                                                          }
+      void saveValue(int i)                 { if( itsCompact ) compactWriter().Int(i);     else itsWriter.Int(i);     }
       //! Saves a uint to the current node
-      void saveValue(unsigned u)            { itsWriter.Uint(u);                                                         }
+      void saveValue(unsigned u)            { if( itsCompact ) compactWriter().Uint(u);    else itsWriter.Uint(u);    }
       //! Saves an int64 to the current node
-      void saveValue(int64_t i64)           { itsWriter.Int64(i64);                                                      }
+      void saveValue(int64_t i64)           { if( itsCompact ) compactWriter().Int64(i64); else itsWriter.Int64(i64); }
       //! Saves a uint64 to the current node
-      void saveValue(uint64_t u64)          { itsWriter.Uint64(u64);                                                     }
+      void saveValue(uint64_t u64)          { if( itsCompact ) compactWriter().Uint64(u64); else itsWriter.Uint64(u64); }
       //! Saves a double to the current node
-      void saveValue(double d)              { itsWriter.Double(d);                                                       }
+      void saveValue(double d)              { if( itsCompact ) compactWriter().Double(d);  else itsWriter.Double(d);  }
       //! Saves a string to the current node
-      void saveValue(std::string const & s) { itsWriter.String(s.c_str(), static_cast<rapidjson::SizeType>( s.size() )); }
+      void saveValue(std::string const & s)
+      {
+        auto const size = static_cast<rapidjson::SizeType>( s.size() );
+        if( itsCompact ) compactWriter().String(s.c_str(), size); else itsWriter.String(s.c_str(), size);
+      }
       //! Saves a const char * to the current node
-      void saveValue(char const * s)        { itsWriter.String(s);                                                       }
+      void saveValue(char const * s)        { if( itsCompact ) compactWriter().String(s);  else itsWriter.String(s);  }
 
     private:
       // Some compilers/OS have difficulty disambiguating the above for various flavors of longs, so we provide
@@ -288,9 +468,9 @@ namespace cereal
                                           (sizeof(T) >= sizeof(long double) || sizeof(T) >= sizeof(long long))> = traits::sfinae> inline
       void saveValue(T const & t)
       {
-        std::stringstream ss; ss.precision( std::numeric_limits<long double>::max_digits10 );
-        ss << t;
-        saveValue( ss.str() );
+        char buffer[charconv_detail::bufferSize];
+        auto const size = charconv_detail::toChars( buffer, t );
+        saveValue( std::string( buffer, size ) );
       }
 
       //! Write the name of the upcoming node and prepare object/array state
@@ -313,13 +493,13 @@ namespace cereal
         // Start up either an object or an array, depending on state
         if(nodeType == NodeType::StartArray)
         {
-          itsWriter.StartArray();
+          startArray();
           itsNodeStack.top() = NodeType::InArray;
         }
         else if(nodeType == NodeType::StartObject)
         {
           itsNodeStack.top() = NodeType::InObject;
-          itsWriter.StartObject();
+          startObject();
         }
 
         // Array types do not output names
@@ -327,8 +507,11 @@ namespace cereal
 
         if(itsNextName == nullptr)
         {
-          std::string name = "value" + std::to_string( itsNameCounter.top()++ ) + "\0";
-          saveValue(name);
+          // generate valueN in place, since this happens for every unnamed value
+          char name[charconv_detail::bufferSize] = "value";
+          auto const size = 5 + charconv_detail::toChars( name + 5, itsNameCounter.top()++ );
+          if( itsCompact ) compactWriter().String(name, static_cast<rapidjson::SizeType>( size ));
+          else itsWriter.String(name, static_cast<rapidjson::SizeType>( size ));
         }
         else
         {
@@ -345,12 +528,70 @@ namespace cereal
 
       //! @}
 
+    protected:
+      //! Construct, optionally without starting the enclosing object
+      /*! Archives that write a sequence of documents start each of them with startRoot
+          and end it with finishNode */
+      JSONOutputArchive(std::ostream & stream, Options const & options, bool root) :
+        JSONOutputArchive( &stream, nullptr, options, root )
+      { }
+
+      //! Writes out whatever output is held in the chunk of the write stream
+      void flush()
+      {
+        itsWriteStream.flush();
+      }
+
+      //! Construct, writing to either stream or str, optionally without starting the enclosing object
+      JSONOutputArchive(std::ostream * stream, std::string * str, Options const & options, bool root) :
+        OutputArchive<JSONOutputArchive>(this),
+        itsWriteStream(stream, str),
+        itsWriter(itsWriteStream, options.itsPrecision),
+        itsCompact(options.itsCompact),
+        itsBinaryArithmetic(options.itsBinaryArithmetic),
+        itsNextName(nullptr)
+      {
+        itsWriter.SetIndent( options.itsIndentChar, options.itsIndentLength );
+        if( root )
+          startRoot();
+      }
+
+      //! Completes the document and starts a new one, writing to either stream or str
+      void rebind( std::ostream * stream, std::string * str )
+      {
+        finish();
+        OutputArchive<JSONOutputArchive>::reset();
+        itsWriteStream.rebind( stream, str );
+        itsNextName = nullptr;
+        startRoot();
+      }
+
+      //! Prepares the enclosing object of a document
+      void startRoot()
+      {
+        itsNameCounter.push(0);
+        itsNodeStack.push(NodeType::StartObject);
+      }
+
     private:
+      //! The writer used for compact output
+      /*! This is the base of the pretty writer, sharing its state, which writes
+          without the whitespace the pretty writer adds around values */
+      CompactWriter & compactWriter() { return itsWriter; }
+
+      void startObject() { if( itsCompact ) compactWriter().StartObject(); else itsWriter.StartObject(); }
+      void endObject()   { if( itsCompact ) compactWriter().EndObject();   else itsWriter.EndObject();   }
+      void startArray()  { if( itsCompact ) compactWriter().StartArray();  else itsWriter.StartArray();  }
+      void endArray()    { if( itsCompact ) compactWriter().EndArray();    else itsWriter.EndArray();    }
+
       WriteStream itsWriteStream;          //!< Rapidjson write stream
       JSONWriter itsWriter;                //!< Rapidjson writer
+      bool itsCompact;                     //!< Whether to write with the compact writer
+      bool itsBinaryArithmetic;            //!< Whether to save arithmetic vectors and arrays as blobs
+      std::string itsBinaryBuffer;         //!< Holds base64 encoded binary data while it is written
       char const * itsNextName;            //!< The next name
-      std::stack<uint32_t> itsNameCounter; //!< Counter for creating unique names for unnamed nodes
-      std::stack<NodeType> itsNodeStack;
+      std::stack<uint32_t, std::vector<uint32_t>> itsNameCounter; //!< Counter for creating unique names for unnamed nodes
+      std::stack<NodeType, std::vector<NodeType>> itsNodeStack;
   }; // JSONOutputArchive
 
   // ######################################################################
@@ -406,13 +647,44 @@ namespace cereal
       /*! @param stream The stream to read from */
       JSONInputArchive(std::istream & stream) :
         InputArchive<JSONInputArchive>(this),
-        itsNextName( nullptr ),
-        itsReadStream(stream)
+        itsNextName( nullptr )
       {
-        itsDocument.ParseStream<0>(itsReadStream);
+        ReadStream readStream(stream);
+        itsDocument.ParseStream<0>(readStream);
         itsIteratorStack.emplace_back(itsDocument.MemberBegin(), itsDocument.MemberEnd());
       }
 
+      //! Construct, parsing a buffer in place
+      /*! The document is parsed in situ: strings are decoded within the buffer and
+          the document refers to them there, instead of copying each of them.  The
+          buffer is modified and must remain valid for as long as the archive is used.
+
+          @param buffer A null terminated JSON document */
+      JSONInputArchive(char * buffer) :
+        InputArchive<JSONInputArchive>(this),
+        itsNextName( nullptr )
+      {
+        parseInsitu( buffer );
+      }
+
+      //! Construct, reading from a value that has already been parsed
+      /*! This loads from an object that is part of some larger document, such as a
+          payload within an envelope, without writing it out and parsing it again.
+          Nothing is copied: the value must remain valid and unchanged for as long
+          as the archive is used, and strings from loadStringRef point into it.
+
+          @param value A JSON object, which may also be a whole rapidjson::Document
+          @throws Exception if the value is not an object */
+      JSONInputArchive(rapidjson::Value const & value) :
+        InputArchive<JSONInputArchive>(this),
+        itsNextName( nullptr )
+      {
+        if( !value.IsObject() )
+          throw Exception("JSONInputArchive can only read from a JSON object");
+
+        itsIteratorStack.emplace_back(value.MemberBegin(), value.MemberEnd());
+      }
+
       //! Loads some binary data, encoded as a base64 string
       /*! This will automatically start and finish a node to load the data, and can be called directly by
           users.
@@ -422,18 +694,84 @@ namespace cereal
       void loadBinaryValue( void * data, size_t size, const char * name = nullptr )
       {
         itsNextName = name;
+        search();
 
-        std::string encoded;
-        loadValue( encoded );
-        auto decoded = base64::decode( encoded );
+        // decoded straight from the document into data
+        auto const & value = itsIteratorStack.back().value();
+        auto const encoded = value.GetString();
+        auto const length = value.GetStringLength();
 
-        if( size != decoded.size() )
+        if( size != base64::decoded_size( encoded, length ) )
           throw Exception("Decoded binary data size does not match specified size");
 
-        std::memcpy( data, decoded.data(), decoded.size() );
-        itsNextName = nullptr;
+        base64::decode( encoded, length, reinterpret_cast<unsigned char *>( data ) );
+        ++itsIteratorStack.back();
       };
 
+      //! Gets the number of bytes that loadBinaryValue would load, without loading them
+      /*! This finds the node as loadBinaryValue does but stays on it, so the size can be
+          checked before anything is allocated for the data.
+
+          @param name The name of the node holding the data, or null for the next node */
+      size_t binaryValueSize( const char * name = nullptr )
+      {
+        itsNextName = name;
+        search();
+
+        auto const & value = itsIteratorStack.back().value();
+        if( !value.IsString() )
+          throw Exception("Binary data is not encoded as a base64 string");
+
+        return base64::decoded_size( value.GetString(), value.GetStringLength() );
+      }
+
+      //! Loads a string without copying it
+      /*! The string points into the document, which for an archive constructed
+          from a buffer is the buffer itself.  It remains valid for as long as the
+          archive, and also as long as the buffer for an archive parsed in place.
+          It is null terminated, but may also contain nulls.
+
+          This can be called directly by users and follows the same ordering rules
+          specified in the class description in regards to loading in/out of order
+
+          @param data Set to the first character of the string
+          @param size Set to the length of the string */
+      void loadStringRef( const char *& data, size_t & size, const char * name = nullptr )
+      {
+        itsNextName = name;
+        search();
+
+        auto const & value = itsIteratorStack.back().value();
+        data = value.GetString();
+        size = value.GetStringLength();
+        ++itsIteratorStack.back();
+      }
+
+    protected:
+      //! Construct without a document, for archives that parse a sequence of them with parseInsitu
+      JSONInputArchive() :
+        InputArchive<JSONInputArchive>(this),
+        itsNextName( nullptr )
+      { }
+
+      //! Replaces the document by parsing a buffer in place
+      /*! Memory used by the previous document is reused, so anything referring into
+          it, such as strings from loadStringRef, is invalidated.
+
+          @throws Exception if the buffer does not hold a JSON object */
+      void parseInsitu( char * buffer )
+      {
+        itsNextName = nullptr;
+        itsIteratorStack.clear();
+        itsDocument.GetAllocator().Rewind();
+
+        itsDocument.ParseInsitu<0>( buffer );
+        if( itsDocument.HasParseError() )
+          throw Exception( std::string("Failed to parse JSON: ") + itsDocument.GetParseError() );
+
+        itsIteratorStack.emplace_back(itsDocument.MemberBegin(), itsDocument.MemberEnd());
+      }
+
     private:
       //! @}
       /*! @name Internal Functionality
@@ -485,19 +823,42 @@ namespace cereal
           }
 
           //! Adjust our position such that we are at the node with the given name
-          /*! @throws Exception if no such named node exists */
+          /*! Wide objects are searched through an index of their member names,
+              built the first time a search is needed.
+
+              @throws Exception if no such named node exists */
           inline void search( const char * searchName )
           {
             const auto len = std::strlen( searchName );
-            size_t index = 0;
-            for( auto it = itsMemberItBegin; it != itsMemberItEnd; ++it, ++index )
+            const auto count = static_cast<size_t>( itsMemberItEnd - itsMemberItBegin );
+
+            if( count >= detail::FlatNameIndex::linearSearchLimit )
             {
-              const auto currentName = it->name.GetString();
-              if( ( std::strncmp( searchName, currentName, len ) == 0 ) &&
-                  ( std::strlen( currentName ) == len ) )
+              if( itsNameIndex.empty() )
               {
-                itsIndex = index;
+                itsNameIndex.reserve( count );
+                for( size_t index = 0; index < count; ++index )
+                {
+                  const auto currentName = itsMemberItBegin[index].name.GetString();
+                  itsNameIndex.insert( currentName, std::strlen( currentName ), index );
+                }
+              }
+
+              if( itsNameIndex.find( searchName, len, itsIndex ) )
                 return;
+            }
+            else
+            {
+              size_t index = 0;
+              for( auto it = itsMemberItBegin; it != itsMemberItEnd; ++it, ++index )
+              {
+                const auto currentName = it->name.GetString();
+                if( ( std::strncmp( searchName, currentName, len ) == 0 ) &&
+                    ( std::strlen( currentName ) == len ) )
+                {
+                  itsIndex = index;
+                  return;
+                }
               }
             }
 
@@ -508,6 +869,7 @@ namespace cereal
           MemberIterator itsMemberItBegin, itsMemberItEnd; //!< The member iterator (object)
           ValueIterator itsValueItBegin, itsValueItEnd;    //!< The value iterator (array)
           size_t itsIndex;                                 //!< The current index of this iterator
+          detail::FlatNameIndex itsNameIndex;              //!< Positions of member names, built on the first search
           enum Type {Value, Member, Null_} itsType;    //!< Whether this holds values (array) or members (objects) or nothing
       };
 
@@ -636,7 +998,7 @@ namespace cereal
       template <class T> inline
       typename std::enable_if<sizeof(T) == sizeof(std::uint64_t) && !std::is_signed<T>::value, void>::type
       loadLong(T & lu){ loadValue( reinterpret_cast<std::uint64_t&>( lu ) ); }
-            
+            
     public:
       //! Serialize a long if it would not be caught otherwise
       template <class T> inline
@@ -654,12 +1016,9 @@ namespace cereal
       #endif // _MSC_VER
 
     private:
-      //! Convert a string to a long long
-      void stringToNumber( std::string const & str, long long & val ) { val = std::stoll( str ); }
-      //! Convert a string to an unsigned long long
-      void stringToNumber( std::string const & str, unsigned long long & val ) { val = std::stoull( str ); }
-      //! Convert a string to a long double
-      void stringToNumber( std::string const & str, long double & val ) { val = std::stold( str ); }
+      //! Convert a string to a long long, unsigned long long, or long double
+      template <class T> inline
+      void stringToNumber( std::string const & str, T & val ) { val = charconv_detail::fromChars<T>( str.c_str() ); }
 
     public:
       //! Loads a value from the current node - long double and long long overloads
@@ -686,11 +1045,71 @@ namespace cereal
 
     private:
       const char * itsNextName;               //!< Next name set by NVP
-      ReadStream itsReadStream;               //!< Rapidjson write stream
       std::vector<Iterator> itsIteratorStack; //!< 'Stack' of rapidJSON iterators
       rapidjson::Document itsDocument;        //!< Rapidjson document
   };
 
+  namespace json_detail
+  {
+    //! Saves count elements as a base64 blob into the current node
+    /*! The blob holds the element type, the number of elements, and the little
+        endian bytes of the elements, e.g. {"type": "f64", "size": 2, "data": "..."}
+        @internal */
+    template <class T> inline
+    void save_blob( JSONOutputArchive & ar, T const * data, std::size_t count )
+    {
+      ar( make_nvp( "type", blob_type<T>() ), make_nvp( "size", static_cast<size_type>( count ) ) );
+
+      if( sizeof(T) == 1 || is_little_endian() )
+        ar.saveBinaryValue( data, count * sizeof(T), "data" );
+      else
+      {
+        std::vector<unsigned char> bytes( reinterpret_cast<unsigned char const *>( data ),
+                                          reinterpret_cast<unsigned char const *>( data + count ) );
+        swap_elements( bytes.data(), sizeof(T), count );
+        ar.saveBinaryValue( bytes.data(), bytes.size(), "data" );
+      }
+    }
+
+    //! Whether the node just started holds a base64 blob rather than an array of numbers
+    /*! @internal */
+    inline bool is_blob( JSONInputArchive const & ar )
+    {
+      auto const name = ar.getNodeName();
+      return name && std::strcmp( name, "type" ) == 0;
+    }
+
+    //! Loads a base64 blob from the current node
+    /*! @param allocate Called with the number of elements, returning where they are loaded to
+        @throws Exception if the blob holds some other element type, its size does not match
+                its data, or it exceeds the load limits
+        @internal */
+    template <class T, class Allocate> inline
+    void load_blob( JSONInputArchive & ar, Allocate && allocate )
+    {
+      std::string type;
+      size_type count;
+      ar( make_nvp( "type", type ), make_nvp( "size", count ) );
+
+      if( type != blob_type<T>() )
+        throw Exception( "Base64 blob holds " + type + " elements rather than " + blob_type<T>() );
+      if( count > std::numeric_limits<std::size_t>::max() / sizeof(T) )
+        throw Exception( "Base64 blob size is too large" );
+
+      // the size comes from the document, so it is checked against the data before allocating
+      auto const size = static_cast<std::size_t>( count );
+      if( ar.binaryValueSize( "data" ) != size * sizeof(T) )
+        throw Exception( "Base64 blob size does not match its data" );
+      ar.checkLoadSize( count );
+
+      T * data = allocate( size );
+      ar.loadBinaryValue( data, size * sizeof(T), "data" );
+
+      if( sizeof(T) > 1 && !is_little_endian() )
+        swap_elements( reinterpret_cast<unsigned char *>( data ), sizeof(T), size );
+    }
+  } // namespace json_detail
+
   // ######################################################################
   // JSONArchive prologue and epilogue functions
   // ######################################################################
@@ -900,6 +1319,69 @@ namespace cereal
   {
     ar.loadSize( st.size );
   }
+
+  // ######################################################################
+  //! Saving arithmetic vectors to JSON, as base64 blobs if the options ask for them
+  template <class T, class A, traits::EnableIf<json_detail::is_blob_element<T>::value> = traits::sfinae> inline
+  void CEREAL_SAVE_FUNCTION_NAME( JSONOutputArchive & ar, std::vector<T, A> const & vector )
+  {
+    if( ar.binaryArithmetic() )
+      json_detail::save_blob( ar, vector.data(), vector.size() );
+    else
+    {
+      ar( make_size_tag( static_cast<size_type>( vector.size() ) ) );
+      for( auto const & v : vector )
+        ar( v );
+    }
+  }
+
+  //! Loading arithmetic vectors from JSON base64 blobs or arrays of numbers
+  template <class T, class A, traits::EnableIf<json_detail::is_blob_element<T>::value> = traits::sfinae> inline
+  void CEREAL_LOAD_FUNCTION_NAME( JSONInputArchive & ar, std::vector<T, A> & vector )
+  {
+    if( json_detail::is_blob( ar ) )
+      json_detail::load_blob<T>( ar, [&]( std::size_t count )
+      {
+        vector.resize( count );
+        return vector.data();
+      } );
+    else
+    {
+      size_type size;
+      ar( make_size_tag( size ) );
+
+      vector.resize( static_cast<std::size_t>( size ) );
+      for( auto & v : vector )
+        ar( v );
+    }
+  }
+
+  //! Saving arithmetic arrays to JSON, as base64 blobs if the options ask for them
+  template <class T, size_t N, traits::EnableIf<json_detail::is_blob_element<T>::value> = traits::sfinae> inline
+  void CEREAL_SAVE_FUNCTION_NAME( JSONOutputArchive & ar, std::array<T, N> const & array )
+  {
+    if( ar.binaryArithmetic() )
+      json_detail::save_blob( ar, array.data(), N );
+    else
+      for( auto const & i : array )
+        ar( i );
+  }
+
+  //! Loading arithmetic arrays from JSON base64 blobs or their elements
+  template <class T, size_t N, traits::EnableIf<json_detail::is_blob_element<T>::value> = traits::sfinae> inline
+  void CEREAL_LOAD_FUNCTION_NAME( JSONInputArchive & ar, std::array<T, N> & array )
+  {
+    if( json_detail::is_blob( ar ) )
+      json_detail::load_blob<T>( ar, [&]( std::size_t count )
+      {
+        if( count != N )
+          throw Exception( "Base64 blob size does not match the size of the array" );
+        return array.data();
+      } );
+    else
+      for( auto & i : array )
+        ar( i );
+  }
 } // namespace cereal
 
 // register archives for polymorphic support
@@ -0,0 +1,129 @@
+/*! \file json_lines.hpp
+    \brief JSON archives that read and write a stream of records, one per line */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_JSON_LINES_HPP_
+#define CEREAL_ARCHIVES_JSON_LINES_HPP_
+
+#include <cereal/archives/json.hpp>
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace cereal
+{
+  // ######################################################################
+  //! An output archive that writes a stream of JSON records, one per line
+  /*! Each call to writeRecord writes a single compact JSON object followed by a
+      newline, which is the format known as JSON Lines or NDJSON.  The object holds
+      exactly what a JSONOutputArchive constructed for the record would hold, but the
+      writer and the archive's tracking tables are kept and reused between records,
+      making this suitable for high rate logging.
+
+      Every record stands on its own: shared pointers, polymorphic type names and
+      class versions are written again in each record that uses them, so records can
+      be read in any order or by a JSONInputArchive.
+
+      Data is serialized exactly as it would be by a JSONOutputArchive, to which this
+      archive hands itself.  If serializing a record throws, the output stream is left
+      in an unusable state.
+
+      \ingroup Archives */
+  class JSONLinesOutputArchive : private JSONOutputArchive
+  {
+    public:
+      //! Construct, outputting to the provided stream
+      /*! @param stream The stream to output to.  Records are appended as they are
+                        written, but the stream is not flushed.
+          @param precision The precision used for floating point numbers */
+      JSONLinesOutputArchive( std::ostream & stream, int precision = std::numeric_limits<double>::max_digits10 ) :
+        JSONOutputArchive( stream, Options( precision, Options::IndentChar::space, 0, true ), false ),
+        itsStream( stream )
+      { }
+
+      //! Writes a single record holding the given data
+      /*! The data is placed in one JSON object, named by NVPs or given generated names */
+      template <class ... Types> inline
+      void writeRecord( Types && ... args )
+      {
+        reset();
+        startRoot();
+        JSONOutputArchive::operator()( std::forward<Types>( args )... );
+        finishNode();
+        flush();
+        itsStream.put( '\n' );
+      }
+
+    private:
+      std::ostream & itsStream; //!< The stream records are written to
+  }; // JSONLinesOutputArchive
+
+  // ######################################################################
+  //! An input archive that reads a stream of JSON records, one per line
+  /*! Each call to readRecord reads one line and loads from it exactly as a
+      JSONInputArchive would, parsing the line in place.  The line buffer, the
+      document's memory, and the archive's tracking tables are kept and reused
+      between records.  Blank lines are skipped.
+
+      This reads the output of JSONLinesOutputArchive, or any other JSON Lines stream
+      whose records are objects.
+
+      \ingroup Archives */
+  class JSONLinesInputArchive : private JSONInputArchive
+  {
+    public:
+      //! Construct, reading from the provided stream
+      /*! @param stream The stream to read from, which is read a line at a time */
+      JSONLinesInputArchive( std::istream & stream ) :
+        itsStream( stream )
+      { }
+
+      //! Reads the next record, loading the given data from it
+      /*! @return false if the stream held no further records, in which case nothing is loaded
+          @throws Exception if the record is not a JSON object, or does not hold the data */
+      template <class ... Types> inline
+      bool readRecord( Types && ... args )
+      {
+        do
+        {
+          if( !std::getline( itsStream, itsLine ) )
+            return false;
+        } while( itsLine.find_first_not_of( " \t\r" ) == std::string::npos );
+
+        reset();
+        parseInsitu( &itsLine[0] );
+        JSONInputArchive::operator()( std::forward<Types>( args )... );
+        return true;
+      }
+
+    private:
+      std::istream & itsStream; //!< The stream records are read from
+      std::string itsLine;      //!< The current record, which its document refers into
+  }; // JSONLinesInputArchive
+} // namespace cereal
+
+#endif // CEREAL_ARCHIVES_JSON_LINES_HPP_
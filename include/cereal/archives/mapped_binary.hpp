@@ -0,0 +1,533 @@
+/*! \file mapped_binary.hpp
+    \brief Binary archives that operate on memory mapped files */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_MAPPED_BINARY_HPP_
+#define CEREAL_ARCHIVES_MAPPED_BINARY_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/archives/memory_binary.hpp>
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <cerrno>
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace cereal
+{
+  namespace mapped_binary_detail
+  {
+    //! How a mapped file is expected to be accessed, used to give readahead hints to the OS
+    /*! @ingroup Internal */
+    enum class AccessHint
+    {
+      normal,     //!< No particular access pattern
+      sequential, //!< Data will be read front to back, aggressive readahead is useful
+      random      //!< Data will be accessed out of order, readahead is wasteful
+    };
+
+    //! Builds an error message for a failed mapping operation
+    /*! @ingroup Internal */
+    inline std::string error_message( std::string const & what, std::string const & path )
+    {
+      #ifdef _WIN32
+      return what + " '" + path + "' (error " + std::to_string( GetLastError() ) + ")";
+      #else
+      return what + " '" + path + "' (" + std::strerror( errno ) + ")";
+      #endif
+    }
+
+    //! A read only mapping of an entire file
+    /*! @ingroup Internal */
+    class ReadMapping
+    {
+      public:
+        ReadMapping( std::string const & path, AccessHint hint ) : itsData(nullptr), itsSize(0)
+        {
+          #ifdef _WIN32
+          DWORD const flags = hint == AccessHint::sequential ? FILE_FLAG_SEQUENTIAL_SCAN :
+                              hint == AccessHint::random     ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL;
+          itsFile = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr );
+          if( itsFile == INVALID_HANDLE_VALUE )
+            throw Exception( error_message( "Failed to open", path ) );
+
+          LARGE_INTEGER size;
+          if( !GetFileSizeEx( itsFile, &size ) )
+          {
+            CloseHandle( itsFile );
+            throw Exception( error_message( "Failed to get size of", path ) );
+          }
+          itsSize = static_cast<std::size_t>( size.QuadPart );
+
+          itsMapping = nullptr;
+          if( itsSize == 0 )
+            return;
+
+          itsMapping = CreateFileMappingA( itsFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+          if( itsMapping )
+            itsData = static_cast<const char *>( MapViewOfFile( itsMapping, FILE_MAP_READ, 0, 0, 0 ) );
+
+          if( !itsData )
+          {
+            if( itsMapping ) CloseHandle( itsMapping );
+            CloseHandle( itsFile );
+            throw Exception( error_message( "Failed to map", path ) );
+          }
+          #else
+          itsFile = ::open( path.c_str(), O_RDONLY );
+          if( itsFile < 0 )
+            throw Exception( error_message( "Failed to open", path ) );
+
+          struct stat info;
+          if( ::fstat( itsFile, &info ) != 0 )
+          {
+            ::close( itsFile );
+            throw Exception( error_message( "Failed to get size of", path ) );
+          }
+          itsSize = static_cast<std::size_t>( info.st_size );
+
+          if( itsSize == 0 )
+            return;
+
+          void * data = ::mmap( nullptr, itsSize, PROT_READ, MAP_PRIVATE, itsFile, 0 );
+          if( data == MAP_FAILED )
+          {
+            ::close( itsFile );
+            throw Exception( error_message( "Failed to map", path ) );
+          }
+          itsData = static_cast<const char *>( data );
+
+          int const advice = hint == AccessHint::sequential ? MADV_SEQUENTIAL :
+                             hint == AccessHint::random     ? MADV_RANDOM : MADV_NORMAL;
+          ::madvise( data, itsSize, advice ); // only a hint, failure is not an error
+          #endif
+        }
+
+        ~ReadMapping()
+        {
+          #ifdef _WIN32
+          if( itsData ) UnmapViewOfFile( itsData );
+          if( itsMapping ) CloseHandle( itsMapping );
+          CloseHandle( itsFile );
+          #else
+          if( itsData ) ::munmap( const_cast<char *>( itsData ), itsSize );
+          ::close( itsFile );
+          #endif
+        }
+
+        ReadMapping( ReadMapping const & ) = delete;
+        ReadMapping & operator=( ReadMapping const & ) = delete;
+
+        const char * data() const { return itsData; }
+        std::size_t size() const { return itsSize; }
+
+      private:
+        #ifdef _WIN32
+        HANDLE itsFile;
+        HANDLE itsMapping;
+        #else
+        int itsFile;
+        #endif
+        const char * itsData;
+        std::size_t itsSize;
+    };
+
+    //! A writable mapping of a file that can be grown as data is written
+    /*! The file is extended in large steps as needed and truncated to the
+        exact size written when the mapping is closed.
+        @ingroup Internal */
+    class WriteMapping
+    {
+      public:
+        WriteMapping( std::string const & path ) : itsPath( path ), itsOpen(false), itsData(nullptr), itsCapacity(0)
+        {
+          #ifdef _WIN32
+          itsFile = CreateFileA( path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+          if( itsFile == INVALID_HANDLE_VALUE )
+            throw Exception( error_message( "Failed to open", path ) );
+          itsMapping = nullptr;
+          #else
+          itsFile = ::open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+          if( itsFile < 0 )
+            throw Exception( error_message( "Failed to open", path ) );
+          #endif
+          itsOpen = true;
+        }
+
+        ~WriteMapping()
+        {
+          if( itsOpen )
+            close( 0 );
+        }
+
+        //! Unmaps the file and truncates it to size bytes
+        void close( std::size_t size )
+        {
+          unmap();
+          itsOpen = false;
+
+          #ifdef _WIN32
+          LARGE_INTEGER end;
+          end.QuadPart = static_cast<LONGLONG>( size );
+          SetFilePointerEx( itsFile, end, nullptr, FILE_BEGIN );
+          SetEndOfFile( itsFile );
+          CloseHandle( itsFile );
+          #else
+          if( ::ftruncate( itsFile, static_cast<off_t>( size ) ) != 0 )
+            { } // nothing sensible can be done about this while closing
+          ::close( itsFile );
+          #endif
+        }
+
+        //! Grows the file and mapping to hold at least capacity bytes
+        /*! Any pointers into the previous mapping are invalidated */
+        void reserve( std::size_t capacity )
+        {
+          capacity = std::max( capacity, std::max<std::size_t>( itsCapacity * 2, 1 << 20 ) );
+          unmap();
+
+          #ifdef _WIN32
+          ULARGE_INTEGER size;
+          size.QuadPart = capacity;
+          itsMapping = CreateFileMappingA( itsFile, nullptr, PAGE_READWRITE, size.HighPart, size.LowPart, nullptr );
+          if( itsMapping )
+            itsData = static_cast<char *>( MapViewOfFile( itsMapping, FILE_MAP_WRITE, 0, 0, 0 ) );
+          #else
+          if( ::ftruncate( itsFile, static_cast<off_t>( capacity ) ) == 0 )
+          {
+            void * data = ::mmap( nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, itsFile, 0 );
+            if( data != MAP_FAILED )
+            {
+              itsData = static_cast<char *>( data );
+              ::madvise( data, capacity, MADV_SEQUENTIAL );
+            }
+          }
+          #endif
+
+          if( !itsData )
+            throw Exception( error_message( "Failed to map", itsPath ) );
+
+          itsCapacity = capacity;
+        }
+
+        WriteMapping( WriteMapping const & ) = delete;
+        WriteMapping & operator=( WriteMapping const & ) = delete;
+
+        char * data() const { return itsData; }
+        std::size_t capacity() const { return itsCapacity; }
+
+      private:
+        void unmap()
+        {
+          #ifdef _WIN32
+          if( itsData ) UnmapViewOfFile( itsData );
+          if( itsMapping ) CloseHandle( itsMapping );
+          itsMapping = nullptr;
+          #else
+          if( itsData ) ::munmap( itsData, itsCapacity );
+          #endif
+          itsData = nullptr;
+        }
+
+        std::string itsPath;
+        bool itsOpen;
+        #ifdef _WIN32
+        HANDLE itsFile;
+        HANDLE itsMapping;
+        #else
+        int itsFile;
+        #endif
+        char * itsData;
+        std::size_t itsCapacity;
+    };
+  } // namespace mapped_binary_detail
+
+  // ######################################################################
+  //! An output archive designed to save binary data to a memory mapped file
+  /*! This archive produces exactly the same representation as BinaryOutputArchive,
+      but writes through a memory mapping of the output file instead of a stream.
+      The file is grown in large steps as data is written and truncated to the exact
+      size of the serialized data when the archive is destroyed.
+
+      This is most useful for very large archives, where it avoids the extra copy
+      through stream buffers and lets the kernel write back pages as it sees fit.
+
+      This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      Blocks of binary data can be aligned as by MemoryBinaryOutputArchive, so that a
+      MappedBinaryInputArchive can lend them out as ArrayViews.
+
+      \ingroup Archives */
+  class MappedBinaryOutputArchive : public OutputArchive<MappedBinaryOutputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! The options for the mapped binary output archive, shared with MemoryBinaryOutputArchive
+      using Options = MemoryBinaryOutputArchive::Options;
+
+      //! Construct, creating (or truncating) the file at the provided path
+      /*! @param path The file to write to
+          @param sizeHint The expected size of the output, if known, to avoid remapping
+                          the file while it grows
+          @param options The memory binary specific options to use
+          @throw Exception if the file cannot be opened or mapped */
+      MappedBinaryOutputArchive(std::string const & path, std::size_t sizeHint = 0, Options const & options = Options::Default()) :
+        OutputArchive<MappedBinaryOutputArchive, AllowEmptyClassElision>(this),
+        itsMapping(path),
+        itsSize(0),
+        itsAlignment(options.itsAlignment)
+      {
+        itsMapping.reserve( sizeHint );
+      }
+
+      //! Unmaps the file and truncates it to the size of the data written
+      ~MappedBinaryOutputArchive()
+      {
+        itsMapping.close( itsSize );
+      }
+
+      //! Writes size bytes of data to the mapped file
+      void saveBinary( const void * data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        if( itsMapping.capacity() - itsSize < size )
+          itsMapping.reserve( itsSize + size );
+
+        std::memcpy( itsMapping.data() + itsSize, data, size );
+        itsSize += size;
+      }
+
+      //! Writes a block of binary data, padded first if blocks are aligned
+      /*! @param alignment The alignment of the elements of the block */
+      void saveBinaryData( const void * data, std::size_t size, std::size_t alignment )
+      {
+        if( itsAlignment )
+          for( auto padding = memory_binary_detail::padding( itsSize, std::max( alignment, itsAlignment ) ); padding; )
+          {
+            auto const chunk = std::min( padding, sizeof(memory_binary_detail::zeroes) );
+            saveBinary( memory_binary_detail::zeroes, chunk );
+            padding -= chunk;
+          }
+
+        saveBinary( data, size );
+      }
+
+      //! Returns the number of bytes that have been output by this archive
+      std::size_t bytesWritten() const
+      {
+        return itsSize;
+      }
+
+    private:
+      mapped_binary_detail::WriteMapping itsMapping;
+      std::size_t itsSize;      //!< The number of bytes written
+      std::size_t itsAlignment; //!< The smallest alignment of binary data blocks, 0 if they are not aligned
+  };
+
+  // ######################################################################
+  //! An input archive designed to load binary data from a memory mapped file
+  /*! This archive reads the representation produced by BinaryOutputArchive,
+      MemoryBinaryOutputArchive, and MappedBinaryOutputArchive through a read only
+      mapping of the entire file.
+
+      Like MemoryBinaryInputArchive, this archive can lend out data directly from
+      the mapping without copying it by loading a BinaryView or using borrowBinary.
+      Data saved with aligned binary data can also be lent out as an ArrayView, since
+      the mapping starts on a page boundary.  Borrowed data remains valid until the
+      archive is destroyed.
+
+      By default the OS is told that the file will be read sequentially, which
+      enables aggressive readahead on platforms that support it.
+
+      This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      \ingroup Archives */
+  class MappedBinaryInputArchive : public InputArchive<MappedBinaryInputArchive, AllowEmptyClassElision>
+  {
+    public:
+      using AccessHint = mapped_binary_detail::AccessHint;
+
+      //! The options for the mapped binary input archive, shared with MemoryBinaryInputArchive
+      using Options = MemoryBinaryInputArchive::Options;
+
+      //! Construct, mapping the file at the provided path
+      /*! @param path The file to read from
+          @param hint How the data is expected to be accessed
+          @param options The memory binary specific options to use, which must match those the data was saved with
+          @throw Exception if the file cannot be opened or mapped */
+      MappedBinaryInputArchive(std::string const & path, AccessHint hint = AccessHint::sequential, Options const & options = Options::Default()) :
+        InputArchive<MappedBinaryInputArchive, AllowEmptyClassElision>(this),
+        itsMapping(path, hint),
+        itsPos(itsMapping.data()),
+        itsEnd(itsMapping.data() + itsMapping.size()),
+        itsAlignment(options.itsAlignment)
+      { }
+
+      //! Reads size bytes of data from the mapped file
+      void loadBinary( void * const data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        std::memcpy( data, borrowBinary( size ), size );
+      }
+
+      //! Borrows size bytes from the mapped file without copying them
+      /*! @return A pointer into the mapping at the current position, which
+                  is then advanced past the borrowed data
+          @throw Exception if fewer than size bytes remain */
+      const char * borrowBinary( std::size_t size )
+      {
+        if( static_cast<std::size_t>( itsEnd - itsPos ) < size )
+          throw Exception("Failed to read " + std::to_string(size) + " bytes from mapped file! Only " +
+                          std::to_string(itsEnd - itsPos) + " bytes remaining");
+
+        auto const ptr = itsPos;
+        itsPos += size;
+        return ptr;
+      }
+
+      //! Borrows a block of binary data, skipping its padding first if blocks are aligned
+      /*! @param alignment The alignment of the elements of the block */
+      const char * borrowBinaryData( std::size_t size, std::size_t alignment )
+      {
+        if( itsAlignment )
+          borrowBinary( memory_binary_detail::padding( bytesRead(), std::max( alignment, itsAlignment ) ) );
+
+        return borrowBinary( size );
+      }
+
+      //! Returns the number of bytes that have been consumed by this archive
+      std::size_t bytesRead() const
+      {
+        return static_cast<std::size_t>( itsPos - itsMapping.data() );
+      }
+
+      //! Returns the number of bytes remaining in the mapped file
+      std::size_t bytesRemaining() const
+      {
+        return static_cast<std::size_t>( itsEnd - itsPos );
+      }
+
+    private:
+      mapped_binary_detail::ReadMapping itsMapping;
+      const char * itsPos;      //!< The next byte to be read
+      const char * itsEnd;      //!< One past the end of the mapping
+      std::size_t itsAlignment; //!< The smallest alignment of binary data blocks, 0 if they are not aligned
+  };
+
+  // ######################################################################
+  // MappedBinaryArchive serialization functions
+
+  //! Saving for POD types to mapped binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(MappedBinaryOutputArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Loading for POD types from mapped binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(MappedBinaryInputArchive & ar, T & t)
+  {
+    ar.loadBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to mapped binary
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(MappedBinaryInputArchive, MappedBinaryOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Serializing SizeTags to mapped binary
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(MappedBinaryInputArchive, MappedBinaryOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, SizeTag<T> & t )
+  {
+    ar( t.size );
+  }
+
+  //! Saving binary data to mapped binary
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(MappedBinaryOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinaryData( bd.data, static_cast<std::size_t>( bd.size ), memory_binary_detail::binary_alignment<T>::value );
+  }
+
+  //! Loading binary data from mapped binary
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(MappedBinaryInputArchive & ar, BinaryData<T> & bd)
+  {
+    auto const size = static_cast<std::size_t>( bd.size );
+    std::memcpy( bd.data, ar.borrowBinaryData( size, memory_binary_detail::binary_alignment<T>::value ), size );
+  }
+
+  //! Loading for BinaryView, borrowing directly from the mapped file
+  inline void CEREAL_LOAD_FUNCTION_NAME(MappedBinaryInputArchive & ar, BinaryView & view)
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+    view.size = static_cast<std::size_t>( size );
+    view.data = ar.borrowBinaryData( view.size, 1 );
+  }
+
+  //! Loading for ArrayView, borrowing directly from the mapped file
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(MappedBinaryInputArchive & ar, ArrayView<T> & view)
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+    view.data = memory_binary_detail::borrow_array<T>( ar, size );
+    view.size = static_cast<std::size_t>( size );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::MappedBinaryOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::MappedBinaryInputArchive)
+
+// tie input and output archives together
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::MappedBinaryInputArchive, cereal::MappedBinaryOutputArchive)
+
+#endif // CEREAL_ARCHIVES_MAPPED_BINARY_HPP_
@@ -0,0 +1,580 @@
+/*! \file memory_binary.hpp
+    \brief Binary archives that operate directly on memory */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_MEMORY_BINARY_HPP_
+#define CEREAL_ARCHIVES_MEMORY_BINARY_HPP_
+
+#include <cereal/cereal.hpp>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace cereal
+{
+  class MappedBinaryOutputArchive;
+  class MappedBinaryInputArchive;
+
+  namespace memory_binary_detail
+  {
+    //! The alignment of the elements of the data wrapped by a BinaryData
+    /*! BinaryData may be created from a pointer or a reference to an array, and
+        untyped data is treated as bytes.
+        @ingroup Internal */
+    template <class T>
+    struct binary_alignment
+    {
+      using element = typename std::remove_cv<typename std::remove_all_extents<
+        typename std::remove_reference<typename std::remove_pointer<T>::type>::type>::type>::type;
+
+      static const std::size_t value = alignof(typename std::conditional<std::is_void<element>::value, char, element>::type);
+    };
+
+    //! The number of bytes needed to bring offset up to a multiple of alignment, a power of two
+    /*! @ingroup Internal */
+    inline std::size_t padding( std::size_t offset, std::size_t alignment )
+    {
+      return ( alignment - ( offset & ( alignment - 1 ) ) ) & ( alignment - 1 );
+    }
+
+    //! Checks that an alignment requested through archive options is a power of two
+    /*! @ingroup Internal */
+    inline std::size_t checked_alignment( std::size_t alignment )
+    {
+      if( alignment == 0 || ( alignment & ( alignment - 1 ) ) != 0 )
+        throw Exception("Binary data alignment must be a power of two, not " + std::to_string(alignment));
+      return alignment;
+    }
+
+    //! Zeroes written as padding
+    /*! @ingroup Internal */
+    static const char zeroes[64] = {};
+  } // namespace memory_binary_detail
+
+  // ######################################################################
+  //! An output archive designed to save binary data directly into contiguous memory
+  /*! This archive produces exactly the same representation as BinaryOutputArchive,
+      so anything it writes can be read back by a BinaryInputArchive, but instead of
+      going through a std::streambuf it copies directly into a block of memory.  Each
+      save is a bounds check and a memcpy that can be fully inlined.
+
+      The archive can either write into a caller supplied region of memory of a fixed
+      size, in which case running out of space will throw an Exception, or it can
+      append to a std::vector<char> which will be grown as needed.  When writing into
+      a vector, the vector will be resized to exactly fit the serialized data when the
+      archive is destroyed.  You can use bytesWritten() at any time to see how much data
+      has been output so far.
+
+      @code{.cpp}
+      std::vector<char> buffer;
+      {
+        cereal::MemoryBinaryOutputArchive ar( buffer );
+        ar( myData );
+      } // buffer now holds exactly the serialized data
+      @endcode
+
+      This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      With Options::Aligned, every block of binary data, such as the contents of a
+      std::vector of arithmetic values, is preceded by zeroed padding that places it
+      at a multiple of its element alignment, or of a larger requested alignment such
+      as a cache line, from the start of the output.  When such data is loaded from
+      memory aligned at least as strictly, an ArrayView can then point straight into
+      it.  Aligned data must be loaded by an archive using the same option.
+
+      \ingroup Archives */
+  class MemoryBinaryOutputArchive : public OutputArchive<MemoryBinaryOutputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! A class containing various advanced options for the memory binary output archive
+      class Options
+      {
+        public:
+          //! Default options, which produce exactly the representation of BinaryOutputArchive
+          static Options Default(){ return Options(); }
+
+          //! Pad every block of binary data to the alignment of its elements, or to alignment if that is larger
+          static Options Aligned( std::size_t alignment = 1 ){ return Options( true, alignment ); }
+
+          //! Specify specific options for the MemoryBinaryOutputArchive
+          /*! @param aligned Whether to pad blocks of binary data so that they are aligned
+              @param alignment The smallest alignment of every block, a power of two */
+          explicit Options( bool aligned = false, std::size_t alignment = 1 ) :
+            itsAlignment( aligned ? memory_binary_detail::checked_alignment( alignment ) : 0 ) { }
+
+        private:
+          friend class MemoryBinaryOutputArchive;
+          friend class MappedBinaryOutputArchive;
+          std::size_t itsAlignment; //!< 0 when blocks are not aligned
+      };
+
+      //! Construct, outputting to a fixed size region of memory
+      /*! @param data A pointer to the beginning of the region to write to
+          @param size The size of the region, in bytes.  Attempting to write more than
+                      this many bytes will throw an Exception.
+          @param options The memory binary specific options to use */
+      MemoryBinaryOutputArchive(char * data, std::size_t size, Options const & options = Options::Default()) :
+        OutputArchive<MemoryBinaryOutputArchive, AllowEmptyClassElision>(this),
+        itsBuffer(nullptr),
+        itsBegin(data),
+        itsPos(data),
+        itsEnd(data + size),
+        itsAlignment(options.itsAlignment)
+      { }
+
+      //! Construct, appending to the provided vector
+      /*! Data will be written after any existing contents of the vector, which will
+          be grown as necessary to fit the data.  Aligned blocks are aligned relative
+          to where this archive starts writing.
+
+          @param buffer The vector to append to.  This must outlive the archive.
+          @param options The memory binary specific options to use */
+      MemoryBinaryOutputArchive(std::vector<char> & buffer, Options const & options = Options::Default()) :
+        OutputArchive<MemoryBinaryOutputArchive, AllowEmptyClassElision>(this),
+        itsBuffer(&buffer),
+        itsBegin(nullptr),
+        itsPos(nullptr),
+        itsEnd(nullptr),
+        itsAlignment(options.itsAlignment)
+      {
+        bind( buffer );
+      }
+
+      //! Trims a growable buffer down to the size of the data actually written
+      ~MemoryBinaryOutputArchive()
+      {
+        trim();
+      }
+
+      //! Rebinds the archive to a fixed size region of memory, forgetting all tracked pointers and types
+      /*! If the archive was appending to a vector, the vector is first trimmed as it would
+          be on destruction.  Memory used for tracking is kept, so one archive can cheaply
+          save many independent messages.
+          @param data A pointer to the beginning of the region to write to
+          @param size The size of the region, in bytes */
+      void reset( char * data, std::size_t size )
+      {
+        trim();
+        OutputArchive<MemoryBinaryOutputArchive, AllowEmptyClassElision>::reset();
+        itsBuffer = nullptr;
+        itsBegin  = data;
+        itsPos    = data;
+        itsEnd    = data + size;
+      }
+
+      //! Rebinds the archive to append to a vector, forgetting all tracked pointers and types
+      /*! If the archive was appending to a vector, the vector is first trimmed as it would
+          be on destruction.  Memory used for tracking is kept, so one archive can cheaply
+          save many independent messages.
+          @param buffer The vector to append to.  This must outlive the archive. */
+      void reset( std::vector<char> & buffer )
+      {
+        trim();
+        OutputArchive<MemoryBinaryOutputArchive, AllowEmptyClassElision>::reset();
+        bind( buffer );
+      }
+
+      //! Writes size bytes of data to the output buffer
+      void saveBinary( const void * data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        if( static_cast<std::size_t>( itsEnd - itsPos ) < size )
+          grow( size );
+
+        std::memcpy( itsPos, data, size );
+        itsPos += size;
+      }
+
+      //! Writes a block of binary data, padded first if blocks are aligned
+      /*! @param alignment The alignment of the elements of the block */
+      void saveBinaryData( const void * data, std::size_t size, std::size_t alignment )
+      {
+        if( itsAlignment )
+          for( auto padding = memory_binary_detail::padding( bytesWritten(), std::max( alignment, itsAlignment ) ); padding; )
+          {
+            auto const chunk = std::min( padding, sizeof(memory_binary_detail::zeroes) );
+            saveBinary( memory_binary_detail::zeroes, chunk );
+            padding -= chunk;
+          }
+
+        saveBinary( data, size );
+      }
+
+      //! Returns the number of bytes that have been output by this archive
+      std::size_t bytesWritten() const
+      {
+        return static_cast<std::size_t>( itsPos - itsBegin );
+      }
+
+      //! Trims a growable buffer down to the data written and lets go of it
+      /*! Nothing more may be saved until the archive is reset. */
+      void finish()
+      {
+        trim();
+        itsBuffer = nullptr;
+        itsBegin  = nullptr;
+        itsPos    = nullptr;
+        itsEnd    = nullptr;
+      }
+
+    private:
+      //! Starts appending to a growable buffer
+      void bind( std::vector<char> & buffer )
+      {
+        auto const used = buffer.size();
+        buffer.resize( std::max( buffer.capacity(), used + 256 ) );
+        itsBuffer = &buffer;
+        itsBegin  = buffer.data();
+        itsPos    = itsBegin + used;
+        itsEnd    = itsBegin + buffer.size();
+      }
+
+      //! Trims a growable buffer down to the size of the data actually written
+      void trim()
+      {
+        if( itsBuffer )
+          itsBuffer->resize( static_cast<std::size_t>( itsPos - itsBuffer->data() ) );
+      }
+
+      //! Makes room for at least size more bytes, or throws if the buffer is fixed
+      void grow( std::size_t size )
+      {
+        if( !itsBuffer )
+          throw Exception("Failed to write " + std::to_string(size) + " bytes to output buffer! Only " +
+                          std::to_string(itsEnd - itsPos) + " bytes remaining");
+
+        auto const begin = static_cast<std::size_t>( itsBegin - itsBuffer->data() );
+        auto const used  = static_cast<std::size_t>( itsPos - itsBuffer->data() );
+        itsBuffer->resize( std::max( itsBuffer->size() * 2, used + size ) );
+
+        itsBegin = itsBuffer->data() + begin;
+        itsPos   = itsBuffer->data() + used;
+        itsEnd   = itsBuffer->data() + itsBuffer->size();
+      }
+
+      std::vector<char> * itsBuffer; //!< The growable buffer, if we were given one
+      char * itsBegin;               //!< The first byte written by this archive
+      char * itsPos;                 //!< Where the next byte will be written
+      char * itsEnd;                 //!< One past the last byte we may write
+      std::size_t itsAlignment;      //!< The smallest alignment of binary data blocks, 0 if they are not aligned
+  };
+
+  // ######################################################################
+  //! An input archive designed to load binary data directly from contiguous memory
+  /*! This archive reads the representation produced by BinaryOutputArchive and
+      MemoryBinaryOutputArchive from a caller owned region of memory.  Loads are a
+      bounds check and a memcpy from a cursor into the buffer, with no virtual dispatch.
+
+      In addition to normal loading, this archive supports borrowing data directly
+      from the buffer without copying it.  See BinaryView and borrowBinary.  Any
+      borrowed data is only valid for as long as the underlying buffer is.
+
+      This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      Data saved with MemoryBinaryOutputArchive::Options::Aligned must be loaded with
+      Options::Aligned, given the same alignment.  Arrays can then be borrowed as
+      ArrayViews, provided the buffer itself is aligned at least as strictly.
+
+      \ingroup Archives */
+  class MemoryBinaryInputArchive : public InputArchive<MemoryBinaryInputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! A class containing various advanced options for the memory binary input archive
+      class Options
+      {
+        public:
+          //! Default options, for data saved with the default output options
+          static Options Default(){ return Options(); }
+
+          //! Load data saved with MemoryBinaryOutputArchive::Options::Aligned, given the same alignment
+          static Options Aligned( std::size_t alignment = 1 ){ return Options( true, alignment ); }
+
+          //! Specify specific options for the MemoryBinaryInputArchive
+          /*! @param aligned Whether blocks of binary data are padded so that they are aligned
+              @param alignment The smallest alignment of every block, a power of two */
+          explicit Options( bool aligned = false, std::size_t alignment = 1 ) :
+            itsAlignment( aligned ? memory_binary_detail::checked_alignment( alignment ) : 0 ) { }
+
+        private:
+          friend class MemoryBinaryInputArchive;
+          friend class MappedBinaryInputArchive;
+          std::size_t itsAlignment; //!< 0 when blocks are not aligned
+      };
+
+      //! Construct, loading from the provided region of memory
+      /*! @param data A pointer to the beginning of the serialized data.  This must outlive
+                      the archive and anything borrowed from it.
+          @param size The number of bytes available to read
+          @param options The memory binary specific options to use, which must match those the data was saved with */
+      MemoryBinaryInputArchive(const char * data, std::size_t size, Options const & options = Options::Default()) :
+        InputArchive<MemoryBinaryInputArchive, AllowEmptyClassElision>(this),
+        itsBegin(data),
+        itsPos(data),
+        itsEnd(data + size),
+        itsAlignment(options.itsAlignment)
+      { }
+
+      //! Rebinds the archive to a new region of memory, forgetting all tracked pointers and types
+      /*! @param data A pointer to the beginning of the serialized data
+          @param size The number of bytes available to read */
+      void reset( const char * data, std::size_t size )
+      {
+        InputArchive<MemoryBinaryInputArchive, AllowEmptyClassElision>::reset();
+        itsBegin = data;
+        itsPos   = data;
+        itsEnd   = data + size;
+      }
+
+      //! Reads size bytes of data from the input buffer
+      void loadBinary( void * const data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        std::memcpy( data, borrowBinary( size ), size );
+      }
+
+      //! Borrows size bytes from the input buffer without copying them
+      /*! @return A pointer into the underlying buffer at the current position, which
+                  is then advanced past the borrowed data
+          @throw Exception if fewer than size bytes remain */
+      const char * borrowBinary( std::size_t size )
+      {
+        if( static_cast<std::size_t>( itsEnd - itsPos ) < size )
+          throw Exception("Failed to read " + std::to_string(size) + " bytes from input buffer! Only " +
+                          std::to_string(itsEnd - itsPos) + " bytes remaining");
+
+        auto const ptr = itsPos;
+        itsPos += size;
+        return ptr;
+      }
+
+      //! Borrows a block of binary data, skipping its padding first if blocks are aligned
+      /*! @param alignment The alignment of the elements of the block */
+      const char * borrowBinaryData( std::size_t size, std::size_t alignment )
+      {
+        if( itsAlignment )
+          borrowBinary( memory_binary_detail::padding( bytesRead(), std::max( alignment, itsAlignment ) ) );
+
+        return borrowBinary( size );
+      }
+
+      //! Returns the number of bytes that have been consumed by this archive
+      std::size_t bytesRead() const
+      {
+        return static_cast<std::size_t>( itsPos - itsBegin );
+      }
+
+      //! Returns the number of bytes remaining in the input buffer
+      std::size_t bytesRemaining() const
+      {
+        return static_cast<std::size_t>( itsEnd - itsPos );
+      }
+
+    private:
+      const char * itsBegin;    //!< The beginning of the input buffer
+      const char * itsPos;      //!< The next byte to be read
+      const char * itsEnd;      //!< One past the end of the input buffer
+      std::size_t itsAlignment; //!< The smallest alignment of binary data blocks, 0 if they are not aligned
+  };
+
+  // ######################################################################
+  //! A non owning view of a sized block of bytes
+  /*! A BinaryView is serialized identically to a std::string, so data saved as a
+      string (or as a BinaryView) can be loaded as either.  When loaded from a
+      MemoryBinaryInputArchive the view points directly into the archive's buffer
+      instead of copying the data out, which makes it suitable for large blobs and
+      strings that only need to be inspected or forwarded.
+
+      @code{.cpp}
+      cereal::MemoryBinaryInputArchive ar( receiveBuffer, receiveSize );
+      cereal::BinaryView payload;
+      ar( payload ); // payload.data points into receiveBuffer
+      @endcode
+
+      BinaryView can be saved to any archive that supports BinaryData, but can only
+      be loaded by archives that can lend out their underlying memory.
+
+      @ingroup Utility */
+  struct BinaryView
+  {
+    BinaryView() : data(nullptr), size(0) {}
+    BinaryView( const char * d, std::size_t s ) : data(d), size(s) {}
+
+    //! Copies the viewed data into a std::string
+    std::string str() const { return std::string( data, size ); }
+
+    const char * data; //!< pointer to the beginning of the viewed data
+    std::size_t size;  //!< size in bytes
+  };
+
+  // ######################################################################
+  //! A non owning view of an array of trivially serializable values
+  /*! An ArrayView is serialized identically to a std::vector<T>, so data saved as a
+      vector (or as an ArrayView) can be loaded as either.  It can be loaded from a
+      MemoryBinaryInputArchive or MappedBinaryInputArchive whose data was saved with
+      aligned binary data, in which case it points directly into the archive's buffer.
+      Loading throws an Exception if the array is not suitably aligned there.
+
+      @code{.cpp}
+      cereal::MemoryBinaryInputArchive ar( alignedBuffer, size, cereal::MemoryBinaryInputArchive::Options::Aligned() );
+      cereal::ArrayView<double> samples;
+      ar( samples ); // samples.data points into alignedBuffer
+      @endcode
+
+      @ingroup Utility */
+  template <class T>
+  struct ArrayView
+  {
+    static_assert( traits::is_trivially_serializable<T>::value, "ArrayView requires a trivially serializable type" );
+
+    ArrayView() : data(nullptr), size(0) {}
+    ArrayView( const T * d, std::size_t s ) : data(d), size(s) {}
+
+    const T * begin() const { return data; }
+    const T * end() const { return data + size; }
+
+    const T * data;   //!< pointer to the first viewed value
+    std::size_t size; //!< number of values
+  };
+
+  namespace memory_binary_detail
+  {
+    //! Borrows an aligned array of count values of type T from an archive that lends out its memory
+    /*! @ingroup Internal */
+    template <class T, class Archive> inline
+    const T * borrow_array( Archive & ar, size_type count )
+    {
+      if( count > ar.bytesRemaining() / sizeof(T) )
+        throw Exception("Failed to borrow an array of " + std::to_string(count) + " values! Only " +
+                        std::to_string(ar.bytesRemaining()) + " bytes remaining");
+
+      auto const data = ar.borrowBinaryData( static_cast<std::size_t>( count ) * sizeof(T), alignof(T) );
+      if( reinterpret_cast<std::uintptr_t>( data ) % alignof(T) != 0 )
+        throw Exception("Failed to borrow an array - the data is not aligned, so it must be saved with aligned binary data");
+
+      return reinterpret_cast<const T *>( data );
+    }
+  } // namespace memory_binary_detail
+
+  // ######################################################################
+  // MemoryBinaryArchive serialization functions
+
+  //! Saving for POD types to memory binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(MemoryBinaryOutputArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Loading for POD types from memory binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(MemoryBinaryInputArchive & ar, T & t)
+  {
+    ar.loadBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to memory binary
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(MemoryBinaryInputArchive, MemoryBinaryOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Serializing SizeTags to memory binary
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(MemoryBinaryInputArchive, MemoryBinaryOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, SizeTag<T> & t )
+  {
+    ar( t.size );
+  }
+
+  //! Saving binary data to memory binary
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(MemoryBinaryOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinaryData( bd.data, static_cast<std::size_t>( bd.size ), memory_binary_detail::binary_alignment<T>::value );
+  }
+
+  //! Loading binary data from memory binary
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(MemoryBinaryInputArchive & ar, BinaryData<T> & bd)
+  {
+    auto const size = static_cast<std::size_t>( bd.size );
+    std::memcpy( bd.data, ar.borrowBinaryData( size, memory_binary_detail::binary_alignment<T>::value ), size );
+  }
+
+  //! Saving for BinaryView, using the same representation as std::string
+  template <class Archive> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<char>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(Archive & ar, BinaryView const & view)
+  {
+    ar( make_size_tag( static_cast<size_type>(view.size) ) );
+    ar( binary_data( static_cast<const char *>( view.data ), view.size ) );
+  }
+
+  //! Loading for BinaryView, borrowing directly from the input buffer
+  inline void CEREAL_LOAD_FUNCTION_NAME(MemoryBinaryInputArchive & ar, BinaryView & view)
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+    view.size = static_cast<std::size_t>( size );
+    view.data = ar.borrowBinaryData( view.size, 1 );
+  }
+
+  //! Saving for ArrayView, using the same representation as std::vector
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<T>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(Archive & ar, ArrayView<T> const & view)
+  {
+    ar( make_size_tag( static_cast<size_type>(view.size) ) );
+    ar( binary_data( static_cast<const T *>( view.data ), view.size * sizeof(T) ) );
+  }
+
+  //! Loading for ArrayView, borrowing directly from the input buffer
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(MemoryBinaryInputArchive & ar, ArrayView<T> & view)
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+    view.data = memory_binary_detail::borrow_array<T>( ar, size );
+    view.size = static_cast<std::size_t>( size );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::MemoryBinaryOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::MemoryBinaryInputArchive)
+
+// tie input and output archives together
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::MemoryBinaryInputArchive, cereal::MemoryBinaryOutputArchive)
+
+#endif // CEREAL_ARCHIVES_MEMORY_BINARY_HPP_
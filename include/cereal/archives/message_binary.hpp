@@ -0,0 +1,274 @@
+/*! \file message_binary.hpp
+    \brief Length prefixed binary messages that can be decoded as their bytes arrive */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_MESSAGE_BINARY_HPP_
+#define CEREAL_ARCHIVES_MESSAGE_BINARY_HPP_
+
+#include <cereal/archives/memory_binary.hpp>
+#include <cereal/details/varint.hpp>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace cereal
+{
+  namespace message_binary_detail
+  {
+    //! The result of looking for a message header in a buffer
+    /*! @internal */
+    struct Header
+    {
+      bool complete;      //!< Whether the whole header is in the buffer
+      std::size_t size;   //!< The size of the header, in bytes
+      std::uint64_t body; //!< The size of the message that follows, in bytes
+    };
+
+    //! Reads a varint message header, without throwing if it is not all there yet
+    /*! @throws Exception if the header is longer than any 64 bit varint
+        @internal */
+    inline Header read_header( std::uint8_t const * data, std::size_t size )
+    {
+      std::uint64_t value = 0;
+      for( std::size_t i = 0; i < varint_detail::max_varint_size; ++i )
+      {
+        if( i == size )
+          return { false, 0, 0 };
+
+        value |= static_cast<std::uint64_t>( data[i] & 0x7F ) << ( 7 * i );
+        if( ( data[i] & 0x80 ) == 0 )
+          return { true, i + 1, value };
+      }
+
+      throw Exception("Invalid message header - its length is longer than 64 bits");
+    }
+  } // namespace message_binary_detail
+
+  // ######################################################################
+  //! Encodes length prefixed binary messages
+  /*! Each message is saved with the same representation as BinaryOutputArchive,
+      preceded by its size as a varint, so that a BinaryMessageDecoder on the other end
+      can tell when a whole message has arrived.  Every message is independent: tracked
+      pointers and types are forgotten between them, while the memory used to track them
+      is kept.
+
+      @code{.cpp}
+      cereal::BinaryMessageEncoder encoder;
+      std::vector<char> out;
+      encoder.encode( out, request );
+      send( socket, out.data(), out.size(), 0 );
+      @endcode
+
+      \ingroup Archives */
+  class BinaryMessageEncoder
+  {
+    public:
+      BinaryMessageEncoder() : itsArchive( itsScratch ) {}
+
+      BinaryMessageEncoder( BinaryMessageEncoder const & ) = delete;
+      BinaryMessageEncoder & operator=( BinaryMessageEncoder const & ) = delete;
+
+      //! Appends a message holding args to out
+      /*! If saving throws, out is left as it was. */
+      template <class ... Types> inline
+      void encode( std::vector<char> & out, Types && ... args )
+      {
+        auto const start = out.size();
+        out.resize( start + varint_detail::max_varint_size );
+
+        try
+        {
+          itsArchive.reset( out );
+          itsArchive( std::forward<Types>( args )... );
+          itsArchive.reset( itsScratch );
+        }
+        catch( ... )
+        {
+          itsArchive.reset( itsScratch );
+          out.resize( start );
+          throw;
+        }
+
+        // The body was saved after room for the longest header, so it is moved back
+        // to follow the actual header
+        auto const body = out.size() - start - varint_detail::max_varint_size;
+        std::uint8_t header[varint_detail::max_varint_size];
+        auto const headerSize = varint_detail::encode_varint( body, header );
+
+        std::memcpy( &out[start], header, headerSize );
+        std::memmove( &out[start + headerSize], &out[start + varint_detail::max_varint_size], body );
+        out.resize( start + headerSize + body );
+      }
+
+    private:
+      std::vector<char> itsScratch;         //!< Bound to the archive between messages
+      MemoryBinaryOutputArchive itsArchive; //!< Saves the body of each message
+  };
+
+  // ######################################################################
+  //! Decodes length prefixed binary messages from bytes that arrive in pieces
+  /*! Bytes are given to the decoder as they are received, for example from a
+      non-blocking socket, either by copying them in with feed or by receiving them
+      straight into the space returned by prepare and then calling commit.  Once a whole
+      message has arrived, tryLoad loads it with a MemoryBinaryInputArchive; until then
+      it returns false without touching its arguments, so it can simply be called
+      after every read.  bytesNeeded tells how much more must arrive before the next
+      message is complete.
+
+      @code{.cpp}
+      cereal::BinaryMessageDecoder decoder( 1 << 20 );
+
+      // whenever the socket is readable
+      auto const received = recv( socket, decoder.prepare( 4096 ), 4096, 0 );
+      decoder.commit( received );
+
+      Request request;
+      while( decoder.tryLoad( request ) )
+        handle( request );
+      @endcode
+
+      \ingroup Archives */
+  class BinaryMessageDecoder
+  {
+    public:
+      //! Construct an empty decoder
+      /*! @param maxMessageSize The size of the largest message that will be accepted, in bytes.
+                                A header announcing a larger message throws an Exception, so
+                                that a hostile peer can not make the decoder buffer without bound. */
+      explicit BinaryMessageDecoder( std::size_t maxMessageSize = (std::numeric_limits<std::size_t>::max)() ) :
+        itsMaxMessageSize( maxMessageSize ),
+        itsBegin( 0 ),
+        itsEnd( 0 ),
+        itsArchive( nullptr, 0 )
+      { }
+
+      BinaryMessageDecoder( BinaryMessageDecoder const & ) = delete;
+      BinaryMessageDecoder & operator=( BinaryMessageDecoder const & ) = delete;
+
+      //! Returns space for at least size bytes to be received into, to be followed by commit
+      /*! Any buffered bytes of the message in progress are kept. */
+      char * prepare( std::size_t size )
+      {
+        if( itsBuffer.size() - itsEnd < size )
+        {
+          // Decoded messages are dropped from the front before the buffer grows
+          std::memmove( itsBuffer.data(), itsBuffer.data() + itsBegin, itsEnd - itsBegin );
+          itsEnd -= itsBegin;
+          itsBegin = 0;
+
+          if( itsBuffer.size() - itsEnd < size )
+            itsBuffer.resize( std::max( itsBuffer.size() * 2, itsEnd + size ) );
+        }
+
+        return itsBuffer.data() + itsEnd;
+      }
+
+      //! Adds size bytes, received into the space returned by prepare, to the buffered input
+      void commit( std::size_t size )
+      {
+        if( size > itsBuffer.size() - itsEnd )
+          throw Exception("Committed more bytes than were prepared");
+        itsEnd += size;
+      }
+
+      //! Copies size bytes into the buffered input
+      void feed( const char * data, std::size_t size )
+      {
+        std::memcpy( prepare( size ), data, size );
+        commit( size );
+      }
+
+      //! The number of bytes buffered and not yet decoded
+      std::size_t bytesBuffered() const
+      {
+        return itsEnd - itsBegin;
+      }
+
+      //! The number of bytes that must still arrive before the next message is complete
+      /*! While the header of the next message is incomplete this returns 1, since the
+          size of the message is not known yet.  It returns 0 once tryLoad will succeed.
+          @throws Exception if the next message is larger than the limit */
+      std::size_t bytesNeeded() const
+      {
+        auto const header = nextHeader();
+        if( !header.complete )
+          return 1;
+
+        auto const total = header.size + static_cast<std::size_t>( header.body );
+        return total > bytesBuffered() ? total - bytesBuffered() : 0;
+      }
+
+      //! Loads the next message into args if all of it has arrived
+      /*! Each message is loaded by an archive that has forgotten all tracked pointers
+          and types.  If loading throws, the message is dropped, so decoding can carry on
+          with the next one.
+
+          @return true if a message was loaded, false if more bytes are needed
+          @throws Exception if the next message is larger than the limit, or can not be
+                  loaded into args */
+      template <class ... Types> inline
+      bool tryLoad( Types && ... args )
+      {
+        auto const header = nextHeader();
+        if( !header.complete )
+          return false;
+
+        auto const body = static_cast<std::size_t>( header.body );
+        if( bytesBuffered() - header.size < body )
+          return false;
+
+        auto const data = itsBuffer.data() + itsBegin + header.size;
+        itsBegin += header.size + body;
+        if( itsBegin == itsEnd )
+          itsBegin = itsEnd = 0;
+
+        itsArchive.reset( data, body );
+        itsArchive( std::forward<Types>( args )... );
+        return true;
+      }
+
+    private:
+      //! Looks for the header of the next message and checks it against the limit
+      message_binary_detail::Header nextHeader() const
+      {
+        auto const header = message_binary_detail::read_header( reinterpret_cast<std::uint8_t const *>( itsBuffer.data() + itsBegin ),
+                                                                bytesBuffered() );
+        if( header.complete && header.body > itsMaxMessageSize )
+          throw Exception("Message of " + std::to_string( header.body ) + " bytes exceeds the limit of " +
+                          std::to_string( itsMaxMessageSize ) + " bytes");
+        return header;
+      }
+
+      std::size_t itsMaxMessageSize;       //!< The largest message that is accepted
+      std::vector<char> itsBuffer;         //!< Received bytes, from itsBegin to itsEnd
+      std::size_t itsBegin;                //!< The first byte not yet decoded
+      std::size_t itsEnd;                  //!< One past the last byte received
+      MemoryBinaryInputArchive itsArchive; //!< Loads the body of each message
+  };
+} // namespace cereal
+
+#endif // CEREAL_ARCHIVES_MESSAGE_BINARY_HPP_
@@ -0,0 +1,231 @@
+/*! \file pool.hpp
+    \brief Per thread pools of archives that are reset and reused rather than constructed
+    \ingroup Archives */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_POOL_HPP_
+#define CEREAL_ARCHIVES_POOL_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace cereal
+{
+  namespace pool_detail
+  {
+    //! Completes the output of an archive that has a finish function, such as JSONOutputArchive
+    template <class Archive> inline
+    auto finish( Archive & ar, int ) -> decltype( ar.finish(), void() )
+    {
+      ar.finish();
+    }
+
+    //! Writes out anything an archive holds back until it is flushed
+    template <class Archive> inline
+    auto finish( Archive & ar, long ) -> decltype( ar.flush(), void() )
+    {
+      ar.flush();
+    }
+
+    //! Nothing to complete for archives that write everything as they go
+    template <class Archive> inline
+    void finish( Archive &, ... )
+    { }
+
+    //! Forgets everything an output archive has tracked
+    /*! This is the reset of the base archive, which the reset of a derived archive hides */
+    template <class Archive, std::uint32_t Flags> inline
+    void forget( OutputArchive<Archive, Flags> & ar )
+    {
+      ar.reset();
+    }
+
+    //! Forgets everything an input archive has tracked, releasing any objects it loaded
+    template <class Archive, std::uint32_t Flags> inline
+    void forget( InputArchive<Archive, Flags> & ar )
+    {
+      ar.reset();
+    }
+  } // namespace pool_detail
+
+  // ######################################################################
+  //! A per thread pool of archives that are reset and reused rather than constructed
+  /*! Constructing an archive allocates its tracking tables and, for some archives,
+      writers and stacks, which is significant when an archive is made for every small
+      message.  An archive acquired from the pool is taken from a free list of the
+      calling thread and rebound with its reset function, and is only constructed when
+      the list is empty.  The memory it allocated for earlier messages is kept, so a
+      thread that serializes many messages stops allocating for its archives.
+
+      @code{.cpp}
+      {
+        auto ar = cereal::ArchivePool<cereal::BinaryOutputArchive>::acquire( os );
+        (*ar)( message );
+      } // the output is complete and the archive is back in the pool
+      @endcode
+
+      The handle returned by acquire owns the archive.  When the handle is destroyed,
+      the archive completes its output as it would on destruction, forgets everything
+      it tracked (releasing any shared objects an input archive holds), and is put on
+      the free list of the thread destroying the handle.  An archive that would exceed
+      the capacity of that list is destroyed instead.
+
+      The archive must have a reset function taking the same arguments as acquire is
+      given, which are passed to its constructor when a new one is made.  This holds
+      for the binary, portable binary, memory binary and JSON output archives, and for
+      the binary, portable binary and memory binary input archives.  A JSON archive
+      taken from the pool keeps the options it was constructed with.
+
+      Compilers without thread_local (see CEREAL_HAS_THREAD_LOCAL), such as VS2013,
+      keep no free lists: every handle owns a newly constructed archive, which is
+      destroyed along with it.
+
+      @tparam Archive The type of archive pooled
+      @ingroup Utility */
+  template <class Archive>
+  class ArchivePool
+  {
+    public:
+      //! Returns an archive to the pool of the calling thread
+      struct Release
+      {
+        void operator()( Archive * archive ) const
+        {
+          std::unique_ptr<Archive> owned( archive );
+          pool_detail::finish( *archive, 0 );
+          pool_detail::forget( *archive );
+
+          freeList().give( std::move( owned ) );
+        }
+      };
+
+      //! An archive on loan from the pool
+      typedef std::unique_ptr<Archive, Release> Handle;
+
+      //! Takes an archive from the pool bound to a new target, or constructs one
+      /*! @param args The arguments to the reset function of a pooled archive, or to the
+                      constructor of a new one, such as the stream to use */
+      template <class ... Args> static
+      Handle acquire( Args && ... args )
+      {
+        auto archive = freeList().take();
+        if( !archive )
+          return Handle( new Archive( std::forward<Args>( args )... ) );
+
+        archive->reset( std::forward<Args>( args )... );
+        return Handle( archive.release() );
+      }
+
+      //! The number of archives waiting in the pool of the calling thread
+      static std::size_t available()
+      {
+        return freeList().size();
+      }
+
+      //! Sets how many archives the pool of the calling thread keeps, destroying any beyond it
+      /*! The default is 8. */
+      static void setCapacity( std::size_t capacity )
+      {
+        freeList().setCapacity( capacity );
+      }
+
+      //! Destroys every archive in the pool of the calling thread
+      static void clear()
+      {
+        freeList().clear();
+      }
+
+    private:
+      #if CEREAL_HAS_THREAD_LOCAL
+      //! The archives waiting to be reused by one thread
+      class FreeList
+      {
+        public:
+          FreeList() : itsCapacity( 8 ) {}
+
+          //! Takes the most recently returned archive, or nullptr if there is none
+          std::unique_ptr<Archive> take()
+          {
+            if( itsArchives.empty() )
+              return nullptr;
+
+            std::unique_ptr<Archive> archive( std::move( itsArchives.back() ) );
+            itsArchives.pop_back();
+            return archive;
+          }
+
+          //! Keeps an archive for reuse, or destroys it if the list is full
+          void give( std::unique_ptr<Archive> archive )
+          {
+            if( itsArchives.size() < itsCapacity )
+              itsArchives.push_back( std::move( archive ) );
+          }
+
+          std::size_t size() const { return itsArchives.size(); }
+
+          void setCapacity( std::size_t capacity )
+          {
+            itsCapacity = capacity;
+            if( itsArchives.size() > capacity )
+              itsArchives.resize( capacity );
+          }
+
+          void clear() { itsArchives.clear(); }
+
+        private:
+          std::vector<std::unique_ptr<Archive>> itsArchives;
+          std::size_t itsCapacity;
+      };
+
+      static FreeList & freeList()
+      {
+        static thread_local FreeList pool;
+        return pool;
+      }
+      #else // CEREAL_HAS_THREAD_LOCAL
+      //! Stands in for a free list when there is no thread_local to keep one per thread
+      struct FreeList
+      {
+        std::unique_ptr<Archive> take() { return nullptr; }
+        void give( std::unique_ptr<Archive> ) {}
+        std::size_t size() const { return 0; }
+        void setCapacity( std::size_t ) {}
+        void clear() {}
+      };
+
+      static FreeList freeList()
+      {
+        return FreeList();
+      }
+      #endif // CEREAL_HAS_THREAD_LOCAL
+  };
+} // namespace cereal
+
+#endif // CEREAL_ARCHIVES_POOL_HPP_
@@ -32,6 +32,21 @@
 #include <cereal/cereal.hpp>
 #include <sstream>
 #include <limits>
+#include <cstring>
+#include <vector>
+#include <complex>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
 
 namespace cereal
 {
@@ -55,6 +70,175 @@ namespace cereal
       for( std::size_t i = 0, end = DataSize / 2; i < end; ++i )
         std::swap( data[i], data[DataSize - i - 1] );
     }
+
+    //! Unsigned word types used to byte swap elements of a given size
+    /*! @ingroup Internal */
+    template <std::size_t DataSize> struct swap_word {};
+
+    template <> struct swap_word<2>
+    {
+      typedef std::uint16_t type;
+      static type swap( type v )
+      {
+        #ifdef _MSC_VER
+        return _byteswap_ushort( v );
+        #else
+        return __builtin_bswap16( v );
+        #endif
+      }
+    };
+
+    template <> struct swap_word<4>
+    {
+      typedef std::uint32_t type;
+      static type swap( type v )
+      {
+        #ifdef _MSC_VER
+        return _byteswap_ulong( v );
+        #else
+        return __builtin_bswap32( v );
+        #endif
+      }
+    };
+
+    template <> struct swap_word<8>
+    {
+      typedef std::uint64_t type;
+      static type swap( type v )
+      {
+        #ifdef _MSC_VER
+        return _byteswap_uint64( v );
+        #else
+        return __builtin_bswap64( v );
+        #endif
+      }
+    };
+
+    #if defined(__AVX2__) || defined(__SSSE3__)
+    //! Builds the pshufb control mask reversing each DataSize byte element of a 16 byte lane
+    /*! @ingroup Internal */
+    template <std::size_t DataSize>
+    inline __m128i swap_mask()
+    {
+      std::uint8_t mask[16];
+      for( std::size_t i = 0; i < 16; ++i )
+        mask[i] = static_cast<std::uint8_t>( (i / DataSize) * DataSize + (DataSize - 1 - i % DataSize) );
+      return _mm_loadu_si128( reinterpret_cast<const __m128i *>( mask ) );
+    }
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    //! Reverses each DataSize byte element of a NEON register
+    /*! @ingroup Internal */
+    inline uint8x16_t swap_neon( uint8x16_t v, std::integral_constant<std::size_t, 2> ) { return vrev16q_u8( v ); }
+    inline uint8x16_t swap_neon( uint8x16_t v, std::integral_constant<std::size_t, 4> ) { return vrev32q_u8( v ); }
+    inline uint8x16_t swap_neon( uint8x16_t v, std::integral_constant<std::size_t, 8> ) { return vrev64q_u8( v ); }
+    #endif
+
+    //! Swaps the bytes of as many whole vector registers worth of elements as possible
+    /*! The instruction set is selected at compile time; without vector support this
+        does nothing.
+        @return The number of bytes processed
+        @ingroup Internal */
+    template <std::size_t DataSize>
+    inline std::size_t swap_bytes_vector( std::uint8_t * data, std::size_t size )
+    {
+      std::size_t i = 0;
+
+      #if defined(__AVX2__)
+      __m256i const mask = _mm256_broadcastsi128_si256( swap_mask<DataSize>() );
+      for( ; i + 32 <= size; i += 32 )
+      {
+        __m256i * p = reinterpret_cast<__m256i *>( data + i );
+        _mm256_storeu_si256( p, _mm256_shuffle_epi8( _mm256_loadu_si256( p ), mask ) );
+      }
+      #elif defined(__SSSE3__)
+      __m128i const mask = swap_mask<DataSize>();
+      for( ; i + 16 <= size; i += 16 )
+      {
+        __m128i * p = reinterpret_cast<__m128i *>( data + i );
+        _mm_storeu_si128( p, _mm_shuffle_epi8( _mm_loadu_si128( p ), mask ) );
+      }
+      #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+      for( ; i + 16 <= size; i += 16 )
+        vst1q_u8( data + i, swap_neon( vld1q_u8( data + i ), std::integral_constant<std::size_t, DataSize>() ) );
+      #else
+      (void)data; (void)size;
+      #endif
+
+      return i;
+    }
+
+    //! Swaps the order of bytes for every element in a contiguous block of 2, 4, or 8 byte elements
+    /*! Whole vector registers are swapped with SSSE3/AVX2 shuffles or NEON byte reversal
+        when the compiler targets them, and the remainder with byte swap intrinsics.
+        @param data The data as a uint8_t pointer
+        @param size The size of the data in bytes, a multiple of DataSize
+        @tparam DataSize The true size of each element
+        @ingroup Internal */
+    template <std::size_t DataSize> inline
+    typename std::enable_if<DataSize == 2 || DataSize == 4 || DataSize == 8, void>::type
+    swap_bytes( std::uint8_t * data, std::size_t size )
+    {
+      typedef swap_word<DataSize> word;
+
+      for( std::size_t i = swap_bytes_vector<DataSize>( data, size ); i < size; i += DataSize )
+      {
+        typename word::type w;
+        std::memcpy( &w, data + i, DataSize );
+        w = word::swap( w );
+        std::memcpy( data + i, &w, DataSize );
+      }
+    }
+
+    //! Swaps the order of bytes for every element in a contiguous block of elements
+    /*! @param data The data as a uint8_t pointer
+        @param size The size of the data in bytes, a multiple of DataSize
+        @tparam DataSize The true size of each element
+        @ingroup Internal */
+    template <std::size_t DataSize> inline
+    typename std::enable_if<!(DataSize == 2 || DataSize == 4 || DataSize == 8), void>::type
+    swap_bytes( std::uint8_t * data, std::size_t size )
+    {
+      for( std::size_t i = 0; i < size; i += DataSize )
+        swap_bytes<DataSize>( data + i );
+    }
+
+    //! Gets the element type of the data wrapped by a BinaryData
+    /*! BinaryData may be created from a pointer or a reference to an array
+        @ingroup Internal */
+    template <class T>
+    struct binary_element
+    {
+      using type = typename std::remove_cv<typename std::remove_all_extents<
+        typename std::remove_reference<typename std::remove_pointer<T>::type>::type>::type>::type;
+    };
+
+    //! Gets the arithmetic type that is byte swapped within elements of binary data
+    /*! This is the element type itself for arithmetic types and the underlying type of
+        enums.  std::complex is swapped as its two parts.  Other types have no such type
+        and so cannot be saved as binary data.
+        @ingroup Internal */
+    template <class T, class SFINAE = void>
+    struct swapped_type
+    {
+      using type = T;
+    };
+
+    template <class T>
+    struct swapped_type<T, typename std::enable_if<std::is_enum<T>::value>::type>
+    {
+      using type = typename std::underlying_type<T>::type;
+    };
+
+    template <class T>
+    struct swapped_type<std::complex<T>>
+    {
+      using type = T;
+    };
+
+    //! The arithmetic type swapped within the data wrapped by a BinaryData
+    /*! @ingroup Internal */
+    template <class T>
+    using binary_swapped_type = typename swapped_type<typename binary_element<T>::type>::type;
   } // end namespace portable_binary_detail
 
   // ######################################################################
@@ -66,6 +250,11 @@ namespace cereal
       the user takes care of ensuring serialized types are the same size
       across machines, is portable over different architectures.
 
+      By default data is written in the byte order of the saving machine.  If
+      most readers share some other byte order, it can be selected through
+      Options so that the cost of swapping is paid once by the writer rather
+      than by every reader.
+
       When using a binary archive and a file stream, you must use the
       std::ios::binary format flag to avoid having your data altered
       inadvertently.
@@ -78,27 +267,111 @@ namespace cereal
   class PortableBinaryOutputArchive : public OutputArchive<PortableBinaryOutputArchive, AllowEmptyClassElision>
   {
     public:
+      //! A class containing various advanced options for the PortableBinaryOutput archive
+      class Options
+      {
+        public:
+          //! Represents desired endianness
+          enum class Endianness : std::uint8_t
+          { big, little };
+
+          //! Default options, preserve system endianness
+          static Options Default(){ return Options(); }
+
+          //! Save as little endian
+          static Options LittleEndian(){ return Options( Endianness::little ); }
+
+          //! Save as big endian
+          static Options BigEndian(){ return Options( Endianness::big ); }
+
+          //! Specify specific options for the PortableBinaryOutputArchive
+          /*! @param outputEndian The desired endianness of saved (output) data */
+          explicit Options( Endianness outputEndian = getEndianness() ) :
+            itsOutputEndianness( outputEndian ) { }
+
+        private:
+          //! Gets the endianness of the system
+          inline static Endianness getEndianness()
+          { return portable_binary_detail::is_little_endian() ? Endianness::little : Endianness::big; }
+
+          //! Checks if Options is set for little endian
+          inline bool is_little_endian() const
+          { return itsOutputEndianness == Endianness::little; }
+
+          friend class PortableBinaryOutputArchive;
+          Endianness itsOutputEndianness;
+      };
+
       //! Construct, outputting to the provided stream
       /*! @param stream The stream to output to.  Can be a stringstream, a file stream, or
-        even cout! */
-      PortableBinaryOutputArchive(std::ostream & stream) :
+                        even cout!
+          @param options The PortableBinary specific options to use.  See the Options struct
+                         for the values of default parameters */
+      PortableBinaryOutputArchive(std::ostream & stream, Options const & options = Options::Default()) :
         OutputArchive<PortableBinaryOutputArchive, AllowEmptyClassElision>(this),
-        itsStream(stream)
+        itsStream(&stream),
+        itsConvertEndianness( portable_binary_detail::is_little_endian() ^ options.is_little_endian() )
+      {
+        this->operator()( options.is_little_endian() );
+      }
+
+      //! Rebinds the archive to a new stream, forgetting all tracked pointers and types
+      /*! The endianness flag is written to the new stream, using the options the archive
+          was constructed with.  Memory used for tracking is kept, so one archive can cheaply
+          save many independent messages.
+          @param stream The stream to output to from now on */
+      void reset( std::ostream & stream )
       {
-        this->operator()( portable_binary_detail::is_little_endian() );
+        OutputArchive<PortableBinaryOutputArchive, AllowEmptyClassElision>::reset();
+        itsStream = &stream;
+        this->operator()( static_cast<bool>( portable_binary_detail::is_little_endian() ^ itsConvertEndianness ) );
       }
 
       //! Writes size bytes of data to the output stream
+      /*! @param data The data to save
+          @param size The number of bytes in the data
+          @tparam DataSize T The size of the actual type of the data elements being saved */
+      template <std::size_t DataSize>
       void saveBinary( const void * data, std::size_t size )
       {
-        auto const writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
+        this->statisticsCounter().binary( size );
+        if( !itsConvertEndianness )
+        {
+          write( data, size );
+          return;
+        }
+
+        // swap through a scratch buffer, a block at a time
+        std::size_t const blockSize = (swap_buffer_size / DataSize) * DataSize;
+        if( itsSwapBuffer.empty() )
+          itsSwapBuffer.resize( swap_buffer_size );
+
+        auto ptr = reinterpret_cast<const std::uint8_t*>( data );
+        while( size > 0 )
+        {
+          auto const n = std::min( size, blockSize );
+          std::memcpy( itsSwapBuffer.data(), ptr, n );
+          portable_binary_detail::swap_bytes<DataSize>( itsSwapBuffer.data(), n );
+          write( itsSwapBuffer.data(), n );
+          ptr += n;
+          size -= n;
+        }
+      }
+
+    private:
+      static const std::size_t swap_buffer_size = 4096;
+
+      void write( const void * data, std::size_t size )
+      {
+        auto const writtenSize = static_cast<std::size_t>( itsStream->rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
 
         if(writtenSize != size)
           throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
       }
 
-    private:
-      std::ostream & itsStream;
+      std::ostream * itsStream;
+      bool const itsConvertEndianness; //!< If set to true, we will need to swap bytes upon saving
+      std::vector<std::uint8_t> itsSwapBuffer;
   };
 
   // ######################################################################
@@ -134,12 +407,21 @@ namespace cereal
       /*! @param stream The stream to read from. */
       PortableBinaryInputArchive(std::istream & stream) :
         InputArchive<PortableBinaryInputArchive, AllowEmptyClassElision>(this),
-        itsStream(stream),
+        itsStream(&stream),
         itsConvertEndianness( false )
       {
-        bool streamLittleEndian;
-        this->operator()( streamLittleEndian );
-        itsConvertEndianness = portable_binary_detail::is_little_endian() ^ streamLittleEndian;
+        loadEndianness();
+      }
+
+      //! Rebinds the archive to a new stream, forgetting all tracked pointers and types
+      /*! The endianness flag is read from the new stream.
+          @param stream The stream to read from from now on */
+      void reset( std::istream & stream )
+      {
+        InputArchive<PortableBinaryInputArchive, AllowEmptyClassElision>::reset();
+        itsStream = &stream;
+        itsConvertEndianness = false;
+        loadEndianness();
       }
 
       //! Reads size bytes of data from the input stream
@@ -149,23 +431,28 @@ namespace cereal
       template <std::size_t DataSize>
       void loadBinary( void * const data, std::size_t size )
       {
+        this->statisticsCounter().binary( size );
         // load data
-        auto const readSize = static_cast<std::size_t>( itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size ) );
+        auto const readSize = static_cast<std::size_t>( itsStream->rdbuf()->sgetn( reinterpret_cast<char*>( data ), size ) );
 
         if(readSize != size)
           throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
 
         // flip bits if needed
         if( itsConvertEndianness )
-        {
-          std::uint8_t * ptr = reinterpret_cast<std::uint8_t*>( data );
-          for( std::size_t i = 0; i < size; i += DataSize )
-            portable_binary_detail::swap_bytes<DataSize>( ptr );
-        }
+          portable_binary_detail::swap_bytes<DataSize>( reinterpret_cast<std::uint8_t*>( data ), size );
       }
 
     private:
-      std::istream & itsStream;
+      //! Reads the endianness of the stream
+      void loadEndianness()
+      {
+        bool streamLittleEndian;
+        this->operator()( streamLittleEndian );
+        itsConvertEndianness = portable_binary_detail::is_little_endian() ^ streamLittleEndian;
+      }
+
+      std::istream * itsStream;
       bool itsConvertEndianness; //!< If set to true, we will need to swap bytes upon loading
   };
 
@@ -180,7 +467,7 @@ namespace cereal
     static_assert( !std::is_floating_point<T>::value ||
                    (std::is_floating_point<T>::value && std::numeric_limits<T>::is_iec559),
                    "Portable binary only supports IEEE 754 standardized floating point" );
-    ar.saveBinary(std::addressof(t), sizeof(t));
+    ar.template saveBinary<sizeof(T)>(std::addressof(t), sizeof(t));
   }
 
   //! Loading for POD types from portable binary
@@ -211,22 +498,28 @@ namespace cereal
   }
 
   //! Saving binary data to portable binary
+  /*! Only blocks of arithmetic types, enums and std::complex are supported, since
+      anything else cannot be byte swapped on load. */
   template <class T> inline
-  void CEREAL_SAVE_FUNCTION_NAME(PortableBinaryOutputArchive & ar, BinaryData<T> const & bd)
+  typename std::enable_if<std::is_arithmetic<portable_binary_detail::binary_swapped_type<T>>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(PortableBinaryOutputArchive & ar, BinaryData<T> const & bd)
   {
-    typedef typename std::remove_pointer<T>::type TT;
+    typedef portable_binary_detail::binary_swapped_type<T> TT;
     static_assert( !std::is_floating_point<TT>::value ||
                    (std::is_floating_point<TT>::value && std::numeric_limits<TT>::is_iec559),
                    "Portable binary only supports IEEE 754 standardized floating point" );
 
-    ar.saveBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+    ar.template saveBinary<sizeof(TT)>( bd.data, static_cast<std::size_t>( bd.size ) );
   }
 
   //! Loading binary data from portable binary
+  /*! Only blocks of arithmetic types, enums and std::complex are supported, since
+      anything else cannot be byte swapped on load. */
   template <class T> inline
-  void CEREAL_LOAD_FUNCTION_NAME(PortableBinaryInputArchive & ar, BinaryData<T> & bd)
+  typename std::enable_if<std::is_arithmetic<portable_binary_detail::binary_swapped_type<T>>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(PortableBinaryInputArchive & ar, BinaryData<T> & bd)
   {
-    typedef typename std::remove_pointer<T>::type TT;
+    typedef portable_binary_detail::binary_swapped_type<T> TT;
     static_assert( !std::is_floating_point<TT>::value ||
                    (std::is_floating_point<TT>::value && std::numeric_limits<TT>::is_iec559),
                    "Portable binary only supports IEEE 754 standardized floating point" );
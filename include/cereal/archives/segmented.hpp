@@ -0,0 +1,317 @@
+/*! \file segmented.hpp
+    \brief A container of independent archive segments that can be saved and loaded concurrently */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_SEGMENTED_HPP_
+#define CEREAL_ARCHIVES_SEGMENTED_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/details/streambuf.hpp>
+#include <cstring>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace cereal
+{
+  namespace segmented_detail
+  {
+    //! Marks the end of a segmented container
+    /*! @ingroup Internal */
+    static const std::uint32_t magic = 0x47455343; // "CSEG"
+
+    //! The size of the footer at the end of a segmented container
+    /*! The footer holds the position of the directory, the number of segments, and the magic number.
+        @ingroup Internal */
+    static const std::uint64_t footer_size = 2 * sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+    //! Where a segment is stored
+    /*! @internal */
+    struct Segment
+    {
+      std::uint64_t offset; //!< Position of the segment, relative to the start of the container
+      std::uint64_t size;   //!< Size of the segment in bytes
+    };
+  } // namespace segmented_detail
+
+  // ######################################################################
+  //! Writes a container of independently saved, named segments
+  /*! Each segment is saved by an archive of its own, of type OutputArchiveType,
+      so it has its own pointer and type tables and does not refer to anything in
+      other segments.  Segments can be saved concurrently from any number of threads:
+      each is serialized into a buffer of its own, which is appended to the stream
+      under a lock once it is complete.  A directory of all segments is written when
+      the container is finished.
+
+      @code{.cpp}
+      cereal::SegmentedArchiveWriter<cereal::BinaryOutputArchive> writer( file );
+
+      // from any thread
+      writer.saveSegment( "physics", [&]( cereal::BinaryOutputArchive & ar ) { ar( physics ); } );
+
+      writer.finish();
+      @endcode
+
+      @tparam OutputArchiveType An output archive that can be constructed from a std::ostream
+      \ingroup Archives */
+  template <class OutputArchiveType>
+  class SegmentedArchiveWriter
+  {
+    public:
+      //! Construct, writing to the provided stream
+      /*! @param stream The stream to write to, which should be opened in binary mode.
+                        It does not need to be seekable. */
+      SegmentedArchiveWriter( std::ostream & stream ) :
+        itsStream( stream ),
+        itsPosition( 0 ),
+        itsFinished( false )
+      { }
+
+      SegmentedArchiveWriter( SegmentedArchiveWriter const & ) = delete;
+      SegmentedArchiveWriter & operator=( SegmentedArchiveWriter const & ) = delete;
+
+      //! Destructor, finishes the container if that was not done already
+      /*! Errors cannot be reported here, so call finish to find out whether the directory was written */
+      ~SegmentedArchiveWriter()
+      {
+        if( !itsFinished )
+          try { finish(); } catch( ... ) {}
+      }
+
+      //! Saves a segment, calling save with a new archive for it
+      /*! This may be called concurrently from several threads.  If save throws, nothing of
+          the segment is written.
+
+          @param name A name for the segment, unique within the container
+          @param save A function taking an OutputArchiveType &, which saves the contents of the segment
+          @throws Exception if the name is already used, or the container is finished */
+      template <class F> inline
+      void saveSegment( std::string const & name, F && save )
+      {
+        std::string buffer;
+        {
+          streambuf_detail::StringWriteBuffer streamBuffer( buffer );
+          std::ostream stream( &streamBuffer );
+          OutputArchiveType ar( stream );
+          save( ar );
+        }
+
+        std::lock_guard<std::mutex> lock( itsMutex );
+        if( itsFinished )
+          throw Exception("Can not save a segment after the container is finished");
+        if( !itsNames.insert( name ).second )
+          throw Exception("A segment named " + name + " was already saved");
+
+        write( buffer.data(), buffer.size() );
+        itsDirectory.push_back( { name, { itsPosition - buffer.size(), buffer.size() } } );
+      }
+
+      //! Writes the directory of all segments, after which no more can be saved
+      void finish()
+      {
+        std::lock_guard<std::mutex> lock( itsMutex );
+        if( itsFinished )
+          return;
+        itsFinished = true;
+
+        std::uint64_t const directory = itsPosition;
+        for( auto const & entry : itsDirectory )
+        {
+          std::uint64_t const nameSize = entry.first.size();
+          write( &nameSize, sizeof(nameSize) );
+          write( entry.first.data(), entry.first.size() );
+          write( &entry.second.offset, sizeof(entry.second.offset) );
+          write( &entry.second.size, sizeof(entry.second.size) );
+        }
+
+        std::uint64_t const count = itsDirectory.size();
+        write( &directory, sizeof(directory) );
+        write( &count, sizeof(count) );
+        write( &segmented_detail::magic, sizeof(segmented_detail::magic) );
+        itsStream.flush();
+      }
+
+    private:
+      //! Writes size bytes to the stream, keeping track of the position
+      void write( const void * data, std::size_t size )
+      {
+        auto const writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
+        itsPosition += writtenSize;
+
+        if(writtenSize != size)
+          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+      }
+
+      std::ostream & itsStream;
+      std::mutex itsMutex;       //!< Guards the stream and the directory
+      std::uint64_t itsPosition; //!< Bytes written to the stream
+      bool itsFinished;          //!< Whether the directory has been written
+      std::unordered_set<std::string> itsNames; //!< Names of the segments saved so far
+      std::vector<std::pair<std::string, segmented_detail::Segment>> itsDirectory; //!< Segments in the order they were written
+  };
+
+  // ######################################################################
+  //! Reads a container written by SegmentedArchiveWriter, loading segments in any order
+  /*! The directory is read when the reader is constructed.  Segments can then be
+      loaded by name, concurrently from any number of threads: the bytes of a segment
+      are read from the stream under a lock, and then loaded from memory by an archive
+      of its own, of type InputArchiveType.
+
+      @tparam InputArchiveType An input archive that can be constructed from a std::istream
+      \ingroup Archives */
+  template <class InputArchiveType>
+  class SegmentedArchiveReader
+  {
+    public:
+      //! Construct, reading the directory from the provided stream
+      /*! @param stream The stream to read from, which must be seekable.  The container
+                        begins at its current position and ends at the end of the stream.
+          @throws Exception if the stream does not end with a valid directory */
+      SegmentedArchiveReader( std::istream & stream ) :
+        itsStream( stream ),
+        itsStart( stream.tellg() )
+      {
+        if( itsStart == std::istream::pos_type(-1) || !itsStream.seekg( 0, std::ios::end ) )
+          throw Exception("SegmentedArchiveReader requires a seekable stream");
+
+        auto const size = static_cast<std::uint64_t>( itsStream.tellg() - itsStart );
+        if( size < segmented_detail::footer_size )
+          throw Exception("Invalid segmented container - too small to hold a directory");
+
+        std::uint64_t directory, count;
+        std::uint32_t magic;
+        seek( size - segmented_detail::footer_size );
+        read( &directory, sizeof(directory) );
+        read( &count, sizeof(count) );
+        read( &magic, sizeof(magic) );
+
+        auto const directoryEnd = size - segmented_detail::footer_size;
+        if( magic != segmented_detail::magic )
+          throw Exception("Invalid segmented container - the directory is missing");
+        if( directory > directoryEnd )
+          throw Exception("Invalid segmented container - the directory does not fit in the stream");
+
+        // names are read into one block, bounded by the size of the directory
+        std::vector<char> entries( static_cast<std::size_t>( directoryEnd - directory ) );
+        seek( directory );
+        read( entries.data(), entries.size() );
+
+        std::size_t pos = 0;
+        auto take = [&]( void * data, std::size_t bytes )
+        {
+          if( bytes > entries.size() - pos )
+            throw Exception("Invalid segmented container - the directory is truncated");
+          std::memcpy( data, entries.data() + pos, bytes );
+          pos += bytes;
+        };
+
+        for( std::uint64_t i = 0; i < count; ++i )
+        {
+          std::uint64_t nameSize;
+          take( &nameSize, sizeof(nameSize) );
+          if( nameSize > entries.size() - pos )
+            throw Exception("Invalid segmented container - the directory is truncated");
+
+          std::string name( entries.data() + pos, static_cast<std::size_t>( nameSize ) );
+          pos += static_cast<std::size_t>( nameSize );
+
+          segmented_detail::Segment segment;
+          take( &segment.offset, sizeof(segment.offset) );
+          take( &segment.size, sizeof(segment.size) );
+          if( segment.offset > directory || segment.size > directory - segment.offset )
+            throw Exception("Invalid segmented container - segment " + name + " is out of place");
+
+          itsNames.push_back( name );
+          itsSegments.emplace( std::move( name ), segment );
+        }
+      }
+
+      SegmentedArchiveReader( SegmentedArchiveReader const & ) = delete;
+      SegmentedArchiveReader & operator=( SegmentedArchiveReader const & ) = delete;
+
+      //! The names of all segments, in the order they were written
+      std::vector<std::string> const & segmentNames() const { return itsNames; }
+
+      //! Whether a segment with the given name exists
+      bool hasSegment( std::string const & name ) const { return itsSegments.count( name ) != 0; }
+
+      //! Loads a segment, calling load with a new archive for it
+      /*! This may be called concurrently from several threads.
+
+          @param name The name of the segment
+          @param load A function taking an InputArchiveType &, which loads the contents of the segment
+          @throws Exception if there is no such segment */
+      template <class F> inline
+      void loadSegment( std::string const & name, F && load )
+      {
+        auto const segment = itsSegments.find( name );
+        if( segment == itsSegments.end() )
+          throw Exception("There is no segment named " + name);
+
+        std::vector<char> buffer( static_cast<std::size_t>( segment->second.size ) );
+        {
+          std::lock_guard<std::mutex> lock( itsMutex );
+          seek( segment->second.offset );
+          read( buffer.data(), buffer.size() );
+        }
+
+        streambuf_detail::MemoryReadBuffer streamBuffer( buffer.data(), buffer.size() );
+        std::istream stream( &streamBuffer );
+        InputArchiveType ar( stream );
+        load( ar );
+      }
+
+    private:
+      //! Moves to a position relative to the start of the container
+      void seek( std::uint64_t pos )
+      {
+        if( !itsStream.seekg( itsStart + static_cast<std::streamoff>( pos ) ) )
+          throw Exception("Failed to seek in the input stream");
+      }
+
+      //! Reads size bytes from the stream
+      void read( void * data, std::size_t size )
+      {
+        auto const readSize = static_cast<std::size_t>( itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size ) );
+
+        if(readSize != size)
+          throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+      }
+
+      std::istream & itsStream;
+      std::istream::pos_type itsStart;   //!< Where the container begins in the stream
+      std::mutex itsMutex;               //!< Guards the stream
+      std::vector<std::string> itsNames; //!< Names of the segments, in the order they were written
+      std::unordered_map<std::string, segmented_detail::Segment> itsSegments; //!< Where each segment is stored
+  };
+} // namespace cereal
+
+#endif // CEREAL_ARCHIVES_SEGMENTED_HPP_
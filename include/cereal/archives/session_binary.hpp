@@ -0,0 +1,378 @@
+/*! \file session_binary.hpp
+    \brief Binary archives for a stream of length prefixed records that share type information */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_SESSION_BINARY_HPP_
+#define CEREAL_ARCHIVES_SESSION_BINARY_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/details/varint.hpp>
+#include <algorithm>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+namespace cereal
+{
+  namespace session_binary_detail
+  {
+    //! Flag in a record header signifying that the record registers type information
+    /*! @ingroup Internal */
+    static const std::uint8_t defines_types_flag = 0x01;
+
+    //! Flag in a record header signifying that all type information was forgotten before the record
+    /*! @ingroup Internal */
+    static const std::uint8_t resets_types_flag = 0x02;
+  } // namespace session_binary_detail
+
+  // ######################################################################
+  //! An output archive that saves a stream of binary records sharing type information
+  /*! Each call to writeRecord saves one record, which is serialized exactly as
+      BinaryOutputArchive would serialize it and prefixed by a small header holding
+      its length, a tag chosen by the caller, and flags.  A reader can use the header
+      to dispatch the record to the right loading code or to skip it entirely.
+
+      Polymorphic type names, interned strings, and class versions are registered
+      once for the whole stream rather than once per record, so only the first record
+      using a type carries its name and version.  Shared pointers are tracked within a
+      record only, so every record holds the objects it points to.
+
+      Since later records may refer back to type information registered by earlier
+      ones, a record that registered any is flagged as doing so, and
+      SessionBinaryInputArchive will not skip it.
+
+      The record is built in memory and only written once it is complete, so a
+      serialization that throws leaves nothing of the record in the stream.  Type
+      information it registered is then forgotten, and the next record tells the
+      reader to forget its own.
+
+      This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      \ingroup Archives */
+  class SessionBinaryOutputArchive : public OutputArchive<SessionBinaryOutputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, outputting to the provided stream
+      /*! @param stream The stream to output to, which should be opened in binary mode */
+      SessionBinaryOutputArchive(std::ostream & stream) :
+        OutputArchive<SessionBinaryOutputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream),
+        itsResetTypes(false)
+      { }
+
+      //! Saves a single record holding the given data
+      /*! @param tag A value of the caller's choice, stored in the record header
+          @param args The data to save */
+      template <class ... Types> inline
+      void writeRecord( std::uint32_t tag, Types && ... args )
+      {
+        resetPointers();
+        itsRecord.clear();
+
+        auto const definitions = definitionCount();
+        try
+        {
+          (*this)( std::forward<Types>( args )... );
+        }
+        catch( ... )
+        {
+          // the reader never sees what was registered, so both sides start over
+          reset();
+          itsResetTypes = true;
+          throw;
+        }
+
+        std::uint8_t flags = 0;
+        if( definitionCount() != definitions )
+          flags |= session_binary_detail::defines_types_flag;
+        if( itsResetTypes )
+          flags |= session_binary_detail::resets_types_flag;
+
+        std::uint8_t header[2 * varint_detail::max_varint_size + 1];
+        auto size = varint_detail::encode_varint( itsRecord.size(), header );
+        size += varint_detail::encode_varint( tag, header + size );
+        header[size++] = flags;
+
+        write( header, size );
+        write( itsRecord.data(), itsRecord.size() );
+        itsResetTypes = false;
+      }
+
+      //! Writes size bytes of data to the current record
+      void saveBinary( const void * data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        auto const bytes = reinterpret_cast<const char *>( data );
+        itsRecord.insert( itsRecord.end(), bytes, bytes + size );
+      }
+
+    private:
+      //! Writes size bytes of data to the output stream
+      void write( const void * data, std::size_t size )
+      {
+        auto const writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
+
+        if(writtenSize != size)
+          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+      }
+
+      std::ostream & itsStream;
+      std::vector<char> itsRecord; //!< The record being saved, kept between records for its memory
+      bool itsResetTypes;          //!< Whether type information was forgotten since the last record
+  };
+
+  // ######################################################################
+  //! An input archive that loads records saved by SessionBinaryOutputArchive
+  /*! Records are visited in order with nextRecord, after which each can be
+      inspected through its tag and then either loaded with readRecord or skipped
+      with skipRecord:
+
+      @code{.cpp}
+      cereal::SessionBinaryInputArchive ar( stream );
+      while( ar.nextRecord() )
+      {
+        if( ar.recordTag() == PositionTag )
+          ar.readRecord( position );
+        else
+          ar.skipRecord();
+      }
+      @endcode
+
+      Loading a record may leave part of it unread, such as fields added by a newer
+      writer, which is then skipped.  Loading more than a record holds throws.
+
+      Since type information is shared between records, records must be visited in
+      the order they were written, and records that register type information can
+      not be skipped.
+
+      \ingroup Archives */
+  class SessionBinaryInputArchive : public InputArchive<SessionBinaryInputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, loading from the provided stream
+      SessionBinaryInputArchive(std::istream & stream) :
+        InputArchive<SessionBinaryInputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream),
+        itsRemaining(0),
+        itsTag(0),
+        itsFlags(0),
+        itsPending(false)
+      { }
+
+      //! Moves to the next record, reading its header
+      /*! A record that was neither loaded nor skipped is skipped first.
+          @return false if the stream holds no further records */
+      bool nextRecord()
+      {
+        if( itsPending )
+          skipRecord();
+        discardRemaining();
+
+        auto const first = itsStream.rdbuf()->sbumpc();
+        if( std::char_traits<char>::eq_int_type( first, std::char_traits<char>::eof() ) )
+          return false;
+
+        auto const size = readVarint( first );
+        auto const tag = readVarint( itsStream.rdbuf()->sbumpc() );
+        if( tag > std::numeric_limits<std::uint32_t>::max() )
+          throw Exception("Invalid record header - the tag does not fit in 32 bits");
+
+        auto const flags = itsStream.rdbuf()->sbumpc();
+        if( std::char_traits<char>::eq_int_type( flags, std::char_traits<char>::eof() ) )
+          throw Exception("Failed to read a record header - the stream ended");
+
+        itsRemaining = size;
+        itsTag = static_cast<std::uint32_t>( tag );
+        itsFlags = static_cast<std::uint8_t>( flags );
+        itsPending = true;
+        return true;
+      }
+
+      //! The tag of the current record, given to writeRecord when it was saved
+      std::uint32_t recordTag() const { return itsTag; }
+
+      //! The number of bytes in the current record that remain to be loaded
+      std::uint64_t recordSize() const { return itsRemaining; }
+
+      //! Whether the current record registers type information, so can not be skipped
+      bool recordDefinesTypes() const { return ( itsFlags & session_binary_detail::defines_types_flag ) != 0; }
+
+      //! Loads the given data from the current record
+      /*! @throws Exception if there is no current record, or it holds less data than requested */
+      template <class ... Types> inline
+      void readRecord( Types && ... args )
+      {
+        if( !itsPending )
+          throw Exception("No record to read - call nextRecord first");
+
+        itsPending = false;
+        startRecord();
+        (*this)( std::forward<Types>( args )... );
+        discardRemaining();
+      }
+
+      //! Skips the current record without loading it
+      /*! @throws Exception if there is no current record, or it registers type information */
+      void skipRecord()
+      {
+        if( !itsPending )
+          throw Exception("No record to skip - call nextRecord first");
+        if( recordDefinesTypes() )
+          throw Exception("Can not skip a record that registers type information - it must be read");
+
+        itsPending = false;
+        startRecord();
+        discardRemaining();
+      }
+
+      //! Reads size bytes of data from the current record
+      void loadBinary( void * const data, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        if( size > itsRemaining )
+          throw Exception("Failed to read " + std::to_string(size) + " bytes from the record! Only " + std::to_string(itsRemaining) + " remain");
+
+        auto const readSize = static_cast<std::size_t>( itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size ) );
+        itsRemaining -= readSize;
+
+        if(readSize != size)
+          throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+      }
+
+    private:
+      //! Prepares the tracked state for the current record
+      void startRecord()
+      {
+        if( itsFlags & session_binary_detail::resets_types_flag )
+          reset();
+        else
+          resetPointers();
+      }
+
+      //! Reads a variable length integer from the header, given its first byte
+      std::uint64_t readVarint( std::char_traits<char>::int_type c )
+      {
+        std::uint64_t value = 0;
+        for( unsigned shift = 0; shift < 64; shift += 7 )
+        {
+          if( std::char_traits<char>::eq_int_type( c, std::char_traits<char>::eof() ) )
+            throw Exception("Failed to read a record header - the stream ended");
+
+          auto const byte = static_cast<std::uint8_t>( c );
+          value |= static_cast<std::uint64_t>( byte & 0x7f ) << shift;
+          if( !( byte & 0x80 ) )
+            return value;
+
+          c = itsStream.rdbuf()->sbumpc();
+        }
+
+        throw Exception("Invalid record header - a variable length integer is too long");
+      }
+
+      //! Skips the unread remainder of the current record
+      void discardRemaining()
+      {
+        char buffer[4096];
+        while( itsRemaining )
+        {
+          auto const size = static_cast<std::streamsize>( std::min<std::uint64_t>( itsRemaining, sizeof(buffer) ) );
+          if( itsStream.rdbuf()->sgetn( buffer, size ) != size )
+          {
+            itsRemaining = 0;
+            throw Exception("Failed to skip a record - the stream ended");
+          }
+          itsRemaining -= static_cast<std::uint64_t>( size );
+        }
+      }
+
+      std::istream & itsStream;
+      std::uint64_t itsRemaining; //!< Bytes of the current record not yet read
+      std::uint32_t itsTag;       //!< Tag of the current record
+      std::uint8_t itsFlags;      //!< Flags of the current record
+      bool itsPending;            //!< Whether the current record has been neither read nor skipped
+  };
+
+  // ######################################################################
+  // Common SessionBinaryArchive serialization functions
+
+  //! Saving for POD types to session binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(SessionBinaryOutputArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Loading for POD types from session binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(SessionBinaryInputArchive & ar, T & t)
+  {
+    ar.loadBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to session binary
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(SessionBinaryInputArchive, SessionBinaryOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Serializing SizeTags to session binary
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(SessionBinaryInputArchive, SessionBinaryOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, SizeTag<T> & t )
+  {
+    ar( t.size );
+  }
+
+  //! Saving binary data
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(SessionBinaryOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+
+  //! Loading binary data
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(SessionBinaryInputArchive & ar, BinaryData<T> & bd)
+  {
+    ar.loadBinary(bd.data, static_cast<std::size_t>(bd.size));
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::SessionBinaryOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::SessionBinaryInputArchive)
+
+// tie input and output archives together
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::SessionBinaryInputArchive, cereal::SessionBinaryOutputArchive)
+
+#endif // CEREAL_ARCHIVES_SESSION_BINARY_HPP_
@@ -0,0 +1,473 @@
+/*! \file shared_ring.hpp
+    \brief Binary messages passed through a single producer, single consumer ring buffer in shared memory */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_SHARED_RING_HPP_
+#define CEREAL_ARCHIVES_SHARED_RING_HPP_
+
+#include <cereal/archives/memory_binary.hpp>
+#include <cereal/archives/message_binary.hpp>
+#include <cereal/archives/size_computing.hpp>
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace cereal
+{
+  namespace shared_ring_detail
+  {
+    static_assert( ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+                   "Shared ring buffers need lock free atomics to work across processes" );
+
+    //! Identifies memory that holds a ring, written once the ring is ready to be used
+    /*! @ingroup Internal */
+    static const std::uint64_t ring_magic = 0x474E495220524543ULL; // "CER RING"
+
+    //! The size of every message header, a varint padded to a fixed width
+    /*! @ingroup Internal */
+    static const std::size_t header_size = 5;
+
+    //! The header value telling the reader that the next message starts at the beginning of the ring
+    /*! This is the largest value a header can hold, so it is never the size of a message.
+        @ingroup Internal */
+    static const std::uint64_t wrap_marker = ( std::uint64_t(1) << ( 7 * header_size ) ) - 1;
+
+    //! The largest ring that can be created, which keeps every message well below wrap_marker
+    /*! @ingroup Internal */
+    static const std::size_t max_capacity = std::size_t(1) << 30;
+
+    //! The smallest ring that can be created
+    /*! @ingroup Internal */
+    static const std::size_t min_capacity = 64;
+
+    //! The shared state at the start of the ring memory
+    /*! The counters only ever grow, counting every byte that passed through the
+        ring, so that a full ring and an empty one can be told apart.  The producer
+        and consumer state live on separate cache lines so that neither side's writes
+        slow down the other's reads.
+        @internal */
+    struct Control
+    {
+      std::atomic<std::uint64_t> magic;                 //!< ring_magic once the ring is ready
+      std::uint64_t capacity;                           //!< The size of the data area, a power of two
+      alignas(64) std::atomic<std::uint64_t> head;      //!< One past the last byte published by the writer
+      alignas(64) std::atomic<std::uint64_t> tail;      //!< One past the last byte released by the reader
+      alignas(64) std::atomic<std::uint32_t> signal;    //!< Bumped to wake a sleeping reader
+      std::atomic<std::uint32_t> sleeping;              //!< Set while the reader is, or is about to be, asleep
+    };
+
+    static_assert( sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+                   "The reader sleeps on the address of an atomic, which must be a plain integer" );
+
+    //! Encodes a header as a varint of exactly header_size bytes
+    /*! Every byte but the last has its continuation bit set, so the result is read
+        back as the same value by any varint decoder.
+        @internal */
+    inline void encode_header( std::uint64_t value, char * out )
+    {
+      for( std::size_t i = 0; i + 1 < header_size; ++i, value >>= 7 )
+        out[i] = static_cast<char>( ( value & 0x7F ) | 0x80 );
+      out[header_size - 1] = static_cast<char>( value & 0x7F );
+    }
+
+    //! Returns the bytes skipped at the end of the ring because no header fits there
+    /*! @internal */
+    inline std::size_t padding( std::uint64_t position, std::size_t capacity )
+    {
+      auto const remaining = capacity - static_cast<std::size_t>( position & ( capacity - 1 ) );
+      return remaining < header_size ? remaining : 0;
+    }
+
+    //! Puts the reader to sleep until signal no longer holds value
+    /*! Without futexes the reader only yields, so waking it is just a matter of
+        changing signal.
+        @internal */
+    inline void wait( std::atomic<std::uint32_t> & signal, std::uint32_t value )
+    {
+      #ifdef __linux__
+      // not FUTEX_PRIVATE_FLAG, since the two sides may be in different processes
+      syscall( SYS_futex, reinterpret_cast<std::uint32_t *>( &signal ), FUTEX_WAIT, value, nullptr, nullptr, 0 );
+      #else
+      if( signal.load( std::memory_order_acquire ) == value )
+        std::this_thread::yield();
+      #endif
+    }
+
+    //! Wakes the reader sleeping in wait
+    /*! @internal */
+    inline void wake( std::atomic<std::uint32_t> & signal )
+    {
+      signal.fetch_add( 1, std::memory_order_seq_cst );
+      #ifdef __linux__
+      syscall( SYS_futex, reinterpret_cast<std::uint32_t *>( &signal ), FUTEX_WAKE, 1, nullptr, nullptr, 0 );
+      #endif
+    }
+
+    //! Checks and returns the control block at the start of ring memory
+    /*! @internal */
+    inline Control * control( void * memory, std::size_t size )
+    {
+      if( reinterpret_cast<std::uintptr_t>( memory ) % alignof(Control) != 0 )
+        throw Exception("Shared ring memory must be aligned to " + std::to_string( alignof(Control) ) + " bytes");
+      if( size < sizeof(Control) + min_capacity )
+        throw Exception("Shared ring memory of " + std::to_string( size ) + " bytes is too small to hold a ring");
+      return static_cast<Control *>( memory );
+    }
+  } // namespace shared_ring_detail
+
+  // ######################################################################
+  //! Saves binary messages into a ring buffer in shared memory, to be loaded by a SharedRingReader
+  /*! The ring lives in memory supplied by the caller, typically a shared mapping
+      between two processes, and connects exactly one writer to exactly one reader
+      without any locks.  Each message is serialized by a MemoryBinaryOutputArchive
+      straight into the free space of the ring, so it is never copied, and is then
+      published by advancing a single atomic counter.
+
+      Messages are framed exactly as BinaryMessageEncoder frames them, with a varint
+      length before each one, except that the varint always occupies five bytes so
+      that it can be written once the size of the message is known.  A message that
+      does not fit before the end of the ring is saved at its start instead.  Every
+      message is independent: tracked pointers and types are forgotten between them.
+
+      The reader is only woken through the operating system when it has gone to
+      sleep waiting for a message; on Linux this uses a futex in the shared memory,
+      elsewhere a sleeping reader yields instead.
+
+      @code{.cpp}
+      // in the producer, once the memory is shared
+      cereal::SharedRingWriter writer( memory, size );
+      writer.write( request );
+
+      // in the consumer, once the writer has set up the ring
+      cereal::SharedRingReader reader( memory, size );
+      Request request;
+      reader.read( request );
+      @endcode
+
+      The memory must be aligned to 64 bytes, which any page aligned mapping is.
+      This archive does nothing to ensure that the endianness of the saved and
+      loaded data is the same.
+
+      \ingroup Archives */
+  class SharedRingWriter
+  {
+    public:
+      //! Construct, setting up an empty ring in the given memory
+      /*! The ring uses the largest power of two bytes that fit in the memory after
+          its control block.  Anything the memory held before is discarded.
+
+          @param memory The memory to hold the ring, aligned to 64 bytes, which must outlive the writer
+          @param size The size of the memory, in bytes
+          @throws Exception if the memory is misaligned or too small */
+      SharedRingWriter( void * memory, std::size_t size ) :
+        itsControl( shared_ring_detail::control( memory, size ) ),
+        itsData( static_cast<char *>( memory ) + sizeof(shared_ring_detail::Control) ),
+        itsCapacity( 1 ),
+        itsHead( 0 ),
+        itsTail( 0 ),
+        itsArchive( nullptr, 0 )
+      {
+        auto const available = size - sizeof(shared_ring_detail::Control);
+        while( itsCapacity * 2 <= available && itsCapacity < shared_ring_detail::max_capacity )
+          itsCapacity *= 2;
+
+        auto control = new (memory) shared_ring_detail::Control();
+        control->capacity = itsCapacity;
+        control->head.store( 0, std::memory_order_relaxed );
+        control->tail.store( 0, std::memory_order_relaxed );
+        control->signal.store( 0, std::memory_order_relaxed );
+        control->sleeping.store( 0, std::memory_order_relaxed );
+        control->magic.store( shared_ring_detail::ring_magic, std::memory_order_release );
+      }
+
+      SharedRingWriter( SharedRingWriter const & ) = delete;
+      SharedRingWriter & operator=( SharedRingWriter const & ) = delete;
+
+      //! Saves a message holding args if the ring has room for it
+      /*! @return true if the message was published, false if the ring is too full
+                  right now, in which case nothing was written
+          @throws Exception if the message could never fit in the ring, or if saving
+                  args throws, in which case nothing was written */
+      template <class ... Types> inline
+      bool tryWrite( Types && ... args )
+      {
+        auto const start = itsHead + shared_ring_detail::padding( itsHead, itsCapacity );
+        auto const space = contiguousSpace( start );
+
+        try
+        {
+          if( space > shared_ring_detail::header_size )
+            return publish( save( start, space, args... ) );
+        }
+        catch( Exception const & )
+        {
+          // saving also throws when the message overflows the space it was given,
+          // which is only told apart from a real error by the size of the message
+          if( shared_ring_detail::header_size + serialized_size( args... ) <= space )
+            throw;
+        }
+
+        auto const size = shared_ring_detail::header_size + serialized_size( args... );
+        if( size > itsCapacity )
+          throw Exception("Message of " + std::to_string( size ) + " bytes does not fit in a shared ring of " +
+                          std::to_string( itsCapacity ) + " bytes");
+
+        // The message goes at the start of the ring, after a marker telling the reader to
+        // skip there.  Room at the start means everything before it is free as well.
+        auto const offset = static_cast<std::size_t>( start & ( itsCapacity - 1 ) );
+        if( offset == 0 || contiguousSpace( start + ( itsCapacity - offset ) ) < size )
+          return false;
+
+        auto const end = save( start + ( itsCapacity - offset ), size, args... );
+        shared_ring_detail::encode_header( shared_ring_detail::wrap_marker, itsData + offset );
+        return publish( end );
+      }
+
+      //! Saves a message holding args, waiting for the reader to make room for it
+      /*! @throws Exception if the message could never fit in the ring, or if saving
+                  args throws, in which case nothing was written */
+      template <class ... Types> inline
+      void write( Types && ... args )
+      {
+        while( !tryWrite( args... ) )
+          // only the reader can make room, which is seen as the tail moving on
+          while( itsControl->tail.load( std::memory_order_acquire ) == itsTail )
+            std::this_thread::yield();
+      }
+
+      //! The size of the data area of the ring, in bytes
+      std::size_t capacity() const
+      {
+        return itsCapacity;
+      }
+
+    private:
+      //! Returns the free bytes from position up to the end of the ring
+      /*! The reader's tail is only read again when the last value seen leaves too
+          little room, so a writer that is well ahead of the reader does not touch
+          its cache line. */
+      std::size_t contiguousSpace( std::uint64_t position )
+      {
+        auto const contiguous = itsCapacity - static_cast<std::size_t>( position & ( itsCapacity - 1 ) );
+        if( position + contiguous - itsTail > itsCapacity )
+          itsTail = itsControl->tail.load( std::memory_order_acquire );
+
+        auto const used = position - itsTail;
+        return used >= itsCapacity ? 0 : std::min( contiguous, static_cast<std::size_t>( itsCapacity - used ) );
+      }
+
+      //! Saves args as a message at position, in at most space bytes, returning the position after it
+      template <class ... Types> inline
+      std::uint64_t save( std::uint64_t position, std::size_t space, Types && ... args )
+      {
+        auto const data = itsData + ( position & ( itsCapacity - 1 ) );
+        itsArchive.reset( data + shared_ring_detail::header_size, space - shared_ring_detail::header_size );
+        itsArchive( std::forward<Types>( args )... );
+
+        auto const body = itsArchive.bytesWritten();
+        shared_ring_detail::encode_header( body, data );
+        return position + shared_ring_detail::header_size + body;
+      }
+
+      //! Makes everything up to end visible to the reader, waking it if it sleeps
+      bool publish( std::uint64_t end )
+      {
+        itsHead = end;
+        itsControl->head.store( end, std::memory_order_seq_cst );
+        if( itsControl->sleeping.load( std::memory_order_seq_cst ) )
+          shared_ring_detail::wake( itsControl->signal );
+        return true;
+      }
+
+      shared_ring_detail::Control * itsControl; //!< The state shared with the reader
+      char * itsData;                           //!< The data area of the ring
+      std::size_t itsCapacity;                  //!< The size of the data area, a power of two
+      std::uint64_t itsHead;                    //!< The next byte to write
+      std::uint64_t itsTail;                    //!< The last tail seen, which may lag behind the reader's
+      MemoryBinaryOutputArchive itsArchive;     //!< Saves each message straight into the ring
+  };
+
+  // ######################################################################
+  //! Loads binary messages from a ring buffer in shared memory, saved by a SharedRingWriter
+  /*! Each message is loaded by a MemoryBinaryInputArchive pointing straight into the
+      ring, so nothing is copied before loading, and types that borrow from their input,
+      such as ArrayView, point into the ring itself.  The space of a message is given
+      back to the writer only when the next message is read, or release is called, so
+      anything borrowed from a message stays valid until then.
+
+      While no message is waiting, read spins briefly before going to sleep, and only
+      then asks the writer to wake it.
+
+      \ingroup Archives */
+  class SharedRingReader
+  {
+    public:
+      //! Construct, attaching to a ring set up by a SharedRingWriter
+      /*! @param memory The memory holding the ring, which must outlive the reader
+          @param size The size of the memory, in bytes
+          @throws Exception if the memory does not hold a ring, or is smaller than the ring it holds */
+      SharedRingReader( void * memory, std::size_t size ) :
+        itsControl( shared_ring_detail::control( memory, size ) ),
+        itsData( static_cast<char const *>( memory ) + sizeof(shared_ring_detail::Control) ),
+        itsCapacity( 0 ),
+        itsTail( 0 ),
+        itsReleased( 0 ),
+        itsHead( 0 ),
+        itsArchive( nullptr, 0 )
+      {
+        if( itsControl->magic.load( std::memory_order_acquire ) != shared_ring_detail::ring_magic )
+          throw Exception("Shared ring memory has not been set up by a SharedRingWriter");
+
+        itsCapacity = static_cast<std::size_t>( itsControl->capacity );
+        if( itsCapacity < shared_ring_detail::min_capacity || ( itsCapacity & ( itsCapacity - 1 ) ) != 0 )
+          throw Exception("Shared ring memory holds an invalid ring");
+        if( itsCapacity > size - sizeof(shared_ring_detail::Control) )
+          throw Exception("Shared ring memory is smaller than the ring it holds");
+
+        itsTail = itsReleased = itsHead = itsControl->tail.load( std::memory_order_acquire );
+      }
+
+      SharedRingReader( SharedRingReader const & ) = delete;
+      SharedRingReader & operator=( SharedRingReader const & ) = delete;
+
+      //! Loads the next message into args if one is waiting
+      /*! The previous message is released first.  If loading throws, the message is
+          dropped, so reading can carry on with the next one.
+
+          @return true if a message was loaded, false if none is waiting
+          @throws Exception if the ring is corrupt, or the message can not be loaded into args */
+      template <class ... Types> inline
+      bool tryRead( Types && ... args )
+      {
+        release();
+        if( !pending() )
+          return false;
+
+        auto position = itsTail + shared_ring_detail::padding( itsTail, itsCapacity );
+        auto body = header( position );
+        if( body == shared_ring_detail::wrap_marker )
+        {
+          position += itsCapacity - static_cast<std::size_t>( position & ( itsCapacity - 1 ) );
+          body = header( position );
+        }
+
+        auto const data = position + shared_ring_detail::header_size;
+        if( body > itsHead - data || body > itsCapacity - static_cast<std::size_t>( data & ( itsCapacity - 1 ) ) )
+          throw Exception("Shared ring is corrupt - a message runs past the data written to it");
+
+        itsTail = data + body;
+        itsArchive.reset( itsData + ( data & ( itsCapacity - 1 ) ), static_cast<std::size_t>( body ) );
+        itsArchive( std::forward<Types>( args )... );
+        return true;
+      }
+
+      //! Loads the next message into args, waiting for one to arrive
+      /*! @throws Exception if the ring is corrupt, or the message can not be loaded into args */
+      template <class ... Types> inline
+      void read( Types && ... args )
+      {
+        while( !tryRead( args... ) )
+          wait();
+      }
+
+      //! Gives the space of the last message read back to the writer
+      /*! Nothing borrowed from that message may be used afterwards. */
+      void release()
+      {
+        if( itsReleased != itsTail )
+        {
+          itsReleased = itsTail;
+          itsControl->tail.store( itsTail, std::memory_order_release );
+        }
+      }
+
+      //! The size of the data area of the ring, in bytes
+      std::size_t capacity() const
+      {
+        return itsCapacity;
+      }
+
+    private:
+      //! Whether the writer has published anything past the last message read
+      /*! The writer's head is only read again once everything seen so far has been read. */
+      bool pending()
+      {
+        if( itsHead == itsTail )
+          itsHead = itsControl->head.load( std::memory_order_acquire );
+        return itsHead != itsTail;
+      }
+
+      //! Reads the header at position
+      std::uint64_t header( std::uint64_t position ) const
+      {
+        if( itsHead - position < shared_ring_detail::header_size )
+          throw Exception("Shared ring is corrupt - a message header runs past the data written to it");
+
+        auto const result = message_binary_detail::read_header( reinterpret_cast<std::uint8_t const *>( itsData + ( position & ( itsCapacity - 1 ) ) ),
+                                                                shared_ring_detail::header_size );
+        if( !result.complete )
+          throw Exception("Shared ring is corrupt - invalid message header");
+        return result.body;
+      }
+
+      //! Waits until the writer publishes something new
+      /*! The reader spins for a while first, since a busy writer will usually publish
+          again sooner than the operating system could wake the reader.  Before going to
+          sleep it says so and looks again, and the writer looks for a sleeping reader
+          after publishing, so one of them always sees the other. */
+      void wait()
+      {
+        for( int spin = 0; spin < 1024; ++spin )
+          if( itsControl->head.load( std::memory_order_acquire ) != itsTail )
+            return;
+
+        auto const signal = itsControl->signal.load( std::memory_order_seq_cst );
+        itsControl->sleeping.store( 1, std::memory_order_seq_cst );
+        if( itsControl->head.load( std::memory_order_seq_cst ) == itsTail )
+          shared_ring_detail::wait( itsControl->signal, signal );
+        itsControl->sleeping.store( 0, std::memory_order_relaxed );
+      }
+
+      shared_ring_detail::Control * itsControl; //!< The state shared with the writer
+      char const * itsData;                     //!< The data area of the ring
+      std::size_t itsCapacity;                  //!< The size of the data area, a power of two
+      std::uint64_t itsTail;                    //!< One past the last message read
+      std::uint64_t itsReleased;                //!< The tail last given back to the writer
+      std::uint64_t itsHead;                    //!< The last head seen, which may lag behind the writer's
+      MemoryBinaryInputArchive itsArchive;      //!< Loads each message straight from the ring
+  };
+} // namespace cereal
+
+#endif // CEREAL_ARCHIVES_SHARED_RING_HPP_
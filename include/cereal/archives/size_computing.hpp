@@ -0,0 +1,178 @@
+/*! \file size_computing.hpp
+    \brief An output archive that computes the size of serialized data without writing it */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_SIZE_COMPUTING_HPP_
+#define CEREAL_ARCHIVES_SIZE_COMPUTING_HPP_
+
+#include <cereal/cereal.hpp>
+#include <ostream>
+#include <streambuf>
+
+namespace cereal
+{
+  // ######################################################################
+  //! An output archive that counts the bytes BinaryOutputArchive would write
+  /*! No data is written anywhere; saveBinary only accumulates a byte count.  Since
+      this is a full OutputArchive, shared pointers and polymorphic type names are
+      tracked exactly as they are in a real archive, so the result is exact even
+      when pointers are shared or polymorphic types are saved.  Polymorphic types
+      must be registered after including this header for it to see them.
+
+      The count matches the output of BinaryOutputArchive and the archives that share
+      its layout, such as MemoryBinaryOutputArchive, which makes it possible to size
+      a buffer exactly before serializing into it:
+
+      @code{.cpp}
+      std::vector<char> buffer( cereal::serialized_size( data ) );
+      cereal::MemoryBinaryOutputArchive ar( buffer.data(), buffer.size() );
+      ar( data );
+      @endcode
+
+      \ingroup Archives */
+  class SizeComputingArchive : public OutputArchive<SizeComputingArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, starting with a size of zero
+      SizeComputingArchive() :
+        OutputArchive<SizeComputingArchive, AllowEmptyClassElision>(this),
+        itsSize(0)
+      { }
+
+      //! Counts size bytes of data without writing them
+      void saveBinary( const void *, std::size_t size )
+      {
+        this->statisticsCounter().binary( size );
+        itsSize += size;
+      }
+
+      //! Returns the number of bytes saved so far
+      std::size_t size() const
+      {
+        return itsSize;
+      }
+
+    private:
+      std::size_t itsSize;
+  };
+
+  // ######################################################################
+  // Common SizeComputingArchive serialization functions
+
+  //! Saving for POD types to the size computing archive
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(SizeComputingArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to the size computing archive
+  template <class T> inline
+  void CEREAL_SERIALIZE_FUNCTION_NAME( SizeComputingArchive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Serializing SizeTags to the size computing archive
+  template <class T> inline
+  void CEREAL_SERIALIZE_FUNCTION_NAME( SizeComputingArchive & ar, SizeTag<T> & t )
+  {
+    ar( t.size );
+  }
+
+  //! Saving binary data to the size computing archive
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(SizeComputingArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+
+  namespace size_computing_detail
+  {
+    //! A stream buffer that discards everything written to it, keeping count
+    /*! @internal */
+    class CountingStreambuf : public std::streambuf
+    {
+      public:
+        CountingStreambuf() : itsCount(0) {}
+
+        std::size_t count() const { return itsCount; }
+
+      protected:
+        std::streamsize xsputn( const char *, std::streamsize n ) override
+        {
+          itsCount += static_cast<std::size_t>( n );
+          return n;
+        }
+
+        int_type overflow( int_type c ) override
+        {
+          if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+            ++itsCount;
+          return traits_type::not_eof( c );
+        }
+
+      private:
+        std::size_t itsCount;
+    };
+  } // namespace size_computing_detail
+
+  //! Computes the number of bytes the given objects occupy when saved in the BinaryOutputArchive layout
+  /*! @relates SizeComputingArchive */
+  template <class Archive = SizeComputingArchive, class ... Types> inline
+  typename std::enable_if<std::is_same<Archive, SizeComputingArchive>::value, std::size_t>::type
+  serialized_size( Types && ... args )
+  {
+    SizeComputingArchive ar;
+    ar( std::forward<Types>( args )... );
+    return ar.size();
+  }
+
+  //! Computes the number of bytes the given objects occupy when saved with Archive
+  /*! Archive must be constructible from a std::ostream.  The objects are serialized
+      into a stream that discards its data, so this works for any stream based archive,
+      including text archives which only complete their output on destruction.
+      @relates SizeComputingArchive */
+  template <class Archive, class ... Types> inline
+  typename std::enable_if<!std::is_same<Archive, SizeComputingArchive>::value, std::size_t>::type
+  serialized_size( Types && ... args )
+  {
+    size_computing_detail::CountingStreambuf buffer;
+    std::ostream stream( &buffer );
+    {
+      Archive ar( stream );
+      ar( std::forward<Types>( args )... );
+    }
+    return buffer.count();
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::SizeComputingArchive)
+
+#endif // CEREAL_ARCHIVES_SIZE_COMPUTING_HPP_
@@ -0,0 +1,816 @@
+/*! \file streaming_json.hpp
+    \brief A JSON input archive that parses its input incrementally */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_STREAMING_JSON_HPP_
+#define CEREAL_ARCHIVES_STREAMING_JSON_HPP_
+
+#include <cereal/archives/json.hpp>
+#include <cerrno>
+#include <cstdlib>
+#include <utility>
+
+namespace cereal
+{
+  namespace streaming_json_detail
+  {
+    //! A single token of JSON text
+    /*! @internal */
+    struct Token
+    {
+      enum Type { StartObject, EndObject, StartArray, EndArray, Name, String, Number, True, False, Null, End };
+
+      Token() : type( End ) {}
+
+      Type type;
+      std::string text; //!< The decoded string for Name and String, the literal text for Number
+    };
+
+    //! Splits JSON text read from a stream into tokens, one at a time
+    /*! Characters are taken from the stream buffer as they are needed, so the
+        stream is left positioned right after the last token read.
+        @internal */
+    class Tokenizer
+    {
+      public:
+        Tokenizer( std::istream & stream ) : itsBuffer( *stream.rdbuf() ), itsExpectName( false ) {}
+
+        //! Reads the next token, which is End once the stream is exhausted
+        /*! @throws Exception if the text is not valid JSON */
+        void next( Token & token )
+        {
+          for( ;; )
+          {
+            skipWhitespace();
+
+            auto const c = itsBuffer.sgetc();
+            switch( c )
+            {
+              case '{': itsBuffer.sbumpc(); itsContexts.push_back( '{' ); itsExpectName = true;  token.type = Token::StartObject; return;
+              case '[': itsBuffer.sbumpc(); itsContexts.push_back( '[' ); itsExpectName = false; token.type = Token::StartArray;  return;
+              case '}': itsBuffer.sbumpc(); close( '{' ); token.type = Token::EndObject; return;
+              case ']': itsBuffer.sbumpc(); close( '[' ); token.type = Token::EndArray;  return;
+              case ',':
+                itsBuffer.sbumpc();
+                itsExpectName = !itsContexts.empty() && itsContexts.back() == '{';
+                continue;
+              case '"':
+                itsBuffer.sbumpc();
+                readString( token.text );
+                if( itsExpectName )
+                {
+                  skipWhitespace();
+                  if( itsBuffer.sbumpc() != ':' )
+                    throw Exception("JSON Parsing failed - expected a colon after an object member name");
+                  itsExpectName = false;
+                  token.type = Token::Name;
+                }
+                else
+                  token.type = Token::String;
+                return;
+              case 't': expectLiteral( "true" );  token.type = Token::True;  return;
+              case 'f': expectLiteral( "false" ); token.type = Token::False; return;
+              case 'n': expectLiteral( "null" );  token.type = Token::Null;  return;
+              default:
+                if( c == '-' || ( c >= '0' && c <= '9' ) )
+                {
+                  readNumber( token.text );
+                  token.type = Token::Number;
+                  return;
+                }
+
+                if( std::streambuf::traits_type::eq_int_type( c, std::streambuf::traits_type::eof() ) )
+                {
+                  if( !itsContexts.empty() )
+                    throw Exception("JSON Parsing failed - unexpected end of input");
+                  token.type = Token::End;
+                  return;
+                }
+
+                throw Exception("JSON Parsing failed - unexpected character in input");
+            }
+          }
+        }
+
+      private:
+        void skipWhitespace()
+        {
+          for( ;; )
+          {
+            auto const c = itsBuffer.sgetc();
+            if( c != ' ' && c != '\n' && c != '\r' && c != '\t' )
+              return;
+            itsBuffer.sbumpc();
+          }
+        }
+
+        void close( char open )
+        {
+          if( itsContexts.empty() || itsContexts.back() != open )
+            throw Exception("JSON Parsing failed - mismatched closing bracket");
+          itsContexts.pop_back();
+          itsExpectName = false;
+        }
+
+        void expectLiteral( char const * literal )
+        {
+          for( ; *literal; ++literal )
+            if( itsBuffer.sbumpc() != *literal )
+              throw Exception("JSON Parsing failed - invalid literal");
+        }
+
+        void readNumber( std::string & out )
+        {
+          out.clear();
+          for( ;; )
+          {
+            auto const c = itsBuffer.sgetc();
+            if( ( c >= '0' && c <= '9' ) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E' )
+              out.push_back( static_cast<char>( itsBuffer.sbumpc() ) );
+            else
+              return;
+          }
+        }
+
+        unsigned int readHex()
+        {
+          unsigned int value = 0;
+          for( int i = 0; i < 4; ++i )
+          {
+            auto const c = itsBuffer.sbumpc();
+            value <<= 4;
+            if( c >= '0' && c <= '9' )      value |= static_cast<unsigned int>( c - '0' );
+            else if( c >= 'a' && c <= 'f' ) value |= static_cast<unsigned int>( c - 'a' + 10 );
+            else if( c >= 'A' && c <= 'F' ) value |= static_cast<unsigned int>( c - 'A' + 10 );
+            else
+              throw Exception("JSON Parsing failed - invalid unicode escape");
+          }
+          return value;
+        }
+
+        void appendUtf8( std::string & out, unsigned int code )
+        {
+          if( code < 0x80 )
+            out.push_back( static_cast<char>( code ) );
+          else if( code < 0x800 )
+          {
+            out.push_back( static_cast<char>( 0xC0 | ( code >> 6 ) ) );
+            out.push_back( static_cast<char>( 0x80 | ( code & 0x3F ) ) );
+          }
+          else if( code < 0x10000 )
+          {
+            out.push_back( static_cast<char>( 0xE0 | ( code >> 12 ) ) );
+            out.push_back( static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) ) );
+            out.push_back( static_cast<char>( 0x80 | ( code & 0x3F ) ) );
+          }
+          else
+          {
+            out.push_back( static_cast<char>( 0xF0 | ( code >> 18 ) ) );
+            out.push_back( static_cast<char>( 0x80 | ( ( code >> 12 ) & 0x3F ) ) );
+            out.push_back( static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) ) );
+            out.push_back( static_cast<char>( 0x80 | ( code & 0x3F ) ) );
+          }
+        }
+
+        void readString( std::string & out )
+        {
+          out.clear();
+          for( ;; )
+          {
+            auto const c = itsBuffer.sbumpc();
+            if( c == '"' )
+              return;
+
+            if( std::streambuf::traits_type::eq_int_type( c, std::streambuf::traits_type::eof() ) )
+              throw Exception("JSON Parsing failed - unterminated string");
+
+            if( c != '\\' )
+            {
+              out.push_back( static_cast<char>( c ) );
+              continue;
+            }
+
+            switch( itsBuffer.sbumpc() )
+            {
+              case '"':  out.push_back( '"' );  break;
+              case '\\': out.push_back( '\\' ); break;
+              case '/':  out.push_back( '/' );  break;
+              case 'b':  out.push_back( '\b' ); break;
+              case 'f':  out.push_back( '\f' ); break;
+              case 'n':  out.push_back( '\n' ); break;
+              case 'r':  out.push_back( '\r' ); break;
+              case 't':  out.push_back( '\t' ); break;
+              case 'u':
+              {
+                auto code = readHex();
+                if( code >= 0xD800 && code <= 0xDBFF )
+                {
+                  if( itsBuffer.sbumpc() != '\\' || itsBuffer.sbumpc() != 'u' )
+                    throw Exception("JSON Parsing failed - invalid surrogate pair");
+                  auto const low = readHex();
+                  if( low < 0xDC00 || low > 0xDFFF )
+                    throw Exception("JSON Parsing failed - invalid surrogate pair");
+                  code = 0x10000 + ( ( code - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+                }
+                appendUtf8( out, code );
+                break;
+              }
+              default:
+                throw Exception("JSON Parsing failed - invalid escape sequence");
+            }
+          }
+        }
+
+        std::streambuf & itsBuffer;
+        std::vector<char> itsContexts; //!< The open brackets enclosing the current position
+        bool itsExpectName;            //!< Whether the next string is the name of an object member
+    };
+  } // namespace streaming_json_detail
+
+  // ######################################################################
+  //! An input archive that loads JSON as it reads it, without building a document first
+  /*! This archive loads data saved by JSONOutputArchive, like JSONInputArchive,
+      but parses its input incrementally: tokens are read from the stream only
+      as values are loaded.  Memory use does not grow with the size of the input,
+      and loading starts before the whole input has arrived, which suits large
+      exports saved as many values at the top level of an archive.
+
+      Loading in the order data was saved, with or without NVPs, reads straight
+      from the stream.  Out of order loads are still supported: when the name of
+      an NVP does not match the next member, the members before the one searched
+      for are buffered, and loaded from the buffer if they are asked for later.
+      Subsequent sequential loads continue after the member that was found.
+
+      Containers need their size before their elements are loaded, which JSON
+      does not record, so every array whose size is requested is buffered until
+      its end to count its elements.  Arrays are therefore not streamed, the
+      values containing them are.
+
+      The stream buffer is read one character at a time without reading ahead,
+      so the stream is left positioned right after the data that was loaded.
+
+      \ingroup Archives */
+  class StreamingJSONInputArchive : public InputArchive<StreamingJSONInputArchive>, public traits::TextArchive
+  {
+    private:
+      typedef streaming_json_detail::Token Token;
+      typedef std::vector<Token> Tokens;
+
+    public:
+      /*! @name Common Functionality
+          Common use cases for directly interacting with an StreamingJSONInputArchive */
+      //! @{
+
+      //! Construct, reading from the provided stream
+      /*! Only the opening of the top level object is read before returning.
+          @param stream The stream to read from */
+      StreamingJSONInputArchive(std::istream & stream) :
+        InputArchive<StreamingJSONInputArchive>(this),
+        itsNextName( nullptr ),
+        itsTokenizer( stream ),
+        itsHasLookahead( false )
+      {
+        // An archive that saved nothing is empty rather than an empty object
+        auto const & first = peek();
+        if( first.type == Token::StartObject )
+          take();
+        else if( first.type != Token::End )
+          throw Exception("JSON Parsing failed - the top level of an archive must be an object");
+
+        itsFrames.emplace_back( false );
+      }
+
+      //! Loads some binary data, encoded as a base64 string
+      /*! This will automatically start and finish a node to load the data, and can be called directly by
+          users.
+
+          Note that this follows the same ordering rules specified in the class description in regards
+          to loading in/out of order */
+      void loadBinaryValue( void * data, size_t size, const char * name = nullptr )
+      {
+        itsNextName = name;
+
+        std::string encoded;
+        loadValue( encoded );
+        auto decoded = base64::decode( encoded );
+
+        if( size != decoded.size() )
+          throw Exception("Decoded binary data size does not match specified size");
+
+        std::memcpy( data, decoded.data(), decoded.size() );
+        itsNextName = nullptr;
+      };
+
+    private:
+      //! @}
+      /*! @name Internal Functionality
+          Functionality designed for use by those requiring control over the inner mechanisms of
+          the StreamingJSONInputArchive */
+      //! @{
+
+      //! An object or array that is being loaded
+      struct Frame
+      {
+        Frame( bool array ) : isArray( array ), isSized( false ), resume( noResume ) {}
+
+        static const std::size_t noResume = static_cast<std::size_t>( -1 );
+
+        bool isArray;                                        //!< Whether this is an array, otherwise an object
+        bool isSized;                                        //!< Whether the elements have been counted into a replay
+        std::vector<std::pair<std::string, Tokens>> skipped; //!< Members skipped over by out of order loads, in order
+        std::size_t resume;                                  //!< Index in skipped of the member loaded next without a name,
+                                                             //!< or noResume to read it from the stream
+      };
+
+      //! Buffered tokens that are read before any further tokens from the stream
+      struct Replay
+      {
+        Replay( Tokens && t ) : tokens( std::move( t ) ), position( 0 ) {}
+
+        Tokens tokens;
+        std::size_t position;
+      };
+
+      //! The next token, without consuming it
+      Token & peek()
+      {
+        while( !itsReplays.empty() )
+        {
+          auto & replay = itsReplays.back();
+          if( replay.position < replay.tokens.size() )
+            return replay.tokens[replay.position];
+          itsReplays.pop_back();
+        }
+
+        if( !itsHasLookahead )
+        {
+          itsTokenizer.next( itsLookahead );
+          itsHasLookahead = true;
+        }
+
+        return itsLookahead;
+      }
+
+      //! Consumes the next token, which remains valid until the next call to peek or take
+      Token & take()
+      {
+        auto & token = peek();
+        if( !itsReplays.empty() )
+          ++itsReplays.back().position;
+        else
+          itsHasLookahead = false;
+        return token;
+      }
+
+      //! Consumes one complete value, appending its tokens to out if it is given
+      void consumeValue( Tokens * out )
+      {
+        std::size_t depth = 0;
+        do
+        {
+          auto & token = take();
+          switch( token.type )
+          {
+            case Token::StartObject: case Token::StartArray: ++depth; break;
+            case Token::EndObject: case Token::EndArray:
+              if( depth == 0 )
+                throw Exception("JSON Parsing failed - expected a value");
+              --depth;
+              break;
+            case Token::End:
+              throw Exception("JSON Parsing failed - unexpected end of input");
+            case Token::Name:
+              if( depth == 0 )
+                throw Exception("JSON Parsing failed - expected a value");
+              break;
+            default: break;
+          }
+
+          if( out )
+            out->push_back( std::move( token ) );
+        } while( depth > 0 );
+      }
+
+      //! Moves to the node named by the NVP given with setNextName, if any
+      /*! The names of members are consumed as the archive moves past them.  If
+          an NVP does not match the next member, members are buffered until the
+          matching one is found, unless it was buffered earlier.
+
+          Resets the NVP name after called.
+
+          As with JSONInputArchive, a value loaded without a name is the member
+          following the one most recently loaded.
+
+          @throws Exception if an expectedName is given and not found */
+      void search()
+      {
+        auto const name = itsNextName;
+        itsNextName = nullptr;
+
+        auto & frame = itsFrames.back();
+        if( frame.isArray )
+        {
+          if( name )
+            throw Exception("JSON Parsing failed - provided NVP not found");
+          return;
+        }
+
+        if( !name )
+        {
+          if( frame.resume < frame.skipped.size() )
+            replaySkipped( frame, frame.resume );
+          else
+          {
+            frame.resume = Frame::noResume;
+            if( peek().type == Token::Name )
+              take();
+          }
+          return;
+        }
+
+        for( std::size_t i = 0; i < frame.skipped.size(); ++i )
+          if( frame.skipped[i].first == name )
+          {
+            replaySkipped( frame, i );
+            return;
+          }
+
+        frame.resume = Frame::noResume;
+        for( ;; )
+        {
+          auto & token = peek();
+          if( token.type != Token::Name )
+            throw Exception("JSON Parsing failed - provided NVP not found");
+
+          if( token.text == name )
+          {
+            take();
+            return;
+          }
+
+          std::string skippedName = std::move( take().text );
+          Tokens value;
+          consumeValue( &value );
+          frame.skipped.emplace_back( std::move( skippedName ), std::move( value ) );
+        }
+      }
+
+      //! Loads the next value from a skipped member, continuing with the member after it
+      void replaySkipped( Frame & frame, std::size_t index )
+      {
+        itsReplays.emplace_back( std::move( frame.skipped[index].second ) );
+        frame.skipped.erase( frame.skipped.begin() + static_cast<std::ptrdiff_t>( index ) );
+        frame.resume = index;
+      }
+
+      //! Takes the next token, which must be a value of the given type
+      Token & takeValue( Token::Type type )
+      {
+        search();
+
+        auto & token = take();
+        if( token.type != type )
+          throw Exception("JSON Parsing failed - value has an unexpected type");
+        return token;
+      }
+
+      //! Takes the next token, which must be a number, and converts it
+      template <class T, class Convert> inline
+      T takeNumber( Convert convert )
+      {
+        auto const & text = takeValue( Token::Number ).text;
+
+        char * end;
+        errno = 0;
+        auto const value = convert( text.c_str(), &end );
+        if( errno == ERANGE || end != text.c_str() + text.size() )
+          throw Exception("JSON Parsing failed - invalid number " + text);
+        return static_cast<T>( value );
+      }
+
+      static long long toSigned( char const * s, char ** end ) { return std::strtoll( s, end, 10 ); }
+      static unsigned long long toUnsigned( char const * s, char ** end ) { return std::strtoull( s, end, 10 ); }
+      static double toDouble( char const * s, char ** end ) { return std::strtod( s, end ); }
+
+    public:
+      //! Starts a new node, going into the object or array it holds
+      void startNode()
+      {
+        search();
+
+        auto const type = take().type;
+        if( type == Token::StartObject )
+          itsFrames.emplace_back( false );
+        else if( type == Token::StartArray )
+          itsFrames.emplace_back( true );
+        else
+          throw Exception("JSON Parsing failed - expected an object or array");
+      }
+
+      //! Finishes the most recently started node, skipping anything in it that was not loaded
+      void finishNode()
+      {
+        auto const end = itsFrames.back().isArray ? Token::EndArray : Token::EndObject;
+        for( ;; )
+        {
+          auto const type = peek().type;
+          if( type == end )
+            break;
+          else if( type == Token::Name )
+            take();
+          else
+            consumeValue( nullptr );
+        }
+
+        take();
+        itsFrames.pop_back();
+      }
+
+      //! Retrieves the name of the next node
+      /*! Unlike JSONInputArchive this is not const, since it may need to read the name.
+          @return nullptr if no name exists */
+      const char * getNodeName()
+      {
+        if( itsFrames.back().isArray )
+          return nullptr;
+
+        auto const & token = peek();
+        return token.type == Token::Name ? token.text.c_str() : nullptr;
+      }
+
+      //! Sets the name for the next node created with startNode
+      void setNextName( const char * name )
+      {
+        itsNextName = name;
+      }
+
+      //! Loads a value from the current node - small signed overload
+      template <class T, traits::EnableIf<std::is_signed<T>::value,
+                                          sizeof(T) < sizeof(int64_t)> = traits::sfinae> inline
+      void loadValue(T & val)
+      {
+        auto const value = takeNumber<long long>( &toSigned );
+        if( value < std::numeric_limits<T>::min() || value > std::numeric_limits<T>::max() )
+          throw Exception("JSON Parsing failed - number out of range");
+        val = static_cast<T>( value );
+      }
+
+      //! Loads a value from the current node - small unsigned overload
+      template <class T, traits::EnableIf<std::is_unsigned<T>::value,
+                                          sizeof(T) < sizeof(uint64_t),
+                                          !std::is_same<bool, T>::value> = traits::sfinae> inline
+      void loadValue(T & val)
+      {
+        auto const value = takeNumber<unsigned long long>( &toUnsigned );
+        if( value > std::numeric_limits<T>::max() )
+          throw Exception("JSON Parsing failed - number out of range");
+        val = static_cast<T>( value );
+      }
+
+      //! Loads a value from the current node - bool overload
+      void loadValue(bool & val)
+      {
+        search();
+
+        auto const type = take().type;
+        if( type != Token::True && type != Token::False )
+          throw Exception("JSON Parsing failed - value has an unexpected type");
+        val = type == Token::True;
+      }
+
+      //! Loads a value from the current node - int64 overload
+      void loadValue(int64_t & val)     { val = takeNumber<int64_t>( &toSigned ); }
+      //! Loads a value from the current node - uint64 overload
+      void loadValue(uint64_t & val)    { val = takeNumber<uint64_t>( &toUnsigned ); }
+      //! Loads a value from the current node - float overload
+      void loadValue(float & val)       { val = takeNumber<float>( &toDouble ); }
+      //! Loads a value from the current node - double overload
+      void loadValue(double & val)      { val = takeNumber<double>( &toDouble ); }
+      //! Loads a value from the current node - string overload
+      void loadValue(std::string & val) { val = std::move( takeValue( Token::String ).text ); }
+
+      // Special cases to handle various flavors of long, which tend to conflict with
+      // the int32_t or int64_t on various compiler/OS combinations.  MSVC doesn't need any of this.
+      #ifndef _MSC_VER
+    private:
+      //! 32 bit signed long loading from current node
+      template <class T> inline
+      typename std::enable_if<sizeof(T) == sizeof(std::int32_t) && std::is_signed<T>::value, void>::type
+      loadLong(T & l){ loadValue( reinterpret_cast<std::int32_t&>( l ) ); }
+
+      //! non 32 bit signed long loading from current node
+      template <class T> inline
+      typename std::enable_if<sizeof(T) == sizeof(std::int64_t) && std::is_signed<T>::value, void>::type
+      loadLong(T & l){ loadValue( reinterpret_cast<std::int64_t&>( l ) ); }
+
+      //! 32 bit unsigned long loading from current node
+      template <class T> inline
+      typename std::enable_if<sizeof(T) == sizeof(std::uint32_t) && !std::is_signed<T>::value, void>::type
+      loadLong(T & lu){ loadValue( reinterpret_cast<std::uint32_t&>( lu ) ); }
+
+      //! non 32 bit unsigned long loading from current node
+      template <class T> inline
+      typename std::enable_if<sizeof(T) == sizeof(std::uint64_t) && !std::is_signed<T>::value, void>::type
+      loadLong(T & lu){ loadValue( reinterpret_cast<std::uint64_t&>( lu ) ); }
+
+    public:
+      //! Serialize a long if it would not be caught otherwise
+      template <class T> inline
+      typename std::enable_if<std::is_same<T, long>::value &&
+                              !std::is_same<T, std::int32_t>::value &&
+                              !std::is_same<T, std::int64_t>::value, void>::type
+      loadValue( T & t ){ loadLong(t); }
+
+      //! Serialize an unsigned long if it would not be caught otherwise
+      template <class T> inline
+      typename std::enable_if<std::is_same<T, unsigned long>::value &&
+                              !std::is_same<T, std::uint32_t>::value &&
+                              !std::is_same<T, std::uint64_t>::value, void>::type
+      loadValue( T & t ){ loadLong(t); }
+      #endif // _MSC_VER
+
+    private:
+      //! Convert a string to a long long, unsigned long long, or long double
+      template <class T> inline
+      void stringToNumber( std::string const & str, T & val ) { val = charconv_detail::fromChars<T>( str.c_str() ); }
+
+    public:
+      //! Loads a value from the current node - long double and long long overloads
+      template <class T, traits::EnableIf<std::is_arithmetic<T>::value,
+                                          !std::is_same<T, long>::value,
+                                          !std::is_same<T, unsigned long>::value,
+                                          !std::is_same<T, std::int64_t>::value,
+                                          !std::is_same<T, std::uint64_t>::value,
+                                          (sizeof(T) >= sizeof(long double) || sizeof(T) >= sizeof(long long))> = traits::sfinae>
+      inline void loadValue(T & val)
+      {
+        std::string encoded;
+        loadValue( encoded );
+        stringToNumber( encoded, val );
+      }
+
+      //! Loads the size for a SizeTag
+      /*! The array being loaded is buffered until its end to count its elements */
+      void loadSize(size_type & size)
+      {
+        auto & frame = itsFrames.back();
+        if( !frame.isArray || frame.isSized )
+          throw Exception("JSON Parsing failed - size requested for a node that is not an array");
+
+        Tokens elements;
+        size = 0;
+        while( peek().type != Token::EndArray )
+        {
+          consumeValue( &elements );
+          ++size;
+        }
+        elements.push_back( std::move( take() ) );
+
+        itsReplays.emplace_back( std::move( elements ) );
+        frame.isSized = true;
+      }
+
+      //! @}
+
+    private:
+      const char * itsNextName;                   //!< Next name set by NVP
+      streaming_json_detail::Tokenizer itsTokenizer; //!< Reads tokens from the stream
+      Token itsLookahead;                         //!< The next token from the stream, if itsHasLookahead
+      bool itsHasLookahead;                       //!< Whether itsLookahead holds a token not yet consumed
+      std::vector<Replay> itsReplays;             //!< Buffered tokens to read before the stream, innermost last
+      std::vector<Frame> itsFrames;               //!< The objects and arrays being loaded, innermost last
+  };
+
+  // ######################################################################
+  // StreamingJSONInputArchive prologue and epilogue functions
+  // ######################################################################
+
+  // ######################################################################
+  //! Prologue for NVPs for streaming JSON archives
+  /*! NVPs do not start or finish nodes - they just set up the names */
+  template <class T> inline
+  void prologue( StreamingJSONInputArchive &, NameValuePair<T> const & )
+  { }
+
+  //! Epilogue for NVPs for streaming JSON archives
+  template <class T> inline
+  void epilogue( StreamingJSONInputArchive &, NameValuePair<T> const & )
+  { }
+
+  //! Prologue for SizeTags for streaming JSON archives
+  template <class T> inline
+  void prologue( StreamingJSONInputArchive &, SizeTag<T> const & )
+  { }
+
+  //! Epilogue for SizeTags for streaming JSON archives
+  template <class T> inline
+  void epilogue( StreamingJSONInputArchive &, SizeTag<T> const & )
+  { }
+
+  //! Prologue for all other types for streaming JSON archives
+  /*! Starts a new node, except for minimal types */
+  template <class T, traits::DisableIf<std::is_arithmetic<T>::value ||
+                                       traits::has_minimal_base_class_serialization<T, traits::has_minimal_input_serialization, StreamingJSONInputArchive>::value ||
+                                       traits::has_minimal_input_serialization<T, StreamingJSONInputArchive>::value> = traits::sfinae>
+  inline void prologue( StreamingJSONInputArchive & ar, T const & )
+  {
+    ar.startNode();
+  }
+
+  //! Epilogue for all other types for streaming JSON archives
+  /*! Finishes the node created in the prologue, except for minimal types */
+  template <class T, traits::DisableIf<std::is_arithmetic<T>::value ||
+                                       traits::has_minimal_base_class_serialization<T, traits::has_minimal_input_serialization, StreamingJSONInputArchive>::value ||
+                                       traits::has_minimal_input_serialization<T, StreamingJSONInputArchive>::value> = traits::sfinae>
+  inline void epilogue( StreamingJSONInputArchive & ar, T const & )
+  {
+    ar.finishNode();
+  }
+
+  //! Prologue for arithmetic types for streaming JSON archives
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void prologue( StreamingJSONInputArchive &, T const & )
+  { }
+
+  //! Epilogue for arithmetic types for streaming JSON archives
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void epilogue( StreamingJSONInputArchive &, T const & )
+  { }
+
+  //! Prologue for strings for streaming JSON archives
+  template<class CharT, class Traits, class Alloc> inline
+  void prologue(StreamingJSONInputArchive &, std::basic_string<CharT, Traits, Alloc> const &)
+  { }
+
+  //! Epilogue for strings for streaming JSON archives
+  template<class CharT, class Traits, class Alloc> inline
+  void epilogue(StreamingJSONInputArchive &, std::basic_string<CharT, Traits, Alloc> const &)
+  { }
+
+  // ######################################################################
+  // Common StreamingJSONInputArchive serialization functions
+  // ######################################################################
+  //! Loading NVP types from JSON
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( StreamingJSONInputArchive & ar, NameValuePair<T> & t )
+  {
+    ar.setNextName( t.name );
+    ar( t.value );
+  }
+
+  //! Loading arithmetic from JSON
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void CEREAL_LOAD_FUNCTION_NAME(StreamingJSONInputArchive & ar, T & t)
+  {
+    ar.loadValue( t );
+  }
+
+  //! loading string from JSON
+  template<class CharT, class Traits, class Alloc> inline
+  void CEREAL_LOAD_FUNCTION_NAME(StreamingJSONInputArchive & ar, std::basic_string<CharT, Traits, Alloc> & str)
+  {
+    ar.loadValue( str );
+  }
+
+  //! Loading SizeTags from JSON
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( StreamingJSONInputArchive & ar, SizeTag<T> & st )
+  {
+    ar.loadSize( st.size );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::StreamingJSONInputArchive)
+
+// data for this archive is saved by JSONOutputArchive, which stays tied to JSONInputArchive
+namespace cereal { namespace traits { namespace detail {
+  template <> struct get_output_from_input<cereal::StreamingJSONInputArchive>
+  { using type = cereal::JSONOutputArchive; };
+} } } // namespace cereal::traits::detail
+
+#endif // CEREAL_ARCHIVES_STREAMING_JSON_HPP_
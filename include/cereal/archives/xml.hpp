@@ -30,11 +30,15 @@
 #define CEREAL_ARCHIVES_XML_HPP_
 #include <cereal/cereal.hpp>
 #include <cereal/details/util.hpp>
+#include <cereal/details/flat_map.hpp>
+#include <cereal/details/charconv.hpp>
 
 #include <cereal/external/rapidxml/rapidxml.hpp>
 #include <cereal/external/rapidxml/rapidxml_print.hpp>
 #include <cereal/external/base64.hpp>
 
+#include <algorithm>
+#include <memory>
 #include <sstream>
 #include <stack>
 #include <vector>
@@ -62,6 +66,245 @@ namespace cereal
     {
       return c == ' ' || c == '\t' || c == '\n' || c == '\r';
     }
+
+    //! Whether a value can be saved as an attribute with Options::ScalarAttributes
+    /*! Characters are excluded since they are saved as raw text, which may be whitespace */
+    template <class T>
+    struct is_attribute_scalar : std::integral_constant<bool, std::is_arithmetic<T>::value &&
+                                                              !std::is_same<T, char>::value> {};
+
+    //! Whether a name is one of the attributes the archives write themselves
+    inline bool isReservedAttribute( const char * name )
+    {
+      return std::strcmp( name, "size" ) == 0 || std::strcmp( name, "type" ) == 0 ||
+             std::strncmp( name, "xml:", 4 ) == 0;
+    }
+
+    //! Writes XML to a stream as elements are opened and closed
+    /*! The output is the same as printing the equivalent rapidxml document.
+        Attributes may be added to an element until a child element is opened
+        in it, and the text of an element is held until the element is closed,
+        so memory use is bounded by the nesting depth and the largest value
+        rather than by the size of the document.
+
+        Output is collected in a fixed size buffer that is written to the
+        stream whenever it fills.
+
+        @internal */
+    class StreamWriter
+    {
+      public:
+        //! Starts a document with an XML declaration and opens its root element
+        StreamWriter( std::ostream & stream, const char * root, bool indent ) :
+          itsStream( stream ),
+          itsSize( 0 ),
+          itsIndent( indent )
+        {
+          put( "<?xml version=\"1.0\" encoding=\"utf-8\"?>" );
+          newline();
+          openElement( root, std::strlen( root ) );
+        }
+
+        //! Opens a child element of the innermost open element
+        void openElement( const char * name, std::size_t size )
+        {
+          if( !itsElements.empty() )
+            beginChildren( itsElements.back() );
+
+          indent( itsElements.size() );
+          put( '<' );
+          put( name, size );
+
+          itsElements.emplace_back();
+          itsElements.back().name.assign( name, size );
+        }
+
+        //! Adds an attribute to the innermost open element
+        /*! Attributes added after a child element has been opened are dropped */
+        void attribute( const char * name, const char * value )
+        {
+          if( itsElements.back().state != Element::Open )
+            return;
+
+          put( ' ' );
+          put( name );
+          put( '=' );
+
+          // quote with whichever character does not need escaping, as rapidxml does
+          auto const valueEnd = value + std::strlen( value );
+          if( std::find( value, valueEnd, '"' ) != valueEnd )
+          {
+            put( '\'' );
+            putEscaped( value, valueEnd, '"' );
+            put( '\'' );
+          }
+          else
+          {
+            put( '"' );
+            putEscaped( value, valueEnd, '\'' );
+            put( '"' );
+          }
+        }
+
+        //! Sets the text of the innermost open element
+        void text( const char * data, std::size_t size )
+        {
+          auto & element = itsElements.back();
+          if( element.state == Element::Open && !element.hasText )
+          {
+            element.text.assign( data, size );
+            element.hasText = true;
+            return;
+          }
+
+          // further text is printed as separate children, like extra rapidxml data nodes
+          beginChildren( element );
+          indent( itsElements.size() );
+          putEscaped( data, data + size, '\0' );
+          newline();
+        }
+
+        //! Closes the innermost open element
+        void closeElement()
+        {
+          auto & element = itsElements.back();
+          if( element.state == Element::Open && !element.hasText )
+            put( "/>" );
+          else
+          {
+            if( element.state == Element::Open )
+            {
+              put( '>' );
+              putEscaped( element.text.data(), element.text.data() + element.text.size(), '\0' );
+            }
+            else
+              indent( itsElements.size() - 1 );
+
+            put( "</" );
+            put( element.name.data(), element.name.size() );
+            put( '>' );
+          }
+
+          newline();
+          itsElements.pop_back();
+        }
+
+        //! Closes every open element and writes all output to the stream
+        void finish()
+        {
+          while( !itsElements.empty() )
+            closeElement();
+
+          // rapidxml ends the document itself with a newline too
+          newline();
+          flush();
+        }
+
+      private:
+        struct Element
+        {
+          Element() : state( Open ), hasText( false ) {}
+
+          enum State { Open, HasChildren } state; //!< Whether the start tag is still open for attributes
+          bool hasText;                           //!< Whether text is held for an element that is still open
+          std::string name;
+          std::string text;
+        };
+
+        //! Ends the start tag of an element so that children can follow
+        void beginChildren( Element & element )
+        {
+          if( element.state != Element::Open )
+            return;
+
+          put( '>' );
+          newline();
+          element.state = Element::HasChildren;
+
+          if( element.hasText )
+          {
+            indent( itsElements.size() );
+            putEscaped( element.text.data(), element.text.data() + element.text.size(), '\0' );
+            newline();
+            element.hasText = false;
+            element.text.clear();
+          }
+        }
+
+        void indent( std::size_t depth )
+        {
+          if( itsIndent )
+            for( std::size_t i = 0; i < depth; ++i )
+              put( '\t' );
+        }
+
+        void newline()
+        {
+          if( itsIndent )
+            put( '\n' );
+        }
+
+        void put( char c )
+        {
+          if( itsSize == sizeof( itsBuffer ) )
+            flush();
+          itsBuffer[itsSize++] = c;
+        }
+
+        void put( const char * data, std::size_t size )
+        {
+          while( size > 0 )
+          {
+            if( itsSize == sizeof( itsBuffer ) )
+              flush();
+
+            auto const count = ( std::min )( size, sizeof( itsBuffer ) - itsSize );
+            std::memcpy( itsBuffer + itsSize, data, count );
+            itsSize += count;
+            data += count;
+            size -= count;
+          }
+        }
+
+        void put( const char * str ) { put( str, std::strlen( str ) ); }
+
+        //! Writes text replacing markup characters with entities, except for noexpand
+        void putEscaped( const char * begin, const char * end, char noexpand )
+        {
+          auto run = begin;
+          for( ; begin != end; ++begin )
+          {
+            const char * entity;
+            switch( *begin == noexpand ? '\0' : *begin )
+            {
+              case '<':  entity = "&lt;";   break;
+              case '>':  entity = "&gt;";   break;
+              case '\'': entity = "&apos;"; break;
+              case '"':  entity = "&quot;"; break;
+              case '&':  entity = "&amp;";  break;
+              default: continue;
+            }
+
+            put( run, static_cast<std::size_t>( begin - run ) );
+            put( entity );
+            run = begin + 1;
+          }
+
+          put( run, static_cast<std::size_t>( end - run ) );
+        }
+
+        void flush()
+        {
+          itsStream.write( itsBuffer, static_cast<std::streamsize>( itsSize ) );
+          itsSize = 0;
+        }
+
+        std::ostream & itsStream;
+        char itsBuffer[4096];
+        std::size_t itsSize;
+        bool itsIndent;
+        std::vector<Element> itsElements; //!< The open elements, innermost last
+    };
   }
 
   // ######################################################################
@@ -71,6 +314,10 @@ namespace cereal
       The envisioned way of using this archive is in an RAII fashion, letting
       the automatic destruction of the object cause the flush to its stream.
 
+      With Options::Streaming (or the streaming option set), no tree is built:
+      elements are written through a small buffer as they are finished, so memory
+      use stays bounded for very large outputs.  The output is identical either way.
+
       XML archives provides a human readable output but at decreased
       performance (both in time and space) compared to binary archives.
 
@@ -87,6 +334,14 @@ namespace cereal
       XML archives can optionally print the type of everything they serialize, which
       adds an attribute to each node.
 
+      With Options::ScalarAttributes, arithmetic values saved in name-value pairs
+      are written as attributes of the element they belong to, as in
+      <leg id="3" price="100.5">, instead of as child elements of their own.  This
+      roughly halves the size and node count of documents made mostly of scalars.
+      A scalar saved after a child element of the same element, or named like an
+      attribute the archive writes itself (size, type, or xml:...), is still
+      written as an element.  XMLInputArchive loads either form.
+
       XML archives do not output the size information for any dynamically sized structure
       and instead infer it from the number of children for a node.  This means that data
       can be hand edited for dynamic sized structures and will still be readable.  This
@@ -110,22 +365,39 @@ namespace cereal
           //! Default options with no indentation
           static Options NoIndent(){ return Options( std::numeric_limits<double>::max_digits10, false ); }
 
+          //! Default options, writing XML as values are saved instead of when the archive is destroyed
+          static Options Streaming(){ return Options( std::numeric_limits<double>::max_digits10, true, false, true ); }
+
+          //! Default options, writing named arithmetic values as attributes of their enclosing element
+          static Options ScalarAttributes(){ return Options( std::numeric_limits<double>::max_digits10, true, false, false, true ); }
+
           //! Specify specific options for the XMLOutputArchive
           /*! @param precision The precision used for floating point numbers
               @param indent Whether to indent each line of XML
-              @param outputType Whether to output the type of each serialized object as an attribute */
+              @param outputType Whether to output the type of each serialized object as an attribute
+              @param streaming Whether to write XML to the stream as it is saved, without keeping a document
+                               in memory.  The output is the same, but elements that are finished may
+                               reach the stream before the archive is destroyed
+              @param scalarAttributes Whether to write arithmetic values in name-value pairs as attributes
+                               of their enclosing element rather than as child elements */
           explicit Options( int precision = std::numeric_limits<double>::max_digits10,
                             bool indent = true,
-                            bool outputType = false ) :
+                            bool outputType = false,
+                            bool streaming = false,
+                            bool scalarAttributes = false ) :
             itsPrecision( precision ),
             itsIndent( indent ),
-            itsOutputType( outputType ) { }
+            itsOutputType( outputType ),
+            itsStreaming( streaming ),
+            itsScalarAttributes( scalarAttributes ) { }
 
         private:
           friend class XMLOutputArchive;
           int itsPrecision;
           bool itsIndent;
           bool itsOutputType;
+          bool itsStreaming;
+          bool itsScalarAttributes;
       };
 
       //! Construct, outputting to the provided stream upon destruction
@@ -136,19 +408,29 @@ namespace cereal
       XMLOutputArchive( std::ostream & stream, Options const & options = Options::Default() ) :
         OutputArchive<XMLOutputArchive>(this),
         itsStream(stream),
+        itsPrecision( options.itsPrecision ),
         itsOutputType( options.itsOutputType ),
-        itsIndent( options.itsIndent )
+        itsIndent( options.itsIndent ),
+        itsScalarAttributes( options.itsScalarAttributes )
       {
-        // rapidxml will delete all allocations when xml_document is cleared
-        auto node = itsXML.allocate_node( rapidxml::node_declaration );
-        node->append_attribute( itsXML.allocate_attribute( "version", "1.0" ) );
-        node->append_attribute( itsXML.allocate_attribute( "encoding", "utf-8" ) );
-        itsXML.append_node( node );
-
-        // allocate root node
-        auto root = itsXML.allocate_node( rapidxml::node_element, xml_detail::CEREAL_XML_STRING );
-        itsXML.append_node( root );
-        itsNodes.emplace( root );
+        if( options.itsStreaming )
+        {
+          itsWriter.reset( new xml_detail::StreamWriter( itsStream, xml_detail::CEREAL_XML_STRING, itsIndent ) );
+          itsNodes.emplace();
+        }
+        else
+        {
+          // rapidxml will delete all allocations when xml_document is cleared
+          auto node = itsXML.allocate_node( rapidxml::node_declaration );
+          node->append_attribute( itsXML.allocate_attribute( "version", "1.0" ) );
+          node->append_attribute( itsXML.allocate_attribute( "encoding", "utf-8" ) );
+          itsXML.append_node( node );
+
+          // allocate root node
+          auto root = itsXML.allocate_node( rapidxml::node_element, xml_detail::CEREAL_XML_STRING );
+          itsXML.append_node( root );
+          itsNodes.emplace( root );
+        }
 
         // set attributes on the streams
         itsStream << std::boolalpha;
@@ -160,6 +442,12 @@ namespace cereal
       //! Destructor, flushes the XML
       ~XMLOutputArchive()
       {
+        if( itsWriter )
+        {
+          itsWriter->finish();
+          return;
+        }
+
         const int flags = itsIndent ? 0x0 : rapidxml::print_no_indenting;
         rapidxml::print( itsStream, itsXML, flags );
         itsXML.clear();
@@ -175,11 +463,25 @@ namespace cereal
 
         startNode();
 
-        auto base64string = base64::encode( reinterpret_cast<const unsigned char *>( data ), size );
-        saveValue( base64string );
+        auto const encodedSize = base64::encoded_size( size );
+        if( itsWriter )
+        {
+          itsBinaryBuffer.resize( encodedSize );
+          if( size )
+            base64::encode( reinterpret_cast<const unsigned char *>( data ), size, &itsBinaryBuffer[0] );
+          itsWriter->text( itsBinaryBuffer.data(), encodedSize );
+        }
+        else
+        {
+          // encoded straight into the memory of the document
+          auto dataPtr = itsXML.allocate_string( nullptr, encodedSize + 1 );
+          base64::encode( reinterpret_cast<const unsigned char *>( data ), size, dataPtr );
+          dataPtr[encodedSize] = '\0';
+          itsNodes.top().node->append_node( itsXML.allocate_node( rapidxml::node_data, nullptr, dataPtr ) );
+        }
 
         if( itsOutputType )
-          itsNodes.top().node->append_attribute( itsXML.allocate_attribute( "type", "cereal binary data" ) );
+          addAttribute( "type", "cereal binary data" );
 
         finishNode();
       };
@@ -200,6 +502,14 @@ namespace cereal
       {
         // generate a name for this new node
         const auto nameString = itsNodes.top().getValueName();
+        itsNodes.top().hasChildren = true;
+
+        if( itsWriter )
+        {
+          itsWriter->openElement( nameString.data(), nameString.size() );
+          itsNodes.emplace();
+          return;
+        }
 
         // allocate strings for all of the data in the XML object
         auto namePtr = itsXML.allocate_string( nameString.data(), nameString.length() + 1 );
@@ -213,6 +523,8 @@ namespace cereal
       //! Designates the most recently added node as finished
       void finishNode()
       {
+        if( itsWriter )
+          itsWriter->closeElement();
         itsNodes.pop();
       }
 
@@ -225,43 +537,125 @@ namespace cereal
       //! Saves some data, encoded as a string, into the current top level node
       /*! The data will be be named with the most recent name if one exists,
           otherwise it will be given some default delimited value that depends upon
-          the parent node */
-      template <class T> inline
+          the parent node.
+
+          Arithmetic types other than char have their own overloads, which do not use a stream */
+      template <class T, traits::DisableIf<std::is_arithmetic<T>::value &&
+                                           !std::is_same<T, char>::value> = traits::sfinae> inline
       void saveValue( T const & value )
       {
         itsOS.clear(); itsOS.seekp( 0, std::ios::beg );
         itsOS << value << std::ends;
 
+        // the string always contains a '\0' added by std::ends
         const auto strValue = itsOS.str();
+        saveChars( strValue.c_str(), strValue.length() - 1 );
+      }
 
-        // If the first or last character is a whitespace, add xml:space attribute
-        // the string always contains a '\0' added by std::ends, so the last character is at len-2 and an 'empty' 
-        // string has a length of 1 or lower
-        const auto len = strValue.length();
-        if ( len > 1 && ( xml_detail::isWhitespace( strValue[0] ) || xml_detail::isWhitespace( strValue[len - 2] ) ) )
-        {
-          itsNodes.top().node->append_attribute( itsXML.allocate_attribute( "xml:space", "preserve" ) );
-        }
+      //! Saves a string directly, without formatting it through a stream
+      void saveValue( std::string const & value )
+      {
+        saveChars( value.c_str(), value.length() );
+      }
 
-        // allocate strings for all of the data in the XML object
-        auto dataPtr = itsXML.allocate_string( itsOS.str().c_str(), itsOS.str().length() + 1 );
+      //! Saves a bool as true or false
+      void saveValue( bool const & value )
+      {
+        if( value )
+          saveChars( "true", 4 );
+        else
+          saveChars( "false", 5 );
+      }
 
-        // insert into the XML
-        itsNodes.top().node->append_node( itsXML.allocate_node( rapidxml::node_data, nullptr, dataPtr ) );
+      //! Saves an integer, except for characters, without formatting it through a stream
+      template <class T, traits::EnableIf<std::is_integral<T>::value,
+                                          !std::is_same<T, bool>::value,
+                                          !std::is_same<T, char>::value> = traits::sfinae> inline
+      void saveValue( T const & value )
+      {
+        char buffer[charconv_detail::bufferSize];
+        saveChars( buffer, charconv_detail::toChars( buffer, value ) );
       }
 
-      //! Overload for uint8_t prevents them from being serialized as characters
-      void saveValue( uint8_t const & value )
+      //! Saves a floating point number with the precision from the options
+      /*! Without loss of precision, this is the shortest text that reads back as the same value
+          when supported by the standard library, see charconv_detail::toChars */
+      template <class T, traits::EnableIf<std::is_floating_point<T>::value> = traits::sfinae> inline
+      void saveValue( T const & value )
       {
-        saveValue( static_cast<uint32_t>( value ) );
+        char buffer[charconv_detail::bufferSize];
+        saveChars( buffer, charconv_detail::toChars( buffer, value, itsPrecision ) );
       }
 
-      //! Overload for int8_t prevents them from being serialized as characters
-      void saveValue( int8_t const & value )
+      //! Saves a named arithmetic value as an attribute of the current top level node, if the options allow it
+      /*! @return false if the value must be saved as a child element instead */
+      template <class T> inline
+      bool saveAttribute( const char * name, T const & value )
       {
-        saveValue( static_cast<int32_t>( value ) );
+        if( !itsScalarAttributes || !name || itsNodes.top().hasChildren || xml_detail::isReservedAttribute( name ) )
+          return false;
+
+        char buffer[charconv_detail::bufferSize + 1];
+        buffer[formatScalar( buffer, value )] = '\0';
+        appendAttribute( name, buffer );
+        return true;
       }
 
+    private:
+      //! Formats a bool as true or false
+      std::size_t formatScalar( char * buffer, bool value )
+      {
+        std::strcpy( buffer, value ? "true" : "false" );
+        return value ? 4 : 5;
+      }
+
+      //! Formats an integer
+      template <class T, traits::EnableIf<std::is_integral<T>::value,
+                                          !std::is_same<T, bool>::value> = traits::sfinae> inline
+      std::size_t formatScalar( char * buffer, T value )
+      {
+        return charconv_detail::toChars( buffer, value );
+      }
+
+      //! Formats a floating point number with the precision from the options
+      template <class T, traits::EnableIf<std::is_floating_point<T>::value> = traits::sfinae> inline
+      std::size_t formatScalar( char * buffer, T value )
+      {
+        return charconv_detail::toChars( buffer, value, itsPrecision );
+      }
+
+      //! Appends an attribute whose name and value outlive the archive to the current top level node
+      void addAttribute( const char * name, const char * value )
+      {
+        if( itsWriter )
+          itsWriter->attribute( name, value );
+        else
+          itsNodes.top().node->append_attribute( itsXML.allocate_attribute( name, value ) );
+      }
+
+      //! Appends size characters of null terminated text as the data of the current top level node
+      void saveChars( const char * data, std::size_t size )
+      {
+        // If the first or last character is a whitespace, add xml:space attribute
+        if ( size > 0 && ( xml_detail::isWhitespace( data[0] ) || xml_detail::isWhitespace( data[size - 1] ) ) )
+        {
+          addAttribute( "xml:space", "preserve" );
+        }
+
+        if( itsWriter )
+        {
+          itsWriter->text( data, size );
+          return;
+        }
+
+        // allocate strings for all of the data in the XML object
+        auto dataPtr = itsXML.allocate_string( data, size + 1 );
+
+        // insert into the XML
+        itsNodes.top().node->append_node( itsXML.allocate_node( rapidxml::node_data, nullptr, dataPtr ) );
+      }
+
+    public:
       //! Causes the type to be appended as an attribute to the most recently made node if output type is set to true
       template <class T> inline
       void insertType()
@@ -269,18 +663,19 @@ namespace cereal
         if( !itsOutputType )
           return;
 
-        // generate a name for this new node
-        const auto nameString = util::demangledName<T>();
-
-        // allocate strings for all of the data in the XML object
-        auto namePtr = itsXML.allocate_string( nameString.data(), nameString.length() + 1 );
-
-        itsNodes.top().node->append_attribute( itsXML.allocate_attribute( "type", namePtr ) );
+        // the cached name outlives the document, so the node can refer to it without a copy
+        addAttribute( "type", util::cachedDemangledName<T>().c_str() );
       }
 
       //! Appends an attribute to the current top level node
       void appendAttribute( const char * name, const char * value )
       {
+        if( itsWriter )
+        {
+          itsWriter->attribute( name, value );
+          return;
+        }
+
         auto namePtr =  itsXML.allocate_string( name );
         auto valuePtr = itsXML.allocate_string( value );
         itsNodes.top().node->append_attribute( itsXML.allocate_attribute( namePtr, valuePtr ) );
@@ -294,12 +689,14 @@ namespace cereal
                   const char * nm = nullptr ) :
           node( n ),
           counter( 0 ),
-          name( nm )
+          name( nm ),
+          hasChildren( false )
         { }
 
         rapidxml::xml_node<> * node; //!< A pointer to this node
         size_t counter;              //!< The counter for naming child nodes
         const char * name;           //!< The name for the next child node
+        bool hasChildren;            //!< Whether a child node has been started, after which attributes are not added
 
         //! Gets the name for the next child node created from this node
         /*! The name will be automatically generated using the counter if
@@ -325,8 +722,12 @@ namespace cereal
       rapidxml::xml_document<> itsXML; //!< The XML document
       std::stack<NodeInfo> itsNodes;   //!< A stack of nodes added to the document
       std::ostringstream itsOS;        //!< Used to format strings internally
+      int itsPrecision;                //!< The precision for floating point numbers
       bool itsOutputType;              //!< Controls whether type information is printed
       bool itsIndent;                  //!< Controls whether indenting is used
+      bool itsScalarAttributes;        //!< Controls whether named arithmetic values are written as attributes
+      std::unique_ptr<xml_detail::StreamWriter> itsWriter; //!< Writes XML as it is saved, if streaming
+      std::string itsBinaryBuffer;     //!< Holds base64 encoded binary data while it is streamed
   }; // XMLOutputArchive
 
   // ######################################################################
@@ -374,36 +775,40 @@ namespace cereal
 
       //! Construct, reading in from the provided stream
       /*! Reads in an entire XML document from some stream and parses it as soon
-          as serialization starts
+          as serialization starts.  The remaining size of seekable streams is
+          detected so that the document is read with a single bulk read.
 
           @param stream The stream to read from.  Can be a stringstream or a file. */
       XMLInputArchive( std::istream & stream ) :
+        InputArchive<XMLInputArchive>( this )
+      {
+        readStream( stream );
+        itsData.push_back('\0'); // rapidxml will do terrible things without the data being null terminated
+        parse( itsData.data() );
+      }
+
+      //! Construct, parsing a document the archive takes ownership of
+      /*! The document is parsed in place, without copying it.
+
+          @param data The XML document, which may or may not be null terminated */
+      XMLInputArchive( std::vector<char> && data ) :
         InputArchive<XMLInputArchive>( this ),
-        itsData( std::istreambuf_iterator<char>( stream ), std::istreambuf_iterator<char>() )
+        itsData( std::move( data ) )
       {
-        try
-        {
-          itsData.push_back('\0'); // rapidxml will do terrible things without the data being null terminated
-          itsXML.parse<rapidxml::parse_trim_whitespace | rapidxml::parse_no_data_nodes | rapidxml::parse_declaration_node>( reinterpret_cast<char *>( itsData.data() ) );
-        }
-        catch( rapidxml::parse_error const & )
-        {
-          //std::cerr << "-----Original-----" << std::endl;
-          //stream.seekg(0);
-          //std::cout << std::string( std::istreambuf_iterator<char>( stream ), std::istreambuf_iterator<char>() ) << std::endl;
+        if( itsData.empty() || itsData.back() != '\0' )
+          itsData.push_back('\0');
+        parse( itsData.data() );
+      }
 
-          //std::cerr << "-----Error-----" << std::endl;
-          //std::cerr << e.what() << std::endl;
-          //std::cerr << e.where<char>() << std::endl;
-          throw Exception("XML Parsing failed - likely due to invalid characters or invalid naming");
-        }
+      //! Construct, parsing a document in a buffer owned by the caller
+      /*! The document is parsed in place, without copying it.  Parsing modifies the
+          buffer, which must remain valid for as long as the archive is used.
 
-        // Parse the root
-        auto root = itsXML.first_node( xml_detail::CEREAL_XML_STRING );
-        if( root == nullptr )
-          throw Exception("Could not detect cereal root node - likely due to empty or invalid input");
-        else
-          itsNodes.emplace( root );
+          @param data A null terminated XML document */
+      XMLInputArchive( char * data ) :
+        InputArchive<XMLInputArchive>( this )
+      {
+        parse( data );
       }
 
       //! Loads some binary data, encoded as a base64 string, optionally specified by some name
@@ -417,15 +822,14 @@ namespace cereal
         setNextName( name );
         startNode();
 
-        std::string encoded;
-        loadValue( encoded );
-
-        auto decoded = base64::decode( encoded );
+        // decoded straight from the document into data
+        auto const encoded = itsNodes.top().node->value();
+        auto const length = std::strlen( encoded );
 
-        if( size != decoded.size() )
+        if( size != base64::decoded_size( encoded, length ) )
           throw Exception("Decoded binary data size does not match specified size");
 
-        std::memcpy( data, decoded.data(), decoded.size() );
+        base64::decode( encoded, length, reinterpret_cast<unsigned char *>( data ) );
 
         finishNode();
       };
@@ -496,9 +900,7 @@ namespace cereal
                                           std::is_same<T, bool>::value> = traits::sfinae> inline
       void loadValue( T & value )
       {
-        std::istringstream is( itsNodes.top().node->value() );
-        is.setf( std::ios::boolalpha );
-        is >> value;
+        value = std::strcmp( itsNodes.top().node->value(), "true" ) == 0;
       }
 
       //! Loads a char (signed or unsigned) from the current top node
@@ -513,130 +915,139 @@ namespace cereal
       //! Load an int8_t from the current top node (ensures we parse entire number)
       void loadValue( int8_t & value )
       {
-        int32_t val; loadValue( val ); value = static_cast<int8_t>( val );
+        value = charconv_detail::fromChars<int8_t>( itsNodes.top().node->value() );
       }
 
       //! Load a uint8_t from the current top node (ensures we parse entire number)
       void loadValue( uint8_t & value )
       {
-        uint32_t val; loadValue( val ); value = static_cast<uint8_t>( val );
+        value = charconv_detail::fromChars<uint8_t>( itsNodes.top().node->value() );
       }
 
-      //! Loads a type best represented as an unsigned long from the current top node
-      template <class T, traits::EnableIf<std::is_unsigned<T>::value,
+      //! Loads an integer from the current top node
+      /*! @throws std::invalid_argument or std::out_of_range if the node does not hold a T */
+      template <class T, traits::EnableIf<std::is_integral<T>::value,
                                           !std::is_same<T, bool>::value,
-                                          !std::is_same<T, unsigned char>::value,
-                                          sizeof(T) < sizeof(long long)> = traits::sfinae> inline
+                                          (sizeof(T) > sizeof(char))> = traits::sfinae> inline
       void loadValue( T & value )
       {
-        value = static_cast<T>( std::stoul( itsNodes.top().node->value() ) );
+        value = charconv_detail::fromChars<T>( itsNodes.top().node->value() );
       }
 
-      //! Loads a type best represented as an unsigned long long from the current top node
-      template <class T, traits::EnableIf<std::is_unsigned<T>::value,
-                                          !std::is_same<T, bool>::value,
-                                          sizeof(T) >= sizeof(long long)> = traits::sfinae> inline
+      //! Loads a floating point number from the current top node, including subnormal values
+      /*! @throws std::invalid_argument or std::out_of_range if the node does not hold a T */
+      template <class T, traits::EnableIf<std::is_floating_point<T>::value> = traits::sfinae> inline
       void loadValue( T & value )
       {
-        value = static_cast<T>( std::stoull( itsNodes.top().node->value() ) );
+        value = charconv_detail::fromChars<T>( itsNodes.top().node->value() );
       }
 
-      //! Loads a type best represented as an int from the current top node
-      template <class T, traits::EnableIf<std::is_signed<T>::value,
-                                          !std::is_same<T, char>::value,
-                                          sizeof(T) <= sizeof(int)> = traits::sfinae> inline
-      void loadValue( T & value )
+      //! Loads a string from the current top node
+      void loadValue( std::string & str )
       {
-        value = static_cast<T>( std::stoi( itsNodes.top().node->value() ) );
+        // value_size() still counts escaped entities before they were decoded, so use the terminator
+        str.assign( itsNodes.top().node->value() );
       }
 
-      //! Loads a type best represented as a long from the current top node
-      template <class T, traits::EnableIf<std::is_signed<T>::value,
-                                          (sizeof(T) > sizeof(int)),
-                                          sizeof(T) <= sizeof(long)> = traits::sfinae> inline
-      void loadValue( T & value )
+      //! Loads a string of other characters from the current top node
+      template<class CharT, class Traits, class Alloc> inline
+      void loadValue( std::basic_string<CharT, Traits, Alloc> & str )
       {
-        value = static_cast<T>( std::stol( itsNodes.top().node->value() ) );
+        std::basic_istringstream<CharT, Traits> is( itsNodes.top().node->value() );
+
+        str.assign( std::istreambuf_iterator<CharT, Traits>( is ),
+                    std::istreambuf_iterator<CharT, Traits>() );
       }
 
-      //! Loads a type best represented as a long long from the current top node
-      template <class T, traits::EnableIf<std::is_signed<T>::value,
-                                          (sizeof(T) > sizeof(long)),
-                                          sizeof(T) <= sizeof(long long)> = traits::sfinae> inline
-      void loadValue( T & value )
+      //! Loads the size of the current top node
+      template <class T> inline
+      void loadSize( T & value )
+      {
+        value = getNumChildren( itsNodes.top().node );
+      }
+
+      //! Loads a named arithmetic value from an attribute of the current top node, if it has one
+      /*! @return false if there is no such attribute, and the value must be loaded from an element */
+      template <class T> inline
+      bool loadAttribute( const char * name, T & value )
       {
-        value = static_cast<T>( std::stoll( itsNodes.top().node->value() ) );
+        if( !name || xml_detail::isReservedAttribute( name ) )
+          return false;
+
+        auto const attribute = itsNodes.top().node->first_attribute( name );
+        if( attribute == nullptr )
+          return false;
+
+        parseScalar( attribute->value(), value );
+        return true;
       }
 
-      //! Loads a type best represented as a float from the current top node
-      void loadValue( float & value )
+    protected:
+      //! Parses a bool written as true or false
+      static void parseScalar( const char * text, bool & value )
       {
-        try
-        {
-          value = std::stof( itsNodes.top().node->value() );
-        }
-        catch( std::out_of_range const & )
-        {
-          // special case for denormalized values
-          std::istringstream is( itsNodes.top().node->value() );
-          is >> value;
-          if( std::fpclassify( value ) != FP_SUBNORMAL )
-            throw;
-        }
+        value = std::strcmp( text, "true" ) == 0;
       }
 
-      //! Loads a type best represented as a double from the current top node
-      void loadValue( double & value )
+      //! Parses a number
+      /*! @throws std::invalid_argument or std::out_of_range if the text does not hold a T */
+      template <class T, traits::DisableIf<std::is_same<T, bool>::value> = traits::sfinae> inline
+      static void parseScalar( const char * text, T & value )
       {
-        try
+        value = charconv_detail::fromChars<T>( text );
+      }
+
+      //! Reads the rest of a stream into itsData
+      /*! Seekable streams are read with one bulk read of their remaining size,
+          others in large blocks */
+      void readStream( std::istream & stream )
+      {
+        auto & buffer = *stream.rdbuf();
+        auto const start = buffer.pubseekoff( 0, std::ios::cur, std::ios::in );
+        auto const end = start == std::streampos( -1 ) ? start : buffer.pubseekoff( 0, std::ios::end, std::ios::in );
+
+        if( end != std::streampos( -1 ) && buffer.pubseekpos( start, std::ios::in ) == start )
         {
-          value = std::stod( itsNodes.top().node->value() );
+          itsData.resize( static_cast<std::size_t>( end - start ) );
+          itsData.resize( static_cast<std::size_t>( buffer.sgetn( itsData.data(), static_cast<std::streamsize>( itsData.size() ) ) ) );
+
+          if( std::char_traits<char>::eq_int_type( buffer.sgetc(), std::char_traits<char>::eof() ) )
+            return;
         }
-        catch( std::out_of_range const & )
+
+        // unseekable streams, or ones that grew since their size was detected
+        std::size_t const block = 1 << 16;
+        for( ;; )
         {
-          // special case for denormalized values
-          std::istringstream is( itsNodes.top().node->value() );
-          is >> value;
-          if( std::fpclassify( value ) != FP_SUBNORMAL )
-            throw;
+          auto const size = itsData.size();
+          itsData.resize( size + block );
+          auto const count = buffer.sgetn( itsData.data() + size, static_cast<std::streamsize>( block ) );
+          itsData.resize( size + static_cast<std::size_t>( count ) );
+          if( count < static_cast<std::streamsize>( block ) )
+            break;
         }
       }
 
-      //! Loads a type best represented as a long double from the current top node
-      void loadValue( long double & value )
+      //! Parses a null terminated document in place and moves to its root
+      void parse( char * data )
       {
         try
         {
-          value = std::stold( itsNodes.top().node->value() );
+          itsXML.parse<rapidxml::parse_trim_whitespace | rapidxml::parse_no_data_nodes | rapidxml::parse_declaration_node>( data );
         }
-        catch( std::out_of_range const & )
+        catch( rapidxml::parse_error const & )
         {
-          // special case for denormalized values
-          std::istringstream is( itsNodes.top().node->value() );
-          is >> value;
-          if( std::fpclassify( value ) != FP_SUBNORMAL )
-            throw;
+          throw Exception("XML Parsing failed - likely due to invalid characters or invalid naming");
         }
-      }
 
-      //! Loads a string from the current node from the current top node
-      template<class CharT, class Traits, class Alloc> inline
-      void loadValue( std::basic_string<CharT, Traits, Alloc> & str )
-      {
-        std::basic_istringstream<CharT, Traits> is( itsNodes.top().node->value() );
-
-        str.assign( std::istreambuf_iterator<CharT, Traits>( is ),
-                    std::istreambuf_iterator<CharT, Traits>() );
-      }
-
-      //! Loads the size of the current top node
-      template <class T> inline
-      void loadSize( T & value )
-      {
-        value = getNumChildren( itsNodes.top().node );
+        // Parse the root
+        auto root = itsXML.first_node( xml_detail::CEREAL_XML_STRING );
+        if( root == nullptr )
+          throw Exception("Could not detect cereal root node - likely due to empty or invalid input");
+        else
+          itsNodes.emplace( root );
       }
 
-    protected:
       //! Gets the number of children (usually interpreted as size) for the specified node
       static size_t getNumChildren( rapidxml::xml_node<> * node )
       {
@@ -676,35 +1087,63 @@ namespace cereal
         }
 
         //! Searches for a child with the given name in this node
-        /*! @param searchName The name to search for (must be null terminated)
+        /*! Nodes with many children are searched through an index of their
+            names, built the first time a search is needed.
+
+            @param searchName The name to search for (must be null terminated)
             @return The node if found, nullptr otherwise */
         rapidxml::xml_node<> * search( const char * searchName )
         {
           if( searchName )
           {
-            size_t new_size = XMLInputArchive::getNumChildren( node );
             const size_t name_size = rapidxml::internal::measure( searchName );
 
-            for( auto new_child = node->first_node(); new_child != nullptr; new_child = new_child->next_sibling() )
+            if( children.empty() )
+            {
+              for( auto c = node->first_node(); c != nullptr; c = c->next_sibling() )
+                children.push_back( c );
+
+              if( children.size() >= detail::FlatNameIndex::linearSearchLimit )
+              {
+                nameIndex.reserve( children.size() );
+                for( size_t i = 0; i < children.size(); ++i )
+                  nameIndex.insert( children[i]->name(), children[i]->name_size(), i );
+              }
+            }
+
+            if( !nameIndex.empty() )
             {
-              if( rapidxml::internal::compare( new_child->name(), new_child->name_size(), searchName, name_size, true ) )
+              size_t position;
+              if( nameIndex.find( searchName, name_size, position ) )
               {
-                size = new_size;
-                child = new_child;
+                size = children.size() - position;
+                child = children[position];
 
-                return new_child;
+                return child;
               }
-              --new_size;
+            }
+            else
+            {
+              for( size_t i = 0; i < children.size(); ++i )
+                if( rapidxml::internal::compare( children[i]->name(), children[i]->name_size(), searchName, name_size, true ) )
+                {
+                  size = children.size() - i;
+                  child = children[i];
+
+                  return child;
+                }
             }
           }
 
           return nullptr;
         }
 
-        rapidxml::xml_node<> * node;  //!< A pointer to this node
-        rapidxml::xml_node<> * child; //!< A pointer to its current child
-        size_t size;                  //!< The remaining number of children for this node
-        const char * name;            //!< The NVP name for next next child node
+        rapidxml::xml_node<> * node;                  //!< A pointer to this node
+        rapidxml::xml_node<> * child;                 //!< A pointer to its current child
+        size_t size;                                  //!< The remaining number of children for this node
+        const char * name;                            //!< The NVP name for next next child node
+        std::vector<rapidxml::xml_node<> *> children; //!< The children of this node, gathered on the first search
+        detail::FlatNameIndex nameIndex;              //!< Positions of the names of children, for nodes with many
       }; // NodeInfo
 
       //! @}
@@ -812,10 +1251,42 @@ namespace cereal
   // Common XMLArchive serialization functions
   // ######################################################################
 
+  namespace xml_detail
+  {
+    //! Saves an arithmetic NVP as an attribute, if the archive allows it
+    template <class T> inline
+    bool saveAttribute( XMLOutputArchive & ar, NameValuePair<T> const & t, std::true_type /* scalar */ )
+    {
+      return ar.saveAttribute( t.name, t.value );
+    }
+
+    template <class T> inline
+    bool saveAttribute( XMLOutputArchive &, NameValuePair<T> const &, std::false_type /* scalar */ )
+    {
+      return false;
+    }
+
+    //! Loads an arithmetic NVP from an attribute, if there is one
+    template <class T> inline
+    bool loadAttribute( XMLInputArchive & ar, NameValuePair<T> & t, std::true_type /* scalar */ )
+    {
+      return ar.loadAttribute( t.name, t.value );
+    }
+
+    template <class T> inline
+    bool loadAttribute( XMLInputArchive &, NameValuePair<T> &, std::false_type /* scalar */ )
+    {
+      return false;
+    }
+  } // namespace xml_detail
+
   //! Saving NVP types to XML
   template <class T> inline
   void CEREAL_SAVE_FUNCTION_NAME( XMLOutputArchive & ar, NameValuePair<T> const & t )
   {
+    if( xml_detail::saveAttribute( ar, t, xml_detail::is_attribute_scalar<typename std::decay<T>::type>() ) )
+      return;
+
     ar.setNextName( t.name );
     ar( t.value );
   }
@@ -824,6 +1295,9 @@ namespace cereal
   template <class T> inline
   void CEREAL_LOAD_FUNCTION_NAME( XMLInputArchive & ar, NameValuePair<T> & t )
   {
+    if( xml_detail::loadAttribute( ar, t, xml_detail::is_attribute_scalar<typename std::decay<T>::type>() ) )
+      return;
+
     ar.setNextName( t.name );
     ar( t.value );
   }
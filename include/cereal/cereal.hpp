@@ -35,17 +35,44 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
+#include <limits>
 
 #include <cereal/macros.hpp>
 #include <cereal/details/traits.hpp>
 #include <cereal/details/helpers.hpp>
+#include <cereal/details/flat_map.hpp>
+#include <cereal/details/memory_resource.hpp>
 #include <cereal/types/base_class.hpp>
 
 namespace cereal
 {
+  // Forward declarations, see details/snapshot.hpp
+  template <class Archive> class SnapshotWriter;
+  template <class Archive> class SnapshotReader;
+
+  namespace traits
+  {
+    //! Whether the serialization of T with Archive is instantiated in another translation unit
+    /*! \sa CEREAL_EXTERN_SERIALIZATION */
+    template <class Archive, class T>
+    struct has_extern_serialization : std::false_type {};
+  }
+
+  namespace detail
+  {
+    //! Serializes t with ar, for types declared with CEREAL_EXTERN_SERIALIZATION
+    /*! This is not inline so that an explicit instantiation declaration stops it,
+        and everything it uses, from being instantiated
+        @internal */
+    template <class Archive, class T>
+    void process_extern( Archive & ar, T & t );
+  }
+
   // ######################################################################
   //! Creates a name value pair
   /*! @relates NameValuePair
@@ -127,8 +154,18 @@ namespace cereal
         ensure that your classes that have custom serialization are correct
         by using the traits is_output_serializable and is_input_serializable
         in cereal/details/traits.hpp.
+
+      CoalesceArithmetic
+        This packs a run of adjacent arithmetic values passed to a single call,
+        such as ar( x, y, z ), into one buffer that is written with a single call
+        to saveBinary or read with a single call to loadBinary.  Archives that set
+        this must provide saveBinary or loadBinary, and must serialize arithmetic
+        types as exactly their bytes with no prologue or epilogue, which is how
+        BinaryOutputArchive and BinaryInputArchive behave.  Runs are not coalesced
+        while an ArchiveObserver is attached, or when statistics or tracing are
+        compiled in, so that every value is still seen on its own.
       @ingroup Internal */
-  enum Flags { AllowEmptyClassElision = 1 };
+  enum Flags { AllowEmptyClassElision = 1, CoalesceArithmetic = 2 };
 
   // ######################################################################
   //! Registers a specific Archive type with cereal
@@ -203,8 +240,10 @@ namespace cereal
       static const std::uint32_t version;                                        \
       static std::uint32_t registerVersion()                                     \
       {                                                                          \
-        ::cereal::detail::StaticObject<Versions>::getInstance().mapping.emplace( \
-             std::type_index(typeid(TYPE)).hash_code(), VERSION_NUMBER );        \
+        ::cereal::detail::StaticObject<Versions>::getInstance().declare(         \
+             std::type_index(typeid(TYPE)).hash_code(), VERSION_NUMBER,          \
+             std::integral_constant<std::uint64_t,                               \
+               ::cereal::detail::schema_term( #TYPE, VERSION_NUMBER )>::value ); \
         return VERSION_NUMBER;                                                   \
       }                                                                          \
       static void unused() { (void)version; }                                    \
@@ -213,6 +252,134 @@ namespace cereal
       Version<TYPE>::registerVersion();                                          \
   } } // end namespaces
 
+  // ######################################################################
+  //! Declares that serializing a type with an archive is instantiated in another translation unit
+  /*! Each translation unit that serializes a type instantiates the serialization
+      functions of the type and of everything it contains, together with the traits
+      cereal uses to choose them, and the linker later discards all but one copy.
+      Declaring the type extern skips that work in every translation unit but one,
+      which instantiates it with CEREAL_INSTANTIATE_SERIALIZATION:
+
+      @code{.cpp}
+      // record.hpp, included wherever a Record is serialized
+      CEREAL_EXTERN_SERIALIZATION(cereal::BinaryOutputArchive, Record)
+      CEREAL_EXTERN_SERIALIZATION(cereal::BinaryInputArchive, Record)
+
+      // record.cpp
+      #include "record.hpp"
+      CEREAL_INSTANTIATE_SERIALIZATION(cereal::BinaryOutputArchive, Record)
+      CEREAL_INSTANTIATE_SERIALIZATION(cereal::BinaryInputArchive, Record)
+      @endcode
+
+      The declaration must be seen before the type is first serialized with the
+      archive, and the archive header must be included before it.  This macro
+      should be placed at global scope.
+      @ingroup Utility */
+  #define CEREAL_EXTERN_SERIALIZATION(ARCHIVE, TYPE)                                               \
+  namespace cereal {                                                                               \
+    namespace traits { template <> struct has_extern_serialization<ARCHIVE, TYPE> : std::true_type {}; } \
+    namespace detail { extern template void process_extern<ARCHIVE, TYPE>( ARCHIVE &, TYPE & ); }  \
+  } // end namespaces
+
+  //! Instantiates serializing a type with an archive that is declared extern
+  /*! This must follow CEREAL_EXTERN_SERIALIZATION for the same type and archive,
+      in a translation unit that sees the serialization functions of the type.
+      \sa CEREAL_EXTERN_SERIALIZATION
+      @ingroup Utility */
+  #define CEREAL_INSTANTIATE_SERIALIZATION(ARCHIVE, TYPE)                                          \
+  namespace cereal { namespace detail {                                                            \
+    template void process_extern<ARCHIVE, TYPE>( ARCHIVE &, TYPE & );                              \
+  } } // end namespaces
+
+  namespace detail
+  {
+    //! How a value is described to an ArchiveObserver
+    template <class T>
+    struct observed
+    {
+      typedef T type;
+      static const bool wrapper = false;
+      template <class U> static char const * name( U const & ) { return nullptr; }
+    };
+
+    template <class T>
+    struct observed<NameValuePair<T>>
+    {
+      typedef typename std::remove_cv<typename std::remove_reference<T>::type>::type type;
+      static const bool wrapper = false;
+      static char const * name( NameValuePair<T> const & nvp ) { return nvp.name; }
+    };
+
+    //! Cereal's own wrappers, which belong to the value around them
+    template <class T>
+    struct observed_wrapper
+    {
+      typedef T type;
+      static const bool wrapper = true;
+      template <class U> static char const * name( U const & ) { return nullptr; }
+    };
+
+    template <class T> struct observed<SizeTag<T>> : observed_wrapper<SizeTag<T>> {};
+    template <class T> struct observed<BinaryData<T>> : observed_wrapper<BinaryData<T>> {};
+    template <class T> struct observed<base_class<T>> : observed_wrapper<base_class<T>> {};
+    template <class T> struct observed<virtual_base_class<T>> : observed_wrapper<virtual_base_class<T>> {};
+
+    #ifdef CEREAL_TRACE_POLICY
+    //! Calls CEREAL_TRACE_POLICY around serializing a value of a traced type
+    /*! CEREAL_TRACE_POLICY may be defined, before including any cereal header, to a
+        class whose static functions mark where each value of a traced type (see
+        traits::is_traced) begins and ends being serialized, for instance as slices
+        of a Perfetto or ITT trace:
+
+        @code{.cpp}
+        struct Tracer
+        {
+          static void begin( std::type_info const & type, std::uint64_t position );
+          static void end( std::type_info const & type, std::uint64_t position );
+        };
+        #define CEREAL_TRACE_POLICY ::Tracer
+        @endcode
+
+        The position is ArchiveStatistics::bytes, which binary archives advance as they
+        write or read, and which stays zero for text archives.  The end call is made from
+        the destructor, so a trace stays balanced when serialization throws.  Without
+        the define, nothing is called or compiled in. */
+    template <class T, bool Traced = traits::is_traced<T>::value && !observed<T>::wrapper &&
+                                     std::is_same<typename observed<T>::type, T>::value>
+    class TraceScope
+    {
+      public:
+        explicit TraceScope( StatisticsCounter const & counter ) : itsCounter( counter )
+        {
+          CEREAL_TRACE_POLICY::begin( typeid(T), itsCounter.get().bytes );
+        }
+
+        ~TraceScope()
+        {
+          CEREAL_TRACE_POLICY::end( typeid(T), itsCounter.get().bytes );
+        }
+
+      private:
+        StatisticsCounter const & itsCounter;
+    };
+
+    template <class T>
+    class TraceScope<T, false>
+    {
+      public:
+        explicit TraceScope( StatisticsCounter const & ) {}
+    };
+    #else // CEREAL_TRACE_POLICY
+    //! Stands in for tracing when CEREAL_TRACE_POLICY is not defined
+    template <class T>
+    class TraceScope
+    {
+      public:
+        explicit TraceScope( StatisticsCounter const & ) {}
+    };
+    #endif // CEREAL_TRACE_POLICY
+  } // namespace detail
+
   // ######################################################################
   //! The base output archive class
   /*! This is the base output archive for all output archives.  If you create
@@ -236,7 +403,8 @@ namespace cereal
     public:
       //! Construct the output archive
       /*! @param derived A pointer to the derived ArchiveType (pass this from the derived archive) */
-      OutputArchive(ArchiveType * const derived) : self(derived), itsCurrentPointerId(1), itsCurrentPolymorphicTypeId(1)
+      OutputArchive(ArchiveType * const derived) : self(derived), itsProcessingBase(false), itsCurrentPointerId(1), itsCurrentPolymorphicTypeId(1), itsCurrentInternedStringId(1),
+        itsVersionedTypeCount(0), itsElideClassVersions(false), itsSnapshotWriter(nullptr), itsUserData(), itsStatistics(), itsObserver(nullptr)
       { }
 
       OutputArchive & operator=( OutputArchive const & ) = delete;
@@ -284,23 +452,232 @@ namespace cereal
           unnecessary saves from taking place if multiple shared pointers
           point to the same data.
 
+          Ids are 64 bits wide so that a single archive can hold more than 2^31
+          pointers; see memory_detail::saveSharedPointerId for how they are written.
+
           @internal
           @param addr The address (see shared_ptr get()) pointed to by the shared pointer
-          @return A key that uniquely identifies the pointer */
-      inline std::uint32_t registerSharedPointer( void const * addr )
+          @return A key that uniquely identifies the pointer, with detail::msb_64bit
+                  set if this is the first time it has been seen */
+      inline std::uint64_t registerSharedPointer( void const * addr )
       {
         // Handle null pointers by just returning 0
         if(addr == 0) return 0;
 
-        auto id = itsSharedPointerMap.find( addr );
-        if( id == itsSharedPointerMap.end() )
+        auto id = itsSharedPointerMap.insert( addr, itsCurrentPointerId );
+        if( id.second )
         {
-          auto ptrId = itsCurrentPointerId++;
-          itsSharedPointerMap.insert( {addr, ptrId} );
-          return ptrId | detail::msb_32bit; // mask MSB to be 1
+          ++itsCurrentPointerId;
+          itsStatistics.sharedPointer();
+          return id.first | detail::msb_64bit; // mask MSB to be 1
         }
         else
-          return id->second;
+          return id.first;
+      }
+
+      //! Prepares the archive to track the given number of distinct shared pointers
+      /*! This is purely an optimization for archives saving very large numbers
+          of shared pointers, avoiding repeated growth of the tracking table.
+
+          @param count The expected number of distinct shared pointers */
+      inline void reserveSharedPointers( std::size_t count )
+      {
+        itsSharedPointerMap.reserve( count );
+      }
+
+      //! Forgets everything the archive has tracked so far
+      /*! Shared pointers, polymorphic type names, interned strings, deduplicated blobs,
+          base classes, and class versions are cleared, so data saved afterwards is independent of anything saved
+          before, exactly as if it had been saved by a newly constructed archive.
+          Memory allocated for tracking is kept for reuse.
+
+          Archives that write to a stream provide a reset taking the new stream,
+          which should be preferred over calling this directly. */
+      inline void reset()
+      {
+        itsBaseClasses.clear();
+        itsProcessingBase = false;
+        itsSharedPointerMap.clear();
+        itsCurrentPointerId = 1;
+        itsTrackingScopes.clear();
+        itsPolymorphicTypeMap.clear();
+        itsCurrentPolymorphicTypeId = 1;
+        itsInternedStringMap.clear();
+        itsCurrentInternedStringId = 1;
+        itsBlobMap.clear();
+        itsBlobs.clear();
+        itsVersionedTypes.clear();
+        itsVersionedTypeCount = 0;
+        itsElideClassVersions = false;
+        itsStatistics.reset();
+      }
+
+      //! Forgets tracked shared pointers and base classes, keeping type information
+      /*! Polymorphic type names, interned strings, deduplicated blobs, and class versions
+          stay registered, so data saved afterwards refers back to those saved before.  It can only be
+          loaded by an input archive that loaded the earlier data and then called its own
+          resetPointers.  This lets a stream of messages carry type information once. */
+      inline void resetPointers()
+      {
+        itsBaseClasses.clear();
+        itsProcessingBase = false;
+        itsSharedPointerMap.clear();
+        itsCurrentPointerId = 1;
+        itsTrackingScopes.clear();
+      }
+
+      //! Starts a region of the data whose shared pointers are forgotten when it ends
+      /*! An archive tracks every shared pointer it saves, so that later pointers to the
+          same object refer back to it.  In a long stream of records this table grows
+          without bound, and on the loading side it keeps every loaded object alive.
+          Placing each record in a tracking scope forgets the pointers first saved within
+          it when endTrackingScope is called, so memory stays flat.  Pointers tracked
+          before the scope began are still referred back to.  Scopes may be nested.
+
+          The input archive must begin and end its scopes at the same points in the data.
+          A pointer first saved within a scope and saved again after it has ended is
+          written in full a second time, and so is loaded as a separate object.
+
+          @code{.cpp}
+          for( auto const & record : records )
+          {
+            ar.beginTrackingScope();
+            ar( record );
+            ar.endTrackingScope();
+          }
+          @endcode */
+      inline void beginTrackingScope()
+      {
+        itsTrackingScopes.push_back( itsCurrentPointerId );
+        itsSharedPointerMap.checkpoint();
+      }
+
+      //! Writes a fingerprint of the registered class versions, after which no class version is written
+      /*! Every versioned type normally writes its version the first time it is saved.  When
+          the reader is built with the same CEREAL_CLASS_VERSION declarations, this header
+          replaces all of them with a single 64 bit word, and neither side looks versions up
+          per archive any more.  Each type contributes a term computed at compile time from
+          its name as spelled in the macro and its version, and the terms are summed when
+          CEREAL_CLASS_VERSION declarations run during static initialization.
+
+          The fingerprint therefore covers every versioned type linked into the program,
+          not just the types in the archive.  A reader and writer that link different sets
+          of versioned types reject each other's data even if the archive holds none of the
+          differing types.  It is also incomplete if this is called during static
+          initialization, before all declarations have run.
+
+          The input archive must call its own useSchemaFingerprint at the same point in the
+          data, and throws if its fingerprint differs.  Data saved this way therefore cannot
+          be loaded by a reader whose versions have changed; use it for data exchanged between
+          builds of the same program.  The setting lasts until the archive is reset. */
+      inline void useSchemaFingerprint()
+      {
+        std::uint64_t const fingerprint = detail::StaticObject<detail::Versions>::getInstance().getFingerprint();
+        process( make_nvp<ArchiveType>("cereal_schema_fingerprint", fingerprint) );
+        itsElideClassVersions = true;
+      }
+
+      //! Ends the innermost tracking scope, forgetting the shared pointers first saved within it
+      /*! @throws Exception if no tracking scope has begun */
+      inline void endTrackingScope()
+      {
+        if( itsTrackingScopes.empty() )
+          throw Exception("endTrackingScope was called without a matching beginTrackingScope");
+
+        auto const first = itsTrackingScopes.back();
+        itsTrackingScopes.pop_back();
+        itsSharedPointerMap.rollback();
+        itsCurrentPointerId = first;
+      }
+
+      //! Attaches the writer of the incremental snapshot being saved, or nullptr
+      /*! This is done by SnapshotWriter::save.
+          @internal */
+      inline void setSnapshot( SnapshotWriter<ArchiveType> * writer )
+      {
+        itsSnapshotWriter = writer;
+      }
+
+      //! Gets the writer of the incremental snapshot being saved
+      /*! @return The writer, or nullptr if this is not saving a snapshot
+          @internal */
+      inline SnapshotWriter<ArchiveType> * getSnapshotWriter() const
+      {
+        return itsSnapshotWriter;
+      }
+
+      //! Attaches user data of type T for serialization functions to retrieve with getUserData
+      /*! Unlike UserDataAdapter, this does not change the type of the archive, and
+          retrieving the data costs no dynamic_cast.  Data of different types can be
+          attached side by side; attaching data of a type again replaces it, and passing
+          nullptr detaches it.  The data must outlive its use by the archive, and is
+          kept when the archive is reset.
+
+          @code{.cpp}
+          template <class Archive>
+          static void load_and_construct( Archive & ar, cereal::construct<MyType> & construct )
+          {
+            int x;
+            ar( x );
+            construct( x, ar.template getUserData<MyContext>() );
+          }
+          @endcode
+
+          @param data The data to attach, or nullptr */
+      template <class T> inline
+      void setUserData( T * data )
+      {
+        itsUserData.set( data );
+      }
+
+      //! Gets user data of type T attached with setUserData
+      /*! @return The data, or nullptr if none of this type is attached */
+      template <class T> inline
+      T * getUserData() const
+      {
+        return itsUserData.template get<T>();
+      }
+
+      //! Gives an archive that saves part of this one's data the same user data
+      /*! This is used where data is saved by archives of its own that are embedded
+          in this one, such as the chunks of cereal::parallel.
+          @internal */
+      inline void configureNested( ArchiveType & nested ) const
+      {
+        static_cast<OutputArchive &>( nested ).itsUserData = itsUserData;
+      }
+
+      //! Counts of the work done by the archive since it was constructed or reset
+      /*! These are only collected when CEREAL_ARCHIVE_STATISTICS or CEREAL_TRACE_POLICY
+          is defined, and are all zero otherwise.  Bytes and calls to %sBinary are only counted by binary archives. */
+      inline ArchiveStatistics const & statistics() const
+      {
+        return itsStatistics.get();
+      }
+
+      //! Gives archives and serialization functions access to the counters of statistics
+      /*! @internal */
+      inline detail::StatisticsCounter & statisticsCounter()
+      {
+        return itsStatistics;
+      }
+
+      //! Attaches an observer that is told about every value the archive serializes
+      /*! Observing costs a branch per value while no observer is attached.  The observer
+          must outlive its use by the archive, and is kept when the archive is reset.
+          @param observer The observer, or nullptr to detach it */
+      inline void setObserver( ArchiveObserver * observer )
+      {
+        itsObserver = observer;
+      }
+
+      //! The number of polymorphic type names, interned strings, deduplicated blobs, and class versions registered
+      /*! Comparing this before and after saving some data tells whether the data holds
+          type information that later data may refer back to.
+          @internal */
+      inline std::size_t definitionCount() const
+      {
+        return itsCurrentPolymorphicTypeId + itsCurrentInternedStringId + itsBlobs.size() + itsVersionedTypeCount;
       }
 
       //! Registers a polymorphic type name with the archive
@@ -324,33 +701,174 @@ namespace cereal
           return id->second;
       }
 
+      //! Registers a string saved through cereal::interned with the archive
+      /*! @internal
+          @param str The string to intern
+          @return A key that uniquely identifies the string, with the MSB set
+                  if this is the first time the string was registered */
+      inline std::uint32_t registerInternedString( std::string const & str )
+      {
+        auto id = itsInternedStringMap.find( str );
+        if( id == itsInternedStringMap.end() )
+        {
+          auto stringId = itsCurrentInternedStringId++;
+          itsInternedStringMap.insert( {str, stringId} );
+          return stringId | detail::msb_32bit; // mask MSB to be 1
+        }
+        else
+          return id->second;
+      }
+
+      //! Registers a block of bytes saved through cereal::deduplicated with the archive
+      /*! Blocks are found by a hash of their contents, and a copy of each distinct
+          block is kept to confirm that a match is not a collision.
+
+          @internal
+          @param data The bytes of the block
+          @param size The number of bytes in the block
+          @return A key that uniquely identifies the contents of the block, with the
+                  MSB set if this is the first time they were registered */
+      inline std::uint32_t registerDeduplicatedBlob( void const * data, std::size_t size )
+      {
+        auto const hash = detail::hash_bytes( data, size );
+        auto const candidates = itsBlobMap.equal_range( hash );
+        for( auto it = candidates.first; it != candidates.second; ++it )
+        {
+          auto const & blob = itsBlobs[it->second - 1];
+          if( blob.size() == size && std::memcmp( blob.data(), data, size ) == 0 )
+            return it->second;
+        }
+
+        itsBlobs.emplace_back( static_cast<char const *>( data ), size );
+        auto const blobId = static_cast<std::uint32_t>( itsBlobs.size() );
+        itsBlobMap.insert( {hash, blobId} );
+        return blobId | detail::msb_32bit; // mask MSB to be 1
+      }
+
     private:
-      //! Serializes data after calling prologue, then calls epilogue
+      template <class A, class T> friend void detail::process_extern( A &, T & );
+
+      //! Serializes data, in another translation unit if it is declared extern
       template <class T> inline
       void process( T && head )
+      {
+        // Nesting is counted as InputArchive counts it for LoadLimits::maxDepth
+        static const bool nests = std::is_class<typename std::decay<T>::type>::value;
+        if( nests )
+          itsStatistics.enter();
+        if( itsObserver )
+          observeEnter( head );
+        detail::TraceScope<typename std::decay<T>::type> const trace( itsStatistics );
+
+        processLocal( traits::has_extern_serialization<ArchiveType, typename std::decay<T>::type>(), head );
+
+        if( itsObserver )
+          itsObserver->leave();
+        if( nests )
+          itsStatistics.leave();
+      }
+
+      //! Tells the observer about a value
+      template <class T> inline
+      void observeEnter( T const & head )
+      {
+        typedef detail::observed<typename std::decay<T>::type> Observed;
+        itsObserver->enter( Observed::name( head ), typeid(typename Observed::type), Observed::wrapper );
+      }
+
+      //! Serializes a type declared with CEREAL_EXTERN_SERIALIZATION
+      template <class T> inline
+      void processLocal( std::true_type, T & head )
+      {
+        detail::process_extern( *self, const_cast<typename std::decay<T>::type &>( head ) );
+      }
+
+      //! Serializes data after calling prologue, then calls epilogue
+      template <class T> inline
+      void processLocal( std::false_type, T & head )
       {
         prologue( *self, head );
         self->processImpl( head );
         epilogue( *self, head );
       }
 
+      //! Whether the leading arithmetic values of a call are packed together
+      template <class ... Types>
+      using coalesce = std::integral_constant<bool, (Flags & CoalesceArithmetic) && !detail::counts_values &&
+                                                    traits::detail::arithmetic_run<Types...>::count >= 2>;
+
       //! Unwinds to process all data
       template <class T, class ... Other> inline
       void process( T && head, Other && ... tail )
+      {
+        processRun( coalesce<T, Other...>(), std::forward<T>( head ), std::forward<Other>( tail )... );
+      }
+
+      //! Processes the head on its own
+      template <class T, class ... Other> inline
+      void processRun( std::false_type, T && head, Other && ... tail )
       {
         self->process( std::forward<T>( head ) );
         self->process( std::forward<Other>( tail )... );
       }
 
+      //! Packs the leading arithmetic values into a buffer saved at once
+      /*! An attached observer sees each value on its own instead */
+      template <class ... Types> inline
+      void processRun( std::true_type, Types && ... args )
+      {
+        if( itsObserver )
+          return processRun( std::false_type(), std::forward<Types>( args )... );
+
+        using run = traits::detail::arithmetic_run<Types...>;
+        char buffer[run::size];
+        saveRun<run::count>( buffer, buffer, std::forward<Types>( args )... );
+      }
+
+      //! Packs N more values of a run
+      template <std::size_t N, class ... Types> inline
+      void saveRun( char * buffer, char * position, Types && ... args )
+      {
+        saveRun<N>( std::integral_constant<bool, N == 0>(), buffer, position, std::forward<Types>( args )... );
+      }
+
+      //! Saves a completed run, then processes the rest
+      template <std::size_t N, class ... Types> inline
+      void saveRun( std::true_type, char * buffer, char * position, Types && ... rest )
+      {
+        self->saveBinary( buffer, static_cast<std::size_t>( position - buffer ) );
+        processRest( std::forward<Types>( rest )... );
+      }
+
+      //! Packs the next value of a run
+      template <std::size_t N, class T, class ... Other> inline
+      void saveRun( std::false_type, char * buffer, char * position, T && head, Other && ... tail )
+      {
+        std::memcpy( position, std::addressof( head ), sizeof( head ) );
+        saveRun<N - 1>( buffer, position + sizeof( head ), std::forward<Other>( tail )... );
+      }
+
+      //! Nothing follows a run
+      void processRest()
+      { }
+
+      //! Processes whatever follows a run
+      template <class ... Types> inline
+      void processRest( Types && ... args )
+      {
+        self->process( std::forward<Types>( args )... );
+      }
+
       //! Serialization of a virtual_base_class wrapper
       /*! \sa virtual_base_class */
       template <class T> inline
       ArchiveType & processImpl(virtual_base_class<T> const & b)
       {
         traits::detail::base_class_id id(b.base_ptr);
-        if(itsBaseClassSet.count(id) == 0)
+        if(std::find(itsBaseClasses.begin(), itsBaseClasses.end(), id) == itsBaseClasses.end())
         {
-          itsBaseClassSet.insert(id);
+          itsBaseClasses.push_back(id);
+          itsProcessingBase = true;
           self->processImpl( *b.base_ptr );
         }
         return *self;
@@ -361,77 +879,99 @@ namespace cereal
       template <class T> inline
       ArchiveType & processImpl(base_class<T> const & b)
       {
+        itsProcessingBase = true;
         self->processImpl( *b.base_ptr );
         return *self;
       }
 
-      //! Helper macro that expands the requirements for activating an overload
-      /*! Requirements:
-            Has the requested serialization function
-            Does not have version and unversioned at the same time
-            Is output serializable AND
-              is specialized for this type of function OR
-              has no specialization at all */
-      #define PROCESS_IF(name)                                                             \
-      traits::EnableIf<traits::has_##name<T, ArchiveType>::value,                          \
-                       !traits::has_invalid_output_versioning<T, ArchiveType>::value,      \
-                       (traits::is_output_serializable<T, ArchiveType>::value &&           \
-                        (traits::is_specialized_##name<T, ArchiveType>::value ||           \
-                         !traits::is_specialized<T, ArchiveType>::value))> = traits::sfinae
+      //! Serializes with the functions chosen for T by traits::output_kind
+      template <class T> inline
+      ArchiveType & processImpl(T const & t)
+      {
+        return processObject( t, std::is_class<T>() );
+      }
+
+      //! Serializes an object that may have virtual base classes
+      /*! Virtual base classes are only tracked while the most derived object they are
+          part of is serialized, which keeps the tracking as small as the nesting of
+          objects.  A base class is serialized as part of the object deriving from it,
+          so it leaves the tracking in place. */
+      template <class T> inline
+      ArchiveType & processObject(T const & t, std::true_type /* is_class */)
+      {
+        bool const isBase = itsProcessingBase;
+        itsProcessingBase = false;
+
+        if( isBase )
+          return self->processImpl( t, typename traits::output_kind<T, ArchiveType, (Flags & AllowEmptyClassElision) != 0>::type() );
+
+        auto const tracked = itsBaseClasses.size();
+        self->processImpl( t, typename traits::output_kind<T, ArchiveType, (Flags & AllowEmptyClassElision) != 0>::type() );
+        itsBaseClasses.erase( itsBaseClasses.begin() + static_cast<std::ptrdiff_t>( tracked ), itsBaseClasses.end() );
+        return *self;
+      }
+
+      //! Serializes a value that cannot have base classes
+      template <class T> inline
+      ArchiveType & processObject(T const & t, std::false_type /* is_class */)
+      {
+        return self->processImpl( t, typename traits::output_kind<T, ArchiveType, (Flags & AllowEmptyClassElision) != 0>::type() );
+      }
+
+      //! Helper macro that names the tag for a kind of serialization function
+      #define PROCESS_KIND(name) std::integral_constant<traits::serialization_kind, traits::serialization_kind::name>
 
       //! Member serialization
-      template <class T, PROCESS_IF(member_serialize)> inline
-      ArchiveType & processImpl(T const & t)
+      template <class T> inline
+      ArchiveType & processImpl(T const & t, PROCESS_KIND(member_serialize))
       {
         access::member_serialize(*self, const_cast<T &>(t));
         return *self;
       }
 
       //! Non member serialization
-      template <class T, PROCESS_IF(non_member_serialize)> inline
-      ArchiveType & processImpl(T const & t)
+      template <class T> inline
+      ArchiveType & processImpl(T const & t, PROCESS_KIND(non_member_serialize))
       {
         CEREAL_SERIALIZE_FUNCTION_NAME(*self, const_cast<T &>(t));
         return *self;
       }
 
       //! Member split (save)
-      template <class T, PROCESS_IF(member_save)> inline
-      ArchiveType & processImpl(T const & t)
+      template <class T> inline
+      ArchiveType & processImpl(T const & t, PROCESS_KIND(member_split))
       {
         access::member_save(*self, t);
         return *self;
       }
 
       //! Non member split (save)
-      template <class T, PROCESS_IF(non_member_save)> inline
-      ArchiveType & processImpl(T const & t)
+      template <class T> inline
+      ArchiveType & processImpl(T const & t, PROCESS_KIND(non_member_split))
       {
         CEREAL_SAVE_FUNCTION_NAME(*self, t);
         return *self;
       }
 
       //! Member split (save_minimal)
-      template <class T, PROCESS_IF(member_save_minimal)> inline
-      ArchiveType & processImpl(T const & t)
+      template <class T> inline
+      ArchiveType & processImpl(T const & t, PROCESS_KIND(member_minimal))
       {
         self->process( access::member_save_minimal(*self, t) );
         return *self;
       }
 
       //! Non member split (save_minimal)
-      template <class T, PROCESS_IF(non_member_save_minimal)> inline
-      ArchiveType & processImpl(T const & t)
+      template <class T> inline
+      ArchiveType & processImpl(T const & t, PROCESS_KIND(non_member_minimal))
       {
         self->process( CEREAL_SAVE_MINIMAL_FUNCTION_NAME(*self, t) );
         return *self;
       }
 
       //! Empty class specialization
-      template <class T, traits::EnableIf<(Flags & AllowEmptyClassElision),
-                                          !traits::is_output_serializable<T, ArchiveType>::value,
-                                          std::is_empty<T>::value> = traits::sfinae> inline
-      ArchiveType & processImpl(T const &)
+      template <class T> inline
+      ArchiveType & processImpl(T const &, PROCESS_KIND(empty))
       {
         return *self;
       }
@@ -440,10 +980,8 @@ namespace cereal
       /*! Invalid if we have invalid output versioning or
           we are not output serializable, and either
           don't allow empty class ellision or allow it but are not serializing an empty class */
-      template <class T, traits::EnableIf<traits::has_invalid_output_versioning<T, ArchiveType>::value ||
-                                          (!traits::is_output_serializable<T, ArchiveType>::value &&
-                                           (!(Flags & AllowEmptyClassElision) || ((Flags & AllowEmptyClassElision) && !std::is_empty<T>::value)))> = traits::sfinae> inline
-      ArchiveType & processImpl(T const &)
+      template <class T> inline
+      ArchiveType & processImpl(T const &, PROCESS_KIND(invalid))
       {
         static_assert(traits::detail::count_output_serializers<T, ArchiveType>::value != 0,
             "cereal could not find any output serialization functions for the provided type and archive combination. \n\n "
@@ -474,21 +1012,31 @@ namespace cereal
       template <class T> inline
       std::uint32_t registerClassVersion()
       {
-        static const auto hash = std::type_index(typeid(T)).hash_code();
-        const auto insertResult = itsVersionedTypes.insert( hash );
-        const auto version =
-          detail::StaticObject<detail::Versions>::getInstance().find( hash, detail::Version<T>::version );
+        static const auto version = detail::StaticObject<detail::Versions>::getInstance().find(
+          std::type_index(typeid(T)).hash_code(), detail::Version<T>::version );
+        if( itsElideClassVersions )
+          return version;
 
-        if( insertResult.second ) // insertion took place, serialize the version number
+        const auto slot = detail::versioned_type_slot<T>();
+
+        if( slot >= itsVersionedTypes.size() )
+          itsVersionedTypes.resize( slot + 1, false );
+
+        if( !itsVersionedTypes[slot] ) // first time we've seen this type, serialize the version number
+        {
+          itsVersionedTypes[slot] = true;
+          ++itsVersionedTypeCount;
+          itsStatistics.versionedType();
           process( make_nvp<ArchiveType>("cereal_class_version", version) );
+        }
 
         return version;
       }
 
       //! Member serialization
       /*! Versioning implementation */
-      template <class T, PROCESS_IF(member_versioned_serialize)> inline
-      ArchiveType & processImpl(T const & t)
+      template <class T> inline
+      ArchiveType & processImpl(T const & t, PROCESS_KIND(member_versioned_serialize))
       {
         access::member_serialize(*self, const_cast<T &>(t), registerClassVersion<T>());
         return *self;
@@ -496,8 +1044,8 @@ namespace cereal
 
       //! Non member serialization
       /*! Versioning implementation */
-      template <class T, PROCESS_IF(non_member_versioned_serialize)> inline
-      ArchiveType & processImpl(T const & t)
+      template <class T> inline
+      ArchiveType & processImpl(T const & t, PROCESS_KIND(non_member_versioned_serialize))
       {
         CEREAL_SERIALIZE_FUNCTION_NAME(*self, const_cast<T &>(t), registerClassVersion<T>());
         return *self;
@@ -505,8 +1053,8 @@ namespace cereal
 
       //! Member split (save)
       /*! Versioning implementation */
-      template <class T, PROCESS_IF(member_versioned_save)> inline
-      ArchiveType & processImpl(T const & t)
+      template <class T> inline
+      ArchiveType & processImpl(T const & t, PROCESS_KIND(member_versioned_split))
       {
         access::member_save(*self, t, registerClassVersion<T>());
         return *self;
@@ -514,8 +1062,8 @@ namespace cereal
 
       //! Non member split (save)
       /*! Versioning implementation */
-      template <class T, PROCESS_IF(non_member_versioned_save)> inline
-      ArchiveType & processImpl(T const & t)
+      template <class T> inline
+      ArchiveType & processImpl(T const & t, PROCESS_KIND(non_member_versioned_split))
       {
         CEREAL_SAVE_FUNCTION_NAME(*self, t, registerClassVersion<T>());
         return *self;
@@ -523,8 +1071,8 @@ namespace cereal
 
       //! Member split (save_minimal)
       /*! Versioning implementation */
-      template <class T, PROCESS_IF(member_versioned_save_minimal)> inline
-      ArchiveType & processImpl(T const & t)
+      template <class T> inline
+      ArchiveType & processImpl(T const & t, PROCESS_KIND(member_versioned_minimal))
       {
         self->process( access::member_save_minimal(*self, t, registerClassVersion<T>()) );
         return *self;
@@ -532,26 +1080,32 @@ namespace cereal
 
       //! Non member split (save_minimal)
       /*! Versioning implementation */
-      template <class T, PROCESS_IF(non_member_versioned_save_minimal)> inline
-      ArchiveType & processImpl(T const & t)
+      template <class T> inline
+      ArchiveType & processImpl(T const & t, PROCESS_KIND(non_member_versioned_minimal))
       {
         self->process( CEREAL_SAVE_MINIMAL_FUNCTION_NAME(*self, t, registerClassVersion<T>()) );
         return *self;
       }
 
-    #undef PROCESS_IF
+    #undef PROCESS_KIND
 
     private:
       ArchiveType * const self;
 
-      //! A set of all base classes that have been serialized
-      std::unordered_set<traits::detail::base_class_id, traits::detail::base_class_id_hash> itsBaseClassSet;
+      //! Virtual base classes serialized as part of the objects currently being serialized
+      std::vector<traits::detail::base_class_id> itsBaseClasses;
+
+      //! Whether the next object processed is a base class of the one being serialized
+      bool itsProcessingBase;
 
       //! Maps from addresses to pointer ids
-      std::unordered_map<void const *, std::uint32_t> itsSharedPointerMap;
+      detail::FlatPointerMap itsSharedPointerMap;
 
       //! The id to be given to the next pointer
-      std::uint32_t itsCurrentPointerId;
+      std::uint64_t itsCurrentPointerId;
+
+      //! The first pointer id of each open tracking scope, innermost last
+      std::vector<std::uint64_t> itsTrackingScopes;
 
       //! Maps from polymorphic type name strings to ids
       std::unordered_map<char const *, std::uint32_t> itsPolymorphicTypeMap;
@@ -559,10 +1113,77 @@ namespace cereal
       //! The id to be given to the next polymorphic type name
       std::uint32_t itsCurrentPolymorphicTypeId;
 
-      //! Keeps track of classes that have versioning information associated with them
-      std::unordered_set<size_type> itsVersionedTypes;
+      //! Maps from interned strings to ids
+      std::unordered_map<std::string, std::uint32_t> itsInternedStringMap;
+
+      //! The id to be given to the next interned string
+      std::uint32_t itsCurrentInternedStringId;
+
+      //! Maps from hashes of deduplicated blobs to their ids
+      std::unordered_multimap<std::uint64_t, std::uint32_t> itsBlobMap;
+
+      //! The contents of deduplicated blobs, indexed by their id - 1
+      std::vector<std::string> itsBlobs;
+
+      //! Keeps track of classes that have versioning information associated with them, by versioned_type_slot
+      std::vector<bool> itsVersionedTypes;
+
+      //! The number of classes set in itsVersionedTypes
+      std::size_t itsVersionedTypeCount;
+
+      //! Whether a schema fingerprint replaces the class versions, see useSchemaFingerprint
+      bool itsElideClassVersions;
+
+      //! The writer of the snapshot being saved, may be null
+      SnapshotWriter<ArchiveType> * itsSnapshotWriter;
+
+      //! Data attached with setUserData
+      detail::UserDataSlots itsUserData;
+
+      //! Counts reported by statistics
+      detail::StatisticsCounter itsStatistics;
+
+      //! Receives every value processed, may be null
+      ArchiveObserver * itsObserver;
   }; // class OutputArchive
 
+  // ######################################################################
+  //! Limits on what an input archive accepts while loading
+  /*! Data from an untrusted source can claim that a container holds billions of
+      elements, making the container allocate room for all of them before the stream
+      is found to be short.  Every size is checked against these limits as soon as it
+      is loaded, before anything is allocated for it, and a size beyond a limit throws
+      an Exception.  Every limit defaults to unlimited.
+
+      @code{.cpp}
+      cereal::LoadLimits limits;
+      limits.maxElements = 1 << 20;
+      limits.maxTotalElements = 1 << 24;
+      limits.maxDepth = 64;
+      archive.setLoadLimits( limits );
+      @endcode
+
+      @ingroup Utility */
+  struct LoadLimits
+  {
+    LoadLimits() :
+      maxElements( (std::numeric_limits<size_type>::max)() ),
+      maxTotalElements( (std::numeric_limits<size_type>::max)() ),
+      maxDepth( (std::numeric_limits<std::size_t>::max)() )
+    { }
+
+    //! The most elements of any one container, or characters of any one string
+    size_type maxElements;
+
+    //! The most elements of all containers and strings loaded since construction or the last reset
+    /*! Since the elements of strings and vectors of arithmetic types are bytes or
+        small values, this also bounds the memory they take in total. */
+    size_type maxTotalElements;
+
+    //! The deepest nesting of classes being loaded, which bounds the recursion of loading
+    std::size_t maxDepth;
+  };
+
   // ######################################################################
   //! The base input archive class
   /*! This is the base input archive for all input archives.  If you create
@@ -588,10 +1209,22 @@ namespace cereal
       /*! @param derived A pointer to the derived ArchiveType (pass this from the derived archive) */
       InputArchive(ArchiveType * const derived) :
         self(derived),
-        itsBaseClassSet(),
+        itsBaseClasses(),
+        itsProcessingBase( false ),
         itsSharedPointerMap(),
-        itsPolymorphicTypeMap(),
-        itsVersionedTypes()
+        itsPolymorphicTypes(),
+        itsInternedStrings(),
+        itsBlobs(),
+        itsVersionedTypes(),
+        itsElideClassVersions( false ),
+        itsMemoryResource( nullptr ),
+        itsSnapshotReader( nullptr ),
+        itsUserData(),
+        itsLoadLimits(),
+        itsTotalElements( 0 ),
+        itsDepth( 0 ),
+        itsStatistics(),
+        itsObserver( nullptr )
       { }
 
       InputArchive & operator=( InputArchive const & ) = delete;
@@ -641,27 +1274,275 @@ namespace cereal
           @param id The unique id that was serialized for the pointer
           @return A shared pointer to the data
           @throw Exception if the id does not exist */
-      inline std::shared_ptr<void> getSharedPointer(std::uint32_t const id)
+      inline std::shared_ptr<void> getSharedPointer(std::uint64_t const id)
       {
         if(id == 0) return std::shared_ptr<void>(nullptr);
 
-        auto iter = itsSharedPointerMap.find( id );
-        if(iter == itsSharedPointerMap.end())
+        if(id > itsSharedPointerMap.size() || !itsSharedPointerMap[id - 1])
           throw Exception("Error while trying to deserialize a smart pointer. Could not find id " + std::to_string(id));
 
-        return iter->second;
+        return itsSharedPointerMap[id - 1];
       }
 
       //! Registers a shared pointer to its unique identifier
       /*! After a shared pointer has been allocated for the first time, it should
-          be registered with its loaded id for future references to it.
+          be registered with its loaded id for future references to it.  Ids are
+          handed out sequentially when saving, so they must be registered in order.
+
+          @param id The unique identifier for the shared pointer, which may have
+                    detail::msb_64bit set
+          @param ptr The actual shared pointer
+          @throw Exception if the id is out of sequence */
+      inline void registerSharedPointer(std::uint64_t const id, std::shared_ptr<void> ptr)
+      {
+        std::uint64_t const stripped_id = id & ~detail::msb_64bit;
+
+        if(stripped_id == 0 || stripped_id > itsSharedPointerMap.size() + 1)
+          throw Exception("Error while trying to deserialize a smart pointer. Id " + std::to_string(stripped_id) + " is out of sequence");
 
-          @param id The unique identifier for the shared pointer
-          @param ptr The actual shared pointer */
-      inline void registerSharedPointer(std::uint32_t const id, std::shared_ptr<void> ptr)
+        if(stripped_id > itsSharedPointerMap.size())
+        {
+          itsSharedPointerMap.push_back( std::move( ptr ) );
+          itsStatistics.sharedPointer();
+        }
+        else
+          itsSharedPointerMap[stripped_id - 1] = std::move( ptr );
+      }
+
+      //! Prepares the archive to track the given number of distinct shared pointers
+      /*! This is purely an optimization for archives loading very large numbers
+          of shared pointers.
+
+          @param count The expected number of distinct shared pointers */
+      inline void reserveSharedPointers( std::size_t count )
       {
-        std::uint32_t const stripped_id = id & ~detail::msb_32bit;
-        itsSharedPointerMap[stripped_id] = ptr;
+        itsSharedPointerMap.reserve( count );
+      }
+
+      //! Sets the memory resource used to allocate objects created while loading
+      /*! This applies to objects owned by std::shared_ptr, including polymorphic
+          ones, and by resource_unique_ptr.  The resource must outlive every such
+          object.  Passing nullptr restores allocation with the global operator new.
+
+          @param resource The resource to allocate from, or nullptr */
+      inline void setMemoryResource( MemoryResource * resource )
+      {
+        itsMemoryResource = resource;
+      }
+
+      //! Gets the memory resource used to allocate objects created while loading
+      /*! @return The resource set by setMemoryResource, or nullptr if there is none */
+      inline MemoryResource * getMemoryResource() const
+      {
+        return itsMemoryResource;
+      }
+
+      //! Attaches the reader of the incremental snapshot being loaded, or nullptr
+      /*! This is done by SnapshotReader::load.
+          @internal */
+      inline void setSnapshot( SnapshotReader<ArchiveType> * reader )
+      {
+        itsSnapshotReader = reader;
+      }
+
+      //! Gets the reader of the incremental snapshot being loaded
+      /*! @return The reader, or nullptr if this is not loading a snapshot
+          @internal */
+      inline SnapshotReader<ArchiveType> * getSnapshotReader() const
+      {
+        return itsSnapshotReader;
+      }
+
+      //! Attaches user data of type T for serialization functions to retrieve with getUserData
+      /*! Unlike UserDataAdapter, this does not change the type of the archive, and
+          retrieving the data costs no dynamic_cast.  Data of different types can be
+          attached side by side; attaching data of a type again replaces it, and passing
+          nullptr detaches it.  The data must outlive its use by the archive, and is
+          kept when the archive is reset.
+
+          @code{.cpp}
+          template <class Archive>
+          static void load_and_construct( Archive & ar, cereal::construct<MyType> & construct )
+          {
+            int x;
+            ar( x );
+            construct( x, ar.template getUserData<MyContext>() );
+          }
+          @endcode
+
+          @param data The data to attach, or nullptr */
+      template <class T> inline
+      void setUserData( T * data )
+      {
+        itsUserData.set( data );
+      }
+
+      //! Gets user data of type T attached with setUserData
+      /*! @return The data, or nullptr if none of this type is attached */
+      template <class T> inline
+      T * getUserData() const
+      {
+        return itsUserData.template get<T>();
+      }
+
+      //! Gives an archive that loads part of this one's data the same settings
+      /*! The nested archive gets the memory resource, user data and load limits of this
+          one.  Its limits on depth and on elements in total are reduced by what this
+          archive has used so far, and what it loads is charged back with chargeNested.
+          This is used where data is loaded by archives of its own that are embedded in
+          this one, such as the chunks of cereal::parallel.
+          @internal */
+      inline void configureNested( ArchiveType & nested ) const
+      {
+        auto & base = static_cast<InputArchive &>( nested );
+        base.itsMemoryResource = itsMemoryResource;
+        base.itsUserData = itsUserData;
+        base.itsLoadLimits = itsLoadLimits;
+        base.itsLoadLimits.maxDepth = itsLoadLimits.maxDepth - (std::min)( itsDepth, itsLoadLimits.maxDepth );
+        base.itsLoadLimits.maxTotalElements = itsLoadLimits.maxTotalElements - itsTotalElements;
+      }
+
+      //! Counts the elements loaded by an archive set up with configureNested against this one's limits
+      /*! @throws Exception if they exceed LoadLimits::maxTotalElements
+          @internal */
+      inline void chargeNested( ArchiveType const & nested )
+      {
+        auto const used = static_cast<InputArchive const &>( nested ).itsTotalElements;
+        if( used > itsLoadLimits.maxTotalElements - itsTotalElements )
+          throw Exception("Loading exceeds the limit of " + std::to_string(itsLoadLimits.maxTotalElements) + " elements in total");
+        itsTotalElements += used;
+      }
+
+      //! Counts of the work done by the archive since it was constructed or reset
+      /*! These are only collected when CEREAL_ARCHIVE_STATISTICS or CEREAL_TRACE_POLICY
+          is defined, and are all zero otherwise.  Bytes and calls to %sBinary are only counted by binary archives. */
+      inline ArchiveStatistics const & statistics() const
+      {
+        return itsStatistics.get();
+      }
+
+      //! Gives archives and serialization functions access to the counters of statistics
+      /*! @internal */
+      inline detail::StatisticsCounter & statisticsCounter()
+      {
+        return itsStatistics;
+      }
+
+      //! Attaches an observer that is told about every value the archive serializes
+      /*! Observing costs a branch per value while no observer is attached.  The observer
+          must outlive its use by the archive, and is kept when the archive is reset.
+          @param observer The observer, or nullptr to detach it */
+      inline void setObserver( ArchiveObserver * observer )
+      {
+        itsObserver = observer;
+      }
+
+      //! Sets the limits checked while loading
+      /*! The limits stay in place across resets.  See LoadLimits. */
+      inline void setLoadLimits( LoadLimits const & limits )
+      {
+        itsLoadLimits = limits;
+      }
+
+      //! Gets the limits checked while loading
+      inline LoadLimits const & getLoadLimits() const
+      {
+        return itsLoadLimits;
+      }
+
+      //! Checks a number of elements against the limits, before anything is allocated for them
+      /*! Sizes loaded through make_size_tag are checked automatically.  Serialization
+          functions that load an element count some other way, such as a named value,
+          call this before allocating for it.  The elements count towards
+          LoadLimits::maxTotalElements.
+          @throws Exception if the size exceeds the limits */
+      inline void checkLoadSize( size_type size )
+      {
+        if( size > itsLoadLimits.maxElements )
+          throw Exception("Size of " + std::to_string(size) + " exceeds the limit of " +
+                          std::to_string(itsLoadLimits.maxElements) + " elements");
+
+        if( size > itsLoadLimits.maxTotalElements - itsTotalElements )
+          throw Exception("Size of " + std::to_string(size) + " exceeds the limit of " +
+                          std::to_string(itsLoadLimits.maxTotalElements) + " elements in total");
+
+        itsTotalElements += size;
+      }
+
+      //! Forgets everything the archive has tracked so far
+      /*! Shared pointers, polymorphic type names, interned strings, deduplicated blobs,
+          base classes, and class versions are cleared, so the archive can load data saved by a new or reset output
+          archive.  The count of elements checked against LoadLimits::maxTotalElements
+          starts over.  Memory allocated for tracking is kept for reuse, and the memory
+          resource and load limits are left in place.  An archive that threw while loading
+          should be reset before it is used again.
+
+          Archives that read from a stream provide a reset taking the new stream,
+          which should be preferred over calling this directly. */
+      inline void reset()
+      {
+        itsBaseClasses.clear();
+        itsProcessingBase = false;
+        itsSharedPointerMap.clear();
+        itsTrackingScopes.clear();
+        itsPolymorphicTypes.clear();
+        itsInternedStrings.clear();
+        itsBlobs.clear();
+        itsVersionedTypes.clear();
+        itsElideClassVersions = false;
+        itsTotalElements = 0;
+        itsDepth = 0;
+        itsStatistics.reset();
+      }
+
+      //! Forgets tracked shared pointers and base classes, keeping type information
+      /*! This mirrors OutputArchive::resetPointers, and must be called at the same points
+          in the data as it was while saving. */
+      inline void resetPointers()
+      {
+        itsBaseClasses.clear();
+        itsProcessingBase = false;
+        itsSharedPointerMap.clear();
+        itsTrackingScopes.clear();
+      }
+
+      //! Starts a region of the data whose shared pointers are forgotten when it ends
+      /*! This mirrors OutputArchive::beginTrackingScope, and must be called at the same
+          points in the data as it was while saving.  When the scope ends, the archive
+          releases its references to the objects loaded through shared pointers within
+          it, so they are freed once nothing else refers to them. */
+      inline void beginTrackingScope()
+      {
+        itsTrackingScopes.push_back( itsSharedPointerMap.size() );
+      }
+
+      //! Reads a schema fingerprint, after which no class version is read
+      /*! This mirrors OutputArchive::useSchemaFingerprint, and must be called at the same
+          point in the data as it was while saving.  Versions are then taken from the
+          CEREAL_CLASS_VERSION declarations of this build.
+
+          @throws Exception if the fingerprint does not match that of this build, which covers
+                  every versioned type linked into it, since the data does not carry the
+                  versions it was saved with */
+      inline void useSchemaFingerprint()
+      {
+        std::uint64_t fingerprint;
+        process( make_nvp<ArchiveType>("cereal_schema_fingerprint", fingerprint) );
+        if( fingerprint != detail::StaticObject<detail::Versions>::getInstance().getFingerprint() )
+          throw Exception("The schema fingerprint of the archive does not match the class versions registered in this program");
+        itsElideClassVersions = true;
+      }
+
+      //! Ends the innermost tracking scope, forgetting the shared pointers first loaded within it
+      /*! @throws Exception if no tracking scope has begun */
+      inline void endTrackingScope()
+      {
+        if( itsTrackingScopes.empty() )
+          throw Exception("endTrackingScope was called without a matching beginTrackingScope");
+
+        auto const first = itsTrackingScopes.back();
+        itsTrackingScopes.pop_back();
+        itsSharedPointerMap.erase( itsSharedPointerMap.begin() + static_cast<std::ptrdiff_t>( first ), itsSharedPointerMap.end() );
       }
 
       //! Retrieves the string for a polymorphic type given a unique key for it
@@ -670,55 +1551,247 @@ namespace cereal
 
           @param id The unique id that was serialized for the polymorphic type
           @return The string identifier for the tyep */
-      inline std::string getPolymorphicName(std::uint32_t const id)
+      inline std::string const & getPolymorphicName(std::uint32_t const id) const
       {
-        auto name = itsPolymorphicTypeMap.find( id );
-        if(name == itsPolymorphicTypeMap.end())
-        {
-          throw Exception("Error while trying to deserialize a polymorphic pointer. Could not find type id " + std::to_string(id));
-        }
-        return name->second;
+        return getPolymorphicType( id ).first;
+      }
+
+      //! Retrieves the binding resolved for a polymorphic type given a unique key for it
+      /*! This lets repeated pointers of a type skip looking up its name in the
+          binding map.  The binding is stored untyped, since its type depends on the
+          polymorphic machinery, which this archive knows nothing about.
+
+          @internal
+          @param id The unique id that was serialized for the polymorphic type
+          @return The binding registered along with the name of the type */
+      inline void const * getPolymorphicBinding(std::uint32_t const id) const
+      {
+        return getPolymorphicType( id ).second;
       }
 
       //! Registers a polymorphic name string to its unique identifier
       /*! After a polymorphic type has been loaded for the first time, it should
-          be registered with its loaded id for future references to it.
+          be registered with its loaded id for future references to it.  Ids are
+          handed out in order when saving, so each new type must have the next id.
 
           @param id The unique identifier for the polymorphic type
-          @param name The name associated with the tyep */
-      inline void registerPolymorphicName(std::uint32_t const id, std::string const & name)
+          @param name The name associated with the tyep
+          @param binding The binding resolved for the type, which must outlive the archive */
+      inline void registerPolymorphicName(std::uint32_t const id, std::string const & name, void const * binding)
+      {
+        std::uint32_t const stripped_id = id & ~detail::msb_32bit;
+        if( stripped_id != itsPolymorphicTypes.size() + 1 )
+          throw Exception("Error while trying to deserialize a polymorphic pointer. Unexpected type id " + std::to_string(stripped_id));
+
+        itsPolymorphicTypes.emplace_back( name, binding );
+      }
+
+      //! Retrieves a string loaded through cereal::interned given its id
+      /*! @internal
+          @param id The id that was serialized for the string
+          @return The string previously registered with that id */
+      inline std::string const & getInternedString( std::uint32_t const id ) const
+      {
+        if( id == 0 || id > itsInternedStrings.size() )
+          throw Exception("Error while trying to deserialize an interned string. Could not find string id " + std::to_string(id));
+
+        return itsInternedStrings[id - 1];
+      }
+
+      //! Registers a string loaded through cereal::interned for later references to it
+      /*! Ids are handed out in order when saving, so each new string must have
+          the next id.
+
+          @internal
+          @param id The id that was serialized for the string, with its MSB set
+          @param str The string to associate with the id */
+      inline void registerInternedString( std::uint32_t const id, std::string const & str )
       {
         std::uint32_t const stripped_id = id & ~detail::msb_32bit;
-        itsPolymorphicTypeMap.insert( {stripped_id, name} );
+        if( stripped_id != itsInternedStrings.size() + 1 )
+          throw Exception("Error while trying to deserialize an interned string. Unexpected string id " + std::to_string(stripped_id));
+
+        itsInternedStrings.push_back( str );
+      }
+
+      //! Retrieves the bytes of a block loaded through cereal::deduplicated given its id
+      /*! @internal
+          @param id The id that was serialized for the block
+          @return The bytes previously registered with that id */
+      inline std::string const & getDeduplicatedBlob( std::uint32_t const id ) const
+      {
+        if( id == 0 || id > itsBlobs.size() )
+          throw Exception("Error while trying to deserialize a deduplicated blob. Could not find blob id " + std::to_string(id));
+
+        return itsBlobs[id - 1];
+      }
+
+      //! Registers a block loaded through cereal::deduplicated for later references to it
+      /*! @internal
+          @param id The id that was serialized for the block, with its MSB set
+          @param data The bytes of the block
+          @param size The number of bytes in the block */
+      inline void registerDeduplicatedBlob( std::uint32_t const id, void const * data, std::size_t size )
+      {
+        std::uint32_t const stripped_id = id & ~detail::msb_32bit;
+        if( stripped_id != itsBlobs.size() + 1 )
+          throw Exception("Error while trying to deserialize a deduplicated blob. Unexpected blob id " + std::to_string(stripped_id));
+
+        itsBlobs.emplace_back( static_cast<char const *>( data ), size );
       }
 
     private:
-      //! Serializes data after calling prologue, then calls epilogue
+      template <class A, class T> friend void detail::process_extern( A &, T & );
+
+      //! Retrieves the name and binding registered for a polymorphic type id
+      inline std::pair<std::string, void const *> const & getPolymorphicType(std::uint32_t const id) const
+      {
+        if( id == 0 || id > itsPolymorphicTypes.size() )
+          throw Exception("Error while trying to deserialize a polymorphic pointer. Could not find type id " + std::to_string(id));
+
+        return itsPolymorphicTypes[id - 1];
+      }
+
+      //! Serializes data, in another translation unit if it is declared extern
       template <class T> inline
       void process( T && head )
+      {
+        // Only classes can nest, so nothing is counted for arithmetic types
+        static const bool nests = std::is_class<typename std::decay<T>::type>::value;
+        if( nests && ++itsDepth > itsLoadLimits.maxDepth )
+          throw Exception("Nesting exceeds the limit of " + std::to_string(itsLoadLimits.maxDepth) + " levels");
+        if( nests )
+          itsStatistics.enter();
+        if( itsObserver )
+          observeEnter( head );
+        detail::TraceScope<typename std::decay<T>::type> const trace( itsStatistics );
+
+        processLocal( traits::has_extern_serialization<ArchiveType, typename std::decay<T>::type>(), head );
+
+        if( itsObserver )
+          itsObserver->leave();
+        if( nests )
+        {
+          --itsDepth;
+          itsStatistics.leave();
+        }
+      }
+
+      //! Tells the observer about a value
+      template <class T> inline
+      void observeEnter( T const & head )
+      {
+        typedef detail::observed<typename std::decay<T>::type> Observed;
+        itsObserver->enter( Observed::name( head ), typeid(typename Observed::type), Observed::wrapper );
+      }
+
+      //! Serializes a type declared with CEREAL_EXTERN_SERIALIZATION
+      template <class T> inline
+      void processLocal( std::true_type, T & head )
+      {
+        detail::process_extern( *self, head );
+      }
+
+      //! Serializes data after calling prologue, then calls epilogue
+      template <class T> inline
+      void processLocal( std::false_type, T & head )
       {
         prologue( *self, head );
         self->processImpl( head );
+        checkLoadLimits( head );
         epilogue( *self, head );
       }
 
+      //! Nothing to check for anything but sizes
+      template <class T> inline
+      void checkLoadLimits( T const & )
+      { }
+
+      //! Checks a loaded size against the limits, before anything is allocated for it
+      template <class T> inline
+      void checkLoadLimits( SizeTag<T> const & tag )
+      {
+        checkLoadSize( static_cast<size_type>( tag.size ) );
+      }
+
+      //! Whether the leading arithmetic values of a call are packed together
+      template <class ... Types>
+      using coalesce = std::integral_constant<bool, (Flags & CoalesceArithmetic) && !detail::counts_values &&
+                                                    traits::detail::arithmetic_run<Types...>::count >= 2>;
+
       //! Unwinds to process all data
       template <class T, class ... Other> inline
       void process( T && head, Other && ... tail )
+      {
+        processRun( coalesce<T, Other...>(), std::forward<T>( head ), std::forward<Other>( tail )... );
+      }
+
+      //! Processes the head on its own
+      template <class T, class ... Other> inline
+      void processRun( std::false_type, T && head, Other && ... tail )
       {
         process( std::forward<T>( head ) );
         process( std::forward<Other>( tail )... );
       }
 
+      //! Loads the leading arithmetic values at once, then unpacks them
+      /*! With sticky errors, a failed read zeroes every value of the run.  An attached
+          observer sees each value on its own instead. */
+      template <class ... Types> inline
+      void processRun( std::true_type, Types && ... args )
+      {
+        if( itsObserver )
+          return processRun( std::false_type(), std::forward<Types>( args )... );
+
+        using run = traits::detail::arithmetic_run<Types...>;
+        char buffer[run::size];
+        self->loadBinary( buffer, run::size );
+        loadRun<run::count>( buffer, std::forward<Types>( args )... );
+      }
+
+      //! Unpacks N more values of a run
+      template <std::size_t N, class ... Types> inline
+      void loadRun( char const * position, Types && ... args )
+      {
+        loadRun<N>( std::integral_constant<bool, N == 0>(), position, std::forward<Types>( args )... );
+      }
+
+      //! Processes whatever follows an unpacked run
+      template <std::size_t N, class ... Types> inline
+      void loadRun( std::true_type, char const *, Types && ... rest )
+      {
+        processRest( std::forward<Types>( rest )... );
+      }
+
+      //! Unpacks the next value of a run
+      template <std::size_t N, class T, class ... Other> inline
+      void loadRun( std::false_type, char const * position, T && head, Other && ... tail )
+      {
+        std::memcpy( std::addressof( head ), position, sizeof( head ) );
+        loadRun<N - 1>( position + sizeof( head ), std::forward<Other>( tail )... );
+      }
+
+      //! Nothing follows a run
+      void processRest()
+      { }
+
+      //! Processes whatever follows a run
+      template <class ... Types> inline
+      void processRest( Types && ... args )
+      {
+        process( std::forward<Types>( args )... );
+      }
+
       //! Serialization of a virtual_base_class wrapper
       /*! \sa virtual_base_class */
       template <class T> inline
       ArchiveType & processImpl(virtual_base_class<T> & b)
       {
         traits::detail::base_class_id id(b.base_ptr);
-        if(itsBaseClassSet.count(id) == 0)
+        if(std::find(itsBaseClasses.begin(), itsBaseClasses.end(), id) == itsBaseClasses.end())
         {
-          itsBaseClassSet.insert(id);
+          itsBaseClasses.push_back(id);
+          itsProcessingBase = true;
           self->processImpl( *b.base_ptr );
         }
         return *self;
@@ -729,59 +1802,83 @@ namespace cereal
       template <class T> inline
       ArchiveType & processImpl(base_class<T> & b)
       {
+        itsProcessingBase = true;
         self->processImpl( *b.base_ptr );
         return *self;
       }
 
-      //! Helper macro that expands the requirements for activating an overload
-      /*! Requirements:
-            Has the requested serialization function
-            Does not have version and unversioned at the same time
-            Is input serializable AND
-              is specialized for this type of function OR
-              has no specialization at all */
-      #define PROCESS_IF(name)                                                              \
-      traits::EnableIf<traits::has_##name<T, ArchiveType>::value,                           \
-                       !traits::has_invalid_input_versioning<T, ArchiveType>::value,        \
-                       (traits::is_input_serializable<T, ArchiveType>::value &&             \
-                        (traits::is_specialized_##name<T, ArchiveType>::value ||            \
-                         !traits::is_specialized<T, ArchiveType>::value))> = traits::sfinae
+      //! Serializes with the functions chosen for T by traits::input_kind
+      template <class T> inline
+      ArchiveType & processImpl(T & t)
+      {
+        return processObject( t, std::is_class<T>() );
+      }
+
+      //! Serializes an object that may have virtual base classes
+      /*! Virtual base classes are only tracked while the most derived object they are
+          part of is serialized, which keeps the tracking as small as the nesting of
+          objects.  A base class is serialized as part of the object deriving from it,
+          so it leaves the tracking in place. */
+      template <class T> inline
+      ArchiveType & processObject(T & t, std::true_type /* is_class */)
+      {
+        bool const isBase = itsProcessingBase;
+        itsProcessingBase = false;
+
+        if( isBase )
+          return self->processImpl( t, typename traits::input_kind<T, ArchiveType, (Flags & AllowEmptyClassElision) != 0>::type() );
+
+        auto const tracked = itsBaseClasses.size();
+        self->processImpl( t, typename traits::input_kind<T, ArchiveType, (Flags & AllowEmptyClassElision) != 0>::type() );
+        itsBaseClasses.erase( itsBaseClasses.begin() + static_cast<std::ptrdiff_t>( tracked ), itsBaseClasses.end() );
+        return *self;
+      }
+
+      //! Serializes a value that cannot have base classes
+      template <class T> inline
+      ArchiveType & processObject(T & t, std::false_type /* is_class */)
+      {
+        return self->processImpl( t, typename traits::input_kind<T, ArchiveType, (Flags & AllowEmptyClassElision) != 0>::type() );
+      }
+
+      //! Helper macro that names the tag for a kind of serialization function
+      #define PROCESS_KIND(name) std::integral_constant<traits::serialization_kind, traits::serialization_kind::name>
 
       //! Member serialization
-      template <class T, PROCESS_IF(member_serialize)> inline
-      ArchiveType & processImpl(T & t)
+      template <class T> inline
+      ArchiveType & processImpl(T & t, PROCESS_KIND(member_serialize))
       {
         access::member_serialize(*self, t);
         return *self;
       }
 
       //! Non member serialization
-      template <class T, PROCESS_IF(non_member_serialize)> inline
-      ArchiveType & processImpl(T & t)
+      template <class T> inline
+      ArchiveType & processImpl(T & t, PROCESS_KIND(non_member_serialize))
       {
         CEREAL_SERIALIZE_FUNCTION_NAME(*self, t);
         return *self;
       }
 
       //! Member split (load)
-      template <class T, PROCESS_IF(member_load)> inline
-      ArchiveType & processImpl(T & t)
+      template <class T> inline
+      ArchiveType & processImpl(T & t, PROCESS_KIND(member_split))
       {
         access::member_load(*self, t);
         return *self;
       }
 
       //! Non member split (load)
-      template <class T, PROCESS_IF(non_member_load)> inline
-      ArchiveType & processImpl(T & t)
+      template <class T> inline
+      ArchiveType & processImpl(T & t, PROCESS_KIND(non_member_split))
       {
         CEREAL_LOAD_FUNCTION_NAME(*self, t);
         return *self;
       }
 
       //! Member split (load_minimal)
-      template <class T, PROCESS_IF(member_load_minimal)> inline
-      ArchiveType & processImpl(T & t)
+      template <class T> inline
+      ArchiveType & processImpl(T & t, PROCESS_KIND(member_minimal))
       {
         using OutArchiveType = typename traits::detail::get_output_from_input<ArchiveType>::type;
         typename traits::has_member_save_minimal<T, OutArchiveType>::type value;
@@ -791,8 +1888,8 @@ namespace cereal
       }
 
       //! Non member split (load_minimal)
-      template <class T, PROCESS_IF(non_member_load_minimal)> inline
-      ArchiveType & processImpl(T & t)
+      template <class T> inline
+      ArchiveType & processImpl(T & t, PROCESS_KIND(non_member_minimal))
       {
         using OutArchiveType = typename traits::detail::get_output_from_input<ArchiveType>::type;
         typename traits::has_non_member_save_minimal<T, OutArchiveType>::type value;
@@ -802,10 +1899,8 @@ namespace cereal
       }
 
       //! Empty class specialization
-      template <class T, traits::EnableIf<(Flags & AllowEmptyClassElision),
-                                          !traits::is_input_serializable<T, ArchiveType>::value,
-                                          std::is_empty<T>::value> = traits::sfinae> inline
-      ArchiveType & processImpl(T const &)
+      template <class T> inline
+      ArchiveType & processImpl(T const &, PROCESS_KIND(empty))
       {
         return *self;
       }
@@ -814,10 +1909,8 @@ namespace cereal
       /*! Invalid if we have invalid input versioning or
           we are not input serializable, and either
           don't allow empty class ellision or allow it but are not serializing an empty class */
-      template <class T, traits::EnableIf<traits::has_invalid_input_versioning<T, ArchiveType>::value ||
-                                          (!traits::is_input_serializable<T, ArchiveType>::value &&
-                                           (!(Flags & AllowEmptyClassElision) || ((Flags & AllowEmptyClassElision) && !std::is_empty<T>::value)))> = traits::sfinae> inline
-      ArchiveType & processImpl(T const &)
+      template <class T> inline
+      ArchiveType & processImpl(T const &, PROCESS_KIND(invalid))
       {
         static_assert(traits::detail::count_input_serializers<T, ArchiveType>::value != 0,
             "cereal could not find any input serialization functions for the provided type and archive combination. \n\n "
@@ -848,17 +1941,27 @@ namespace cereal
       template <class T> inline
       std::uint32_t loadClassVersion()
       {
-        static const auto hash = std::type_index(typeid(T)).hash_code();
-        auto lookupResult = itsVersionedTypes.find( hash );
+        if( itsElideClassVersions )
+        {
+          static const auto version = detail::StaticObject<detail::Versions>::getInstance().find(
+            std::type_index(typeid(T)).hash_code(), detail::Version<T>::version );
+          return version;
+        }
+
+        const auto slot = detail::versioned_type_slot<T>();
 
-        if( lookupResult != itsVersionedTypes.end() ) // already exists
-          return lookupResult->second;
+        if( slot < itsVersionedTypes.size() && itsVersionedTypes[slot] >= 0 ) // already exists
+          return static_cast<std::uint32_t>( itsVersionedTypes[slot] );
         else // need to load
         {
           std::uint32_t version;
 
           process( make_nvp<ArchiveType>("cereal_class_version", version) );
-          itsVersionedTypes.emplace_hint( lookupResult, hash, version );
+
+          if( slot >= itsVersionedTypes.size() )
+            itsVersionedTypes.resize( slot + 1, -1 );
+          itsVersionedTypes[slot] = version;
+          itsStatistics.versionedType();
 
           return version;
         }
@@ -866,8 +1969,8 @@ namespace cereal
 
       //! Member serialization
       /*! Versioning implementation */
-      template <class T, PROCESS_IF(member_versioned_serialize)> inline
-      ArchiveType & processImpl(T & t)
+      template <class T> inline
+      ArchiveType & processImpl(T & t, PROCESS_KIND(member_versioned_serialize))
       {
         const auto version = loadClassVersion<T>();
         access::member_serialize(*self, t, version);
@@ -876,8 +1979,8 @@ namespace cereal
 
       //! Non member serialization
       /*! Versioning implementation */
-      template <class T, PROCESS_IF(non_member_versioned_serialize)> inline
-      ArchiveType & processImpl(T & t)
+      template <class T> inline
+      ArchiveType & processImpl(T & t, PROCESS_KIND(non_member_versioned_serialize))
       {
         const auto version = loadClassVersion<T>();
         CEREAL_SERIALIZE_FUNCTION_NAME(*self, t, version);
@@ -886,8 +1989,8 @@ namespace cereal
 
       //! Member split (load)
       /*! Versioning implementation */
-      template <class T, PROCESS_IF(member_versioned_load)> inline
-      ArchiveType & processImpl(T & t)
+      template <class T> inline
+      ArchiveType & processImpl(T & t, PROCESS_KIND(member_versioned_split))
       {
         const auto version = loadClassVersion<T>();
         access::member_load(*self, t, version);
@@ -896,8 +1999,8 @@ namespace cereal
 
       //! Non member split (load)
       /*! Versioning implementation */
-      template <class T, PROCESS_IF(non_member_versioned_load)> inline
-      ArchiveType & processImpl(T & t)
+      template <class T> inline
+      ArchiveType & processImpl(T & t, PROCESS_KIND(non_member_versioned_split))
       {
         const auto version = loadClassVersion<T>();
         CEREAL_LOAD_FUNCTION_NAME(*self, t, version);
@@ -906,8 +2009,8 @@ namespace cereal
 
       //! Member split (load_minimal)
       /*! Versioning implementation */
-      template <class T, PROCESS_IF(member_versioned_load_minimal)> inline
-      ArchiveType & processImpl(T & t)
+      template <class T> inline
+      ArchiveType & processImpl(T & t, PROCESS_KIND(member_versioned_minimal))
       {
         using OutArchiveType = typename traits::detail::get_output_from_input<ArchiveType>::type;
         const auto version = loadClassVersion<T>();
@@ -919,8 +2022,8 @@ namespace cereal
 
       //! Non member split (load_minimal)
       /*! Versioning implementation */
-      template <class T, PROCESS_IF(non_member_versioned_load_minimal)> inline
-      ArchiveType & processImpl(T & t)
+      template <class T> inline
+      ArchiveType & processImpl(T & t, PROCESS_KIND(non_member_versioned_minimal))
       {
         using OutArchiveType = typename traits::detail::get_output_from_input<ArchiveType>::type;
         const auto version = loadClassVersion<T>();
@@ -930,23 +2033,71 @@ namespace cereal
         return *self;
       }
 
-      #undef PROCESS_IF
+      #undef PROCESS_KIND
 
     private:
       ArchiveType * const self;
 
-      //! A set of all base classes that have been serialized
-      std::unordered_set<traits::detail::base_class_id, traits::detail::base_class_id_hash> itsBaseClassSet;
+      //! Virtual base classes serialized as part of the objects currently being serialized
+      std::vector<traits::detail::base_class_id> itsBaseClasses;
+
+      //! Whether the next object processed is a base class of the one being serialized
+      bool itsProcessingBase;
+
+      //! Loaded shared pointers, indexed by their id - 1
+      std::vector<std::shared_ptr<void>> itsSharedPointerMap;
+
+      //! The number of loaded shared pointers when each open tracking scope began, innermost last
+      std::vector<std::size_t> itsTrackingScopes;
 
-      //! Maps from pointer ids to metadata
-      std::unordered_map<std::uint32_t, std::shared_ptr<void>> itsSharedPointerMap;
+      //! Loaded polymorphic type names and their bindings, indexed by their id - 1
+      std::vector<std::pair<std::string, void const *>> itsPolymorphicTypes;
 
-      //! Maps from name ids to names
-      std::unordered_map<std::uint32_t, std::string> itsPolymorphicTypeMap;
+      //! Loaded interned strings, indexed by their id - 1
+      std::vector<std::string> itsInternedStrings;
 
-      //! Maps from type hash codes to version numbers
-      std::unordered_map<std::size_t, std::uint32_t> itsVersionedTypes;
+      //! Loaded deduplicated blobs, indexed by their id - 1
+      std::vector<std::string> itsBlobs;
+
+      //! Loaded version numbers indexed by versioned_type_slot, -1 if not yet loaded
+      std::vector<std::int64_t> itsVersionedTypes;
+
+      //! Whether a schema fingerprint replaces the class versions, see useSchemaFingerprint
+      bool itsElideClassVersions;
+
+      //! Where objects created while loading are allocated, may be null
+      MemoryResource * itsMemoryResource;
+
+      //! The reader of the snapshot being loaded, may be null
+      SnapshotReader<ArchiveType> * itsSnapshotReader;
+
+      //! Data attached with setUserData
+      detail::UserDataSlots itsUserData;
+
+      //! Limits checked while loading
+      LoadLimits itsLoadLimits;
+
+      //! Elements of all containers loaded so far, checked against LoadLimits::maxTotalElements
+      size_type itsTotalElements;
+
+      //! The nesting of classes being loaded
+      std::size_t itsDepth;
+
+      //! Counts reported by statistics
+      detail::StatisticsCounter itsStatistics;
+
+      //! Receives every value processed, may be null
+      ArchiveObserver * itsObserver;
   }; // class InputArchive
+
+  namespace detail
+  {
+    template <class Archive, class T>
+    void process_extern( Archive & ar, T & t )
+    {
+      ar.processLocal( std::false_type(), t );
+    }
+  }
 } // namespace cereal
 
 // This include needs to come after things such as binary_data, make_nvp, etc
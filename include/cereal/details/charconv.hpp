@@ -0,0 +1,213 @@
+/*! \file charconv.hpp
+    \brief Conversions between arithmetic values and text used internally by text archives
+    \ingroup Internal */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_CHARCONV_HPP_
+#define CEREAL_DETAILS_CHARCONV_HPP_
+
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if defined(__has_include)
+  #if __has_include(<charconv>) && __cplusplus >= 201703L
+    #include <charconv>
+  #endif
+#endif
+
+// std::to_chars and std::from_chars for floating point need library support beyond C++17 itself
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  #define CEREAL_HAS_FLOAT_CHARCONV 1
+#else
+  #define CEREAL_HAS_FLOAT_CHARCONV 0
+#endif
+
+namespace cereal
+{
+  namespace charconv_detail
+  {
+    //! Enough room for any value written by toChars, including its terminating null
+    static const std::size_t bufferSize = 128;
+
+    //! The largest precision honored for floating point, keeping output within bufferSize
+    static const int maxPrecision = 100;
+
+    //! Whether an integer is below zero, without comparing unsigned types against zero
+    template <class T> inline bool isNegative( T value, std::true_type )  { return value < 0; }
+    template <class T> inline bool isNegative( T, std::false_type )       { return false; }
+
+    // ######################################################################
+    //! Writes an integer in decimal, followed by a null
+    /*! @param buffer Storage of at least bufferSize characters
+        @return The number of characters written, not counting the null */
+    template <class T, typename std::enable_if<std::is_integral<T>::value, bool>::type = true> inline
+    std::size_t toChars( char * buffer, T value )
+    {
+      typedef typename std::make_unsigned<T>::type U;
+
+      // negate in the unsigned type, which is well defined for the minimum value
+      bool const negative = isNegative( value, std::is_signed<T>() );
+      U magnitude = negative ? static_cast<U>( U(0) - static_cast<U>( value ) ) : static_cast<U>( value );
+
+      char digits[std::numeric_limits<U>::digits10 + 1];
+      std::size_t count = 0;
+      do
+      {
+        digits[count++] = static_cast<char>( '0' + magnitude % 10 );
+        magnitude = static_cast<U>( magnitude / 10 );
+      } while( magnitude );
+
+      std::size_t size = 0;
+      if( negative )
+        buffer[size++] = '-';
+      while( count )
+        buffer[size++] = digits[--count];
+      buffer[size] = '\0';
+      return size;
+    }
+
+    //! printf formats for each floating point type
+    inline char const * printfFormat( float )       { return "%.*g"; }
+    inline char const * printfFormat( double )      { return "%.*g"; }
+    inline char const * printfFormat( long double ) { return "%.*Lg"; }
+
+    //! Promotes a float for printf, which takes floats as doubles
+    inline double printfValue( float value ) { return value; }
+    inline double printfValue( double value ) { return value; }
+    inline long double printfValue( long double value ) { return value; }
+
+    //! Writes a floating point number with the given precision, followed by a null
+    /*! With a precision that can represent every value of T exactly, the
+        shortest text that reads back as the same value is written when the
+        standard library provides floating point std::to_chars.  Otherwise the
+        output matches an iostream using the same precision.
+
+        @param buffer Storage of at least bufferSize characters
+        @return The number of characters written, not counting the null */
+    template <class T, typename std::enable_if<std::is_floating_point<T>::value, bool>::type = true> inline
+    std::size_t toChars( char * buffer, T value, int precision = std::numeric_limits<T>::max_digits10 )
+    {
+      #if CEREAL_HAS_FLOAT_CHARCONV
+      if( precision >= std::numeric_limits<T>::max_digits10 && std::isfinite( value ) )
+      {
+        auto const result = std::to_chars( buffer, buffer + bufferSize - 1, value );
+        if( result.ec == std::errc() )
+        {
+          *result.ptr = '\0';
+          return static_cast<std::size_t>( result.ptr - buffer );
+        }
+      }
+      #endif // CEREAL_HAS_FLOAT_CHARCONV
+
+      if( precision > maxPrecision )
+        precision = maxPrecision;
+
+      auto const size = std::snprintf( buffer, bufferSize, printfFormat( value ), precision, printfValue( value ) );
+      return size < 0 ? 0 : static_cast<std::size_t>( size );
+    }
+
+    // ######################################################################
+    //! strtoX for each arithmetic type, converting through the widest type of its kind
+    inline long long strtoValue( char const * str, char ** end, long long )                  { return std::strtoll( str, end, 10 ); }
+    inline unsigned long long strtoValue( char const * str, char ** end, unsigned long long ) { return std::strtoull( str, end, 10 ); }
+    inline float strtoValue( char const * str, char ** end, float )                           { return std::strtof( str, end ); }
+    inline double strtoValue( char const * str, char ** end, double )                         { return std::strtod( str, end ); }
+    inline long double strtoValue( char const * str, char ** end, long double )               { return std::strtold( str, end ); }
+
+    //! Whether a value read as long long fits in T
+    template <class T> inline
+    bool fitsIn( long long value )
+    {
+      return value >= static_cast<long long>( std::numeric_limits<T>::min() ) &&
+             value <= static_cast<long long>( std::numeric_limits<T>::max() );
+    }
+
+    //! Whether a value read as unsigned long long fits in T
+    template <class T> inline
+    bool fitsIn( unsigned long long value )
+    {
+      return value <= static_cast<unsigned long long>( std::numeric_limits<T>::max() );
+    }
+
+    //! Reads an integer from the start of a null terminated string
+    /*! Leading whitespace is skipped and trailing characters are ignored, as with std::stoll.
+        @throws std::invalid_argument if no number is found
+        @throws std::out_of_range if the number does not fit in T */
+    template <class T, typename std::enable_if<std::is_integral<T>::value, bool>::type = true> inline
+    T fromChars( char const * str )
+    {
+      typedef typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type Wide;
+
+      char * end;
+      errno = 0;
+      auto const value = strtoValue( str, &end, Wide() );
+      if( end == str )
+        throw std::invalid_argument( "cereal: no number to convert" );
+      if( errno == ERANGE || !fitsIn<T>( value ) )
+        throw std::out_of_range( "cereal: number out of range" );
+
+      return static_cast<T>( value );
+    }
+
+    //! Reads a floating point number from the start of a null terminated string
+    /*! Leading whitespace is skipped and trailing characters are ignored, as with std::stod.
+        Subnormal values are accepted even though they set ERANGE.
+        @throws std::invalid_argument if no number is found
+        @throws std::out_of_range if the number does not fit in T */
+    template <class T, typename std::enable_if<std::is_floating_point<T>::value, bool>::type = true> inline
+    T fromChars( char const * str )
+    {
+      T value;
+
+      #if CEREAL_HAS_FLOAT_CHARCONV
+      // the common case of plain numbers, anything else goes through strtoX
+      auto const result = std::from_chars( str, str + std::char_traits<char>::length( str ), value );
+      if( result.ec == std::errc() )
+        return value;
+      #endif // CEREAL_HAS_FLOAT_CHARCONV
+
+      char * end;
+      errno = 0;
+      value = strtoValue( str, &end, T() );
+      if( end == str )
+        throw std::invalid_argument( "cereal: no number to convert" );
+      if( errno == ERANGE && std::fpclassify( value ) != FP_SUBNORMAL )
+        throw std::out_of_range( "cereal: number out of range" );
+
+      return value;
+    }
+  } // namespace charconv_detail
+} // namespace cereal
+
+#endif // CEREAL_DETAILS_CHARCONV_HPP_
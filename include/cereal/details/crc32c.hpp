@@ -0,0 +1,130 @@
+/*! \file crc32c.hpp
+    \brief CRC32C checksums, using the processor's CRC instructions where available
+    \ingroup Internal */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_CRC32C_HPP_
+#define CEREAL_DETAILS_CRC32C_HPP_
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace cereal
+{
+  namespace crc32c_detail
+  {
+    //! Lookup tables for computing CRC32C eight bytes at a time in software
+    /*! @ingroup Internal */
+    struct Tables
+    {
+      std::uint32_t table[8][256];
+
+      Tables()
+      {
+        for( std::uint32_t i = 0; i < 256; ++i )
+        {
+          std::uint32_t crc = i;
+          for( int bit = 0; bit < 8; ++bit )
+            crc = ( crc >> 1 ) ^ ( 0x82F63B78U & ( 0U - ( crc & 1 ) ) );
+          table[0][i] = crc;
+        }
+
+        for( std::uint32_t i = 0; i < 256; ++i )
+          for( int t = 1; t < 8; ++t )
+            table[t][i] = ( table[t - 1][i] >> 8 ) ^ table[0][table[t - 1][i] & 0xFF];
+      }
+    };
+
+    //! Continues a CRC32C (Castagnoli) checksum over more data
+    /*! SSE 4.2 and ARMv8 provide an instruction that consumes eight bytes per cycle,
+        which is used when the compiler targets it.  Otherwise the checksum is computed
+        eight bytes at a time with lookup tables.
+
+        @param crc The checksum of the data so far, 0 for none
+        @param data The data to add
+        @param size The number of bytes to add
+        @return The checksum of all of the data
+        @ingroup Internal */
+    inline std::uint32_t update( std::uint32_t crc, const void * data, std::size_t size )
+    {
+      auto p = static_cast<const unsigned char *>( data );
+      auto const end = p + size;
+      crc = ~crc;
+
+    #if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+      for( ; end - p >= 8; p += 8 )
+      {
+        std::uint64_t word;
+        std::memcpy( &word, p, sizeof(word) );
+      #if defined(__SSE4_2__) && ( defined(__x86_64__) || defined(_M_X64) )
+        crc = static_cast<std::uint32_t>( _mm_crc32_u64( crc, word ) );
+      #elif defined(__SSE4_2__)
+        crc = _mm_crc32_u32( _mm_crc32_u32( crc, static_cast<std::uint32_t>( word ) ), static_cast<std::uint32_t>( word >> 32 ) );
+      #else
+        crc = __crc32cd( crc, word );
+      #endif
+      }
+
+      for( ; p != end; ++p )
+      #if defined(__SSE4_2__)
+        crc = _mm_crc32_u8( crc, *p );
+      #else
+        crc = __crc32cb( crc, *p );
+      #endif
+    #else // software
+      static const Tables tables;
+      auto const & t = tables.table;
+
+      // The eight byte steps read the data as little endian
+      static const std::uint32_t probe = 1;
+      if( *reinterpret_cast<const unsigned char *>( &probe ) == 1 )
+        for( ; end - p >= 8; p += 8 )
+        {
+          std::uint32_t low, high;
+          std::memcpy( &low, p, sizeof(low) );
+          std::memcpy( &high, p + 4, sizeof(high) );
+          low ^= crc;
+          crc = t[7][low & 0xFF] ^ t[6][( low >> 8 ) & 0xFF] ^ t[5][( low >> 16 ) & 0xFF] ^ t[4][low >> 24] ^
+                t[3][high & 0xFF] ^ t[2][( high >> 8 ) & 0xFF] ^ t[1][( high >> 16 ) & 0xFF] ^ t[0][high >> 24];
+        }
+
+      for( ; p != end; ++p )
+        crc = ( crc >> 8 ) ^ t[0][( crc ^ *p ) & 0xFF];
+    #endif
+
+      return ~crc;
+    }
+  } // namespace crc32c_detail
+} // namespace cereal
+
+#endif // CEREAL_DETAILS_CRC32C_HPP_
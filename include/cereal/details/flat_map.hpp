@@ -0,0 +1,313 @@
+/*! \file flat_map.hpp
+    \brief Open addressing hash table used internally by archives
+    \ingroup Internal */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_FLAT_MAP_HPP_
+#define CEREAL_DETAILS_FLAT_MAP_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace cereal
+{
+  namespace detail
+  {
+    //! A flat hash table mapping non null pointers to 64 bit ids
+    /*! Entries are stored inline in a single power of two sized array and
+        collisions are resolved with linear probing, so inserts do not allocate
+        except when the table grows and lookups touch contiguous memory.
+
+        Entries cannot be removed individually.  clear() empties the table, keeping
+        its capacity, and rollback() removes every entry inserted since the matching
+        checkpoint().  While a checkpoint is open the keys inserted are logged, so a
+        rollback costs time in proportion to the entries it removes rather than to the
+        size of the table.
+
+        @internal */
+    class FlatPointerMap
+    {
+      public:
+        FlatPointerMap() : itsSize(0) {}
+
+        //! Looks up key, inserting value if it is not present
+        /*! @param key The pointer to look up, which must not be null
+            @param value The value to insert if key is not present
+            @return The value mapped to key and whether it was inserted */
+        std::pair<std::uint64_t, bool> insert( void const * key, std::uint64_t value )
+        {
+          if( (itsSize + 1) * 2 > itsEntries.size() )
+            grow( itsSize + 1 );
+
+          auto & entry = probe( key );
+          if( entry.key == key )
+            return {entry.value, false};
+
+          entry.key = key;
+          entry.value = value;
+          ++itsSize;
+          if( !itsCheckpoints.empty() )
+            itsLog.push_back( key );
+          return {value, true};
+        }
+
+        //! Makes room for at least count entries without a rehash
+        void reserve( std::size_t count )
+        {
+          if( count * 2 > itsEntries.size() )
+            grow( count );
+        }
+
+        //! Removes every entry and open checkpoint, keeping the allocated capacity
+        void clear()
+        {
+          itsLog.clear();
+          itsCheckpoints.clear();
+          if( itsSize == 0 )
+            return;
+
+          for( auto & entry : itsEntries )
+            entry.key = nullptr;
+          itsSize = 0;
+        }
+
+        //! Starts logging inserts, so that they can be removed by the matching rollback
+        /*! Checkpoints nest, each rollback matching the innermost open checkpoint. */
+        void checkpoint()
+        {
+          itsCheckpoints.push_back( itsLog.size() );
+        }
+
+        //! Removes every entry inserted since the innermost open checkpoint, and closes it
+        /*! There must be an open checkpoint. */
+        void rollback()
+        {
+          auto const first = itsCheckpoints.back();
+          itsCheckpoints.pop_back();
+
+          while( itsLog.size() > first )
+          {
+            erase( itsLog.back() );
+            itsLog.pop_back();
+          }
+        }
+
+        //! The number of entries in the table
+        std::size_t size() const { return itsSize; }
+
+      private:
+        struct Entry
+        {
+          Entry() : key(nullptr), value(0) {}
+          void const * key;
+          std::uint64_t value;
+        };
+
+        //! Removes key, moving later entries of its probe sequence back to close the gap
+        void erase( void const * key )
+        {
+          auto const mask = itsEntries.size() - 1;
+          auto hole = static_cast<std::size_t>( &probe( key ) - itsEntries.data() );
+          if( itsEntries[hole].key != key )
+            return;
+
+          for( auto i = (hole + 1) & mask; itsEntries[i].key; i = (i + 1) & mask )
+          {
+            // an entry can fill the hole unless its home slot lies after the hole, up to where it is
+            auto const home = hash( itsEntries[i].key ) & mask;
+            if( ( (i - home) & mask ) >= ( (i - hole) & mask ) )
+            {
+              itsEntries[hole] = itsEntries[i];
+              hole = i;
+            }
+          }
+
+          itsEntries[hole] = Entry();
+          --itsSize;
+        }
+
+        //! Finds the slot holding key, or the empty slot where it belongs
+        Entry & probe( void const * key )
+        {
+          auto const mask = itsEntries.size() - 1;
+          for( auto i = hash( key ) & mask; ; i = (i + 1) & mask )
+          {
+            auto & entry = itsEntries[i];
+            if( entry.key == key || entry.key == nullptr )
+              return entry;
+          }
+        }
+
+        //! Mixes the bits of a pointer, whose low bits are usually zero due to alignment
+        static std::size_t hash( void const * key )
+        {
+          auto h = static_cast<std::uint64_t>( reinterpret_cast<std::uintptr_t>( key ) );
+          h ^= h >> 33;
+          h *= 0xff51afd7ed558ccdULL;
+          h ^= h >> 33;
+          return static_cast<std::size_t>( h );
+        }
+
+        //! Rehashes into a table able to hold at least count entries at half load
+        void grow( std::size_t count )
+        {
+          std::size_t capacity = itsEntries.empty() ? 16 : itsEntries.size();
+          while( capacity < count * 2 )
+            capacity *= 2;
+
+          std::vector<Entry> old( capacity );
+          old.swap( itsEntries );
+
+          for( auto const & entry : old )
+            if( entry.key )
+              probe( entry.key ) = entry;
+        }
+
+        std::vector<Entry> itsEntries;
+        std::size_t itsSize;
+        std::vector<void const *> itsLog;        //!< Keys inserted while a checkpoint is open
+        std::vector<std::size_t> itsCheckpoints; //!< The size of the log at each open checkpoint
+    };
+
+    //! A flat hash table mapping the names of sibling nodes to their positions
+    /*! Text archives use this to find members loaded out of order in wide
+        objects.  The names are not copied and must outlive the index.  When a
+        name occurs more than once, the first position inserted is kept, matching
+        a linear search from the front.
+
+        @internal */
+    class FlatNameIndex
+    {
+      public:
+        //! The number of siblings below which a linear search is cheaper than building an index
+        static const std::size_t linearSearchLimit = 16;
+
+        FlatNameIndex() : itsSize(0) {}
+
+        //! Whether nothing has been inserted
+        bool empty() const { return itsSize == 0; }
+
+        //! Makes room for at least count names without a rehash
+        void reserve( std::size_t count )
+        {
+          if( count * 2 > itsEntries.size() )
+            grow( count );
+        }
+
+        //! Maps name to position, unless name is already present
+        void insert( const char * name, std::size_t size, std::size_t position )
+        {
+          if( (itsSize + 1) * 2 > itsEntries.size() )
+            grow( itsSize + 1 );
+
+          auto const h = hash( name, size );
+          auto & entry = itsEntries[slot( name, size, h )];
+          if( entry.name )
+            return;
+
+          entry.name = name;
+          entry.size = size;
+          entry.hash = h;
+          entry.position = position;
+          ++itsSize;
+        }
+
+        //! Looks up the position of name
+        /*! @return Whether name was found, in which case position is set */
+        bool find( const char * name, std::size_t size, std::size_t & position ) const
+        {
+          if( itsSize == 0 )
+            return false;
+
+          auto const & entry = itsEntries[slot( name, size, hash( name, size ) )];
+          if( !entry.name )
+            return false;
+
+          position = entry.position;
+          return true;
+        }
+
+      private:
+        struct Entry
+        {
+          Entry() : name(nullptr), size(0), hash(0), position(0) {}
+          const char * name;
+          std::size_t size;
+          std::size_t hash;
+          std::size_t position;
+        };
+
+        //! Finds the index of the slot holding name, or of the empty slot where it belongs
+        std::size_t slot( const char * name, std::size_t size, std::size_t h ) const
+        {
+          auto const mask = itsEntries.size() - 1;
+          for( auto i = h & mask; ; i = (i + 1) & mask )
+          {
+            auto const & entry = itsEntries[i];
+            if( entry.name == nullptr ||
+                ( entry.hash == h && entry.size == size && std::memcmp( entry.name, name, size ) == 0 ) )
+              return i;
+          }
+        }
+
+        //! FNV-1a over the characters of a name
+        static std::size_t hash( const char * name, std::size_t size )
+        {
+          std::uint64_t h = 0xcbf29ce484222325ULL;
+          for( std::size_t i = 0; i < size; ++i )
+          {
+            h ^= static_cast<unsigned char>( name[i] );
+            h *= 0x100000001b3ULL;
+          }
+          return static_cast<std::size_t>( h );
+        }
+
+        //! Rehashes into a table able to hold at least count entries at half load
+        void grow( std::size_t count )
+        {
+          std::size_t capacity = itsEntries.empty() ? 16 : itsEntries.size();
+          while( capacity < count * 2 )
+            capacity *= 2;
+
+          std::vector<Entry> old( capacity );
+          old.swap( itsEntries );
+
+          for( auto const & entry : old )
+            if( entry.name )
+              itsEntries[slot( entry.name, entry.size, entry.hash )] = entry;
+        }
+
+        std::vector<Entry> itsEntries;
+        std::size_t itsSize;
+    };
+  } // namespace detail
+} // namespace cereal
+
+#endif // CEREAL_DETAILS_FLAT_MAP_HPP_
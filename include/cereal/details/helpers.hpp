@@ -32,10 +32,16 @@
 
 #include <type_traits>
 #include <cstdint>
+#include <cstring>
 #include <utility>
+#include <string>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <stdexcept>
+#include <mutex>
+#include <typeindex>
 
 #include <cereal/macros.hpp>
 #include <cereal/details/static_object.hpp>
@@ -235,6 +241,55 @@ namespace cereal
     // used during saving pointers
     static const int32_t msb_32bit  = 0x80000000;
     static const int32_t msb2_32bit = 0x40000000;
+    // used for polymorphic types registered with a numeric id
+    static const int32_t msb3_32bit = 0x20000000;
+    // used for shared pointer ids, which are wider than the ids written to archives
+    static const std::uint64_t msb_64bit = 0x8000000000000000ULL;
+    // a shared pointer id that is followed by the actual, wide id
+    static const std::uint32_t wide_id_32bit = 0x7FFFFFFF;
+
+    //! Identifies a type without RTTI, by the address of a static member
+    template <class T>
+    struct type_key { static char const id; };
+
+    template <class T> char const type_key<T>::id = 0;
+
+    //! User data attached to an archive, one pointer per type
+    /*! Archives rarely hold more than a few kinds of user data, so these are kept in a
+        vector searched linearly, which is cheaper than any map for so few entries. */
+    class UserDataSlots
+    {
+      public:
+        //! Attaches data of type T, replacing any attached before, or detaches it if data is nullptr
+        template <class T>
+        void set( T * data )
+        {
+          void const * key = &type_key<typename std::remove_cv<T>::type>::id;
+          for( auto & slot : itsSlots )
+            if( slot.first == key )
+            {
+              slot.second = data;
+              return;
+            }
+
+          itsSlots.emplace_back( key, data );
+        }
+
+        //! Gets the data of type T, or nullptr if there is none
+        template <class T>
+        T * get() const
+        {
+          void const * key = &type_key<typename std::remove_cv<T>::type>::id;
+          for( auto const & slot : itsSlots )
+            if( slot.first == key )
+              return static_cast<T *>( slot.second );
+
+          return nullptr;
+        }
+
+      private:
+        std::vector<std::pair<void const *, void *>> itsSlots;
+    };
   }
 
   // ######################################################################
@@ -325,6 +380,424 @@ namespace cereal
     return {std::forward<KeyType>(key), std::forward<ValueType>(value)};
   }
 
+  // ######################################################################
+  //! A wrapper around a container that is loaded into its existing elements
+  /*! @relates in_place
+      @internal */
+  template <class T>
+  struct InPlaceWrapper
+  {
+    InPlaceWrapper( T & c ) : container( c ) {}
+    T & container;
+
+    InPlaceWrapper & operator=( InPlaceWrapper const & ) = delete;
+  };
+
+  //! Loads a container reusing the elements it already holds
+  /*! Loading a map or set normally clears it and allocates a new element for
+      every item.  When wrapped with in_place, elements whose keys are in the
+      archive are kept: their mapped values are loaded into the existing
+      objects, so their storage (e.g. the capacity of strings and vectors) is
+      reused as well.  Only elements for keys that are new are allocated, and
+      elements for keys that are no longer present are removed.  Repeatedly
+      loading data with the same keys into a long lived container therefore
+      does not allocate nodes.
+
+      Reused mapped values are loaded over their previous state rather than a
+      default constructed one, so their load functions must assign every member.
+
+      Saving through the wrapper is identical to saving the container itself,
+      and both can load each other's data.  This is supported for std::map,
+      std::multimap, std::set, std::multiset and std::unordered_map.
+
+      std::unique_ptr and std::shared_ptr can be wrapped as well.  If the pointer
+      holds an object and the archive holds one of the same dynamic type, found
+      from its polymorphic name or id, the data is loaded into the existing object
+      instead of a new allocation.  A std::shared_ptr is only reused when it is the
+      sole owner of its object, so no other pointer sees the object change.  Types
+      that are only loaded by load_and_construct always get a new object.
+
+      @code{.cpp}
+      std::map<std::string, std::vector<double>> cache;
+      while( more data )
+        archive( cereal::in_place( cache ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  InPlaceWrapper<T> in_place( T & container )
+  {
+    return {container};
+  }
+
+  // ######################################################################
+  //! A wrapper around an unordered container that also serializes its hashing parameters
+  /*! @relates with_hash_policy
+      @internal */
+  template <class T>
+  struct HashPolicyWrapper
+  {
+    HashPolicyWrapper( T & c ) : container( c ) {}
+    T & container;
+
+    HashPolicyWrapper & operator=( HashPolicyWrapper const & ) = delete;
+
+    //! Saves the maximum load factor and bucket count followed by the container
+    template <class Archive> inline
+    void CEREAL_SAVE_FUNCTION_NAME( Archive & ar ) const
+    {
+      float const maxLoadFactor = container.max_load_factor();
+      std::uint64_t const bucketCount = container.bucket_count();
+
+      ar( make_nvp<Archive>("max_load_factor", maxLoadFactor),
+          make_nvp<Archive>("bucket_count", bucketCount),
+          make_nvp<Archive>("container", static_cast<typename std::add_const<T>::type &>( container )) );
+    }
+
+    //! Restores the hashing parameters before loading the elements, so they are
+    //! inserted without any rehashing
+    template <class Archive> inline
+    void CEREAL_LOAD_FUNCTION_NAME( Archive & ar )
+    {
+      float maxLoadFactor;
+      std::uint64_t bucketCount;
+      ar( make_nvp<Archive>("max_load_factor", maxLoadFactor),
+          make_nvp<Archive>("bucket_count", bucketCount) );
+
+      if( !(maxLoadFactor > 0.0f) )
+        throw Exception("Invalid maximum load factor for unordered container");
+
+      container.clear();
+      container.max_load_factor( maxLoadFactor );
+      container.rehash( static_cast<std::size_t>( bucketCount ) );
+
+      ar( make_nvp<Archive>("container", container) );
+    }
+  };
+
+  //! Serializes an unordered container together with its bucket count and maximum load factor
+  /*! Unordered containers are normally saved as just their elements, and loading
+      only reserves enough buckets for them.  A table that was grown or tuned
+      ahead of time therefore comes back smaller, and rehashes again as soon as
+      more elements are inserted.  Wrapping the container with with_hash_policy
+      saves its max_load_factor and bucket_count as well, and restores both
+      before the elements are loaded, so the loaded container has the same
+      capacity as the original.
+
+      The parameters are stored in front of the container, so data saved with
+      the wrapper must also be loaded with it.  This works with
+      std::unordered_map, std::unordered_multimap, std::unordered_set and
+      std::unordered_multiset, or any container with the same interface.
+
+      @code{.cpp}
+      std::unordered_map<std::uint64_t, Order> orders;
+      orders.reserve( 1 << 20 );
+      archive( cereal::with_hash_policy( orders ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  HashPolicyWrapper<T> with_hash_policy( T & container )
+  {
+    return {container};
+  }
+
+  // ######################################################################
+  //! A wrapper around a string that is saved at most once per archive
+  /*! @relates interned
+      @internal */
+  template <class T>
+  struct InternedWrapper
+  {
+    InternedWrapper( T & s ) : value( s ) {}
+    T & value;
+
+    InternedWrapper & operator=( InternedWrapper const & ) = delete;
+  };
+
+  //! Serializes a string so that repeated occurrences of it are written as a back reference
+  /*! Each string saved through the wrapper is looked up in a table kept by the
+      archive, in the same way as the names of polymorphic types.  The first
+      occurrence of a string is saved in full along with a new id, and every
+      later occurrence is saved as just that id.  Loading resolves ids through
+      the strings loaded so far, so repeated strings are read only once.
+
+      This pays off for strings that repeat many times in an archive, such as
+      symbol names or identifiers.  The table is cleared when the archive is
+      reset.  Data saved through the wrapper must be loaded through it, with
+      all interned strings loaded in the order they were saved.
+
+      Requires \<cereal/types/string.hpp\>.
+
+      @code{.cpp}
+      template <class Archive>
+      void serialize( Archive & ar )
+      {
+        ar( cereal::interned( symbol ), price, quantity );
+      }
+      @endcode
+
+      @ingroup Utility */
+  inline InternedWrapper<std::string> interned( std::string & value )
+  {
+    return {value};
+  }
+
+  //! Serializes a string so that repeated occurrences of it are written as a back reference
+  /*! @relates InternedWrapper
+      @ingroup Utility */
+  inline InternedWrapper<std::string const> interned( std::string const & value )
+  {
+    return {value};
+  }
+
+  // ######################################################################
+  //! A wrapper around a contiguous block of data that is saved at most once per archive
+  /*! @relates deduplicated
+      @internal */
+  template <class T>
+  struct DeduplicatedWrapper
+  {
+    DeduplicatedWrapper( T & v, std::size_t t ) : value( v ), threshold( t ) {}
+    T & value;
+    std::size_t threshold;
+
+    DeduplicatedWrapper & operator=( DeduplicatedWrapper const & ) = delete;
+  };
+
+  //! Serializes a vector or string so that later copies of the same contents are written as a back reference
+  /*! This is interned for large blocks of data, such as cached images or repeated
+      configuration payloads that are held by different owners and so are not shared
+      through a pointer.  The bytes of each block saved through the wrapper are hashed
+      and looked up in a table kept by the archive.  The first occurrence of some
+      contents is saved in full along with a new id, and every later block with the
+      same contents is saved as just that id.  Loading copies the contents of an id
+      from the first block loaded with it.
+
+      Blocks smaller than threshold bytes are always saved in full, without being
+      hashed or kept.  Otherwise the archive keeps a copy of every distinct block until
+      it is reset, both to rule out hash collisions when saving and to resolve ids when
+      loading.  Data saved through the wrapper must be loaded through it, with all
+      deduplicated blocks loaded in the order they were saved.
+
+      The value must be a std::vector, std::basic_string, or similar contiguous
+      container of trivially serializable elements.
+
+      @code{.cpp}
+      template <class Archive>
+      void serialize( Archive & ar )
+      {
+        ar( name, cereal::deduplicated( thumbnail ) );
+      }
+      @endcode
+
+      @param threshold The smallest size in bytes of a block that is deduplicated
+      @ingroup Utility */
+  template <class T> inline
+  DeduplicatedWrapper<T> deduplicated( T & value, std::size_t threshold = 1024 )
+  {
+    return {value, threshold};
+  }
+
+  // ######################################################################
+  //! A wrapper around a std::unique_ptr to an array and the number of its elements
+  /*! @relates owned_array
+      @internal */
+  template <class Ptr, class Size>
+  struct OwnedArrayWrapper
+  {
+    OwnedArrayWrapper( Ptr & p, Size & s ) : pointer( p ), size( s ) {}
+    Ptr & pointer;
+    Size & size;
+
+    OwnedArrayWrapper & operator=( OwnedArrayWrapper const & ) = delete;
+  };
+
+  //! Serializes a std::unique_ptr to an array along with the number of its elements
+  /*! A std::unique_ptr<T[]> does not know how many elements it holds, so the count
+      is passed alongside it.  Arrays of arithmetic or trivially serializable types
+      are saved as a single block of binary data by archives that support it, and
+      the data is saved exactly as a std::vector<T> would be, so each can load the
+      other's data.
+
+      Loading reuses the array if it already holds the loaded number of elements.
+      Otherwise a new array is allocated with new T[size], which leaves arithmetic
+      and trivial elements uninitialized until the data is copied into them, and
+      the count is updated.  Loading requires the default deleter.
+
+      @code{.cpp}
+      std::unique_ptr<double[]> samples;
+      std::size_t count;
+      archive( cereal::owned_array( samples, count ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T, class D, class Size> inline
+  OwnedArrayWrapper<std::unique_ptr<T[], D>, Size> owned_array( std::unique_ptr<T[], D> & pointer, Size & size )
+  {
+    return {pointer, size};
+  }
+
+  //! Saves a std::unique_ptr to an array along with the number of its elements
+  /*! @relates OwnedArrayWrapper */
+  template <class T, class D, class Size> inline
+  OwnedArrayWrapper<std::unique_ptr<T[], D> const, Size const> owned_array( std::unique_ptr<T[], D> const & pointer, Size const & size )
+  {
+    return {pointer, size};
+  }
+
+  // ######################################################################
+  //! A wrapper around a container of polymorphic pointers that all point to the same type
+  /*! @relates homogeneous
+      @internal */
+  template <class T>
+  struct HomogeneousWrapper
+  {
+    HomogeneousWrapper( T & c ) : container( c ) {}
+    T & container;
+
+    HomogeneousWrapper & operator=( HomogeneousWrapper const & ) = delete;
+  };
+
+  //! Serializes a container of polymorphic pointers whose objects all have the same dynamic type
+  /*! Each polymorphic pointer normally carries its own type metadata, and saving it
+      looks up the dynamic type of its object among the registered types.  When every
+      object in a container is known to have the same type, such as a vector of
+      shapes that are all circles, the wrapper looks up the type once and writes its
+      metadata once, followed by the data of every object.
+
+      Saving checks that no pointer is null and that every object has the same
+      dynamic type, and throws an Exception otherwise.  Data saved through the wrapper
+      must be loaded through it.  The container must be a std::vector, std::deque or
+      std::list of std::shared_ptr or std::unique_ptr to a polymorphic type.
+
+      @code{.cpp}
+      std::vector<std::shared_ptr<Shape>> circles;
+      ar( cereal::homogeneous( circles ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  HomogeneousWrapper<T> homogeneous( T & container )
+  {
+    return {container};
+  }
+
+  // ######################################################################
+  //! Counts of the work done by an archive
+  /*! Archives only collect these when CEREAL_ARCHIVE_STATISTICS is defined, before
+      including any cereal header, and report zero for all of them otherwise.  Without
+      the define, the counting is removed at compile time.  Defining CEREAL_TRACE_POLICY
+      collects them as well, since its calls report the byte count as a position.
+
+      @code{.cpp}
+      cereal::BinaryOutputArchive ar( os );
+      ar( data );
+      metrics.record( "serialize.bytes", ar.statistics().bytes );
+      @endcode
+
+      @ingroup Utility */
+  struct ArchiveStatistics
+  {
+    std::uint64_t bytes = 0;              //!< Bytes passed to saveBinary or loadBinary
+    std::uint64_t binaryCalls = 0;        //!< Calls to saveBinary or loadBinary
+    std::uint64_t sharedPointers = 0;     //!< Distinct shared pointers tracked
+    std::uint64_t polymorphicLookups = 0; //!< Polymorphic pointers whose type was looked up
+    std::uint64_t versionedTypes = 0;     //!< Types whose class version was saved or loaded
+    std::uint64_t maxDepth = 0;           //!< Deepest nesting of classes, counted as for LoadLimits::maxDepth
+  };
+
+  namespace detail
+  {
+    #if defined(CEREAL_ARCHIVE_STATISTICS) || defined(CEREAL_TRACE_POLICY)
+    //! Collects ArchiveStatistics for an archive
+    class StatisticsCounter
+    {
+      public:
+        StatisticsCounter() : itsDepth( 0 ) {}
+
+        void binary( std::uint64_t size )  { itsStatistics.bytes += size; ++itsStatistics.binaryCalls; }
+        void sharedPointer()               { ++itsStatistics.sharedPointers; }
+        void polymorphicLookup()           { ++itsStatistics.polymorphicLookups; }
+        void versionedType()               { ++itsStatistics.versionedTypes; }
+
+        void enter()
+        {
+          if( ++itsDepth > itsStatistics.maxDepth )
+            itsStatistics.maxDepth = itsDepth;
+        }
+
+        void leave() { --itsDepth; }
+
+        void reset()
+        {
+          itsStatistics = ArchiveStatistics();
+          itsDepth = 0;
+        }
+
+        ArchiveStatistics const & get() const { return itsStatistics; }
+
+      private:
+        ArchiveStatistics itsStatistics;
+        std::uint64_t itsDepth;
+    };
+    #else // CEREAL_ARCHIVE_STATISTICS || CEREAL_TRACE_POLICY
+    //! Stands in for the statistics of an archive when they are not collected
+    class StatisticsCounter
+    {
+      public:
+        void binary( std::uint64_t ) {}
+        void sharedPointer() {}
+        void polymorphicLookup() {}
+        void versionedType() {}
+        void enter() {}
+        void leave() {}
+        void reset() {}
+
+        ArchiveStatistics const & get() const
+        {
+          static const ArchiveStatistics none = ArchiveStatistics();
+          return none;
+        }
+    };
+    #endif // CEREAL_ARCHIVE_STATISTICS || CEREAL_TRACE_POLICY
+
+    //! Whether statistics or tracing are compiled in, which must see every value on its own
+    /*! Archives do not coalesce runs of arithmetic values when this is set, so that
+        each value is counted and traced as it would be by any other archive.
+        @internal */
+    #if defined(CEREAL_ARCHIVE_STATISTICS) || defined(CEREAL_TRACE_POLICY)
+    static const bool counts_values = true;
+    #else
+    static const bool counts_values = false;
+    #endif
+  } // namespace detail
+
+  // ######################################################################
+  //! Receives every value an archive serializes, for tools such as ProfilingAdapter
+  /*! An observer is attached to an archive with setObserver.  Each value the archive
+      processes is bracketed by a call to enter and a call to leave, with the values
+      it contains entered and left in between.  A value whose serialization throws is
+      not left.
+
+      @ingroup Utility */
+  class ArchiveObserver
+  {
+    public:
+      virtual ~ArchiveObserver() {}
+
+      //! Called before a value is serialized
+      /*! @param name The name of a name-value pair, or nullptr for any other value
+          @param type The type of the value, or of the value in the name-value pair
+          @param wrapper Whether the value is one of cereal's own wrappers, such as a
+                         size tag, binary data or a base class, which belong to the value
+                         around them */
+      virtual void enter( char const * name, std::type_info const & type, bool wrapper ) = 0;
+
+      //! Called after the most recently entered value has been serialized
+      virtual void leave() = 0;
+  };
+
   namespace detail
   {
     //! Tag for Version, which due to its anonymous namespace, becomes a different
@@ -343,17 +816,184 @@ namespace cereal
       // always get a version number of 0
     };
 
+    //! FNV-1a over a null terminated string, evaluated at compile time by CEREAL_CLASS_VERSION
+    /*! @internal */
+    constexpr std::uint64_t schema_hash( char const * name, std::uint64_t h = 0xcbf29ce484222325ULL )
+    {
+      return *name ? schema_hash( name + 1, ( h ^ static_cast<unsigned char>( *name ) ) * 0x100000001b3ULL ) : h;
+    }
+
+    //! The last step of the SplitMix64 finalizer
+    /*! @internal */
+    constexpr std::uint64_t schema_mix3( std::uint64_t z ) { return z ^ ( z >> 31 ); }
+
+    //! The second step of the SplitMix64 finalizer
+    /*! @internal */
+    constexpr std::uint64_t schema_mix2( std::uint64_t z ) { return schema_mix3( ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL ); }
+
+    //! The SplitMix64 finalizer, spreading every input bit over the whole result
+    /*! @internal */
+    constexpr std::uint64_t schema_mix( std::uint64_t z ) { return schema_mix2( ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL ); }
+
+    //! The contribution of one CEREAL_CLASS_VERSION to the schema fingerprint
+    /*! The name is the type as spelled in the macro, so the term is the same on every
+        platform and compiler.
+        @internal */
+    constexpr std::uint64_t schema_term( char const * name, std::uint32_t version )
+    {
+      return schema_mix( schema_hash( name ) ^ ( static_cast<std::uint64_t>( version ) * 0x9E3779B97F4A7C15ULL ) );
+    }
+
     //! Holds all registered version information
+    /*! This is only accessed once per type and archive, so a lock is sufficient
+        to make registration from several threads safe.
+
+        The fingerprint is the sum of the schema_term of every type registered with
+        CEREAL_CLASS_VERSION, so it does not depend on the order of registration. */
     struct Versions
     {
       std::unordered_map<std::size_t, std::uint32_t> mapping;
+      std::unordered_set<std::size_t> declared;
+      std::uint64_t fingerprint = 0;
+      std::mutex mutex;
 
       std::uint32_t find( std::size_t hash, std::uint32_t version )
       {
+        std::lock_guard<std::mutex> lock( mutex );
         const auto result = mapping.emplace( hash, version );
         return result.first->second;
       }
+
+      //! Registers the version of a type named in CEREAL_CLASS_VERSION
+      /*! A type declared in several translation units contributes to the fingerprint once */
+      void declare( std::size_t hash, std::uint32_t version, std::uint64_t term )
+      {
+        std::lock_guard<std::mutex> lock( mutex );
+        mapping.emplace( hash, version );
+        if( declared.insert( hash ).second )
+          fingerprint += term;
+      }
+
+      //! The fingerprint of every version declared so far
+      std::uint64_t getFingerprint()
+      {
+        std::lock_guard<std::mutex> lock( mutex );
+        return fingerprint;
+      }
     }; // struct Versions
+
+    //! Assigns every versioned type a small, dense index
+    /*! Archives use these indices to track which types they have seen in a
+        flat array instead of a hash table.  An index is assigned the first time
+        a type is serialized and never changes afterwards.  The mapping is by
+        type hash so that a type keeps one index even when it is instantiated in
+        several translation units. */
+    struct VersionedTypeSlots
+    {
+      std::unordered_map<std::size_t, std::size_t> mapping;
+      std::mutex mutex;
+
+      std::size_t slot( std::size_t hash )
+      {
+        std::lock_guard<std::mutex> lock( mutex );
+        const auto result = mapping.emplace( hash, mapping.size() );
+        return result.first->second;
+      }
+    }; // struct VersionedTypeSlots
+
+    //! Gets the dense index of a versioned type, see VersionedTypeSlots
+    template <class T> inline
+    std::size_t versioned_type_slot()
+    {
+      static const auto slot = StaticObject<VersionedTypeSlots>::getInstance().slot( std::type_index(typeid(T)).hash_code() );
+      return slot;
+    }
+
+    // ######################################################################
+    //! Rotates a 64 bit value left
+    /*! @internal */
+    inline std::uint64_t rotl64( std::uint64_t value, unsigned int bits )
+    {
+      return ( value << bits ) | ( value >> ( 64 - bits ) );
+    }
+
+    //! Reads a 64 bit word in native byte order from possibly unaligned memory
+    /*! @internal */
+    inline std::uint64_t read64( unsigned char const * p )
+    {
+      std::uint64_t value;
+      std::memcpy( &value, p, sizeof(value) );
+      return value;
+    }
+
+    //! Reads a 32 bit word in native byte order from possibly unaligned memory
+    /*! @internal */
+    inline std::uint32_t read32( unsigned char const * p )
+    {
+      std::uint32_t value;
+      std::memcpy( &value, p, sizeof(value) );
+      return value;
+    }
+
+    //! Hashes a block of bytes with XXH64
+    /*! Four independent lanes consume 32 bytes per step, so large blocks hash at close
+        to memory speed.  Words are read in native byte order, so the result is only
+        meaningful within one process and is never written to an archive.
+        @internal */
+    inline std::uint64_t hash_bytes( void const * data, std::size_t size, std::uint64_t seed = 0 )
+    {
+      static const std::uint64_t p1 = 0x9E3779B185EBCA87ULL;
+      static const std::uint64_t p2 = 0xC2B2AE3D27D4EB4FULL;
+      static const std::uint64_t p3 = 0x165667B19E3779F9ULL;
+      static const std::uint64_t p4 = 0x85EBCA77C2B2AE63ULL;
+      static const std::uint64_t p5 = 0x27D4EB2F165667C5ULL;
+
+      auto round = []( std::uint64_t acc, std::uint64_t input )
+      {
+        return rotl64( acc + input * p2, 31 ) * p1;
+      };
+
+      auto p = static_cast<unsigned char const *>( data );
+      auto const end = p + size;
+      std::uint64_t h;
+
+      if( size >= 32 )
+      {
+        std::uint64_t v1 = seed + p1 + p2, v2 = seed + p2, v3 = seed, v4 = seed - p1;
+        for( auto const limit = end - 32; p <= limit; p += 32 )
+        {
+          v1 = round( v1, read64( p ) );
+          v2 = round( v2, read64( p + 8 ) );
+          v3 = round( v3, read64( p + 16 ) );
+          v4 = round( v4, read64( p + 24 ) );
+        }
+
+        h = rotl64( v1, 1 ) + rotl64( v2, 7 ) + rotl64( v3, 12 ) + rotl64( v4, 18 );
+        for( auto v : {v1, v2, v3, v4} )
+          h = ( h ^ round( 0, v ) ) * p1 + p4;
+      }
+      else
+        h = seed + p5;
+
+      h += static_cast<std::uint64_t>( size );
+
+      for( ; p + 8 <= end; p += 8 )
+        h = rotl64( h ^ round( 0, read64( p ) ), 27 ) * p1 + p4;
+      if( p + 4 <= end )
+      {
+        h = rotl64( h ^ ( static_cast<std::uint64_t>( read32( p ) ) * p1 ), 23 ) * p2 + p3;
+        p += 4;
+      }
+      for( ; p < end; ++p )
+        h = rotl64( h ^ ( *p * p5 ), 11 ) * p1;
+
+      h ^= h >> 33;
+      h *= p2;
+      h ^= h >> 29;
+      h *= p3;
+      h ^= h >> 32;
+      return h;
+    }
   } // namespace detail
 } // namespace cereal
 
@@ -0,0 +1,245 @@
+/*! \file memory_resource.hpp
+    \brief Memory resources that objects created while loading can be allocated from */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_MEMORY_RESOURCE_HPP_
+#define CEREAL_DETAILS_MEMORY_RESOURCE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace cereal
+{
+  // ######################################################################
+  //! A source of memory for objects that cereal creates while loading
+  /*! By default cereal allocates the objects owned by smart pointers it loads
+      with the global operator new.  Attaching a memory resource to an input
+      archive with InputArchive::setMemoryResource makes std::shared_ptr loads,
+      including polymorphic ones, and loads of resource_unique_ptr allocate
+      from it instead.
+
+      @code{.cpp}
+      cereal::MonotonicArena arena;
+      {
+        std::ifstream is( "tree.bin", std::ios::binary );
+        cereal::BinaryInputArchive ar( is );
+        ar.setMemoryResource( &arena );
+
+        std::shared_ptr<Node> root;
+        ar( root );
+        // use root
+      } // objects are destroyed here, which does not free their memory
+
+      arena.release(); // frees all of the memory at once
+      @endcode
+
+      @ingroup Utility */
+  class MemoryResource
+  {
+    public:
+      virtual ~MemoryResource() {}
+
+      //! Allocates size bytes aligned to alignment, throwing std::bad_alloc on failure
+      virtual void * allocate( std::size_t size, std::size_t alignment ) = 0;
+
+      //! Returns memory previously given out by allocate with the same size and alignment
+      virtual void deallocate( void * ptr, std::size_t size, std::size_t alignment ) = 0;
+  };
+
+  // ######################################################################
+  //! A memory resource that hands out memory from large blocks and frees it all at once
+  /*! Allocation only advances a pointer into the current block and deallocation
+      does nothing, so loading many small objects is fast and does not fragment
+      the heap.  All memory is freed by release or when the arena is destroyed,
+      which must only happen after every object allocated from it has been
+      destroyed.
+
+      This class is not thread safe.
+
+      @ingroup Utility */
+  class MonotonicArena : public MemoryResource
+  {
+    public:
+      //! Construct an arena
+      /*! @param blockSize The size of the blocks requested from the global operator new */
+      explicit MonotonicArena( std::size_t blockSize = 64 * 1024 ) :
+        itsBlockSize( blockSize ),
+        itsCurrent( nullptr ),
+        itsEnd( nullptr ),
+        itsBlockBytes( 0 )
+      { }
+
+      MonotonicArena( MonotonicArena const & ) = delete;
+      MonotonicArena & operator=( MonotonicArena const & ) = delete;
+
+      ~MonotonicArena()
+      {
+        release();
+      }
+
+      void * allocate( std::size_t size, std::size_t alignment ) override
+      {
+        std::uintptr_t aligned = align( itsCurrent, alignment );
+
+        if( itsCurrent == nullptr || aligned + size > reinterpret_cast<std::uintptr_t>( itsEnd ) )
+        {
+          std::size_t const blockSize = size + alignment > itsBlockSize ? size + alignment : itsBlockSize;
+          itsBlocks.emplace_back( new char[blockSize] );
+          itsBlockBytes += blockSize;
+          itsCurrent = itsBlocks.back().get();
+          itsEnd = itsCurrent + blockSize;
+          aligned = align( itsCurrent, alignment );
+        }
+
+        itsCurrent = reinterpret_cast<char *>( aligned + size );
+        return reinterpret_cast<void *>( aligned );
+      }
+
+      void deallocate( void *, std::size_t, std::size_t ) override
+      { }
+
+      //! Frees all memory allocated from the arena
+      void release()
+      {
+        itsBlocks.clear();
+        itsCurrent = nullptr;
+        itsEnd = nullptr;
+        itsBlockBytes = 0;
+      }
+
+      //! Gets the total size of the blocks currently held by the arena
+      std::size_t blockBytes() const
+      {
+        return itsBlockBytes;
+      }
+
+    private:
+      //! Rounds ptr up to a multiple of alignment, which must be a power of two
+      static std::uintptr_t align( char * ptr, std::size_t alignment )
+      {
+        return ( reinterpret_cast<std::uintptr_t>( ptr ) + alignment - 1 ) & ~( std::uintptr_t( alignment ) - 1 );
+      }
+
+      std::size_t const itsBlockSize;
+      std::vector<std::unique_ptr<char[]>> itsBlocks;
+      char * itsCurrent; //!< next free byte in the last block
+      char * itsEnd;     //!< one past the end of the last block
+      std::size_t itsBlockBytes;
+  };
+
+  // ######################################################################
+  //! A standard allocator that allocates from a MemoryResource
+  /*! When the resource is null the global operator new is used.
+      @ingroup Utility */
+  template <class T>
+  class ResourceAllocator
+  {
+    public:
+      typedef T value_type;
+
+      template <class U>
+      struct rebind { typedef ResourceAllocator<U> other; };
+
+      ResourceAllocator( MemoryResource * resource = nullptr ) : itsResource( resource ) {}
+
+      template <class U>
+      ResourceAllocator( ResourceAllocator<U> const & other ) : itsResource( other.resource() ) {}
+
+      T * allocate( std::size_t n )
+      {
+        if( itsResource )
+          return static_cast<T *>( itsResource->allocate( n * sizeof(T), std::alignment_of<T>::value ) );
+        return static_cast<T *>( ::operator new( n * sizeof(T) ) );
+      }
+
+      void deallocate( T * ptr, std::size_t n )
+      {
+        if( itsResource )
+          itsResource->deallocate( ptr, n * sizeof(T), std::alignment_of<T>::value );
+        else
+          ::operator delete( ptr );
+      }
+
+      MemoryResource * resource() const
+      {
+        return itsResource;
+      }
+
+    private:
+      MemoryResource * itsResource;
+  };
+
+  template <class T, class U> inline
+  bool operator==( ResourceAllocator<T> const & a, ResourceAllocator<U> const & b )
+  { return a.resource() == b.resource(); }
+
+  template <class T, class U> inline
+  bool operator!=( ResourceAllocator<T> const & a, ResourceAllocator<U> const & b )
+  { return a.resource() != b.resource(); }
+
+  // ######################################################################
+  //! A deleter for std::unique_ptr that returns memory to the MemoryResource it came from
+  /*! When the resource is null the object is deleted with delete.
+      @ingroup Utility */
+  template <class T>
+  class ResourceDeleter
+  {
+    public:
+      ResourceDeleter( MemoryResource * resource = nullptr ) : itsResource( resource ) {}
+
+      void operator()( T * ptr ) const
+      {
+        if( !itsResource )
+        {
+          delete ptr;
+          return;
+        }
+
+        ptr->~T();
+        itsResource->deallocate( ptr, sizeof(T), std::alignment_of<T>::value );
+      }
+
+      MemoryResource * resource() const
+      {
+        return itsResource;
+      }
+
+    private:
+      MemoryResource * itsResource;
+  };
+
+  //! A std::unique_ptr whose object cereal allocates from the MemoryResource of the archive loading it
+  /*! @ingroup Utility */
+  template <class T>
+  using resource_unique_ptr = std::unique_ptr<T, ResourceDeleter<T>>;
+} // namespace cereal
+
+#endif // CEREAL_DETAILS_MEMORY_RESOURCE_HPP_
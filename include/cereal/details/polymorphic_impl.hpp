@@ -47,9 +47,12 @@
 #include <cereal/details/static_object.hpp>
 #include <cereal/types/memory.hpp>
 #include <cereal/types/string.hpp>
-#include <functional>
+#include <atomic>
+#include <mutex>
 #include <typeindex>
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 //! Binds a polymorhic type to all registered archives
 /*! This binds a polymorphic type to all compatible registered archives that
@@ -78,11 +81,24 @@ namespace cereal
     template <class T>
     struct binding_name {};
 
+    //! Binds a compile time type with a user defined numeric id
+    /*! The base case is for types registered without an id, which are
+        identified by their name alone.  See CEREAL_REGISTER_TYPE_WITH_ID */
+    template <class T>
+    struct binding_id
+    {
+      static const bool registered = false;
+      static std::uint32_t id() { return 0; }
+    };
+
     //! A structure holding a map from type_indices to output serializer functions
     /*! A static object of this map should be created for each registered archive
         type, containing entries for every registered type that describe how to
         properly cast the type to its real type in polymorphic scenarios for
-        shared_ptr, weak_ptr, and unique_ptr. */
+        shared_ptr, weak_ptr, and unique_ptr.
+
+        The map is hashed since it is only written during registration and read
+        on every polymorphic save. */
     template <class Archive>
     struct OutputBindingMap
     {
@@ -91,17 +107,25 @@ namespace cereal
           their first parameter (will be cast properly inside the function,
           and a pointer to actual data (contents of smart_ptr's get() function)
           as their second parameter */
-      typedef std::function<void(void*, void const *)> Serializer;
+      typedef void (*Serializer)(void*, void const *);
+
+      //! Types are identified by their type_index
+      typedef std::type_index Key;
 
       //! Struct containing the serializer functions for all pointer types
       struct Serializers
       {
         Serializer shared_ptr, //!< Serializer function for shared/weak pointers
                    unique_ptr; //!< Serializer function for unique pointers
+
+        //! Serializer functions for the parts of the above, used when many pointers share one type
+        Serializer metadata,        //!< Writes only the type metadata, ignoring the data pointer
+                   shared_ptr_data, //!< Writes a shared/weak pointer without its metadata
+                   unique_ptr_data; //!< Writes a unique pointer without its metadata
       };
 
       //! A map of serializers for pointers of all registered types
-      std::map<std::type_index, Serializers> map;
+      std::unordered_map<std::type_index, Serializers> map;
     };
 
     //! An empty noop deleter
@@ -111,7 +135,10 @@ namespace cereal
     /*! A static object of this map should be created for each registered archive
         type, containing entries for every registered type that describe how to
         properly cast the type to its real type in polymorphic scenarios for
-        shared_ptr, weak_ptr, and unique_ptr. */
+        shared_ptr, weak_ptr, and unique_ptr.
+
+        The map is hashed since it is only written during registration and read
+        on every polymorphic load. */
     template <class Archive>
     struct InputBindingMap
     {
@@ -121,25 +148,218 @@ namespace cereal
           and a shared_ptr (or unique_ptr for the unique case) of any base
           type.  Internally it will properly be loaded and cast to the
           correct type. */
-      typedef std::function<void(void*, std::shared_ptr<void> & )> SharedSerializer;
+      typedef void (*SharedSerializer)(void*, std::shared_ptr<void> &);
       //! Unique ptr serializer function
-      typedef std::function<void(void*, std::unique_ptr<void, EmptyDeleter<void>> & )> UniqueSerializer;
+      typedef void (*UniqueSerializer)(void*, std::unique_ptr<void, EmptyDeleter<void>> &);
+      //! Shared ptr serializer function loading into an existing object
+      /*! The pointer points to the most derived object.  It is replaced if the data
+          refers to an object loaded earlier. */
+      typedef void (*SharedInPlaceSerializer)(void*, std::shared_ptr<void> &);
+      //! Unique ptr serializer function loading into an existing object
+      /*! The pointer points to the most derived object.  Returns false if the data
+          holds a null pointer instead. */
+      typedef bool (*UniqueInPlaceSerializer)(void*, void*);
+
+      //! Types are identified by their registered name
+      typedef std::string Key;
 
       //! Struct containing the serializer functions for all pointer types
       struct Serializers
       {
         SharedSerializer shared_ptr; //!< Serializer function for shared/weak pointers
         UniqueSerializer unique_ptr; //!< Serializer function for unique pointers
+        std::type_info const * type; //!< The type loaded, null for null pointers
+        SharedInPlaceSerializer shared_ptr_in_place; //!< Null if the type cannot be loaded in place
+        UniqueInPlaceSerializer unique_ptr_in_place; //!< Null if the type cannot be loaded in place
       };
 
       //! A map of serializers for pointers of all registered types
-      std::map<std::string, Serializers> map;
+      std::unordered_map<std::string, Serializers> map;
+
+      //! Serializers and names of types registered with a numeric id, keyed by that id
+      std::unordered_map<std::uint32_t, std::pair<std::string, Serializers>> idMap;
     };
 
+    //! Holds the bindings of an archive so that they can be read while types are being registered
+    /*! Registering a type only records a function that will create its bindings.
+        The bindings for every type registered with an archive are created together
+        the first time that archive serializes a polymorphic pointer, and again
+        whenever new types have been registered since, for example by a shared
+        library loaded at run time.  This keeps static initialization cheap when
+        many types are registered with many archives.
+
+        Readers only ever see an immutable snapshot of the bindings, reached through
+        a single atomic load, so lookups never take a lock.  New bindings are added to
+        a copy of the current snapshot under a mutex, which is then published
+        atomically.  Superseded snapshots are kept alive for the life of the program
+        since a reader on another thread may still be using one; they are only made
+        when new types are registered, which is rare.
+
+        Registering a type that is already known costs a single set lookup, so
+        libraries registering overlapping types do not cause new snapshots.
+
+        @tparam Map Either InputBindingMap or OutputBindingMap */
+    template <class Map>
+    class BindingRegistry
+    {
+      public:
+        //! A function adding the bindings for one type
+        typedef void (*Creator)(Map &);
+
+        BindingRegistry() : itsCurrent( &itsEmpty ), itsHasPending( false ) {}
+
+        //! Records a creator to be run before the bindings are next read
+        /*! @param creator Adds the bindings for a type
+            @param key Identifies the type, see Map::Key
+            @return false if a creator was already recorded for the type, in which case
+                    this one is ignored */
+        bool defer( Creator creator, typename Map::Key const & key )
+        {
+          std::lock_guard<std::mutex> lock( itsMutex );
+          if( !itsKeys.insert( key ).second )
+            return false;
+
+          itsPending.push_back( creator );
+          itsHasPending.store( true, std::memory_order_release );
+          return true;
+        }
+
+        //! Gets the current bindings, first creating any that are pending
+        Map const & get()
+        {
+          if( itsHasPending.load( std::memory_order_acquire ) )
+            update();
+          return *itsCurrent.load( std::memory_order_acquire );
+        }
+
+      private:
+        //! Publishes a new snapshot including all pending bindings
+        void update()
+        {
+          std::lock_guard<std::mutex> lock( itsMutex );
+          if( itsPending.empty() )
+            return;
+
+          std::unique_ptr<Map> next( new Map( *itsCurrent.load( std::memory_order_relaxed ) ) );
+          for( auto create : itsPending )
+            create( *next );
+
+          itsPending.clear();
+          itsHasPending.store( false, std::memory_order_relaxed );
+          itsCurrent.store( next.get(), std::memory_order_release );
+          itsSnapshots.push_back( std::move( next ) );
+        }
+
+        Map const itsEmpty;
+        std::atomic<Map const *> itsCurrent;              //!< the snapshot readers use
+        std::atomic<bool> itsHasPending;                  //!< whether itsPending is non empty
+        std::mutex itsMutex;                              //!< guards everything below
+        std::vector<Creator> itsPending;                  //!< creators that have not been run yet
+        std::unordered_set<typename Map::Key> itsKeys;    //!< the types of every creator recorded
+        std::vector<std::unique_ptr<Map const>> itsSnapshots; //!< every snapshot ever published
+    };
+
+    #ifdef CEREAL_SHARED_BINDING_REGISTRY
+    //! The binding registries of every archive, shared by all libraries in a process
+    /*! Normally each shared library has its own registries, which on some platforms
+        are merged by the dynamic linker and on others are not.  When
+        CEREAL_SHARED_BINDING_REGISTRY is defined, a single instance of this class,
+        defined with CEREAL_DEFINE_SHARED_BINDING_REGISTRY in one library, holds the
+        registries for all of them.  See CEREAL_DEFINE_SHARED_BINDING_REGISTRY */
+    class SharedBindingRegistries
+    {
+      public:
+        //! Gets the registry for a map type, creating it if this is the first request for it
+        void * get( std::type_index const & map, void * (*create)() )
+        {
+          std::lock_guard<std::mutex> lock( itsMutex );
+          auto & registry = itsRegistries[map];
+          if( !registry )
+            registry = create();
+          return registry;
+        }
+
+      private:
+        std::mutex itsMutex;
+        std::unordered_map<std::type_index, void *> itsRegistries; //!< never freed, as libraries may outlive it
+    };
+
+    //! Gets the shared registries, defined by CEREAL_DEFINE_SHARED_BINDING_REGISTRY
+    CEREAL_SHARED_BINDING_REGISTRY_API SharedBindingRegistries & getSharedBindingRegistries();
+    #endif // CEREAL_SHARED_BINDING_REGISTRY
+
+    //! Gets the registry holding the bindings for an archive, see BindingRegistry
+    /*! @tparam Map Either InputBindingMap or OutputBindingMap */
+    template <class Map> inline
+    BindingRegistry<Map> & getBindingRegistry()
+    {
+      #ifdef CEREAL_SHARED_BINDING_REGISTRY
+      // Looked up once per library, after which no lock is taken
+      static BindingRegistry<Map> & registry = *static_cast<BindingRegistry<Map> *>(
+          getSharedBindingRegistries().get( typeid(Map), []() -> void * { return new BindingRegistry<Map>(); } ) );
+      return registry;
+      #else // NOT CEREAL_SHARED_BINDING_REGISTRY
+      return StaticObject<BindingRegistry<Map>>::getInstance();
+      #endif // CEREAL_SHARED_BINDING_REGISTRY
+    }
+
+    //! Gets the bindings for an archive, see BindingRegistry
+    /*! @tparam Map Either InputBindingMap or OutputBindingMap */
+    template <class Map> inline
+    Map const & getBindingMap()
+    {
+      return getBindingRegistry<Map>().get();
+    }
+
     // forward decls for archives from cereal.hpp
     class InputArchiveBase;
     class OutputArchiveBase;
 
+    //! Sets the serializers that load into existing objects of a polymorphic type, see in_place
+    /*! @internal */
+    template <class Archive, class T, bool Loadable = traits::is_input_serializable<T, Archive>::value>
+    struct InPlaceInputSerializers
+    {
+      static void set( typename InputBindingMap<Archive>::Serializers & serializers )
+      {
+        serializers.shared_ptr_in_place =
+          [](void * arptr, std::shared_ptr<void> & dptr)
+          {
+            Archive & ar = *static_cast<Archive*>(arptr);
+            std::shared_ptr<T> ptr = std::static_pointer_cast<T>(dptr);
+
+            ::cereal::memory_detail::InPlacePtrWrapper<std::shared_ptr<T>> wrapper( ptr );
+            ar( CEREAL_NVP_("ptr_wrapper", wrapper) );
+
+            dptr = ptr;
+          };
+
+        serializers.unique_ptr_in_place =
+          [](void * arptr, void * object)
+          {
+            Archive & ar = *static_cast<Archive*>(arptr);
+            std::unique_ptr<T, EmptyDeleter<T>> ptr( static_cast<T*>(object) );
+
+            ::cereal::memory_detail::InPlacePtrWrapper<std::unique_ptr<T, EmptyDeleter<T>>> wrapper( ptr );
+            ar( CEREAL_NVP_("ptr_wrapper", wrapper) );
+
+            return static_cast<bool>( ptr );
+          };
+      }
+    };
+
+    //! Types only loaded by load_and_construct are never loaded in place
+    /*! @internal */
+    template <class Archive, class T>
+    struct InPlaceInputSerializers<Archive, T, false>
+    {
+      static void set( typename InputBindingMap<Archive>::Serializers & serializers )
+      {
+        serializers.shared_ptr_in_place = nullptr;
+        serializers.unique_ptr_in_place = nullptr;
+      }
+    };
+
     //! Creates a binding (map entry) between an input archive type and a polymorphic type
     /*! Bindings are made when types are registered, assuming that at least one
         archive has already been registered.  When this struct is created,
@@ -147,14 +367,19 @@ namespace cereal
         casting for serializing polymorphic objects */
     template <class Archive, class T> struct InputBindingCreator
     {
-      //! Initialize the binding
-      InputBindingCreator()
+      //! Identifies the type in InputBindingMap
+      static typename InputBindingMap<Archive>::Key key()
+      {
+        return binding_name<T>::name();
+      }
+
+      //! Adds the binding to the bindings of an archive
+      static void create( InputBindingMap<Archive> & bindings )
       {
-        auto & map = StaticObject<InputBindingMap<Archive>>::getInstance().map;
+        auto & map = bindings.map;
         auto key = std::string(binding_name<T>::name());
-        auto lb = map.lower_bound(key);
 
-        if (lb != map.end() && lb->first == key)
+        if (map.find(key) != map.end())
           return;
 
         typename InputBindingMap<Archive>::Serializers serializers;
@@ -181,7 +406,22 @@ namespace cereal
             dptr.reset(ptr.release());
           };
 
-        map.insert( lb, { std::move(key), std::move(serializers) } );
+        serializers.type = &typeid(T);
+        InPlaceInputSerializers<Archive, T>::set( serializers );
+
+        if( binding_id<T>::registered )
+        {
+          auto const id = binding_id<T>::id();
+          auto & idMap = bindings.idMap;
+          auto existing = idMap.find( id );
+          if( existing != idMap.end() && existing->second.first != key )
+            throw Exception("Polymorphic type id " + std::to_string(id) + " is registered for both " +
+                            existing->second.first + " and " + key);
+
+          idMap.insert( { id, { key, serializers } } );
+        }
+
+        map.insert( { std::move(key), serializers } );
       }
     };
 
@@ -192,9 +432,24 @@ namespace cereal
         casting for serializing polymorphic objects */
     template <class Archive, class T> struct OutputBindingCreator
     {
+      //! Identifies the type in OutputBindingMap
+      static typename OutputBindingMap<Archive>::Key key()
+      {
+        return std::type_index(typeid(T));
+      }
+
       //! Writes appropriate metadata to the archive for this polymorphic type
       static void writeMetadata(Archive & ar)
       {
+        // Types with a numeric id are identified by it alone, except in text archives
+        // where the name is kept for readability
+        if( binding_id<T>::registered && !traits::is_text_archive<Archive>::value )
+        {
+          std::uint32_t const id = binding_id<T>::id() | detail::msb3_32bit;
+          ar( CEREAL_NVP_("polymorphic_id", id) );
+          return;
+        }
+
         // Register the polymorphic type name with the archive, and get the id
         char const * name = binding_name<T>::name();
         std::uint32_t id = ar.registerPolymorphicType(name);
@@ -275,20 +530,19 @@ namespace cereal
         ar( CEREAL_NVP_("ptr_wrapper", memory_detail::make_ptr_wrapper( psptr() ) ) );
       }
 
-      //! Initialize the binding
-      OutputBindingCreator()
+      //! Adds the binding to the bindings of an archive
+      static void create( OutputBindingMap<Archive> & bindings )
       {
-        auto & map = StaticObject<OutputBindingMap<Archive>>::getInstance().map;
+        auto & map = bindings.map;
         auto key = std::type_index(typeid(T));
-        auto lb = map.lower_bound(key);
 
-        if (lb != map.end() && lb->first == key)
+        if (map.find(key) != map.end())
           return;
 
         typename OutputBindingMap<Archive>::Serializers serializers;
 
         serializers.shared_ptr =
-          [&](void * arptr, void const * dptr)
+          [](void * arptr, void const * dptr)
           {
             Archive & ar = *static_cast<Archive*>(arptr);
 
@@ -302,7 +556,7 @@ namespace cereal
           };
 
         serializers.unique_ptr =
-          [&](void * arptr, void const * dptr)
+          [](void * arptr, void const * dptr)
           {
             Archive & ar = *static_cast<Archive*>(arptr);
 
@@ -313,7 +567,33 @@ namespace cereal
             ar( CEREAL_NVP_("ptr_wrapper", memory_detail::make_ptr_wrapper(ptr)) );
           };
 
-        map.insert( { std::move(key), std::move(serializers) } );
+        serializers.metadata =
+          [](void * arptr, void const *)
+          {
+            writeMetadata(*static_cast<Archive*>(arptr));
+          };
+
+        serializers.shared_ptr_data =
+          [](void * arptr, void const * dptr)
+          {
+            Archive & ar = *static_cast<Archive*>(arptr);
+
+            #ifdef _MSC_VER
+            savePolymorphicSharedPtr( ar, dptr, ::cereal::traits::has_shared_from_this<T>::type() ); // MSVC doesn't like typename here
+            #else // not _MSC_VER
+            savePolymorphicSharedPtr( ar, dptr, typename ::cereal::traits::has_shared_from_this<T>::type() );
+            #endif // _MSC_VER
+          };
+
+        serializers.unique_ptr_data =
+          [](void * arptr, void const * dptr)
+          {
+            Archive & ar = *static_cast<Archive*>(arptr);
+            std::unique_ptr<T const, EmptyDeleter<T const>> const ptr(static_cast<T const *>(dptr));
+            ar( CEREAL_NVP_("ptr_wrapper", memory_detail::make_ptr_wrapper(ptr)) );
+          };
+
+        map.insert( { std::move(key), serializers } );
       }
     };
 
@@ -325,20 +605,32 @@ namespace cereal
     //! namespace it becomes a different type in each translation unit.
     namespace { struct polymorphic_binding_tag {}; }
 
+    //! Records that a binding between an archive type and a polymorphic type should be created
+    /*! A static object of this is made for every registered type and archive.  All it does
+        is add a function to the archive's pending bindings, see BindingRegistry */
+    template <class Map, class Creator>
+    struct DeferredBinding
+    {
+      DeferredBinding()
+      {
+        getBindingRegistry<Map>().defer( &Creator::create, Creator::key() );
+      }
+    };
+
     //! Causes the static object bindings between an archive type and a serializable type T
     template <class Archive, class T>
     struct create_bindings
     {
-      static const InputBindingCreator<Archive, T> &
+      static const DeferredBinding<InputBindingMap<Archive>, InputBindingCreator<Archive, T>> &
       load(std::true_type)
       {
-        return cereal::detail::StaticObject<InputBindingCreator<Archive, T>>::getInstance();
+        return cereal::detail::StaticObject<DeferredBinding<InputBindingMap<Archive>, InputBindingCreator<Archive, T>>>::getInstance();
       }
 
-      static const OutputBindingCreator<Archive, T> &
+      static const DeferredBinding<OutputBindingMap<Archive>, OutputBindingCreator<Archive, T>> &
       save(std::true_type)
       {
-        return cereal::detail::StaticObject<OutputBindingCreator<Archive, T>>::getInstance();
+        return cereal::detail::StaticObject<DeferredBinding<OutputBindingMap<Archive>, OutputBindingCreator<Archive, T>>>::getInstance();
       }
 
       inline static void load(std::false_type) {}
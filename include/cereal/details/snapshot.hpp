@@ -0,0 +1,394 @@
+/*! \file snapshot.hpp
+    \brief Incremental snapshots of graphs of shared objects
+    \ingroup OtherTypes */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_SNAPSHOT_HPP_
+#define CEREAL_DETAILS_SNAPSHOT_HPP_
+
+#include <cereal/details/helpers.hpp>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace cereal
+{
+  // ######################################################################
+  //! A base class for objects whose changes are tracked by incremental snapshots
+  /*! Objects deriving from SnapshotTracked and owned by std::shared_ptr are
+      written by a SnapshotWriter only when markChanged has been called on them
+      since the previous snapshot.  Anything else they hold, such as containers or
+      pointers to other objects, counts as part of them, so markChanged must be
+      called whenever any of it changes.
+
+      Outside of a snapshot, tracked objects are serialized as usual.
+
+      @ingroup Utility */
+  class SnapshotTracked
+  {
+    public:
+      //! Records that this object changed since the last snapshot it was written to
+      void markChanged() { ++itsSnapshotVersion; }
+
+    protected:
+      SnapshotTracked() : itsSnapshotVersion( 0 ) {}
+
+    private:
+      template <class> friend class SnapshotWriter;
+
+      std::uint64_t itsSnapshotVersion; //!< Incremented by every markChanged
+  };
+
+  namespace snapshot_detail
+  {
+    //! Whether a type is tracked by incremental snapshots
+    /*! @internal */
+    template <class T>
+    struct is_tracked : std::is_base_of<SnapshotTracked, typename std::remove_const<T>::type> {};
+
+    //! Saves the data of a tracked object, which is at least as derived as T
+    /*! @internal */
+    template <class Archive, class T> inline
+    void save_object( Archive & ar, void const * object )
+    {
+      ar( CEREAL_NVP_("data", *static_cast<T const *>( object )) );
+    }
+
+    //! Loads the data of a tracked object in place
+    /*! @internal */
+    template <class Archive, class T> inline
+    void load_object( Archive & ar, void * object )
+    {
+      ar( CEREAL_NVP_("data", *static_cast<T *>( object )) );
+    }
+
+    //! Attaches a snapshot writer or reader to an archive for as long as it exists
+    /*! @internal */
+    template <class Archive, class Snapshot>
+    class ScopedSnapshot
+    {
+      public:
+        ScopedSnapshot( Archive & ar, Snapshot * snapshot ) : itsArchive( ar ) { ar.setSnapshot( snapshot ); }
+        ~ScopedSnapshot() { itsArchive.setSnapshot( static_cast<Snapshot *>( nullptr ) ); }
+
+      private:
+        Archive & itsArchive;
+    };
+  } // namespace snapshot_detail
+
+  // ######################################################################
+  //! Writes a chain of snapshots of a graph of shared objects, each holding only what changed
+  /*! The first snapshot written is a full one.  Every later one holds only the
+      SnapshotTracked objects that were created or marked as changed since the one
+      before it, and refers to the others by an id that stays the same across the
+      chain.  Loading the chain in order with a SnapshotReader rebuilds the graph
+      as it was when the last snapshot was written.
+
+      Everything that is not a tracked object, including the data passed to save
+      itself, is written in full every time, and each pointer to an unchanged tracked
+      object costs a reference.  A graph held as tracked objects therefore costs in
+      proportion to how much of it changes.  Changed objects that the data no longer
+      reaches through changed objects are found from the writer's record of every
+      tracked object, and objects that no longer exist are recorded as removed.
+
+      @code{.cpp}
+      struct Node : cereal::SnapshotTracked
+      {
+        std::vector<std::shared_ptr<Node>> children;
+        std::string label;
+
+        template <class Archive>
+        void serialize( Archive & ar ) { ar( children, label ); }
+      };
+
+      cereal::SnapshotWriter<cereal::BinaryOutputArchive> writer;
+      for( int i = 0; ; ++i )
+      {
+        std::ofstream os( "checkpoint" + std::to_string( i ), std::ios::binary );
+        cereal::BinaryOutputArchive ar( os );
+        writer.save( ar, root );
+
+        // ... change the graph, calling markChanged on the nodes that change
+      }
+
+      cereal::SnapshotReader<cereal::BinaryInputArchive> reader;
+      std::shared_ptr<Node> root;
+      for( int i = 0; i < count; ++i )
+      {
+        std::ifstream is( "checkpoint" + std::to_string( i ), std::ios::binary );
+        cereal::BinaryInputArchive ar( is );
+        reader.load( ar, root );
+      }
+      @endcode
+
+      Each snapshot must be saved to an archive of its own.  Tracked types cannot use
+      load_and_construct, since their data is loaded into the existing objects.  A
+      writer is not thread safe, and objects must not change while being saved.
+
+      @tparam Archive The output archive type snapshots are written with */
+  template <class Archive>
+  class SnapshotWriter
+  {
+    public:
+      SnapshotWriter() : itsNextId( 1 ), itsSequence( 0 ) {}
+
+      SnapshotWriter( SnapshotWriter const & ) = delete;
+      SnapshotWriter & operator=( SnapshotWriter const & ) = delete;
+
+      //! Writes the next snapshot of the chain
+      /*! If this throws, the next snapshot will be a full one, as after rebase.
+          @param ar A newly constructed or reset archive
+          @param args The data to save, which is written in full */
+      template <class ... Types> inline
+      void save( Archive & ar, Types && ... args )
+      {
+        try
+        {
+          snapshot_detail::ScopedSnapshot<Archive, SnapshotWriter> scope( ar, this );
+          ar( CEREAL_NVP_("snapshot", itsSequence) );
+          ar( std::forward<Types>( args )... );
+          saveUnreached( ar );
+        }
+        catch( ... )
+        {
+          rebase();
+          throw;
+        }
+
+        ++itsSequence;
+      }
+
+      //! Starts a new chain, so that the next snapshot is a full one
+      void rebase()
+      {
+        itsEntries.clear();
+        itsRemoved.clear();
+        itsNextId = 1;
+        itsSequence = 0;
+      }
+
+      //! The number of snapshots written since construction or the last rebase
+      std::uint64_t sequence() const { return itsSequence; }
+
+      //! Saves a tracked object when it is first seen in a snapshot
+      /*! @internal */
+      template <class T> inline
+      void saveObject( Archive & ar, std::shared_ptr<T> const & ptr )
+      {
+        using Element = typename std::remove_const<T>::type;
+        SnapshotTracked const & tracked = *ptr;
+
+        auto & entry = itsEntries[ptr.get()];
+        bool changed = true;
+        if( entry.id != 0 && !entry.object.expired() )
+          changed = entry.version != tracked.itsSnapshotVersion;
+        else
+        {
+          // A new object, possibly at the address of one that was destroyed
+          if( entry.id != 0 )
+            itsRemoved.push_back( entry.id );
+
+          entry.object = ptr;
+          entry.tracked = &tracked;
+          entry.save = &snapshot_detail::save_object<Archive, Element>;
+          entry.id = itsNextId++;
+        }
+
+        entry.version = tracked.itsSnapshotVersion;
+        entry.sequence = itsSequence;
+
+        ar( CEREAL_NVP_("snapshot_id", entry.id) );
+        ar( CEREAL_NVP_("changed", changed) );
+        if( changed )
+          ar( CEREAL_NVP_("data", *ptr) );
+      }
+
+    private:
+      //! Saves changed objects that were not reached, terminated by an id of 0, then removed ids likewise
+      void saveUnreached( Archive & ar )
+      {
+        std::vector<Entry *> pending;
+        for( auto it = itsEntries.begin(); it != itsEntries.end(); )
+        {
+          if( it->second.object.expired() )
+          {
+            itsRemoved.push_back( it->second.id );
+            it = itsEntries.erase( it );
+            continue;
+          }
+
+          if( it->second.sequence != itsSequence && it->second.version != it->second.tracked->itsSnapshotVersion )
+            pending.push_back( &it->second );
+          ++it;
+        }
+
+        for( auto entry : pending )
+        {
+          // Saving earlier entries may have reached this one
+          if( entry->sequence == itsSequence )
+            continue;
+
+          auto const object = entry->object.lock();
+          entry->version = entry->tracked->itsSnapshotVersion;
+          entry->sequence = itsSequence;
+
+          ar( CEREAL_NVP_("snapshot_id", entry->id) );
+          entry->save( ar, object.get() );
+        }
+        ar( CEREAL_NVP_("snapshot_id", std::uint64_t( 0 )) );
+
+        for( auto id : itsRemoved )
+          ar( CEREAL_NVP_("removed", id) );
+        ar( CEREAL_NVP_("removed", std::uint64_t( 0 )) );
+        itsRemoved.clear();
+      }
+
+      //! What the writer knows about a tracked object
+      struct Entry
+      {
+        Entry() : tracked( nullptr ), save( nullptr ), id( 0 ), version( 0 ), sequence( 0 ) {}
+
+        std::weak_ptr<void const> object;            //!< Tells whether the object still exists
+        SnapshotTracked const * tracked;             //!< The object, valid while it exists
+        void (*save)( Archive &, void const * );     //!< Saves the data of the object
+        std::uint64_t id;                            //!< The id of the object across the chain
+        std::uint64_t version;                       //!< The version of the object when it was last written
+        std::uint64_t sequence;                      //!< The last snapshot the object was seen in
+      };
+
+      std::unordered_map<void const *, Entry> itsEntries; //!< Every tracked object written in the chain, by address
+      std::vector<std::uint64_t> itsRemoved;              //!< Ids of objects destroyed since the last snapshot
+      std::uint64_t itsNextId;                            //!< The id given to the next new object
+      std::uint64_t itsSequence;                          //!< The number of the next snapshot in the chain
+  };
+
+  // ######################################################################
+  //! Loads a chain of snapshots written by a SnapshotWriter
+  /*! Snapshots must be loaded in the order they were written, starting from a full
+      one.  Each one is loaded over the objects of those before it: objects that
+      changed are loaded in place, so every pointer to them stays valid, and the
+      data passed to load is loaded as usual.
+
+      The reader keeps every tracked object alive until a later snapshot records
+      that it was removed, or the next full snapshot is loaded.
+
+      @tparam Archive The input archive type snapshots are read with */
+  template <class Archive>
+  class SnapshotReader
+  {
+    public:
+      SnapshotReader() : itsSequence( 0 ) {}
+
+      SnapshotReader( SnapshotReader const & ) = delete;
+      SnapshotReader & operator=( SnapshotReader const & ) = delete;
+
+      //! Loads the next snapshot of the chain
+      /*! If this throws, the next snapshot loaded must be a full one.
+          @param ar A newly constructed or reset archive
+          @param args The data to load
+          @throws Exception if the snapshot does not follow the last one loaded */
+      template <class ... Types> inline
+      void load( Archive & ar, Types && ... args )
+      {
+        std::uint64_t sequence;
+        ar( CEREAL_NVP_("snapshot", sequence) );
+
+        if( sequence == 0 )
+          itsObjects.clear();
+        else if( sequence != itsSequence )
+          throw Exception("Snapshot " + std::to_string( sequence ) + " does not follow the last snapshot loaded, expected " +
+                          ( itsSequence ? std::to_string( itsSequence ) : std::string("a full snapshot") ));
+
+        itsSequence = 0;
+
+        snapshot_detail::ScopedSnapshot<Archive, SnapshotReader> scope( ar, this );
+        ar( std::forward<Types>( args )... );
+
+        std::uint64_t id;
+        for( ar( CEREAL_NVP_("snapshot_id", id) ); id != 0; ar( CEREAL_NVP_("snapshot_id", id) ) )
+        {
+          auto const & entry = find( id );
+          entry.load( ar, entry.object.get() );
+        }
+
+        for( ar( CEREAL_NVP_("removed", id) ); id != 0; ar( CEREAL_NVP_("removed", id) ) )
+          itsObjects.erase( id );
+
+        itsSequence = sequence + 1;
+      }
+
+      //! Starts over, so that the next snapshot loaded must be a full one
+      void clear()
+      {
+        itsObjects.clear();
+        itsSequence = 0;
+      }
+
+      //! The number of tracked objects currently held
+      std::size_t size() const { return itsObjects.size(); }
+
+      //! Gets a tracked object loaded by an earlier snapshot, or nullptr
+      /*! @internal */
+      std::shared_ptr<void> getObject( std::uint64_t id ) const
+      {
+        auto const it = itsObjects.find( id );
+        return it != itsObjects.end() ? it->second.object : std::shared_ptr<void>();
+      }
+
+      //! Records a tracked object created by the snapshot being loaded
+      /*! @internal */
+      template <class T> inline
+      void addObject( std::uint64_t id, std::shared_ptr<T> const & ptr )
+      {
+        auto & entry = itsObjects[id];
+        entry.object = ptr;
+        entry.load = &snapshot_detail::load_object<Archive, T>;
+      }
+
+    private:
+      //! What the reader holds for a tracked object
+      struct Entry
+      {
+        std::shared_ptr<void> object;          //!< The object
+        void (*load)( Archive &, void * );     //!< Loads the data of the object in place
+      };
+
+      Entry const & find( std::uint64_t id ) const
+      {
+        auto const it = itsObjects.find( id );
+        if( it == itsObjects.end() )
+          throw Exception("Snapshot refers to object " + std::to_string( id ) + ", which is not in the snapshots before it");
+        return it->second;
+      }
+
+      std::unordered_map<std::uint64_t, Entry> itsObjects; //!< Every tracked object loaded, by id
+      std::uint64_t itsSequence;                          //!< The number of the next snapshot expected, 0 if a full one
+  };
+} // namespace cereal
+
+#endif // CEREAL_DETAILS_SNAPSHOT_HPP_
@@ -46,6 +46,17 @@
 #   define CEREAL_USED __attribute__ ((__used__))
 #endif
 
+//! Exports the shared binding registry from the library defining it, see CEREAL_DEFINE_SHARED_BINDING_REGISTRY
+#ifdef _MSC_VER
+#   ifdef CEREAL_SHARED_BINDING_REGISTRY_EXPORTS
+#     define CEREAL_SHARED_BINDING_REGISTRY_API __declspec(dllexport)
+#   else
+#     define CEREAL_SHARED_BINDING_REGISTRY_API __declspec(dllimport)
+#   endif
+#else // clang or gcc
+#   define CEREAL_SHARED_BINDING_REGISTRY_API __attribute__ ((visibility("default")))
+#endif
+
 namespace cereal
 {
   namespace detail
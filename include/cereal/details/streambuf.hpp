@@ -0,0 +1,79 @@
+/*! \file streambuf.hpp
+    \brief Stream buffers over memory, for archives that serialize into buffers of their own
+    \ingroup Internal */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_STREAMBUF_HPP_
+#define CEREAL_DETAILS_STREAMBUF_HPP_
+
+#include <streambuf>
+#include <string>
+
+namespace cereal
+{
+  namespace streambuf_detail
+  {
+    //! A stream buffer that appends everything written to it to a string
+    /*! @internal */
+    class StringWriteBuffer : public std::streambuf
+    {
+      public:
+        StringWriteBuffer( std::string & str ) : itsString( str ) {}
+
+      protected:
+        std::streamsize xsputn( const char * s, std::streamsize n ) override
+        {
+          itsString.append( s, static_cast<std::size_t>( n ) );
+          return n;
+        }
+
+        int_type overflow( int_type c ) override
+        {
+          if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+            itsString.push_back( traits_type::to_char_type( c ) );
+          return traits_type::not_eof( c );
+        }
+
+      private:
+        std::string & itsString;
+    };
+
+    //! A stream buffer that reads from a block of memory without copying it
+    /*! @internal */
+    class MemoryReadBuffer : public std::streambuf
+    {
+      public:
+        MemoryReadBuffer( const char * data, std::size_t size )
+        {
+          auto const begin = const_cast<char *>( data );
+          setg( begin, begin, begin + size );
+        }
+    };
+  } // namespace streambuf_detail
+} // namespace cereal
+
+#endif // CEREAL_DETAILS_STREAMBUF_HPP_
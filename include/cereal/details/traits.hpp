@@ -1062,6 +1062,97 @@ namespace cereal
     struct is_input_serializable : std::integral_constant<bool,
       detail::count_input_serializers<T, InputArchive>::value == 1> {};
 
+    // ######################################################################
+    //! The serialization functions an archive uses for a type
+    /*! Chosen once per type and archive by output_kind and input_kind */
+    enum class serialization_kind
+    {
+      invalid,  //!< No usable serialization functions, or an ambiguous set of them
+      empty,    //!< An empty class with no serialization functions, which is elided
+      member_serialize, non_member_serialize,
+      member_split, non_member_split,
+      member_minimal, non_member_minimal,
+      member_versioned_serialize, non_member_versioned_serialize,
+      member_versioned_split, non_member_versioned_split,
+      member_versioned_minimal, non_member_versioned_minimal
+    };
+
+    //! Selects a kind if the serialization function name is the one in use
+    /*! A function is in use if the type has it, is serializable at all, and it is the
+        specialized function or there is no specialization
+        @internal */
+    #define CEREAL_SELECT_KIND(name, kind)                                                         \
+      (serializable && has_##name<T, A>::value &&                                                  \
+       (is_specialized_##name<T, A>::value || !specialized)) ? serialization_kind::kind :
+
+    //! The serialization kind an output archive uses for a type
+    /*! OutputArchive dispatches on this instead of testing every kind of
+        serialization function in a separate overload, so the traits for each
+        type are only evaluated once.
+
+        @tparam T The type being saved
+        @tparam A The output archive
+        @tparam Elision Whether the archive allows empty class elision */
+    template <class T, class A, bool Elision>
+    class output_kind
+    {
+      private:
+        static const bool serializable = is_output_serializable<T, A>::value;
+        static const bool specialized = is_specialized<T, A>::value;
+
+      public:
+        static const serialization_kind value =
+          has_invalid_output_versioning<T, A>::value ? serialization_kind::invalid :
+          CEREAL_SELECT_KIND(member_serialize, member_serialize)
+          CEREAL_SELECT_KIND(non_member_serialize, non_member_serialize)
+          CEREAL_SELECT_KIND(member_save, member_split)
+          CEREAL_SELECT_KIND(non_member_save, non_member_split)
+          CEREAL_SELECT_KIND(member_save_minimal, member_minimal)
+          CEREAL_SELECT_KIND(non_member_save_minimal, non_member_minimal)
+          CEREAL_SELECT_KIND(member_versioned_serialize, member_versioned_serialize)
+          CEREAL_SELECT_KIND(non_member_versioned_serialize, non_member_versioned_serialize)
+          CEREAL_SELECT_KIND(member_versioned_save, member_versioned_split)
+          CEREAL_SELECT_KIND(non_member_versioned_save, non_member_versioned_split)
+          CEREAL_SELECT_KIND(member_versioned_save_minimal, member_versioned_minimal)
+          CEREAL_SELECT_KIND(non_member_versioned_save_minimal, non_member_versioned_minimal)
+          (Elision && !serializable && std::is_empty<T>::value) ? serialization_kind::empty : serialization_kind::invalid;
+
+        //! The tag to dispatch on
+        using type = std::integral_constant<serialization_kind, value>;
+    };
+
+    //! The serialization kind an input archive uses for a type
+    /*! \sa output_kind */
+    template <class T, class A, bool Elision>
+    class input_kind
+    {
+      private:
+        static const bool serializable = is_input_serializable<T, A>::value;
+        static const bool specialized = is_specialized<T, A>::value;
+
+      public:
+        static const serialization_kind value =
+          has_invalid_input_versioning<T, A>::value ? serialization_kind::invalid :
+          CEREAL_SELECT_KIND(member_serialize, member_serialize)
+          CEREAL_SELECT_KIND(non_member_serialize, non_member_serialize)
+          CEREAL_SELECT_KIND(member_load, member_split)
+          CEREAL_SELECT_KIND(non_member_load, non_member_split)
+          CEREAL_SELECT_KIND(member_load_minimal, member_minimal)
+          CEREAL_SELECT_KIND(non_member_load_minimal, non_member_minimal)
+          CEREAL_SELECT_KIND(member_versioned_serialize, member_versioned_serialize)
+          CEREAL_SELECT_KIND(non_member_versioned_serialize, non_member_versioned_serialize)
+          CEREAL_SELECT_KIND(member_versioned_load, member_versioned_split)
+          CEREAL_SELECT_KIND(non_member_versioned_load, non_member_versioned_split)
+          CEREAL_SELECT_KIND(member_versioned_load_minimal, member_versioned_minimal)
+          CEREAL_SELECT_KIND(non_member_versioned_load_minimal, non_member_versioned_minimal)
+          (Elision && !serializable && std::is_empty<T>::value) ? serialization_kind::empty : serialization_kind::invalid;
+
+        //! The tag to dispatch on
+        using type = std::integral_constant<serialization_kind, value>;
+    };
+
+    #undef CEREAL_SELECT_KIND
+
     // ######################################################################
     // Base Class Support
     namespace detail
@@ -1260,6 +1351,170 @@ namespace cereal
     #define CEREAL_ARCHIVE_RESTRICT(INTYPE, OUTTYPE) \
     typename std::enable_if<cereal::traits::is_same_archive<Archive, INTYPE>::value || cereal::traits::is_same_archive<Archive, OUTTYPE>::value, void>::type
 
+    // ######################################################################
+    namespace detail
+    {
+      //! Checks if a type can be safely copied with memcpy
+      /*! Older versions of libstdc++ do not provide std::is_trivially_copyable */
+      template <class T>
+      struct is_trivially_copyable : std::integral_constant<bool,
+      #if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 5
+        __has_trivial_copy(T)
+      #else
+        std::is_trivially_copyable<T>::value
+      #endif
+      > {};
+    }
+
+    //! Checks if a type may be serialized by copying its bytes
+    /*! Containers of types satisfying this trait will be serialized as a single
+        block of binary data by archives that support it (see BinaryData), instead
+        of serializing each element individually.  This is true for all arithmetic
+        types, for enums, and for std::complex of arithmetic types when its header is
+        included, and can be enabled for other types with CEREAL_TRIVIALLY_SERIALIZABLE.
+
+        Note that std::vector<bool> is never treated this way. */
+    template <class T, class SFINAE = void>
+    struct is_trivially_serializable : std::integral_constant<bool, std::is_arithmetic<T>::value> {};
+
+    //! Marks a type as able to be serialized by copying its bytes
+    /*! This allows containers of a trivially copyable user type, such as a
+        std::vector of some plain struct, to be written and read with a single
+        memcpy by binary archives instead of serializing each element's members in
+        turn.  The type must still provide a normal serialization function, which
+        is used when it is serialized individually or by archives that do not
+        support binary data, such as JSON and XML.
+
+        Since the in-memory representation is written directly, any padding
+        inside the type is written as well, and the data will only be readable
+        on a machine with identical layout and endianness.  This is ignored by
+        PortableBinaryOutputArchive, which cannot byte swap arbitrary types.
+
+        This macro should be placed at global scope.
+
+        @code{.cpp}
+        struct Point { float x, y, z;
+                       template <class Archive> void serialize( Archive & ar ) { ar( x, y, z ); } };
+        CEREAL_TRIVIALLY_SERIALIZABLE( Point )
+        @endcode */
+    #define CEREAL_TRIVIALLY_SERIALIZABLE(TYPE)                                              \
+    namespace cereal { namespace traits {                                                    \
+      template <> struct is_trivially_serializable<TYPE> : std::true_type                    \
+      {                                                                                      \
+        static_assert( ::cereal::traits::detail::is_trivially_copyable<TYPE>::value,         \
+                       "CEREAL_TRIVIALLY_SERIALIZABLE requires a trivially copyable type" ); \
+      }; } } /* end namespaces */
+
+    // ######################################################################
+    //! The number of bytes a type occupies when saved by BinaryOutputArchive, if known at compile time
+    /*! This has a value member only for types that always save the same number of
+        bytes, which includes arithmetic types, enums, and arrays, pairs, tuples and
+        complex numbers made from such types when their headers are included.  Types
+        that save a length, such as strings and containers, or that save pointers,
+        have no value; check first with has_fixed_binary_size.
+
+        User types can be given a size with CEREAL_FIXED_BINARY_SIZE.  Since class
+        versions are written once per type, versioned types never have a fixed size,
+        and the size assumes the default options of BinaryOutputArchive.
+
+        A buffer for a fixed size type can be sized once, with no need for
+        SizeComputingArchive:
+
+        @code{.cpp}
+        static_assert( cereal::traits::fixed_binary_size<std::array<double, 3>>::value == 24, "" );
+        @endcode */
+    template <class T, class SFINAE = void>
+    struct fixed_binary_size {};
+
+    //! Arithmetic types save exactly their bytes
+    template <class T>
+    struct fixed_binary_size<T, typename std::enable_if<std::is_arithmetic<T>::value>::type> :
+      std::integral_constant<std::size_t, sizeof(T)> {};
+
+    namespace detail
+    {
+      template <class T>
+      struct has_fixed_binary_size_impl
+      {
+        template <class TT>
+        static auto test(int) -> decltype( fixed_binary_size<TT>::value, yes() );
+        template <class>
+        static no test(...);
+        static const bool value = std::is_same<decltype(test<T>(0)), yes>::value;
+      };
+
+      //! The total fixed binary size of some types, which must all have one
+      template <class ... Types>
+      struct fixed_binary_size_sum : std::integral_constant<std::size_t, 0> {};
+
+      template <class T, class ... Other>
+      struct fixed_binary_size_sum<T, Other...> :
+        std::integral_constant<std::size_t, fixed_binary_size<T>::value + fixed_binary_size_sum<Other...>::value> {};
+    }
+
+    //! Checks if a type has a fixed_binary_size
+    template <class T>
+    struct has_fixed_binary_size : std::integral_constant<bool, detail::has_fixed_binary_size_impl<T>::value> {};
+
+    namespace detail
+    {
+      //! Checks if all of some types have a fixed_binary_size
+      template <class ... Types>
+      struct all_fixed_binary_size : std::true_type {};
+
+      template <class T, class ... Other>
+      struct all_fixed_binary_size<T, Other...> :
+        std::integral_constant<bool, has_fixed_binary_size<T>::value && all_fixed_binary_size<Other...>::value> {};
+
+      //! The fixed binary size of an array of Count elements of T, occupying Bytes in memory
+      /*! Arrays of trivially serializable types are saved as one block of Bytes, padding
+          included, and all other arrays as each element in turn */
+      template <class T, std::size_t Count, std::size_t Bytes, bool Block>
+      struct fixed_binary_array_size : std::integral_constant<std::size_t, Bytes> {};
+
+      template <class T, std::size_t Count, std::size_t Bytes>
+      struct fixed_binary_array_size<T, Count, Bytes, false> :
+        std::integral_constant<std::size_t, Count * fixed_binary_size<T>::value> {};
+    }
+
+    //! Gives a user type a fixed_binary_size
+    /*! The type is described by the types of what its serialization function passes to
+        the archive, in any order, each of which must have a fixed size itself.  Nothing
+        checks that this matches the serialization function, and the function must not
+        take a version parameter.
+
+        This macro should be placed at global scope.
+
+        @code{.cpp}
+        struct Sample { std::uint32_t id; float x, y;
+                        template <class Archive> void serialize( Archive & ar ) { ar( id, x, y ); } };
+        CEREAL_FIXED_BINARY_SIZE( Sample, std::uint32_t, float, float )
+        @endcode */
+    #define CEREAL_FIXED_BINARY_SIZE(TYPE, ...)                                                       \
+    namespace cereal { namespace traits {                                                             \
+      template <> struct fixed_binary_size<TYPE> :                                                    \
+        std::integral_constant<std::size_t, detail::fixed_binary_size_sum<__VA_ARGS__>::value> {};    \
+      } } /* end namespaces */
+
+    //! Checks if the trace policy is called around serializing a type
+    /*! When CEREAL_TRACE_POLICY is defined, every class type is traced by default,
+        apart from cereal's own wrappers such as name-value pairs and size tags.  Hot
+        small types can be left out with CEREAL_NOT_TRACED, which removes their
+        calls at compile time.  Without CEREAL_TRACE_POLICY this has no effect. */
+    template <class T, class SFINAE = void>
+    struct is_traced : std::integral_constant<bool, std::is_class<T>::value> {};
+
+    //! Leaves a type out of the calls to CEREAL_TRACE_POLICY
+    /*! This macro should be placed at global scope.
+
+        @code{.cpp}
+        CEREAL_NOT_TRACED( Vec3 )
+        @endcode */
+    #define CEREAL_NOT_TRACED(TYPE)                                                          \
+    namespace cereal { namespace traits {                                                    \
+      template <> struct is_traced<TYPE> : std::false_type {};                               \
+      } } /* end namespaces */
+
     //! Type traits only struct used to mark an archive as human readable (text based)
     /*! Archives that wish to identify as text based/human readable should inherit from
         this struct */
@@ -1270,6 +1525,32 @@ namespace cereal
     struct is_text_archive : std::integral_constant<bool,
       std::is_base_of<TextArchive, detail::decay_archive<A>>::value>
     { };
+
+    // ######################################################################
+    namespace detail
+    {
+      //! Measures the run of arithmetic types at the start of a parameter pack
+      /*! count is the number of leading arithmetic types and size is their
+          total size in bytes.  Used by archives with the CoalesceArithmetic flag. */
+      template <class ... Types>
+      struct arithmetic_run
+      {
+        static const std::size_t count = 0;
+        static const std::size_t size = 0;
+      };
+
+      template <class T, class ... Other>
+      struct arithmetic_run<T, Other...>
+      {
+        private:
+          using type = typename std::decay<T>::type;
+          static const bool arithmetic = std::is_arithmetic<type>::value;
+
+        public:
+          static const std::size_t count = arithmetic ? 1 + arithmetic_run<Other...>::count : 0;
+          static const std::size_t size = arithmetic ? sizeof(type) + arithmetic_run<Other...>::size : 0;
+      };
+    }
   } // namespace traits
 
   // ######################################################################
@@ -1319,6 +1600,63 @@ namespace cereal
         LoadAndConstruct<T>::load_and_construct( ar, construct );
       }
     };
+
+    //! An object created by its load_and_construct function in local storage
+    /*! Containers load elements that are not default constructible into this before
+        moving them into place.  The object is destroyed along with the storage only if
+        load_and_construct constructed it.
+        @internal */
+    template <class T, class A>
+    struct LoadAndConstructValue
+    {
+      LoadAndConstructValue() : construct( reinterpret_cast<T *>( &storage ) ) {}
+      LoadAndConstructValue( LoadAndConstructValue const & ) = delete;
+      LoadAndConstructValue & operator=( LoadAndConstructValue const & ) = delete;
+
+      ~LoadAndConstructValue()
+      {
+        if( construct.itsValid )
+          construct.itsPtr->~T();
+      }
+
+      //! Loads the object, this is only used with input archives
+      void CEREAL_SERIALIZE_FUNCTION_NAME( A & ar )
+      {
+        Construct<T, A>::load_andor_construct( ar, construct );
+        if( !construct.itsValid )
+          throw Exception("A load_and_construct function returned without constructing its object");
+      }
+
+      //! The constructed object
+      T & get()
+      { return *construct.itsPtr; }
+
+      typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+      ::cereal::construct<T> construct;
+    };
+
+    //! Where a container loads an element before moving it into place
+    /*! This is the element type itself, or LoadAndConstructValue when the element is
+        not default constructible but has a load_and_construct function.
+        @internal */
+    template <class T, class A>
+    struct load_storage
+    {
+      using type = typename std::conditional<std::is_default_constructible<T>::value || !traits::has_load_and_construct<T, A>::value,
+                                             T, LoadAndConstructValue<T, A>>::type;
+    };
+
+    //! The element held by load_storage
+    /*! @internal */
+    template <class T> inline
+    T & loaded_value( T & value )
+    { return value; }
+
+    //! The element held by load_storage, when it was constructed by load_and_construct
+    /*! @internal */
+    template <class T, class A> inline
+    T & loaded_value( LoadAndConstructValue<T, A> & value )
+    { return value.get(); }
   } // namespace detail
 } // namespace cereal
 
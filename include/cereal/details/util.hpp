@@ -66,6 +66,8 @@ namespace cereal
       std::size_t len;
 
       demangledName = abi::__cxa_demangle(mangledName.c_str(), 0, &len, &status);
+      if( !demangledName )
+        return mangledName;
 
       std::string retName(demangledName);
       free(demangledName);
@@ -81,4 +83,21 @@ namespace cereal
   }
 } // namespace cereal
 #endif // clang or gcc branch of _MSC_VER
+
+namespace cereal
+{
+  namespace util
+  {
+    //! Gets the demangled name of a type, demangling it only the first time
+    /*! The returned string lives until the program exits, so pointers to its
+        data can be kept without copying it.
+        @internal */
+    template <class T> inline
+    std::string const & cachedDemangledName()
+    {
+      static const std::string name = demangledName<T>();
+      return name;
+    }
+  } // namespace util
+} // namespace cereal
 #endif // CEREAL_DETAILS_UTIL_HPP_
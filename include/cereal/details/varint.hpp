@@ -0,0 +1,112 @@
+/*! \file varint.hpp
+    \brief Variable length integer encoding shared by archives and encoded types
+    \ingroup Internal */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_VARINT_HPP_
+#define CEREAL_DETAILS_VARINT_HPP_
+
+#include <cereal/details/helpers.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace cereal
+{
+  namespace varint_detail
+  {
+    //! The largest number of bytes a 64 bit LEB128 value can occupy
+    /*! @ingroup Internal */
+    static const std::size_t max_varint_size = 10;
+
+    //! Encodes a value as unsigned LEB128
+    /*! @param value The value to encode
+        @param out A buffer of at least max_varint_size bytes
+        @return The number of bytes used
+        @ingroup Internal */
+    inline std::size_t encode_varint( std::uint64_t value, std::uint8_t * out )
+    {
+      std::size_t n = 0;
+      while( value >= 0x80 )
+      {
+        out[n++] = static_cast<std::uint8_t>( value | 0x80 );
+        value >>= 7;
+      }
+      out[n++] = static_cast<std::uint8_t>( value );
+      return n;
+    }
+
+    //! Appends a value encoded as unsigned LEB128 to a buffer
+    /*! @ingroup Internal */
+    inline void append_varint( std::vector<std::uint8_t> & buffer, std::uint64_t value )
+    {
+      std::uint8_t encoded[max_varint_size];
+      buffer.insert( buffer.end(), encoded, encoded + encode_varint( value, encoded ) );
+    }
+
+    //! Decodes an unsigned LEB128 value from a buffer
+    /*! @param pos The position to decode from, advanced past the value
+        @param end The end of the buffer
+        @throws Exception if the value is truncated or longer than 64 bits
+        @ingroup Internal */
+    inline std::uint64_t decode_varint( std::uint8_t const * & pos, std::uint8_t const * end )
+    {
+      // Values smaller than 128 take a single branch to decode
+      if( pos != end && *pos < 0x80 )
+        return *pos++;
+
+      std::uint64_t value = 0;
+      for( unsigned int shift = 0; shift < 64; shift += 7 )
+      {
+        if( pos == end )
+          throw Exception("Variable length integer is truncated!");
+
+        auto const c = *pos++;
+        value |= static_cast<std::uint64_t>( c & 0x7F ) << shift;
+        if( ( c & 0x80 ) == 0 )
+          return value;
+      }
+
+      throw Exception("Variable length integer is longer than 64 bits!");
+    }
+
+    //! Maps signed integers to unsigned so that values of small magnitude encode compactly
+    /*! @ingroup Internal */
+    inline std::uint64_t zigzag_encode( std::int64_t value )
+    {
+      return ( static_cast<std::uint64_t>( value ) << 1 ) ^ static_cast<std::uint64_t>( value >> 63 );
+    }
+
+    //! Inverse of zigzag_encode
+    /*! @ingroup Internal */
+    inline std::int64_t zigzag_decode( std::uint64_t value )
+    {
+      return static_cast<std::int64_t>( ( value >> 1 ) ^ ( ~( value & 1 ) + 1 ) );
+    }
+  } // namespace varint_detail
+} // namespace cereal
+
+#endif // CEREAL_DETAILS_VARINT_HPP_
@@ -20,13 +20,26 @@
    3. This notice may not be removed or altered from any source distribution.
 
    René Nyffenegger rene.nyffenegger@adp-gmbh.ch
+
+   This is an altered version for cereal: encoding and decoding are table
+   driven, can write into caller provided buffers, and use SSSE3 when it is
+   enabled.  The decoding rules of the original are kept.
 */
 
 #ifndef CEREAL_EXTERNAL_BASE64_HPP_
 #define CEREAL_EXTERNAL_BASE64_HPP_
 
+#include <cctype>
+#include <cstddef>
 #include <string>
 
+#if defined(__SSSE3__)
+  #include <tmmintrin.h>
+  #define CEREAL_BASE64_SSSE3 1
+#else
+  #define CEREAL_BASE64_SSSE3 0
+#endif
+
 namespace base64
 {
   static const std::string chars =
@@ -38,87 +51,188 @@ namespace base64
     return (isalnum(c) || (c == '+') || (c == '/'));
   }
 
-  inline std::string encode(unsigned char const* bytes_to_encode, size_t in_len) {
-    std::string ret;
-    int i = 0;
-    int j = 0;
-    unsigned char char_array_3[3];
-    unsigned char char_array_4[4];
-
-    while (in_len--) {
-      char_array_3[i++] = *(bytes_to_encode++);
-      if (i == 3) {
-        char_array_4[0] = (unsigned char) ((char_array_3[0] & 0xfc) >> 2);
-        char_array_4[1] = (unsigned char) ( ( ( char_array_3[0] & 0x03 ) << 4 ) + ( ( char_array_3[1] & 0xf0 ) >> 4 ) );
-        char_array_4[2] = (unsigned char) ( ( ( char_array_3[1] & 0x0f ) << 2 ) + ( ( char_array_3[2] & 0xc0 ) >> 6 ) );
-        char_array_4[3] = (unsigned char) ( char_array_3[2] & 0x3f );
-
-        for(i = 0; (i <4) ; i++)
-          ret += chars[char_array_4[i]];
-        i = 0;
-      }
+  namespace detail
+  {
+    //! The character for each six bit value
+    static const char encode_table[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+      "abcdefghijklmnopqrstuvwxyz"
+      "0123456789+/";
+
+    //! The six bit value of each character, or 0xff for characters that are not base64
+    inline unsigned char decode_value(unsigned char c) {
+      static const unsigned char table[256] = {
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255, 62,255,255,255, 63,
+         52, 53, 54, 55, 56, 57, 58, 59, 60, 61,255,255,255,255,255,255,
+        255,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+         15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25,255,255,255,255,255,
+        255, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+         41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255 };
+      return table[c];
     }
 
-    if (i)
-    {
-      for(j = i; j < 3; j++)
-        char_array_3[j] = '\0';
-
-      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-      char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-      char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-      char_array_4[3] = char_array_3[2] & 0x3f;
+    #if CEREAL_BASE64_SSSE3
+    //! Encodes the first 12 of 16 readable bytes into 16 characters
+    inline void encode_block(unsigned char const * in, char * out) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in));
+      v = _mm_shuffle_epi8(v, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
 
-      for (j = 0; (j < i + 1); j++)
-        ret += chars[char_array_4[j]];
+      // split each group of three bytes into four six bit values, one per byte
+      __m128i const t0 = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+      __m128i const t1 = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+      __m128i const indices = _mm_or_si128(t0, t1);
 
-      while((i++ < 3))
-        ret += '=';
+      // map each range of values to the offset from its value to its character
+      __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+      range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+      __m128i const offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
 
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices));
     }
 
-    return ret;
+    //! Decodes 16 characters into 12 bytes, storing 16 bytes
+    /*! @return false if any of the characters is not base64 */
+    inline bool decode_block(char const * in, unsigned char * out) {
+      __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in));
+      __m128i const mask = _mm_set1_epi8(0x2f);
+      __m128i const hi_nibbles = _mm_and_si128(_mm_srli_epi32(v, 4), mask);
+      __m128i const lo_nibbles = _mm_and_si128(v, mask);
+
+      // a character is valid when its low and high nibble classes share no bit
+      __m128i const lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                           0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+      __m128i const lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                           0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+      __m128i const classes = _mm_and_si128(_mm_shuffle_epi8(lut_lo, lo_nibbles), _mm_shuffle_epi8(lut_hi, hi_nibbles));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(classes, _mm_setzero_si128())) != 0xffff)
+        return false;
+
+      // map each character to its six bit value with an offset chosen by its high nibble
+      __m128i const lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+      __m128i const roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(v, mask), hi_nibbles));
+      __m128i const values = _mm_add_epi8(v, roll);
+
+      // pack four six bit values into three bytes
+      __m128i const merged = _mm_madd_epi16(_mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+      __m128i const packed = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out), packed);
+      return true;
+    }
+    #endif // CEREAL_BASE64_SSSE3
+  } // namespace detail
 
+  //! The number of characters encode writes for in_len bytes
+  inline size_t encoded_size(size_t in_len) {
+    return (in_len + 2) / 3 * 4;
   }
 
-  inline std::string decode(std::string const& encoded_string) {
-    size_t in_len = encoded_string.size();
+  //! Encodes in_len bytes, writing exactly encoded_size(in_len) characters to out
+  inline void encode(unsigned char const* bytes_to_encode, size_t in_len, char* out) {
     size_t i = 0;
-    size_t j = 0;
-    int in_ = 0;
-    unsigned char char_array_4[4], char_array_3[3];
-    std::string ret;
-
-    while (in_len-- && ( encoded_string[in_] != '=') && is_base64(encoded_string[in_])) {
-      char_array_4[i++] = encoded_string[in_]; in_++;
-      if (i ==4) {
-        for (i = 0; i <4; i++)
-          char_array_4[i] = (unsigned char) chars.find( char_array_4[i] );
-
-        char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-        char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-        char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-        for (i = 0; (i < 3); i++)
-          ret += char_array_3[i];
-        i = 0;
-      }
+
+    #if CEREAL_BASE64_SSSE3
+    // each block reads 16 bytes but consumes 12
+    for (; i + 16 <= in_len; i += 12, out += 16)
+      detail::encode_block(bytes_to_encode + i, out);
+    #endif // CEREAL_BASE64_SSSE3
+
+    for (; i + 3 <= in_len; i += 3, out += 4) {
+      unsigned long const triple = (static_cast<unsigned long>(bytes_to_encode[i]) << 16) |
+                                   (static_cast<unsigned long>(bytes_to_encode[i + 1]) << 8) |
+                                    static_cast<unsigned long>(bytes_to_encode[i + 2]);
+      out[0] = detail::encode_table[(triple >> 18) & 0x3f];
+      out[1] = detail::encode_table[(triple >> 12) & 0x3f];
+      out[2] = detail::encode_table[(triple >> 6) & 0x3f];
+      out[3] = detail::encode_table[triple & 0x3f];
     }
 
-    if (i) {
-      for (j = i; j <4; j++)
-        char_array_4[j] = 0;
+    if (i < in_len) {
+      unsigned long triple = static_cast<unsigned long>(bytes_to_encode[i]) << 16;
+      if (i + 1 < in_len)
+        triple |= static_cast<unsigned long>(bytes_to_encode[i + 1]) << 8;
 
-      for (j = 0; j <4; j++)
-        char_array_4[j] = (unsigned char) chars.find( char_array_4[j] );
+      out[0] = detail::encode_table[(triple >> 18) & 0x3f];
+      out[1] = detail::encode_table[(triple >> 12) & 0x3f];
+      out[2] = i + 1 < in_len ? detail::encode_table[(triple >> 6) & 0x3f] : '=';
+      out[3] = '=';
+    }
+  }
 
-      char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-      char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-      char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+  inline std::string encode(unsigned char const* bytes_to_encode, size_t in_len) {
+    std::string ret(encoded_size(in_len), '\0');
+    if (in_len)
+      encode(bytes_to_encode, in_len, &ret[0]);
+    return ret;
+  }
 
-      for (j = 0; (j < i - 1); j++) ret += char_array_3[j];
+  //! The number of leading characters that are decoded, up to the first '=' or other character that is not base64
+  inline size_t decodable_length(char const* encoded, size_t in_len) {
+    size_t n = 0;
+    while (n < in_len && detail::decode_value(static_cast<unsigned char>(encoded[n])) != 0xff)
+      ++n;
+    return n;
+  }
+
+  //! The number of bytes decode writes for the first in_len characters of encoded
+  inline size_t decoded_size(char const* encoded, size_t in_len) {
+    size_t const n = decodable_length(encoded, in_len);
+    return n / 4 * 3 + (n % 4 > 1 ? n % 4 - 1 : 0);
+  }
+
+  //! Decodes the first in_len characters of encoded, writing exactly decoded_size(encoded, in_len) bytes to out
+  /*! As with the string overload, decoding stops at the first '=' or other character that is not base64
+      @return The number of bytes written */
+  inline size_t decode(char const* encoded, size_t in_len, unsigned char* out) {
+    size_t const n = decodable_length(encoded, in_len);
+    unsigned char * const begin = out;
+    size_t i = 0;
+
+    #if CEREAL_BASE64_SSSE3
+    // each block stores 16 bytes but produces 12, so stop while the whole store fits in the output
+    for (; i + 24 <= n; i += 16, out += 12)
+      detail::decode_block(encoded + i, out);
+    #endif // CEREAL_BASE64_SSSE3
+
+    for (; i + 4 <= n; i += 4, out += 3) {
+      unsigned long const quad = (static_cast<unsigned long>(detail::decode_value(static_cast<unsigned char>(encoded[i]))) << 18) |
+                                 (static_cast<unsigned long>(detail::decode_value(static_cast<unsigned char>(encoded[i + 1]))) << 12) |
+                                 (static_cast<unsigned long>(detail::decode_value(static_cast<unsigned char>(encoded[i + 2]))) << 6) |
+                                  static_cast<unsigned long>(detail::decode_value(static_cast<unsigned char>(encoded[i + 3])));
+      out[0] = static_cast<unsigned char>(quad >> 16);
+      out[1] = static_cast<unsigned char>(quad >> 8);
+      out[2] = static_cast<unsigned char>(quad);
     }
 
+    size_t const rest = n - i;
+    if (rest > 1) {
+      unsigned long quad = (static_cast<unsigned long>(detail::decode_value(static_cast<unsigned char>(encoded[i]))) << 18) |
+                           (static_cast<unsigned long>(detail::decode_value(static_cast<unsigned char>(encoded[i + 1]))) << 12);
+      if (rest > 2)
+        quad |= static_cast<unsigned long>(detail::decode_value(static_cast<unsigned char>(encoded[i + 2]))) << 6;
+
+      *out++ = static_cast<unsigned char>(quad >> 16);
+      if (rest > 2)
+        *out++ = static_cast<unsigned char>(quad >> 8);
+    }
+
+    return static_cast<size_t>(out - begin);
+  }
+
+  inline std::string decode(std::string const& encoded_string) {
+    std::string ret(decoded_size(encoded_string.data(), encoded_string.size()), '\0');
+    if (!ret.empty())
+      decode(encoded_string.data(), encoded_string.size(), reinterpret_cast<unsigned char *>(&ret[0]));
     return ret;
   }
 } // base64
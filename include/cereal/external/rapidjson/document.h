@@ -698,7 +698,12 @@ public:
 	/*! \param allocator		Optional allocator for allocating stack memory.
 		\param stackCapacity	Initial capacity of stack in bytes.
 	*/
-	GenericDocument(Allocator* allocator = 0, size_t stackCapacity = kDefaultStackCapacity) : stack_(allocator, stackCapacity), parseError_(0), errorOffset_(0) {}
+	GenericDocument(Allocator* allocator = 0, size_t stackCapacity = kDefaultStackCapacity) : allocator_(allocator), ownAllocator_(0), stack_(0, stackCapacity), parseError_(0), errorOffset_(0) {
+		if (!allocator_)
+			ownAllocator_ = allocator_ = new Allocator();
+	}
+
+	~GenericDocument() { delete ownAllocator_; }
 
 	//! Parse JSON text from an input stream.
 	/*! \tparam parseFlags Combination of ParseFlag.
@@ -755,7 +760,8 @@ public:
 	size_t GetErrorOffset() const { return errorOffset_; }
 
 	//! Get the allocator of this document.
-	Allocator& GetAllocator() {	return stack_.GetAllocator(); }
+	/*! The parsing stack is kept apart from this allocator, so it can be rewound between parses. */
+	Allocator& GetAllocator() {	return *allocator_; }
 
 	//! Get the capacity of stack in bytes.
 	size_t GetStackCapacity() const { return stack_.GetCapacity(); }
@@ -805,7 +811,9 @@ private:
 	}
 
 	static const size_t kDefaultStackCapacity = 1024;
-	internal::Stack<Allocator> stack_;
+	Allocator* allocator_;
+	Allocator* ownAllocator_;
+	internal::Stack<CrtAllocator> stack_;
 	const char* parseError_;
 	size_t errorOffset_;
 };
@@ -211,6 +211,19 @@ public:
 		}
 	}
 
+	//! Deallocates all memory chunks but the first one, which is reused from its start.
+	/*! Every block allocated before is invalidated.
+	*/
+	void Rewind() {
+		while(chunkHead_ != 0 && chunkHead_->next != 0) {
+			ChunkHeader* next = chunkHead_->next;
+			baseAllocator_->Free(chunkHead_);
+			chunkHead_ = next;
+		}
+		if (chunkHead_ != 0)
+			chunkHead_->size = 0;
+	}
+
 	//! Computes the total capacity of allocated memory chunks.
 	/*! \return total capacity in bytes.
 	*/
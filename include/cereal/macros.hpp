@@ -79,4 +79,16 @@
 #define CEREAL_SAVE_MINIMAL_FUNCTION_NAME save_minimal
 #endif // CEREAL_SAVE_MINIMAL_FUNCTION_NAME
 
+#ifndef CEREAL_HAS_THREAD_LOCAL
+//! Whether the compiler supports thread_local
+/*! VS2013 has no thread_local, and its __declspec(thread) can not hold objects
+    with constructors or destructors, so features that need per thread objects
+    fall back to not keeping any state there. */
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define CEREAL_HAS_THREAD_LOCAL 0
+#else
+#define CEREAL_HAS_THREAD_LOCAL 1
+#endif
+#endif // CEREAL_HAS_THREAD_LOCAL
+
 #endif // CEREAL_MACROS_HPP_
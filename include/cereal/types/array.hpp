@@ -35,21 +35,21 @@
 
 namespace cereal
 {
-  //! Saving for std::array primitive types
+  //! Saving for std::array primitive or trivially serializable types
   //! using binary serialization, if supported
   template <class Archive, class T, size_t N> inline
   typename std::enable_if<traits::is_output_serializable<BinaryData<T>, Archive>::value
-                          && std::is_arithmetic<T>::value, void>::type
+                          && traits::is_trivially_serializable<T>::value, void>::type
   CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::array<T, N> const & array )
   {
     ar( binary_data( array.data(), sizeof(array) ) );
   }
 
-  //! Loading for std::array primitive types
+  //! Loading for std::array primitive or trivially serializable types
   //! using binary serialization, if supported
   template <class Archive, class T, size_t N> inline
   typename std::enable_if<traits::is_input_serializable<BinaryData<T>, Archive>::value
-                          && std::is_arithmetic<T>::value, void>::type
+                          && traits::is_trivially_serializable<T>::value, void>::type
   CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::array<T, N> & array )
   {
     ar( binary_data( array.data(), sizeof(array) ) );
@@ -58,7 +58,7 @@ namespace cereal
   //! Saving for std::array all other types
   template <class Archive, class T, size_t N> inline
   typename std::enable_if<!traits::is_output_serializable<BinaryData<T>, Archive>::value
-                          || !std::is_arithmetic<T>::value, void>::type
+                          || !traits::is_trivially_serializable<T>::value, void>::type
   CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::array<T, N> const & array )
   {
     for( auto const & i : array )
@@ -68,12 +68,21 @@ namespace cereal
   //! Loading for std::array all other types
   template <class Archive, class T, size_t N> inline
   typename std::enable_if<!traits::is_input_serializable<BinaryData<T>, Archive>::value
-                          || !std::is_arithmetic<T>::value, void>::type
+                          || !traits::is_trivially_serializable<T>::value, void>::type
   CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::array<T, N> & array )
   {
     for( auto & i : array )
       ar( i );
   }
+
+  namespace traits
+  {
+    //! std::array of fixed size or trivially serializable types
+    template <class T, size_t N>
+    struct fixed_binary_size<std::array<T, N>, typename std::enable_if<has_fixed_binary_size<T>::value ||
+                                                                       is_trivially_serializable<T>::value>::type> :
+      detail::fixed_binary_array_size<T, N, sizeof(std::array<T, N>), is_trivially_serializable<T>::value> {};
+  } // namespace traits
 } // namespace cereal
 
 #endif // CEREAL_TYPES_ARRAY_HPP_
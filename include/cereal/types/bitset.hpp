@@ -43,13 +43,53 @@ namespace cereal
     {
       ulong,
       ullong,
-      string
+      string,
+      bits
     };
+
+    //! Loads the packed representation of a bitset, if BinaryData is supported
+    /*! @internal */
+    template <class Archive, size_t N> inline
+    typename std::enable_if<traits::is_input_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+    load_bits( Archive & ar, std::bitset<N> & bits )
+    {
+      std::uint8_t bytes[(N + 7) / 8 + 1]; // + 1 to avoid a zero sized array
+      ar( binary_data( bytes, (N + 7) / 8 ) );
+
+      for( std::size_t i = 0; i < N; ++i )
+        bits[i] = ( ( bytes[i / 8] >> ( i % 8 ) ) & 1 ) != 0;
+    }
+
+    //! The packed representation is never produced by archives without BinaryData support
+    /*! @internal */
+    template <class Archive, size_t N> inline
+    typename std::enable_if<!traits::is_input_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+    load_bits( Archive &, std::bitset<N> & )
+    {
+      throw Exception("Packed bitset data cannot be loaded by this archive");
+    }
+  }
+
+  //! Serializing (save) for std::bitset when BinaryData is supported
+  /*! The bits are packed into ceil(N / 8) bytes, with bit i stored in
+      byte i / 8 at position i % 8, and written as a single block. */
+  template <class Archive, size_t N> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::bitset<N> const & bits )
+  {
+    ar( CEREAL_NVP_("type", bitset_detail::type::bits) );
+
+    std::uint8_t bytes[(N + 7) / 8 + 1] = {}; // + 1 to avoid a zero sized array
+    for( std::size_t i = 0; i < N; ++i )
+      bytes[i / 8] = static_cast<std::uint8_t>( bytes[i / 8] | ( bits[i] << ( i % 8 ) ) );
+
+    ar( binary_data( bytes, (N + 7) / 8 ) );
   }
 
   //! Serializing (save) for std::bitset
   template <class Archive, size_t N> inline
-  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::bitset<N> const & bits )
+  typename std::enable_if<!traits::is_output_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::bitset<N> const & bits )
   {
     try
     {
@@ -103,6 +143,11 @@ namespace cereal
         bits = std::bitset<N>( b );
         break;
       }
+      case bitset_detail::type::bits:
+      {
+        bitset_detail::load_bits( ar, bits );
+        break;
+      }
       default:
         throw Exception("Invalid bitset data representation");
     }
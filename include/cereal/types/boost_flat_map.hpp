@@ -0,0 +1,153 @@
+/*! \file boost_flat_map.hpp
+    \brief Support for boost::container::flat_map and flat_multimap
+    \ingroup OtherTypes */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TYPES_BOOST_FLAT_MAP_HPP_
+#define CEREAL_TYPES_BOOST_FLAT_MAP_HPP_
+
+#include <cereal/cereal.hpp>
+#include <boost/container/flat_map.hpp>
+
+namespace cereal
+{
+  namespace flat_map_detail
+  {
+    //! Whether the elements of a flat map can be saved as one block of binary data
+    /*! This requires the key and mapped types to be trivially serializable, of
+        the same size and without padding between them, so that the block can be
+        written as an array of keys by archives that byte swap each element
+        @internal */
+    template <class Archive, class MapT>
+    struct use_binary : std::integral_constant<bool,
+      (traits::is_output_serializable<BinaryData<typename MapT::key_type>, Archive>::value ||
+       traits::is_input_serializable<BinaryData<typename MapT::key_type>, Archive>::value) &&
+      traits::is_trivially_serializable<typename MapT::key_type>::value &&
+      traits::is_trivially_serializable<typename MapT::mapped_type>::value &&
+      sizeof(typename MapT::key_type) == sizeof(typename MapT::mapped_type) &&
+      sizeof(typename MapT::sequence_type::value_type) == 2 * sizeof(typename MapT::key_type)> {};
+
+    //! Saves the elements as one block of binary data
+    /*! @internal */
+    template <class Archive, class MapT> inline
+    void save( Archive & ar, MapT const & map, std::true_type /* binary */ )
+    {
+      ar( make_size_tag( static_cast<size_type>(map.size()) ) );
+      if( !map.empty() )
+        ar( binary_data( reinterpret_cast<typename MapT::key_type const *>( &*map.begin() ), map.size() * sizeof(*map.begin()) ) );
+    }
+
+    //! Saves the elements as individual key and value pairs
+    /*! @internal */
+    template <class Archive, class MapT> inline
+    void save( Archive & ar, MapT const & map, std::false_type /* binary */ )
+    {
+      ar( make_size_tag( static_cast<size_type>(map.size()) ) );
+
+      for( const auto & i : map )
+        ar( make_map_item(i.first, i.second) );
+    }
+
+    //! Loads the elements from one block of binary data
+    /*! @internal */
+    template <class Archive, class SequenceT> inline
+    void loadSequence( Archive & ar, SequenceT & sequence, std::true_type /* binary */ )
+    {
+      typedef typename std::remove_const<typename SequenceT::value_type::first_type>::type KeyT;
+      if( !sequence.empty() )
+        ar( binary_data( reinterpret_cast<KeyT *>( sequence.data() ), sequence.size() * sizeof(typename SequenceT::value_type) ) );
+    }
+
+    //! Loads the elements as individual key and value pairs
+    /*! @internal */
+    template <class Archive, class SequenceT> inline
+    void loadSequence( Archive & ar, SequenceT & sequence, std::false_type /* binary */ )
+    {
+      for( auto & i : sequence )
+        ar( make_map_item(i.first, i.second) );
+    }
+
+    //! Loads a flat map in a single bulk construction
+    /*! Saved maps are already sorted, so the elements are loaded directly into the
+        underlying sequence of the map, which then adopts it without sorting.  The
+        order is still verified, in linear time, since adopting an unsorted sequence
+        would break the map.
+
+        @tparam Range boost::container::ordered_unique_range_t or ordered_range_t
+        @param unique Whether equal keys are not allowed
+        @internal */
+    template <class Archive, class MapT, class Range> inline
+    void load( Archive & ar, MapT & map, Range range, bool unique )
+    {
+      size_type size;
+      ar( make_size_tag( size ) );
+
+      auto sequence = map.extract_sequence();
+      sequence.clear();
+      sequence.resize( static_cast<std::size_t>( size ) );
+
+      loadSequence( ar, sequence, use_binary<Archive, MapT>() );
+
+      auto const comp = map.key_comp();
+      for( std::size_t i = 1; i < sequence.size(); ++i )
+        if( comp( sequence[i].first, sequence[i - 1].first ) || ( unique && !comp( sequence[i - 1].first, sequence[i].first ) ) )
+          throw Exception( "Error while loading a flat map: keys are not in order" );
+
+      map.adopt_sequence( range, std::move( sequence ) );
+    }
+  } // namespace flat_map_detail
+
+  //! Saving for boost::container::flat_map
+  template <class Archive, class K, class T, class C, class A> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, boost::container::flat_map<K, T, C, A> const & map )
+  {
+    flat_map_detail::save( ar, map, flat_map_detail::use_binary<Archive, boost::container::flat_map<K, T, C, A>>() );
+  }
+
+  //! Loading for boost::container::flat_map
+  template <class Archive, class K, class T, class C, class A> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, boost::container::flat_map<K, T, C, A> & map )
+  {
+    flat_map_detail::load( ar, map, boost::container::ordered_unique_range, true );
+  }
+
+  //! Saving for boost::container::flat_multimap
+  template <class Archive, class K, class T, class C, class A> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, boost::container::flat_multimap<K, T, C, A> const & multimap )
+  {
+    flat_map_detail::save( ar, multimap, flat_map_detail::use_binary<Archive, boost::container::flat_multimap<K, T, C, A>>() );
+  }
+
+  //! Loading for boost::container::flat_multimap
+  template <class Archive, class K, class T, class C, class A> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, boost::container::flat_multimap<K, T, C, A> & multimap )
+  {
+    flat_map_detail::load( ar, multimap, boost::container::ordered_range, false );
+  }
+} // namespace cereal
+
+#endif // CEREAL_TYPES_BOOST_FLAT_MAP_HPP_
@@ -0,0 +1,141 @@
+/*! \file boost_flat_set.hpp
+    \brief Support for boost::container::flat_set and flat_multiset
+    \ingroup OtherTypes */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TYPES_BOOST_FLAT_SET_HPP_
+#define CEREAL_TYPES_BOOST_FLAT_SET_HPP_
+
+#include <cereal/cereal.hpp>
+#include <boost/container/flat_set.hpp>
+
+namespace cereal
+{
+  namespace flat_set_detail
+  {
+    //! Whether the elements of a flat set can be saved as one block of binary data
+    /*! @internal */
+    template <class Archive, class SetT>
+    struct use_binary : std::integral_constant<bool,
+      (traits::is_output_serializable<BinaryData<typename SetT::key_type>, Archive>::value ||
+       traits::is_input_serializable<BinaryData<typename SetT::key_type>, Archive>::value) &&
+      traits::is_trivially_serializable<typename SetT::key_type>::value> {};
+
+    //! Saves the elements as one block of binary data
+    /*! @internal */
+    template <class Archive, class SetT> inline
+    void save( Archive & ar, SetT const & set, std::true_type /* binary */ )
+    {
+      ar( make_size_tag( static_cast<size_type>(set.size()) ) );
+      if( !set.empty() )
+        ar( binary_data( &*set.begin(), set.size() * sizeof(*set.begin()) ) );
+    }
+
+    //! Saves the elements individually
+    /*! @internal */
+    template <class Archive, class SetT> inline
+    void save( Archive & ar, SetT const & set, std::false_type /* binary */ )
+    {
+      ar( make_size_tag( static_cast<size_type>(set.size()) ) );
+
+      for( const auto & i : set )
+        ar( i );
+    }
+
+    //! Loads the elements from one block of binary data
+    /*! @internal */
+    template <class Archive, class SequenceT> inline
+    void loadSequence( Archive & ar, SequenceT & sequence, std::true_type /* binary */ )
+    {
+      if( !sequence.empty() )
+        ar( binary_data( sequence.data(), sequence.size() * sizeof(typename SequenceT::value_type) ) );
+    }
+
+    //! Loads the elements individually
+    /*! @internal */
+    template <class Archive, class SequenceT> inline
+    void loadSequence( Archive & ar, SequenceT & sequence, std::false_type /* binary */ )
+    {
+      for( auto & i : sequence )
+        ar( i );
+    }
+
+    //! Loads a flat set in a single bulk construction, see flat_map_detail::load
+    /*! @tparam Range boost::container::ordered_unique_range_t or ordered_range_t
+        @param unique Whether equal keys are not allowed
+        @internal */
+    template <class Archive, class SetT, class Range> inline
+    void load( Archive & ar, SetT & set, Range range, bool unique )
+    {
+      size_type size;
+      ar( make_size_tag( size ) );
+
+      auto sequence = set.extract_sequence();
+      sequence.clear();
+      sequence.resize( static_cast<std::size_t>( size ) );
+
+      loadSequence( ar, sequence, use_binary<Archive, SetT>() );
+
+      auto const comp = set.key_comp();
+      for( std::size_t i = 1; i < sequence.size(); ++i )
+        if( comp( sequence[i], sequence[i - 1] ) || ( unique && !comp( sequence[i - 1], sequence[i] ) ) )
+          throw Exception( "Error while loading a flat set: keys are not in order" );
+
+      set.adopt_sequence( range, std::move( sequence ) );
+    }
+  } // namespace flat_set_detail
+
+  //! Saving for boost::container::flat_set
+  template <class Archive, class K, class C, class A> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, boost::container::flat_set<K, C, A> const & set )
+  {
+    flat_set_detail::save( ar, set, flat_set_detail::use_binary<Archive, boost::container::flat_set<K, C, A>>() );
+  }
+
+  //! Loading for boost::container::flat_set
+  template <class Archive, class K, class C, class A> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, boost::container::flat_set<K, C, A> & set )
+  {
+    flat_set_detail::load( ar, set, boost::container::ordered_unique_range, true );
+  }
+
+  //! Saving for boost::container::flat_multiset
+  template <class Archive, class K, class C, class A> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, boost::container::flat_multiset<K, C, A> const & multiset )
+  {
+    flat_set_detail::save( ar, multiset, flat_set_detail::use_binary<Archive, boost::container::flat_multiset<K, C, A>>() );
+  }
+
+  //! Loading for boost::container::flat_multiset
+  template <class Archive, class K, class C, class A> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, boost::container::flat_multiset<K, C, A> & multiset )
+  {
+    flat_set_detail::load( ar, multiset, boost::container::ordered_range, false );
+  }
+} // namespace cereal
+
+#endif // CEREAL_TYPES_BOOST_FLAT_SET_HPP_
@@ -53,28 +53,30 @@ namespace cereal
       Archive & ar;
     };
 
-    //! @internal
-    template<int N, class Variant, class ... Args, class Archive>
-    typename std::enable_if<N == boost::mpl::size<typename Variant::types>::value, void>::type
-    load_variant(Archive & /*ar*/, int /*target*/, Variant & /*variant*/)
+    //! Loads a single alternative of a variant and moves it into the variant
+    /*! @internal */
+    template <class Archive, class Variant, class T> inline
+    void load_alternative( Archive & ar, Variant & variant )
     {
-      throw ::cereal::Exception("Error traversing variant during load");
+      T value;
+      ar( CEREAL_NVP_("data", value) );
+      variant = std::move( value );
     }
 
-    //! @internal
-    template<int N, class Variant, class H, class ... T, class Archive>
-    typename std::enable_if<N < boost::mpl::size<typename Variant::types>::value, void>::type
-    load_variant(Archive & ar, int target, Variant & variant)
+    //! The loaders for every alternative of a variant, indexed by which
+    /*! Dispatching through this table takes constant time, however many
+        alternatives the variant has.
+        @internal */
+    template <class Archive, class Variant, class ... Types>
+    struct variant_loaders
     {
-      if(N == target)
-      {
-        H value;
-        ar( CEREAL_NVP_("data", value) );
-        variant = value;
-      }
-      else
-        load_variant<N+1, Variant, T...>(ar, target, variant);
-    }
+      typedef void (*loader)( Archive &, Variant & );
+      static const loader table[sizeof...(Types)];
+    };
+
+    template <class Archive, class Variant, class ... Types>
+    const typename variant_loaders<Archive, Variant, Types...>::loader
+      variant_loaders<Archive, Variant, Types...>::table[sizeof...(Types)] = { &load_alternative<Archive, Variant, Types>... };
 
   } // namespace variant_detail
 
@@ -96,10 +98,10 @@ namespace cereal
 
     int32_t which;
     ar( CEREAL_NVP_("which", which) );
-    if(which >= boost::mpl::size<types>::value)
+    if(which < 0 || which >= boost::mpl::size<types>::value)
       throw Exception("Invalid 'which' selector when deserializing boost::variant");
 
-    variant_detail::load_variant<0, boost::variant<VariantTypes...>, VariantTypes...>(ar, which, variant);
+    variant_detail::variant_loaders<Archive, boost::variant<VariantTypes...>, VariantTypes...>::table[which](ar, variant);
   }
 } // namespace cereal
 
@@ -0,0 +1,367 @@
+/*! \file columnar.hpp
+    \brief Columnar encoding for containers of strings and of records
+    \ingroup STLSupport */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TYPES_COLUMNAR_HPP_
+#define CEREAL_TYPES_COLUMNAR_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/details/varint.hpp>
+#include <cereal/types/string.hpp>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+namespace cereal
+{
+  // ######################################################################
+  //! A wrapper around a container of strings that is serialized column by column
+  /*! @relates columnar
+      @internal */
+  template <class T>
+  struct ColumnarWrapper
+  {
+    ColumnarWrapper( T & c ) : container( c ) {}
+    T & container;
+
+    ColumnarWrapper & operator=( ColumnarWrapper const & ) = delete;
+  };
+
+  //! Serializes a container of strings as one array of lengths followed by one block of characters
+  /*! Binary archives normally write every string of a container as its own
+      size tag followed by its characters, which for many short strings costs
+      more than the characters themselves.  When wrapped with columnar, the
+      lengths of all strings are written together as a block of LEB128 varints,
+      followed by all of their characters concatenated into a single block.
+      Loading reads both blocks at once and carves the strings out of them.
+
+      Archives that do not support binary data save the container as usual.
+      Data saved through the wrapper must be loaded through it.  This works with
+      any container of std::basic_string that can be iterated and resized, such
+      as std::vector, std::deque and std::list.
+
+      @code{.cpp}
+      std::vector<std::string> symbols;
+      archive( cereal::columnar( symbols ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  ColumnarWrapper<T> columnar( T & container )
+  {
+    return {container};
+  }
+
+  namespace columnar_detail
+  {
+    //! The character type of the strings in a container
+    /*! @internal */
+    template <class T>
+    using char_type = typename std::remove_const<T>::type::value_type::value_type;
+  } // namespace columnar_detail
+
+  //! Saving for containers of strings wrapped with columnar, if binary data is supported
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<columnar_detail::char_type<T>>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, ColumnarWrapper<T> const & wrapper )
+  {
+    typedef columnar_detail::char_type<T> CharT;
+
+    std::vector<std::uint8_t> lengths;
+    std::size_t count = 0;
+    std::size_t total = 0;
+    for( auto const & s : wrapper.container )
+    {
+      varint_detail::append_varint( lengths, s.size() );
+      total += s.size();
+      ++count;
+    }
+
+    std::vector<CharT> characters;
+    characters.reserve( total );
+    for( auto const & s : wrapper.container )
+      characters.insert( characters.end(), s.begin(), s.end() );
+
+    ar( make_size_tag( static_cast<size_type>( count ) ) );
+    ar( make_size_tag( static_cast<size_type>( lengths.size() ) ) );
+    ar( binary_data( lengths.data(), lengths.size() ) );
+    ar( binary_data( characters.data(), characters.size() * sizeof(CharT) ) );
+  }
+
+  //! Loading for containers of strings wrapped with columnar, if binary data is supported
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_input_serializable<BinaryData<columnar_detail::char_type<T>>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, ColumnarWrapper<T> & wrapper )
+  {
+    typedef columnar_detail::char_type<T> CharT;
+
+    size_type count;
+    ar( make_size_tag( count ) );
+
+    size_type lengthsSize;
+    ar( make_size_tag( lengthsSize ) );
+
+    // Every length takes at least one byte, which bounds the count before allocating for it
+    if( count > lengthsSize )
+      throw Exception("Columnar strings hold more lengths than their encoding can contain");
+
+    std::vector<std::uint8_t> lengths( static_cast<std::size_t>( lengthsSize ) );
+    ar( binary_data( lengths.data(), lengths.size() ) );
+
+    std::vector<std::size_t> sizes( static_cast<std::size_t>( count ) );
+    std::size_t total = 0;
+    auto pos = static_cast<std::uint8_t const *>( lengths.data() );
+    auto const end = pos + lengths.size();
+    for( auto & size : sizes )
+    {
+      auto const length = varint_detail::decode_varint( pos, end );
+      if( length > ( std::numeric_limits<std::size_t>::max() / sizeof(CharT) ) - total )
+        throw Exception("Columnar strings are too long");
+
+      size = static_cast<std::size_t>( length );
+      total += size;
+    }
+
+    if( pos != end )
+      throw Exception("Columnar string lengths hold more data than their count");
+
+    std::vector<CharT> characters( total );
+    ar( binary_data( characters.data(), characters.size() * sizeof(CharT) ) );
+
+    wrapper.container.clear();
+    wrapper.container.resize( sizes.size() );
+
+    auto data = characters.data();
+    auto size = sizes.begin();
+    for( auto & s : wrapper.container )
+    {
+      s.assign( data, *size );
+      data += *size++;
+    }
+  }
+
+  //! Saving for containers of strings wrapped with columnar, which is the same as saving the container
+  template <class Archive, class T> inline
+  typename std::enable_if<!traits::is_output_serializable<BinaryData<columnar_detail::char_type<T>>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, ColumnarWrapper<T> const & wrapper )
+  {
+    CEREAL_SAVE_FUNCTION_NAME( ar, static_cast<typename std::add_const<T>::type &>( wrapper.container ) );
+  }
+
+  //! Loading for containers of strings wrapped with columnar, which is the same as loading the container
+  template <class Archive, class T> inline
+  typename std::enable_if<!traits::is_input_serializable<BinaryData<columnar_detail::char_type<T>>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, ColumnarWrapper<T> & wrapper )
+  {
+    CEREAL_LOAD_FUNCTION_NAME( ar, wrapper.container );
+  }
+
+  // ######################################################################
+  //! A wrapper around a container of records that is serialized one member at a time
+  /*! @relates columns
+      @internal */
+  template <class T, class ... Members>
+  struct ColumnsWrapper
+  {
+    typedef std::tuple<Members...> member_tuple;
+
+    ColumnsWrapper( T & c, Members ... m ) : container( c ), members( m... ) {}
+    T & container;
+    member_tuple members;
+
+    ColumnsWrapper & operator=( ColumnsWrapper const & ) = delete;
+  };
+
+  //! Serializes a container of records as a struct of arrays, one column for each given member
+  /*! Serializing a container of records normally writes every member of every
+      record in turn.  When wrapped with columns, the number of records is written,
+      followed by the given members of all records, one member after the other.
+      Columns of arithmetic or trivially serializable members are gathered and
+      written as a single block of binary data by archives that support it, which
+      makes them contiguous for bulk copies and compresses them far better.  Other
+      columns, and all columns of other archives, are written as arrays of values.
+
+      Loading resizes the container to the number of records, then scatters each
+      column back into the records.  Only the given members are serialized, and
+      data saved through the wrapper must be loaded through it with the same members
+      in the same order.  This works with any container of records that can be
+      iterated and resized, such as std::vector and std::deque.
+
+      @code{.cpp}
+      struct Trade
+      {
+        double price;
+        std::uint32_t quantity;
+        std::string symbol;
+      };
+
+      std::vector<Trade> trades;
+      archive( cereal::columns( trades, &Trade::price, &Trade::quantity, &Trade::symbol ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T, class ... Members> inline
+  ColumnsWrapper<T, Members...> columns( T & container, Members ... members )
+  {
+    return {container, members...};
+  }
+
+  //! A single column of a container of records
+  /*! @relates columns
+      @internal */
+  template <class T, class Member>
+  struct ColumnWrapper
+  {
+    T & container;
+    Member member;
+    std::size_t count;
+
+    ColumnWrapper & operator=( ColumnWrapper const & ) = delete;
+  };
+
+  namespace columnar_detail
+  {
+    //! The type of the member a member pointer points to
+    /*! @internal */
+    template <class Member> struct member_type;
+
+    template <class Record, class M>
+    struct member_type<M Record::*> { typedef M type; };
+
+    //! Whether the column for Member is saved as binary data by Archive
+    /*! @internal */
+    template <class Archive, class Member, class M = typename member_type<Member>::type>
+    struct is_output_binary_column : std::integral_constant<bool,
+      traits::is_output_serializable<BinaryData<M>, Archive>::value &&
+      traits::is_trivially_serializable<M>::value && !std::is_same<M, bool>::value> {};
+
+    //! Whether the column for Member is loaded as binary data by Archive
+    /*! @internal */
+    template <class Archive, class Member, class M = typename member_type<Member>::type>
+    struct is_input_binary_column : std::integral_constant<bool,
+      traits::is_input_serializable<BinaryData<M>, Archive>::value &&
+      traits::is_trivially_serializable<M>::value && !std::is_same<M, bool>::value> {};
+
+    //! Serializes the columns of wrapper from the Ith member on, past the last member
+    /*! @internal */
+    template <std::size_t I, class Archive, class W> inline
+    typename std::enable_if<(I == std::tuple_size<typename W::member_tuple>::value), void>::type
+    process_columns( Archive &, W &, std::size_t )
+    { }
+
+    //! Serializes the columns of wrapper from the Ith member on
+    /*! @internal */
+    template <std::size_t I, class Archive, class W> inline
+    typename std::enable_if<(I < std::tuple_size<typename W::member_tuple>::value), void>::type
+    process_columns( Archive & ar, W & wrapper, std::size_t count )
+    {
+      typedef typename std::tuple_element<I, typename W::member_tuple>::type Member;
+      ar( ColumnWrapper<typename std::remove_reference<decltype(wrapper.container)>::type, Member>{ wrapper.container, std::get<I>( wrapper.members ), count } );
+      process_columns<I + 1>( ar, wrapper, count );
+    }
+  } // namespace columnar_detail
+
+  //! Saving for containers of records wrapped with columns
+  template <class Archive, class T, class ... Members> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, ColumnsWrapper<T, Members...> const & wrapper )
+  {
+    auto const count = static_cast<std::size_t>( wrapper.container.size() );
+    ar( make_nvp( "size", static_cast<size_type>( count ) ) );
+    columnar_detail::process_columns<0>( ar, wrapper, count );
+  }
+
+  //! Loading for containers of records wrapped with columns
+  template <class Archive, class T, class ... Members> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, ColumnsWrapper<T, Members...> & wrapper )
+  {
+    size_type count;
+    ar( make_nvp( "size", count ) );
+    ar.checkLoadSize( count );
+
+    wrapper.container.clear();
+    wrapper.container.resize( static_cast<std::size_t>( count ) );
+    columnar_detail::process_columns<0>( ar, wrapper, static_cast<std::size_t>( count ) );
+  }
+
+  //! Saving for a column of records as a block of binary data
+  template <class Archive, class T, class Member> inline
+  typename std::enable_if<columnar_detail::is_output_binary_column<Archive, Member>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, ColumnWrapper<T, Member> const & wrapper )
+  {
+    typedef typename columnar_detail::member_type<Member>::type M;
+
+    std::vector<M> column;
+    column.reserve( wrapper.count );
+    for( auto const & record : wrapper.container )
+      column.push_back( record.*wrapper.member );
+
+    ar( binary_data( column.data(), column.size() * sizeof(M) ) );
+  }
+
+  //! Loading for a column of records from a block of binary data
+  template <class Archive, class T, class Member> inline
+  typename std::enable_if<columnar_detail::is_input_binary_column<Archive, Member>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, ColumnWrapper<T, Member> & wrapper )
+  {
+    typedef typename columnar_detail::member_type<Member>::type M;
+
+    std::vector<M> column( wrapper.count );
+    ar( binary_data( column.data(), column.size() * sizeof(M) ) );
+
+    auto value = column.begin();
+    for( auto & record : wrapper.container )
+      record.*wrapper.member = *value++;
+  }
+
+  //! Saving for a column of records as an array of values
+  template <class Archive, class T, class Member> inline
+  typename std::enable_if<!columnar_detail::is_output_binary_column<Archive, Member>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, ColumnWrapper<T, Member> const & wrapper )
+  {
+    ar( make_size_tag( static_cast<size_type>( wrapper.count ) ) );
+    for( auto const & record : wrapper.container )
+      ar( record.*wrapper.member );
+  }
+
+  //! Loading for a column of records from an array of values
+  template <class Archive, class T, class Member> inline
+  typename std::enable_if<!columnar_detail::is_input_binary_column<Archive, Member>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, ColumnWrapper<T, Member> & wrapper )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    if( size != wrapper.count )
+      throw Exception("Column holds a different number of values than there are records");
+
+    for( auto & record : wrapper.container )
+      ar( record.*wrapper.member );
+  }
+} // namespace cereal
+
+#endif // CEREAL_TYPES_COLUMNAR_HPP_
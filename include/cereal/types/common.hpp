@@ -36,7 +36,7 @@ namespace cereal
 {
   namespace common_detail
   {
-    //! Serialization for arrays if BinaryData is supported and we are arithmetic
+    //! Serialization for arrays if BinaryData is supported and we are arithmetic or trivially serializable
     /*! @internal */
     template <class Archive, class T> inline
     void serializeArray( Archive & ar, T & array, std::true_type /* binary_supported */ )
@@ -44,7 +44,7 @@ namespace cereal
       ar( binary_data( array, sizeof(array) ) );
     }
 
-    //! Serialization for arrays if BinaryData is not supported or we are not arithmetic
+    //! Serialization for arrays if BinaryData is not supported or we are not arithmetic or trivially serializable
     /*! @internal */
     template <class Archive, class T> inline
     void serializeArray( Archive & ar, T & array, std::false_type /* binary_supported */ )
@@ -88,6 +88,24 @@ namespace cereal
     };
   }
 
+  namespace traits
+  {
+    //! Enums save their underlying type
+    template <class T>
+    struct fixed_binary_size<T, typename std::enable_if<std::is_enum<T>::value>::type> :
+      std::integral_constant<std::size_t, sizeof(T)> {};
+
+    //! Enums are saved as the bytes of their underlying type, so containers of them can be copied in bulk
+    template <class T>
+    struct is_trivially_serializable<T, typename std::enable_if<std::is_enum<T>::value>::type> : std::true_type {};
+
+    //! C style arrays of fixed size or trivially serializable types
+    template <class T, std::size_t N>
+    struct fixed_binary_size<T[N], typename std::enable_if<has_fixed_binary_size<T>::value ||
+                                                           is_trivially_serializable<typename std::remove_all_extents<T>::type>::value>::type> :
+      detail::fixed_binary_array_size<T, N, sizeof(T[N]), is_trivially_serializable<typename std::remove_all_extents<T>::type>::value> {};
+  } // namespace traits
+
   //! Saving for enum types
   template <class Archive, class T> inline
   typename std::enable_if<common_detail::is_enum<T>::value,
@@ -106,6 +124,63 @@ namespace cereal
     t = reinterpret_cast<typename common_detail::is_enum<T>::type const &>( value );
   }
 
+  //! Saving for containers wrapped with in_place, which is the same as saving the container
+  /*! @relates in_place */
+  template <class Archive, class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, InPlaceWrapper<T> const & wrapper )
+  {
+    CEREAL_SAVE_FUNCTION_NAME( ar, static_cast<typename std::add_const<T>::type &>( wrapper.container ) );
+  }
+
+  //! Saving for blocks of data wrapped with deduplicated
+  /*! The id is followed by the data itself unless it repeats an earlier block.  An id of
+      zero marks a block below the threshold, which is not registered with the archive.
+      @relates deduplicated */
+  template <class Archive, class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, DeduplicatedWrapper<T> const & wrapper )
+  {
+    typedef typename std::remove_const<T>::type::value_type ValueT;
+    static_assert( traits::is_trivially_serializable<ValueT>::value && !std::is_same<ValueT, bool>::value,
+                   "deduplicated requires a contiguous container of trivially serializable elements" );
+
+    auto const & value = wrapper.value;
+    auto const bytes = value.size() * sizeof(ValueT);
+    std::uint32_t const id = bytes < wrapper.threshold ? 0 : ar.registerDeduplicatedBlob( value.data(), bytes );
+    ar( CEREAL_NVP_("id", id) );
+
+    if( id == 0 || ( id & detail::msb_32bit ) )
+      ar( CEREAL_NVP_("data", value) );
+  }
+
+  //! Loading for blocks of data wrapped with deduplicated
+  /*! @relates deduplicated */
+  template <class Archive, class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, DeduplicatedWrapper<T> & wrapper )
+  {
+    typedef typename T::value_type ValueT;
+
+    std::uint32_t id;
+    ar( CEREAL_NVP_("id", id) );
+
+    auto & value = wrapper.value;
+    if( id == 0 || ( id & detail::msb_32bit ) )
+    {
+      ar( CEREAL_NVP_("data", value) );
+      if( id )
+        ar.registerDeduplicatedBlob( id, value.empty() ? nullptr : &value[0], value.size() * sizeof(ValueT) );
+    }
+    else
+    {
+      auto const & blob = ar.getDeduplicatedBlob( id );
+      if( blob.size() % sizeof(ValueT) )
+        throw Exception("Error while trying to deserialize a deduplicated blob. Its size does not match the type it is loaded into");
+
+      value.resize( blob.size() / sizeof(ValueT) );
+      if( !value.empty() )
+        std::memcpy( &value[0], blob.data(), blob.size() );
+    }
+  }
+
   //! Serialization for raw pointers
   /*! This exists only to throw a static_assert to let users know we don't support raw pointers. */
   template <class Archive, class T> inline
@@ -122,7 +197,7 @@ namespace cereal
   {
     common_detail::serializeArray( ar, array,
         std::integral_constant<bool, traits::is_output_serializable<BinaryData<T>, Archive>::value &&
-                                     std::is_arithmetic<typename std::remove_all_extents<T>::type>::value>() );
+                                     traits::is_trivially_serializable<typename std::remove_all_extents<T>::type>::value>() );
   }
 } // namespace cereal
 
@@ -51,6 +51,19 @@ namespace cereal
         CEREAL_NVP_("imag", imag) );
     bits = {real, imag};
   }
+
+  namespace traits
+  {
+    //! std::complex saves its real and imaginary parts
+    template <class T>
+    struct fixed_binary_size<std::complex<T>, typename std::enable_if<has_fixed_binary_size<T>::value>::type> :
+      detail::fixed_binary_size_sum<T, T> {};
+
+    //! std::complex of arithmetic types is two values laid out one after the other, so containers of
+    //! them can be copied in bulk
+    template <class T>
+    struct is_trivially_serializable<std::complex<T>, typename std::enable_if<std::is_arithmetic<T>::value>::type> : std::true_type {};
+  } // namespace traits
 } // namespace cereal
 
 #endif // CEREAL_TYPES_COMPLEX_HPP_
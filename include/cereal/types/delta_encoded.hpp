@@ -0,0 +1,297 @@
+/*! \file delta_encoded.hpp
+    \brief Delta and frame of reference encoding for vectors of integers
+    \ingroup STLSupport */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TYPES_DELTA_ENCODED_HPP_
+#define CEREAL_TYPES_DELTA_ENCODED_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/details/varint.hpp>
+#include <cereal/types/vector.hpp>
+#include <algorithm>
+#include <limits>
+
+namespace cereal
+{
+  // ######################################################################
+  //! A wrapper around a vector of integers that is saved as packed differences
+  /*! @relates delta_encoded
+      @internal */
+  template <class T>
+  struct DeltaEncodedWrapper
+  {
+    DeltaEncodedWrapper( T & v ) : vector( v ) {}
+    T & vector;
+
+    DeltaEncodedWrapper & operator=( DeltaEncodedWrapper const & ) = delete;
+  };
+
+  //! Serializes a vector of integers as the bit packed differences between consecutive values
+  /*! Sorted or slowly changing sequences, such as timestamps or ids, have
+      differences much smaller than the values themselves.  When wrapped with
+      delta_encoded, binary archives save the first value as a varint and then
+      the difference of every other value from the one before it, zigzag encoded so that decreasing values are small too.
+      The differences are split into blocks of delta_encoded_detail::block_size,
+      and each block stores its smallest difference as a reference followed by
+      the distance of every difference from it, bit packed with the width of the
+      largest one.  A block of evenly spaced values therefore takes a few bytes
+      in total, however large the values are.
+
+      Loading unpacks each block and sums the differences back into values in
+      two tight loops.  Archives that do not support binary data save the vector
+      as usual.  Data saved through the wrapper must be loaded through it.
+
+      @code{.cpp}
+      std::vector<std::uint64_t> timestamps;
+      archive( cereal::delta_encoded( timestamps ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  DeltaEncodedWrapper<T> delta_encoded( T & vector )
+  {
+    static_assert( std::is_integral<typename std::remove_const<T>::type::value_type>::value &&
+                   !std::is_same<typename std::remove_const<T>::type::value_type, bool>::value,
+                   "delta_encoded requires a vector of integers" );
+    return {vector};
+  }
+
+  namespace delta_encoded_detail
+  {
+    //! The number of differences packed together with the same reference and width
+    /*! @internal */
+    static const std::size_t block_size = 128;
+
+    //! The number of bits needed to represent a value
+    /*! @internal */
+    inline unsigned int bit_width( std::uint64_t value )
+    {
+      unsigned int width = 0;
+      while( value )
+      {
+        ++width;
+        value >>= 1;
+      }
+      return width;
+    }
+
+    //! Packs values of the given width, least significant bit first, into a zeroed buffer
+    /*! @internal */
+    inline void pack( std::uint64_t const * values, std::size_t count, unsigned int width, std::uint8_t * out )
+    {
+      if( width == 0 )
+        return;
+
+      std::size_t bit = 0;
+      for( std::size_t i = 0; i < count; ++i, bit += width )
+      {
+        auto const value = values[i];
+        auto const shift = static_cast<unsigned int>( bit & 7 );
+        auto p = out + ( bit >> 3 );
+
+        p[0] |= static_cast<std::uint8_t>( value << shift );
+        for( unsigned int written = 8 - shift; written < width; written += 8 )
+          *++p |= static_cast<std::uint8_t>( value >> written );
+      }
+    }
+
+    //! Unpacks values of the given width that were packed with pack
+    /*! @internal */
+    inline void unpack( std::uint8_t const * in, std::size_t count, unsigned int width, std::uint64_t * values )
+    {
+      if( width == 0 )
+      {
+        std::fill( values, values + count, std::uint64_t( 0 ) );
+        return;
+      }
+
+      auto const mask = width == 64 ? ~std::uint64_t( 0 ) : ( std::uint64_t( 1 ) << width ) - 1;
+
+      std::size_t bit = 0;
+      for( std::size_t i = 0; i < count; ++i, bit += width )
+      {
+        auto const shift = static_cast<unsigned int>( bit & 7 );
+        auto p = in + ( bit >> 3 );
+
+        std::uint64_t value = p[0] >> shift;
+        for( unsigned int read = 8 - shift; read < width; read += 8 )
+          value |= static_cast<std::uint64_t>( *++p ) << read;
+
+        values[i] = value & mask;
+      }
+    }
+
+    //! The number of bytes taken by count packed values of the given width
+    /*! @internal */
+    inline std::size_t packed_size( std::size_t count, unsigned int width )
+    {
+      return ( count * width + 7 ) / 8;
+    }
+  } // namespace delta_encoded_detail
+
+  //! Saving for vectors of integers wrapped with delta_encoded, if binary data is supported
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, DeltaEncodedWrapper<T> const & wrapper )
+  {
+    typedef typename std::remove_const<T>::type::value_type ValueT;
+    typedef typename std::make_unsigned<ValueT>::type UnsignedT;
+    typedef typename std::make_signed<ValueT>::type SignedT;
+
+    auto const & vector = wrapper.vector;
+
+    std::vector<std::uint8_t> encoded;
+    std::uint64_t block[delta_encoded_detail::block_size];
+    UnsignedT previous = 0;
+
+    // The first value is saved as is, so that it does not widen the first block
+    if( !vector.empty() )
+    {
+      previous = static_cast<UnsignedT>( vector.front() );
+      varint_detail::append_varint( encoded, previous );
+    }
+
+    for( std::size_t begin = 1; begin < vector.size(); begin += delta_encoded_detail::block_size )
+    {
+      auto const count = std::min( delta_encoded_detail::block_size, vector.size() - begin );
+
+      // Differences wrap around in the unsigned type and are reinterpreted as signed
+      for( std::size_t i = 0; i < count; ++i )
+      {
+        auto const value = static_cast<UnsignedT>( vector[begin + i] );
+        block[i] = varint_detail::zigzag_encode( static_cast<SignedT>( static_cast<UnsignedT>( value - previous ) ) );
+        previous = value;
+      }
+
+      auto const reference = *std::min_element( block, block + count );
+      std::uint64_t range = 0;
+      for( std::size_t i = 0; i < count; ++i )
+        range |= ( block[i] -= reference );
+
+      auto const width = delta_encoded_detail::bit_width( range );
+      encoded.push_back( static_cast<std::uint8_t>( width ) );
+      varint_detail::append_varint( encoded, reference );
+
+      auto const offset = encoded.size();
+      encoded.resize( offset + delta_encoded_detail::packed_size( count, width ) );
+      delta_encoded_detail::pack( block, count, width, encoded.data() + offset );
+    }
+
+    ar( make_size_tag( static_cast<size_type>( vector.size() ) ) );
+    ar( make_size_tag( static_cast<size_type>( encoded.size() ) ) );
+    ar( binary_data( encoded.data(), encoded.size() ) );
+  }
+
+  //! Loading for vectors of integers wrapped with delta_encoded, if binary data is supported
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_input_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, DeltaEncodedWrapper<T> & wrapper )
+  {
+    typedef typename T::value_type ValueT;
+    typedef typename std::make_unsigned<ValueT>::type UnsignedT;
+
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    size_type encodedSize;
+    ar( make_size_tag( encodedSize ) );
+
+    // Every block takes at least two bytes, which bounds the size before allocating for it
+    if( size > encodedSize / 2 * delta_encoded_detail::block_size + 1 )
+      throw Exception("Delta encoded vector holds more values than its encoding can contain");
+
+    std::vector<std::uint8_t> encoded( static_cast<std::size_t>( encodedSize ) );
+    ar( binary_data( encoded.data(), encoded.size() ) );
+
+    auto & vector = wrapper.vector;
+    vector.resize( static_cast<std::size_t>( size ) );
+
+    auto pos = static_cast<std::uint8_t const *>( encoded.data() );
+    auto const end = pos + encoded.size();
+    std::uint64_t block[delta_encoded_detail::block_size];
+    UnsignedT previous = 0;
+
+    if( !vector.empty() )
+    {
+      auto const first = varint_detail::decode_varint( pos, end );
+      if( first > std::numeric_limits<UnsignedT>::max() )
+        throw Exception("Delta encoded vector holds a value that is too large for its type");
+
+      previous = static_cast<UnsignedT>( first );
+      vector.front() = static_cast<ValueT>( previous );
+    }
+
+    for( std::size_t begin = 1; begin < vector.size(); begin += delta_encoded_detail::block_size )
+    {
+      auto const count = std::min( delta_encoded_detail::block_size, vector.size() - begin );
+
+      if( pos == end )
+        throw Exception("Delta encoded vector is truncated");
+
+      unsigned int const width = *pos++;
+      if( width > 64 )
+        throw Exception("Delta encoded vector has an invalid bit width");
+
+      auto const reference = varint_detail::decode_varint( pos, end );
+
+      auto const packedSize = delta_encoded_detail::packed_size( count, width );
+      if( static_cast<std::size_t>( end - pos ) < packedSize )
+        throw Exception("Delta encoded vector is truncated");
+
+      delta_encoded_detail::unpack( pos, count, width, block );
+      pos += packedSize;
+
+      for( std::size_t i = 0; i < count; ++i )
+      {
+        previous = static_cast<UnsignedT>( previous + static_cast<UnsignedT>( varint_detail::zigzag_decode( block[i] + reference ) ) );
+        vector[begin + i] = static_cast<ValueT>( previous );
+      }
+    }
+
+    if( pos != end )
+      throw Exception("Delta encoded vector holds more data than its size");
+  }
+
+  //! Saving for vectors wrapped with delta_encoded, which is the same as saving the vector
+  template <class Archive, class T> inline
+  typename std::enable_if<!traits::is_output_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, DeltaEncodedWrapper<T> const & wrapper )
+  {
+    CEREAL_SAVE_FUNCTION_NAME( ar, static_cast<typename std::add_const<T>::type &>( wrapper.vector ) );
+  }
+
+  //! Loading for vectors wrapped with delta_encoded, which is the same as loading the vector
+  template <class Archive, class T> inline
+  typename std::enable_if<!traits::is_input_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, DeltaEncodedWrapper<T> & wrapper )
+  {
+    CEREAL_LOAD_FUNCTION_NAME( ar, wrapper.vector );
+  }
+} // namespace cereal
+
+#endif // CEREAL_TYPES_DELTA_ENCODED_HPP_
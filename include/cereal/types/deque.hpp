@@ -32,12 +32,74 @@
 
 #include <cereal/cereal.hpp>
 #include <deque>
+#include <memory>
 
 namespace cereal
 {
+  namespace deque_detail
+  {
+    //! Calls f( data, count ) for each run of elements that a deque stores contiguously
+    /*! A deque keeps its elements in a series of fixed size blocks, so this walks it with
+        its iterators, which step within a block without recomputing its position, and
+        starts a new run wherever the next element is not adjacent to the last.
+        @internal */
+    template <class Deque, class F> inline
+    void for_each_block( Deque & deque, F && f )
+    {
+      auto it = deque.begin();
+      auto const end = deque.end();
+      while( it != end )
+      {
+        auto * const block = std::addressof( *it );
+        std::size_t count = 1;
+        for( ++it; it != end && std::addressof( *it ) == block + count; ++it )
+          ++count;
+
+        f( block, count );
+      }
+    }
+  } // namespace deque_detail
+
+  //! Saving for std::deque of arithmetic (but not bool) or trivially serializable types
+  //! using binary serialization, if supported
+  /*! Each block of the deque is written as binary data, so the result is the same as
+      for a std::vector holding the same elements. */
+  template <class Archive, class T, class A> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<T>, Archive>::value
+                          && traits::is_trivially_serializable<T>::value && !std::is_same<T, bool>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::deque<T, A> const & deque )
+  {
+    ar( make_size_tag( static_cast<size_type>(deque.size()) ) );
+
+    deque_detail::for_each_block( deque, [&]( T const * data, std::size_t count )
+    {
+      ar( binary_data( static_cast<T const *>( data ), count * sizeof(T) ) );
+    } );
+  }
+
+  //! Loading for std::deque of arithmetic (but not bool) or trivially serializable types
+  //! using binary serialization, if supported
+  template <class Archive, class T, class A> inline
+  typename std::enable_if<traits::is_input_serializable<BinaryData<T>, Archive>::value
+                          && traits::is_trivially_serializable<T>::value && !std::is_same<T, bool>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::deque<T, A> & deque )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    deque.resize( static_cast<size_t>( size ) );
+
+    deque_detail::for_each_block( deque, [&]( T * data, std::size_t count )
+    {
+      ar( binary_data( static_cast<T *>( data ), count * sizeof(T) ) );
+    } );
+  }
+
   //! Saving for std::deque
   template <class Archive, class T, class A> inline
-  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::deque<T, A> const & deque )
+  typename std::enable_if<!traits::is_output_serializable<BinaryData<T>, Archive>::value
+                          || !traits::is_trivially_serializable<T>::value || std::is_same<T, bool>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::deque<T, A> const & deque )
   {
     ar( make_size_tag( static_cast<size_type>(deque.size()) ) );
 
@@ -47,7 +109,9 @@ namespace cereal
 
   //! Loading for std::deque
   template <class Archive, class T, class A> inline
-  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::deque<T, A> & deque )
+  typename std::enable_if<!traits::is_input_serializable<BinaryData<T>, Archive>::value
+                          || !traits::is_trivially_serializable<T>::value || std::is_same<T, bool>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::deque<T, A> & deque )
   {
     size_type size;
     ar( make_size_tag( size ) );
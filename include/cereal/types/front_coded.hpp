@@ -0,0 +1,239 @@
+/*! \file front_coded.hpp
+    \brief Front coding of the string keys of ordered maps and sets
+    \ingroup STLSupport */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TYPES_FRONT_CODED_HPP_
+#define CEREAL_TYPES_FRONT_CODED_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/details/varint.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/set.hpp>
+#include <cereal/types/string.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace cereal
+{
+  // ######################################################################
+  //! A wrapper around an ordered map or set of strings whose keys are saved front coded
+  /*! @relates front_coded
+      @internal */
+  template <class T>
+  struct FrontCodedWrapper
+  {
+    FrontCodedWrapper( T & c ) : container( c ) {}
+    T & container;
+
+    FrontCodedWrapper & operator=( FrontCodedWrapper const & ) = delete;
+  };
+
+  //! Serializes an ordered map or set with string keys, storing each key as its difference from the one before
+  /*! The keys of an ordered container are saved in sorted order, so consecutive keys
+      such as paths or qualified names tend to share a long prefix.  When wrapped with
+      front_coded, binary archives save each key as the length of the prefix it shares
+      with the previous key and the remaining suffix, with both lengths as varints.
+      All keys are written together as a single block of binary data, followed by the
+      mapped values of a map in the same order.
+
+      Loading rebuilds each key from the previous one in a single buffer, and inserts
+      the elements at the end of the container, as for an ordinary map or set.
+      Archives that do not support binary data save the container as usual.  Data
+      saved through the wrapper must be loaded through it.
+
+      This works with std::map, std::multimap, std::set and std::multiset whose keys
+      are strings of a single byte character type.
+
+      @code{.cpp}
+      std::map<std::string, Route> routes;
+      archive( cereal::front_coded( routes ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  FrontCodedWrapper<T> front_coded( T & container )
+  {
+    static_assert( sizeof(typename std::remove_const<T>::type::key_type::value_type) == 1,
+                   "front_coded requires a container with keys that are strings of single byte characters" );
+    return {container};
+  }
+
+  namespace front_coded_detail
+  {
+    //! Gets the key of an element of a set
+    /*! @internal */
+    template <class CharT, class Traits, class Alloc> inline
+    std::basic_string<CharT, Traits, Alloc> const & key_of( std::basic_string<CharT, Traits, Alloc> const & key )
+    {
+      return key;
+    }
+
+    //! Gets the key of an element of a map
+    /*! @internal */
+    template <class K, class V> inline
+    K const & key_of( std::pair<K const, V> const & item )
+    {
+      return item.first;
+    }
+
+    //! Saves the mapped value of an element of a map
+    /*! @internal */
+    template <class Archive, class K, class V> inline
+    void save_value( Archive & ar, std::pair<K const, V> const & item )
+    {
+      ar( item.second );
+    }
+
+    //! Elements of a set have no mapped value
+    /*! @internal */
+    template <class Archive, class Key> inline
+    void save_value( Archive &, Key const & )
+    { }
+
+    //! Loads the mapped value of an element of a map and inserts it at the end
+    /*! @internal */
+    template <class Archive, class MapT> inline
+    auto insert( Archive & ar, MapT & map, typename MapT::key_type const & key ) -> decltype( typename MapT::mapped_type(), void() )
+    {
+      typename MapT::mapped_type value;
+      ar( value );
+      #ifdef CEREAL_OLDER_GCC
+      map.insert( map.end(), std::make_pair( key, std::move( value ) ) );
+      #else // NOT CEREAL_OLDER_GCC
+      map.emplace_hint( map.end(), key, std::move( value ) );
+      #endif // NOT CEREAL_OLDER_GCC
+    }
+
+    //! Inserts a key at the end of a set
+    /*! @internal */
+    template <class Archive, class SetT> inline
+    void insert( Archive &, SetT & set, typename SetT::value_type const & key )
+    {
+      set.insert( set.end(), key );
+    }
+  } // namespace front_coded_detail
+
+  //! Saving for containers wrapped with front_coded, if binary data is supported
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, FrontCodedWrapper<T> const & wrapper )
+  {
+    auto const & container = wrapper.container;
+
+    std::vector<std::uint8_t> encoded;
+    typename std::remove_const<T>::type::key_type const * previous = nullptr;
+    for( auto const & item : container )
+    {
+      auto const & key = front_coded_detail::key_of( item );
+
+      std::size_t prefix = 0;
+      if( previous )
+      {
+        auto const length = std::min( key.size(), previous->size() );
+        while( prefix < length && key[prefix] == (*previous)[prefix] )
+          ++prefix;
+      }
+
+      varint_detail::append_varint( encoded, prefix );
+      varint_detail::append_varint( encoded, key.size() - prefix );
+      auto const suffix = reinterpret_cast<std::uint8_t const *>( key.data() + prefix );
+      encoded.insert( encoded.end(), suffix, suffix + ( key.size() - prefix ) );
+
+      previous = &key;
+    }
+
+    ar( make_size_tag( static_cast<size_type>( container.size() ) ) );
+    ar( make_size_tag( static_cast<size_type>( encoded.size() ) ) );
+    ar( binary_data( encoded.data(), encoded.size() ) );
+
+    for( auto const & item : container )
+      front_coded_detail::save_value( ar, item );
+  }
+
+  //! Loading for containers wrapped with front_coded, if binary data is supported
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_input_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, FrontCodedWrapper<T> & wrapper )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    size_type encodedSize;
+    ar( make_size_tag( encodedSize ) );
+
+    // Every key takes at least two bytes, which bounds the size before loading anything for it
+    if( size > encodedSize / 2 )
+      throw Exception("Front coded container holds more keys than its encoding can contain");
+
+    std::vector<std::uint8_t> encoded( static_cast<std::size_t>( encodedSize ) );
+    ar( binary_data( encoded.data(), encoded.size() ) );
+
+    auto & container = wrapper.container;
+    container.clear();
+
+    auto pos = static_cast<std::uint8_t const *>( encoded.data() );
+    auto const end = pos + encoded.size();
+    typename T::key_type key;
+    for( size_type i = 0; i < size; ++i )
+    {
+      auto const prefix = varint_detail::decode_varint( pos, end );
+      auto const suffix = varint_detail::decode_varint( pos, end );
+      if( prefix > key.size() )
+        throw Exception("Front coded key shares more characters than the previous key holds");
+      if( suffix > static_cast<std::uint64_t>( end - pos ) )
+        throw Exception("Front coded container is truncated");
+
+      key.resize( static_cast<std::size_t>( prefix ) );
+      key.append( reinterpret_cast<typename T::key_type::value_type const *>( pos ), static_cast<std::size_t>( suffix ) );
+      pos += suffix;
+
+      front_coded_detail::insert( ar, container, key );
+    }
+
+    if( pos != end )
+      throw Exception("Front coded container holds more data than its size");
+  }
+
+  //! Saving for containers wrapped with front_coded, which is the same as saving the container
+  template <class Archive, class T> inline
+  typename std::enable_if<!traits::is_output_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, FrontCodedWrapper<T> const & wrapper )
+  {
+    CEREAL_SAVE_FUNCTION_NAME( ar, static_cast<typename std::add_const<T>::type &>( wrapper.container ) );
+  }
+
+  //! Loading for containers wrapped with front_coded, which is the same as loading the container
+  template <class Archive, class T> inline
+  typename std::enable_if<!traits::is_input_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, FrontCodedWrapper<T> & wrapper )
+  {
+    CEREAL_LOAD_FUNCTION_NAME( ar, wrapper.container );
+  }
+} // namespace cereal
+
+#endif // CEREAL_TYPES_FRONT_CODED_HPP_
@@ -49,6 +49,108 @@ namespace cereal
       }
     }
 
+    //! Kept out of this namespace so that argument dependent lookup does not
+    //! consider the load functions for the items
+    namespace item_detail
+    {
+      //! A map item whose value is loaded into the element after it is inserted
+      /*! The element is inserted at the end of the map with its loaded key and a value
+          initialized value, so the value is never moved.
+          @internal */
+      template <class MapT>
+      struct EmplaceItem
+      {
+        MapT & map;
+
+        EmplaceItem & operator=( EmplaceItem const & ) = delete;
+
+        //! Loads the item, this is only used with input archives
+        template <class Archive> inline
+        void CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar )
+        {
+          typename detail::load_storage<typename MapT::key_type, Archive>::type key;
+          ar( make_nvp<Archive>("key", key) );
+
+          #ifdef CEREAL_OLDER_GCC
+          auto const element = map.insert( map.end(), std::make_pair( std::move( detail::loaded_value( key ) ), typename MapT::mapped_type() ) );
+          #else // NOT CEREAL_OLDER_GCC
+          auto const element = map.emplace_hint( map.end(), std::piecewise_construct,
+                                                 std::forward_as_tuple( std::move( detail::loaded_value( key ) ) ),
+                                                 std::forward_as_tuple() );
+          #endif // NOT CEREAL_OLDER_GCC
+
+          ar( make_nvp<Archive>("value", element->second) );
+        }
+      };
+
+      //! A map item that loads its value into the element of the map with its key
+      /*! Items must be loaded in order, advancing current through the map.  Elements
+          with keys that precede the loaded key are removed, and an element is
+          inserted if the key is not found.
+          @internal */
+      template <class MapT>
+      struct InPlaceItem
+      {
+        MapT & map;
+        typename MapT::iterator & current;
+        typename MapT::key_type & key;
+
+        InPlaceItem & operator=( InPlaceItem const & ) = delete;
+
+        //! Loads the item, this is only used with input archives
+        template <class Archive> inline
+        void CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar )
+        {
+          ar( make_nvp<Archive>("key", key) );
+
+          auto const comp = map.key_comp();
+          while( current != map.end() && comp( current->first, key ) )
+            current = map.erase( current );
+
+          if( current == map.end() || comp( key, current->first ) )
+            #ifdef CEREAL_OLDER_GCC
+            current = map.insert( current, std::make_pair( key, typename MapT::mapped_type() ) );
+            #else // NOT CEREAL_OLDER_GCC
+            current = map.emplace_hint( current, key, typename MapT::mapped_type() );
+            #endif // NOT CEREAL_OLDER_GCC
+
+          ar( make_nvp<Archive>("value", current->second) );
+          ++current;
+        }
+      };
+    } // namespace item_detail
+
+    //! Loads elements into the nodes of the map, when the value is default constructible
+    /*! @internal */
+    template <class Archive, class MapT> inline
+    void loadElements( Archive & ar, MapT & map, size_type size, std::true_type /* default constructible */ )
+    {
+      for( size_type i = 0; i < size; ++i )
+      {
+        item_detail::EmplaceItem<MapT> item{ map };
+        ar( item );
+      }
+    }
+
+    //! Loads elements and moves them into the map, when the value is constructed by load_and_construct
+    /*! @internal */
+    template <class Archive, class MapT> inline
+    void loadElements( Archive & ar, MapT & map, size_type size, std::false_type /* default constructible */ )
+    {
+      for( size_type i = 0; i < size; ++i )
+      {
+        typename detail::load_storage<typename MapT::key_type, Archive>::type key;
+        typename detail::load_storage<typename MapT::mapped_type, Archive>::type value;
+
+        ar( make_map_item(key, value) );
+        #ifdef CEREAL_OLDER_GCC
+        map.insert( map.end(), std::make_pair( std::move( detail::loaded_value( key ) ), std::move( detail::loaded_value( value ) ) ) );
+        #else // NOT CEREAL_OLDER_GCC
+        map.emplace_hint( map.end(), std::move( detail::loaded_value( key ) ), std::move( detail::loaded_value( value ) ) );
+        #endif // NOT CEREAL_OLDER_GCC
+      }
+    }
+
     //! @internal
     template <class Archive, class MapT> inline
     void load( Archive & ar, MapT & map )
@@ -58,19 +160,30 @@ namespace cereal
 
       map.clear();
 
-      auto hint = map.begin();
-      for( size_t i = 0; i < size; ++i )
-      {
-        typename MapT::key_type key;
-        typename MapT::mapped_type value;
+      // Saved elements are already in order, so each one belongs at the end;
+      // hinting with end() makes every insertion amortized constant time and
+      // keeps equivalent keys of multi containers in their saved order
+      loadElements( ar, map, size, std::is_default_constructible<typename MapT::mapped_type>() );
+    }
 
-        ar( make_map_item(key, value) );
-        #ifdef CEREAL_OLDER_GCC
-        hint = map.insert( hint, std::make_pair(std::move(key), std::move(value)) );
-        #else // NOT CEREAL_OLDER_GCC
-        hint = map.emplace_hint( hint, std::move( key ), std::move( value ) );
-        #endif // NOT CEREAL_OLDER_GCC
+    //! Loads a map reusing the elements that it already holds, see in_place
+    /*! Saved maps are in key order, so the archive and the map are merged in a single pass.
+        @internal */
+    template <class Archive, class MapT> inline
+    void loadInPlace( Archive & ar, MapT & map )
+    {
+      size_type size;
+      ar( make_size_tag( size ) );
+
+      auto current = map.begin();
+      typename MapT::key_type key;
+      for( size_type i = 0; i < size; ++i )
+      {
+        item_detail::InPlaceItem<MapT> item{ map, current, key };
+        ar( item );
       }
+
+      map.erase( current, map.end() );
     }
   }
 
@@ -88,6 +201,13 @@ namespace cereal
     map_detail::load( ar, map );
   }
 
+  //! Loading for std::map wrapped with in_place
+  template <class Archive, class K, class T, class C, class A> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, InPlaceWrapper<std::map<K, T, C, A>> & wrapper )
+  {
+    map_detail::loadInPlace( ar, wrapper.container );
+  }
+
   //! Saving for std::multimap
   /*! @note serialization for this type is not guaranteed to preserve ordering */
   template <class Archive, class K, class T, class C, class A> inline
@@ -103,6 +223,14 @@ namespace cereal
   {
     map_detail::load( ar, multimap );
   }
+
+  //! Loading for std::multimap wrapped with in_place
+  /*! @note serialization for this type is not guaranteed to preserve ordering */
+  template <class Archive, class K, class T, class C, class A> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, InPlaceWrapper<std::multimap<K, T, C, A>> & wrapper )
+  {
+    map_detail::loadInPlace( ar, wrapper.container );
+  }
 } // namespace cereal
 
 #endif // CEREAL_TYPES_MAP_HPP_
@@ -31,6 +31,7 @@
 #define CEREAL_TYPES_SHARED_PTR_HPP_
 
 #include <cereal/cereal.hpp>
+#include <cereal/details/snapshot.hpp>
 #include <memory>
 #include <cstring>
 
@@ -58,6 +59,40 @@ namespace cereal
       return {std::forward<T>(t)};
     }
 
+    //! A wrapper around a std::shared_ptr that is serialized without tracking its identity
+    /*! @internal */
+    template<class T>
+    struct UntrackedWrapper
+    {
+      UntrackedWrapper(T && p) : ptr(std::forward<T>(p)) {}
+      T & ptr;
+
+      UntrackedWrapper & operator=( UntrackedWrapper const & ) = delete;
+    };
+
+    //! A wrapper around a pointer whose existing object is loaded into, see in_place
+    /*! @internal */
+    template<class T>
+    struct InPlacePtrWrapper
+    {
+      InPlacePtrWrapper(T & p) : ptr(p) {}
+      T & ptr;
+
+      InPlacePtrWrapper & operator=( InPlacePtrWrapper const & ) = delete;
+    };
+
+    //! A wrapper around the head of a chain of linked pointers, see make_chain
+    /*! @internal */
+    template <class Head, class Ptr, class Node>
+    struct ChainWrapper
+    {
+      ChainWrapper( Head & h, Ptr Node::* n ) : head( h ), next( n ) {}
+      Head & head;
+      Ptr Node::* const next;
+
+      ChainWrapper & operator=( ChainWrapper const & ) = delete;
+    };
+
     //! A struct that acts as a wrapper around calling load_andor_construct
     /*! The purpose of this is to allow a load_and_construct call to properly enter into the
         'data' NVP of the ptr_wrapper
@@ -77,6 +112,161 @@ namespace cereal
       ::cereal::construct<T> construct;
     };
 
+    //! Storage for an object that cereal constructs in place for a std::shared_ptr
+    /*! The object is destroyed along with the storage only if its construction
+        finished, which is signalled by setting valid.
+        @internal */
+    template <class T>
+    struct SharedStorage
+    {
+      //! The storage is zero initialized since taking ownership of it may inspect
+      //! its enable_shared_from_this state
+      SharedStorage() : storage(), valid( false ) {}
+      SharedStorage( SharedStorage const & ) = delete;
+      SharedStorage & operator=( SharedStorage const & ) = delete;
+
+      ~SharedStorage()
+      {
+        if( valid )
+          get()->~T();
+      }
+
+      T * get()
+      { return reinterpret_cast<T *>( &storage ); }
+
+      typename std::aligned_storage<sizeof(T)>::type storage;
+      bool valid;
+    };
+
+    //! Makes a shared_ptr own uninitialized storage for a type not derived from
+    //! std::enable_shared_from_this
+    /*! The storage, its valid flag and the control block of the shared_ptr are
+        placed in a single allocation by std::allocate_shared, with ptr aliasing
+        the storage.
+
+        @param resource The memory resource to allocate from, or nullptr
+        @param ptr The shared_ptr that will own the storage
+        @return The valid flag, to be set once the object has been constructed
+        @internal */
+    template <class T> inline
+    bool & makeSharedStorage( MemoryResource * resource, std::shared_ptr<T> & ptr, std::false_type /* has_shared_from_this */ )
+    {
+      auto storage = std::allocate_shared<SharedStorage<T>>( ResourceAllocator<SharedStorage<T>>( resource ) );
+      ptr = std::shared_ptr<T>( storage, storage->get() );
+      return storage->valid;
+    }
+
+    //! Makes a shared_ptr own uninitialized storage for a type derived from
+    //! std::enable_shared_from_this
+    /*! The shared_ptr must be constructed from the raw pointer for it to initialize
+        the enable_shared_from_this state, so the control block is allocated
+        separately from the storage.
+
+        @param resource The memory resource to allocate from, or nullptr
+        @param ptr The shared_ptr that will own the storage
+        @return The valid flag, to be set once the object has been constructed
+        @internal */
+    template <class T> inline
+    bool & makeSharedStorage( MemoryResource * resource, std::shared_ptr<T> & ptr, std::true_type /* has_shared_from_this */ )
+    {
+      ResourceAllocator<SharedStorage<T>> allocator( resource );
+      SharedStorage<T> * storage = ::new ( allocator.allocate( 1 ) ) SharedStorage<T>();
+
+      ptr.reset( storage->get(),
+          [storage, allocator]( T * ) mutable
+          {
+            storage->~SharedStorage<T>();
+            allocator.deallocate( storage, 1 );
+          }, allocator );
+
+      return storage->valid;
+    }
+
+    //! Uninitialized storage for an object that will be owned by a std::unique_ptr
+    /*! The storage is freed on destruction unless it has been handed to the
+        unique_ptr with release.
+        @internal */
+    template <class T, class D>
+    class UniqueStorage
+    {
+      using ST = typename std::aligned_storage<sizeof(T)>::type;
+
+      public:
+        UniqueStorage( MemoryResource * ) : itsStorage( new ST() ) {}
+
+        T * get()
+        { return reinterpret_cast<T *>( itsStorage.get() ); }
+
+        //! Transfers ownership of the (now constructed) object to ptr
+        void release( std::unique_ptr<T, D> & ptr )
+        { ptr.reset( reinterpret_cast<T *>( itsStorage.release() ) ); }
+
+      private:
+        std::unique_ptr<ST> itsStorage;
+    };
+
+    //! Uninitialized storage for a resource_unique_ptr, allocated from a memory resource
+    /*! @internal */
+    template <class T>
+    class UniqueStorage<T, ResourceDeleter<T>>
+    {
+      using ST = typename std::aligned_storage<sizeof(T)>::type;
+
+      public:
+        UniqueStorage( MemoryResource * resource ) :
+          itsResource( resource ),
+          itsStorage( resource ? resource->allocate( sizeof(T), std::alignment_of<T>::value ) : new ST() )
+        { }
+
+        ~UniqueStorage()
+        {
+          if( !itsStorage )
+            return;
+
+          if( itsResource )
+            itsResource->deallocate( itsStorage, sizeof(T), std::alignment_of<T>::value );
+          else
+            delete static_cast<ST *>( itsStorage );
+        }
+
+        T * get()
+        { return static_cast<T *>( itsStorage ); }
+
+        //! Transfers ownership of the (now constructed) object to ptr
+        void release( std::unique_ptr<T, ResourceDeleter<T>> & ptr )
+        {
+          ptr.reset( get() );
+          ptr.get_deleter() = ResourceDeleter<T>( itsResource );
+          itsStorage = nullptr;
+        }
+
+      private:
+        MemoryResource * itsResource;
+        void * itsStorage;
+    };
+
+    //! Default constructs the object for a unique_ptr with an arbitrary deleter
+    /*! @internal */
+    template <class Archive, class T, class D> inline
+    void constructUnique( Archive &, std::unique_ptr<T, D> & ptr )
+    {
+      ptr.reset( ::cereal::detail::Construct<T, Archive>::load_andor_construct() );
+    }
+
+    //! Default constructs the object for a resource_unique_ptr using the memory resource of the archive
+    /*! @internal */
+    template <class Archive, class T> inline
+    void constructUnique( Archive & ar, std::unique_ptr<T, ResourceDeleter<T>> & ptr )
+    {
+      // Instantiated only for its check that T is default constructible
+      (void)&::cereal::detail::Construct<T, Archive>::load_andor_construct;
+
+      UniqueStorage<T, ResourceDeleter<T>> storage( ar.getMemoryResource() );
+      T * raw = storage.get();
+      ::cereal::access::construct( raw );
+      storage.release( ptr );
+    }
+
     //! A helper struct for saving and restoring the state of types that derive from
     //! std::enable_shared_from_this
     /*! This special struct is necessary because when a user uses load_and_construct,
@@ -171,8 +361,268 @@ namespace cereal
       memory_detail::LoadAndConstructLoadWrapper<Archive, T> loadWrapper( ptr );
       ar( CEREAL_NVP_("data", loadWrapper) );
     }
+
+    //! Default constructs the object for a shared_ptr that is NOT derived from
+    //! std::enable_shared_from_this
+    /*! The object is constructed in place in storage from makeSharedStorage.
+
+        @param ar The archive, which supplies the memory resource
+        @param ptr The shared_ptr that will own the new object
+        @internal */
+    template <class Archive, class T> inline
+    void constructShared( Archive & ar, std::shared_ptr<T> & ptr, std::false_type /* has_shared_from_this */ )
+    {
+      // Instantiated only for its check that T is default constructible
+      (void)&::cereal::detail::Construct<T, Archive>::load_andor_construct;
+
+      bool & valid = makeSharedStorage( ar.getMemoryResource(), ptr, std::false_type() );
+      T * raw = ptr.get();
+      ::cereal::access::construct( raw );
+      valid = true;
+    }
+
+    //! Default constructs the object for a shared_ptr that is derived from
+    //! std::enable_shared_from_this
+    /*! The enable_shared_from_this state set up by the shared_ptr is preserved
+        across construction, see EnableSharedStateHelper.
+
+        @param ar The archive, which supplies the memory resource
+        @param ptr The shared_ptr that will own the new object
+        @internal */
+    template <class Archive, class T> inline
+    void constructShared( Archive & ar, std::shared_ptr<T> & ptr, std::true_type /* has_shared_from_this */ )
+    {
+      // Instantiated only for its check that T is default constructible
+      (void)&::cereal::detail::Construct<T, Archive>::load_andor_construct;
+
+      bool & valid = makeSharedStorage( ar.getMemoryResource(), ptr, std::true_type() );
+      T * raw = ptr.get();
+      {
+        EnableSharedStateHelper<T> state( raw );
+        ::cereal::access::construct( raw );
+      }
+      valid = true;
+    }
+
+    //! Saves a shared pointer id given by OutputArchive::registerSharedPointer
+    /*! Ids are written as 32 bits, with the msb set for the first occurrence of a
+        pointer.  An archive holding more than 2^31 - 2 pointers writes
+        detail::wide_id_32bit in place of the larger ids, followed by the full 64
+        bit id, so archives that never reach that many pay nothing.
+
+        @param ar The archive
+        @param id The id, with detail::msb_64bit set for a new pointer
+        @internal */
+    template <class Archive> inline
+    void saveSharedPointerId( Archive & ar, std::uint64_t const id )
+    {
+      std::uint32_t const isNew = ( id & detail::msb_64bit ) ? detail::msb_32bit : 0;
+      std::uint64_t const stripped = id & ~detail::msb_64bit;
+
+      if( stripped < detail::wide_id_32bit )
+        ar( CEREAL_NVP_("id", static_cast<std::uint32_t>( stripped ) | isNew) );
+      else
+      {
+        ar( CEREAL_NVP_("id", detail::wide_id_32bit | isNew) );
+        ar( CEREAL_NVP_("wide_id", stripped) );
+      }
+    }
+
+    //! Loads a shared pointer id written by saveSharedPointerId
+    /*! @param ar The archive
+        @return The id, with detail::msb_64bit set for a new pointer
+        @internal */
+    template <class Archive> inline
+    std::uint64_t loadSharedPointerId( Archive & ar )
+    {
+      std::uint32_t id;
+      ar( CEREAL_NVP_("id", id) );
+
+      std::uint64_t stripped = id & ~detail::msb_32bit;
+      if( stripped == detail::wide_id_32bit )
+        ar( CEREAL_NVP_("wide_id", stripped) );
+
+      return ( id & detail::msb_32bit ) ? stripped | detail::msb_64bit : stripped;
+    }
+
+    //! Saves the object of a shared pointer seen for the first time
+    /*! @internal */
+    template <class Archive, class T> inline
+    void saveSharedData( Archive & ar, std::shared_ptr<T> const & ptr, std::false_type /* tracked */ )
+    {
+      ar( CEREAL_NVP_("data", *ptr) );
+    }
+
+    //! Saves the object of a shared pointer seen for the first time, leaving unchanged ones out of snapshots
+    /*! @internal */
+    template <class Archive, class T> inline
+    void saveSharedData( Archive & ar, std::shared_ptr<T> const & ptr, std::true_type /* tracked */ )
+    {
+      if( auto writer = ar.getSnapshotWriter() )
+        writer->saveObject( ar, ptr );
+      else
+        ar( CEREAL_NVP_("data", *ptr) );
+    }
+
+    //! Constructs and loads the object of a shared pointer seen for the first time
+    /*! @internal */
+    template <class Archive, class T> inline
+    void loadSharedData( Archive & ar, std::uint64_t const id, std::shared_ptr<T> & ptr, std::false_type /* tracked */ )
+    {
+      constructShared( ar, ptr, typename ::cereal::traits::has_shared_from_this<T>::type() );
+      ar.registerSharedPointer( id, ptr );
+      ar( CEREAL_NVP_("data", *ptr) );
+    }
+
+    //! Loads the object of a shared pointer seen for the first time, reusing it from earlier snapshots
+    /*! When loading a snapshot, an object that already exists is loaded in place if
+        it changed, and a new one is recorded with the reader.
+        @internal */
+    template <class Archive, class T> inline
+    void loadSharedData( Archive & ar, std::uint64_t const id, std::shared_ptr<T> & ptr, std::true_type /* tracked */ )
+    {
+      auto reader = ar.getSnapshotReader();
+      if( !reader )
+        return loadSharedData( ar, id, ptr, std::false_type() );
+
+      std::uint64_t snapshotId;
+      bool changed;
+      ar( CEREAL_NVP_("snapshot_id", snapshotId) );
+      ar( CEREAL_NVP_("changed", changed) );
+
+      if( auto existing = reader->getObject( snapshotId ) )
+      {
+        ptr = std::static_pointer_cast<T>( existing );
+        ar.registerSharedPointer( id, ptr );
+      }
+      else if( changed )
+      {
+        constructShared( ar, ptr, typename ::cereal::traits::has_shared_from_this<T>::type() );
+        ar.registerSharedPointer( id, ptr );
+        reader->addObject( snapshotId, ptr );
+      }
+      else
+        throw Exception("Snapshot refers to object " + std::to_string( snapshotId ) + ", which is not in the snapshots before it");
+
+      if( changed )
+        ar( CEREAL_NVP_("data", *ptr) );
+    }
   } // end namespace memory_detail
 
+  //! Serializes a std::shared_ptr without tracking its identity
+  /*! cereal normally records every shared_ptr it saves so that any later pointer
+      to the same object is written as a reference to it, preserving aliasing.
+      Wrapping a pointer in untracked skips this: the pointee is written inline
+      after a one byte null flag, as for std::unique_ptr, and nothing is
+      registered with the archive when saving or loading.
+
+      Use this only for pointers whose objects are never referred to by another
+      pointer in the same archive, such as shared_ptr to immutable data that is
+      only shared for cheap copies.  Aliased objects will be duplicated when
+      loaded.  The pointee must not be polymorphic.  The same wrapper must be
+      used for loading as was used for saving.
+
+      @code{.cpp}
+      struct MyType
+      {
+        std::shared_ptr<Config const> config;
+
+        template <class Archive>
+        void serialize( Archive & ar )
+        {
+          ar( cereal::make_nvp( "config", cereal::untracked( config ) ) );
+        }
+      };
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  memory_detail::UntrackedWrapper<T> untracked( T && ptr )
+  {
+    return {std::forward<T>(ptr)};
+  }
+
+  //! Serializes a chain of nodes linked by smart pointers without recursion
+  /*! Following a long chain of pointers one node at a time recurses through
+      the archive for every link, which limits the length of lists and other
+      pointer linked sequences that can be serialized before the stack runs
+      out.  make_chain instead walks the chain in a loop, serializing the
+      pointer to each node as an element of a sequence, and relinks the nodes
+      when loading.
+
+      The serialization functions of the node type must not serialize the link
+      itself.  The chain must end in a null pointer.  Shared pointers to nodes
+      keep their identity with the rest of the archive as usual.
+
+      @code{.cpp}
+      struct Node
+      {
+        int value;
+        std::unique_ptr<Node> next;
+
+        template <class Archive>
+        void serialize( Archive & ar )
+        { ar( value ); } // note that next is not serialized
+      };
+
+      struct List
+      {
+        std::unique_ptr<Node> head;
+
+        template <class Archive>
+        void serialize( Archive & ar )
+        { ar( cereal::make_chain( head, &Node::next ) ); }
+      };
+      @endcode
+
+      @param head The pointer to the first node
+      @param next The member of the node type linking to the next node
+      @ingroup Utility */
+  template <class Head, class Ptr, class Node> inline
+  memory_detail::ChainWrapper<Head, Ptr, Node> make_chain( Head & head, Ptr Node::* next )
+  {
+    return {head, next};
+  }
+
+  //! Saving a chain of linked pointers (chain implementation)
+  /*! @internal */
+  template <class Archive, class Head, class Ptr, class Node> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, memory_detail::ChainWrapper<Head, Ptr, Node> const & wrapper )
+  {
+    size_type count = 0;
+    for( Ptr const * link = &wrapper.head; *link; link = &( (**link).*wrapper.next ) )
+      ++count;
+
+    ar( make_size_tag( count ) );
+
+    for( Ptr const * link = &wrapper.head; *link; link = &( (**link).*wrapper.next ) )
+      ar( *link );
+  }
+
+  //! Loading a chain of linked pointers (chain implementation)
+  /*! @internal */
+  template <class Archive, class Ptr, class Node> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, memory_detail::ChainWrapper<Ptr, Ptr, Node> & wrapper )
+  {
+    size_type count;
+    ar( make_size_tag( count ) );
+
+    Ptr * link = &wrapper.head;
+    for( size_type i = 0; i < count; ++i )
+    {
+      Ptr node;
+      ar( node );
+      if( !node )
+        throw Exception( "Error while loading a chain of pointers: unexpected null node" );
+
+      *link = std::move( node );
+      link = &( (**link).*wrapper.next );
+    }
+
+    if( count == 0 )
+      wrapper.head = Ptr();
+  }
+
   //! Saving std::shared_ptr for non polymorphic types
   template <class Archive, class T> inline
   typename std::enable_if<!std::is_polymorphic<T>::value, void>::type
@@ -224,6 +674,158 @@ namespace cereal
     ar( CEREAL_NVP_("ptr_wrapper", memory_detail::make_ptr_wrapper( ptr )) );
   }
 
+  namespace memory_detail
+  {
+    //! Whether the object of a std::unique_ptr can be loaded into
+    /*! @internal */
+    template <class Archive, class T, class D> inline
+    bool canLoadInPlace( Archive &, std::unique_ptr<T, D> const & ptr )
+    {
+      return static_cast<bool>( ptr );
+    }
+
+    //! Whether the object of a std::shared_ptr can be loaded into
+    /*! Only an object owned by the pointer alone is reused, so loading never changes an
+        object seen through another pointer.  Objects that may belong to an earlier
+        snapshot are never reused.
+        @internal */
+    template <class Archive, class T> inline
+    bool canLoadInPlace( Archive & ar, std::shared_ptr<T> const & ptr )
+    {
+      return ptr.use_count() == 1 && !( snapshot_detail::is_tracked<T>::value && ar.getSnapshotReader() );
+    }
+
+    //! Loads a pointer into its existing object when it can, see in_place
+    /*! @internal */
+    template <class Archive, class Ptr> inline
+    void loadInPlace( Archive & ar, Ptr & ptr, std::true_type /* input serializable */ )
+    {
+      if( canLoadInPlace( ar, ptr ) )
+      {
+        InPlacePtrWrapper<Ptr> wrapper( ptr );
+        ar( CEREAL_NVP_("ptr_wrapper", wrapper) );
+      }
+      else
+        ar( CEREAL_NVP_("ptr_wrapper", make_ptr_wrapper( ptr )) );
+    }
+
+    //! Loads a pointer to a type that is only loaded by load_and_construct, which always makes a new object
+    /*! @internal */
+    template <class Archive, class Ptr> inline
+    void loadInPlace( Archive & ar, Ptr & ptr, std::false_type /* input serializable */ )
+    {
+      ar( CEREAL_NVP_("ptr_wrapper", make_ptr_wrapper( ptr )) );
+    }
+  } // namespace memory_detail
+
+  //! Loading std::shared_ptr wrapped with in_place for non polymorphic types
+  /*! @relates in_place */
+  template <class Archive, class T> inline
+  typename std::enable_if<!std::is_polymorphic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, InPlaceWrapper<std::shared_ptr<T>> & wrapper )
+  {
+    memory_detail::loadInPlace( ar, wrapper.container, traits::is_input_serializable<T, Archive>() );
+  }
+
+  //! Loading std::unique_ptr wrapped with in_place for non polymorphic types
+  /*! @relates in_place */
+  template <class Archive, class T, class D> inline
+  typename std::enable_if<!std::is_polymorphic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, InPlaceWrapper<std::unique_ptr<T, D>> & wrapper )
+  {
+    memory_detail::loadInPlace( ar, wrapper.container, traits::is_input_serializable<T, Archive>() );
+  }
+
+  namespace memory_detail
+  {
+    //! Whether the elements of an owned array are serialized as a single block of binary data
+    /*! @internal */
+    template <class T, bool BinarySupported>
+    using owned_array_is_binary = std::integral_constant<bool, BinarySupported &&
+                                                         traits::is_trivially_serializable<T>::value &&
+                                                         !std::is_same<T, bool>::value>;
+
+    //! Saves the elements of an owned array as binary data
+    /*! @internal */
+    template <class Archive, class T, class D> inline
+    void saveOwnedArray( Archive & ar, std::unique_ptr<T[], D> const & pointer, std::size_t size, std::true_type /* binary */ )
+    {
+      ar( binary_data( pointer.get(), size * sizeof(T) ) );
+    }
+
+    //! Saves the elements of an owned array one by one
+    /*! @internal */
+    template <class Archive, class T, class D> inline
+    void saveOwnedArray( Archive & ar, std::unique_ptr<T[], D> const & pointer, std::size_t size, std::false_type /* binary */ )
+    {
+      for( std::size_t i = 0; i < size; ++i )
+        ar( pointer[i] );
+    }
+
+    //! Loads the elements of an owned array as binary data
+    /*! @internal */
+    template <class Archive, class T, class D> inline
+    void loadOwnedArray( Archive & ar, std::unique_ptr<T[], D> & pointer, std::size_t size, std::true_type /* binary */ )
+    {
+      ar( binary_data( pointer.get(), size * sizeof(T) ) );
+    }
+
+    //! Loads the elements of an owned array one by one
+    /*! @internal */
+    template <class Archive, class T, class D> inline
+    void loadOwnedArray( Archive & ar, std::unique_ptr<T[], D> & pointer, std::size_t size, std::false_type /* binary */ )
+    {
+      for( std::size_t i = 0; i < size; ++i )
+        ar( pointer[i] );
+    }
+  } // namespace memory_detail
+
+  //! Saving std::unique_ptr to arrays wrapped with owned_array
+  /*! @relates owned_array */
+  template <class Archive, class T, class D, class Size> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, OwnedArrayWrapper<std::unique_ptr<T[], D> const, Size const> const & wrapper )
+  {
+    auto const size = static_cast<std::size_t>( wrapper.size );
+    if( size && !wrapper.pointer )
+      throw Exception("Error while trying to serialize an owned array. It is null but has a size of " + std::to_string(size));
+
+    ar( make_size_tag( static_cast<size_type>( size ) ) );
+    memory_detail::saveOwnedArray( ar, wrapper.pointer, size,
+        memory_detail::owned_array_is_binary<T, traits::is_output_serializable<BinaryData<T>, Archive>::value>() );
+  }
+
+  //! Saving std::unique_ptr to arrays wrapped with owned_array, from non const references
+  /*! @relates owned_array */
+  template <class Archive, class T, class D, class Size> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, OwnedArrayWrapper<std::unique_ptr<T[], D>, Size> const & wrapper )
+  {
+    CEREAL_SAVE_FUNCTION_NAME( ar, OwnedArrayWrapper<std::unique_ptr<T[], D> const, Size const>( wrapper.pointer, wrapper.size ) );
+  }
+
+  //! Loading std::unique_ptr to arrays wrapped with owned_array
+  /*! @relates owned_array */
+  template <class Archive, class T, class D, class Size> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, OwnedArrayWrapper<std::unique_ptr<T[], D>, Size> & wrapper )
+  {
+    size_type loaded;
+    ar( make_size_tag( loaded ) );
+    auto const size = static_cast<std::size_t>( loaded );
+
+    auto & pointer = wrapper.pointer;
+    if( size == 0 )
+      pointer.reset();
+    else if( !pointer || static_cast<std::size_t>( wrapper.size ) != size )
+    {
+      static_assert( std::is_same<D, std::default_delete<T[]>>::value,
+                     "owned_array can only allocate arrays for std::unique_ptr with the default deleter" );
+      pointer.reset( new T[size] );
+    }
+
+    memory_detail::loadOwnedArray( ar, pointer, size,
+        memory_detail::owned_array_is_binary<T, traits::is_input_serializable<BinaryData<T>, Archive>::value>() );
+    wrapper.size = static_cast<Size>( size );
+  }
+
   // ######################################################################
   // Pointer wrapper implementations follow below
 
@@ -234,13 +836,11 @@ namespace cereal
   {
     auto & ptr = wrapper.ptr;
 
-    uint32_t id = ar.registerSharedPointer( ptr.get() );
-    ar( CEREAL_NVP_("id", id) );
+    auto const id = ar.registerSharedPointer( ptr.get() );
+    memory_detail::saveSharedPointerId( ar, id );
 
-    if( id & detail::msb_32bit )
-    {
-      ar( CEREAL_NVP_("data", *ptr) );
-    }
+    if( id & detail::msb_64bit )
+      memory_detail::saveSharedData( ar, ptr, typename snapshot_detail::is_tracked<T>::type() );
   }
 
   //! Loading std::shared_ptr, case when user load and construct (wrapper implementation)
@@ -251,31 +851,18 @@ namespace cereal
   {
     auto & ptr = wrapper.ptr;
 
-    uint32_t id;
+    auto const id = memory_detail::loadSharedPointerId( ar );
 
-    ar( CEREAL_NVP_("id", id) );
+    if( snapshot_detail::is_tracked<T>::value && ar.getSnapshotReader() )
+      throw Exception("Types with load_and_construct cannot be loaded from incremental snapshots");
 
-    if( id & detail::msb_32bit )
+    if( id & detail::msb_64bit )
     {
-      // Storage type for the pointer - since we can't default construct this type,
-      // we'll allocate it using std::aligned_storage and use a custom deleter
-      using ST = typename std::aligned_storage<sizeof(T)>::type;
-
-      // Valid flag - set to true once construction finishes
-      //  This prevents us from calling the destructor on
-      //  uninitialized data.
-      auto valid = std::make_shared<bool>( false );
-
-      // Allocate our storage, which we will treat as
-      //  uninitialized until initialized with placement new
-      ptr.reset( reinterpret_cast<T *>( new ST() ),
-          [=]( T * t )
-          {
-            if( valid )
-              t->~T();
-
-            delete reinterpret_cast<ST *>( t );
-          } );
+      // Allocate our storage, which we will treat as uninitialized until
+      //  initialized with placement new.  The valid flag is set to true once
+      //  construction finishes, which prevents us from calling the destructor
+      //  on uninitialized data.
+      bool & valid = memory_detail::makeSharedStorage( ar.getMemoryResource(), ptr, typename ::cereal::traits::has_shared_from_this<T>::type() );
 
       // Register the pointer
       ar.registerSharedPointer( id, ptr );
@@ -284,7 +871,7 @@ namespace cereal
       memory_detail::loadAndConstructSharedPtr( ar, ptr.get(), typename ::cereal::traits::has_shared_from_this<T>::type() );
 
       // Mark pointer as valid (initialized)
-      *valid = true;
+      valid = true;
     }
     else
       ptr = std::static_pointer_cast<T>(ar.getSharedPointer(id));
@@ -298,13 +885,27 @@ namespace cereal
   {
     auto & ptr = wrapper.ptr;
 
-    uint32_t id;
+    auto const id = memory_detail::loadSharedPointerId( ar );
+
+    if( id & detail::msb_64bit )
+      memory_detail::loadSharedData( ar, id, ptr, typename snapshot_detail::is_tracked<T>::type() );
+    else
+      ptr = std::static_pointer_cast<T>(ar.getSharedPointer(id));
+  }
+
+  //! Loading std::shared_ptr into its existing object (in place implementation)
+  /*! The object is registered in place of a new one.  If the data refers to an object
+      loaded earlier, the pointer is replaced by it.
+      @internal */
+  template <class Archive, class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, memory_detail::InPlacePtrWrapper<std::shared_ptr<T>> & wrapper )
+  {
+    auto & ptr = wrapper.ptr;
 
-    ar( CEREAL_NVP_("id", id) );
+    auto const id = memory_detail::loadSharedPointerId( ar );
 
-    if( id & detail::msb_32bit )
+    if( id & detail::msb_64bit )
     {
-      ptr.reset( detail::Construct<T, Archive>::load_andor_construct() );
       ar.registerSharedPointer( id, ptr );
       ar( CEREAL_NVP_("data", *ptr) );
     }
@@ -312,6 +913,70 @@ namespace cereal
       ptr = std::static_pointer_cast<T>(ar.getSharedPointer(id));
   }
 
+  //! Saving std::shared_ptr without tracking (untracked implementation)
+  /*! @internal */
+  template <class Archive, class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, memory_detail::UntrackedWrapper<T> const & wrapper )
+  {
+    auto & ptr = wrapper.ptr;
+
+    using Element = typename std::remove_reference<decltype(*ptr)>::type;
+    static_assert( !std::is_polymorphic<Element>::value, "cereal::untracked cannot be used with polymorphic types" );
+
+    if( !ptr )
+      ar( CEREAL_NVP_("valid", uint8_t(0)) );
+    else
+    {
+      ar( CEREAL_NVP_("valid", uint8_t(1)) );
+      ar( CEREAL_NVP_("data", *ptr) );
+    }
+  }
+
+  //! Loading std::shared_ptr without tracking, case when user load and construct (untracked implementation)
+  /*! @internal */
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::has_load_and_construct<T, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, memory_detail::UntrackedWrapper<std::shared_ptr<T> &> & wrapper )
+  {
+    static_assert( !std::is_polymorphic<T>::value, "cereal::untracked cannot be used with polymorphic types" );
+
+    uint8_t isValid;
+    ar( CEREAL_NVP_("valid", isValid) );
+
+    auto & ptr = wrapper.ptr;
+
+    if( isValid )
+    {
+      bool & valid = memory_detail::makeSharedStorage( ar.getMemoryResource(), ptr, typename ::cereal::traits::has_shared_from_this<T>::type() );
+      memory_detail::loadAndConstructSharedPtr( ar, ptr.get(), typename ::cereal::traits::has_shared_from_this<T>::type() );
+      valid = true;
+    }
+    else
+      ptr.reset();
+  }
+
+  //! Loading std::shared_ptr without tracking, case when no user load and construct (untracked implementation)
+  /*! @internal */
+  template <class Archive, class T> inline
+  typename std::enable_if<!traits::has_load_and_construct<T, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, memory_detail::UntrackedWrapper<std::shared_ptr<T> &> & wrapper )
+  {
+    static_assert( !std::is_polymorphic<T>::value, "cereal::untracked cannot be used with polymorphic types" );
+
+    uint8_t isValid;
+    ar( CEREAL_NVP_("valid", isValid) );
+
+    auto & ptr = wrapper.ptr;
+
+    if( isValid )
+    {
+      memory_detail::constructShared( ar, ptr, typename ::cereal::traits::has_shared_from_this<T>::type() );
+      ar( CEREAL_NVP_("data", *ptr) );
+    }
+    else
+      ptr.reset();
+  }
+
   //! Saving std::unique_ptr (wrapper implementation)
   /*! @internal */
   template <class Archive, class T, class D> inline
@@ -345,27 +1010,38 @@ namespace cereal
 
     if( isValid )
     {
-      // Storage type for the pointer - since we can't default construct this type,
-      // we'll allocate it using std::aligned_storage
-      using ST = typename std::aligned_storage<sizeof(T)>::type;
-
-      // Allocate storage - note the ST type so that deleter is correct if
-      //                    an exception is thrown before we are initialized
-      std::unique_ptr<ST> stPtr( new ST() );
+      // Allocate storage - since we can't default construct this type, this is
+      //                    freed as raw storage if an exception is thrown before
+      //                    we are initialized
+      memory_detail::UniqueStorage<T, D> storage( ar.getMemoryResource() );
 
       // Use wrapper to enter into "data" nvp of ptr_wrapper
-      memory_detail::LoadAndConstructLoadWrapper<Archive, T> loadWrapper( reinterpret_cast<T *>( stPtr.get() ) );
+      memory_detail::LoadAndConstructLoadWrapper<Archive, T> loadWrapper( storage.get() );
 
       // Initialize storage
       ar( CEREAL_NVP_("data", loadWrapper) );
 
       // Transfer ownership to correct unique_ptr type
-      ptr.reset( reinterpret_cast<T *>( stPtr.release() ) );
+      storage.release( ptr );
     }
     else
       ptr.reset( nullptr );
   }
 
+  //! Loading std::unique_ptr into its existing object (in place implementation)
+  /*! @internal */
+  template <class Archive, class T, class D> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, memory_detail::InPlacePtrWrapper<std::unique_ptr<T, D>> & wrapper )
+  {
+    uint8_t isValid;
+    ar( CEREAL_NVP_("valid", isValid) );
+
+    if( isValid )
+      ar( CEREAL_NVP_("data", *wrapper.ptr) );
+    else
+      wrapper.ptr.reset( nullptr );
+  }
+
   //! Loading std::unique_ptr, case when no load_and_construct (wrapper implementation)
   /*! @internal */
   template <class Archive, class T, class D> inline
@@ -379,7 +1055,7 @@ namespace cereal
 
     if( isValid )
     {
-      ptr.reset( detail::Construct<T, Archive>::load_andor_construct() );
+      memory_detail::constructUnique( ar, ptr );
       ar( CEREAL_NVP_( "data", *ptr ) );
     }
     else
@@ -0,0 +1,246 @@
+/*! \file optional_fields.hpp
+    \brief Presence bitmaps for structs whose members are mostly at their default values
+    \ingroup OtherTypes */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TYPES_OPTIONAL_FIELDS_HPP_
+#define CEREAL_TYPES_OPTIONAL_FIELDS_HPP_
+
+#include <cereal/cereal.hpp>
+#include <tuple>
+
+namespace cereal
+{
+  // ######################################################################
+  //! A member that is only serialized when it differs from its default value
+  /*! @relates optional_field
+      @internal */
+  template <class T>
+  struct OptionalField
+  {
+    OptionalField( char const * n, T & v, typename std::remove_const<T>::type d ) :
+      name( n ), value( v ), defaultValue( std::move( d ) ) {}
+
+    char const * name;
+    T & value;
+    typename std::remove_const<T>::type defaultValue;
+
+    OptionalField & operator=( OptionalField const & ) = delete;
+
+    //! Whether the member differs from its default value and must be serialized
+    bool present() const
+    { return !( value == defaultValue ); }
+  };
+
+  //! Declares a member that is left out of the data while it equals a default value
+  /*! Optional fields are passed to optional_fields, see there.
+
+      @ingroup Utility */
+  template <class T, class D> inline
+  OptionalField<T> optional_field( T & value, D && defaultValue )
+  {
+    return {nullptr, value, std::forward<D>( defaultValue )};
+  }
+
+  //! Declares a member with a name that is left out of the data while it equals a default value
+  /*! The name is used by text archives.
+
+      @ingroup Utility */
+  template <class T, class D> inline
+  OptionalField<T> optional_field( char const * name, T & value, D && defaultValue )
+  {
+    return {name, value, std::forward<D>( defaultValue )};
+  }
+
+  // ######################################################################
+  //! A group of optional fields saved behind a presence bitmap
+  /*! @relates optional_fields
+      @internal */
+  template <class ... Fields>
+  struct OptionalFieldsWrapper
+  {
+    static_assert( sizeof...(Fields) > 0, "optional_fields requires at least one field" );
+
+    //! The number of bytes in the presence bitmap
+    static const std::size_t bitmapSize = ( sizeof...(Fields) + 7 ) / 8;
+
+    std::tuple<Fields...> fields;
+  };
+
+  //! Serializes members that are mostly at their default values behind a presence bitmap
+  /*! The group starts with a bitmap holding one bit per field, set for the fields
+      that differ from their default value.  Only those fields follow it, in order.
+      Fields left out are not dispatched to the archive at all, and loading sets
+      them to their default value.  Binary archives save the bitmap as a single
+      block of bytes, so a struct with fifty fields at their defaults takes seven.
+
+      Fields need an equality operator.  Data saved through optional_fields must
+      be loaded through it, with the same fields in the same order.
+
+      @code{.cpp}
+      struct Order
+      {
+        std::uint32_t id;
+        double price = 0, stop = 0;
+        std::string note;
+        std::int32_t flags = 0;
+
+        template <class Archive>
+        void serialize( Archive & ar )
+        {
+          ar( id, cereal::optional_fields( cereal::optional_field( "price", price, 0.0 ),
+                                           cereal::optional_field( "stop", stop, 0.0 ),
+                                           cereal::optional_field( "note", note, std::string() ),
+                                           cereal::optional_field( "flags", flags, 0 ) ) );
+        }
+      };
+      @endcode
+
+      @ingroup Utility */
+  template <class ... T> inline
+  OptionalFieldsWrapper<OptionalField<T>...> optional_fields( OptionalField<T> && ... fields )
+  {
+    return {std::tuple<OptionalField<T>...>( std::move( fields )... )};
+  }
+
+  namespace optional_fields_detail
+  {
+    //! Calls f on every field with its index
+    /*! @internal */
+    template <std::size_t I = 0, class F, class ... Fields> inline
+    typename std::enable_if<I == sizeof...(Fields)>::type
+    forEach( std::tuple<Fields...> &, F & )
+    { }
+
+    //! Calls f on every field with its index
+    /*! @internal */
+    template <std::size_t I = 0, class F, class ... Fields> inline
+    typename std::enable_if<I < sizeof...(Fields)>::type
+    forEach( std::tuple<Fields...> & fields, F & f )
+    {
+      f( std::get<I>( fields ), I );
+      forEach<I + 1>( fields, f );
+    }
+
+    //! Whether bit index of a presence bitmap is set
+    /*! @internal */
+    inline bool isSet( std::uint8_t const * bitmap, std::size_t index )
+    {
+      return ( bitmap[index / 8] >> ( index % 8 ) ) & 1;
+    }
+
+    //! Serializes a field with its name, if it has one
+    /*! @internal */
+    template <class Archive, class T> inline
+    void serializeField( Archive & ar, OptionalField<T> & field )
+    {
+      if( field.name )
+        ar( make_nvp<Archive>( field.name, field.value ) );
+      else
+        ar( field.value );
+    }
+
+    //! Sets the bits of the fields that differ from their defaults
+    /*! @internal */
+    struct MarkPresent
+    {
+      std::uint8_t * bitmap;
+
+      template <class Field>
+      void operator()( Field const & field, std::size_t index )
+      {
+        if( field.present() )
+          bitmap[index / 8] = static_cast<std::uint8_t>( bitmap[index / 8] | ( 1u << ( index % 8 ) ) );
+      }
+    };
+
+    //! Saves the fields marked in the bitmap
+    /*! @internal */
+    template <class Archive>
+    struct SavePresent
+    {
+      Archive & ar;
+      std::uint8_t const * bitmap;
+
+      template <class Field>
+      void operator()( Field & field, std::size_t index )
+      {
+        if( isSet( bitmap, index ) )
+          serializeField( ar, field );
+      }
+    };
+
+    //! Loads the fields marked in the bitmap and resets the others to their defaults
+    /*! @internal */
+    template <class Archive>
+    struct LoadPresent
+    {
+      Archive & ar;
+      std::uint8_t const * bitmap;
+
+      template <class Field>
+      void operator()( Field & field, std::size_t index )
+      {
+        if( isSet( bitmap, index ) )
+          serializeField( ar, field );
+        else
+          field.value = field.defaultValue;
+      }
+    };
+  } // namespace optional_fields_detail
+
+  //! Saving for members grouped with optional_fields
+  template <class Archive, class ... Fields> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, OptionalFieldsWrapper<Fields...> const & wrapper )
+  {
+    typedef OptionalFieldsWrapper<Fields...> WrapperT;
+    auto & fields = const_cast<WrapperT &>( wrapper ).fields;
+
+    std::uint8_t bitmap[WrapperT::bitmapSize] = {};
+    optional_fields_detail::MarkPresent mark{ bitmap };
+    optional_fields_detail::forEach( fields, mark );
+    ar( CEREAL_NVP_("presence", bitmap) );
+
+    optional_fields_detail::SavePresent<Archive> save{ ar, bitmap };
+    optional_fields_detail::forEach( fields, save );
+  }
+
+  //! Loading for members grouped with optional_fields
+  template <class Archive, class ... Fields> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, OptionalFieldsWrapper<Fields...> & wrapper )
+  {
+    typedef OptionalFieldsWrapper<Fields...> WrapperT;
+
+    std::uint8_t bitmap[WrapperT::bitmapSize];
+    ar( CEREAL_NVP_("presence", bitmap) );
+
+    optional_fields_detail::LoadPresent<Archive> load{ ar, bitmap };
+    optional_fields_detail::forEach( wrapper.fields, load );
+  }
+} // namespace cereal
+
+#endif // CEREAL_TYPES_OPTIONAL_FIELDS_HPP_
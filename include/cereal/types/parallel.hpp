@@ -0,0 +1,291 @@
+/*! \file parallel.hpp
+    \brief Support for serializing the chunks of a large vector on several threads
+    \ingroup STLSupport */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TYPES_PARALLEL_HPP_
+#define CEREAL_TYPES_PARALLEL_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/details/streambuf.hpp>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cereal
+{
+  namespace parallel_detail
+  {
+    //! The number of elements in each chunk when none is given
+    /*! @internal */
+    static const std::size_t default_chunk_size = 1 << 16;
+
+    //! Calls work(i) for every i in [0, count), spread over up to threads threads
+    /*! The calling thread does its share of the work.  The first exception thrown by
+        any call stops the remaining work and is rethrown once all threads finish.
+
+        @param threads The number of threads to use, with 0 for one per hardware thread
+        @internal */
+    template <class F> inline
+    void run( std::size_t count, std::size_t threads, F const & work )
+    {
+      if( threads == 0 )
+        threads = std::max( 1u, std::thread::hardware_concurrency() );
+      threads = std::min( threads, count );
+
+      if( threads <= 1 )
+      {
+        for( std::size_t i = 0; i < count; ++i )
+          work( i );
+        return;
+      }
+
+      std::atomic<std::size_t> next( 0 );
+      std::exception_ptr error;
+      std::mutex errorMutex;
+
+      auto worker = [&]()
+      {
+        for( std::size_t i; ( i = next++ ) < count; )
+        {
+          try
+          {
+            work( i );
+          }
+          catch( ... )
+          {
+            std::lock_guard<std::mutex> lock( errorMutex );
+            if( !error )
+              error = std::current_exception();
+            next = count;
+          }
+        }
+      };
+
+      std::vector<std::thread> pool;
+      pool.reserve( threads - 1 );
+      for( std::size_t t = 1; t < threads; ++t )
+        pool.emplace_back( worker );
+      worker();
+      for( auto & thread : pool )
+        thread.join();
+
+      if( error )
+        std::rethrow_exception( error );
+    }
+
+    //! Whether chunks can be saved with archives of their own embedded in this one
+    /*! @internal */
+    template <class Archive>
+    struct can_save_chunks : std::integral_constant<bool,
+      traits::is_output_serializable<BinaryData<char>, Archive>::value && std::is_constructible<Archive, std::ostream &>::value> {};
+
+    //! Whether chunks can be loaded with archives of their own embedded in this one
+    /*! @internal */
+    template <class Archive>
+    struct can_load_chunks : std::integral_constant<bool,
+      traits::is_input_serializable<BinaryData<char>, Archive>::value && std::is_constructible<Archive, std::istream &>::value> {};
+  } // namespace parallel_detail
+
+  // ######################################################################
+  //! A wrapper around a vector that is serialized in chunks on several threads
+  /*! @relates parallel
+      @internal */
+  template <class T>
+  struct ParallelWrapper
+  {
+    ParallelWrapper( T & c, std::size_t cs, std::size_t t ) : container( c ), chunkSize( cs ), threads( t ) {}
+    T & container;
+    std::size_t chunkSize;
+    std::size_t threads;
+
+    ParallelWrapper & operator=( ParallelWrapper const & ) = delete;
+  };
+
+  //! Serializes a vector in independent chunks, spread over several threads
+  /*! The vector is split into contiguous chunks of chunkSize elements.  Each chunk is
+      saved by its own archive, of the same type as the enclosing one, into a buffer
+      of its own, and the buffers are then written one after another together with
+      their sizes.  Loading reads all of the buffers and then loads the chunks in
+      parallel, straight into their place in the vector.
+
+      Chunk archives get the user data of the enclosing archive, and when loading also
+      its memory resource and LoadLimits, with what they load counted against the
+      limits of the enclosing archive.
+
+      Since every chunk has its own archive, elements must not share pointers with
+      elements of other chunks or with anything outside the vector.  Elements should
+      be independent of each other, and their serialization must be safe to run
+      concurrently.
+
+      Archives that do not support binary data, or cannot be constructed from a
+      stream, save the vector as usual.  Data saved through the wrapper must be loaded
+      through it, with any chunk size and number of threads.
+
+      @code{.cpp}
+      std::vector<Record> records;
+      archive( cereal::parallel( records ) );
+      @endcode
+
+      @param container The std::vector to serialize
+      @param chunkSize The number of elements in each chunk
+      @param threads The number of threads to use, with 0 for one per hardware thread
+      @ingroup Utility */
+  template <class T> inline
+  ParallelWrapper<T> parallel( T & container, std::size_t chunkSize = parallel_detail::default_chunk_size, std::size_t threads = 0 )
+  {
+    return {container, chunkSize, threads};
+  }
+
+  //! Saving for vectors wrapped with parallel, in chunks
+  template <class Archive, class T> inline
+  typename std::enable_if<parallel_detail::can_save_chunks<Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, ParallelWrapper<T> const & wrapper )
+  {
+    auto const & vector = wrapper.container;
+    std::size_t const chunkSize = std::max<std::size_t>( wrapper.chunkSize, 1 );
+    std::size_t const chunks = ( vector.size() + chunkSize - 1 ) / chunkSize;
+
+    std::vector<std::string> buffers( chunks );
+    parallel_detail::run( chunks, wrapper.threads, [&]( std::size_t chunk )
+    {
+      streambuf_detail::StringWriteBuffer buffer( buffers[chunk] );
+      std::ostream stream( &buffer );
+      {
+        Archive chunkArchive( stream );
+        ar.configureNested( chunkArchive );
+        auto const end = std::min( vector.size(), ( chunk + 1 ) * chunkSize );
+        for( auto i = chunk * chunkSize; i < end; ++i )
+          chunkArchive( vector[i] );
+      }
+    } );
+
+    std::vector<std::uint64_t> sizes( chunks );
+    std::uint64_t total = 0;
+    for( std::size_t i = 0; i < chunks; ++i )
+      total += sizes[i] = buffers[i].size();
+
+    ar( make_size_tag( static_cast<size_type>( vector.size() ) ) );
+    ar( static_cast<std::uint64_t>( chunkSize ) );
+    ar( make_size_tag( static_cast<size_type>( chunks ) ) );
+    ar( make_size_tag( static_cast<size_type>( total ) ) );
+    ar( binary_data( sizes.data(), sizes.size() * sizeof(std::uint64_t) ) );
+    for( auto const & buffer : buffers )
+      ar( binary_data( buffer.data(), buffer.size() ) );
+  }
+
+  //! Loading for vectors wrapped with parallel, in chunks
+  template <class Archive, class T> inline
+  typename std::enable_if<parallel_detail::can_load_chunks<Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, ParallelWrapper<T> & wrapper )
+  {
+    auto & vector = wrapper.container;
+
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    std::uint64_t chunkSize;
+    ar( chunkSize );
+    if( chunkSize == 0 )
+      throw Exception("Invalid parallel vector - its chunks are empty");
+
+    size_type chunks, total;
+    ar( make_size_tag( chunks ) );
+    ar( make_size_tag( total ) );
+    if( chunks != size / chunkSize + ( size % chunkSize != 0 ) )
+      throw Exception("Invalid parallel vector - its number of chunks does not match its size");
+
+    std::vector<std::uint64_t> sizes( static_cast<std::size_t>( chunks ) );
+    ar( binary_data( sizes.data(), sizes.size() * sizeof(std::uint64_t) ) );
+
+    // Chunk sizes come from the stream, so they must add up to the checked total
+    std::uint64_t sum = 0;
+    for( auto chunkBytes : sizes )
+    {
+      if( chunkBytes > total - sum )
+        throw Exception("Invalid parallel vector - its chunks are larger than its total of " + std::to_string(total) + " bytes");
+      sum += chunkBytes;
+    }
+    if( sum != total )
+      throw Exception("Invalid parallel vector - its chunks do not add up to its total of " + std::to_string(total) + " bytes");
+
+    // Each buffer is allocated only once the ones before it have been read
+    std::vector<std::vector<char>> buffers( sizes.size() );
+    for( std::size_t i = 0; i < sizes.size(); ++i )
+    {
+      buffers[i].resize( static_cast<std::size_t>( sizes[i] ) );
+      ar( binary_data( buffers[i].data(), buffers[i].size() ) );
+    }
+
+    vector.resize( static_cast<std::size_t>( size ) );
+    // Chunk archives share the limits of this one, so they are set up and charged under a lock
+    std::mutex limitsMutex;
+    parallel_detail::run( buffers.size(), wrapper.threads, [&]( std::size_t chunk )
+    {
+      streambuf_detail::MemoryReadBuffer buffer( buffers[chunk].data(), buffers[chunk].size() );
+      std::istream stream( &buffer );
+      {
+        Archive chunkArchive( stream );
+        {
+          std::lock_guard<std::mutex> lock( limitsMutex );
+          ar.configureNested( chunkArchive );
+        }
+        auto const end = std::min<std::uint64_t>( size, ( chunk + 1 ) * chunkSize );
+        for( auto i = chunk * chunkSize; i < end; ++i )
+          chunkArchive( vector[static_cast<std::size_t>( i )] );
+
+        std::lock_guard<std::mutex> lock( limitsMutex );
+        ar.chargeNested( chunkArchive );
+      }
+    } );
+  }
+
+  //! Saving for vectors wrapped with parallel, for archives that can not embed other archives
+  template <class Archive, class T> inline
+  typename std::enable_if<!parallel_detail::can_save_chunks<Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, ParallelWrapper<T> const & wrapper )
+  {
+    ar( wrapper.container );
+  }
+
+  //! Loading for vectors wrapped with parallel, for archives that can not embed other archives
+  template <class Archive, class T> inline
+  typename std::enable_if<!parallel_detail::can_load_chunks<Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, ParallelWrapper<T> & wrapper )
+  {
+    ar( wrapper.container );
+  }
+} // namespace cereal
+
+#endif // CEREAL_TYPES_PARALLEL_HPP_
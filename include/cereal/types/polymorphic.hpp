@@ -105,6 +105,35 @@
   } } /* end namespaces */                                   \
   CEREAL_BIND_TO_ARCHIVES(T)
 
+//! Registers a polymorphic type with cereal, giving it a
+//! user defined numeric id
+/*! Binary archives identify a type registered this way by
+    its id alone, so the type name is never written.  This
+    makes messages carrying polymorphic pointers smaller and
+    avoids a lookup by name when loading.  Text archives
+    still use the name of the type.
+
+    The id must be unique among all polymorphic types, must
+    be less than 2^29, and must not change once data has been
+    saved with it. */
+#define CEREAL_REGISTER_TYPE_WITH_ID(T, Id)                                             \
+  namespace cereal {                                                                    \
+  namespace detail {                                                                    \
+  template <>                                                                           \
+  struct binding_name<T>                                                                \
+  {                                                                                     \
+    STATIC_CONSTEXPR char const * name() { return #T; }                                 \
+  };                                                                                    \
+  template <>                                                                           \
+  struct binding_id<T>                                                                  \
+  {                                                                                     \
+    static_assert( (Id) < 0x20000000u, "Polymorphic type ids must be less than 2^29" ); \
+    static const bool registered = true;                                                \
+    STATIC_CONSTEXPR std::uint32_t id() { return (Id); }                                \
+  };                                                                                    \
+  } } /* end namespaces */                                                              \
+  CEREAL_BIND_TO_ARCHIVES(T)
+
 //! Adds a way to force initialization of a translation unit containing
 //! calls to CEREAL_REGISTER_TYPE
 /*! In C++, dynamic initialization of non-local variables of a translation
@@ -156,6 +185,32 @@
     }                                                   \
   } } /* end namespaces */
 
+//! Defines the registry of polymorphic bindings shared by every library in a process
+/*! By default each shared library that registers polymorphic types gets its own
+    copy of the bindings for every archive.  Whether these copies are merged when
+    libraries are loaded depends on the platform and on symbol visibility, and
+    every library pays for creating bindings of the types it registers even when
+    another library already did.
+
+    Defining CEREAL_SHARED_BINDING_REGISTRY in every library and executable of a
+    program makes them all use a single registry instead.  It must be defined in
+    exactly one of them, usually a core library the others link against, by placing
+    this macro in one of its source files.  On Windows that library must also be
+    built with CEREAL_SHARED_BINDING_REGISTRY_EXPORTS defined.  Types registered by
+    more than one library then have their bindings created only once.
+
+    The library defining the registry must stay loaded for as long as any other
+    library using it. */
+#define CEREAL_DEFINE_SHARED_BINDING_REGISTRY                                                 \
+  namespace cereal {                                                                          \
+  namespace detail {                                                                          \
+    CEREAL_SHARED_BINDING_REGISTRY_API SharedBindingRegistries & getSharedBindingRegistries() \
+    {                                                                                         \
+      static SharedBindingRegistries * registries = new SharedBindingRegistries();            \
+      return *registries;                                                                     \
+    }                                                                                         \
+  } } /* end namespaces */
+
 #ifdef _MSC_VER
 #undef CONSTEXPR
 #endif
@@ -172,6 +227,12 @@ namespace cereal
                               "you are using was included (and registered with CEREAL_REGISTER_ARCHIVE) prior to calling CEREAL_REGISTER_TYPE.\n"   \
                               "If your type is already registered and you still see this error, you may need to use CEREAL_REGISTER_DYNAMIC_INIT.");
 
+    //! Whether T is declared final, so that a pointer to it always points to exactly a T
+    /*! std::is_final is C++14, but the intrinsic it is built on is available earlier.
+        @internal */
+    template <class T>
+    struct is_final : std::integral_constant<bool, __is_final(T)> {};
+
     //! Get an input binding from the given archive by deserializing the type meta data
     /*! @internal */
     template<class Archive> inline
@@ -183,23 +244,59 @@ namespace cereal
         typename ::cereal::detail::InputBindingMap<Archive>::Serializers emptySerializers;
         emptySerializers.shared_ptr = [](void*, std::shared_ptr<void> & ptr) { ptr.reset(); };
         emptySerializers.unique_ptr = [](void*, std::unique_ptr<void, ::cereal::detail::EmptyDeleter<void>> & ptr) { ptr.reset( nullptr ); };
+        emptySerializers.type = nullptr;
+        emptySerializers.shared_ptr_in_place = nullptr;
+        emptySerializers.unique_ptr_in_place = nullptr;
         return emptySerializers;
       }
 
-      std::string name;
-      if(nameid & detail::msb_32bit)
+      ar.statisticsCounter().polymorphicLookup();
+
+      // Types registered with a numeric id carry no name
+      if(nameid & detail::msb3_32bit)
       {
-        ar( CEREAL_NVP_("polymorphic_name", name) );
-        ar.registerPolymorphicName(nameid, name);
+        auto const & idMap = detail::getBindingMap<detail::InputBindingMap<Archive>>().idMap;
+        auto const id = nameid & ~detail::msb3_32bit;
+
+        auto binding = idMap.find(id);
+        if(binding == idMap.end())
+          UNREGISTERED_POLYMORPHIC_EXCEPTION(load, std::string("with id ") + std::to_string(id))
+        return binding->second.second;
       }
-      else
-        name = ar.getPolymorphicName(nameid);
 
-      auto & bindingMap = detail::StaticObject<detail::InputBindingMap<Archive>>::getInstance().map;
+      typedef typename ::cereal::detail::InputBindingMap<Archive>::Serializers Serializers;
+
+      // A type seen before was resolved when its name was loaded, so its binding is
+      // found by id without touching the name
+      if(!(nameid & detail::msb_32bit))
+        return *static_cast<Serializers const *>(ar.getPolymorphicBinding(nameid));
 
+      std::string name;
+      ar( CEREAL_NVP_("polymorphic_name", name) );
+
+      // Elements of the map are never moved, so the archive can hold on to the binding
+      auto const & bindingMap = detail::getBindingMap<detail::InputBindingMap<Archive>>().map;
       auto binding = bindingMap.find(name);
       if(binding == bindingMap.end())
         UNREGISTERED_POLYMORPHIC_EXCEPTION(load, name)
+      ar.registerPolymorphicName(nameid, name, &binding->second);
+
+      return binding->second;
+    }
+
+    //! Get the output binding for the dynamic type of a polymorphic pointer
+    /*! @internal */
+    template<class Archive> inline
+    typename ::cereal::detail::OutputBindingMap<Archive>::Serializers const & getOutputBinding(Archive & ar, std::type_info const & ptrinfo)
+    {
+      ar.statisticsCounter().polymorphicLookup();
+
+      auto const & bindingMap = detail::getBindingMap<detail::OutputBindingMap<Archive>>().map;
+
+      auto binding = bindingMap.find(std::type_index(ptrinfo));
+      if(binding == bindingMap.end())
+        UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
+
       return binding->second;
     }
 
@@ -297,13 +394,7 @@ namespace cereal
     // of an abstract object
     //  this implies we need to do the lookup
 
-    auto & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
-
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
-    if(binding == bindingMap.end())
-      UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
-
-    binding->second.shared_ptr(&ar, ptr.get());
+    polymorphic_detail::getOutputBinding(ar, ptrinfo).shared_ptr(&ar, ptr.get());
   }
 
   //! Saving std::shared_ptr for polymorphic types, not abstract
@@ -318,10 +409,10 @@ namespace cereal
       return;
     }
 
-    std::type_info const & ptrinfo = typeid(*ptr.get());
     static std::type_info const & tinfo = typeid(T);
 
-    if(ptrinfo == tinfo)
+    // A final type is always exactly itself, so its dynamic type need not be checked
+    if(polymorphic_detail::is_final<T>::value || typeid(*ptr.get()) == tinfo)
     {
       // The 2nd msb signals that the following pointer does not need to be
       // cast with our polymorphic machinery
@@ -332,13 +423,7 @@ namespace cereal
       return;
     }
 
-    auto & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
-
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
-    if(binding == bindingMap.end())
-      UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
-
-    binding->second.shared_ptr(&ar, ptr.get());
+    polymorphic_detail::getOutputBinding(ar, typeid(*ptr.get())).shared_ptr(&ar, ptr.get());
   }
 
   //! Loading std::shared_ptr for polymorphic types
@@ -395,13 +480,7 @@ namespace cereal
     // of an abstract object
     //  this implies we need to do the lookup
 
-    auto & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
-
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
-    if(binding == bindingMap.end())
-      UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
-
-    binding->second.unique_ptr(&ar, ptr.get());
+    polymorphic_detail::getOutputBinding(ar, ptrinfo).unique_ptr(&ar, ptr.get());
   }
 
   //! Saving std::unique_ptr for polymorphic types, not abstract
@@ -416,10 +495,10 @@ namespace cereal
       return;
     }
 
-    std::type_info const & ptrinfo = typeid(*ptr.get());
     static std::type_info const & tinfo = typeid(T);
 
-    if(ptrinfo == tinfo)
+    // A final type is always exactly itself, so its dynamic type need not be checked
+    if(polymorphic_detail::is_final<T>::value || typeid(*ptr.get()) == tinfo)
     {
       // The 2nd msb signals that the following pointer does not need to be
       // cast with our polymorphic machinery
@@ -430,13 +509,7 @@ namespace cereal
       return;
     }
 
-    auto & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
-
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
-    if(binding == bindingMap.end())
-      UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
-
-    binding->second.unique_ptr(&ar, ptr.get());
+    polymorphic_detail::getOutputBinding(ar, typeid(*ptr.get())).unique_ptr(&ar, ptr.get());
   }
 
   //! Loading std::unique_ptr, case when user provides load_and_construct for polymorphic types
@@ -457,6 +530,227 @@ namespace cereal
     ptr.reset(static_cast<T*>(result.release()));
   }
 
+  namespace polymorphic_detail
+  {
+    //! Loads a pointer saved as its static type into its existing object, if that is exactly of the static type
+    /*! @return false if the existing object cannot be reused
+        @internal */
+    template <class Archive, class Ptr> inline
+    bool load_exact_in_place( Archive & ar, Ptr & ptr, std::true_type /* input serializable */ )
+    {
+      if( !memory_detail::canLoadInPlace( ar, ptr ) || typeid(*ptr) != typeid(typename Ptr::element_type) )
+        return false;
+
+      memory_detail::InPlacePtrWrapper<Ptr> wrapper( ptr );
+      ar( CEREAL_NVP_("ptr_wrapper", wrapper) );
+      return true;
+    }
+
+    //! Types only loaded by load_and_construct are never loaded in place
+    /*! @internal */
+    template <class Archive, class Ptr> inline
+    bool load_exact_in_place( Archive &, Ptr &, std::false_type /* input serializable */ )
+    {
+      return false;
+    }
+  } // namespace polymorphic_detail
+
+  //! Loading std::shared_ptr wrapped with in_place for polymorphic types
+  /*! The existing object is loaded into when the data holds an object of its dynamic
+      type, found from the polymorphic name or id.
+      @relates in_place */
+  template <class Archive, class T> inline
+  typename std::enable_if<std::is_polymorphic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, InPlaceWrapper<std::shared_ptr<T>> & wrapper )
+  {
+    auto & ptr = wrapper.container;
+
+    std::uint32_t nameid;
+    ar( CEREAL_NVP_("polymorphic_id", nameid) );
+
+    if( ( nameid & detail::msb2_32bit ) &&
+        polymorphic_detail::load_exact_in_place( ar, ptr, traits::is_input_serializable<T, Archive>() ) )
+      return;
+
+    if(polymorphic_detail::serialize_wrapper(ar, ptr, nameid))
+      return;
+
+    auto binding = polymorphic_detail::getInputBinding(ar, nameid);
+    if( binding.shared_ptr_in_place && memory_detail::canLoadInPlace( ar, ptr ) && *binding.type == typeid(*ptr) )
+    {
+      void * const object = dynamic_cast<void *>( ptr.get() );
+      std::shared_ptr<void> result( ptr, object );
+      binding.shared_ptr_in_place(&ar, result);
+      if( result.get() != object )
+        ptr = std::static_pointer_cast<T>(result);
+      return;
+    }
+
+    std::shared_ptr<void> result;
+    binding.shared_ptr(&ar, result);
+    ptr = std::static_pointer_cast<T>(result);
+  }
+
+  //! Loading std::unique_ptr wrapped with in_place for polymorphic types
+  /*! The existing object is loaded into when the data holds an object of its dynamic
+      type, found from the polymorphic name or id.
+      @relates in_place */
+  template <class Archive, class T, class D> inline
+  typename std::enable_if<std::is_polymorphic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, InPlaceWrapper<std::unique_ptr<T, D>> & wrapper )
+  {
+    auto & ptr = wrapper.container;
+
+    std::uint32_t nameid;
+    ar( CEREAL_NVP_("polymorphic_id", nameid) );
+
+    if( ( nameid & detail::msb2_32bit ) &&
+        polymorphic_detail::load_exact_in_place( ar, ptr, traits::is_input_serializable<T, Archive>() ) )
+      return;
+
+    if(polymorphic_detail::serialize_wrapper(ar, ptr, nameid))
+      return;
+
+    auto binding = polymorphic_detail::getInputBinding(ar, nameid);
+    if( binding.unique_ptr_in_place && ptr && *binding.type == typeid(*ptr) )
+    {
+      if( !binding.unique_ptr_in_place(&ar, dynamic_cast<void *>( ptr.get() )) )
+        ptr.reset();
+      return;
+    }
+
+    std::unique_ptr<void, ::cereal::detail::EmptyDeleter<void>> result;
+    binding.unique_ptr(&ar, result);
+    ptr.reset(static_cast<T*>(result.release()));
+  }
+
+  namespace polymorphic_detail
+  {
+    //! Saves the data of a shared_ptr in a homogeneous container, without its type metadata
+    /*! @internal */
+    template <class Archive, class T> inline
+    void save_homogeneous_data( Archive & ar, typename ::cereal::detail::OutputBindingMap<Archive>::Serializers const & binding,
+                                std::shared_ptr<T> const & ptr )
+    {
+      binding.shared_ptr_data(&ar, ptr.get());
+    }
+
+    //! Saves the data of a unique_ptr in a homogeneous container, without its type metadata
+    /*! @internal */
+    template <class Archive, class T, class D> inline
+    void save_homogeneous_data( Archive & ar, typename ::cereal::detail::OutputBindingMap<Archive>::Serializers const & binding,
+                                std::unique_ptr<T, D> const & ptr )
+    {
+      binding.unique_ptr_data(&ar, ptr.get());
+    }
+
+    //! Loads a shared_ptr in a homogeneous container through the binding of its type
+    /*! @internal */
+    template <class Archive, class T> inline
+    void load_homogeneous_data( Archive & ar, typename ::cereal::detail::InputBindingMap<Archive>::Serializers const & binding,
+                                std::shared_ptr<T> & ptr )
+    {
+      std::shared_ptr<void> result;
+      binding.shared_ptr(&ar, result);
+      ptr = std::static_pointer_cast<T>(result);
+    }
+
+    //! Loads a unique_ptr in a homogeneous container through the binding of its type
+    /*! @internal */
+    template <class Archive, class T, class D> inline
+    void load_homogeneous_data( Archive & ar, typename ::cereal::detail::InputBindingMap<Archive>::Serializers const & binding,
+                                std::unique_ptr<T, D> & ptr )
+    {
+      std::unique_ptr<void, ::cereal::detail::EmptyDeleter<void>> result;
+      binding.unique_ptr(&ar, result);
+      ptr.reset(static_cast<T*>(result.release()));
+    }
+
+    //! Saves the pointers of a homogeneous container whose dynamic type equals their static type
+    /*! @internal */
+    template <class Archive, class T> inline
+    void save_homogeneous_exact( Archive & ar, T const & container, std::false_type /* abstract */ )
+    {
+      ar( CEREAL_NVP_("polymorphic_id", ::cereal::detail::msb2_32bit) );
+      for( auto const & ptr : container )
+        ar( CEREAL_NVP_("ptr_wrapper", memory_detail::make_ptr_wrapper(ptr)) );
+    }
+
+    //! An abstract type can never be the dynamic type of a pointer
+    /*! @internal */
+    template <class Archive, class T> inline
+    void save_homogeneous_exact( Archive &, T const &, std::true_type /* abstract */ )
+    { }
+  } // namespace polymorphic_detail
+
+  //! Saving for containers of polymorphic pointers wrapped with homogeneous
+  /*! The type metadata is written once, followed by the data of each pointer.
+      @relates homogeneous */
+  template <class Archive, class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, HomogeneousWrapper<T> const & wrapper )
+  {
+    // The size is a named value rather than a size tag, since text archives would
+    // otherwise count the metadata as one of the elements
+    auto const & container = wrapper.container;
+    ar( CEREAL_NVP_("size", static_cast<size_type>( container.size() )) );
+    if( container.empty() )
+      return;
+
+    auto const & first = *container.begin();
+    if( !first )
+      throw Exception("Trying to save a null pointer in a homogeneous container");
+
+    typedef typename std::remove_reference<decltype(*first)>::type BaseT;
+    std::type_info const & ptrinfo = typeid(*first);
+    for( auto const & ptr : container )
+      if( !ptr || typeid(*ptr) != ptrinfo )
+        throw Exception("Trying to save a homogeneous container whose pointers are null or of different types");
+
+    // The pointers are exactly their static type, so no binding is needed
+    if( polymorphic_detail::is_final<BaseT>::value || ptrinfo == typeid(BaseT) )
+    {
+      polymorphic_detail::save_homogeneous_exact( ar, container, std::is_abstract<BaseT>() );
+      return;
+    }
+
+    auto const & binding = polymorphic_detail::getOutputBinding(ar, ptrinfo);
+    binding.metadata(&ar, nullptr);
+    for( auto const & ptr : container )
+      polymorphic_detail::save_homogeneous_data( ar, binding, ptr );
+  }
+
+  //! Loading for containers of polymorphic pointers wrapped with homogeneous
+  /*! @relates homogeneous */
+  template <class Archive, class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, HomogeneousWrapper<T> & wrapper )
+  {
+    size_type size;
+    ar( CEREAL_NVP_("size", size) );
+    ar.checkLoadSize( size );
+
+    auto & container = wrapper.container;
+    container.clear();
+    container.resize( static_cast<std::size_t>( size ) );
+    if( container.empty() )
+      return;
+
+    std::uint32_t nameid;
+    ar( CEREAL_NVP_("polymorphic_id", nameid) );
+    if( nameid == 0 )
+      throw Exception("Invalid type metadata for a homogeneous container");
+
+    if( nameid & detail::msb2_32bit )
+    {
+      for( auto & ptr : container )
+        polymorphic_detail::serialize_wrapper( ar, ptr, nameid );
+      return;
+    }
+
+    auto const binding = polymorphic_detail::getInputBinding( ar, nameid );
+    for( auto & ptr : container )
+      polymorphic_detail::load_homogeneous_data( ar, binding, ptr );
+  }
+
   #undef UNREGISTERED_POLYMORPHIC_EXCEPTION
 } // namespace cereal
 #endif // CEREAL_TYPES_POLYMORPHIC_HPP_
@@ -0,0 +1,374 @@
+/*! \file quantized.hpp
+    \brief Lossy half precision and scaled integer encodings for vectors of floating point values
+    \ingroup STLSupport */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TYPES_QUANTIZED_HPP_
+#define CEREAL_TYPES_QUANTIZED_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace cereal
+{
+  namespace quantized_detail
+  {
+    //! Reinterprets the bits of a float
+    /*! @internal */
+    inline std::uint32_t float_bits( float f )
+    {
+      std::uint32_t u;
+      std::memcpy( &u, &f, sizeof(f) );
+      return u;
+    }
+
+    //! Reinterprets bits as a float
+    /*! @internal */
+    inline float bits_float( std::uint32_t u )
+    {
+      float f;
+      std::memcpy( &f, &u, sizeof(f) );
+      return f;
+    }
+
+    //! Converts a float to IEEE half precision, rounding to nearest even
+    /*! Values too large for half precision become infinity and NaNs stay NaN.
+        @internal */
+    inline std::uint16_t float_to_half( float f )
+    {
+      std::uint32_t const f32infinity = 255u << 23;
+      std::uint32_t const f16overflow = ( 127u + 16 ) << 23;
+      std::uint32_t const denormMagic = ( ( 127u - 15 ) + ( 23 - 10 ) + 1 ) << 23;
+
+      std::uint32_t x = float_bits( f );
+      std::uint32_t const sign = x & 0x80000000u;
+      x ^= sign;
+
+      std::uint16_t h;
+      if( x >= f16overflow )
+        h = x > f32infinity ? 0x7E00 : 0x7C00;
+      else if( x < ( 113u << 23 ) )
+      {
+        // Results in the subnormal range are rounded by the floating point addition
+        h = static_cast<std::uint16_t>( float_bits( bits_float( x ) + bits_float( denormMagic ) ) - denormMagic );
+      }
+      else
+      {
+        std::uint32_t const mantissaOdd = ( x >> 13 ) & 1;
+        x += ( static_cast<std::uint32_t>( 15 - 127 ) << 23 ) + 0xFFF;
+        x += mantissaOdd;
+        h = static_cast<std::uint16_t>( x >> 13 );
+      }
+
+      return static_cast<std::uint16_t>( h | ( sign >> 16 ) );
+    }
+
+    //! Converts an IEEE half precision value to a float, which is exact
+    /*! @internal */
+    inline float half_to_float( std::uint16_t h )
+    {
+      std::uint32_t const sign = static_cast<std::uint32_t>( h & 0x8000 ) << 16;
+      std::uint32_t const exponent = ( h >> 10 ) & 0x1F;
+      std::uint32_t mantissa = h & 0x3FF;
+
+      if( exponent == 0x1F )
+        return bits_float( sign | 0x7F800000u | ( mantissa << 13 ) );
+
+      if( exponent != 0 )
+        return bits_float( sign | ( ( exponent + 112 ) << 23 ) | ( mantissa << 13 ) );
+
+      if( mantissa == 0 )
+        return bits_float( sign );
+
+      // Subnormal values are normalized for the wider exponent of float
+      std::uint32_t shift = 0;
+      while( !( mantissa & 0x400 ) )
+      {
+        mantissa <<= 1;
+        ++shift;
+      }
+      return bits_float( sign | ( ( 113 - shift ) << 23 ) | ( ( mantissa & 0x3FF ) << 13 ) );
+    }
+
+    //! Converts a float to bfloat16, the upper half of its bits, rounding to nearest even
+    /*! @internal */
+    inline std::uint16_t float_to_bfloat16( float f )
+    {
+      std::uint32_t const x = float_bits( f );
+      if( ( x & 0x7FFFFFFFu ) > 0x7F800000u )
+        return static_cast<std::uint16_t>( ( x >> 16 ) | 0x40 ); // keep NaNs quiet
+
+      return static_cast<std::uint16_t>( ( x + 0x7FFFu + ( ( x >> 16 ) & 1 ) ) >> 16 );
+    }
+
+    //! Converts a bfloat16 value to a float, which is exact
+    /*! @internal */
+    inline float bfloat16_to_float( std::uint16_t b )
+    {
+      return bits_float( static_cast<std::uint32_t>( b ) << 16 );
+    }
+
+    //! Converts values to half precision
+    /*! @internal */
+    template <class T> inline
+    void to_half( T const * in, std::size_t size, std::uint16_t * out )
+    {
+      for( std::size_t i = 0; i < size; ++i )
+        out[i] = float_to_half( static_cast<float>( in[i] ) );
+    }
+
+    //! Converts values from half precision
+    /*! @internal */
+    template <class T> inline
+    void from_half( std::uint16_t const * in, std::size_t size, T * out )
+    {
+      for( std::size_t i = 0; i < size; ++i )
+        out[i] = static_cast<T>( half_to_float( in[i] ) );
+    }
+
+    //! Converts floats to half precision, using F16C or NEON conversions when the compiler targets them
+    /*! @internal */
+    inline void to_half( float const * in, std::size_t size, std::uint16_t * out )
+    {
+      std::size_t i = 0;
+
+      #if defined(__F16C__)
+      for( ; i + 8 <= size; i += 8 )
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( out + i ),
+                          _mm256_cvtps_ph( _mm256_loadu_ps( in + i ), _MM_FROUND_TO_NEAREST_INT ) );
+      #elif defined(__ARM_NEON) && defined(__aarch64__)
+      for( ; i + 4 <= size; i += 4 )
+        vst1_u16( out + i, vreinterpret_u16_f16( vcvt_f16_f32( vld1q_f32( in + i ) ) ) );
+      #endif
+
+      for( ; i < size; ++i )
+        out[i] = float_to_half( in[i] );
+    }
+
+    //! Converts floats from half precision, using F16C or NEON conversions when the compiler targets them
+    /*! @internal */
+    inline void from_half( std::uint16_t const * in, std::size_t size, float * out )
+    {
+      std::size_t i = 0;
+
+      #if defined(__F16C__)
+      for( ; i + 8 <= size; i += 8 )
+        _mm256_storeu_ps( out + i, _mm256_cvtph_ps( _mm_loadu_si128( reinterpret_cast<__m128i const *>( in + i ) ) ) );
+      #elif defined(__ARM_NEON) && defined(__aarch64__)
+      for( ; i + 4 <= size; i += 4 )
+        vst1q_f32( out + i, vcvt_f32_f16( vreinterpret_f16_u16( vld1_u16( in + i ) ) ) );
+      #endif
+
+      for( ; i < size; ++i )
+        out[i] = half_to_float( in[i] );
+    }
+
+    //! IEEE half precision, with 11 significant bits and a range of about 6.5e4
+    /*! @internal */
+    struct Float16
+    {
+      template <class Archive, class T> inline
+      static void save( Archive & ar, T const & vector )
+      {
+        std::vector<std::uint16_t> data( vector.size() );
+        to_half( vector.data(), vector.size(), data.data() );
+        ar( CEREAL_NVP_("data", data) );
+      }
+
+      template <class Archive, class T> inline
+      static void load( Archive & ar, T & vector )
+      {
+        std::vector<std::uint16_t> data;
+        ar( CEREAL_NVP_("data", data) );
+        vector.resize( data.size() );
+        from_half( data.data(), data.size(), vector.data() );
+      }
+    };
+
+    //! bfloat16, with 8 significant bits and the range of float
+    /*! @internal */
+    struct BFloat16
+    {
+      template <class Archive, class T> inline
+      static void save( Archive & ar, T const & vector )
+      {
+        std::vector<std::uint16_t> data( vector.size() );
+        for( std::size_t i = 0; i < data.size(); ++i )
+          data[i] = float_to_bfloat16( static_cast<float>( vector[i] ) );
+        ar( CEREAL_NVP_("data", data) );
+      }
+
+      template <class Archive, class T> inline
+      static void load( Archive & ar, T & vector )
+      {
+        std::vector<std::uint16_t> data;
+        ar( CEREAL_NVP_("data", data) );
+        vector.resize( data.size() );
+        for( std::size_t i = 0; i < data.size(); ++i )
+          vector[i] = static_cast<typename T::value_type>( bfloat16_to_float( data[i] ) );
+      }
+    };
+
+    //! 256 evenly spaced levels between the smallest and largest value
+    /*! @internal */
+    struct ScaledInt8
+    {
+      template <class Archive, class T> inline
+      static void save( Archive & ar, T const & vector )
+      {
+        typedef typename T::value_type ValueT;
+
+        ValueT offset = 0;
+        ValueT scale = 0;
+        if( !vector.empty() )
+        {
+          auto const range = std::minmax_element( vector.begin(), vector.end() );
+          offset = *range.first;
+          scale = ( *range.second - *range.first ) / 255;
+        }
+
+        std::vector<std::uint8_t> data( vector.size() );
+        if( scale > 0 )
+          for( std::size_t i = 0; i < data.size(); ++i )
+          {
+            auto const level = std::round( ( vector[i] - offset ) / scale );
+            data[i] = static_cast<std::uint8_t>( std::min<ValueT>( std::max<ValueT>( level, 0 ), 255 ) );
+          }
+
+        ar( CEREAL_NVP_("offset", offset),
+            CEREAL_NVP_("scale", scale),
+            CEREAL_NVP_("data", data) );
+      }
+
+      template <class Archive, class T> inline
+      static void load( Archive & ar, T & vector )
+      {
+        typedef typename T::value_type ValueT;
+
+        ValueT offset;
+        ValueT scale;
+        std::vector<std::uint8_t> data;
+        ar( CEREAL_NVP_("offset", offset),
+            CEREAL_NVP_("scale", scale),
+            CEREAL_NVP_("data", data) );
+
+        vector.resize( data.size() );
+        for( std::size_t i = 0; i < data.size(); ++i )
+          vector[i] = offset + scale * static_cast<ValueT>( data[i] );
+      }
+    };
+  } // namespace quantized_detail
+
+  // ######################################################################
+  //! A wrapper around a vector of floating point values that is saved with a lossy encoding
+  /*! @relates as_float16
+      @internal */
+  template <class T, class Format>
+  struct QuantizedWrapper
+  {
+    static_assert( std::is_floating_point<typename std::remove_const<T>::type::value_type>::value,
+                   "quantized encodings require a vector of floating point values" );
+
+    QuantizedWrapper( T & v ) : vector( v ) {}
+    T & vector;
+
+    QuantizedWrapper & operator=( QuantizedWrapper const & ) = delete;
+  };
+
+  //! Serializes a vector of floating point values as IEEE half precision
+  /*! Values keep 11 significant bits, about three decimal digits, and values
+      larger in magnitude than 65504 become infinity.  This halves the size of
+      a vector of float.  Conversions use F16C or NEON instructions when the
+      compiler targets them.
+
+      Binary archives save the values as a block of 16 bit integers, text
+      archives as individual integers.  Data saved through the wrapper must be
+      loaded through it.
+
+      @code{.cpp}
+      std::vector<float> embedding;
+      archive( cereal::as_float16( embedding ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  QuantizedWrapper<T, quantized_detail::Float16> as_float16( T & vector )
+  {
+    return {vector};
+  }
+
+  //! Serializes a vector of floating point values as bfloat16
+  /*! bfloat16 keeps the range of float, but only 8 significant bits, about two
+      decimal digits.  This halves the size of a vector of float.  See
+      as_float16 for the saved representation.
+
+      @ingroup Utility */
+  template <class T> inline
+  QuantizedWrapper<T, quantized_detail::BFloat16> as_bfloat16( T & vector )
+  {
+    return {vector};
+  }
+
+  //! Serializes a vector of floating point values as one byte each, scaled between the smallest and largest value
+  /*! The smallest value and the distance between levels are saved, followed by
+      every value rounded to the nearest of 256 evenly spaced levels.  The error
+      is at most half of (max - min) / 255, which suits values of similar
+      magnitude such as normalized embeddings.  This quarters the size of a
+      vector of float.  All values must be finite.
+
+      @ingroup Utility */
+  template <class T> inline
+  QuantizedWrapper<T, quantized_detail::ScaledInt8> as_scaled_int8( T & vector )
+  {
+    return {vector};
+  }
+
+  //! Saving for vectors wrapped with a quantized encoding
+  template <class Archive, class T, class Format> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, QuantizedWrapper<T, Format> const & wrapper )
+  {
+    Format::save( ar, static_cast<typename std::add_const<T>::type &>( wrapper.vector ) );
+  }
+
+  //! Loading for vectors wrapped with a quantized encoding
+  template <class Archive, class T, class Format> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, QuantizedWrapper<T, Format> & wrapper )
+  {
+    Format::load( ar, wrapper.vector );
+  }
+} // namespace cereal
+
+#endif // CEREAL_TYPES_QUANTIZED_HPP_
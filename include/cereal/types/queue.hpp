@@ -32,6 +32,7 @@
 
 #include <cereal/details/helpers.hpp>
 #include <queue>
+#include <algorithm>
 
 // The default container for queue is deque, so let's include that too
 #include <cereal/types/deque.hpp>
@@ -43,11 +44,11 @@ namespace cereal
     //! Allows access to the protected container in queue
     /*! @internal */
     template <class T, class C> inline
-    C const & container( std::queue<T, C> const & queue )
+    C & container( std::queue<T, C> & queue )
     {
       struct H : public std::queue<T, C>
       {
-        static C const & get( std::queue<T, C> const & q )
+        static C & get( std::queue<T, C> & q )
         {
           return q.*(&H::c);
         }
@@ -56,14 +57,22 @@ namespace cereal
       return H::get( queue );
     }
 
+    //! Allows access to the protected container in queue
+    /*! @internal */
+    template <class T, class C> inline
+    C const & container( std::queue<T, C> const & queue )
+    {
+      return container( const_cast<std::queue<T, C> &>( queue ) );
+    }
+
     //! Allows access to the protected container in priority queue
     /*! @internal */
     template <class T, class C, class Comp> inline
-    C const & container( std::priority_queue<T, C, Comp> const & priority_queue )
+    C & container( std::priority_queue<T, C, Comp> & priority_queue )
     {
       struct H : public std::priority_queue<T, C, Comp>
       {
-        static C const & get( std::priority_queue<T, C, Comp> const & pq )
+        static C & get( std::priority_queue<T, C, Comp> & pq )
         {
           return pq.*(&H::c);
         }
@@ -72,14 +81,22 @@ namespace cereal
       return H::get( priority_queue );
     }
 
+    //! Allows access to the protected container in priority queue
+    /*! @internal */
+    template <class T, class C, class Comp> inline
+    C const & container( std::priority_queue<T, C, Comp> const & priority_queue )
+    {
+      return container( const_cast<std::priority_queue<T, C, Comp> &>( priority_queue ) );
+    }
+
     //! Allows access to the protected comparator in priority queue
     /*! @internal */
     template <class T, class C, class Comp> inline
-    Comp const & comparator( std::priority_queue<T, C, Comp> const & priority_queue )
+    Comp & comparator( std::priority_queue<T, C, Comp> & priority_queue )
     {
       struct H : public std::priority_queue<T, C, Comp>
       {
-        static Comp const & get( std::priority_queue<T, C, Comp> const & pq )
+        static Comp & get( std::priority_queue<T, C, Comp> & pq )
         {
           return pq.*(&H::comp);
         }
@@ -87,6 +104,64 @@ namespace cereal
 
       return H::get( priority_queue );
     }
+
+    //! Allows access to the protected comparator in priority queue
+    /*! @internal */
+    template <class T, class C, class Comp> inline
+    Comp const & comparator( std::priority_queue<T, C, Comp> const & priority_queue )
+    {
+      return comparator( const_cast<std::priority_queue<T, C, Comp> &>( priority_queue ) );
+    }
+
+    //! Loads the comparator and container of a priority queue in place
+    /*! @param trusted Whether the loaded container is assumed to already be
+               a heap for the comparator, otherwise the heap is rebuilt
+        @internal */
+    template <class Archive, class T, class C, class Comp> inline
+    void load( Archive & ar, std::priority_queue<T, C, Comp> & priority_queue, bool trusted )
+    {
+      auto & comp = comparator( priority_queue );
+      auto & c = container( priority_queue );
+
+      ar( CEREAL_NVP_("comparator", comp) );
+      ar( CEREAL_NVP_("container", c) );
+
+      if( !trusted )
+        std::make_heap( c.begin(), c.end(), comp );
+    }
+  }
+
+  //! A wrapper around a priority queue whose saved heap order is trusted on load
+  /*! @relates trusted_heap
+      @internal */
+  template <class T>
+  struct TrustedHeapWrapper
+  {
+    TrustedHeapWrapper( T & q ) : queue( q ) {}
+    T & queue;
+
+    TrustedHeapWrapper & operator=( TrustedHeapWrapper const & ) = delete;
+  };
+
+  //! Loads a priority queue without rebuilding its heap
+  /*! The container of a priority queue is saved in heap order, but loading
+      normally rebuilds the heap anyway since the archive could have been
+      produced by anything.  When the data is known to come from a saved
+      priority queue with an equivalent comparator, wrapping the queue with
+      trusted_heap skips that linear pass.  Loading data that is not a valid
+      heap through the wrapper results in a queue whose order is unspecified.
+
+      Saving through the wrapper is the same as saving the queue itself.
+
+      @code{.cpp}
+      archive( cereal::trusted_heap( jobs ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  TrustedHeapWrapper<T> trusted_heap( T & queue )
+  {
+    return {queue};
   }
 
   //! Saving for std::queue
@@ -100,9 +175,7 @@ namespace cereal
   template <class Archive, class T, class C> inline
   void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::queue<T, C> & queue )
   {
-    C container;
-    ar( CEREAL_NVP_("container", container) );
-    queue = std::queue<T, C>( std::move( container ) );
+    ar( CEREAL_NVP_("container", queue_detail::container( queue )) );
   }
 
   //! Saving for std::priority_queue
@@ -117,13 +190,21 @@ namespace cereal
   template <class Archive, class T, class C, class Comp> inline
   void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::priority_queue<T, C, Comp> & priority_queue )
   {
-    Comp comparator;
-    ar( CEREAL_NVP_("comparator", comparator) );
+    queue_detail::load( ar, priority_queue, false );
+  }
 
-    C container;
-    ar( CEREAL_NVP_("container", container) );
+  //! Saving for std::priority_queue wrapped with trusted_heap
+  template <class Archive, class T, class C, class Comp> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, TrustedHeapWrapper<std::priority_queue<T, C, Comp>> const & wrapper )
+  {
+    CEREAL_SAVE_FUNCTION_NAME( ar, static_cast<std::priority_queue<T, C, Comp> const &>( wrapper.queue ) );
+  }
 
-    priority_queue = std::priority_queue<T, C, Comp>( comparator, std::move( container ) );
+  //! Loading for std::priority_queue wrapped with trusted_heap
+  template <class Archive, class T, class C, class Comp> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, TrustedHeapWrapper<std::priority_queue<T, C, Comp>> & wrapper )
+  {
+    queue_detail::load( ar, wrapper.queue, true );
   }
 } // namespace cereal
 
@@ -0,0 +1,366 @@
+/*! \file range.hpp
+    \brief Support for saving iterator ranges and loading sequences element by element */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TYPES_RANGE_HPP_
+#define CEREAL_TYPES_RANGE_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace cereal
+{
+  namespace range_detail
+  {
+    //! The number of bytes of trivially serializable elements gathered before they are written together
+    /*! @internal */
+    static const std::size_t buffer_bytes = 4096;
+
+    //! The number of elements of type T that fit in the buffer
+    /*! @internal */
+    template <class T>
+    struct buffer_count : std::integral_constant<std::size_t, ( buffer_bytes / sizeof(T) ) ? buffer_bytes / sizeof(T) : 1> {};
+
+    //! Whether elements of type T are saved as binary data by the archive, as for std::vector
+    /*! @internal */
+    template <class Archive, class T>
+    struct is_binary_output : std::integral_constant<bool,
+      traits::is_output_serializable<BinaryData<T>, Archive>::value && traits::is_trivially_serializable<T>::value && !std::is_same<T, bool>::value> {};
+
+    //! Whether elements of type T are loaded as binary data by the archive, as for std::vector
+    /*! @internal */
+    template <class Archive, class T>
+    struct is_binary_input : std::integral_constant<bool,
+      traits::is_input_serializable<BinaryData<T>, Archive>::value && traits::is_trivially_serializable<T>::value && !std::is_same<T, bool>::value> {};
+
+    //! Uninitialized storage for a buffer of elements
+    /*! @internal */
+    template <class T>
+    struct Buffer
+    {
+      typename std::aligned_storage<sizeof(T), alignof(T)>::type storage[buffer_count<T>::value];
+
+      T * data() { return reinterpret_cast<T *>( storage ); }
+    };
+
+    //! Throws if a range does not hold exactly as many elements as its count
+    /*! @internal */
+    inline void check_count( bool matches )
+    {
+      if( !matches )
+        throw Exception("A range does not hold as many elements as its count");
+    }
+  } // namespace range_detail
+
+  // ######################################################################
+  //! A wrapper around a pair of iterators that is saved like a std::vector
+  /*! @relates range
+      @internal */
+  template <class Iterator>
+  struct RangeWrapper
+  {
+    RangeWrapper( Iterator b, Iterator e, size_type c ) : begin( b ), end( e ), count( c ) {}
+    Iterator begin;
+    Iterator end;
+    size_type count;
+  };
+
+  //! Saves the elements of an iterator range as a std::vector of them
+  /*! The elements are read from the range while they are saved, so query results,
+      elements produced on the fly by an input iterator, or a part of a larger container
+      can be saved without first being copied into a vector.  Data saved from a range can
+      be loaded into a std::vector of its value type, or with cereal::consume.
+      Trivially serializable elements are gathered into a small buffer and written as
+      binary data when the archive supports it, just as std::vector writes them.
+
+      This overload counts the elements with std::distance and so requires a forward
+      iterator.
+
+      @code{.cpp}
+      std::list<Record> records;
+      archive( cereal::range( records.begin(), records.end() ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class Iterator> inline
+  RangeWrapper<Iterator> range( Iterator begin, Iterator end )
+  {
+    static_assert( std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value,
+                   "cereal::range requires a count for input iterators" );
+    return {begin, end, static_cast<size_type>( std::distance( begin, end ) )};
+  }
+
+  //! Saves count elements of an iterator range as a std::vector of them
+  /*! This can be used with single pass input iterators, since the number of
+      elements is known up front.  Saving throws an Exception if the range does not
+      hold exactly count elements, though the elements before the mismatch are already
+      written by then.
+
+      @code{.cpp}
+      archive( cereal::range( std::istream_iterator<int>( input ), std::istream_iterator<int>(), count ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class Iterator> inline
+  RangeWrapper<Iterator> range( Iterator begin, Iterator end, size_type count )
+  {
+    return {begin, end, count};
+  }
+
+  //! Saving for ranges of trivially serializable elements, gathered into binary data
+  template <class Archive, class Iterator> inline
+  typename std::enable_if<range_detail::is_binary_output<Archive, typename std::iterator_traits<Iterator>::value_type>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, RangeWrapper<Iterator> const & wrapper )
+  {
+    typedef typename std::iterator_traits<Iterator>::value_type T;
+
+    ar( make_size_tag( wrapper.count ) );
+
+    range_detail::Buffer<T> buffer;
+    auto it = wrapper.begin;
+    for( size_type remaining = wrapper.count; remaining; )
+    {
+      auto const count = static_cast<std::size_t>( std::min<size_type>( remaining, range_detail::buffer_count<T>::value ) );
+      for( std::size_t i = 0; i < count; ++i, ++it )
+      {
+        range_detail::check_count( it != wrapper.end );
+        T const & value = *it;
+        std::memcpy( buffer.data() + i, &value, sizeof(T) );
+      }
+
+      ar( binary_data( buffer.data(), count * sizeof(T) ) );
+      remaining -= count;
+    }
+
+    range_detail::check_count( it == wrapper.end );
+  }
+
+  //! Saving for ranges of contiguous trivially serializable elements, which are written directly
+  template <class Archive, class T> inline
+  typename std::enable_if<range_detail::is_binary_output<Archive, typename std::remove_const<T>::type>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, RangeWrapper<T *> const & wrapper )
+  {
+    range_detail::check_count( static_cast<size_type>( wrapper.end - wrapper.begin ) == wrapper.count );
+
+    ar( make_size_tag( wrapper.count ) );
+    ar( binary_data( static_cast<T *>( wrapper.begin ), static_cast<std::size_t>( wrapper.count ) * sizeof(T) ) );
+  }
+
+  //! Saving for ranges of elements that are serialized one at a time
+  template <class Archive, class Iterator> inline
+  typename std::enable_if<!range_detail::is_binary_output<Archive, typename std::iterator_traits<Iterator>::value_type>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, RangeWrapper<Iterator> const & wrapper )
+  {
+    typedef typename std::iterator_traits<Iterator>::value_type T;
+
+    ar( make_size_tag( wrapper.count ) );
+
+    auto it = wrapper.begin;
+    for( size_type i = 0; i < wrapper.count; ++i, ++it )
+    {
+      range_detail::check_count( it != wrapper.end );
+      ar( static_cast<T const &>( *it ) );
+    }
+
+    range_detail::check_count( it == wrapper.end );
+  }
+
+  // ######################################################################
+  //! A wrapper around a function that is given each loaded element of a sequence
+  /*! @relates consume
+      @internal */
+  template <class T, class F>
+  struct ConsumeWrapper
+  {
+    ConsumeWrapper( F && f ) : callback( std::forward<F>( f ) ) {}
+    F callback;
+  };
+
+  //! Loads a sequence saved as a std::vector<T>, handing each element to a function instead of storing it
+  /*! Elements are loaded one at a time, or a small buffer at a time for trivially
+      serializable elements, and passed to callback as a T &&.  Nothing but the
+      element at hand is kept, so a sequence can be filtered, aggregated, or inserted
+      into another structure as it is read, with bounded memory.  Anything saved as a
+      std::vector<T> or with cereal::range can be loaded this way.
+
+      @code{.cpp}
+      double total = 0;
+      archive( cereal::consume<Record>( [&]( Record && r ) { total += r.value; } ) );
+      @endcode
+
+      @tparam T The type of the elements
+      @param callback A function called with each element, in order
+      @ingroup Utility */
+  template <class T, class F> inline
+  ConsumeWrapper<T, F> consume( F && callback )
+  {
+    return {std::forward<F>( callback )};
+  }
+
+  //! Loading for consumed sequences of trivially serializable elements, read as binary data
+  template <class Archive, class T, class F> inline
+  typename std::enable_if<range_detail::is_binary_input<Archive, T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, ConsumeWrapper<T, F> & wrapper )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    range_detail::Buffer<T> buffer;
+    while( size )
+    {
+      auto const count = static_cast<std::size_t>( std::min<size_type>( size, range_detail::buffer_count<T>::value ) );
+      ar( binary_data( buffer.data(), count * sizeof(T) ) );
+
+      for( std::size_t i = 0; i < count; ++i )
+        wrapper.callback( std::move( buffer.data()[i] ) );
+      size -= count;
+    }
+  }
+
+  //! Loading for consumed sequences of elements that are serialized one at a time
+  template <class Archive, class T, class F> inline
+  typename std::enable_if<!range_detail::is_binary_input<Archive, T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, ConsumeWrapper<T, F> & wrapper )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    for( size_type i = 0; i < size; ++i )
+    {
+      T value;
+      ar( value );
+      wrapper.callback( std::move( value ) );
+    }
+  }
+
+  // ######################################################################
+  //! A wrapper around a caller provided buffer that a sequence is loaded into
+  /*! @relates into
+      @internal */
+  template <class T>
+  struct IntoWrapper
+  {
+    IntoWrapper( T * d, std::size_t c, std::size_t * l ) : data( d ), capacity( c ), loaded( l ) {}
+    T * data;
+    std::size_t capacity;
+    std::size_t * loaded; //!< Receives the number of loaded elements, or null if it must equal capacity
+  };
+
+  namespace range_detail
+  {
+    //! Throws if a loaded sequence does not fit the buffer it is loaded into, and otherwise records its size
+    /*! @internal */
+    template <class T> inline
+    std::size_t check_into( IntoWrapper<T> const & wrapper, size_type size )
+    {
+      if( wrapper.loaded ? size > wrapper.capacity : size != wrapper.capacity )
+        throw Exception("A sequence does not fit the buffer it is loaded into");
+
+      if( wrapper.loaded )
+        *wrapper.loaded = static_cast<std::size_t>( size );
+      return static_cast<std::size_t>( size );
+    }
+  } // namespace range_detail
+
+  //! Loads a sequence saved as a std::vector<T> into a buffer provided by the caller
+  /*! Nothing is allocated or initialized by the load: trivially serializable elements
+      are copied straight into the buffer as binary data when the archive supports it,
+      so very large sequences can be read into memory that is already reserved, mapped
+      or shared, touching it only once.  Anything saved as a std::vector<T> or with
+      cereal::range can be loaded this way.  In binary archives, strings are saved the
+      same way and so can be loaded into a buffer of characters.
+
+      This overload requires exactly count elements, and loading throws an Exception
+      otherwise.
+
+      @code{.cpp}
+      std::unique_ptr<float[]> samples( new float[count] );
+      archive( cereal::into( samples.get(), count ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  IntoWrapper<T> into( T * data, std::size_t count )
+  {
+    return {data, count, nullptr};
+  }
+
+  //! Loads a sequence saved as a std::vector<T> into a buffer of at most capacity elements
+  /*! The number of elements that were loaded is written to loaded.  Loading throws an
+      Exception if there are more elements than fit in the buffer.
+
+      @code{.cpp}
+      std::size_t count;
+      archive( cereal::into( buffer.data(), buffer.size(), count ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  IntoWrapper<T> into( T * data, std::size_t capacity, std::size_t & loaded )
+  {
+    return {data, capacity, &loaded};
+  }
+
+  //! Loads a sequence saved as a std::vector into a contiguous range, such as a std::span or std::array
+  /*! The range must hold exactly as many elements as are loaded.
+      @ingroup Utility */
+  template <class Contiguous> inline
+  auto into( Contiguous && range ) -> IntoWrapper<typename std::remove_pointer<decltype( range.data() )>::type>
+  {
+    return {range.data(), static_cast<std::size_t>( range.size() ), nullptr};
+  }
+
+  //! Loading into a buffer for trivially serializable elements, read as binary data
+  template <class Archive, class T> inline
+  typename std::enable_if<range_detail::is_binary_input<Archive, T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, IntoWrapper<T> & wrapper )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    auto const count = range_detail::check_into( wrapper, size );
+    ar( binary_data( static_cast<T *>( wrapper.data ), count * sizeof(T) ) );
+  }
+
+  //! Loading into a buffer for elements that are serialized one at a time
+  template <class Archive, class T> inline
+  typename std::enable_if<!range_detail::is_binary_input<Archive, T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, IntoWrapper<T> & wrapper )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    auto const count = range_detail::check_into( wrapper, size );
+    for( std::size_t i = 0; i < count; ++i )
+      ar( wrapper.data[i] );
+  }
+} // namespace cereal
+
+#endif // CEREAL_TYPES_RANGE_HPP_
@@ -56,19 +56,49 @@ namespace cereal
 
       set.clear();
 
-      auto hint = set.begin();
+      // Saved elements are already in order, so each one belongs at the end;
+      // hinting with end() makes every insertion amortized constant time and
+      // keeps equivalent keys of multi containers in their saved order
       for( size_type i = 0; i < size; ++i )
       {
         typename SetT::key_type key;
 
         ar( key );
         #ifdef CEREAL_OLDER_GCC
-        hint = set.insert( hint, std::move( key ) );
+        set.insert( set.end(), std::move( key ) );
         #else // NOT CEREAL_OLDER_GCC
-        hint = set.emplace_hint( hint, std::move( key ) );
+        set.emplace_hint( set.end(), std::move( key ) );
         #endif // NOT CEREAL_OLDER_GCC
       }
     }
+
+    //! Loads a set reusing the elements that it already holds, see in_place
+    /*! Saved sets are in order, so the archive and the set are merged in a single pass.
+        @internal */
+    template <class Archive, class SetT> inline
+    void loadInPlace( Archive & ar, SetT & set )
+    {
+      size_type size;
+      ar( make_size_tag( size ) );
+
+      auto const comp = set.key_comp();
+      auto current = set.begin();
+      typename SetT::key_type key;
+      for( size_type i = 0; i < size; ++i )
+      {
+        ar( key );
+
+        while( current != set.end() && comp( *current, key ) )
+          current = set.erase( current );
+
+        if( current == set.end() || comp( key, *current ) )
+          set.insert( current, key );
+        else
+          ++current;
+      }
+
+      set.erase( current, set.end() );
+    }
   }
 
   //! Saving for std::set
@@ -85,6 +115,13 @@ namespace cereal
     set_detail::load( ar, set );
   }
 
+  //! Loading for std::set wrapped with in_place
+  template <class Archive, class K, class C, class A> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, InPlaceWrapper<std::set<K, C, A>> & wrapper )
+  {
+    set_detail::loadInPlace( ar, wrapper.container );
+  }
+
   //! Saving for std::multiset
   template <class Archive, class K, class C, class A> inline
   void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::multiset<K, C, A> const & multiset )
@@ -98,6 +135,13 @@ namespace cereal
   {
     set_detail::load( ar, multiset );
   }
+
+  //! Loading for std::multiset wrapped with in_place
+  template <class Archive, class K, class C, class A> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, InPlaceWrapper<std::multiset<K, C, A>> & wrapper )
+  {
+    set_detail::loadInPlace( ar, wrapper.container );
+  }
 } // namespace cereal
 
 #endif // CEREAL_TYPES_SET_HPP_
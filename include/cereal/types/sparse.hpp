@@ -0,0 +1,345 @@
+/*! \file sparse.hpp
+    \brief Sparse and run length encoding for vectors of mostly zero numbers
+    \ingroup STLSupport */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TYPES_SPARSE_HPP_
+#define CEREAL_TYPES_SPARSE_HPP_
+
+#include <cereal/cereal.hpp>
+#include <cereal/details/varint.hpp>
+#include <cereal/types/vector.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace cereal
+{
+  namespace sparse_detail
+  {
+    //! The ways a vector wrapped with sparse or rle can be encoded
+    /*! @internal */
+    enum class Encoding : std::uint8_t
+    {
+      dense = 0,       //!< Every value as binary data
+      index_value = 1, //!< The gaps between the indices of non zero values, then those values
+      run_length = 2   //!< The lengths of alternating runs of zeros and non zero values, then those values
+    };
+  } // namespace sparse_detail
+
+  // ######################################################################
+  //! A wrapper around a vector of numbers that is saved without most of its zeros
+  /*! @relates sparse
+      @internal */
+  template <class T>
+  struct SparseWrapper
+  {
+    SparseWrapper( T & v, sparse_detail::Encoding e ) : vector( v ), encoding( e ) {}
+    T & vector;
+    sparse_detail::Encoding encoding;
+
+    SparseWrapper & operator=( SparseWrapper const & ) = delete;
+  };
+
+  namespace sparse_detail
+  {
+    //! Checks that a vector can be wrapped with sparse or rle
+    /*! @internal */
+    template <class T> inline
+    SparseWrapper<T> make_wrapper( T & vector, Encoding encoding )
+    {
+      static_assert( std::is_arithmetic<typename std::remove_const<T>::type::value_type>::value &&
+                     !std::is_same<typename std::remove_const<T>::type::value_type, bool>::value,
+                     "sparse and rle require a vector of numbers" );
+      return {vector, encoding};
+    }
+  } // namespace sparse_detail
+
+  //! Serializes a vector of mostly zero numbers as the indices and values of its non zero values
+  /*! When wrapped with sparse, binary archives save the gap between the index
+      of every non zero value and the one before it as a block of LEB128 varints,
+      followed by all of the non zero values as a single block of binary data.
+      This suits data where the non zero values are scattered, such as feature
+      vectors.  If that would take as much space as saving every value, the
+      vector is saved densely instead.
+
+      Loading reads the non zero values straight into the front of the vector
+      and spreads them out into place from the back.  Only zeros with a positive
+      sign are left out, so that negative zeros round trip.  Archives that do not
+      support binary data save the vector as usual.  Data saved through sparse or
+      rle must be loaded through one of them, but either can load the other.
+
+      @code{.cpp}
+      std::vector<float> features;
+      archive( cereal::sparse( features ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  SparseWrapper<T> sparse( T & vector )
+  {
+    return sparse_detail::make_wrapper( vector, sparse_detail::Encoding::index_value );
+  }
+
+  //! Serializes a vector of mostly zero numbers as runs of zeros and of non zero values
+  /*! When wrapped with rle, binary archives save the lengths of alternating runs
+      of zeros and of non zero values as a block of LEB128 varints, followed by
+      all of the non zero values as a single block of binary data.  This suits
+      data where zeros come in long runs, such as occupancy grids.  As with
+      sparse, the vector is saved densely instead if that would take less space.
+
+      @code{.cpp}
+      std::vector<std::uint8_t> occupancy;
+      archive( cereal::rle( occupancy ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  SparseWrapper<T> rle( T & vector )
+  {
+    return sparse_detail::make_wrapper( vector, sparse_detail::Encoding::run_length );
+  }
+
+  namespace sparse_detail
+  {
+    //! Whether a value is left out of the encoding, which for floating point excludes negative zero
+    /*! @internal */
+    template <class T> inline
+    typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+    is_zero( T value )
+    {
+      return value == T( 0 ) && !std::signbit( value );
+    }
+
+    //! Whether a value is left out of the encoding
+    /*! @internal */
+    template <class T> inline
+    typename std::enable_if<!std::is_floating_point<T>::value, bool>::type
+    is_zero( T value )
+    {
+      return value == T( 0 );
+    }
+
+    //! Spreads count index value encoded values from the front of data out into place
+    /*! @throws Exception if the indices are malformed
+        @internal */
+    template <class T> inline
+    void decode_index_value( T * data, std::size_t size, std::size_t count, std::uint8_t const * pos, std::uint8_t const * end )
+    {
+      std::vector<std::size_t> indices( count );
+      std::size_t next = 0;
+      for( auto & index : indices )
+      {
+        auto const gap = varint_detail::decode_varint( pos, end );
+        if( gap >= size - next )
+          throw Exception("Sparse vector holds an index past its size");
+
+        index = next + static_cast<std::size_t>( gap );
+        next = index + 1;
+      }
+
+      if( pos != end )
+        throw Exception("Sparse vector indices hold more data than their count");
+
+      // Every index is at least its position, so each value is moved before its slot is overwritten
+      auto last = size;
+      for( auto k = count; k-- > 0; )
+      {
+        auto const index = indices[k];
+        std::fill( data + index + 1, data + last, T( 0 ) );
+        data[index] = data[k];
+        last = index;
+      }
+      std::fill( data, data + last, T( 0 ) );
+    }
+
+    //! Spreads count run length encoded values from the front of data out into place
+    /*! @throws Exception if the runs are malformed
+        @internal */
+    template <class T> inline
+    void decode_run_length( T * data, std::size_t size, std::size_t count, std::uint8_t const * pos, std::uint8_t const * end )
+    {
+      std::vector<std::pair<std::size_t, std::size_t>> runs;
+      std::size_t total = 0;
+      std::size_t values = 0;
+      while( pos != end )
+      {
+        auto const zeros = varint_detail::decode_varint( pos, end );
+        auto const literals = varint_detail::decode_varint( pos, end );
+        if( zeros > size - total || literals > size - total - zeros || literals > count - values )
+          throw Exception("Run length encoded vector holds more values than its size");
+
+        runs.emplace_back( static_cast<std::size_t>( zeros ), static_cast<std::size_t>( literals ) );
+        total += runs.back().first + runs.back().second;
+        values += runs.back().second;
+      }
+
+      if( total != size || values != count )
+        throw Exception("Run length encoded vector holds fewer values than its size");
+
+      // Values only ever move towards the back, so going from the last run they are never overwritten
+      auto destination = size;
+      auto source = count;
+      for( auto run = runs.rbegin(); run != runs.rend(); ++run )
+      {
+        destination -= run->second;
+        source -= run->second;
+        std::memmove( data + destination, data + source, run->second * sizeof(T) );
+
+        destination -= run->first;
+        std::fill( data + destination, data + destination + run->first, T( 0 ) );
+      }
+    }
+  } // namespace sparse_detail
+
+  //! Saving for vectors of numbers wrapped with sparse or rle, if binary data is supported
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, SparseWrapper<T> const & wrapper )
+  {
+    typedef typename std::remove_const<T>::type::value_type ValueT;
+
+    auto const & vector = wrapper.vector;
+
+    std::vector<ValueT> values;
+    std::vector<std::uint8_t> encoded;
+
+    if( wrapper.encoding == sparse_detail::Encoding::index_value )
+    {
+      std::size_t next = 0;
+      for( std::size_t i = 0; i < vector.size(); ++i )
+        if( !sparse_detail::is_zero( vector[i] ) )
+        {
+          varint_detail::append_varint( encoded, i - next );
+          values.push_back( vector[i] );
+          next = i + 1;
+        }
+    }
+    else
+    {
+      for( std::size_t i = 0; i < vector.size(); )
+      {
+        auto const zerosBegin = i;
+        while( i < vector.size() && sparse_detail::is_zero( vector[i] ) )
+          ++i;
+
+        auto const literalsBegin = i;
+        while( i < vector.size() && !sparse_detail::is_zero( vector[i] ) )
+          values.push_back( vector[i++] );
+
+        varint_detail::append_varint( encoded, literalsBegin - zerosBegin );
+        varint_detail::append_varint( encoded, i - literalsBegin );
+      }
+    }
+
+    auto encoding = wrapper.encoding;
+    if( encoded.size() + values.size() * sizeof(ValueT) >= vector.size() * sizeof(ValueT) )
+      encoding = sparse_detail::Encoding::dense;
+
+    ar( make_size_tag( static_cast<size_type>( vector.size() ) ) );
+    ar( static_cast<std::uint8_t>( encoding ) );
+
+    if( encoding == sparse_detail::Encoding::dense )
+    {
+      ar( binary_data( vector.data(), vector.size() * sizeof(ValueT) ) );
+      return;
+    }
+
+    ar( make_size_tag( static_cast<size_type>( values.size() ) ) );
+    ar( make_size_tag( static_cast<size_type>( encoded.size() ) ) );
+    ar( binary_data( encoded.data(), encoded.size() ) );
+    ar( binary_data( values.data(), values.size() * sizeof(ValueT) ) );
+  }
+
+  //! Loading for vectors of numbers wrapped with sparse or rle, if binary data is supported
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_input_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, SparseWrapper<T> & wrapper )
+  {
+    typedef typename T::value_type ValueT;
+
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    std::uint8_t encoding;
+    ar( encoding );
+
+    auto & vector = wrapper.vector;
+
+    if( encoding == static_cast<std::uint8_t>( sparse_detail::Encoding::dense ) )
+    {
+      vector.resize( static_cast<std::size_t>( size ) );
+      ar( binary_data( vector.data(), vector.size() * sizeof(ValueT) ) );
+      return;
+    }
+
+    if( encoding != static_cast<std::uint8_t>( sparse_detail::Encoding::index_value ) &&
+        encoding != static_cast<std::uint8_t>( sparse_detail::Encoding::run_length ) )
+      throw Exception("Sparse vector has an unknown encoding");
+
+    size_type count;
+    ar( make_size_tag( count ) );
+
+    size_type encodedSize;
+    ar( make_size_tag( encodedSize ) );
+
+    if( count > size )
+      throw Exception("Sparse vector holds more values than its size");
+
+    std::vector<std::uint8_t> encoded( static_cast<std::size_t>( encodedSize ) );
+    ar( binary_data( encoded.data(), encoded.size() ) );
+
+    // The non zero values are loaded straight into the vector, then spread out in place
+    vector.resize( static_cast<std::size_t>( size ) );
+    ar( binary_data( vector.data(), static_cast<std::size_t>( count ) * sizeof(ValueT) ) );
+
+    auto const pos = static_cast<std::uint8_t const *>( encoded.data() );
+    if( encoding == static_cast<std::uint8_t>( sparse_detail::Encoding::index_value ) )
+      sparse_detail::decode_index_value( vector.data(), vector.size(), static_cast<std::size_t>( count ), pos, pos + encoded.size() );
+    else
+      sparse_detail::decode_run_length( vector.data(), vector.size(), static_cast<std::size_t>( count ), pos, pos + encoded.size() );
+  }
+
+  //! Saving for vectors wrapped with sparse or rle, which is the same as saving the vector
+  template <class Archive, class T> inline
+  typename std::enable_if<!traits::is_output_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, SparseWrapper<T> const & wrapper )
+  {
+    CEREAL_SAVE_FUNCTION_NAME( ar, static_cast<typename std::add_const<T>::type &>( wrapper.vector ) );
+  }
+
+  //! Loading for vectors wrapped with sparse or rle, which is the same as loading the vector
+  template <class Archive, class T> inline
+  typename std::enable_if<!traits::is_input_serializable<BinaryData<std::uint8_t>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, SparseWrapper<T> & wrapper )
+  {
+    CEREAL_LOAD_FUNCTION_NAME( ar, wrapper.vector );
+  }
+} // namespace cereal
+
+#endif // CEREAL_TYPES_SPARSE_HPP_
@@ -42,11 +42,11 @@ namespace cereal
   {
     //! Allows access to the protected container in stack
     template <class T, class C> inline
-    C const & container( std::stack<T, C> const & stack )
+    C & container( std::stack<T, C> & stack )
     {
       struct H : public std::stack<T, C>
       {
-        static C const & get( std::stack<T, C> const & s )
+        static C & get( std::stack<T, C> & s )
         {
           return s.*(&H::c);
         }
@@ -54,6 +54,13 @@ namespace cereal
 
       return H::get( stack );
     }
+
+    //! Allows access to the protected container in stack
+    template <class T, class C> inline
+    C const & container( std::stack<T, C> const & stack )
+    {
+      return container( const_cast<std::stack<T, C> &>( stack ) );
+    }
   }
 
   //! Saving for std::stack
@@ -67,9 +74,7 @@ namespace cereal
   template <class Archive, class T, class C> inline
   void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::stack<T, C> & stack )
   {
-    C container;
-    ar( CEREAL_NVP_("container", container) );
-    stack = std::stack<T, C>( std::move( container ) );
+    ar( CEREAL_NVP_("container", stack_detail::container( stack )) );
   }
 } // namespace cereal
 
@@ -35,6 +35,24 @@
 
 namespace cereal
 {
+  namespace string_detail
+  {
+    //! Resizes a string to hold size characters that are about to be overwritten
+    /*! Where std::basic_string::resize_and_overwrite is available, any new characters are
+        left uninitialized instead of being zero filled, so a large string is written only
+        once as it is loaded.
+        @internal */
+    template <class CharT, class Traits, class Alloc> inline
+    void resize_for_overwrite( std::basic_string<CharT, Traits, Alloc> & str, std::size_t size )
+    {
+    #ifdef __cpp_lib_string_resize_and_overwrite
+      str.resize_and_overwrite( size, []( CharT *, std::size_t n ) { return n; } );
+    #else
+      str.resize( size );
+    #endif
+    }
+  } // namespace string_detail
+
   //! Serialization for basic_string types, if binary data is supported
   template<class Archive, class CharT, class Traits, class Alloc> inline
   typename std::enable_if<traits::is_output_serializable<BinaryData<CharT>, Archive>::value, void>::type
@@ -52,9 +70,37 @@ namespace cereal
   {
     size_type size;
     ar( make_size_tag( size ) );
-    str.resize(static_cast<std::size_t>(size));
+    string_detail::resize_for_overwrite( str, static_cast<std::size_t>(size) );
     ar( binary_data( const_cast<CharT *>( str.data() ), static_cast<std::size_t>(size) * sizeof(CharT) ) );
   }
+
+  //! Saving for strings wrapped with interned
+  /*! The id is followed by the string itself only for its first occurrence */
+  template <class Archive, class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(Archive & ar, InternedWrapper<T> const & wrapper)
+  {
+    std::uint32_t const id = ar.registerInternedString( wrapper.value );
+    ar( CEREAL_NVP_("id", id) );
+
+    if( id & detail::msb_32bit )
+      ar( CEREAL_NVP_("data", static_cast<std::string const &>( wrapper.value )) );
+  }
+
+  //! Loading for strings wrapped with interned
+  template <class Archive> inline
+  void CEREAL_LOAD_FUNCTION_NAME(Archive & ar, InternedWrapper<std::string> & wrapper)
+  {
+    std::uint32_t id;
+    ar( CEREAL_NVP_("id", id) );
+
+    if( id & detail::msb_32bit )
+    {
+      ar( CEREAL_NVP_("data", wrapper.value) );
+      ar.registerInternedString( id, wrapper.value );
+    }
+    else
+      wrapper.value = ar.getInternedString( id );
+  }
 } // namespace cereal
 
 #endif // CEREAL_TYPES_STRING_HPP_
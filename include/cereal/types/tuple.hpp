@@ -118,6 +118,14 @@ namespace cereal
   {
     tuple_detail::serialize<std::tuple_size<std::tuple<Types...>>::value>::template apply( ar, tuple );
   }
+
+  namespace traits
+  {
+    //! std::tuple of fixed size types
+    template <class ... Types>
+    struct fixed_binary_size<std::tuple<Types...>, typename std::enable_if<detail::all_fixed_binary_size<Types...>::value>::type> :
+      detail::fixed_binary_size_sum<Types...> {};
+  } // namespace traits
 } // namespace cereal
 
 #endif // CEREAL_TYPES_TUPLE_HPP_
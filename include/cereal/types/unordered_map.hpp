@@ -32,6 +32,9 @@
 
 #include <cereal/cereal.hpp>
 #include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <vector>
 
 namespace cereal
 {
@@ -47,6 +50,92 @@ namespace cereal
         ar( make_map_item(i.first, i.second) );
     }
 
+    //! Kept out of this namespace so that argument dependent lookup does not
+    //! consider the load functions for the items
+    namespace item_detail
+    {
+      //! A map item whose value is loaded into the element after it is inserted
+      /*! The element is inserted with its loaded key and a value initialized value, so
+          the value is never moved.
+          @internal */
+      template <class MapT>
+      struct EmplaceItem
+      {
+        MapT & map;
+
+        EmplaceItem & operator=( EmplaceItem const & ) = delete;
+
+        //! Loads the item, this is only used with input archives
+        template <class Archive> inline
+        void CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar )
+        {
+          typename detail::load_storage<typename MapT::key_type, Archive>::type key;
+          ar( make_nvp<Archive>("key", key) );
+
+          auto const element = map.emplace_hint( map.end(), std::piecewise_construct,
+                                                 std::forward_as_tuple( std::move( detail::loaded_value( key ) ) ),
+                                                 std::forward_as_tuple() );
+
+          ar( make_nvp<Archive>("value", element->second) );
+        }
+      };
+
+      //! A map item that loads its value into the element of the map with its key
+      /*! An element is inserted if the key is not found.  Loaded elements are
+          recorded so that the others can be removed afterwards.
+          @internal */
+      template <class MapT>
+      struct InPlaceItem
+      {
+        MapT & map;
+        typename MapT::key_type & key;
+        std::vector<typename MapT::value_type const *> & loaded;
+
+        InPlaceItem & operator=( InPlaceItem const & ) = delete;
+
+        //! Loads the item, this is only used with input archives
+        template <class Archive> inline
+        void CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar )
+        {
+          ar( make_nvp<Archive>("key", key) );
+
+          auto element = map.find( key );
+          if( element == map.end() )
+            element = map.emplace( key, typename MapT::mapped_type() ).first;
+
+          ar( make_nvp<Archive>("value", element->second) );
+          loaded.push_back( &*element );
+        }
+      };
+    } // namespace item_detail
+
+    //! Loads elements into the nodes of the map, when the value is default constructible
+    /*! @internal */
+    template <class Archive, class MapT> inline
+    void loadElements( Archive & ar, MapT & map, size_type size, std::true_type /* default constructible */ )
+    {
+      for( size_type i = 0; i < size; ++i )
+      {
+        item_detail::EmplaceItem<MapT> item{ map };
+        ar( item );
+      }
+    }
+
+    //! Loads elements and moves them into the map, when the value is constructed by load_and_construct
+    /*! @internal */
+    template <class Archive, class MapT> inline
+    void loadElements( Archive & ar, MapT & map, size_type size, std::false_type /* default constructible */ )
+    {
+      for( size_type i = 0; i < size; ++i )
+      {
+        typename detail::load_storage<typename MapT::key_type, Archive>::type key;
+        typename detail::load_storage<typename MapT::mapped_type, Archive>::type value;
+
+        ar( make_map_item(key, value) );
+        map.emplace( std::move( detail::loaded_value( key ) ), std::move( detail::loaded_value( value ) ) );
+      }
+    }
+
     //! @internal
     template <class Archive, class MapT> inline
     void load( Archive & ar, MapT & map )
@@ -55,16 +144,43 @@ namespace cereal
       ar( make_size_tag( size ) );
 
       map.clear();
-      map.reserve( static_cast<std::size_t>( size ) );
+      // Buckets the container already has, e.g. restored by with_hash_policy,
+      // are kept rather than shrunk to fit
+      if( static_cast<float>( size ) > map.max_load_factor() * static_cast<float>( map.bucket_count() ) )
+        map.reserve( static_cast<std::size_t>( size ) );
+
+      loadElements( ar, map, size, std::is_default_constructible<typename MapT::mapped_type>() );
+    }
+
+    //! Loads an unordered map reusing the elements that it already holds, see in_place
+    /*! @internal */
+    template <class Archive, class MapT> inline
+    void loadInPlace( Archive & ar, MapT & map )
+    {
+      size_type size;
+      ar( make_size_tag( size ) );
+
+      std::vector<typename MapT::value_type const *> loaded;
+      loaded.reserve( static_cast<std::size_t>( size ) );
 
+      typename MapT::key_type key;
       for( size_type i = 0; i < size; ++i )
       {
-        typename MapT::key_type key;
-        typename MapT::mapped_type value;
-
-        ar( make_map_item(key, value) );
-        map.emplace( std::move( key ), std::move( value ) );
+        item_detail::InPlaceItem<MapT> item{ map, key, loaded };
+        ar( item );
       }
+
+      // Every element was loaded unless the map holds more than the archive
+      if( map.size() == loaded.size() )
+        return;
+
+      std::less<typename MapT::value_type const *> const less;
+      std::sort( loaded.begin(), loaded.end(), less );
+      for( auto element = map.begin(); element != map.end(); )
+        if( std::binary_search( loaded.begin(), loaded.end(), &*element, less ) )
+          ++element;
+        else
+          element = map.erase( element );
     }
   }
 
@@ -82,6 +198,13 @@ namespace cereal
     unordered_map_detail::load( ar, unordered_map );
   }
 
+  //! Loading for std::unordered_map wrapped with in_place
+  template <class Archive, class K, class T, class H, class KE, class A> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, InPlaceWrapper<std::unordered_map<K, T, H, KE, A>> & wrapper )
+  {
+    unordered_map_detail::loadInPlace( ar, wrapper.container );
+  }
+
   //! Saving for std::unordered_multimap
   template <class Archive, class K, class T, class H, class KE, class A> inline
   void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::unordered_multimap<K, T, H, KE, A> const & unordered_multimap )
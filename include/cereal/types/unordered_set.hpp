@@ -55,7 +55,10 @@ namespace cereal
       ar( make_size_tag( size ) );
 
       set.clear();
-      set.reserve( static_cast<std::size_t>( size ) );
+      // Buckets the container already has, e.g. restored by with_hash_policy,
+      // are kept rather than shrunk to fit
+      if( static_cast<float>( size ) > set.max_load_factor() * static_cast<float>( set.bucket_count() ) )
+        set.reserve( static_cast<std::size_t>( size ) );
 
       for( size_type i = 0; i < size; ++i )
       {
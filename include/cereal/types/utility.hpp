@@ -42,6 +42,14 @@ namespace cereal
     ar( CEREAL_NVP_("first",  pair.first),
         CEREAL_NVP_("second", pair.second) );
   }
+
+  namespace traits
+  {
+    //! std::pair of fixed size types
+    template <class T1, class T2>
+    struct fixed_binary_size<std::pair<T1, T2>, typename std::enable_if<detail::all_fixed_binary_size<T1, T2>::value>::type> :
+      detail::fixed_binary_size_sum<T1, T2> {};
+  } // namespace traits
 } // namespace cereal
 
 #endif // CEREAL_TYPES_UTILITY_HPP_
@@ -37,20 +37,20 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace cereal
 {
-  //! Saving for std::valarray arithmetic types, using binary serialization, if supported
+  //! Saving for std::valarray arithmetic or trivially serializable types, using binary serialization, if supported
   template <class Archive, class T> inline
   typename std::enable_if<traits::is_output_serializable<BinaryData<T>, Archive>::value
-                          && std::is_arithmetic<T>::value, void>::type
+                          && traits::is_trivially_serializable<T>::value, void>::type
   CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::valarray<T> const & valarray )
   {
     ar( make_size_tag( static_cast<size_type>(valarray.size()) ) ); // number of elements
     ar( binary_data( &valarray[0], valarray.size() * sizeof(T) ) ); // &valarray[0] ok since guaranteed contiguous
   }
 
-  //! Loading for std::valarray arithmetic types, using binary serialization, if supported
+  //! Loading for std::valarray arithmetic or trivially serializable types, using binary serialization, if supported
   template <class Archive, class T> inline
   typename std::enable_if<traits::is_input_serializable<BinaryData<T>, Archive>::value
-                          && std::is_arithmetic<T>::value, void>::type
+                          && traits::is_trivially_serializable<T>::value, void>::type
   CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::valarray<T> & valarray )
   {
     size_type valarraySize;
@@ -63,7 +63,7 @@ namespace cereal
   //! Saving for std::valarray all other types
   template <class Archive, class T> inline
   typename std::enable_if<!traits::is_output_serializable<BinaryData<T>, Archive>::value
-                          || !std::is_arithmetic<T>::value, void>::type
+                          || !traits::is_trivially_serializable<T>::value, void>::type
   CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::valarray<T> const & valarray )
   {
     ar( make_size_tag( static_cast<size_type>(valarray.size()) ) ); // number of elements
@@ -74,7 +74,7 @@ namespace cereal
   //! Loading for std::valarray all other types
   template <class Archive, class T> inline
   typename std::enable_if<!traits::is_input_serializable<BinaryData<T>, Archive>::value
-                          || !std::is_arithmetic<T>::value, void>::type
+                          || !traits::is_trivially_serializable<T>::value, void>::type
   CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::valarray<T> & valarray )
   {
     size_type valarraySize;
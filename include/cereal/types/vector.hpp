@@ -31,24 +31,77 @@
 #define CEREAL_TYPES_VECTOR_HPP_
 
 #include <cereal/cereal.hpp>
+#include <memory>
 #include <vector>
 
 namespace cereal
 {
-  //! Serialization for std::vectors of arithmetic (but not bool) using binary serialization, if supported
+  //! An allocator that default initializes new elements instead of value initializing them
+  /*! Resizing a std::vector with the standard allocator fills the new elements with
+      zeros, so loading a large vector of arithmetic or trivially serializable types
+      writes all of its memory twice: once when it is resized and again when the data
+      is copied in.  A vector using this allocator leaves such elements uninitialized
+      when it grows, and so loading it touches its memory only once.  Other than that
+      it behaves exactly like the allocator it wraps.
+
+      @code{.cpp}
+      std::vector<float, cereal::default_init_allocator<float>> samples;
+      archive( samples );
+      @endcode
+
+      @tparam A The allocator that is wrapped
+      @ingroup Utility */
+  template <class T, class A = std::allocator<T>>
+  class default_init_allocator : public A
+  {
+      using traits = std::allocator_traits<A>;
+
+    public:
+      template <class U>
+      struct rebind
+      {
+        using other = default_init_allocator<U, typename traits::template rebind_alloc<U>>;
+      };
+
+      default_init_allocator() = default;
+      using A::A;
+
+      template <class U, class B>
+      default_init_allocator( default_init_allocator<U, B> const & other ) noexcept :
+        A( static_cast<B const &>( other ) )
+      { }
+
+      //! Default initializes an element, leaving trivial types uninitialized
+      template <class U>
+      void construct( U * ptr ) noexcept( std::is_nothrow_default_constructible<U>::value )
+      {
+        ::new( static_cast<void *>( ptr ) ) U;
+      }
+
+      //! Constructs an element from arguments through the wrapped allocator
+      template <class U, class ... Args>
+      void construct( U * ptr, Args && ... args )
+      {
+        traits::construct( static_cast<A &>( *this ), ptr, std::forward<Args>( args )... );
+      }
+  };
+
+  //! Serialization for std::vectors of arithmetic (but not bool) or trivially serializable types
+  //! using binary serialization, if supported
   template <class Archive, class T, class A> inline
   typename std::enable_if<traits::is_output_serializable<BinaryData<T>, Archive>::value
-                          && std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, void>::type
+                          && traits::is_trivially_serializable<T>::value && !std::is_same<T, bool>::value, void>::type
   CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::vector<T, A> const & vector )
   {
     ar( make_size_tag( static_cast<size_type>(vector.size()) ) ); // number of elements
     ar( binary_data( vector.data(), vector.size() * sizeof(T) ) );
   }
 
-  //! Serialization for std::vectors of arithmetic (but not bool) using binary serialization, if supported
+  //! Serialization for std::vectors of arithmetic (but not bool) or trivially serializable types
+  //! using binary serialization, if supported
   template <class Archive, class T, class A> inline
   typename std::enable_if<traits::is_input_serializable<BinaryData<T>, Archive>::value
-                          && std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, void>::type
+                          && traits::is_trivially_serializable<T>::value && !std::is_same<T, bool>::value, void>::type
   CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::vector<T, A> & vector )
   {
     size_type vectorSize;
@@ -61,7 +114,7 @@ namespace cereal
   //! Serialization for non-arithmetic vector types
   template <class Archive, class T, class A> inline
   typename std::enable_if<!traits::is_output_serializable<BinaryData<T>, Archive>::value
-                          || !std::is_arithmetic<T>::value, void>::type
+                          || !traits::is_trivially_serializable<T>::value, void>::type
   CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::vector<T, A> const & vector )
   {
     ar( make_size_tag( static_cast<size_type>(vector.size()) ) ); // number of elements
@@ -72,7 +125,7 @@ namespace cereal
   //! Serialization for non-arithmetic vector types
   template <class Archive, class T, class A> inline
   typename std::enable_if<!traits::is_input_serializable<BinaryData<T>, Archive>::value
-                          || !std::is_arithmetic<T>::value, void>::type
+                          || !traits::is_trivially_serializable<T>::value, void>::type
   CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::vector<T, A> & vector )
   {
     size_type size;
@@ -107,6 +160,100 @@ namespace cereal
       v = b;
     }
   }
+
+  // ######################################################################
+  //! A wrapper around a bool vector that is saved packed into 64 bit words
+  /*! @relates packed_bits
+      @internal */
+  template <class T>
+  struct PackedBitsWrapper
+  {
+    PackedBitsWrapper( T & v ) : vector( v ) {}
+    T & vector;
+
+    PackedBitsWrapper & operator=( PackedBitsWrapper const & ) = delete;
+  };
+
+  //! Serializes a bool vector packed into 64 bit words
+  /*! A std::vector<bool> is normally saved as one bool per element, which takes a
+      whole byte in binary archives.  When wrapped with packed_bits, archives that
+      support binary data save its size followed by ceil(size / 64) uint64_t words
+      written in one block, with bit i in word i / 64 at position i % 64.  Archives
+      that do not support binary data save the vector as usual.  Data saved through
+      the wrapper must be loaded through it.
+
+      @code{.cpp}
+      std::vector<bool> index;
+      archive( cereal::packed_bits( index ) );
+      @endcode
+
+      @ingroup Utility */
+  template <class T> inline
+  PackedBitsWrapper<T> packed_bits( T & vector )
+  {
+    static_assert( std::is_same<typename std::remove_const<T>::type::value_type, bool>::value,
+                   "packed_bits requires a vector of bools" );
+    return {vector};
+  }
+
+  namespace vector_detail
+  {
+    //! The number of bits packed into each word by packed_bits
+    /*! @internal */
+    static const std::size_t bool_word_bits = 64;
+  }
+
+  //! Saving for bool vectors wrapped with packed_bits, if binary data is supported
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<std::uint64_t>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, PackedBitsWrapper<T> const & wrapper )
+  {
+    auto const & vector = wrapper.vector;
+    ar( make_size_tag( static_cast<size_type>(vector.size()) ) ); // number of elements
+
+    std::vector<std::uint64_t> words( ( vector.size() + vector_detail::bool_word_bits - 1 ) / vector_detail::bool_word_bits );
+    auto bit = vector.begin();
+    for( auto & word : words )
+      for( std::size_t i = 0; i < vector_detail::bool_word_bits && bit != vector.end(); ++i, ++bit )
+        word |= static_cast<std::uint64_t>( *bit ) << i;
+
+    ar( binary_data( words.data(), words.size() * sizeof(std::uint64_t) ) );
+  }
+
+  //! Loading for bool vectors wrapped with packed_bits, if binary data is supported
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_input_serializable<BinaryData<std::uint64_t>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, PackedBitsWrapper<T> & wrapper )
+  {
+    auto & vector = wrapper.vector;
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    std::vector<std::uint64_t> words( static_cast<std::size_t>( ( size + vector_detail::bool_word_bits - 1 ) / vector_detail::bool_word_bits ) );
+    ar( binary_data( words.data(), words.size() * sizeof(std::uint64_t) ) );
+
+    vector.resize( static_cast<std::size_t>( size ) );
+    auto bit = vector.begin();
+    for( auto const word : words )
+      for( std::size_t i = 0; i < vector_detail::bool_word_bits && bit != vector.end(); ++i, ++bit )
+        *bit = ( ( word >> i ) & 1 ) != 0;
+  }
+
+  //! Saving for bool vectors wrapped with packed_bits, which is the same as saving the vector
+  template <class Archive, class T> inline
+  typename std::enable_if<!traits::is_output_serializable<BinaryData<std::uint64_t>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, PackedBitsWrapper<T> const & wrapper )
+  {
+    CEREAL_SAVE_FUNCTION_NAME( ar, static_cast<typename std::add_const<T>::type &>( wrapper.vector ) );
+  }
+
+  //! Loading for bool vectors wrapped with packed_bits, which is the same as loading the vector
+  template <class Archive, class T> inline
+  typename std::enable_if<!traits::is_input_serializable<BinaryData<std::uint64_t>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, PackedBitsWrapper<T> & wrapper )
+  {
+    CEREAL_LOAD_FUNCTION_NAME( ar, wrapper.vector );
+  }
 } // namespace cereal
 
 #endif // CEREAL_TYPES_VECTOR_HPP_
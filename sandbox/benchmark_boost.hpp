@@ -0,0 +1,199 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Boost.Serialization adapter for the benchmark corpus
+
+   The corpus types are serialized with free functions in the boost::serialization
+   namespace, which leaves the types themselves as they are for cereal.  Adapters
+   for other libraries are written the same way: a class with a save and load for
+   each workload it supports, converting the corpus to and from whatever the library
+   serializes, in a header included by benchmarks.cpp under its own define. */
+#ifndef CEREAL_SANDBOX_BENCHMARK_BOOST_HPP_
+#define CEREAL_SANDBOX_BENCHMARK_BOOST_HPP_
+
+#include "benchmark_corpus.hpp"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/export.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/unique_ptr.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/weak_ptr.hpp>
+
+#include <cereal/details/streambuf.hpp>
+
+namespace boost
+{
+  namespace serialization
+  {
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Node & n, unsigned int )
+    { ar & n.id & n.label & n.children & n.parent; }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Graph & g, unsigned int )
+    { ar & g.roots; }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Vertex & v, unsigned int )
+    { ar & v.x & v.y; }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Shape & s, unsigned int )
+    { ar & s.color; }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Polygon & p, unsigned int )
+    { ar & base_object<corpus::Shape>( p ) & p.points; }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Triangle & t, unsigned int )
+    { ar & base_object<corpus::Polygon>( t ) & t.filled; }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Quad & q, unsigned int )
+    { ar & base_object<corpus::Polygon>( q ) & q.rounding; }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Ellipse & e, unsigned int )
+    { ar & base_object<corpus::Shape>( e ) & e.center & e.rx & e.ry; }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Circle & c, unsigned int )
+    { ar & base_object<corpus::Ellipse>( c ) & c.label; }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Scene & s, unsigned int )
+    { ar & s.shapes; }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Employee & e, unsigned int const version )
+    {
+      ar & e.id & e.name;
+      if( version >= 1 )
+        ar & e.email;
+      if( version >= 2 )
+        ar & e.salary;
+      else
+      {
+        std::int64_t cents = static_cast<std::int64_t>( e.salary * 100 );
+        ar & cents;
+        e.salary = static_cast<double>( cents ) / 100;
+      }
+    }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Department & d, unsigned int )
+    { ar & d.name & d.staff; }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Staff & s, unsigned int )
+    { ar & s.departments; }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Dictionary & d, unsigned int )
+    { ar & d.synonyms & d.attributes; }
+
+    // The fields of a measurement are saved by save_construct_data, before the object
+    template <class Archive>
+    void serialize( Archive &, corpus::Measurement &, unsigned int )
+    { }
+
+    template <class Archive>
+    void save_construct_data( Archive & ar, corpus::Measurement const * m, unsigned int )
+    { ar << m->sensor << m->time << m->value; }
+
+    template <class Archive>
+    void load_construct_data( Archive & ar, corpus::Measurement * m, unsigned int )
+    {
+      std::string sensor;
+      std::int64_t time;
+      double value;
+      ar >> sensor >> time >> value;
+      ::new( m ) corpus::Measurement( sensor, time, value );
+    }
+
+    template <class Archive>
+    void serialize( Archive & ar, corpus::Readings & r, unsigned int )
+    { ar & r.measurements; }
+  } // namespace serialization
+} // namespace boost
+
+BOOST_SERIALIZATION_ASSUME_ABSTRACT(corpus::Shape)
+BOOST_CLASS_EXPORT_GUID(corpus::Triangle, "corpus::Triangle")
+BOOST_CLASS_EXPORT_GUID(corpus::Quad, "corpus::Quad")
+BOOST_CLASS_EXPORT_GUID(corpus::Ellipse, "corpus::Ellipse")
+BOOST_CLASS_EXPORT_GUID(corpus::Circle, "corpus::Circle")
+BOOST_CLASS_VERSION(corpus::Employee, 2)
+BOOST_CLASS_VERSION(corpus::Department, 1)
+
+//! Saves and loads the corpus with a Boost archive
+template <class OArchive, class IArchive>
+class BoostAdapter
+{
+  public:
+    static void save( corpus::Graph const & data, std::string & buffer )      { saveData( data, buffer ); }
+    static void save( corpus::Scene const & data, std::string & buffer )      { saveData( data, buffer ); }
+    static void save( corpus::Staff const & data, std::string & buffer )      { saveData( data, buffer ); }
+    static void save( corpus::Dictionary const & data, std::string & buffer ) { saveData( data, buffer ); }
+    static void save( corpus::Readings const & data, std::string & buffer )   { saveData( data, buffer ); }
+
+    static void load( std::string const & buffer, corpus::Graph & data )      { loadData( buffer, data ); }
+    static void load( std::string const & buffer, corpus::Scene & data )      { loadData( buffer, data ); }
+    static void load( std::string const & buffer, corpus::Staff & data )      { loadData( buffer, data ); }
+    static void load( std::string const & buffer, corpus::Dictionary & data ) { loadData( buffer, data ); }
+    static void load( std::string const & buffer, corpus::Readings & data )   { loadData( buffer, data ); }
+
+  private:
+    template <class T>
+    static void saveData( T const & data, std::string & buffer )
+    {
+      buffer.clear();
+      cereal::streambuf_detail::StringWriteBuffer sb( buffer );
+      std::ostream os( &sb );
+      OArchive ar( os );
+      ar << data;
+    }
+
+    template <class T>
+    static void loadData( std::string const & buffer, T & data )
+    {
+      cereal::streambuf_detail::MemoryReadBuffer sb( buffer.data(), buffer.size() );
+      std::istream is( &sb );
+      IArchive ar( is );
+      ar >> data;
+    }
+};
+
+#endif // CEREAL_SANDBOX_BENCHMARK_BOOST_HPP_
@@ -0,0 +1,488 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Object graphs for the benchmark corpus
+
+   Each workload is a type that stands for a kind of data found in real programs,
+   together with a function building it from a generator and a checksum used to
+   check that it survived a round trip:
+
+     Graph      - a deep tree of shared pointers, with nodes aliased from several
+                  parents and weak pointers back to the parent of each node
+     Scene      - polymorphic shapes from a three level hierarchy
+     Staff      - versioned classes, nested in each other
+     Dictionary - maps from strings to strings and to vectors of strings
+     Readings   - unique pointers to a type without a default constructor, loaded
+                  with load_and_construct
+
+   The types carry cereal serialization only; other libraries declare theirs
+   outside of the types, see benchmark_boost.hpp. */
+#ifndef CEREAL_SANDBOX_BENCHMARK_CORPUS_HPP_
+#define CEREAL_SANDBOX_BENCHMARK_CORPUS_HPP_
+
+#include <cereal/types/base_class.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/memory.hpp>
+#include <cereal/types/polymorphic.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace corpus
+{
+  // ######################################################################
+  // Graph
+
+  struct Node
+  {
+    std::int32_t id;
+    std::string label;
+    std::vector<std::shared_ptr<Node>> children;
+    std::weak_ptr<Node> parent;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( CEREAL_NVP(id), CEREAL_NVP(label), CEREAL_NVP(children), CEREAL_NVP(parent) ); }
+  };
+
+  struct Graph
+  {
+    std::vector<std::shared_ptr<Node>> roots;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( CEREAL_NVP(roots) ); }
+  };
+
+  //! Builds a forest of n nodes, at most 48 deep, where one node in eight is also the child of a second node
+  /*! Every edge leads from a node to one created after it, so the shared pointers never
+      form a cycle; the cycles go through the weak pointers to the parents. */
+  template <class Generator>
+  Graph makeGraph( std::size_t n, Generator & gen )
+  {
+    Graph graph;
+    std::vector<std::shared_ptr<Node>> nodes;
+    std::vector<std::size_t> depth;
+
+    for( std::size_t i = 0; i < n; ++i )
+    {
+      auto node = std::make_shared<Node>();
+      node->id = static_cast<std::int32_t>( i );
+      node->label = gen.string();
+
+      std::size_t const nearby = static_cast<std::size_t>( gen.integer() & 15 );
+      if( i == 0 || nearby >= i || depth[i - 1 - nearby] >= 48 )
+      {
+        graph.roots.push_back( node );
+        depth.push_back( 0 );
+      }
+      else
+      {
+        auto & parent = nodes[i - 1 - nearby];
+        parent->children.push_back( node );
+        node->parent = parent;
+        depth.push_back( depth[i - 1 - nearby] + 1 );
+      }
+
+      nodes.push_back( node );
+    }
+
+    for( std::size_t i = 0; i + 1 < n; ++i )
+      if( ( gen.integer() & 7 ) == 0 )
+        nodes[i]->children.push_back( nodes[i + 1 + static_cast<std::size_t>( gen.integer() & 0xffff ) % ( n - i - 1 )] );
+
+    return graph;
+  }
+
+  //! Sums the distinct nodes, their contents and their edges, so that lost aliasing changes the result
+  inline std::uint64_t checksum( Graph const & graph )
+  {
+    std::uint64_t sum = 0;
+    std::unordered_set<Node const *> seen;
+    std::vector<Node const *> pending;
+    for( auto const & root : graph.roots )
+      pending.push_back( root.get() );
+
+    while( !pending.empty() )
+    {
+      Node const * node = pending.back();
+      pending.pop_back();
+      if( !seen.insert( node ).second )
+        continue;
+
+      auto const parent = node->parent.lock();
+      sum += static_cast<std::uint64_t>( node->id ) * 31 + node->label.size() + node->children.size() * 7 +
+             ( parent ? static_cast<std::uint64_t>( parent->id ) * 131 : 0 );
+      for( auto const & child : node->children )
+        pending.push_back( child.get() );
+    }
+
+    return sum + seen.size();
+  }
+
+  // ######################################################################
+  // Scene
+
+  struct Vertex
+  {
+    float x, y;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( CEREAL_NVP(x), CEREAL_NVP(y) ); }
+  };
+
+  struct Shape
+  {
+    std::uint32_t color;
+
+    virtual ~Shape() {}
+    virtual std::size_t vertices() const = 0;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( CEREAL_NVP(color) ); }
+  };
+
+  struct Polygon : Shape
+  {
+    std::vector<Vertex> points;
+
+    std::size_t vertices() const { return points.size(); }
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( cereal::base_class<Shape>( this ), CEREAL_NVP(points) ); }
+  };
+
+  struct Triangle : Polygon
+  {
+    bool filled;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( cereal::base_class<Polygon>( this ), CEREAL_NVP(filled) ); }
+  };
+
+  struct Quad : Polygon
+  {
+    float rounding;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( cereal::base_class<Polygon>( this ), CEREAL_NVP(rounding) ); }
+  };
+
+  struct Ellipse : Shape
+  {
+    Vertex center;
+    float rx, ry;
+
+    std::size_t vertices() const { return 1; }
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( cereal::base_class<Shape>( this ), CEREAL_NVP(center), CEREAL_NVP(rx), CEREAL_NVP(ry) ); }
+  };
+
+  struct Circle : Ellipse
+  {
+    std::string label;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( cereal::base_class<Ellipse>( this ), CEREAL_NVP(label) ); }
+  };
+
+  struct Scene
+  {
+    std::vector<std::shared_ptr<Shape>> shapes;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( CEREAL_NVP(shapes) ); }
+  };
+
+  //! Builds a scene of n shapes, drawn evenly from the four concrete types
+  template <class Generator>
+  Scene makeScene( std::size_t n, Generator & gen )
+  {
+    Scene scene;
+    for( std::size_t i = 0; i < n; ++i )
+    {
+      auto vertex = [&]() { return Vertex{ static_cast<float>( gen.real() ), static_cast<float>( gen.real() ) }; };
+      std::shared_ptr<Shape> shape;
+
+      switch( i % 4 )
+      {
+        case 0:
+        {
+          auto t = std::make_shared<Triangle>();
+          t->points = { vertex(), vertex(), vertex() };
+          t->filled = gen.integer() > 0;
+          shape = t;
+          break;
+        }
+        case 1:
+        {
+          auto q = std::make_shared<Quad>();
+          q->points = { vertex(), vertex(), vertex(), vertex() };
+          q->rounding = static_cast<float>( gen.real() );
+          shape = q;
+          break;
+        }
+        case 2:
+        {
+          auto e = std::make_shared<Ellipse>();
+          e->center = vertex();
+          e->rx = static_cast<float>( gen.real() );
+          e->ry = static_cast<float>( gen.real() );
+          shape = e;
+          break;
+        }
+        default:
+        {
+          auto c = std::make_shared<Circle>();
+          c->center = vertex();
+          c->rx = c->ry = static_cast<float>( gen.real() );
+          c->label = gen.string();
+          shape = c;
+        }
+      }
+
+      shape->color = static_cast<std::uint32_t>( gen.integer() );
+      scene.shapes.push_back( shape );
+    }
+    return scene;
+  }
+
+  //! Sums the colors and vertices of the shapes, which depend on their dynamic types
+  inline std::uint64_t checksum( Scene const & scene )
+  {
+    std::uint64_t sum = 0;
+    for( auto const & shape : scene.shapes )
+      sum += shape->color + shape->vertices() * 1009;
+    return sum;
+  }
+
+  // ######################################################################
+  // Staff
+
+  //! Version 1 added the email address, version 2 changed the salary from cents to a double
+  struct Employee
+  {
+    std::int32_t id;
+    std::string name;
+    std::string email;
+    double salary;
+
+    template <class Archive>
+    void serialize( Archive & ar, std::uint32_t const version )
+    {
+      ar( CEREAL_NVP(id), CEREAL_NVP(name) );
+      if( version >= 1 )
+        ar( CEREAL_NVP(email) );
+      if( version >= 2 )
+        ar( CEREAL_NVP(salary) );
+      else
+      {
+        std::int64_t cents = static_cast<std::int64_t>( salary * 100 );
+        ar( CEREAL_NVP(cents) );
+        salary = static_cast<double>( cents ) / 100;
+      }
+    }
+  };
+
+  struct Department
+  {
+    std::string name;
+    std::vector<Employee> staff;
+
+    template <class Archive>
+    void serialize( Archive & ar, std::uint32_t const )
+    { ar( CEREAL_NVP(name), CEREAL_NVP(staff) ); }
+  };
+
+  struct Staff
+  {
+    std::vector<Department> departments;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( CEREAL_NVP(departments) ); }
+  };
+
+  //! Builds n employees in departments of 50
+  template <class Generator>
+  Staff makeStaff( std::size_t n, Generator & gen )
+  {
+    Staff staff;
+    for( std::size_t i = 0; i < n; ++i )
+    {
+      if( i % 50 == 0 )
+        staff.departments.push_back( Department{ gen.string(), {} } );
+
+      Employee e;
+      e.id = static_cast<std::int32_t>( i );
+      e.name = gen.string();
+      e.email = e.name + "@example.com";
+      e.salary = gen.real() + 2000;
+      staff.departments.back().staff.push_back( e );
+    }
+    return staff;
+  }
+
+  inline std::uint64_t checksum( Staff const & staff )
+  {
+    std::uint64_t sum = 0;
+    for( auto const & d : staff.departments )
+    {
+      sum += d.name.size();
+      for( auto const & e : d.staff )
+        sum += static_cast<std::uint64_t>( e.id ) + e.name.size() + e.email.size() + static_cast<std::uint64_t>( e.salary );
+    }
+    return sum;
+  }
+
+  // ######################################################################
+  // Dictionary
+
+  struct Dictionary
+  {
+    std::map<std::string, std::vector<std::string>> synonyms;
+    std::map<std::string, std::string> attributes;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( CEREAL_NVP(synonyms), CEREAL_NVP(attributes) ); }
+  };
+
+  //! Builds n entries in each map, with up to 8 synonyms per word
+  template <class Generator>
+  Dictionary makeDictionary( std::size_t n, Generator & gen )
+  {
+    Dictionary dictionary;
+    for( std::size_t i = 0; i < n; ++i )
+    {
+      auto & words = dictionary.synonyms[gen.string()];
+      for( int j = gen.integer() & 7; j >= 0; --j )
+        words.push_back( gen.string() );
+
+      dictionary.attributes[gen.string()] = gen.string() + gen.string();
+    }
+    return dictionary;
+  }
+
+  inline std::uint64_t checksum( Dictionary const & dictionary )
+  {
+    std::uint64_t sum = 0;
+    for( auto const & s : dictionary.synonyms )
+    {
+      sum += s.first.size() * 3;
+      for( auto const & w : s.second )
+        sum += w.size();
+    }
+    for( auto const & a : dictionary.attributes )
+      sum += a.first.size() * 5 + a.second.size();
+    return sum;
+  }
+
+  // ######################################################################
+  // Readings
+
+  //! A measurement that can only be created complete
+  class Measurement
+  {
+    public:
+      Measurement( std::string const & s, std::int64_t t, double v ) : sensor( s ), time( t ), value( v ) {}
+
+      std::string sensor;
+      std::int64_t time;
+      double value;
+
+      template <class Archive>
+      void serialize( Archive & ar )
+      { ar( CEREAL_NVP(sensor), CEREAL_NVP(time), CEREAL_NVP(value) ); }
+
+      template <class Archive>
+      static void load_and_construct( Archive & ar, cereal::construct<Measurement> & construct )
+      {
+        std::string s;
+        std::int64_t t;
+        double v;
+        ar( cereal::make_nvp( "sensor", s ), cereal::make_nvp( "time", t ), cereal::make_nvp( "value", v ) );
+        construct( s, t, v );
+      }
+  };
+
+  struct Readings
+  {
+    std::vector<std::unique_ptr<Measurement>> measurements;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( CEREAL_NVP(measurements) ); }
+  };
+
+  //! Builds n measurements from 64 sensors
+  template <class Generator>
+  Readings makeReadings( std::size_t n, Generator & gen )
+  {
+    std::vector<std::string> sensors;
+    for( int i = 0; i < 64; ++i )
+      sensors.push_back( "sensor/" + gen.string() );
+
+    Readings readings;
+    for( std::size_t i = 0; i < n; ++i )
+      readings.measurements.emplace_back( new Measurement( sensors[i % 64], static_cast<std::int64_t>( i ) * 1000, gen.real() ) );
+    return readings;
+  }
+
+  inline std::uint64_t checksum( Readings const & readings )
+  {
+    std::uint64_t sum = 0;
+    for( auto const & m : readings.measurements )
+      sum += m->sensor.size() + static_cast<std::uint64_t>( m->time ) + static_cast<std::uint64_t>( static_cast<std::int64_t>( m->value ) );
+    return sum;
+  }
+} // namespace corpus
+
+CEREAL_CLASS_VERSION(corpus::Employee, 2)
+CEREAL_CLASS_VERSION(corpus::Department, 1)
+
+CEREAL_REGISTER_TYPE(corpus::Triangle)
+CEREAL_REGISTER_TYPE(corpus::Quad)
+CEREAL_REGISTER_TYPE(corpus::Ellipse)
+CEREAL_REGISTER_TYPE(corpus::Circle)
+
+#endif // CEREAL_SANDBOX_BENCHMARK_CORPUS_HPP_
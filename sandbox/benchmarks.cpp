@@ -0,0 +1,1559 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Benchmarks saving and loading every standard type supported by cereal with
+// every general purpose archive.
+//
+// Usage: cereal_benchmarks [--size=N] [--warmup=N] [--repetitions=N] [--filter=TEXT] [--allocations] [--json=FILE] [--csv=FILE]
+//        cereal_benchmarks --latency [--messages=N] [--warmup=N] [--filter=TEXT] [--histogram]
+//        cereal_benchmarks --threads[=N] [--duration=MS]
+//        cereal_benchmarks --corpus [--size=N] [--warmup=N] [--repetitions=N] [--filter=TEXT] [--allocations]
+//        cereal_benchmarks --text [--size=N] [--warmup=N] [--repetitions=N] [--filter=TEXT]
+//        cereal_benchmarks --compare BASELINE CANDIDATE [--alpha=P] [--threshold=PERCENT]
+//
+//   --size         Number of elements in each benchmarked container (default 10000)
+//   --warmup       Untimed runs before measuring (default 3)
+//   --repetitions  Timed runs, summarized by their median, minimum and spread (default 20)
+//   --filter       Only run benchmarks whose "archive/type" name contains TEXT
+//   --allocations  Also report, for each save and load, the number of heap allocations,
+//                  the bytes they request, and the peak heap growth while it runs, along
+//                  with the peak resident memory of the process so far
+//
+// Data is written to a reused string and read back in place, so the timings
+// contain only the work of the archives and the type serialization.  Heap use is
+// counted by replacing the global operator new and delete, which is done even
+// without --allocations so that timings are comparable between the two modes.
+// Memory taken with malloc directly, as the JSON library does, is not counted.
+//
+// With --latency, small messages of 50 to 500 bytes are instead saved and loaded one
+// at a time, and the latency of each operation is recorded:
+//
+//   --messages     Messages saved and loaded per benchmark (default 1000000)
+//   --warmup       Untimed passes over the 1024 distinct messages before measuring
+//   --histogram    Also print the full percentile distribution of each benchmark, in
+//                  the format of HdrHistogram's percentile output
+//
+// Each archive is measured with a fresh archive and stream per message, which includes
+// the cost of setting them up, and, for archives that can be reset, with one archive
+// reused for every message.
+//
+// With --threads, 1, 2, 4 and so on up to N threads (default: the number of hardware
+// threads) each save and load their own payload of polymorphic and shared pointers,
+// with a new binary archive per operation, for --duration milliseconds (default 1000).
+// The total throughput for each thread count shows contention in the polymorphic
+// binding registry, the allocator, and anything else shared between archives.
+//
+// With --corpus, the object graphs of benchmark_corpus.hpp, with --size elements each,
+// are run through every cereal archive and through each adapter to another library
+// that was built in.  An adapter is a class with a static save and load for each
+// workload it supports, see CerealAdapter below; the Boost.Serialization adapter in
+// benchmark_boost.hpp is built when CMake finds Boost.  Each row is checked to load
+// the same data that was saved.
+//
+// With --text, the JSON and XML archives save and load documents of --size objects
+// that are mostly numbers, mostly strings needing escapes, or deeply nested, and the
+// throughput is reported in MiB/s and objects/s.  Each document is loaded once with
+// its fields read in the order they were saved, and once in reverse, which makes the
+// archives search for every name.
+//
+// The type, corpus and text benchmarks can also write their results to files:
+//
+//   --json         Every timed run of each benchmark, with the compiler, flags and
+//                  processor they were taken with, for --compare
+//   --csv          The summary of each benchmark, one row per benchmark
+//
+// With --compare, two JSON result files are compared benchmark by benchmark.  A change
+// is reported as significant when the Mann-Whitney U test on the timed runs rejects that
+// they are the same at --alpha (default 0.01), and the medians differ by at least
+// --threshold percent (default 2).  The exit status is 2 if any benchmark is
+// significantly slower in the candidate.
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/xml.hpp>
+
+#include <cereal/types/array.hpp>
+#include <cereal/types/base_class.hpp>
+#include <cereal/types/bitset.hpp>
+#include <cereal/types/chrono.hpp>
+#include <cereal/types/common.hpp>
+#include <cereal/types/complex.hpp>
+#include <cereal/types/deque.hpp>
+#include <cereal/types/forward_list.hpp>
+#include <cereal/types/list.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/memory.hpp>
+#include <cereal/types/polymorphic.hpp>
+#include <cereal/types/queue.hpp>
+#include <cereal/types/set.hpp>
+#include <cereal/types/stack.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/tuple.hpp>
+#include <cereal/types/unordered_map.hpp>
+#include <cereal/types/unordered_set.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/valarray.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <cereal/details/streambuf.hpp>
+
+#include "benchmark_corpus.hpp"
+#ifdef CEREAL_BENCHMARK_BOOST
+#include "benchmark_boost.hpp"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <random>
+#include <string>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+// ######################################################################
+// Allocation tracking
+
+//! Heap use of the program, updated by the global operator new and delete below
+/*! The counters are plain, so counting is turned off with countingHeap before running
+    benchmarks on several threads */
+struct HeapCounters
+{
+  std::size_t allocations; //!< calls to operator new
+  std::size_t bytes;       //!< bytes requested from operator new
+  std::size_t live;        //!< bytes currently allocated
+  std::size_t peak;        //!< the largest value of live since it was last reset
+};
+
+static HeapCounters heap = { 0, 0, 0, 0 };
+static bool countingHeap = true;
+
+//! Room kept in front of each allocation to remember its size and whether it was counted, preserving alignment
+static const std::size_t heapHeader = 2 * sizeof(std::size_t) > sizeof(long double) ? 2 * sizeof(std::size_t) : sizeof(long double);
+
+void * operator new( std::size_t size )
+{
+  auto const block = static_cast<char *>( std::malloc( size + heapHeader ) );
+  if( !block )
+    throw std::bad_alloc();
+
+  reinterpret_cast<std::size_t *>( block )[0] = size;
+  reinterpret_cast<std::size_t *>( block )[1] = countingHeap;
+  if( countingHeap )
+  {
+    ++heap.allocations;
+    heap.bytes += size;
+    heap.live += size;
+    if( heap.live > heap.peak )
+      heap.peak = heap.live;
+  }
+  return block + heapHeader;
+}
+
+void operator delete( void * ptr ) noexcept
+{
+  if( !ptr )
+    return;
+
+  auto const block = static_cast<char *>( ptr ) - heapHeader;
+  if( reinterpret_cast<std::size_t *>( block )[1] )
+    heap.live -= reinterpret_cast<std::size_t *>( block )[0];
+  std::free( block );
+}
+
+void * operator new[]( std::size_t size ) { return ::operator new( size ); }
+void operator delete[]( void * ptr ) noexcept { ::operator delete( ptr ); }
+
+//! The peak resident memory of the process so far, in KiB, or 0 if it is unknown
+std::size_t peakResidentKiB()
+{
+  #if defined(__unix__) || defined(__APPLE__)
+  rusage usage;
+  if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+    return 0;
+  #ifdef __APPLE__
+  return static_cast<std::size_t>( usage.ru_maxrss ) / 1024; // reported in bytes
+  #else
+  return static_cast<std::size_t>( usage.ru_maxrss );
+  #endif
+  #else
+  return 0;
+  #endif
+}
+
+// ######################################################################
+// Benchmarked types
+
+enum class Color : std::uint8_t { Red, Green, Blue };
+
+struct Point
+{
+  double x, y, z;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(x), CEREAL_NVP(y), CEREAL_NVP(z) ); }
+};
+
+struct Record
+{
+  std::int32_t id;
+  std::string name;
+  std::vector<float> values;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(id), CEREAL_NVP(name), CEREAL_NVP(values) ); }
+};
+
+struct NamedPoint : Point
+{
+  std::string name;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::base_class<Point>( this ), CEREAL_NVP(name) ); }
+};
+
+struct Shape
+{
+  virtual ~Shape() {}
+  virtual double area() const = 0;
+};
+
+struct Circle : Shape
+{
+  Circle() : radius( 0 ) {}
+  Circle( double r ) : radius( r ) {}
+  double radius;
+
+  double area() const { return 3.14159265358979 * radius * radius; }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(radius) ); }
+};
+
+struct Rectangle : Shape
+{
+  Rectangle() : width( 0 ), height( 0 ) {}
+  Rectangle( double w, double h ) : width( w ), height( h ) {}
+  double width, height;
+
+  double area() const { return width * height; }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(width), CEREAL_NVP(height) ); }
+};
+
+CEREAL_REGISTER_TYPE(Circle)
+CEREAL_REGISTER_TYPE(Rectangle)
+
+// The comparator of std::priority_queue is saved with it, and text archives need a function for it
+namespace cereal
+{
+  template <class Archive, class T> inline
+  void serialize( Archive &, std::less<T> & )
+  { }
+}
+
+// ######################################################################
+// Data generation
+
+//! Generates the data for each benchmark, always the same for a given size
+class Generator
+{
+  public:
+    Generator() : itsEngine( 20140613 ) {}
+
+    int integer() { return std::uniform_int_distribution<int>( -1000000, 1000000 )( itsEngine ); }
+    double real() { return std::uniform_real_distribution<double>( -1000.0, 1000.0 )( itsEngine ); }
+
+    std::string string()
+    {
+      std::string s( std::uniform_int_distribution<std::size_t>( 4, 32 )( itsEngine ), ' ' );
+      for( auto & c : s )
+        c = static_cast<char>( std::uniform_int_distribution<int>( 'a', 'z' )( itsEngine ) );
+      return s;
+    }
+
+  private:
+    std::mt19937 itsEngine;
+};
+
+// ######################################################################
+// Measurement
+
+struct Options
+{
+  std::size_t size = 10000;
+  std::size_t warmup = 3;
+  std::size_t repetitions = 20;
+  std::string filter;
+  bool allocations = false;
+  bool latency = false;
+  std::size_t messages = 1000000;
+  bool histogram = false;
+  std::size_t threads = 0;
+  std::size_t duration = 1000;
+  bool corpus = false;
+  bool text = false;
+  std::string json;
+  std::string csv;
+  std::vector<std::string> compare;
+  double alpha = 0.01;
+  double threshold = 2.0;
+};
+
+//! Heap use of one operation
+struct HeapUse
+{
+  std::size_t allocations, bytes, peak;
+};
+
+//! Heap use of repeated operations, averaged except for the peak, which is the largest seen
+struct HeapStatistics
+{
+  double allocations, kibibytes, peakKiB;
+
+  HeapStatistics( std::vector<HeapUse> const & samples ) : allocations( 0 ), kibibytes( 0 ), peakKiB( 0 )
+  {
+    if( samples.empty() )
+      return;
+
+    for( auto const & s : samples )
+    {
+      allocations += static_cast<double>( s.allocations );
+      kibibytes += static_cast<double>( s.bytes ) / 1024.0;
+      peakKiB = std::max( peakKiB, static_cast<double>( s.peak ) / 1024.0 );
+    }
+    allocations /= static_cast<double>( samples.size() );
+    kibibytes /= static_cast<double>( samples.size() );
+  }
+};
+
+//! Summary of repeated timings, in microseconds
+struct Statistics
+{
+  double median, minimum, deviation;
+
+  Statistics( std::vector<double> samples ) : median( 0 ), minimum( 0 ), deviation( 0 )
+  {
+    if( samples.empty() )
+      return;
+
+    std::sort( samples.begin(), samples.end() );
+    minimum = samples.front();
+    median = samples[samples.size() / 2];
+
+    double mean = 0;
+    for( auto s : samples )
+      mean += s;
+    mean /= static_cast<double>( samples.size() );
+
+    for( auto s : samples )
+      deviation += ( s - mean ) * ( s - mean );
+    deviation = std::sqrt( deviation / static_cast<double>( samples.size() ) );
+  }
+};
+
+//! Times a function, returning microseconds, and records its heap use
+template <class F>
+double measure( F && f, HeapUse & use )
+{
+  HeapCounters const before = heap;
+  heap.peak = heap.live;
+
+  auto const start = std::chrono::steady_clock::now();
+  f();
+  double const elapsed = std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count();
+
+  use.allocations = heap.allocations - before.allocations;
+  use.bytes = heap.bytes - before.bytes;
+  use.peak = heap.peak - before.live;
+  heap.peak = std::max( heap.peak, before.peak );
+  return elapsed;
+}
+
+//! Timed runs of one benchmark, kept for the result files
+struct Result
+{
+  std::string name;
+  std::size_t bytes;
+  std::vector<double> save, load;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(name), CEREAL_NVP(bytes), CEREAL_NVP(save), CEREAL_NVP(load) ); }
+};
+
+//! Where and how a set of results was taken
+struct Environment
+{
+  std::string compiler, flags, processor;
+  std::uint32_t hardwareThreads;
+  std::size_t size, warmup, repetitions;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( CEREAL_NVP(compiler), CEREAL_NVP(flags), CEREAL_NVP(processor), CEREAL_NVP(hardwareThreads),
+        CEREAL_NVP(size), CEREAL_NVP(warmup), CEREAL_NVP(repetitions) );
+  }
+};
+
+//! The contents of a result file
+struct ResultFile
+{
+  Environment environment;
+  std::vector<Result> results;
+};
+
+//! Every benchmark run so far
+std::vector<Result> results;
+
+//! Saves and loads data with a pair of cereal archives
+/*! Other libraries are benchmarked through classes of the same form, which only
+    need a save and load for the types they support. */
+template <class OArchive, class IArchive>
+struct CerealAdapter
+{
+  template <class T>
+  static void save( T const & data, std::string & buffer )
+  {
+    buffer.clear();
+    cereal::streambuf_detail::StringWriteBuffer sb( buffer );
+    std::ostream os( &sb );
+    OArchive ar( os );
+    ar( cereal::make_nvp( "data", data ) );
+  }
+
+  template <class T>
+  static void load( std::string const & buffer, T & data )
+  {
+    cereal::streambuf_detail::MemoryReadBuffer sb( buffer.data(), buffer.size() );
+    std::istream is( &sb );
+    IArchive ar( is );
+    ar( cereal::make_nvp( "data", data ) );
+  }
+};
+
+//! Whether loaded data has the checksum of the saved data, for the corpus types
+template <class T> inline
+auto sameData( T const & saved, T const & loaded, int ) -> decltype( corpus::checksum( saved ), bool() )
+{ return corpus::checksum( saved ) == corpus::checksum( loaded ); }
+
+//! Other types are not checked
+template <class T> inline
+bool sameData( T const &, T const &, long )
+{ return true; }
+
+//! Saves and loads data with an adapter, printing a row of results
+template <class Adapter, class T>
+void benchmark( Options const & options, char const * archiveName, char const * typeName, T const & data )
+{
+  std::string const name = std::string( archiveName ) + "/" + typeName;
+  if( name.find( options.filter ) == std::string::npos )
+    return;
+
+  std::string buffer;
+  T loaded;
+
+  auto save = [&]() { Adapter::save( data, buffer ); };
+  auto load = [&]() { Adapter::load( buffer, loaded ); };
+
+  std::vector<double> saves, loads;
+  std::vector<HeapUse> saveHeap, loadHeap;
+  for( std::size_t i = 0; i < options.warmup + options.repetitions; ++i )
+  {
+    HeapUse saveUse, loadUse;
+    double const s = measure( save, saveUse );
+    double const l = measure( load, loadUse );
+    if( i >= options.warmup )
+    {
+      saves.push_back( s );
+      loads.push_back( l );
+      saveHeap.push_back( saveUse );
+      loadHeap.push_back( loadUse );
+    }
+  }
+
+  results.push_back( Result{ name, buffer.size(), saves, loads } );
+
+  Statistics const saveStats( saves ), loadStats( loads );
+  double const megabytes = static_cast<double>( buffer.size() ) / ( 1024.0 * 1024.0 );
+  std::printf( "%-48s %12zu %12.1f %12.1f %8.1f %10.1f %12.1f %12.1f %8.1f %10.1f",
+               name.c_str(), buffer.size(),
+               saveStats.median, saveStats.minimum, saveStats.deviation, megabytes / ( saveStats.median * 1e-6 ),
+               loadStats.median, loadStats.minimum, loadStats.deviation, megabytes / ( loadStats.median * 1e-6 ) );
+
+  if( options.allocations )
+  {
+    HeapStatistics const saveUse( saveHeap ), loadUse( loadHeap );
+    std::printf( " %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12zu",
+                 saveUse.allocations, saveUse.kibibytes, saveUse.peakKiB,
+                 loadUse.allocations, loadUse.kibibytes, loadUse.peakKiB,
+                 peakResidentKiB() );
+  }
+  std::printf( "%s\n", sameData( data, loaded, 0 ) ? "" : "  loaded data differs" );
+}
+
+//! Runs a benchmark with every archive
+template <class T>
+void benchmarkArchives( Options const & options, char const * typeName, T const & data )
+{
+  benchmark<CerealAdapter<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>>( options, "binary", typeName, data );
+  benchmark<CerealAdapter<cereal::PortableBinaryOutputArchive, cereal::PortableBinaryInputArchive>>( options, "portable_binary", typeName, data );
+  benchmark<CerealAdapter<cereal::JSONOutputArchive, cereal::JSONInputArchive>>( options, "json", typeName, data );
+  benchmark<CerealAdapter<cereal::XMLOutputArchive, cereal::XMLInputArchive>>( options, "xml", typeName, data );
+}
+
+//! Prints the columns written by benchmark
+void printHeader( Options const & options )
+{
+  std::printf( "%zu elements, %zu warmup runs, %zu timed runs; times in microseconds, throughput in MiB/s%s\n\n",
+               options.size, options.warmup, options.repetitions,
+               options.allocations ? ", heap use per operation in KiB" : "" );
+  std::printf( "%-48s %12s %12s %12s %8s %10s %12s %12s %8s %10s",
+               "benchmark", "bytes", "save median", "save min", "stddev", "save MiB/s",
+               "load median", "load min", "stddev", "load MiB/s" );
+  if( options.allocations )
+    std::printf( " %12s %12s %12s %12s %12s %12s %12s",
+                 "save allocs", "save KiB", "save peak", "load allocs", "load KiB", "load peak", "max RSS KiB" );
+  std::printf( "\n" );
+}
+
+//! Fills a container of n elements by calling f
+template <class Container, class F>
+Container make( std::size_t n, F f )
+{
+  Container c;
+  for( std::size_t i = 0; i < n; ++i )
+    c.insert( c.end(), f() );
+  return c;
+}
+
+// ######################################################################
+// Latency of small messages
+
+//! A small message, between 50 and 500 bytes when saved with a binary archive
+struct Message
+{
+  std::uint64_t id;
+  std::int64_t timestamp;
+  std::uint32_t kind;
+  std::string payload;
+  std::vector<std::int32_t> values;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(id), CEREAL_NVP(timestamp), CEREAL_NVP(kind), CEREAL_NVP(payload), CEREAL_NVP(values) ); }
+};
+
+//! A stream buffer reading from memory that can be pointed at new data
+class ReusableReadBuffer : public std::streambuf
+{
+  public:
+    void assign( char const * data, std::size_t size )
+    {
+      auto const begin = const_cast<char *>( data );
+      setg( begin, begin, begin + size );
+    }
+};
+
+//! Latencies of one kind of operation, in nanoseconds
+class Latencies
+{
+  public:
+    Latencies( std::size_t expected ) { itsSamples.reserve( expected ); }
+
+    void record( std::chrono::steady_clock::duration d )
+    {
+      itsSamples.push_back( static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( d ).count() ) );
+    }
+
+    //! Sorts the samples, after which percentiles can be read
+    void finish() { std::sort( itsSamples.begin(), itsSamples.end() ); }
+
+    //! The latency below which the given fraction of samples fall, in microseconds
+    double percentile( double fraction ) const
+    {
+      if( itsSamples.empty() )
+        return 0;
+
+      auto index = static_cast<std::size_t>( std::ceil( fraction * static_cast<double>( itsSamples.size() ) - 1e-9 ) );
+      index = std::min( std::max<std::size_t>( index, 1 ), itsSamples.size() ) - 1;
+      return static_cast<double>( itsSamples[index] ) / 1000.0;
+    }
+
+    //! Prints the distribution the way HdrHistogram's outputPercentileDistribution does
+    void printDistribution( char const * name ) const
+    {
+      std::printf( "\n%s\n%12s %14s %10s %14s\n\n", name, "Value", "Percentile", "TotalCount", "1/(1-Percentile)" );
+
+      // Each step halves the distance to 100%, ticking five times per halving
+      double const ticksPerHalf = 5;
+      for( double fraction = 0; ; )
+      {
+        auto const count = std::max<std::size_t>( 1, static_cast<std::size_t>( std::ceil( fraction * static_cast<double>( itsSamples.size() ) - 1e-9 ) ) );
+        if( count >= itsSamples.size() )
+          break;
+
+        std::printf( "%12.3f %14.12f %10zu %14.2f\n", percentile( fraction ), fraction, count, 1.0 / ( 1.0 - fraction ) );
+
+        double const remaining = 1.0 - fraction;
+        double const halvings = std::floor( std::log2( 1.0 / remaining ) );
+        fraction += std::pow( 0.5, halvings + 1 ) / ticksPerHalf;
+      }
+
+      std::printf( "%12.3f %14.12f %10zu %14s\n", percentile( 1.0 ), 1.0, itsSamples.size(), "inf" );
+      std::printf( "#[Max = %12.3f, Total count = %10zu]\n", percentile( 1.0 ), itsSamples.size() );
+    }
+
+  private:
+    std::vector<std::uint64_t> itsSamples;
+};
+
+//! Prints the percentiles of a save and a load benchmark
+void reportLatency( Options const & options, std::string const & name, Latencies & saves, Latencies & loads, std::size_t bytes )
+{
+  saves.finish();
+  loads.finish();
+
+  for( auto const & row : { std::make_pair( "save", &saves ), std::make_pair( "load", &loads ) } )
+    std::printf( "%-40s %6s %10.2f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+                 name.c_str(), row.first, static_cast<double>( bytes ) / static_cast<double>( options.messages ),
+                 row.second->percentile( 0.5 ), row.second->percentile( 0.99 ), row.second->percentile( 0.999 ),
+                 row.second->percentile( 0.9999 ), row.second->percentile( 1.0 ) );
+
+  if( options.histogram )
+  {
+    saves.printDistribution( ( name + " save" ).c_str() );
+    loads.printDistribution( ( name + " load" ).c_str() );
+    std::printf( "\n" );
+  }
+}
+
+//! Saves and loads each message with a new stream and archive
+template <class OArchive, class IArchive>
+void latencyFresh( Options const & options, char const * archiveName, std::vector<Message> const & messages )
+{
+  std::string const name = std::string( archiveName ) + "/fresh";
+  if( name.find( options.filter ) == std::string::npos )
+    return;
+
+  std::string buffer;
+  Message loaded;
+  Latencies saves( options.messages ), loads( options.messages );
+  std::size_t bytes = 0;
+
+  std::size_t const warmup = options.warmup * messages.size();
+  for( std::size_t i = 0; i < warmup + options.messages; ++i )
+  {
+    Message const & message = messages[i % messages.size()];
+
+    auto const start = std::chrono::steady_clock::now();
+    {
+      buffer.clear();
+      cereal::streambuf_detail::StringWriteBuffer sb( buffer );
+      std::ostream os( &sb );
+      OArchive ar( os );
+      ar( cereal::make_nvp( "message", message ) );
+    }
+    auto const saved = std::chrono::steady_clock::now();
+    {
+      cereal::streambuf_detail::MemoryReadBuffer sb( buffer.data(), buffer.size() );
+      std::istream is( &sb );
+      IArchive ar( is );
+      ar( cereal::make_nvp( "message", loaded ) );
+    }
+    auto const done = std::chrono::steady_clock::now();
+
+    if( i >= warmup )
+    {
+      saves.record( saved - start );
+      loads.record( done - saved );
+      bytes += buffer.size();
+    }
+  }
+
+  reportLatency( options, name, saves, loads, bytes );
+}
+
+//! Saves and loads each message with one archive of each kind, reset between messages
+template <class OArchive, class IArchive>
+void latencyReused( Options const & options, char const * archiveName, std::vector<Message> const & messages )
+{
+  std::string const name = std::string( archiveName ) + "/reused";
+  if( name.find( options.filter ) == std::string::npos )
+    return;
+
+  std::string buffer;
+  cereal::streambuf_detail::StringWriteBuffer writeBuffer( buffer );
+  std::ostream os( &writeBuffer );
+  OArchive oar( os );
+
+  // Input archives may read a header when constructed, so they need a message to start with
+  oar( cereal::make_nvp( "message", messages.front() ) );
+  ReusableReadBuffer readBuffer;
+  readBuffer.assign( buffer.data(), buffer.size() );
+  std::istream is( &readBuffer );
+  IArchive iar( is );
+
+  Message loaded;
+  Latencies saves( options.messages ), loads( options.messages );
+  std::size_t bytes = 0;
+
+  std::size_t const warmup = options.warmup * messages.size();
+  for( std::size_t i = 0; i < warmup + options.messages; ++i )
+  {
+    Message const & message = messages[i % messages.size()];
+
+    auto const start = std::chrono::steady_clock::now();
+    buffer.clear();
+    oar.reset( os );
+    oar( cereal::make_nvp( "message", message ) );
+    auto const saved = std::chrono::steady_clock::now();
+    readBuffer.assign( buffer.data(), buffer.size() );
+    is.clear();
+    iar.reset( is );
+    iar( cereal::make_nvp( "message", loaded ) );
+    auto const done = std::chrono::steady_clock::now();
+
+    if( i >= warmup )
+    {
+      saves.record( saved - start );
+      loads.record( done - saved );
+      bytes += buffer.size();
+    }
+  }
+
+  reportLatency( options, name, saves, loads, bytes );
+}
+
+//! Runs the latency benchmarks for every archive
+void runLatency( Options const & options, Generator & gen )
+{
+  std::vector<Message> messages;
+  for( std::uint64_t i = 0; i < 1024; ++i )
+  {
+    Message m;
+    m.id = i;
+    m.timestamp = gen.integer();
+    m.kind = static_cast<std::uint32_t>( gen.integer() & 0xff );
+    m.payload = std::string( static_cast<std::size_t>( std::abs( gen.integer() ) % 300 + 10 ), 'p' );
+    m.values = make<std::vector<std::int32_t>>( static_cast<std::size_t>( std::abs( gen.integer() ) % 40 ), [&]() { return gen.integer(); } );
+    messages.push_back( m );
+  }
+
+  std::printf( "%zu messages, %zu warmup passes; latencies in microseconds\n\n", options.messages, options.warmup );
+  std::printf( "%-40s %6s %10s %10s %10s %10s %10s %10s\n", "benchmark", "", "bytes", "p50", "p99", "p99.9", "p99.99", "max" );
+
+  latencyFresh<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>( options, "binary", messages );
+  latencyReused<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>( options, "binary", messages );
+  latencyFresh<cereal::PortableBinaryOutputArchive, cereal::PortableBinaryInputArchive>( options, "portable_binary", messages );
+  latencyReused<cereal::PortableBinaryOutputArchive, cereal::PortableBinaryInputArchive>( options, "portable_binary", messages );
+  latencyFresh<cereal::JSONOutputArchive, cereal::JSONInputArchive>( options, "json", messages );
+  latencyFresh<cereal::XMLOutputArchive, cereal::XMLInputArchive>( options, "xml", messages );
+}
+
+// ######################################################################
+// Scaling with threads
+
+//! The payload saved by each thread: polymorphic pointers, and shared pointers saved twice
+struct ThreadPayload
+{
+  std::vector<std::shared_ptr<Shape>> shapes;
+  std::vector<std::shared_ptr<Point>> points;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(shapes), CEREAL_NVP(points) ); }
+};
+
+//! Saves and loads a payload until told to stop, counting the round trips
+/*! Each thread's counter is padded to a cache line, so that the counters themselves
+    do not show up as false sharing */
+struct ThreadWorker
+{
+  std::size_t operations = 0;
+  char padding[64];
+
+  void run( std::atomic<bool> const & start, std::atomic<bool> const & stop )
+  {
+    Generator gen;
+    ThreadPayload payload, loaded;
+    for( int i = 0; i < 128; ++i )
+    {
+      if( i % 2 )
+        payload.shapes.push_back( std::make_shared<Circle>( gen.real() ) );
+      else
+        payload.shapes.push_back( std::make_shared<Rectangle>( gen.real(), gen.real() ) );
+
+      auto const point = std::make_shared<Point>( Point{ gen.real(), gen.real(), gen.real() } );
+      payload.points.push_back( point );
+      payload.points.push_back( point );
+    }
+
+    std::string buffer;
+    while( !start.load( std::memory_order_acquire ) )
+      std::this_thread::yield();
+
+    std::size_t count = 0;
+    while( !stop.load( std::memory_order_relaxed ) )
+    {
+      buffer.clear();
+      {
+        cereal::streambuf_detail::StringWriteBuffer sb( buffer );
+        std::ostream os( &sb );
+        cereal::BinaryOutputArchive ar( os );
+        ar( payload );
+      }
+      {
+        cereal::streambuf_detail::MemoryReadBuffer sb( buffer.data(), buffer.size() );
+        std::istream is( &sb );
+        cereal::BinaryInputArchive ar( is );
+        ar( loaded );
+      }
+      ++count;
+    }
+    operations = count;
+  }
+};
+
+//! Runs the payload on increasing numbers of threads, printing the throughput of each
+void runThreads( Options const & options )
+{
+  // The heap counters are not thread safe
+  countingHeap = false;
+
+  std::printf( "binary archive round trips of %d polymorphic and %d shared pointers, %zu ms per thread count\n\n",
+               128, 256, options.duration );
+  std::printf( "%8s %14s %14s %10s\n", "threads", "round trips/s", "per thread", "scaling" );
+
+  double single = 0;
+  for( std::size_t threads = 1; ; threads = std::min( threads * 2, options.threads ) )
+  {
+    std::vector<ThreadWorker> workers( threads );
+    std::vector<std::thread> pool;
+    std::atomic<bool> start( false ), stop( false );
+
+    for( auto & worker : workers )
+      pool.emplace_back( [&worker, &start, &stop]() { worker.run( start, stop ); } );
+
+    // Give the threads time to build their payloads before starting the clock
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    auto const begin = std::chrono::steady_clock::now();
+    start.store( true, std::memory_order_release );
+    std::this_thread::sleep_for( std::chrono::milliseconds( options.duration ) );
+    stop.store( true, std::memory_order_relaxed );
+    for( auto & t : pool )
+      t.join();
+    double const seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - begin ).count();
+
+    std::size_t total = 0;
+    for( auto const & worker : workers )
+      total += worker.operations;
+
+    double const rate = static_cast<double>( total ) / seconds;
+    if( threads == 1 )
+      single = rate;
+    std::printf( "%8zu %14.0f %14.0f %9.1f%%\n", threads, rate, rate / static_cast<double>( threads ),
+                 single > 0 ? 100.0 * rate / ( single * static_cast<double>( threads ) ) : 0.0 );
+
+    if( threads == options.threads )
+      break;
+  }
+}
+
+// ######################################################################
+// Object graph corpus
+
+//! Whether an adapter can save and load a type
+template <class Adapter, class T, class = void>
+struct supports : std::false_type {};
+
+template <class Adapter, class T>
+struct supports<Adapter, T, decltype( Adapter::save( std::declval<T const &>(), std::declval<std::string &>() ),
+                                      Adapter::load( std::declval<std::string const &>(), std::declval<T &>() ) )> : std::true_type {};
+
+//! Runs a benchmark with an adapter that supports the type
+template <class Adapter, class T>
+void benchmarkSupported( Options const & options, char const * adapterName, char const * typeName, T const & data, std::true_type )
+{
+  benchmark<Adapter>( options, adapterName, typeName, data );
+}
+
+//! Skips an adapter that does not support the type
+template <class Adapter, class T>
+void benchmarkSupported( Options const &, char const *, char const *, T const &, std::false_type )
+{ }
+
+//! Runs a benchmark with every archive, and with the adapters to other libraries that support the type
+/*! Adapters are listed here, each under the define its CMake check sets */
+template <class T>
+void benchmarkAdapters( Options const & options, char const * typeName, T const & data )
+{
+  benchmarkArchives( options, typeName, data );
+
+#ifdef CEREAL_BENCHMARK_BOOST
+  typedef BoostAdapter<boost::archive::binary_oarchive, boost::archive::binary_iarchive> BoostBinary;
+  typedef BoostAdapter<boost::archive::text_oarchive, boost::archive::text_iarchive> BoostText;
+  benchmarkSupported<BoostBinary>( options, "boost_binary", typeName, data, supports<BoostBinary, T>() );
+  benchmarkSupported<BoostText>( options, "boost_text", typeName, data, supports<BoostText, T>() );
+#endif
+}
+
+//! Runs every workload of the corpus
+void runCorpus( Options const & options, Generator & gen )
+{
+  printHeader( options );
+
+  std::size_t const n = options.size;
+  benchmarkAdapters( options, "graph", corpus::makeGraph( n, gen ) );
+  benchmarkAdapters( options, "scene", corpus::makeScene( n, gen ) );
+  benchmarkAdapters( options, "staff", corpus::makeStaff( n, gen ) );
+  benchmarkAdapters( options, "dictionary", corpus::makeDictionary( n, gen ) );
+  benchmarkAdapters( options, "readings", corpus::makeReadings( n, gen ) );
+}
+
+// ######################################################################
+// Text archive throughput
+
+//! An object of numbers, whose fields are loaded in reverse order if OutOfOrder is set
+template <bool OutOfOrder>
+struct Numbers
+{
+  std::int32_t a, b;
+  std::int64_t c;
+  std::uint32_t d;
+  double e, f;
+  float g, h;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  { ar( CEREAL_NVP(a), CEREAL_NVP(b), CEREAL_NVP(c), CEREAL_NVP(d), CEREAL_NVP(e), CEREAL_NVP(f), CEREAL_NVP(g), CEREAL_NVP(h) ); }
+
+  template <class Archive>
+  void load( Archive & ar )
+  {
+    if( OutOfOrder )
+      ar( CEREAL_NVP(h), CEREAL_NVP(g), CEREAL_NVP(f), CEREAL_NVP(e), CEREAL_NVP(d), CEREAL_NVP(c), CEREAL_NVP(b), CEREAL_NVP(a) );
+    else
+      ar( CEREAL_NVP(a), CEREAL_NVP(b), CEREAL_NVP(c), CEREAL_NVP(d), CEREAL_NVP(e), CEREAL_NVP(f), CEREAL_NVP(g), CEREAL_NVP(h) );
+  }
+};
+
+//! An object of strings, some of which need escaping in JSON and XML
+template <bool OutOfOrder>
+struct Strings
+{
+  std::string name, path, quote, description;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  { ar( CEREAL_NVP(name), CEREAL_NVP(path), CEREAL_NVP(quote), CEREAL_NVP(description) ); }
+
+  template <class Archive>
+  void load( Archive & ar )
+  {
+    if( OutOfOrder )
+      ar( CEREAL_NVP(description), CEREAL_NVP(quote), CEREAL_NVP(path), CEREAL_NVP(name) );
+    else
+      ar( CEREAL_NVP(name), CEREAL_NVP(path), CEREAL_NVP(quote), CEREAL_NVP(description) );
+  }
+};
+
+//! A section of a document, with subsections down to a fixed depth
+template <bool OutOfOrder>
+struct Section
+{
+  std::string title;
+  std::int32_t level;
+  std::vector<Section> sections;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  { ar( CEREAL_NVP(title), CEREAL_NVP(level), CEREAL_NVP(sections) ); }
+
+  template <class Archive>
+  void load( Archive & ar )
+  {
+    if( OutOfOrder )
+      ar( CEREAL_NVP(sections), CEREAL_NVP(level), CEREAL_NVP(title) );
+    else
+      ar( CEREAL_NVP(title), CEREAL_NVP(level), CEREAL_NVP(sections) );
+  }
+};
+
+//! Makes n objects of numbers
+template <bool OutOfOrder>
+std::vector<Numbers<OutOfOrder>> makeNumbers( std::size_t n )
+{
+  Generator gen;
+  return make<std::vector<Numbers<OutOfOrder>>>( n, [&]()
+  {
+    return Numbers<OutOfOrder>{ gen.integer(), gen.integer() % 100, static_cast<std::int64_t>( gen.integer() ) * 1000003,
+                                static_cast<std::uint32_t>( gen.integer() & 0xffff ), gen.real(), gen.real() / 3,
+                                static_cast<float>( gen.real() ), static_cast<float>( gen.integer() % 10 ) };
+  } );
+}
+
+//! Makes n objects of strings
+template <bool OutOfOrder>
+std::vector<Strings<OutOfOrder>> makeStrings( std::size_t n )
+{
+  Generator gen;
+  return make<std::vector<Strings<OutOfOrder>>>( n, [&]()
+  {
+    return Strings<OutOfOrder>{ gen.string(), "C:\\data\\" + gen.string() + "/" + gen.string(),
+                                "\"" + gen.string() + "\" <" + gen.string() + "> & \t" + gen.string(),
+                                gen.string() + " " + gen.string() + " " + gen.string() + " " + gen.string() + "\n" + gen.string() };
+  } );
+}
+
+//! Makes a section with n sections below it, most of them in one branch nested up to 64 deep
+template <bool OutOfOrder>
+Section<OutOfOrder> makeSection( std::size_t n, std::int32_t level, Generator & gen )
+{
+  Section<OutOfOrder> section;
+  section.title = gen.string();
+  section.level = level;
+
+  if( n > 0 && level < 64 )
+  {
+    std::size_t const side = ( n - 1 ) / 8;
+    section.sections.push_back( makeSection<OutOfOrder>( n - 1 - side, level + 1, gen ) );
+    if( side > 0 )
+      section.sections.push_back( makeSection<OutOfOrder>( side - 1, level + 1, gen ) );
+  }
+  return section;
+}
+
+//! Counts a section and all the sections below it
+template <bool OutOfOrder>
+std::size_t countSections( Section<OutOfOrder> const & section )
+{
+  std::size_t count = 1;
+  for( auto const & s : section.sections )
+    count += countSections( s );
+  return count;
+}
+
+//! Counts the objects of a document
+template <class T>
+std::size_t countObjects( std::vector<T> const & document ) { return document.size(); }
+
+template <bool OutOfOrder>
+std::size_t countObjects( Section<OutOfOrder> const & document ) { return countSections( document ); }
+
+//! Saves and loads a text document with one archive, printing its throughput
+template <class OArchive, class IArchive, class T>
+void textBenchmark( Options const & options, char const * archiveName, char const * documentName, T const & data )
+{
+  std::string const name = std::string( archiveName ) + "/" + documentName;
+  if( name.find( options.filter ) == std::string::npos )
+    return;
+
+  typedef CerealAdapter<OArchive, IArchive> Adapter;
+  std::string buffer;
+  T loaded;
+
+  std::vector<double> saves, loads;
+  for( std::size_t i = 0; i < options.warmup + options.repetitions; ++i )
+  {
+    HeapUse use;
+    double const s = measure( [&]() { Adapter::save( data, buffer ); }, use );
+    double const l = measure( [&]() { Adapter::load( buffer, loaded ); }, use );
+    if( i >= options.warmup )
+    {
+      saves.push_back( s );
+      loads.push_back( l );
+    }
+  }
+
+  results.push_back( Result{ name, buffer.size(), saves, loads } );
+
+  Statistics const saveStats( saves ), loadStats( loads );
+  double const megabytes = static_cast<double>( buffer.size() ) / ( 1024.0 * 1024.0 );
+  double const objects = static_cast<double>( countObjects( data ) );
+  std::printf( "%-40s %10.0f %12zu %12.1f %10.1f %12.0f %12.1f %10.1f %12.0f\n",
+               name.c_str(), objects, buffer.size(),
+               saveStats.median, megabytes / ( saveStats.median * 1e-6 ), objects / ( saveStats.median * 1e-6 ),
+               loadStats.median, megabytes / ( loadStats.median * 1e-6 ), objects / ( loadStats.median * 1e-6 ) );
+}
+
+//! Runs a text document with the JSON and XML archives, loading it in order and out of order
+template <class InOrder, class OutOfOrder>
+void textBenchmarks( Options const & options, std::string const & documentName, InOrder const & inOrder, OutOfOrder const & outOfOrder )
+{
+  std::string const reversed = documentName + " out of order";
+  textBenchmark<cereal::JSONOutputArchive, cereal::JSONInputArchive>( options, "json", documentName.c_str(), inOrder );
+  textBenchmark<cereal::JSONOutputArchive, cereal::JSONInputArchive>( options, "json", reversed.c_str(), outOfOrder );
+  textBenchmark<cereal::XMLOutputArchive, cereal::XMLInputArchive>( options, "xml", documentName.c_str(), inOrder );
+  textBenchmark<cereal::XMLOutputArchive, cereal::XMLInputArchive>( options, "xml", reversed.c_str(), outOfOrder );
+}
+
+//! Runs the throughput benchmarks of the text archives
+void runText( Options const & options )
+{
+  std::size_t const n = options.size;
+  std::printf( "%zu objects per document, %zu warmup runs, %zu timed runs; median times in microseconds\n\n",
+               n, options.warmup, options.repetitions );
+  std::printf( "%-40s %10s %12s %12s %10s %12s %12s %10s %12s\n",
+               "benchmark", "objects", "bytes", "save median", "save MiB/s", "save obj/s",
+               "load median", "load MiB/s", "load obj/s" );
+
+  textBenchmarks( options, "numbers", makeNumbers<false>( n ), makeNumbers<true>( n ) );
+  textBenchmarks( options, "strings", makeStrings<false>( n ), makeStrings<true>( n ) );
+
+  Generator inOrder, outOfOrder;
+  textBenchmarks( options, "nested", makeSection<false>( n, 0, inOrder ), makeSection<true>( n, 0, outOfOrder ) );
+}
+
+// ######################################################################
+// Standard types
+
+//! Runs a benchmark of every standard type with every archive
+void runTypes( Options const & options, Generator & gen )
+{
+  std::size_t const n = options.size;
+  printHeader( options );
+
+  // common.hpp
+  benchmarkArchives( options, "enum", make<std::vector<Color>>( n, [&]() { return static_cast<Color>( gen.integer() & 1 ); } ) );
+
+  // vector.hpp
+  benchmarkArchives( options, "vector<double>", make<std::vector<double>>( n, [&]() { return gen.real(); } ) );
+  benchmarkArchives( options, "vector<bool>", make<std::vector<bool>>( n, [&]() { return gen.integer() > 0; } ) );
+  benchmarkArchives( options, "vector<Point>", make<std::vector<Point>>( n, [&]() { return Point{ gen.real(), gen.real(), gen.real() }; } ) );
+
+  // string.hpp
+  benchmarkArchives( options, "vector<string>", make<std::vector<std::string>>( n, [&]() { return gen.string(); } ) );
+  benchmarkArchives( options, "string", std::string( n, 'x' ) );
+
+  // array.hpp
+  benchmarkArchives( options, "vector<array<float,4>>",
+                     make<std::vector<std::array<float, 4>>>( n, [&]() { return std::array<float, 4>{ { 1.0f, 2.0f, 3.0f, static_cast<float>( gen.real() ) } }; } ) );
+
+  // bitset.hpp
+  benchmarkArchives( options, "vector<bitset<64>>",
+                     make<std::vector<std::bitset<64>>>( n, [&]() { return std::bitset<64>( static_cast<unsigned long long>( gen.integer() ) ); } ) );
+
+  // chrono.hpp
+  benchmarkArchives( options, "vector<nanoseconds>",
+                     make<std::vector<std::chrono::nanoseconds>>( n, [&]() { return std::chrono::nanoseconds( gen.integer() ); } ) );
+
+  // complex.hpp
+  benchmarkArchives( options, "vector<complex<double>>",
+                     make<std::vector<std::complex<double>>>( n, [&]() { return std::complex<double>( gen.real(), gen.real() ); } ) );
+
+  // deque.hpp, list.hpp, forward_list.hpp
+  benchmarkArchives( options, "deque<int>", make<std::deque<int>>( n, [&]() { return gen.integer(); } ) );
+  benchmarkArchives( options, "list<int>", make<std::list<int>>( n, [&]() { return gen.integer(); } ) );
+  auto const list = make<std::vector<int>>( n, [&]() { return gen.integer(); } );
+  benchmarkArchives( options, "forward_list<int>", std::forward_list<int>( list.begin(), list.end() ) );
+
+  // map.hpp, set.hpp
+  benchmarkArchives( options, "map<int,string>",
+                     make<std::map<int, std::string>>( n, [&]() { return std::make_pair( gen.integer(), gen.string() ); } ) );
+  benchmarkArchives( options, "multimap<int,double>",
+                     make<std::multimap<int, double>>( n, [&]() { return std::make_pair( gen.integer() % 100, gen.real() ); } ) );
+  benchmarkArchives( options, "set<int>", make<std::set<int>>( n, [&]() { return gen.integer(); } ) );
+
+  // unordered_map.hpp, unordered_set.hpp
+  benchmarkArchives( options, "unordered_map<string,int>",
+                     make<std::unordered_map<std::string, int>>( n, [&]() { return std::make_pair( gen.string(), gen.integer() ); } ) );
+  benchmarkArchives( options, "unordered_set<int>", make<std::unordered_set<int>>( n, [&]() { return gen.integer(); } ) );
+
+  // queue.hpp, stack.hpp
+  std::queue<int> queue;
+  std::priority_queue<int> priorityQueue;
+  std::stack<int> stack;
+  for( std::size_t i = 0; i < n; ++i )
+  {
+    queue.push( gen.integer() );
+    priorityQueue.push( gen.integer() );
+    stack.push( gen.integer() );
+  }
+  benchmarkArchives( options, "queue<int>", queue );
+  benchmarkArchives( options, "priority_queue<int>", priorityQueue );
+  benchmarkArchives( options, "stack<int>", stack );
+
+  // tuple.hpp, utility.hpp
+  benchmarkArchives( options, "vector<tuple<int,double,string>>",
+                     make<std::vector<std::tuple<int, double, std::string>>>( n, [&]() { return std::make_tuple( gen.integer(), gen.real(), gen.string() ); } ) );
+  benchmarkArchives( options, "vector<pair<int,double>>",
+                     make<std::vector<std::pair<int, double>>>( n, [&]() { return std::make_pair( gen.integer(), gen.real() ); } ) );
+
+  // valarray.hpp
+  auto const reals = make<std::vector<double>>( n, [&]() { return gen.real(); } );
+  benchmarkArchives( options, "valarray<double>", std::valarray<double>( reals.data(), reals.size() ) );
+
+  // memory.hpp, with every pointer saved twice
+  auto const shared = make<std::vector<std::shared_ptr<Point>>>( n / 2, [&]() { return std::make_shared<Point>( Point{ gen.real(), gen.real(), gen.real() } ); } );
+  auto sharedTwice = shared;
+  sharedTwice.insert( sharedTwice.end(), shared.begin(), shared.end() );
+  benchmarkArchives( options, "vector<shared_ptr<Point>>", sharedTwice );
+
+  // base_class.hpp
+  benchmarkArchives( options, "vector<NamedPoint>", make<std::vector<NamedPoint>>( n, [&]()
+  {
+    NamedPoint p;
+    p.x = gen.real(); p.y = gen.real(); p.z = gen.real();
+    p.name = gen.string();
+    return p;
+  } ) );
+
+  // polymorphic.hpp
+  std::size_t count = 0;
+  benchmarkArchives( options, "vector<shared_ptr<Shape>>", make<std::vector<std::shared_ptr<Shape>>>( n, [&]() -> std::shared_ptr<Shape>
+  {
+    if( ++count % 2 )
+      return std::make_shared<Circle>( gen.real() );
+    return std::make_shared<Rectangle>( gen.real(), gen.real() );
+  } ) );
+
+  // a typical mix of the above
+  benchmarkArchives( options, "vector<Record>", make<std::vector<Record>>( n / 10, [&]()
+  {
+    Record r;
+    r.id = gen.integer();
+    r.name = gen.string();
+    r.values = make<std::vector<float>>( 10, [&]() { return static_cast<float>( gen.real() ); } );
+    return r;
+  } ) );
+}
+
+// ######################################################################
+// Result files
+
+//! The C++ compiler, with its version
+std::string compilerName()
+{
+#if defined(__clang__)
+  return std::string( "clang " ) + __clang_version__;
+#elif defined(__GNUC__)
+  return std::string( "gcc " ) + __VERSION__;
+#elif defined(_MSC_VER)
+  return "msvc " + std::to_string( _MSC_VER );
+#else
+  return "unknown";
+#endif
+}
+
+//! The model name of the processor, if the system reports one
+std::string processorName()
+{
+  std::ifstream cpuinfo( "/proc/cpuinfo" );
+  std::string line;
+  while( std::getline( cpuinfo, line ) )
+    if( line.compare( 0, 10, "model name" ) == 0 && line.find( ':' ) != std::string::npos )
+      return line.substr( line.find_first_not_of( " \t", line.find( ':' ) + 1 ) );
+  return "unknown";
+}
+
+//! Writes the recorded results to the files given with --json and --csv, returning false if one can not be written
+bool writeResults( Options const & options )
+{
+  bool written = true;
+
+  if( !options.json.empty() )
+  {
+    ResultFile file;
+    file.environment.compiler = compilerName();
+#ifdef CEREAL_BENCHMARK_FLAGS
+    file.environment.flags = CEREAL_BENCHMARK_FLAGS;
+#else
+    file.environment.flags = "unknown";
+#endif
+    file.environment.processor = processorName();
+    file.environment.hardwareThreads = std::thread::hardware_concurrency();
+    file.environment.size = options.size;
+    file.environment.warmup = options.warmup;
+    file.environment.repetitions = options.repetitions;
+    file.results = results;
+
+    std::ofstream os( options.json );
+    if( os )
+    {
+      cereal::JSONOutputArchive ar( os );
+      ar( cereal::make_nvp( "environment", file.environment ), cereal::make_nvp( "results", file.results ) );
+    }
+    written = written && os.good();
+  }
+
+  if( !options.csv.empty() )
+  {
+    std::ofstream os( options.csv );
+    os << "benchmark,bytes,save median,save min,save stddev,load median,load min,load stddev\n";
+    for( auto const & r : results )
+    {
+      Statistics const save( r.save ), load( r.load );
+      os << '"' << r.name << "\"," << r.bytes << ','
+         << save.median << ',' << save.minimum << ',' << save.deviation << ','
+         << load.median << ',' << load.minimum << ',' << load.deviation << '\n';
+    }
+    written = written && os.good();
+  }
+
+  if( !written )
+    std::fprintf( stderr, "could not write the results\n" );
+  return written;
+}
+
+//! Two sided p-value of the Mann-Whitney U test that two sets of samples come from the same distribution
+/*! Uses the normal approximation with a correction for ties, which is accurate from about
+    eight samples in each set */
+double mannWhitney( std::vector<double> const & a, std::vector<double> const & b )
+{
+  std::vector<std::pair<double, bool>> all;
+  for( auto x : a )
+    all.emplace_back( x, true );
+  for( auto x : b )
+    all.emplace_back( x, false );
+  std::sort( all.begin(), all.end() );
+
+  // Ranks start at 1, and tied samples share the mean of their ranks
+  double rankSum = 0, ties = 0;
+  for( std::size_t i = 0; i < all.size(); )
+  {
+    std::size_t j = i;
+    while( j < all.size() && all[j].first == all[i].first )
+      ++j;
+
+    double const rank = static_cast<double>( i + 1 + j ) / 2.0;
+    for( std::size_t k = i; k < j; ++k )
+      if( all[k].second )
+        rankSum += rank;
+
+    double const t = static_cast<double>( j - i );
+    ties += t * t * t - t;
+    i = j;
+  }
+
+  double const n1 = static_cast<double>( a.size() ), n2 = static_cast<double>( b.size() ), n = n1 + n2;
+  if( n1 == 0 || n2 == 0 )
+    return 1;
+
+  double const u = rankSum - n1 * ( n1 + 1 ) / 2;
+  double const variance = n1 * n2 / 12 * ( ( n + 1 ) - ties / ( n * ( n - 1 ) ) );
+  if( variance <= 0 )
+    return 1;
+
+  double const z = std::max( 0.0, std::abs( u - n1 * n2 / 2 ) - 0.5 ) / std::sqrt( variance );
+  return std::erfc( z / std::sqrt( 2.0 ) );
+}
+
+//! Loads a result file written with --json
+bool loadResults( std::string const & path, ResultFile & file )
+{
+  std::ifstream is( path );
+  if( !is )
+  {
+    std::fprintf( stderr, "could not open %s\n", path.c_str() );
+    return false;
+  }
+
+  try
+  {
+    cereal::JSONInputArchive ar( is );
+    ar( cereal::make_nvp( "environment", file.environment ), cereal::make_nvp( "results", file.results ) );
+  }
+  catch( std::exception const & e )
+  {
+    std::fprintf( stderr, "could not load %s: %s\n", path.c_str(), e.what() );
+    return false;
+  }
+  return true;
+}
+
+//! Compares the save or load timings of one benchmark, printing their change, returning true if it is a significant regression
+bool compareTimings( Options const & options, std::vector<double> const & baseline, std::vector<double> const & candidate, int & improvements )
+{
+  double const before = Statistics( baseline ).median, after = Statistics( candidate ).median;
+  double const change = before > 0 ? 100.0 * ( after - before ) / before : 0.0;
+  double const p = mannWhitney( baseline, candidate );
+  bool const significant = p < options.alpha && std::abs( change ) >= options.threshold;
+
+  std::printf( " %12.2f %12.2f %+8.1f%% %8.4f %-7s", before, after, change, p,
+               !significant ? "" : change > 0 ? "slower" : "faster" );
+
+  if( significant && change < 0 )
+    ++improvements;
+  return significant && change > 0;
+}
+
+//! Compares two result files, printing the change of every benchmark in both
+/*! A change is significant when the Mann-Whitney U test rejects equal timings at --alpha,
+    and the medians differ by at least --threshold percent.  Returns 2 if any benchmark
+    is significantly slower in the candidate, so that scripts can gate on it. */
+int compareResults( Options const & options, std::string const & baselinePath, std::string const & candidatePath )
+{
+  ResultFile baseline, candidate;
+  if( !loadResults( baselinePath, baseline ) || !loadResults( candidatePath, candidate ) )
+    return 1;
+
+  std::printf( "baseline:  %s\n           %s, %s, %s\n", baselinePath.c_str(), baseline.environment.compiler.c_str(),
+               baseline.environment.flags.c_str(), baseline.environment.processor.c_str() );
+  std::printf( "candidate: %s\n           %s, %s, %s\n", candidatePath.c_str(), candidate.environment.compiler.c_str(),
+               candidate.environment.flags.c_str(), candidate.environment.processor.c_str() );
+  if( baseline.environment.processor != candidate.environment.processor || baseline.environment.size != candidate.environment.size )
+    std::printf( "warning: the results were taken on different processors or with different sizes\n" );
+
+  std::printf( "\nmedians in microseconds; significant at p < %g and a change of at least %g%%\n\n", options.alpha, options.threshold );
+  std::printf( "%-48s %12s %12s %9s %8s %-7s %12s %12s %9s %8s %-7s\n",
+               "benchmark", "save before", "save after", "change", "p", "",
+               "load before", "load after", "change", "p", "" );
+
+  int regressions = 0, improvements = 0;
+  for( auto const & b : candidate.results )
+  {
+    auto const a = std::find_if( baseline.results.begin(), baseline.results.end(),
+                                 [&]( Result const & r ) { return r.name == b.name; } );
+    if( a == baseline.results.end() )
+    {
+      std::printf( "%-48s only in the candidate\n", b.name.c_str() );
+      continue;
+    }
+
+    std::printf( "%-48s", b.name.c_str() );
+    bool const saveSlower = compareTimings( options, a->save, b.save, improvements );
+    bool const loadSlower = compareTimings( options, a->load, b.load, improvements );
+    regressions += saveSlower + loadSlower;
+    std::printf( "\n" );
+  }
+
+  for( auto const & a : baseline.results )
+    if( std::none_of( candidate.results.begin(), candidate.results.end(), [&]( Result const & r ) { return r.name == a.name; } ) )
+      std::printf( "%-48s only in the baseline\n", a.name.c_str() );
+
+  std::printf( "\n%d significantly slower, %d significantly faster\n", regressions, improvements );
+  return regressions ? 2 : 0;
+}
+
+// ######################################################################
+
+bool parseOption( char const * arg, char const * name, std::string & value )
+{
+  std::size_t const length = std::strlen( name );
+  if( std::strncmp( arg, name, length ) != 0 || arg[length] != '=' )
+    return false;
+  value = arg + length + 1;
+  return true;
+}
+
+int main( int argc, char ** argv )
+{
+  Options options;
+  for( int i = 1; i < argc; ++i )
+  {
+    std::string value;
+    if( parseOption( argv[i], "--size", value ) )
+      options.size = std::strtoul( value.c_str(), nullptr, 10 );
+    else if( parseOption( argv[i], "--warmup", value ) )
+      options.warmup = std::strtoul( value.c_str(), nullptr, 10 );
+    else if( parseOption( argv[i], "--repetitions", value ) )
+      options.repetitions = std::strtoul( value.c_str(), nullptr, 10 );
+    else if( parseOption( argv[i], "--filter", value ) )
+      options.filter = value;
+    else if( std::strcmp( argv[i], "--allocations" ) == 0 )
+      options.allocations = true;
+    else if( std::strcmp( argv[i], "--latency" ) == 0 )
+      options.latency = true;
+    else if( parseOption( argv[i], "--messages", value ) )
+      options.messages = std::strtoul( value.c_str(), nullptr, 10 );
+    else if( std::strcmp( argv[i], "--histogram" ) == 0 )
+      options.histogram = true;
+    else if( std::strcmp( argv[i], "--threads" ) == 0 )
+      options.threads = std::max<std::size_t>( 1, std::thread::hardware_concurrency() );
+    else if( parseOption( argv[i], "--threads", value ) )
+      options.threads = std::max<std::size_t>( 1, std::strtoul( value.c_str(), nullptr, 10 ) );
+    else if( parseOption( argv[i], "--duration", value ) )
+      options.duration = std::strtoul( value.c_str(), nullptr, 10 );
+    else if( std::strcmp( argv[i], "--corpus" ) == 0 )
+      options.corpus = true;
+    else if( std::strcmp( argv[i], "--text" ) == 0 )
+      options.text = true;
+    else if( parseOption( argv[i], "--json", value ) )
+      options.json = value;
+    else if( parseOption( argv[i], "--csv", value ) )
+      options.csv = value;
+    else if( std::strcmp( argv[i], "--compare" ) == 0 && i + 2 < argc )
+    {
+      options.compare.push_back( argv[++i] );
+      options.compare.push_back( argv[++i] );
+    }
+    else if( parseOption( argv[i], "--alpha", value ) )
+      options.alpha = std::strtod( value.c_str(), nullptr );
+    else if( parseOption( argv[i], "--threshold", value ) )
+      options.threshold = std::strtod( value.c_str(), nullptr );
+    else
+    {
+      std::fprintf( stderr, "usage: %s [--size=N] [--warmup=N] [--repetitions=N] [--filter=TEXT] [--allocations] [--json=FILE] [--csv=FILE]\n"
+                            "       %s --latency [--messages=N] [--warmup=N] [--filter=TEXT] [--histogram]\n"
+                            "       %s --threads[=N] [--duration=MS]\n"
+                            "       %s --corpus [--size=N] [--warmup=N] [--repetitions=N] [--filter=TEXT] [--allocations]\n"
+                            "       %s --text [--size=N] [--warmup=N] [--repetitions=N] [--filter=TEXT]\n"
+                            "       %s --compare BASELINE CANDIDATE [--alpha=P] [--threshold=PERCENT]\n",
+                            argv[0], argv[0], argv[0], argv[0], argv[0], argv[0] );
+      return 1;
+    }
+  }
+
+  if( !options.compare.empty() )
+    return compareResults( options, options.compare[0], options.compare[1] );
+
+  Generator gen;
+  if( options.latency )
+    runLatency( options, gen );
+  else if( options.threads )
+    runThreads( options );
+  else if( options.corpus )
+    runCorpus( options, gen );
+  else if( options.text )
+    runText( options );
+  else
+    runTypes( options, gen );
+
+  return writeResults( options ) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Types for the compile time benchmark
+
+   compile_time and compile_time_extern serialize the same types with the same
+   archives.  compile_time instantiates everything in one translation unit, as
+   a program that includes cereal wherever it serializes would.  compile_time_extern
+   declares the serialization extern in compile_time.cpp, which then compiles like
+   any other user of the types, and instantiates it once in compile_time_instantiate.cpp.
+
+   Time the build of each target, or of its objects, to follow the cost of
+   cereal's templates. */
+#ifndef CEREAL_SANDBOX_COMPILE_TIME_HPP_
+#define CEREAL_SANDBOX_COMPILE_TIME_HPP_
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/map.hpp>
+
+// A distinct type for every I, each serialized with a single serialize function
+template <int I>
+struct CompileTimeSerialize
+{
+  int a;
+  double b;
+  std::string c;
+  std::vector<int> d;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( a, b, c, d );
+  }
+};
+
+// A distinct type for every I, each serialized with versioned save and load functions
+template <int I>
+struct CompileTimeSplit
+{
+  CompileTimeSerialize<I> inner;
+  std::map<std::string, float> e;
+
+  template <class Archive>
+  void save( Archive & ar, std::uint32_t const ) const
+  {
+    ar( inner, e );
+  }
+
+  template <class Archive>
+  void load( Archive & ar, std::uint32_t const )
+  {
+    ar( inner, e );
+  }
+};
+
+// Applies X to the 32 type indices
+#define COMPILE_TIME_TYPES_8(X, n) X(8*n+0) X(8*n+1) X(8*n+2) X(8*n+3) X(8*n+4) X(8*n+5) X(8*n+6) X(8*n+7)
+#define COMPILE_TIME_TYPES(X) COMPILE_TIME_TYPES_8(X, 0) COMPILE_TIME_TYPES_8(X, 1) \
+                              COMPILE_TIME_TYPES_8(X, 2) COMPILE_TIME_TYPES_8(X, 3)
+
+// Applies SERIALIZATION to every type and archive
+#define COMPILE_TIME_ARCHIVES(SERIALIZATION, TYPE)                \
+  SERIALIZATION(cereal::BinaryOutputArchive, TYPE)                \
+  SERIALIZATION(cereal::BinaryInputArchive, TYPE)                 \
+  SERIALIZATION(cereal::JSONOutputArchive, TYPE)                  \
+  SERIALIZATION(cereal::JSONInputArchive, TYPE)
+
+#define COMPILE_TIME_EXTERN(I) COMPILE_TIME_ARCHIVES(CEREAL_EXTERN_SERIALIZATION, CompileTimeSplit<I>)
+#define COMPILE_TIME_INSTANTIATE(I) COMPILE_TIME_ARCHIVES(CEREAL_INSTANTIATE_SERIALIZATION, CompileTimeSplit<I>)
+
+#endif // CEREAL_SANDBOX_COMPILE_TIME_HPP_
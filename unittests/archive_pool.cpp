@@ -0,0 +1,206 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/memory_binary.hpp>
+#include <cereal/archives/pool.hpp>
+#include <boost/test/unit_test.hpp>
+#include <thread>
+
+struct PooledMessage
+{
+  std::shared_ptr<int> a, b;
+  std::string text;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(a), CEREAL_NVP(b), CEREAL_NVP(text) ); }
+};
+
+// Without thread_local nothing is kept in the pool
+static const std::size_t pooled = CEREAL_HAS_THREAD_LOCAL ? 1 : 0;
+
+static PooledMessage makePooledMessage( int i )
+{
+  PooledMessage m;
+  m.a = std::make_shared<int>( i );
+  m.b = m.a;
+  m.text = "message " + std::to_string( i );
+  return m;
+}
+
+static void checkPooledMessage( PooledMessage const & m, int i )
+{
+  BOOST_REQUIRE( m.a );
+  BOOST_CHECK_EQUAL( *m.a, i );
+  BOOST_CHECK( m.a == m.b );
+  BOOST_CHECK_EQUAL( m.text, "message " + std::to_string( i ) );
+}
+
+template <class IArchive, class OArchive>
+void test_archive_pool()
+{
+  typedef cereal::ArchivePool<OArchive> OPool;
+  typedef cereal::ArchivePool<IArchive> IPool;
+  OPool::clear();
+  IPool::clear();
+
+  std::vector<std::string> messages;
+  OArchive * first = nullptr;
+  for( int i = 0; i < 4; ++i )
+  {
+    std::ostringstream os;
+    {
+      auto oar = OPool::acquire( os );
+      if( i == 0 )
+        first = oar.get();
+      else if( pooled )
+        BOOST_CHECK_EQUAL( oar.get(), first );
+      (*oar)( makePooledMessage( i ) );
+    }
+    messages.push_back( os.str() );
+  }
+  BOOST_CHECK_EQUAL( OPool::available(), pooled );
+
+  // each message stands on its own, including its shared pointers
+  for( int i = 3; i >= 0; --i )
+  {
+    PooledMessage m;
+    std::istringstream is( messages[i] );
+    {
+      auto iar = IPool::acquire( is );
+      (*iar)( m );
+    }
+    checkPooledMessage( m, i );
+
+    std::istringstream plain( messages[i] );
+    IArchive iar( plain );
+    PooledMessage p;
+    iar( p );
+    checkPooledMessage( p, i );
+  }
+  BOOST_CHECK_EQUAL( IPool::available(), pooled );
+}
+
+BOOST_AUTO_TEST_CASE( binary_archive_pool )
+{
+  test_archive_pool<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_archive_pool )
+{
+  test_archive_pool<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_archive_pool )
+{
+  typedef cereal::ArchivePool<cereal::JSONOutputArchive> Pool;
+  Pool::clear();
+
+  for( int i = 0; i < 3; ++i )
+  {
+    std::string json;
+    {
+      auto oar = Pool::acquire( json );
+      (*oar)( cereal::make_nvp( "message", makePooledMessage( i ) ) );
+    }
+
+    PooledMessage m;
+    std::istringstream is( json );
+    cereal::JSONInputArchive iar( is );
+    iar( cereal::make_nvp( "message", m ) );
+    checkPooledMessage( m, i );
+  }
+  BOOST_CHECK_EQUAL( Pool::available(), pooled );
+}
+
+BOOST_AUTO_TEST_CASE( json_archive_reset )
+{
+  std::ostringstream first, second;
+  cereal::JSONOutputArchive oar( first );
+  oar( cereal::make_nvp( "message", makePooledMessage( 1 ) ) );
+  oar.reset( second );
+  oar( cereal::make_nvp( "message", makePooledMessage( 2 ) ) );
+  oar.finish();
+
+  PooledMessage m1, m2;
+  std::istringstream is1( first.str() ), is2( second.str() );
+  {
+    cereal::JSONInputArchive iar1( is1 ), iar2( is2 );
+    iar1( cereal::make_nvp( "message", m1 ) );
+    iar2( cereal::make_nvp( "message", m2 ) );
+  }
+  checkPooledMessage( m1, 1 );
+  checkPooledMessage( m2, 2 );
+}
+
+BOOST_AUTO_TEST_CASE( memory_binary_archive_pool )
+{
+  typedef cereal::ArchivePool<cereal::MemoryBinaryOutputArchive> OPool;
+  typedef cereal::ArchivePool<cereal::MemoryBinaryInputArchive> IPool;
+
+  for( int i = 0; i < 3; ++i )
+  {
+    std::vector<char> buffer;
+    {
+      auto oar = OPool::acquire( buffer );
+      (*oar)( makePooledMessage( i ) );
+    }
+
+    // the buffer is trimmed to the message when the archive goes back to the pool
+    PooledMessage m;
+    {
+      auto iar = IPool::acquire( buffer.data(), buffer.size() );
+      (*iar)( m );
+      BOOST_CHECK_EQUAL( iar->bytesRead(), buffer.size() );
+    }
+    checkPooledMessage( m, i );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( archive_pool_capacity_and_threads )
+{
+  typedef cereal::ArchivePool<cereal::BinaryOutputArchive> Pool;
+  Pool::clear();
+  Pool::setCapacity( 2 );
+
+  std::ostringstream os;
+  {
+    auto a = Pool::acquire( os );
+    auto b = Pool::acquire( os );
+    auto c = Pool::acquire( os );
+    BOOST_CHECK( a.get() != b.get() && b.get() != c.get() );
+  }
+  BOOST_CHECK_EQUAL( Pool::available(), 2 * pooled );
+
+  std::size_t otherThread = 1;
+  std::thread( [&]{ otherThread = Pool::available(); } ).join();
+  BOOST_CHECK_EQUAL( otherThread, 0 );
+
+  Pool::setCapacity( 8 );
+  Pool::clear();
+  BOOST_CHECK_EQUAL( Pool::available(), 0 );
+}
@@ -0,0 +1,162 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/memory_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct ResetVersioned
+{
+  int x;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const version )
+  {
+    ar( x );
+    BOOST_CHECK_EQUAL( version, 2u );
+  }
+
+  bool operator==( ResetVersioned const & other ) const
+  { return x == other.x; }
+};
+
+CEREAL_CLASS_VERSION( ResetVersioned, 2 )
+
+struct ResetMessage
+{
+  std::shared_ptr<int> a, b;
+  ResetVersioned v;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( a, b, v ); }
+};
+
+ResetMessage make_reset_message( int i )
+{
+  ResetMessage m;
+  m.a = std::make_shared<int>( i );
+  m.b = i % 2 ? m.a : std::make_shared<int>( -i );
+  m.v.x = i * 3;
+  return m;
+}
+
+void check_reset_message( ResetMessage const & m, int i )
+{
+  BOOST_REQUIRE( m.a && m.b );
+  BOOST_CHECK_EQUAL( *m.a, i );
+  BOOST_CHECK_EQUAL( m.a == m.b, i % 2 == 1 );
+  BOOST_CHECK_EQUAL( *m.b, i % 2 ? i : -i );
+  BOOST_CHECK_EQUAL( m.v.x, i * 3 );
+}
+
+template <class IArchive, class OArchive>
+void test_stream_reset()
+{
+  std::vector<std::string> messages;
+
+  std::ostringstream first;
+  OArchive oar( first );
+  for( int i = 0; i < 10; ++i )
+  {
+    std::ostringstream os;
+    if( i == 0 )
+      oar( make_reset_message( i ) );
+    else
+    {
+      oar.reset( os );
+      oar( make_reset_message( i ) );
+    }
+    messages.push_back( i == 0 ? first.str() : os.str() );
+
+    // identical to what a fresh archive produces
+    std::ostringstream fresh;
+    {
+      OArchive foar( fresh );
+      foar( make_reset_message( i ) );
+    }
+    BOOST_CHECK( fresh.str() == messages.back() );
+  }
+
+  std::istringstream firstIn( messages[0] );
+  IArchive iar( firstIn );
+  for( int i = 0; i < 10; ++i )
+  {
+    std::istringstream is( messages[i] );
+    if( i > 0 )
+      iar.reset( is );
+
+    ResetMessage m;
+    iar( m );
+    check_reset_message( m, i );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_archive_reset )
+{
+  test_stream_reset<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_archive_reset )
+{
+  test_stream_reset<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( memory_binary_archive_reset )
+{
+  std::vector<std::vector<char>> messages( 10 );
+
+  cereal::MemoryBinaryOutputArchive oar( messages[0] );
+  for( int i = 0; i < 10; ++i )
+  {
+    if( i > 0 )
+      oar.reset( messages[i] );
+    oar( make_reset_message( i ) );
+  }
+
+  // the last message is only trimmed by a following reset
+  char fixed[256];
+  oar.reset( fixed, sizeof(fixed) );
+  oar( make_reset_message( 10 ) );
+  auto const fixedSize = oar.bytesWritten();
+
+  cereal::MemoryBinaryInputArchive iar( messages[0].data(), messages[0].size() );
+  for( int i = 0; i < 10; ++i )
+  {
+    if( i > 0 )
+      iar.reset( messages[i].data(), messages[i].size() );
+
+    ResetMessage m;
+    iar( m );
+    check_reset_message( m, i );
+    BOOST_CHECK_EQUAL( iar.bytesRemaining(), 0u );
+  }
+
+  iar.reset( fixed, fixedSize );
+  ResetMessage m;
+  iar( m );
+  check_reset_message( m, 10 );
+}
@@ -0,0 +1,185 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#define CEREAL_ARCHIVE_STATISTICS
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct StatisticsBase
+{
+  StatisticsBase() : x(0) {}
+  virtual ~StatisticsBase() {}
+  int x;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+};
+
+struct StatisticsDerived : StatisticsBase
+{
+  StatisticsDerived() : y(0) {}
+  int y;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::base_class<StatisticsBase>( this ), y ); }
+};
+
+CEREAL_REGISTER_TYPE(StatisticsDerived)
+
+struct StatisticsVersioned
+{
+  StatisticsVersioned() : v(0) {}
+  int v;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const )
+  { ar( v ); }
+};
+
+CEREAL_CLASS_VERSION(StatisticsVersioned, 3)
+
+struct StatisticsNested
+{
+  std::vector<StatisticsNested> children;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( children ); }
+};
+
+template <class IArchive, class OArchive>
+void test_archive_statistics( bool binary )
+{
+  auto shared = std::make_shared<int>( 5 );
+  std::vector<std::shared_ptr<int>> o_pointers = { shared, shared, std::make_shared<int>( 6 ) };
+  std::vector<std::shared_ptr<StatisticsBase>> o_shapes = { std::make_shared<StatisticsDerived>(), std::make_shared<StatisticsDerived>() };
+  std::vector<StatisticsVersioned> o_versioned( 4 );
+  StatisticsNested o_nested;
+  o_nested.children.resize( 1 );
+  o_nested.children[0].children.resize( 1 );
+
+  std::ostringstream os;
+  cereal::ArchiveStatistics saved;
+  {
+    OArchive oar(os);
+    oar( o_pointers, o_shapes, o_versioned, o_nested );
+    saved = oar.statistics();
+  }
+
+  // the two pointers to one int share an entry, and the shapes are shared pointers too
+  BOOST_CHECK_EQUAL( saved.sharedPointers, 4 );
+  BOOST_CHECK_EQUAL( saved.polymorphicLookups, 2 );
+  BOOST_CHECK_EQUAL( saved.versionedTypes, 1 );
+  // the nested vectors and objects alone are six levels deep
+  BOOST_CHECK_GE( saved.maxDepth, 6 );
+
+  if( binary )
+  {
+    BOOST_CHECK_GT( saved.binaryCalls, 0 );
+    BOOST_CHECK_LE( saved.bytes, os.str().size() );
+  }
+  else
+  {
+    BOOST_CHECK_EQUAL( saved.binaryCalls, 0 );
+    BOOST_CHECK_EQUAL( saved.bytes, 0 );
+  }
+
+  std::vector<std::shared_ptr<int>> i_pointers;
+  std::vector<std::shared_ptr<StatisticsBase>> i_shapes;
+  std::vector<StatisticsVersioned> i_versioned;
+  StatisticsNested i_nested;
+
+  std::istringstream is(os.str());
+  cereal::ArchiveStatistics loaded;
+  {
+    IArchive iar(is);
+    iar( i_pointers, i_shapes, i_versioned, i_nested );
+    loaded = iar.statistics();
+  }
+
+  BOOST_CHECK_EQUAL( loaded.sharedPointers, saved.sharedPointers );
+  BOOST_CHECK_EQUAL( loaded.polymorphicLookups, saved.polymorphicLookups );
+  BOOST_CHECK_EQUAL( loaded.versionedTypes, saved.versionedTypes );
+  BOOST_CHECK_EQUAL( loaded.maxDepth, saved.maxDepth );
+  BOOST_CHECK_EQUAL( loaded.bytes, saved.bytes );
+  BOOST_CHECK_EQUAL( loaded.binaryCalls, saved.binaryCalls );
+}
+
+BOOST_AUTO_TEST_CASE( binary_archive_statistics )
+{
+  test_archive_statistics<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>( true );
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_archive_statistics )
+{
+  test_archive_statistics<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>( true );
+}
+
+BOOST_AUTO_TEST_CASE( xml_archive_statistics )
+{
+  test_archive_statistics<cereal::XMLInputArchive, cereal::XMLOutputArchive>( false );
+}
+
+BOOST_AUTO_TEST_CASE( json_archive_statistics )
+{
+  test_archive_statistics<cereal::JSONInputArchive, cereal::JSONOutputArchive>( false );
+}
+
+BOOST_AUTO_TEST_CASE( archive_statistics_reset )
+{
+  std::ostringstream os;
+  cereal::BinaryOutputArchive oar(os);
+  oar( std::make_shared<int>( 1 ), std::vector<double>( 10 ) );
+  BOOST_CHECK_EQUAL( oar.statistics().sharedPointers, 1 );
+  BOOST_CHECK_GE( oar.statistics().bytes, 10 * sizeof(double) );
+
+  std::ostringstream os2;
+  oar.reset( os2 );
+  BOOST_CHECK_EQUAL( oar.statistics().bytes, 0 );
+  BOOST_CHECK_EQUAL( oar.statistics().sharedPointers, 0 );
+  BOOST_CHECK_EQUAL( oar.statistics().maxDepth, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( archive_statistics_arithmetic_runs )
+{
+  // runs of arithmetic values are not packed together while statistics are collected
+  std::ostringstream os;
+  cereal::BinaryOutputArchive oar(os);
+  oar( 1, 2.0, std::int16_t( 3 ) );
+  BOOST_CHECK_EQUAL( oar.statistics().binaryCalls, 3 );
+  BOOST_CHECK_EQUAL( oar.statistics().bytes, sizeof(int) + sizeof(double) + sizeof(std::int16_t) );
+
+  int a = 0;
+  double b = 0;
+  std::int16_t c = 0;
+  std::istringstream is( os.str() );
+  cereal::BinaryInputArchive iar(is);
+  iar( a, b, c );
+  BOOST_CHECK_EQUAL( iar.statistics().binaryCalls, 3 );
+  BOOST_CHECK_EQUAL( c, 3 );
+}
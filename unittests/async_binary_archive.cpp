@@ -0,0 +1,133 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/async_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+template <class Archive, class ... Options>
+std::string save_async_test_data( std::mt19937 & gen, Options && ... options )
+{
+  std::vector<int> o_ints( 5000 );
+  for( auto & i : o_ints )
+    i = static_cast<int>( gen() );
+  std::map<std::string, double> o_map;
+  for( int j = 0; j < 100; ++j )
+    o_map.emplace( random_basic_string<char>(gen), static_cast<double>( j ) / 4.0 );
+  StructInternalSerialize o_struct( static_cast<int>( gen() ), static_cast<int>( gen() ) );
+
+  std::ostringstream os;
+  {
+    Archive oar( os, std::forward<Options>( options )... );
+    oar( o_ints, o_map, o_struct );
+  }
+
+  return os.str();
+}
+
+void test_async_binary( cereal::AsyncBinaryOutputArchive::Options const & options )
+{
+  for(int ii=0; ii<10; ++ii)
+  {
+    std::mt19937 gen(ii);
+    auto const expected = save_async_test_data<cereal::BinaryOutputArchive>( gen );
+
+    gen.seed(ii);
+    auto const actual = save_async_test_data<cereal::AsyncBinaryOutputArchive>( gen, options );
+
+    BOOST_CHECK( actual == expected );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( async_binary_archive )
+{
+  test_async_binary( cereal::AsyncBinaryOutputArchive::Options::Default() );
+  test_async_binary( cereal::AsyncBinaryOutputArchive::Options( 1000, 2 ) );
+  test_async_binary( cereal::AsyncBinaryOutputArchive::Options( 7, 4 ) );
+}
+
+BOOST_AUTO_TEST_CASE( async_binary_archive_wait )
+{
+  std::ostringstream os;
+  cereal::AsyncBinaryOutputArchive oar( os, cereal::AsyncBinaryOutputArchive::Options( 64 ) );
+
+  std::uint32_t const value = 0x01020304;
+  oar( value );
+  oar.wait();
+  BOOST_CHECK_EQUAL( os.str().size(), sizeof(value) );
+
+  std::vector<char> o_data( 1000, 'c' );
+  oar( cereal::binary_data( o_data.data(), o_data.size() ) );
+  oar.wait();
+  BOOST_CHECK_EQUAL( os.str().size(), sizeof(value) + o_data.size() );
+}
+
+//! A stream buffer that accepts a limited number of bytes
+struct LimitedStreambuf : public std::streambuf
+{
+  LimitedStreambuf( std::streamsize limit ) : remaining( limit ) {}
+
+  std::streamsize xsputn( const char *, std::streamsize n ) override
+  {
+    auto const written = std::min( n, remaining );
+    remaining -= written;
+    return written;
+  }
+
+  int_type overflow( int_type ) override { return traits_type::eof(); }
+
+  std::streamsize remaining;
+};
+
+BOOST_AUTO_TEST_CASE( async_binary_archive_errors )
+{
+  std::vector<double> o_data( 1000, 1.0 );
+
+  {
+    LimitedStreambuf buf( 100 );
+    std::ostream os( &buf );
+    cereal::AsyncBinaryOutputArchive oar( os, cereal::AsyncBinaryOutputArchive::Options( 256 ) );
+    auto save = [&]()
+    {
+      oar( o_data );
+      oar.wait();
+    };
+    // either the save or the wait reports the error, destruction then does not throw
+    BOOST_CHECK_THROW( save(), cereal::Exception );
+    BOOST_CHECK_THROW( oar.wait(), cereal::Exception );
+  }
+
+  {
+    LimitedStreambuf buf( 100 );
+    std::ostream os( &buf );
+    auto save = [&]()
+    {
+      cereal::AsyncBinaryOutputArchive oar( os, cereal::AsyncBinaryOutputArchive::Options( 256 ) );
+      oar( o_data );
+    };
+    BOOST_CHECK_THROW( save(), cereal::Exception );
+  }
+}
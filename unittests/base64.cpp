@@ -0,0 +1,140 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  // the original byte at a time encoder, kept as a reference
+  std::string reference_encode( std::vector<unsigned char> const & bytes )
+  {
+    std::string ret;
+    size_t i = 0;
+    for( ; i + 3 <= bytes.size(); i += 3 )
+    {
+      ret += base64::chars[bytes[i] >> 2];
+      ret += base64::chars[((bytes[i] & 0x03) << 4) | (bytes[i + 1] >> 4)];
+      ret += base64::chars[((bytes[i + 1] & 0x0f) << 2) | (bytes[i + 2] >> 6)];
+      ret += base64::chars[bytes[i + 2] & 0x3f];
+    }
+
+    if( i + 1 == bytes.size() )
+    {
+      ret += base64::chars[bytes[i] >> 2];
+      ret += base64::chars[(bytes[i] & 0x03) << 4];
+      ret += "==";
+    }
+    else if( i + 2 == bytes.size() )
+    {
+      ret += base64::chars[bytes[i] >> 2];
+      ret += base64::chars[((bytes[i] & 0x03) << 4) | (bytes[i + 1] >> 4)];
+      ret += base64::chars[(bytes[i + 1] & 0x0f) << 2];
+      ret += '=';
+    }
+
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( base64_round_trip )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // every length around the block sizes of the vectorized kernels
+  for( size_t size = 0; size < 100; ++size )
+  {
+    std::vector<unsigned char> bytes( size );
+    for( auto & b : bytes )
+      b = static_cast<unsigned char>( gen() );
+
+    auto const encoded = base64::encode( bytes.data(), bytes.size() );
+    BOOST_CHECK_EQUAL( encoded, reference_encode( bytes ) );
+    BOOST_CHECK_EQUAL( encoded.size(), base64::encoded_size( size ) );
+
+    auto const decoded = base64::decode( encoded );
+    BOOST_CHECK_EQUAL( base64::decoded_size( encoded.data(), encoded.size() ), size );
+    BOOST_CHECK( std::vector<unsigned char>( decoded.begin(), decoded.end() ) == bytes );
+  }
+
+  std::vector<unsigned char> large( 1 << 20 );
+  for( auto & b : large )
+    b = static_cast<unsigned char>( gen() );
+  auto const decoded = base64::decode( base64::encode( large.data(), large.size() ) );
+  BOOST_CHECK( std::vector<unsigned char>( decoded.begin(), decoded.end() ) == large );
+}
+
+BOOST_AUTO_TEST_CASE( base64_decode_stops_at_invalid )
+{
+  // decoding ends at padding or at the first character that is not base64
+  BOOST_CHECK_EQUAL( base64::decode( "TWFu" ), "Man" );
+  BOOST_CHECK_EQUAL( base64::decode( "TWE=" ), "Ma" );
+  BOOST_CHECK_EQUAL( base64::decode( "TQ==" ), "M" );
+  BOOST_CHECK_EQUAL( base64::decode( "TWFu TWFu" ), "Man" );
+  BOOST_CHECK_EQUAL( base64::decode( "TWFuTWFuTWFuTWFuTWFuTWFu!TWFu" ), "ManManManManManMan" );
+  BOOST_CHECK_EQUAL( base64::decode( "" ), "" );
+}
+
+template <class IArchive, class OArchive, class... Options>
+void test_base64_archive( Options... options )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<unsigned char> o_bytes( 1000 );
+  for( auto & b : o_bytes )
+    b = static_cast<unsigned char>( gen() );
+
+  std::ostringstream os;
+  {
+    OArchive oar( os, options... );
+    oar.saveBinaryValue( o_bytes.data(), o_bytes.size(), "bytes" );
+    oar.saveBinaryValue( o_bytes.data(), 0, "empty" );
+  }
+
+  std::vector<unsigned char> i_bytes( o_bytes.size() );
+  std::istringstream is( os.str() );
+  {
+    IArchive iar( is );
+    iar.loadBinaryValue( i_bytes.data(), i_bytes.size(), "bytes" );
+    iar.loadBinaryValue( i_bytes.data(), 0, "empty" );
+    BOOST_CHECK_THROW( iar.loadBinaryValue( i_bytes.data(), i_bytes.size() - 1, "bytes" ), cereal::Exception );
+  }
+
+  BOOST_CHECK( o_bytes == i_bytes );
+}
+
+BOOST_AUTO_TEST_CASE( base64_json_archive )
+{
+  test_base64_archive<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( base64_xml_archive )
+{
+  test_base64_archive<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+  test_base64_archive<cereal::XMLInputArchive, cereal::XMLOutputArchive>( cereal::XMLOutputArchive::Options::Streaming() );
+}
@@ -0,0 +1,495 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+// the same record as written by a newer and an older version of a program
+struct SkippableRecordNew
+{
+  int id;
+  std::string name;
+  std::vector<double> samples; // added by the newer version
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const )
+  {
+    ar( id, name, samples );
+  }
+};
+
+struct SkippableRecordOld
+{
+  SkippableRecordOld() : id( 0 ) {}
+  SkippableRecordOld( int i, std::string const & n ) : id( i ), name( n ) {}
+
+  int id;
+  std::string name;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const )
+  {
+    ar( id, name );
+  }
+};
+
+struct SkippableFiltered
+{
+  SkippableFiltered() : id( 0 ) {}
+  int id;
+  SkippableRecordOld record;
+
+  template <class Archive>
+  void save( Archive & ar, std::uint32_t const ) const
+  {
+    ar( id, record );
+  }
+
+  // only records with even ids are loaded past their header
+  template <class Archive>
+  void load( Archive & ar, std::uint32_t const )
+  {
+    ar( id );
+    if( id % 2 == 0 )
+      ar( record );
+  }
+};
+
+BOOST_AUTO_TEST_CASE( binary_skippable_evolution )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<SkippableRecordNew> o_records( 20 );
+  for( auto & r : o_records )
+  {
+    r.id = random_value<int>(gen);
+    r.name = random_basic_string<char>(gen);
+    r.samples.resize( static_cast<size_t>( random_value<unsigned char>(gen) ) );
+    for( auto & s : r.samples )
+      s = random_value<double>(gen);
+  }
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os, cereal::BinaryOutputArchive::Options::Skippable() );
+    oar( o_records, 42 );
+  }
+
+  std::vector<SkippableRecordOld> i_records;
+  int after;
+  std::istringstream is( os.str() );
+  {
+    cereal::BinaryInputArchive iar( is, cereal::BinaryInputArchive::Options::Skippable() );
+    iar( i_records, after );
+  }
+
+  BOOST_REQUIRE_EQUAL( i_records.size(), o_records.size() );
+  for( size_t i = 0; i < o_records.size(); ++i )
+  {
+    BOOST_CHECK_EQUAL( i_records[i].id, o_records[i].id );
+    BOOST_CHECK_EQUAL( i_records[i].name, o_records[i].name );
+  }
+  BOOST_CHECK_EQUAL( after, 42 );
+
+  // a newer reader can not load more than was written
+  std::vector<SkippableRecordNew> n_records;
+  {
+    std::ostringstream oldOs;
+    {
+      cereal::BinaryOutputArchive oar( oldOs, cereal::BinaryOutputArchive::Options::Skippable() );
+      oar( i_records );
+    }
+
+    std::istringstream oldIs( oldOs.str() );
+    cereal::BinaryInputArchive iar( oldIs, cereal::BinaryInputArchive::Options::Skippable() );
+    BOOST_CHECK_THROW( iar( n_records ), cereal::Exception );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_skippable_filter )
+{
+  std::vector<SkippableFiltered> o_filtered( 10 );
+  for( int i = 0; i < 10; ++i )
+  {
+    o_filtered[i].id = i;
+    o_filtered[i].record.id = i * 10;
+    o_filtered[i].record.name = std::to_string( i );
+  }
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os, cereal::BinaryOutputArchive::Options::Skippable() );
+    oar( o_filtered );
+  }
+
+  std::vector<SkippableFiltered> i_filtered;
+  std::istringstream is( os.str() );
+  {
+    cereal::BinaryInputArchive iar( is, cereal::BinaryInputArchive::Options::Skippable() );
+    iar( i_filtered );
+  }
+
+  BOOST_REQUIRE_EQUAL( i_filtered.size(), o_filtered.size() );
+  for( int i = 0; i < 10; ++i )
+  {
+    BOOST_CHECK_EQUAL( i_filtered[i].id, i );
+    BOOST_CHECK_EQUAL( i_filtered[i].record.id, i % 2 == 0 ? i * 10 : 0 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_default_not_prefixed )
+{
+  SkippableRecordOld const record( 1, "name" );
+
+  std::ostringstream plain, skippable;
+  {
+    cereal::BinaryOutputArchive oar( plain );
+    oar( record );
+  }
+  {
+    cereal::BinaryOutputArchive oar( skippable, cereal::BinaryOutputArchive::Options::Skippable() );
+    oar( record );
+  }
+
+  BOOST_CHECK_EQUAL( skippable.str().size(), plain.str().size() + sizeof(std::uint64_t) );
+}
+
+BOOST_AUTO_TEST_CASE( binary_sticky_errors )
+{
+  SkippableRecordNew record;
+  record.id = 7;
+  record.name = "name";
+  record.samples = {1.0, 2.0, 3.0};
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar( record, 42 );
+  }
+
+  // cut the stream in the middle of the samples
+  auto const truncated = os.str().substr( 0, os.str().size() - 16 );
+
+  {
+    std::istringstream is( truncated );
+    cereal::BinaryInputArchive iar( is );
+    SkippableRecordNew loaded;
+    BOOST_CHECK_THROW( iar( loaded ), cereal::Exception );
+  }
+
+  {
+    std::istringstream is( truncated );
+    cereal::BinaryInputArchive iar( is, cereal::BinaryInputArchive::Options::StickyErrors() );
+    BOOST_CHECK( iar.error() == cereal::BinaryError::none );
+
+    SkippableRecordNew loaded;
+    int after = -1;
+    iar( loaded, after );
+    BOOST_CHECK( iar.error() == cereal::BinaryError::read_failed );
+    BOOST_CHECK_EQUAL( loaded.id, 7 );
+    BOOST_CHECK_EQUAL( loaded.name, "name" );
+    BOOST_CHECK_EQUAL( after, 0 );
+
+    // the error stays until the archive is reset
+    std::istringstream complete( os.str() );
+    iar.reset( complete );
+    BOOST_CHECK( iar.error() == cereal::BinaryError::none );
+    iar( loaded, after );
+    BOOST_CHECK( iar.error() == cereal::BinaryError::none );
+    BOOST_CHECK_EQUAL( loaded.samples.size(), 3 );
+    BOOST_CHECK_EQUAL( after, 42 );
+  }
+
+  // a body length that exceeds its enclosing body is recorded too
+  {
+    SkippableFiltered filtered;
+    filtered.id = 2;
+    filtered.record = SkippableRecordOld( 3, "inner" );
+
+    std::ostringstream skippable;
+    {
+      cereal::BinaryOutputArchive oar( skippable, cereal::BinaryOutputArchive::Options::Skippable() );
+      oar( filtered );
+    }
+
+    // the length of the inner record follows the outer length, its version and the id
+    auto data = skippable.str();
+    std::uint64_t const bad = 1000;
+    std::memcpy( &data[sizeof(std::uint64_t) + sizeof(std::uint32_t) + sizeof(int)], &bad, sizeof(bad) );
+
+    std::istringstream is( data );
+    cereal::BinaryInputArchive iar( is, cereal::BinaryInputArchive::Options( true, true ) );
+    SkippableFiltered loaded;
+    iar( loaded );
+    BOOST_CHECK( iar.error() == cereal::BinaryError::invalid_body_length );
+  }
+
+  {
+    std::filebuf closed;
+    std::ostream bad( &closed );
+    cereal::BinaryOutputArchive oar( bad, cereal::BinaryOutputArchive::Options::StickyErrors() );
+    oar( record );
+    BOOST_CHECK( oar.error() == cereal::BinaryError::write_failed );
+
+    cereal::BinaryOutputArchive throwing( bad );
+    BOOST_CHECK_THROW( throwing( record ), cereal::Exception );
+  }
+}
+
+// counts the writes and reads that reach the stream
+class CountingBuffer : public std::stringbuf
+{
+  public:
+    CountingBuffer() : writes( 0 ), reads( 0 ) {}
+    CountingBuffer( std::string const & data ) : std::stringbuf( data ), writes( 0 ), reads( 0 ) {}
+
+    std::size_t writes;
+    std::size_t reads;
+
+  protected:
+    std::streamsize xsputn( char const * s, std::streamsize n ) override
+    {
+      ++writes;
+      return std::stringbuf::xsputn( s, n );
+    }
+
+    std::streamsize xsgetn( char * s, std::streamsize n ) override
+    {
+      ++reads;
+      return std::stringbuf::xsgetn( s, n );
+    }
+};
+
+BOOST_AUTO_TEST_CASE( binary_coalesced_arithmetic )
+{
+  std::mt19937 gen(std::random_device{}());
+
+  int const i = random_value<int>(gen);
+  double const d = random_value<double>(gen);
+  char const c = random_value<char>(gen);
+  std::uint64_t const u = random_value<std::uint64_t>(gen);
+  std::string const s = random_basic_string<char>(gen);
+  float const f = random_value<float>(gen);
+  bool const b = true;
+
+  // the layout is the same as saving each value on its own
+  CountingBuffer coalesced;
+  {
+    std::ostream os( &coalesced );
+    cereal::BinaryOutputArchive oar( os );
+    oar( i, d, c, u );
+  }
+  BOOST_CHECK_EQUAL( coalesced.writes, 1 );
+
+  std::ostringstream separate;
+  {
+    cereal::BinaryOutputArchive oar( separate );
+    oar( i );
+    oar( d );
+    oar( c );
+    oar( u );
+  }
+  BOOST_CHECK( coalesced.str() == separate.str() );
+
+  // runs are broken by anything that is not arithmetic
+  CountingBuffer mixed;
+  {
+    std::ostream os( &mixed );
+    cereal::BinaryOutputArchive oar( os );
+    oar( i, d, s, f, b, c, cereal::make_nvp("u", u) );
+  }
+  // the run before the string, the string's size and data, the run after it, then u
+  BOOST_CHECK_EQUAL( mixed.writes, 5 );
+
+  {
+    CountingBuffer buffer( mixed.str() );
+    std::istream is( &buffer );
+    cereal::BinaryInputArchive iar( is );
+
+    int i_i; double i_d; std::string i_s; float i_f; bool i_b; char i_c; std::uint64_t i_u;
+    iar( i_i, i_d, i_s, i_f, i_b, i_c, cereal::make_nvp("u", i_u) );
+    BOOST_CHECK_EQUAL( buffer.reads, 5 );
+
+    BOOST_CHECK_EQUAL( i_i, i );
+    BOOST_CHECK_EQUAL( i_d, d );
+    BOOST_CHECK_EQUAL( i_s, s );
+    BOOST_CHECK_EQUAL( i_f, f );
+    BOOST_CHECK_EQUAL( i_b, b );
+    BOOST_CHECK_EQUAL( i_c, c );
+    BOOST_CHECK_EQUAL( i_u, u );
+  }
+
+  // a run that cannot be read in full is zeroed with sticky errors
+  {
+    std::istringstream is( coalesced.str().substr( 0, sizeof(int) + sizeof(double) ) );
+    cereal::BinaryInputArchive iar( is, cereal::BinaryInputArchive::Options::StickyErrors() );
+
+    int i_i = -1; double i_d = -1; char i_c = -1; std::uint64_t i_u = 1;
+    iar( i_i, i_d, i_c, i_u );
+    BOOST_CHECK( iar.error() == cereal::BinaryError::read_failed );
+    BOOST_CHECK_EQUAL( i_i, 0 );
+    BOOST_CHECK_EQUAL( i_d, 0 );
+    BOOST_CHECK_EQUAL( i_c, 0 );
+    BOOST_CHECK_EQUAL( i_u, 0 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_checksummed )
+{
+  std::mt19937 gen(std::random_device{}());
+
+  std::vector<SkippableRecordNew> o_records( 50 );
+  for( auto & r : o_records )
+  {
+    r.id = random_value<int>(gen);
+    r.name = random_basic_string<char>(gen);
+    r.samples.resize( static_cast<size_t>( random_value<unsigned char>(gen) ) );
+    for( auto & s : r.samples )
+      s = random_value<double>(gen);
+  }
+
+  // small blocks, so that values straddle block boundaries
+  std::size_t const blockSize = 100;
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os, cereal::BinaryOutputArchive::Options::Checksummed( blockSize ) );
+    oar( o_records, 42 );
+  }
+
+  auto const load = [&]( std::string const & data, cereal::BinaryInputArchive::Options const & options,
+                         std::vector<SkippableRecordNew> & records, int & after )
+  {
+    std::istringstream is( data );
+    cereal::BinaryInputArchive iar( is, options );
+    iar( records, after );
+    return iar.error();
+  };
+
+  {
+    std::vector<SkippableRecordNew> i_records;
+    int after = 0;
+    load( os.str(), cereal::BinaryInputArchive::Options::Checksummed( blockSize ), i_records, after );
+
+    BOOST_REQUIRE_EQUAL( i_records.size(), o_records.size() );
+    for( size_t i = 0; i < o_records.size(); ++i )
+    {
+      BOOST_CHECK_EQUAL( i_records[i].id, o_records[i].id );
+      BOOST_CHECK_EQUAL( i_records[i].name, o_records[i].name );
+      BOOST_CHECK( i_records[i].samples == o_records[i].samples );
+    }
+    BOOST_CHECK_EQUAL( after, 42 );
+  }
+
+  // a flipped bit anywhere in the data is caught before it is loaded
+  {
+    auto corrupt = os.str();
+    corrupt[corrupt.size() / 2] ^= 0x10;
+
+    std::vector<SkippableRecordNew> i_records;
+    int after = 0;
+    BOOST_CHECK_THROW( load( corrupt, cereal::BinaryInputArchive::Options::Checksummed( blockSize ), i_records, after ),
+                       cereal::Exception );
+
+    after = -1;
+    auto const error = load( corrupt, cereal::BinaryInputArchive::Options( false, true, blockSize ), i_records, after );
+    BOOST_CHECK( error == cereal::BinaryError::checksum_mismatch );
+    BOOST_CHECK_EQUAL( after, 0 );
+  }
+
+  // a block larger than the reader allows is rejected as corrupt
+  {
+    std::vector<SkippableRecordNew> i_records;
+    int after = 0;
+    auto const error = load( os.str(), cereal::BinaryInputArchive::Options( false, true, blockSize / 2 ), i_records, after );
+    BOOST_CHECK( error == cereal::BinaryError::checksum_mismatch );
+  }
+
+  // a truncated stream is reported as a failed read
+  {
+    std::vector<SkippableRecordNew> i_records;
+    int after = 0;
+    auto const error = load( os.str().substr( 0, os.str().size() - 3 ),
+                             cereal::BinaryInputArchive::Options( false, true, blockSize ), i_records, after );
+    BOOST_CHECK( error == cereal::BinaryError::read_failed );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_checksummed_skippable )
+{
+  std::vector<SkippableFiltered> o_filtered( 30 );
+  for( int i = 0; i < 30; ++i )
+  {
+    o_filtered[i].id = i;
+    o_filtered[i].record.id = i * 10;
+    o_filtered[i].record.name = std::string( static_cast<size_t>( i ), 'x' );
+  }
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os, cereal::BinaryOutputArchive::Options( true, false, 64 ) );
+    oar( o_filtered );
+  }
+
+  std::vector<SkippableFiltered> i_filtered;
+  std::istringstream is( os.str() );
+  {
+    cereal::BinaryInputArchive iar( is, cereal::BinaryInputArchive::Options( true, false, 64 ) );
+    iar( i_filtered );
+  }
+
+  BOOST_REQUIRE_EQUAL( i_filtered.size(), o_filtered.size() );
+  for( int i = 0; i < 30; ++i )
+  {
+    BOOST_CHECK_EQUAL( i_filtered[i].id, i );
+    BOOST_CHECK_EQUAL( i_filtered[i].record.id, i % 2 == 0 ? i * 10 : 0 );
+  }
+}
+
+//! A stream buffer whose writes always fail
+struct FailingBuffer : public std::streambuf {};
+
+BOOST_AUTO_TEST_CASE( binary_checksummed_flush_errors )
+{
+  FailingBuffer buffer;
+  std::ostream os( &buffer );
+
+  // an explicit flush reports the error, and the block is not tried again
+  {
+    cereal::BinaryOutputArchive oar( os, cereal::BinaryOutputArchive::Options::Checksummed( 1024 ) );
+    oar( std::uint32_t( 1 ) );
+    BOOST_CHECK_THROW( oar.flush(), cereal::Exception );
+    BOOST_CHECK_NO_THROW( oar.flush() );
+  }
+
+  // the destructor swallows the error instead of terminating
+  BOOST_CHECK_NO_THROW( [&]()
+  {
+    cereal::BinaryOutputArchive oar( os, cereal::BinaryOutputArchive::Options::Checksummed( 1024 ) );
+    oar( std::uint32_t( 1 ) );
+  }() );
+}
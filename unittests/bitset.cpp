@@ -92,3 +92,53 @@ BOOST_AUTO_TEST_CASE( json_bitset )
 }
 
 
+
+BOOST_AUTO_TEST_CASE( binary_bitset_packed )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::bitset<4096> o_bits( random_binary_string<4096>( gen ) );
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar(o_bits);
+  }
+
+  // type tag followed by the packed bits
+  BOOST_CHECK_EQUAL( os.str().size(), sizeof(cereal::bitset_detail::type) + 4096 / 8 );
+
+  std::bitset<4096> i_bits;
+  std::istringstream is(os.str());
+  {
+    cereal::BinaryInputArchive iar(is);
+    iar(i_bits);
+  }
+
+  BOOST_CHECK_EQUAL( o_bits, i_bits );
+}
+
+BOOST_AUTO_TEST_CASE( binary_bitset_string_compatibility )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // data written using the string representation can still be loaded
+  std::string const o_string = random_binary_string<256>( gen );
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( cereal::bitset_detail::type::string, o_string );
+  }
+
+  std::bitset<256> i_bits;
+  std::istringstream is(os.str());
+  {
+    cereal::BinaryInputArchive iar(is);
+    iar(i_bits);
+  }
+
+  BOOST_CHECK_EQUAL( std::bitset<256>( o_string ), i_bits );
+}
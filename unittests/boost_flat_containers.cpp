@@ -0,0 +1,147 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/types/boost_flat_map.hpp>
+#include <cereal/types/boost_flat_set.hpp>
+#include <boost/test/unit_test.hpp>
+
+template <class IArchive, class OArchive>
+void test_boost_flat_containers()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    boost::container::flat_map<int, int> o_podmap;
+    boost::container::flat_map<std::string, StructInternalSerialize> o_isermap;
+    boost::container::flat_multimap<int16_t, double> o_podmultimap;
+    boost::container::flat_set<uint32_t> o_podset;
+    boost::container::flat_multiset<std::string> o_strmultiset;
+    for(int j=0; j<100; ++j)
+    {
+      o_podmap.emplace(random_value<int>(gen), random_value<int>(gen));
+      o_isermap.emplace(random_value<std::string>(gen), StructInternalSerialize{ random_value<int>(gen), random_value<int>(gen) });
+      auto key = random_value<int16_t>(gen);
+      o_podmultimap.emplace(key, random_value<double>(gen));
+      o_podmultimap.emplace(key, random_value<double>(gen));
+      o_podset.insert(random_value<uint32_t>(gen));
+      auto str = random_value<std::string>(gen);
+      o_strmultiset.insert(str);
+      o_strmultiset.insert(str);
+    }
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+
+      oar(o_podmap);
+      oar(o_isermap);
+      oar(o_podmultimap);
+      oar(o_podset);
+      oar(o_strmultiset);
+    }
+
+    boost::container::flat_map<int, int> i_podmap = {{1, 2}};
+    boost::container::flat_map<std::string, StructInternalSerialize> i_isermap;
+    boost::container::flat_multimap<int16_t, double> i_podmultimap;
+    boost::container::flat_set<uint32_t> i_podset = {7};
+    boost::container::flat_multiset<std::string> i_strmultiset;
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+
+      iar(i_podmap);
+      iar(i_isermap);
+      iar(i_podmultimap);
+      iar(i_podset);
+      iar(i_strmultiset);
+    }
+
+    BOOST_CHECK(i_podmap == o_podmap);
+    BOOST_CHECK(i_isermap == o_isermap);
+    BOOST_CHECK_EQUAL(i_podmultimap.size(), o_podmultimap.size());
+    for(auto & pair : o_podmultimap)
+      BOOST_CHECK_EQUAL(i_podmultimap.count(pair.first), o_podmultimap.count(pair.first));
+    BOOST_CHECK(i_podset == o_podset);
+    BOOST_CHECK(i_strmultiset == o_strmultiset);
+  }
+}
+
+template <class IArchive, class OArchive>
+void test_boost_flat_unordered()
+{
+  // Maps with a reversed order have the same serialized form but are out of order
+  std::map<std::string, int, std::greater<std::string>> o_map = {{"a", 1}, {"b", 2}, {"c", 3}};
+  std::set<int, std::greater<int>> o_set = {1, 2, 3};
+  std::set<std::string> o_dupset = {"a", "b"};
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+
+    oar(o_map);
+    oar(o_set);
+    oar(cereal::make_size_tag(static_cast<cereal::size_type>(2)), std::string("a"), std::string("a"));
+  }
+
+  boost::container::flat_map<std::string, int> i_map;
+  boost::container::flat_set<int> i_set;
+  boost::container::flat_set<std::string> i_dupset;
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+
+    BOOST_CHECK_THROW(iar(i_map), cereal::Exception);
+    BOOST_CHECK_THROW(iar(i_set), cereal::Exception);
+    BOOST_CHECK_THROW(iar(i_dupset), cereal::Exception);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_boost_flat_containers )
+{
+  test_boost_flat_containers<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+  test_boost_flat_unordered<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_boost_flat_containers )
+{
+  test_boost_flat_containers<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+  test_boost_flat_unordered<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_boost_flat_containers )
+{
+  test_boost_flat_containers<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_boost_flat_containers )
+{
+  test_boost_flat_containers<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
@@ -0,0 +1,99 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/types/boost_variant.hpp>
+#include <boost/test/unit_test.hpp>
+
+template <class IArchive, class OArchive>
+void test_boost_variant()
+{
+  typedef boost::variant<int, double, std::string, StructInternalSerialize, std::vector<int>,
+                         char, std::int16_t, std::uint32_t, std::int64_t, float,
+                         std::uint8_t, std::uint16_t, std::int8_t, std::uint64_t, bool,
+                         std::pair<int, int>, std::map<int, std::string>> Event;
+
+  std::vector<Event> o_events = { 1, 2.5, std::string("hello"), StructInternalSerialize( 3, 4 ),
+                                  std::vector<int>{ 5, 6, 7 }, 'c', std::int16_t( -8 ), std::uint32_t( 9 ),
+                                  std::int64_t( -10 ), 11.5f, std::uint8_t( 12 ), std::uint16_t( 13 ),
+                                  std::int8_t( -14 ), std::uint64_t( 15 ), true, std::make_pair( 16, 17 ),
+                                  std::map<int, std::string>{ { 18, "nineteen" } } };
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_events );
+  }
+
+  std::vector<Event> i_events;
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( i_events );
+  }
+
+  BOOST_REQUIRE_EQUAL( i_events.size(), o_events.size() );
+  for( std::size_t i = 0; i < o_events.size(); ++i )
+  {
+    BOOST_CHECK_EQUAL( i_events[i].which(), o_events[i].which() );
+    BOOST_CHECK( i_events[i] == o_events[i] );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_boost_variant )
+{
+  test_boost_variant<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_boost_variant )
+{
+  test_boost_variant<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_boost_variant )
+{
+  test_boost_variant<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_boost_variant )
+{
+  test_boost_variant<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_boost_variant_invalid_which )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( std::int32_t( -1 ), std::int32_t( 2 ) );
+  }
+
+  boost::variant<int, double> variant;
+  std::istringstream is(os.str());
+  cereal::BinaryInputArchive iar(is);
+  BOOST_CHECK_THROW( iar( variant ), cereal::Exception );
+  BOOST_CHECK_THROW( iar( variant ), cereal::Exception );
+}
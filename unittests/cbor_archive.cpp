@@ -0,0 +1,270 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/cbor.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  // A string from a literal that may contain nulls
+  template <std::size_t N>
+  std::string cbor_bytes( const char (&data)[N] )
+  {
+    return std::string( data, N - 1 );
+  }
+
+  template <class T>
+  std::string cbor_typed_array( std::vector<T> const & values )
+  {
+    std::string result( 1, '\xD8' );
+    result += static_cast<char>( cereal::cbor_detail::typed_array_tag<T>() );
+    result += static_cast<char>( 0x40 + values.size() * sizeof(T) );
+    result.append( reinterpret_cast<const char *>( values.data() ), values.size() * sizeof(T) );
+    return result;
+  }
+
+  template <class T, class ... Types>
+  T load_cbor( std::string const & data, Types && ... names )
+  {
+    std::istringstream is( data );
+    cereal::CBORInputArchive iar( is );
+    T value;
+    iar( cereal::make_nvp( std::forward<Types>( names )..., value ) );
+    return value;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( cbor_output_layout )
+{
+  std::vector<int> const o_vector = { 1, 2, 3 };
+  StructInternalSerialize const o_struct( 4, 5 );
+  std::map<std::string, double> const o_map = { { "a", 0.5 } };
+
+  std::ostringstream os;
+  {
+    cereal::CBOROutputArchive oar( os );
+    oar( cereal::make_nvp("vector", o_vector), cereal::make_nvp("struct", o_struct), cereal::make_nvp("map", o_map),
+         cereal::make_nvp("empty", std::vector<int>()), -500, std::uint64_t( 1000000 ) );
+  }
+
+  std::string const expected = std::string( "\xBF" ) +
+    "\x66vector" + cbor_typed_array( o_vector ) +
+    "\x66struct" + "\xBF\x66value0\x04\x66value1\x05\xFF" +
+    "\x63map" + "\x9F\xBF\x63key\x61" "a" "\x65value\xFB\x3F\xE0" + std::string( 6, '\0' ) + "\xFF\xFF" +
+    "\x65" "empty" + cbor_typed_array( std::vector<int>() ) +
+    "\x66value0\x39\x01\xF3" +
+    "\x66value1" + cbor_bytes( "\x1A\x00\x0F\x42\x40" ) + "\xFF";
+  BOOST_CHECK( os.str() == expected );
+
+  std::vector<int> i_vector;
+  StructInternalSerialize i_struct;
+  std::map<std::string, double> i_map;
+  int i_negative;
+  std::uint64_t i_large;
+
+  std::istringstream is( os.str() );
+  {
+    cereal::CBORInputArchive iar( is );
+    iar( cereal::make_nvp("vector", i_vector), cereal::make_nvp("struct", i_struct), cereal::make_nvp("map", i_map) );
+    iar( cereal::make_nvp("value0", i_negative), i_large );
+  }
+
+  BOOST_CHECK_EQUAL_COLLECTIONS( o_vector.begin(), o_vector.end(), i_vector.begin(), i_vector.end() );
+  BOOST_CHECK_EQUAL( o_struct, i_struct );
+  BOOST_CHECK( o_map == i_map );
+  BOOST_CHECK_EQUAL( i_negative, -500 );
+  BOOST_CHECK_EQUAL( i_large, 1000000u );
+}
+
+BOOST_AUTO_TEST_CASE( cbor_round_trip )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( int ii = 0; ii < 100; ++ii )
+  {
+    std::vector<std::string> o_strings( random_value<std::uint8_t>(gen) % 16 );
+    for( auto & s : o_strings )
+      s = random_basic_string<char>(gen);
+
+    std::map<std::int64_t, std::uint32_t> o_map;
+    for( int j = 0; j < 20; ++j )
+      o_map.emplace( random_value<std::int64_t>(gen), random_value<std::uint32_t>(gen) );
+
+    std::vector<double> o_doubles( random_value<std::uint8_t>(gen) );
+    for( auto & d : o_doubles )
+      d = random_value<double>(gen);
+
+    std::vector<std::vector<std::int16_t>> o_nested( 3 );
+    for( auto & v : o_nested )
+      for( int j = 0; j < 10; ++j )
+        v.push_back( random_value<std::int16_t>(gen) );
+
+    std::array<std::uint32_t, 4> o_array;
+    for( auto & a : o_array )
+      a = random_value<std::uint32_t>(gen);
+
+    std::u16string const o_wide = u"wide é";
+    std::bitset<20> const o_bits( random_value<std::uint32_t>(gen) );
+    std::shared_ptr<StructExternalSerialize> const o_shared = std::make_shared<StructExternalSerialize>( random_value<int>(gen), random_value<int>(gen) );
+    float const o_float = random_value<float>(gen);
+    bool const o_bool = ii % 2 == 0;
+    std::int64_t const o_min = std::numeric_limits<std::int64_t>::min();
+    std::uint64_t const o_max = std::numeric_limits<std::uint64_t>::max();
+
+    std::ostringstream os;
+    {
+      cereal::CBOROutputArchive oar( os );
+      oar( o_strings, o_map, o_doubles, o_nested, o_array, o_wide, o_bits, o_shared, o_shared, o_float, o_bool, o_min, o_max );
+    }
+
+    std::vector<std::string> i_strings;
+    std::map<std::int64_t, std::uint32_t> i_map;
+    std::vector<double> i_doubles;
+    std::vector<std::vector<std::int16_t>> i_nested;
+    std::array<std::uint32_t, 4> i_array;
+    std::u16string i_wide;
+    std::bitset<20> i_bits;
+    std::shared_ptr<StructExternalSerialize> i_shared, i_shared2;
+    float i_float;
+    bool i_bool;
+    std::int64_t i_min;
+    std::uint64_t i_max;
+
+    std::istringstream is( os.str() );
+    {
+      cereal::CBORInputArchive iar( is );
+      iar( i_strings, i_map, i_doubles, i_nested, i_array, i_wide, i_bits, i_shared, i_shared2, i_float, i_bool, i_min, i_max );
+    }
+
+    BOOST_CHECK( i_strings == o_strings );
+    BOOST_CHECK( i_map == o_map );
+    BOOST_CHECK( i_doubles == o_doubles );
+    BOOST_CHECK( i_nested == o_nested );
+    BOOST_CHECK( i_array == o_array );
+    BOOST_CHECK( i_wide == o_wide );
+    BOOST_CHECK( i_bits == o_bits );
+    BOOST_CHECK_EQUAL( *i_shared, *o_shared );
+    BOOST_CHECK_EQUAL( i_shared, i_shared2 );
+    BOOST_CHECK_EQUAL( i_float, o_float );
+    BOOST_CHECK_EQUAL( i_bool, o_bool );
+    BOOST_CHECK_EQUAL( i_min, o_min );
+    BOOST_CHECK_EQUAL( i_max, o_max );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( cbor_out_of_order )
+{
+  std::ostringstream os;
+  {
+    cereal::CBOROutputArchive oar( os );
+    oar( cereal::make_nvp("a", 1), cereal::make_nvp("b", std::string("two")), cereal::make_nvp("c", 3.0) );
+  }
+
+  int a;
+  std::string b;
+  double c;
+
+  std::istringstream is( os.str() );
+  {
+    cereal::CBORInputArchive iar( is );
+    iar( cereal::make_nvp("c", c), cereal::make_nvp("a", a), b );
+    BOOST_CHECK_THROW( iar( cereal::make_nvp("d", a) ), cereal::Exception );
+  }
+
+  BOOST_CHECK_EQUAL( a, 1 );
+  BOOST_CHECK_EQUAL( b, "two" );
+  BOOST_CHECK_EQUAL( c, 3.0 );
+}
+
+BOOST_AUTO_TEST_CASE( cbor_foreign_input )
+{
+  // As another encoder might write it: definite lengths, arrays of numbers,
+  // half precision floats, and strings in chunks
+  std::string const data = cbor_bytes(
+    "\xA4"
+    "\x66values" "\x84\x01\x20\x19\x03\xE8\x22"
+    "\x65ratio" "\xF9\x3E\x00"
+    "\x64name" "\x7F\x62" "ab" "\x61" "c" "\xFF"
+    "\x64list" "\x82\x62" "xy" "\x60" );
+
+  std::vector<int> values;
+  double ratio;
+  std::string name;
+  std::vector<std::string> list;
+
+  std::istringstream is( data + "trailing" );
+  {
+    cereal::CBORInputArchive iar( is );
+    iar( cereal::make_nvp("name", name), cereal::make_nvp("ratio", ratio), cereal::make_nvp("values", values),
+         cereal::make_nvp("list", list) );
+  }
+
+  std::vector<int> const expected = { 1, -1, 1000, -3 };
+  BOOST_CHECK_EQUAL_COLLECTIONS( values.begin(), values.end(), expected.begin(), expected.end() );
+  BOOST_CHECK_EQUAL( ratio, 1.5 );
+  BOOST_CHECK_EQUAL( name, "abc" );
+  BOOST_REQUIRE_EQUAL( list.size(), 2u );
+  BOOST_CHECK_EQUAL( list[0], "xy" );
+  BOOST_CHECK_EQUAL( list[1], "" );
+
+  // The archive reads exactly one map
+  std::string rest;
+  is >> rest;
+  BOOST_CHECK_EQUAL( rest, "trailing" );
+}
+
+BOOST_AUTO_TEST_CASE( cbor_malformed )
+{
+  auto parse = []( std::string const & data )
+  {
+    std::istringstream is( data );
+    cereal::CBORInputArchive iar( is );
+  };
+
+  BOOST_CHECK_NO_THROW( parse( "\xA0" ) );
+  BOOST_CHECK_THROW( parse( "" ), cereal::Exception );
+  BOOST_CHECK_THROW( parse( "\x01" ), cereal::Exception );               // not a map
+  BOOST_CHECK_THROW( parse( "\xBF\x61" "a" ), cereal::Exception );        // truncated
+  BOOST_CHECK_THROW( parse( "\xA1\x61" "a\x5B\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" ), cereal::Exception ); // huge length
+  BOOST_CHECK_THROW( parse( "\xA1\x01\x02" ), cereal::Exception );       // key that is not a string
+  BOOST_CHECK_THROW( parse( "\xA1\x61" "a\xFF" ), cereal::Exception );    // break in a definite map
+  BOOST_CHECK_THROW( parse( "\xBF\x61" "a\xFF" ), cereal::Exception );    // break in place of a value
+  BOOST_CHECK_THROW( parse( "\xA1\x61" "a\x1C" ), cereal::Exception );    // reserved additional information
+
+  BOOST_CHECK_THROW( load_cbor<std::uint8_t>( "\xA1\x61" "a\x19\x01\x2C", "a" ), cereal::Exception ); // 300
+  BOOST_CHECK_THROW( load_cbor<unsigned>( "\xA1\x61" "a\x20", "a" ), cereal::Exception );           // -1
+  BOOST_CHECK_THROW( load_cbor<int>( "\xA1\x61" "a\x61" "b", "a" ), cereal::Exception );            // a string
+  BOOST_CHECK_THROW( load_cbor<std::string>( "\xA1\x61" "a\x01", "a" ), cereal::Exception );
+  BOOST_CHECK_EQUAL( load_cbor<std::int8_t>( "\xA1\x61" "a\x38\x7F", "a" ), -128 );
+  BOOST_CHECK_THROW( load_cbor<std::int8_t>( "\xA1\x61" "a\x38\x80", "a" ), cereal::Exception );    // -129
+
+  // A typed array of the wrong element type
+  std::vector<float> const floats = { 1.0f, 2.0f };
+  BOOST_CHECK_THROW( load_cbor<std::vector<int>>( "\xA1\x61" "a" + cbor_typed_array( floats ), "a" ), cereal::Exception );
+  BOOST_CHECK( load_cbor<std::vector<float>>( "\xA1\x61" "a" + cbor_typed_array( floats ), "a" ) == floats );
+}
@@ -0,0 +1,151 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/details/charconv.hpp>
+#include <boost/test/unit_test.hpp>
+
+template <class T>
+void test_charconv_integer()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<T> values = { std::numeric_limits<T>::min(), T(0), T(1), std::numeric_limits<T>::max() };
+  for( int i = 0; i < 100; ++i )
+    values.push_back( random_value<T>(gen) );
+
+  for( auto value : values )
+  {
+    char buffer[cereal::charconv_detail::bufferSize];
+    auto const size = cereal::charconv_detail::toChars( buffer, value );
+
+    std::ostringstream os;
+    os << +value;
+    BOOST_CHECK_EQUAL( std::string( buffer, size ), os.str() );
+    BOOST_CHECK_EQUAL( size, std::strlen( buffer ) );
+    BOOST_CHECK( cereal::charconv_detail::fromChars<T>( buffer ) == value );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( charconv_integers )
+{
+  test_charconv_integer<int8_t>();
+  test_charconv_integer<uint8_t>();
+  test_charconv_integer<int16_t>();
+  test_charconv_integer<uint16_t>();
+  test_charconv_integer<int32_t>();
+  test_charconv_integer<uint32_t>();
+  test_charconv_integer<int64_t>();
+  test_charconv_integer<uint64_t>();
+}
+
+template <class T>
+void test_charconv_floating()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<T> values = { T(0), T(0.1), T(-1.5), std::numeric_limits<T>::min(), std::numeric_limits<T>::max(),
+                            std::numeric_limits<T>::lowest(), std::numeric_limits<T>::denorm_min(),
+                            std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity() };
+  for( int i = 0; i < 100; ++i )
+    values.push_back( random_value<T>(gen) );
+
+  for( auto value : values )
+  {
+    char buffer[cereal::charconv_detail::bufferSize];
+    cereal::charconv_detail::toChars( buffer, value );
+    BOOST_CHECK( cereal::charconv_detail::fromChars<T>( buffer ) == value );
+  }
+
+  char buffer[cereal::charconv_detail::bufferSize];
+  cereal::charconv_detail::toChars( buffer, std::numeric_limits<T>::quiet_NaN() );
+  BOOST_CHECK( std::isnan( cereal::charconv_detail::fromChars<T>( buffer ) ) );
+}
+
+BOOST_AUTO_TEST_CASE( charconv_floating )
+{
+  test_charconv_floating<float>();
+  test_charconv_floating<double>();
+  test_charconv_floating<long double>();
+}
+
+BOOST_AUTO_TEST_CASE( charconv_errors )
+{
+  using cereal::charconv_detail::fromChars;
+
+  BOOST_CHECK_THROW( fromChars<int>( "" ), std::invalid_argument );
+  BOOST_CHECK_THROW( fromChars<double>( "x" ), std::invalid_argument );
+  BOOST_CHECK_THROW( fromChars<int8_t>( "128" ), std::out_of_range );
+  BOOST_CHECK_THROW( fromChars<uint16_t>( "65536" ), std::out_of_range );
+  BOOST_CHECK_THROW( fromChars<int64_t>( "9223372036854775808" ), std::out_of_range );
+  BOOST_CHECK_THROW( fromChars<float>( "1e39" ), std::out_of_range );
+  BOOST_CHECK_EQUAL( fromChars<int>( " 42 trailing" ), 42 );
+}
+
+BOOST_AUTO_TEST_CASE( charconv_precision )
+{
+  char buffer[cereal::charconv_detail::bufferSize];
+
+  // below full precision the output matches iostreams
+  cereal::charconv_detail::toChars( buffer, 3.14159265358979, 3 );
+  BOOST_CHECK_EQUAL( std::string( buffer ), "3.14" );
+
+  // precision is limited to fit the buffer
+  auto const size = cereal::charconv_detail::toChars( buffer, 1.0 / 3.0, 1000 );
+  BOOST_CHECK( size < cereal::charconv_detail::bufferSize );
+}
+
+BOOST_AUTO_TEST_CASE( xml_arithmetic_text )
+{
+  std::ostringstream os;
+  {
+    cereal::XMLOutputArchive oar( os );
+    oar( cereal::make_nvp( "b", true ), cereal::make_nvp( "i", int8_t( -5 ) ), cereal::make_nvp( "u", uint64_t( 18446744073709551615ULL ) ),
+         cereal::make_nvp( "c", 'c' ), cereal::make_nvp( "s", std::string( " padded " ) ) );
+  }
+
+  auto const xml = os.str();
+  BOOST_CHECK( xml.find( "<b>true</b>" ) != std::string::npos );
+  BOOST_CHECK( xml.find( "<i>-5</i>" ) != std::string::npos );
+  BOOST_CHECK( xml.find( "<u>18446744073709551615</u>" ) != std::string::npos );
+  BOOST_CHECK( xml.find( "<c>c</c>" ) != std::string::npos );
+  BOOST_CHECK( xml.find( "<s xml:space=\"preserve\"> padded </s>" ) != std::string::npos );
+
+  bool b; int8_t i; uint64_t u; char c; std::string s;
+  std::istringstream is( xml );
+  {
+    cereal::XMLInputArchive iar( is );
+    iar( b, i, u, c, s );
+  }
+
+  BOOST_CHECK_EQUAL( b, true );
+  BOOST_CHECK_EQUAL( i, -5 );
+  BOOST_CHECK_EQUAL( u, 18446744073709551615ULL );
+  BOOST_CHECK_EQUAL( c, 'c' );
+  BOOST_CHECK_EQUAL( s, " padded " );
+}
@@ -0,0 +1,141 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include "common.hpp"
+#include <cereal/archives/chunked_output.hpp>
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <thread>
+
+BOOST_AUTO_TEST_CASE( chunked_output_buffer )
+{
+  std::vector<int> o_values( 10000 );
+  for( std::size_t i = 0; i < o_values.size(); ++i )
+    o_values[i] = static_cast<int>( i );
+
+  std::string received;
+  std::vector<std::size_t> sizes;
+  {
+    cereal::ChunkedOutputBuffer buffer( 1000, [&]( const char * data, std::size_t size )
+                                        { received.append( data, size ); sizes.push_back( size ); } );
+    std::ostream stream( &buffer );
+    {
+      cereal::BinaryOutputArchive oar( stream );
+      oar( o_values );
+    }
+    buffer.finish();
+  }
+
+  std::ostringstream expected;
+  {
+    cereal::BinaryOutputArchive oar( expected );
+    oar( o_values );
+  }
+
+  BOOST_CHECK( received == expected.str() );
+  BOOST_REQUIRE( !sizes.empty() );
+  for( std::size_t i = 0; i + 1 < sizes.size(); ++i )
+    BOOST_CHECK_EQUAL( sizes[i], 1000u );
+  BOOST_CHECK_EQUAL( sizes.back(), expected.str().size() % 1000 );
+}
+
+BOOST_AUTO_TEST_CASE( chunked_output_generator )
+{
+  std::mt19937 gen(std::random_device{}());
+
+  std::vector<double> o_values( 50000 );
+  for( auto & v : o_values )
+    v = random_value<double>(gen);
+  std::atomic<std::size_t> saved( 0 );
+
+  cereal::ChunkedOutputGenerator generator( [&]( std::ostream & os )
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar( cereal::make_size_tag( static_cast<cereal::size_type>( o_values.size() ) ) );
+    for( auto v : o_values )
+    {
+      oar( v );
+      ++saved;
+    }
+  }, 4096 );
+
+  // serialization does not run ahead of the consumer
+  std::string received;
+  auto chunk = generator.next();
+  BOOST_REQUIRE( chunk );
+  BOOST_CHECK_EQUAL( chunk.size, 4096u );
+  received.append( chunk.data, chunk.size );
+  std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+  BOOST_CHECK_LT( saved.load(), 4096u / sizeof(double) + 1 );
+
+  while( ( chunk = generator.next() ) )
+    received.append( chunk.data, chunk.size );
+  BOOST_CHECK( !generator.next() );
+
+  std::vector<double> i_values;
+  std::istringstream is( received );
+  {
+    cereal::BinaryInputArchive iar( is );
+    iar( i_values );
+  }
+  BOOST_CHECK( i_values == o_values );
+}
+
+BOOST_AUTO_TEST_CASE( chunked_output_generator_errors )
+{
+  // errors from the save function reach the consumer
+  {
+    cereal::ChunkedOutputGenerator generator( []( std::ostream & os )
+    {
+      os.write( "abc", 3 );
+      throw cereal::Exception( "save failed" );
+    }, 2 );
+
+    auto chunk = generator.next();
+    BOOST_REQUIRE( chunk );
+    BOOST_CHECK_EQUAL( std::string( chunk.data, chunk.size ), "ab" );
+    BOOST_CHECK_THROW( generator.next(), cereal::Exception );
+    BOOST_CHECK( !generator.next() );
+  }
+
+  // abandoning a generator stops the save function
+  {
+    bool finished = false;
+    {
+      cereal::ChunkedOutputGenerator generator( [&]( std::ostream & os )
+      {
+        cereal::BinaryOutputArchive oar( os );
+        for( int i = 0; i < 1000000; ++i )
+          oar( i );
+        finished = true;
+      }, 16 );
+
+      BOOST_CHECK( generator.next() );
+    }
+    BOOST_CHECK( !finished );
+  }
+}
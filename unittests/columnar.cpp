@@ -0,0 +1,272 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/types/columnar.hpp>
+#include <cereal/archives/compact_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+template <class IArchive, class OArchive>
+void test_columnar()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    std::vector<std::string> o_vector;
+    std::deque<std::string> o_deque;
+    std::list<std::string> o_list;
+    for(int j=0; j<100; ++j)
+    {
+      o_vector.push_back( random_basic_string<char>(gen) );
+      o_deque.push_back( random_basic_string<char>(gen) );
+      o_list.push_back( random_basic_string<char>(gen) );
+    }
+    o_vector.emplace_back();
+    o_vector.emplace_back( 300, 'x' );
+
+    std::vector<std::string> const o_empty;
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+
+      oar( cereal::columnar( o_vector ) );
+      oar( cereal::columnar( o_deque ) );
+      oar( cereal::columnar( o_list ) );
+      oar( cereal::columnar( o_empty ) );
+    }
+
+    std::vector<std::string> i_vector = { "stale" };
+    std::deque<std::string> i_deque;
+    std::list<std::string> i_list;
+    std::vector<std::string> i_empty = { "stale" };
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+
+      iar( cereal::columnar( i_vector ) );
+      iar( cereal::columnar( i_deque ) );
+      iar( cereal::columnar( i_list ) );
+      iar( cereal::columnar( i_empty ) );
+    }
+
+    BOOST_CHECK( i_vector == o_vector );
+    BOOST_CHECK( i_deque == o_deque );
+    BOOST_CHECK( i_list == o_list );
+    BOOST_CHECK( i_empty.empty() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_columnar )
+{
+  test_columnar<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_columnar )
+{
+  test_columnar<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( compact_binary_columnar )
+{
+  test_columnar<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_columnar )
+{
+  test_columnar<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_columnar )
+{
+  test_columnar<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+template <class IArchive, class OArchive>
+void test_columnar_wide()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::u16string> o_vector;
+  for(int j=0; j<100; ++j)
+    o_vector.push_back( random_basic_string<char16_t>(gen) );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::columnar( o_vector ) );
+  }
+
+  std::vector<std::u16string> i_vector;
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::columnar( i_vector ) );
+  }
+
+  BOOST_CHECK( i_vector == o_vector );
+}
+
+BOOST_AUTO_TEST_CASE( binary_columnar_wide )
+{
+  test_columnar_wide<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+  test_columnar_wide<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_columnar_size )
+{
+  std::vector<std::string> strings( 1000, "abc" );
+
+  std::ostringstream plain, columnar;
+  {
+    cereal::BinaryOutputArchive oar( plain );
+    oar( strings );
+  }
+  {
+    cereal::BinaryOutputArchive oar( columnar );
+    oar( cereal::columnar( strings ) );
+  }
+
+  // one byte of length for every string instead of an eight byte size tag
+  BOOST_CHECK_EQUAL( columnar.str().size(), 2 * sizeof(cereal::size_type) + 1000 * 4 );
+  BOOST_CHECK_EQUAL( plain.str().size(), sizeof(cereal::size_type) + 1000 * ( sizeof(cereal::size_type) + 3 ) );
+}
+
+BOOST_AUTO_TEST_CASE( binary_columnar_malformed )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+
+    // two strings but a single length
+    std::uint8_t const length = 3;
+    oar( cereal::make_size_tag( static_cast<cereal::size_type>( 2 ) ),
+         cereal::make_size_tag( static_cast<cereal::size_type>( 1 ) ),
+         cereal::binary_data( &length, 1 ) );
+  }
+
+  std::vector<std::string> strings;
+  std::istringstream is( os.str() );
+  cereal::BinaryInputArchive iar( is );
+  BOOST_CHECK_THROW( iar( cereal::columnar( strings ) ), cereal::Exception );
+}
+
+struct ColumnarTrade
+{
+  double price;
+  std::uint32_t quantity;
+  bool buy;
+  std::string symbol;
+  int unsaved;
+
+  bool operator==( ColumnarTrade const & other ) const
+  {
+    return price == other.price && quantity == other.quantity &&
+           buy == other.buy && symbol == other.symbol;
+  }
+};
+
+template <class IArchive, class OArchive>
+void test_columns()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<ColumnarTrade> o_trades( 100 );
+  for( auto & t : o_trades )
+  {
+    t.price = random_value<int>(gen);
+    t.quantity = random_value<std::uint32_t>(gen);
+    t.buy = random_value<int>(gen) % 2 == 0;
+    t.symbol = random_basic_string<char>(gen);
+    t.unsaved = 1;
+  }
+  std::deque<ColumnarTrade> const o_empty;
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::columns( o_trades, &ColumnarTrade::price, &ColumnarTrade::quantity,
+                          &ColumnarTrade::buy, &ColumnarTrade::symbol ) );
+    oar( cereal::columns( o_empty, &ColumnarTrade::price ) );
+  }
+
+  std::vector<ColumnarTrade> i_trades( 3 );
+  std::deque<ColumnarTrade> i_empty( 3 );
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::columns( i_trades, &ColumnarTrade::price, &ColumnarTrade::quantity,
+                          &ColumnarTrade::buy, &ColumnarTrade::symbol ) );
+    iar( cereal::columns( i_empty, &ColumnarTrade::price ) );
+  }
+
+  BOOST_CHECK( i_trades == o_trades );
+  BOOST_CHECK( i_empty.empty() );
+}
+
+BOOST_AUTO_TEST_CASE( binary_columns )
+{
+  test_columns<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+  test_columns<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+  test_columns<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( text_columns )
+{
+  test_columns<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+  test_columns<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_columns_layout )
+{
+  std::vector<ColumnarTrade> trades( 2 );
+  trades[0].price = 1.5; trades[0].quantity = 7;
+  trades[1].price = 2.5; trades[1].quantity = 9;
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar( cereal::columns( trades, &ColumnarTrade::price, &ColumnarTrade::quantity ) );
+  }
+
+  // the count, then every price, then every quantity
+  std::string const data = os.str();
+  BOOST_REQUIRE_EQUAL( data.size(), sizeof(cereal::size_type) + 2 * sizeof(double) + 2 * sizeof(std::uint32_t) );
+
+  double prices[2];
+  std::uint32_t quantities[2];
+  std::memcpy( prices, data.data() + sizeof(cereal::size_type), sizeof(prices) );
+  std::memcpy( quantities, data.data() + sizeof(cereal::size_type) + sizeof(prices), sizeof(quantities) );
+  BOOST_CHECK_EQUAL( prices[0], 1.5 );
+  BOOST_CHECK_EQUAL( prices[1], 2.5 );
+  BOOST_CHECK_EQUAL( quantities[0], 7u );
+  BOOST_CHECK_EQUAL( quantities[1], 9u );
+}
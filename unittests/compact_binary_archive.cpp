@@ -0,0 +1,169 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/compact_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+template <class T>
+void test_compact_binary_extremes( cereal::CompactBinaryOutputArchive::Options const & options )
+{
+  std::vector<T> const o_values = { T(0), T(1), std::numeric_limits<T>::min(), std::numeric_limits<T>::max(),
+                                    static_cast<T>( std::numeric_limits<T>::min() + 1 ),
+                                    static_cast<T>( std::numeric_limits<T>::max() - 1 ) };
+
+  std::ostringstream os;
+  {
+    cereal::CompactBinaryOutputArchive oar(os, options);
+    for( auto const & v : o_values )
+      oar( v );
+  }
+
+  std::istringstream is(os.str());
+  {
+    cereal::CompactBinaryInputArchive iar(is);
+    for( auto const & v : o_values )
+    {
+      T i_value;
+      iar( i_value );
+      BOOST_CHECK_EQUAL( i_value, v );
+    }
+  }
+}
+
+void test_compact_binary( cereal::CompactBinaryOutputArchive::Options const & options )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    std::vector<std::string> o_strings( random_value<std::uint8_t>(gen) );
+    for( auto & s : o_strings )
+      s = random_value<std::string>(gen);
+
+    std::map<std::int64_t, std::uint32_t> o_map;
+    for( int j = 0; j < 100; ++j )
+      o_map.emplace( random_value<std::int64_t>(gen) >> random_value<std::uint8_t>(gen) % 64,
+                     random_value<std::uint32_t>(gen) >> random_value<std::uint8_t>(gen) % 32 );
+
+    std::vector<int> o_ints( 1000 );
+    for( auto & i : o_ints )
+      i = random_value<int>(gen);
+
+    std::shared_ptr<int> o_shared = std::make_shared<int>( random_value<int>(gen) );
+    std::int16_t o_short = random_value<std::int16_t>(gen);
+    double o_double = random_value<double>(gen);
+    bool o_bool = random_value<int>(gen) % 2 == 0;
+
+    std::ostringstream os;
+    {
+      cereal::CompactBinaryOutputArchive oar(os, options);
+      oar( o_strings, o_map, o_ints, o_shared, o_shared, o_short, o_double, o_bool );
+    }
+
+    std::vector<std::string> i_strings;
+    std::map<std::int64_t, std::uint32_t> i_map;
+    std::vector<int> i_ints;
+    std::shared_ptr<int> i_shared, i_shared2;
+    std::int16_t i_short;
+    double i_double;
+    bool i_bool;
+
+    std::istringstream is(os.str());
+    {
+      cereal::CompactBinaryInputArchive iar(is);
+      iar( i_strings, i_map, i_ints, i_shared, i_shared2, i_short, i_double, i_bool );
+    }
+
+    BOOST_CHECK( i_strings == o_strings );
+    BOOST_CHECK( i_map == o_map );
+    BOOST_CHECK( i_ints == o_ints );
+    BOOST_CHECK_EQUAL( *i_shared, *o_shared );
+    BOOST_CHECK_EQUAL( i_shared, i_shared2 );
+    BOOST_CHECK_EQUAL( i_short, o_short );
+    BOOST_CHECK_EQUAL( i_double, o_double );
+    BOOST_CHECK_EQUAL( i_bool, o_bool );
+  }
+
+  test_compact_binary_extremes<std::int16_t>( options );
+  test_compact_binary_extremes<std::uint16_t>( options );
+  test_compact_binary_extremes<std::int32_t>( options );
+  test_compact_binary_extremes<std::uint32_t>( options );
+  test_compact_binary_extremes<std::int64_t>( options );
+  test_compact_binary_extremes<std::uint64_t>( options );
+}
+
+BOOST_AUTO_TEST_CASE( compact_binary_size_tags )
+{
+  test_compact_binary( cereal::CompactBinaryOutputArchive::Options::Default() );
+}
+
+BOOST_AUTO_TEST_CASE( compact_binary_all_integers )
+{
+  test_compact_binary( cereal::CompactBinaryOutputArchive::Options::AllIntegers() );
+}
+
+BOOST_AUTO_TEST_CASE( compact_binary_encoded_size )
+{
+  std::ostringstream os;
+  {
+    cereal::CompactBinaryOutputArchive oar(os);
+    oar( std::string("abc") );
+  }
+  // header + one byte of size + data
+  BOOST_CHECK_EQUAL( os.str().size(), 1u + 1u + 3u );
+
+  std::ostringstream os2;
+  {
+    cereal::CompactBinaryOutputArchive oar(os2, cereal::CompactBinaryOutputArchive::Options::AllIntegers());
+    oar( std::int64_t(-1), std::uint32_t(127), std::uint32_t(128), std::int32_t(300) );
+  }
+  BOOST_CHECK_EQUAL( os2.str().size(), 1u + 1u + 1u + 2u + 2u );
+}
+
+BOOST_AUTO_TEST_CASE( compact_binary_malformed )
+{
+  // header followed by a varint that never terminates
+  std::string const overlong = std::string( 1, '\x01' ) + std::string( 11, '\xFF' );
+  std::istringstream is(overlong);
+  cereal::CompactBinaryInputArchive iar(is);
+  std::uint64_t value;
+  BOOST_CHECK_THROW( iar( value ), cereal::Exception );
+
+  // a value too large for its type
+  std::string const large = std::string( 1, '\x01' ) + std::string( "\xFF\xFF\x7F" );
+  std::istringstream is2(large);
+  cereal::CompactBinaryInputArchive iar2(is2);
+  std::uint16_t small;
+  BOOST_CHECK_THROW( iar2( small ), cereal::Exception );
+
+  // truncated
+  std::string const truncated = std::string( 1, '\x01' ) + std::string( "\xFF" );
+  std::istringstream is3(truncated);
+  cereal::CompactBinaryInputArchive iar3(is3);
+  BOOST_CHECK_THROW( iar3( value ), cereal::Exception );
+}
@@ -0,0 +1,305 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/compressed_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+void test_lz4_block_roundtrip( std::string const & o_data )
+{
+  cereal::LZ4BlockCodec codec;
+  std::vector<char> compressed( codec.maxCompressedSize( o_data.size() ) );
+  auto const size = codec.compress( o_data.data(), o_data.size(), compressed.data(), compressed.size() );
+
+  std::vector<char> i_data( o_data.size() );
+  codec.decompress( compressed.data(), size, i_data.data(), i_data.size() );
+
+  BOOST_CHECK( std::equal( i_data.begin(), i_data.end(), o_data.begin() ) );
+}
+
+BOOST_AUTO_TEST_CASE( lz4_block_codec )
+{
+  std::mt19937 gen(1234);
+
+  test_lz4_block_roundtrip( "" );
+  test_lz4_block_roundtrip( "a" );
+  test_lz4_block_roundtrip( "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa" );
+  test_lz4_block_roundtrip( std::string( 100000, 'x' ) );
+
+  std::string random;
+  for( int i = 0; i < 100000; ++i )
+    random.push_back( static_cast<char>( gen() ) );
+  test_lz4_block_roundtrip( random );
+
+  std::string text;
+  for( int i = 0; i < 5000; ++i )
+    text += "value " + std::to_string( gen() % 100 ) + ", ";
+  test_lz4_block_roundtrip( text );
+
+  // repetitive data should compress well
+  cereal::LZ4BlockCodec codec;
+  std::vector<char> compressed( codec.maxCompressedSize( text.size() ) );
+  BOOST_CHECK_LT( codec.compress( text.data(), text.size(), compressed.data(), compressed.size() ), text.size() / 2 );
+
+  // corrupt data must be rejected rather than read out of bounds
+  std::vector<char> i_data( 16 );
+  char const bad_offset[] = { char(0x10), 'a', char(0x20), char(0x00) };
+  BOOST_CHECK_THROW( codec.decompress( bad_offset, sizeof(bad_offset), i_data.data(), i_data.size() ), cereal::Exception );
+  char const bad_literals[] = { char(0xF0), char(0x40), 'a' };
+  BOOST_CHECK_THROW( codec.decompress( bad_literals, sizeof(bad_literals), i_data.data(), i_data.size() ), cereal::Exception );
+}
+
+void test_compressed_binary( std::size_t frameSize )
+{
+  std::mt19937 gen(5678);
+
+  for(int ii=0; ii<10; ++ii)
+  {
+    std::vector<int> o_ints( 10000 );
+    for( auto & i : o_ints )
+      i = static_cast<int>( gen() % 1000 );
+    std::string o_string = random_basic_string<char>(gen);
+    std::map<std::string, double> o_map;
+    for( int j = 0; j < 100; ++j )
+      o_map.emplace( random_basic_string<char>(gen), static_cast<double>( j ) / 4.0 );
+    StructInternalSerialize o_struct( static_cast<int>( gen() ), static_cast<int>( gen() ) );
+
+    std::ostringstream os;
+    {
+      cereal::CompressedBinaryOutputArchive oar( os, cereal::CompressedBinaryOutputArchive::Options( nullptr, frameSize ) );
+      oar( o_ints, o_string, o_map, o_struct );
+    }
+
+    std::vector<int> i_ints;
+    std::string i_string;
+    std::map<std::string, double> i_map;
+    StructInternalSerialize i_struct;
+
+    std::istringstream is( os.str() );
+    {
+      cereal::CompressedBinaryInputArchive iar( is );
+      iar( i_ints, i_string, i_map, i_struct );
+    }
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( i_ints.begin(), i_ints.end(), o_ints.begin(), o_ints.end() );
+    BOOST_CHECK_EQUAL( i_string, o_string );
+    BOOST_CHECK( i_map == o_map );
+    BOOST_CHECK( i_struct == o_struct );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( compressed_binary_archive )
+{
+  test_compressed_binary( 1 << 20 );
+  test_compressed_binary( 1000 );
+  test_compressed_binary( 7 );
+}
+
+struct StoredCodec : public cereal::CompressionCodec
+{
+  std::size_t maxCompressedSize( std::size_t size ) const override { return size; }
+
+  std::size_t compress( const char * src, std::size_t srcSize, char * dst, std::size_t ) override
+  {
+    ++frames;
+    std::memcpy( dst, src, srcSize );
+    return srcSize;
+  }
+
+  void decompress( const char *, std::size_t, char *, std::size_t ) override
+  {
+    throw cereal::Exception("stored frames should never be decompressed");
+  }
+
+  int frames = 0;
+};
+
+BOOST_AUTO_TEST_CASE( compressed_binary_archive_custom_codec )
+{
+  auto codec = std::make_shared<StoredCodec>();
+  std::vector<std::uint64_t> o_data( 1000, 42 );
+
+  std::ostringstream os;
+  {
+    cereal::CompressedBinaryOutputArchive oar( os, cereal::CompressedBinaryOutputArchive::Options( codec, 1024 ) );
+    oar( o_data );
+  }
+
+  // size tag and 8000 bytes of data in 1024 byte frames
+  BOOST_CHECK_EQUAL( codec->frames, 8 );
+
+  std::vector<std::uint64_t> i_data;
+  std::istringstream is( os.str() );
+  {
+    cereal::CompressedBinaryInputArchive iar( is, codec );
+    iar( i_data );
+  }
+
+  BOOST_CHECK_EQUAL_COLLECTIONS( i_data.begin(), i_data.end(), o_data.begin(), o_data.end() );
+}
+
+struct FailingCodec : public cereal::CompressionCodec
+{
+  std::size_t maxCompressedSize( std::size_t size ) const override { return size; }
+
+  std::size_t compress( const char *, std::size_t, char *, std::size_t ) override
+  {
+    throw cereal::Exception("compression failed");
+  }
+
+  void decompress( const char *, std::size_t, char *, std::size_t ) override {}
+};
+
+BOOST_AUTO_TEST_CASE( compressed_binary_archive_flush_errors )
+{
+  auto codec = std::make_shared<FailingCodec>();
+  std::ostringstream os;
+
+  // an explicit flush reports the error, and the frame is not tried again
+  {
+    cereal::CompressedBinaryOutputArchive oar( os, cereal::CompressedBinaryOutputArchive::Options( codec, 1024 ) );
+    oar( std::uint32_t( 1 ) );
+    BOOST_CHECK_THROW( oar.flush(), cereal::Exception );
+    BOOST_CHECK_NO_THROW( oar.flush() );
+  }
+
+  // the destructor swallows the error instead of terminating
+  BOOST_CHECK_NO_THROW( [&]()
+  {
+    cereal::CompressedBinaryOutputArchive oar( os, cereal::CompressedBinaryOutputArchive::Options( codec, 1024 ) );
+    oar( std::uint32_t( 1 ) );
+  }() );
+  BOOST_CHECK( os.str().empty() );
+}
+
+BOOST_AUTO_TEST_CASE( compressed_binary_archive_truncated )
+{
+  std::ostringstream os;
+  {
+    cereal::CompressedBinaryOutputArchive oar( os );
+    oar( std::string( 10000, 'z' ) );
+  }
+
+  auto const data = os.str();
+  std::istringstream is( data.substr( 0, data.size() - 1 ) );
+  cereal::CompressedBinaryInputArchive iar( is );
+  std::string i_string;
+  BOOST_CHECK_THROW( iar( i_string ), cereal::Exception );
+}
+
+struct DictionaryMessage
+{
+  std::string method;
+  std::string user;
+  std::uint64_t requestId;
+  std::vector<std::int32_t> values;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( method, user, requestId, values ); }
+
+  bool operator==( DictionaryMessage const & other ) const
+  { return method == other.method && user == other.user && requestId == other.requestId && values == other.values; }
+};
+
+inline DictionaryMessage random_message( std::mt19937 & gen )
+{
+  static char const * const methods[] = { "inventory.reserve_items", "inventory.release_items", "billing.charge_customer_account" };
+  DictionaryMessage m;
+  m.method = methods[gen() % 3];
+  m.user = "customer-" + std::to_string( gen() % 50 ) + "@example.com";
+  m.requestId = gen();
+  for( int i = 0; i < 8; ++i )
+    m.values.push_back( static_cast<std::int32_t>( gen() % 4 ) );
+  return m;
+}
+
+template <class OArchive, class ... Options>
+std::string save_message( DictionaryMessage const & m, Options ... options )
+{
+  std::ostringstream os;
+  {
+    OArchive oar( os, options... );
+    oar( m );
+  }
+  return os.str();
+}
+
+BOOST_AUTO_TEST_CASE( compressed_binary_archive_dictionary )
+{
+  std::mt19937 gen(91011);
+
+  std::vector<std::string> samples;
+  for( int i = 0; i < 500; ++i )
+    samples.push_back( save_message<cereal::BinaryOutputArchive>( random_message( gen ) ) );
+
+  auto const dictionary = std::make_shared<cereal::CompressionDictionary>( cereal::CompressionDictionary::train( samples, 4096 ) );
+  BOOST_CHECK( !dictionary->content().empty() );
+  BOOST_CHECK_LE( dictionary->content().size(), 4096u );
+  BOOST_CHECK_NE( dictionary->id(), 0u );
+
+  std::size_t plainSize = 0, withoutSize = 0, withSize = 0;
+  for( int i = 0; i < 100; ++i )
+  {
+    auto const o_message = random_message( gen );
+    plainSize += save_message<cereal::BinaryOutputArchive>( o_message ).size();
+    withoutSize += save_message<cereal::CompressedBinaryOutputArchive>( o_message ).size();
+
+    auto const compressed = save_message<cereal::CompressedBinaryOutputArchive>( o_message,
+      cereal::CompressedBinaryOutputArchive::Options( std::make_shared<cereal::LZ4BlockCodec>( dictionary ) ) );
+    withSize += compressed.size();
+
+    DictionaryMessage i_message;
+    std::istringstream is( compressed );
+    {
+      cereal::CompressedBinaryInputArchive iar( is, std::make_shared<cereal::LZ4BlockCodec>( dictionary ) );
+      iar( i_message );
+    }
+    BOOST_CHECK( i_message == o_message );
+  }
+
+  // small messages barely compress alone, but do against the dictionary
+  BOOST_CHECK_LT( withSize * 3, plainSize * 2 );
+  BOOST_CHECK_LT( withSize * 3, withoutSize * 2 );
+
+  // data is never decoded with a different dictionary, or without one
+  auto const compressed = save_message<cereal::CompressedBinaryOutputArchive>( random_message( gen ),
+    cereal::CompressedBinaryOutputArchive::Options( std::make_shared<cereal::LZ4BlockCodec>( dictionary ) ) );
+  auto const other = std::make_shared<cereal::CompressionDictionary>( dictionary->content(), dictionary->id() + 1 );
+  std::istringstream is( compressed );
+  BOOST_CHECK_THROW( cereal::CompressedBinaryInputArchive( is, std::make_shared<cereal::LZ4BlockCodec>( other ) ), cereal::Exception );
+
+  // large blocks still round trip, with matches into the dictionary and the block itself
+  std::string large;
+  for( auto const & sample : samples )
+    large += sample;
+  cereal::LZ4BlockCodec codec( dictionary );
+  std::vector<char> buffer( codec.maxCompressedSize( large.size() ) );
+  auto const size = codec.compress( large.data(), large.size(), buffer.data(), buffer.size() );
+  std::string i_large( large.size(), '\0' );
+  codec.decompress( buffer.data(), size, &i_large[0], i_large.size() );
+  BOOST_CHECK( i_large == large );
+}
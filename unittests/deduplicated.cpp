@@ -0,0 +1,181 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/compact_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct DeduplicatedAsset
+{
+  std::string name;
+  std::vector<std::uint8_t> payload;
+  std::vector<float> samples;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( CEREAL_NVP(name),
+        CEREAL_NVP_("payload", cereal::deduplicated( payload )),
+        CEREAL_NVP_("samples", cereal::deduplicated( samples, 64 )) );
+  }
+
+  bool operator==( DeduplicatedAsset const & other ) const
+  {
+    return name == other.name && payload == other.payload && samples == other.samples;
+  }
+};
+
+template <class IArchive, class OArchive>
+void test_deduplicated()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::vector<std::uint8_t>> payloads;
+  for(int j=0; j<5; ++j)
+  {
+    std::vector<std::uint8_t> payload( 1000 + gen() % 2000 );
+    for( auto & b : payload )
+      b = random_value<std::uint8_t>(gen);
+    payloads.push_back( payload );
+  }
+  payloads.push_back( { 1, 2, 3 } ); // below the threshold
+  payloads.push_back( {} );
+
+  std::vector<float> samples( 100 );
+  for( auto & f : samples )
+    f = random_value<std::int16_t>(gen) / 4.0f;
+
+  std::vector<DeduplicatedAsset> o_assets;
+  for(int j=0; j<100; ++j)
+    o_assets.push_back( { random_basic_string<char>(gen), payloads[gen() % payloads.size()],
+                          j % 2 ? samples : std::vector<float>( 10, 1.0f ) } );
+
+  std::string const o_single( 5000, 'x' );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_assets );
+    oar( cereal::deduplicated( o_single ), cereal::deduplicated( o_single ) );
+  }
+
+  std::vector<DeduplicatedAsset> i_assets( 3 );
+  std::string i_single1, i_single2;
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( i_assets );
+    iar( cereal::deduplicated( i_single1 ), cereal::deduplicated( i_single2 ) );
+  }
+
+  BOOST_CHECK( i_assets == o_assets );
+  BOOST_CHECK_EQUAL( i_single1, o_single );
+  BOOST_CHECK_EQUAL( i_single2, o_single );
+}
+
+BOOST_AUTO_TEST_CASE( binary_deduplicated )
+{
+  test_deduplicated<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_deduplicated )
+{
+  test_deduplicated<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( compact_binary_deduplicated )
+{
+  test_deduplicated<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_deduplicated )
+{
+  test_deduplicated<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_deduplicated )
+{
+  test_deduplicated<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_deduplicated_size )
+{
+  std::vector<std::uint8_t> const payload( 4096, 7 );
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    for(int j=0; j<10; ++j)
+      oar( cereal::deduplicated( payload ) );
+  }
+
+  // the payload is saved once, followed by nine ids
+  BOOST_CHECK_EQUAL( os.str().size(), 10 * sizeof(std::uint32_t) + sizeof(cereal::size_type) + payload.size() );
+}
+
+BOOST_AUTO_TEST_CASE( binary_deduplicated_distinct )
+{
+  // blocks of the same size that differ only in their last byte are kept apart
+  std::vector<std::uint8_t> a( 2048, 1 ), b( 2048, 1 );
+  b.back() = 2;
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( cereal::deduplicated( a ), cereal::deduplicated( b ), cereal::deduplicated( a ) );
+  }
+
+  std::vector<std::uint8_t> ia, ib, ia2;
+  std::istringstream is(os.str());
+  cereal::BinaryInputArchive iar(is);
+  iar( cereal::deduplicated( ia ), cereal::deduplicated( ib ), cereal::deduplicated( ia2 ) );
+  BOOST_CHECK( ia == a );
+  BOOST_CHECK( ib == b );
+  BOOST_CHECK( ia2 == a );
+}
+
+BOOST_AUTO_TEST_CASE( binary_deduplicated_unknown_id )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( std::uint32_t( 5 ) );
+  }
+
+  std::vector<std::uint8_t> loaded;
+  std::istringstream is(os.str());
+  cereal::BinaryInputArchive iar(is);
+  BOOST_CHECK_THROW( iar( cereal::deduplicated( loaded ) ), cereal::Exception );
+}
+
+BOOST_AUTO_TEST_CASE( hash_bytes )
+{
+  // reference values of XXH64 with a seed of zero
+  BOOST_CHECK_EQUAL( cereal::detail::hash_bytes( "", 0 ), 0xEF46DB3751D8E999ULL );
+  BOOST_CHECK_EQUAL( cereal::detail::hash_bytes( "abc", 3 ), 0x44BC2CF5AD770999ULL );
+}
@@ -0,0 +1,145 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/types/delta_encoded.hpp>
+#include <cereal/archives/compact_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+template <class IArchive, class OArchive, class T>
+void test_delta_encoded_vector( std::vector<T> const & o_vector )
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::delta_encoded( o_vector ) );
+  }
+
+  std::vector<T> i_vector( 3 );
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::delta_encoded( i_vector ) );
+  }
+
+  BOOST_CHECK_EQUAL_COLLECTIONS( i_vector.begin(), i_vector.end(), o_vector.begin(), o_vector.end() );
+}
+
+template <class IArchive, class OArchive>
+void test_delta_encoded()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<10; ++ii)
+  {
+    // increasing with jitter, spanning several blocks
+    std::vector<std::uint64_t> timestamps;
+    std::uint64_t t = random_value<std::uint64_t>(gen) >> 1;
+    for(int j=0; j<1000; ++j)
+      timestamps.push_back( t += 1000 + gen() % 16 );
+    test_delta_encoded_vector<IArchive, OArchive>( timestamps );
+
+    // random values, including wrap around of the differences
+    std::vector<std::int32_t> values;
+    for(int j=0; j<300; ++j)
+      values.push_back( random_value<std::int32_t>(gen) );
+    values.push_back( std::numeric_limits<std::int32_t>::max() );
+    values.push_back( std::numeric_limits<std::int32_t>::min() );
+    test_delta_encoded_vector<IArchive, OArchive>( values );
+
+    std::vector<std::uint64_t> extremes = { 0, ~std::uint64_t( 0 ), 0, 1, ~std::uint64_t( 0 ) - 1 };
+    test_delta_encoded_vector<IArchive, OArchive>( extremes );
+
+    std::vector<std::int8_t> small;
+    for(int j=0; j<200; ++j)
+      small.push_back( random_value<std::int8_t>(gen) );
+    test_delta_encoded_vector<IArchive, OArchive>( small );
+
+    test_delta_encoded_vector<IArchive, OArchive>( std::vector<std::uint16_t>( 129, 7 ) );
+    test_delta_encoded_vector<IArchive, OArchive>( std::vector<std::int64_t>() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_delta_encoded )
+{
+  test_delta_encoded<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_delta_encoded )
+{
+  test_delta_encoded<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( compact_binary_delta_encoded )
+{
+  test_delta_encoded<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_delta_encoded )
+{
+  test_delta_encoded<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_delta_encoded )
+{
+  test_delta_encoded<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_delta_encoded_size )
+{
+  // evenly spaced values need no bits beyond the reference of each block
+  std::vector<std::uint64_t> ids;
+  for(std::uint64_t j=0; j<1280; ++j)
+    ids.push_back( 1000000000000 + j * 10 );
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( cereal::delta_encoded( ids ) );
+  }
+
+  BOOST_CHECK_LT( os.str().size(), 2 * sizeof(cereal::size_type) + 10 * 8 );
+}
+
+BOOST_AUTO_TEST_CASE( binary_delta_encoded_malformed )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+
+    // a first value followed by a block with a width larger than 64 bits
+    std::uint8_t const block[] = { 0, 65, 0 };
+    oar( cereal::make_size_tag( static_cast<cereal::size_type>( 2 ) ),
+         cereal::make_size_tag( static_cast<cereal::size_type>( sizeof(block) ) ),
+         cereal::binary_data( &block[0], sizeof(block) ) );
+  }
+
+  std::vector<std::uint32_t> values;
+  std::istringstream is(os.str());
+  cereal::BinaryInputArchive iar(is);
+  BOOST_CHECK_THROW( iar( cereal::delta_encoded( values ) ), cereal::Exception );
+}
@@ -116,3 +116,52 @@ BOOST_AUTO_TEST_CASE( json_dequeue )
 {
   test_deque<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
 }
+
+template <class IArchive, class OArchive>
+void test_deque_blocks()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // grow at both ends so that the first and last blocks are partly used
+  std::deque<double> o_deque;
+  for( int i = 0; i < 5000; ++i )
+  {
+    o_deque.push_back( random_value<std::int16_t>(gen) / 4.0 );
+    o_deque.push_front( random_value<std::int16_t>(gen) / 4.0 );
+  }
+  for( int i = 0; i < 777; ++i )
+    o_deque.pop_front();
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_deque );
+  }
+
+  // written block by block, the result is the same as for a vector
+  std::ostringstream asVector;
+  {
+    OArchive oar(asVector);
+    oar( std::vector<double>( o_deque.begin(), o_deque.end() ) );
+  }
+  BOOST_CHECK( os.str() == asVector.str() );
+
+  std::deque<double> i_deque( 10, 1.0 );
+  {
+    std::istringstream is(os.str());
+    IArchive iar(is);
+    iar( i_deque );
+  }
+  BOOST_CHECK( i_deque == o_deque );
+}
+
+BOOST_AUTO_TEST_CASE( binary_deque_blocks )
+{
+  test_deque_blocks<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_deque_blocks )
+{
+  test_deque_blocks<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
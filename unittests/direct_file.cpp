@@ -0,0 +1,102 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/direct_file.hpp>
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+BOOST_AUTO_TEST_CASE( direct_file_roundtrip )
+{
+  std::mt19937 gen(std::random_device{}());
+  char const * filename = "direct_file_test.bin";
+
+  std::vector<double> o_doubles( 5000 );
+  for( auto & d : o_doubles )
+    d = random_value<double>(gen);
+  std::map<int, std::string> o_map;
+  for( int i = 0; i < 100; ++i )
+    o_map[i] = random_basic_string<char>(gen);
+
+  // small buffers, so that many writes are in flight and the last one is partial
+  for( bool direct : { true, false } )
+  {
+    std::ostringstream expected;
+    {
+      cereal::BinaryOutputArchive oar( expected );
+      oar( o_doubles, o_map );
+    }
+
+    {
+      cereal::DirectFileOutputBuffer buffer( filename, cereal::DirectFileOutputBuffer::Options( 4096, 3, direct ) );
+      std::ostream stream( &buffer );
+      {
+        cereal::BinaryOutputArchive oar( stream );
+        oar( o_doubles, o_map );
+      }
+      buffer.close();
+    }
+
+    // the padding of the last block is cut off
+    {
+      std::ifstream is( filename, std::ios::binary );
+      std::string const written( ( std::istreambuf_iterator<char>( is ) ), std::istreambuf_iterator<char>() );
+      BOOST_CHECK( written == expected.str() );
+    }
+
+    std::vector<double> i_doubles;
+    std::map<int, std::string> i_map;
+    {
+      cereal::DirectFileInputBuffer buffer( filename, cereal::DirectFileInputBuffer::Options( 8192, 2, direct ) );
+      std::istream stream( &buffer );
+      cereal::BinaryInputArchive iar( stream );
+      iar( i_doubles, i_map );
+
+      int past;
+      BOOST_CHECK_THROW( iar( past ), cereal::Exception );
+    }
+
+    BOOST_CHECK( i_doubles == o_doubles );
+    BOOST_CHECK( i_map == o_map );
+  }
+
+  // empty files are valid
+  {
+    cereal::DirectFileOutputBuffer buffer( filename );
+  }
+  {
+    cereal::DirectFileInputBuffer buffer( filename );
+    std::istream stream( &buffer );
+    cereal::BinaryInputArchive iar( stream );
+    int x;
+    BOOST_CHECK_THROW( iar( x ), cereal::Exception );
+  }
+
+  std::remove( filename );
+
+  BOOST_CHECK_THROW( cereal::DirectFileInputBuffer( "this/file/does/not/exist" ), cereal::Exception );
+  BOOST_CHECK_THROW( cereal::DirectFileOutputBuffer( "this/directory/does/not/exist/file" ), cereal::Exception );
+}
@@ -0,0 +1,150 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct ExternInner
+{
+  int x;
+  std::string s;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const version )
+  {
+    ar( x, s );
+    if( version > 0 )
+      ar( CEREAL_NVP_("extra", x) );
+  }
+};
+
+CEREAL_CLASS_VERSION( ExternInner, 1 )
+
+// the same as ExternInner, but never declared extern
+struct PlainInner : ExternInner {};
+
+CEREAL_CLASS_VERSION( PlainInner, 1 )
+
+struct ExternOuter
+{
+  ExternInner inner;
+  std::vector<ExternInner> many;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    ar( inner, many );
+  }
+
+  template <class Archive>
+  void load( Archive & ar )
+  {
+    ar( inner, many );
+  }
+};
+
+// declared extern as a header would, then instantiated as its source file would
+CEREAL_EXTERN_SERIALIZATION( cereal::BinaryOutputArchive, ExternInner )
+CEREAL_EXTERN_SERIALIZATION( cereal::BinaryInputArchive, ExternInner )
+CEREAL_EXTERN_SERIALIZATION( cereal::JSONOutputArchive, ExternOuter )
+CEREAL_EXTERN_SERIALIZATION( cereal::JSONInputArchive, ExternOuter )
+
+CEREAL_INSTANTIATE_SERIALIZATION( cereal::BinaryOutputArchive, ExternInner )
+CEREAL_INSTANTIATE_SERIALIZATION( cereal::BinaryInputArchive, ExternInner )
+CEREAL_INSTANTIATE_SERIALIZATION( cereal::JSONOutputArchive, ExternOuter )
+CEREAL_INSTANTIATE_SERIALIZATION( cereal::JSONInputArchive, ExternOuter )
+
+static_assert( cereal::traits::has_extern_serialization<cereal::BinaryOutputArchive, ExternInner>::value, "" );
+static_assert( !cereal::traits::has_extern_serialization<cereal::JSONOutputArchive, ExternInner>::value, "" );
+
+template <class OArchive, class IArchive>
+void test_extern_serialization()
+{
+  std::mt19937 gen(std::random_device{}());
+
+  ExternOuter o_outer;
+  o_outer.inner = { random_value<int>(gen), random_basic_string<char>(gen) };
+  for( int i = 0; i < 10; ++i )
+    o_outer.many.push_back( { random_value<int>(gen), random_basic_string<char>(gen) } );
+
+  std::ostringstream os;
+  {
+    OArchive oar( os );
+    oar( o_outer, o_outer.inner );
+  }
+
+  ExternOuter i_outer;
+  ExternInner i_inner;
+  {
+    std::istringstream is( os.str() );
+    IArchive iar( is );
+    iar( i_outer, i_inner );
+  }
+
+  BOOST_CHECK_EQUAL( i_outer.inner.x, o_outer.inner.x );
+  BOOST_CHECK_EQUAL( i_outer.inner.s, o_outer.inner.s );
+  BOOST_REQUIRE_EQUAL( i_outer.many.size(), o_outer.many.size() );
+  for( std::size_t i = 0; i < o_outer.many.size(); ++i )
+  {
+    BOOST_CHECK_EQUAL( i_outer.many[i].x, o_outer.many[i].x );
+    BOOST_CHECK_EQUAL( i_outer.many[i].s, o_outer.many[i].s );
+  }
+  BOOST_CHECK_EQUAL( i_inner.x, o_outer.inner.x );
+  BOOST_CHECK_EQUAL( i_inner.s, o_outer.inner.s );
+}
+
+BOOST_AUTO_TEST_CASE( binary_extern_serialization )
+{
+  test_extern_serialization<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_extern_serialization )
+{
+  test_extern_serialization<cereal::JSONOutputArchive, cereal::JSONInputArchive>();
+}
+
+// the layout is the same as without extern serialization
+BOOST_AUTO_TEST_CASE( extern_serialization_layout )
+{
+  ExternInner inner = { 5, "five" };
+  PlainInner plain;
+  plain.x = inner.x;
+  plain.s = inner.s;
+
+  std::ostringstream with;
+  {
+    cereal::BinaryOutputArchive oar( with );
+    oar( inner, inner );
+  }
+
+  std::ostringstream without;
+  {
+    cereal::BinaryOutputArchive oar( without );
+    oar( plain, plain );
+  }
+
+  BOOST_CHECK( with.str() == without.str() );
+}
@@ -0,0 +1,214 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/flat.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  struct FlatEntry
+  {
+    std::uint32_t id;
+    double weight;
+    cereal::flat_string name;
+    cereal::flat_array<cereal::flat_string> tags;
+  };
+
+  struct FlatTable
+  {
+    std::uint64_t version;
+    cereal::flat_array<FlatEntry> entries;
+    cereal::flat_array<std::int16_t> values;
+  };
+
+  struct FlatData
+  {
+    std::vector<std::string> names;
+    std::vector<std::vector<std::string>> tags;
+    std::vector<std::int16_t> values;
+  };
+
+  FlatData random_flat_data( std::mt19937 & gen )
+  {
+    FlatData data;
+    for( std::size_t i = 0, n = gen() % 16 + 1; i < n; ++i )
+    {
+      data.names.push_back( random_basic_string<char>( gen ) );
+      data.tags.emplace_back();
+      for( std::size_t j = 0, m = gen() % 4; j < m; ++j )
+        data.tags.back().push_back( random_basic_string<char>( gen ) );
+    }
+    for( std::size_t i = 0, n = gen() % 64; i < n; ++i )
+      data.values.push_back( random_value<std::int16_t>( gen ) );
+    return data;
+  }
+
+  std::vector<char> build_flat( FlatData const & data )
+  {
+    cereal::FlatBuilder builder;
+    auto table = builder.create<FlatTable>();
+    builder.get( table ).version = 7;
+
+    auto entries = builder.createArray<FlatEntry>( data.names.size() );
+    for( std::size_t i = 0; i < data.names.size(); ++i )
+    {
+      builder.get( entries.at( i ) ).id = static_cast<std::uint32_t>( i );
+      builder.get( entries.at( i ) ).weight = i * 0.5;
+      builder.link( entries.at( i ), &FlatEntry::name, builder.createString( data.names[i] ) );
+
+      auto tags = builder.createArray<cereal::flat_string>( data.tags[i].size() );
+      for( std::size_t j = 0; j < data.tags[i].size(); ++j )
+        builder.link( tags.at( j ), builder.createString( data.tags[i][j] ) );
+      builder.link( entries.at( i ), &FlatEntry::tags, tags );
+    }
+    builder.link( table, &FlatTable::entries, entries );
+    builder.link( table, &FlatTable::values, builder.createArray( data.values ) );
+
+    return builder.finish( table );
+  }
+
+  void check_flat( FlatData const & data, cereal::FlatView<FlatTable> const & view )
+  {
+    BOOST_CHECK_EQUAL( view->version, 7u );
+    BOOST_REQUIRE_EQUAL( view->entries.size(), data.names.size() );
+    for( std::size_t i = 0; i < data.names.size(); ++i )
+    {
+      auto const & entry = view->entries[i];
+      BOOST_CHECK_EQUAL( entry.id, i );
+      BOOST_CHECK_EQUAL( entry.weight, i * 0.5 );
+      BOOST_CHECK_EQUAL( entry.name.str(), data.names[i] );
+      BOOST_CHECK_EQUAL( std::strlen( entry.name.c_str() ), data.names[i].size() );
+
+      BOOST_REQUIRE_EQUAL( entry.tags.size(), data.tags[i].size() );
+      std::size_t j = 0;
+      for( auto const & tag : entry.tags )
+        BOOST_CHECK_EQUAL( tag.str(), data.tags[i][j++] );
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS( view->values.begin(), view->values.end(), data.values.begin(), data.values.end() );
+  }
+
+  // Copies a layout to memory aligned for it, at an offset of padding blocks
+  std::vector<std::uint64_t> place_flat( std::vector<char> const & layout, std::size_t padding )
+  {
+    std::vector<std::uint64_t> memory( padding + ( layout.size() + 7 ) / 8 );
+    std::memcpy( memory.data() + padding, layout.data(), layout.size() );
+    return memory;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( flat_layout )
+{
+  std::mt19937 gen(std::random_device{}());
+
+  for( int ii = 0; ii < 20; ++ii )
+  {
+    auto const data = random_flat_data( gen );
+    auto const layout = build_flat( data );
+
+    // The same bytes are valid wherever they are placed
+    for( std::size_t padding : { 0, 3 } )
+    {
+      auto const memory = place_flat( layout, padding );
+      auto const begin = reinterpret_cast<const char *>( memory.data() + padding );
+      check_flat( data, cereal::FlatView<FlatTable>( begin, layout.size() ) );
+      check_flat( data, cereal::FlatView<FlatTable>( begin, layout.size(), false ) );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( flat_layout_empty )
+{
+  cereal::FlatBuilder builder;
+  auto table = builder.create<FlatTable>();
+  builder.link( table, &FlatTable::values, builder.createArray<std::int16_t>( 0 ) );
+  auto const layout = builder.finish( table );
+  auto const memory = place_flat( layout, 0 );
+
+  cereal::FlatView<FlatTable> view( reinterpret_cast<const char *>( memory.data() ), layout.size() );
+  BOOST_CHECK( view->entries.empty() );
+  BOOST_CHECK( view->values.empty() );
+  BOOST_CHECK( view->values.begin() == view->values.end() );
+  BOOST_CHECK_EQUAL( view->entries.size(), 0u );
+
+  // The builder can be used again after finishing
+  auto again = builder.create<FlatTable>();
+  builder.get( again ).version = 3;
+  auto const second = builder.finish( again );
+  auto const secondMemory = place_flat( second, 0 );
+  BOOST_CHECK_EQUAL( cereal::FlatView<FlatTable>( reinterpret_cast<const char *>( secondMemory.data() ), second.size() )->version, 3u );
+}
+
+BOOST_AUTO_TEST_CASE( flat_layout_invalid )
+{
+  std::mt19937 gen(std::random_device{}());
+  auto data = random_flat_data( gen );
+  data.values.push_back( 1 );
+  auto const layout = build_flat( data );
+
+  auto open = []( std::vector<char> const & bytes, bool verify )
+  {
+    auto const memory = place_flat( bytes, 0 );
+    cereal::FlatView<FlatTable>( reinterpret_cast<const char *>( memory.data() ), bytes.size(), verify );
+  };
+
+  // Truncated
+  BOOST_CHECK_THROW( open( std::vector<char>( layout.begin(), layout.begin() + 8 ), true ), cereal::Exception );
+  {
+    auto const memory = place_flat( layout, 0 );
+    BOOST_CHECK_THROW( cereal::FlatView<FlatTable>( reinterpret_cast<const char *>( memory.data() ), layout.size() - 1 ), cereal::Exception );
+  }
+
+  // Not a flat layout
+  {
+    auto bytes = layout;
+    bytes[0] ^= 1;
+    BOOST_CHECK_THROW( open( bytes, true ), cereal::Exception );
+  }
+
+  // Misaligned in memory
+  {
+    auto const memory = place_flat( layout, 1 );
+    BOOST_CHECK_THROW( cereal::FlatView<FlatTable>( reinterpret_cast<const char *>( memory.data() ) + 4, layout.size() ), cereal::Exception );
+  }
+
+  // Read as the wrong root type
+  {
+    auto const memory = place_flat( layout, 0 );
+    BOOST_CHECK_THROW( cereal::FlatView<FlatEntry>( reinterpret_cast<const char *>( memory.data() ), layout.size() ), cereal::Exception );
+  }
+
+  // An array pointing outside of the layout is found when verifying
+  {
+    auto bytes = layout;
+    std::uint64_t root;
+    std::memcpy( &root, bytes.data() + 16, sizeof(root) );
+    std::uint64_t count = 1u << 30;
+    std::memcpy( bytes.data() + root + offsetof( FlatTable, values ) + 8, &count, sizeof(count) );
+    BOOST_CHECK_THROW( open( bytes, true ), cereal::Exception );
+    BOOST_CHECK_NO_THROW( open( bytes, false ) );
+  }
+}
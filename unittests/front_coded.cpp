@@ -0,0 +1,148 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/types/front_coded.hpp>
+#include <cereal/archives/compact_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+template <class IArchive, class OArchive, class T>
+void test_front_coded_container( T const & o_container )
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::front_coded( o_container ) );
+  }
+
+  T i_container;
+  i_container.insert( i_container.end(), *o_container.begin() );
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::front_coded( i_container ) );
+  }
+
+  BOOST_CHECK( i_container == o_container );
+}
+
+template <class IArchive, class OArchive>
+void test_front_coded()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<10; ++ii)
+  {
+    // paths sharing long prefixes, along with the empty string and repeated keys
+    std::map<std::string, int> o_map;
+    std::multimap<std::string, std::string> o_multimap;
+    std::set<std::string> o_set;
+    std::multiset<std::string> o_multiset;
+    for(int j=0; j<200; ++j)
+    {
+      std::string path = "/tenant" + std::to_string( gen() % 4 ) + "/region" + std::to_string( gen() % 8 ) +
+                         "/service/" + random_basic_string<char>( gen );
+      o_map[path] = random_value<int>(gen);
+      o_multimap.emplace( path, random_basic_string<char>( gen ) );
+      o_multimap.emplace( path, random_basic_string<char>( gen ) );
+      o_set.insert( path );
+      o_multiset.insert( path );
+      o_multiset.insert( path );
+    }
+    o_map[""] = 1;
+    o_set.insert( "" );
+
+    test_front_coded_container<IArchive, OArchive>( o_map );
+    test_front_coded_container<IArchive, OArchive>( o_multimap );
+    test_front_coded_container<IArchive, OArchive>( o_set );
+    test_front_coded_container<IArchive, OArchive>( o_multiset );
+    test_front_coded_container<IArchive, OArchive>( std::set<std::string>( { "" } ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_front_coded )
+{
+  test_front_coded<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_front_coded )
+{
+  test_front_coded<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( compact_binary_front_coded )
+{
+  test_front_coded<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_front_coded )
+{
+  test_front_coded<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_front_coded )
+{
+  test_front_coded<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_front_coded_size )
+{
+  std::set<std::string> paths;
+  for(int j=0; j<1000; ++j)
+    paths.insert( "/tenant/region/service/endpoint/" + std::to_string( j ) );
+
+  std::ostringstream plain, coded;
+  {
+    cereal::BinaryOutputArchive oar(plain);
+    oar( paths );
+  }
+  {
+    cereal::BinaryOutputArchive oar(coded);
+    oar( cereal::front_coded( paths ) );
+  }
+
+  BOOST_CHECK_LT( coded.str().size() * 4, plain.str().size() );
+}
+
+BOOST_AUTO_TEST_CASE( binary_front_coded_malformed )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+
+    // a second key that shares more characters than the first one holds
+    std::uint8_t const keys[] = { 0, 1, 'a', 2, 0 };
+    oar( cereal::make_size_tag( static_cast<cereal::size_type>( 2 ) ),
+         cereal::make_size_tag( static_cast<cereal::size_type>( sizeof(keys) ) ),
+         cereal::binary_data( &keys[0], sizeof(keys) ) );
+  }
+
+  std::set<std::string> keys;
+  std::istringstream is(os.str());
+  cereal::BinaryInputArchive iar(is);
+  BOOST_CHECK_THROW( iar( cereal::front_coded( keys ) ), cereal::Exception );
+}
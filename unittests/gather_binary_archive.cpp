@@ -0,0 +1,145 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/gather_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct GatherMessage
+{
+  std::uint32_t id;
+  std::string topic;
+  std::vector<std::uint8_t> payload;
+  std::map<std::string, int> headers;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( id, topic, cereal::referenced( payload ), headers );
+  }
+};
+
+inline std::string gather_concatenate( std::vector<cereal::GatherBinaryOutputArchive::Segment> const & segments )
+{
+  std::string result;
+  for( auto const & s : segments )
+    result.append( static_cast<const char *>( s.data ), s.size );
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE( gather_binary_matches_binary )
+{
+  std::mt19937 gen(std::random_device{}());
+
+  GatherMessage o_message;
+  o_message.id = random_value<std::uint32_t>(gen);
+  o_message.topic = random_basic_string<char>(gen);
+  o_message.payload.resize( 100000 );
+  for( auto & b : o_message.payload )
+    b = random_value<std::uint8_t>(gen);
+  for( int i = 0; i < 10; ++i )
+    o_message.headers[random_basic_string<char>(gen)] = random_value<int>(gen);
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar( o_message, 42 );
+  }
+
+  cereal::GatherBinaryOutputArchive gar;
+  gar( o_message, 42 );
+  auto const & segments = gar.segments();
+
+  // the payload is left in place between the copied header and trailer
+  BOOST_REQUIRE_EQUAL( segments.size(), 3u );
+  BOOST_CHECK( segments[1].data == o_message.payload.data() );
+  BOOST_CHECK_EQUAL( segments[1].size, o_message.payload.size() );
+  BOOST_CHECK_EQUAL( gar.bytesWritten(), os.str().size() );
+  BOOST_CHECK_EQUAL( gar.bytesCopied(), os.str().size() - o_message.payload.size() );
+  BOOST_CHECK( gather_concatenate( segments ) == os.str() );
+
+  GatherMessage i_message;
+  int after;
+  std::istringstream is( gather_concatenate( segments ) );
+  {
+    cereal::BinaryInputArchive iar( is );
+    iar( i_message, after );
+  }
+
+  BOOST_CHECK_EQUAL( i_message.id, o_message.id );
+  BOOST_CHECK_EQUAL( i_message.topic, o_message.topic );
+  BOOST_CHECK( i_message.payload == o_message.payload );
+  BOOST_CHECK( i_message.headers == o_message.headers );
+  BOOST_CHECK_EQUAL( after, 42 );
+
+  // after a reset the archive starts over
+  gar.reset();
+  BOOST_CHECK( gar.segments().empty() );
+  gar( std::int32_t( 7 ) );
+  BOOST_CHECK_EQUAL( gar.bytesWritten(), sizeof(std::int32_t) );
+  BOOST_CHECK_EQUAL( gar.segments().size(), 1u );
+}
+
+BOOST_AUTO_TEST_CASE( gather_binary_threshold )
+{
+  std::string small( 100, 'x' );
+  std::vector<double> large( 100, 1.5 );
+
+  cereal::GatherBinaryOutputArchive gar( cereal::GatherBinaryOutputArchive::Options( 512 ) );
+  gar( cereal::referenced( small ), cereal::referenced( large ) );
+
+  // the small string is copied along with the size tags around it
+  auto const & segments = gar.segments();
+  BOOST_REQUIRE_EQUAL( segments.size(), 2u );
+  BOOST_CHECK_EQUAL( segments[0].size, 2 * sizeof(cereal::size_type) + small.size() );
+  BOOST_CHECK( segments[1].data == large.data() );
+}
+
+BOOST_AUTO_TEST_CASE( gather_binary_referenced_other_archives )
+{
+  GatherMessage o_message;
+  o_message.id = 3;
+  o_message.topic = "topic";
+  o_message.payload = { 1, 2, 3 };
+  o_message.headers["key"] = 4;
+
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar( os );
+    oar( o_message );
+  }
+
+  GatherMessage i_message;
+  std::istringstream is( os.str() );
+  {
+    cereal::JSONInputArchive iar( is );
+    iar( i_message );
+  }
+
+  BOOST_CHECK_EQUAL( i_message.id, o_message.id );
+  BOOST_CHECK( i_message.payload == o_message.payload );
+  BOOST_CHECK( i_message.headers == o_message.headers );
+}
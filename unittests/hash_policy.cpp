@@ -0,0 +1,122 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+template <class IArchive, class OArchive, class T>
+void test_hash_policy_container( T const & o_container )
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::with_hash_policy( o_container ) );
+  }
+
+  T i_container;
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::with_hash_policy( i_container ) );
+  }
+
+  BOOST_CHECK( i_container == o_container );
+  BOOST_CHECK_EQUAL( i_container.bucket_count(), o_container.bucket_count() );
+  BOOST_CHECK_EQUAL( i_container.max_load_factor(), o_container.max_load_factor() );
+}
+
+template <class IArchive, class OArchive>
+void test_hash_policy()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::unordered_map<std::string, int> o_map;
+  std::unordered_multimap<int, StructInternalSerialize> o_multimap;
+  std::unordered_set<std::uint32_t> o_set;
+  std::unordered_multiset<std::string> o_multiset;
+
+  o_map.max_load_factor( 0.5f );
+  o_map.reserve( 5000 );
+  o_multimap.max_load_factor( 2.0f );
+  o_set.reserve( 100000 );
+  o_multiset.max_load_factor( 0.25f );
+
+  for(int j=0; j<100; ++j)
+  {
+    o_map.emplace( random_value<std::string>(gen), random_value<int>(gen) );
+    auto key = random_value<int>(gen);
+    o_multimap.emplace( key, StructInternalSerialize{ random_value<int>(gen), random_value<int>(gen) } );
+    o_multimap.emplace( key, StructInternalSerialize{ random_value<int>(gen), random_value<int>(gen) } );
+    o_set.insert( random_value<std::uint32_t>(gen) );
+    o_multiset.insert( random_value<std::string>(gen) );
+  }
+
+  test_hash_policy_container<IArchive, OArchive>( o_map );
+  test_hash_policy_container<IArchive, OArchive>( o_multimap );
+  test_hash_policy_container<IArchive, OArchive>( o_set );
+  test_hash_policy_container<IArchive, OArchive>( o_multiset );
+
+  // Without the wrapper, loading keeps buckets the target already has
+  std::unordered_set<std::uint32_t> i_set;
+  i_set.reserve( o_set.size() * 4 );
+  auto const bucketCount = i_set.bucket_count();
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_set );
+  }
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( i_set );
+  }
+
+  BOOST_CHECK( i_set == o_set );
+  BOOST_CHECK_EQUAL( i_set.bucket_count(), bucketCount );
+}
+
+BOOST_AUTO_TEST_CASE( binary_hash_policy )
+{
+  test_hash_policy<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_hash_policy )
+{
+  test_hash_policy<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_hash_policy )
+{
+  test_hash_policy<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_hash_policy )
+{
+  test_hash_policy<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
@@ -0,0 +1,306 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+template <class IArchive, class OArchive, class T>
+void save_and_load_in_place( T const & source, T & target, bool wrapSave )
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    if( wrapSave )
+      oar( cereal::in_place( source ) );
+    else
+      oar( source );
+  }
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::in_place( target ) );
+  }
+}
+
+template <class IArchive, class OArchive, class MapT>
+void test_in_place_map()
+{
+  MapT o_map;
+  for( int i = 0; i < 20; ++i )
+    o_map.emplace( i * 2, std::string( 40, char('a' + i) ) );
+  o_map.emplace( 4, "duplicate key for multimaps" );
+
+  MapT i_map;
+  save_and_load_in_place<IArchive, OArchive>( o_map, i_map, false );
+  BOOST_CHECK( i_map == o_map );
+
+  // Loading the same keys again reuses every element
+  std::vector<std::string const *> elements;
+  for( auto const & i : i_map )
+    elements.push_back( &i.second );
+
+  for( auto & i : o_map )
+    i.second[0] = 'z';
+  save_and_load_in_place<IArchive, OArchive>( o_map, i_map, true );
+  BOOST_CHECK( i_map == o_map );
+
+  std::size_t reused = 0;
+  for( auto const & i : i_map )
+    reused += std::find( elements.begin(), elements.end(), &i.second ) != elements.end();
+  BOOST_CHECK_EQUAL( reused, i_map.size() );
+
+  // Keys that are added and removed
+  o_map.erase( 0 );
+  o_map.erase( 10 );
+  o_map.erase( 38 );
+  o_map.emplace( -1, "first" );
+  o_map.emplace( 11, "middle" );
+  o_map.emplace( 100, "last" );
+  save_and_load_in_place<IArchive, OArchive>( o_map, i_map, true );
+  BOOST_CHECK( i_map == o_map );
+
+  o_map.clear();
+  save_and_load_in_place<IArchive, OArchive>( o_map, i_map, true );
+  BOOST_CHECK( i_map.empty() );
+}
+
+template <class IArchive, class OArchive, class SetT>
+void test_in_place_set()
+{
+  SetT o_set;
+  for( int i = 0; i < 20; ++i )
+    o_set.insert( i * 3 );
+  o_set.insert( 6 );
+
+  SetT i_set;
+  save_and_load_in_place<IArchive, OArchive>( o_set, i_set, false );
+  BOOST_CHECK( i_set == o_set );
+
+  std::vector<int const *> elements;
+  for( auto const & i : i_set )
+    elements.push_back( &i );
+
+  save_and_load_in_place<IArchive, OArchive>( o_set, i_set, true );
+  BOOST_CHECK( i_set == o_set );
+
+  std::size_t reused = 0;
+  for( auto const & i : i_set )
+    reused += std::find( elements.begin(), elements.end(), &i ) != elements.end();
+  BOOST_CHECK_EQUAL( reused, i_set.size() );
+
+  o_set.erase( 0 );
+  o_set.erase( 30 );
+  o_set.insert( -5 );
+  o_set.insert( 31 );
+  o_set.insert( 1000 );
+  save_and_load_in_place<IArchive, OArchive>( o_set, i_set, true );
+  BOOST_CHECK( i_set == o_set );
+}
+
+template <class IArchive, class OArchive>
+void test_in_place()
+{
+  test_in_place_map<IArchive, OArchive, std::map<int, std::string>>();
+  test_in_place_map<IArchive, OArchive, std::multimap<int, std::string>>();
+  test_in_place_map<IArchive, OArchive, std::unordered_map<int, std::string>>();
+  test_in_place_set<IArchive, OArchive, std::set<int>>();
+  test_in_place_set<IArchive, OArchive, std::multiset<int>>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_in_place )
+{
+  test_in_place<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_in_place )
+{
+  test_in_place<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_in_place )
+{
+  test_in_place<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_in_place )
+{
+  test_in_place<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+struct InPlaceShape
+{
+  virtual ~InPlaceShape() {}
+  virtual int sides() const = 0;
+
+  int id = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( id ); }
+};
+
+struct InPlaceSquare : InPlaceShape
+{
+  int sides() const { return 4; }
+
+  double side = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::base_class<InPlaceShape>( this ), side ); }
+};
+
+struct InPlaceTriangle : InPlaceShape
+{
+  int sides() const { return 3; }
+
+  double base = 0, height = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::base_class<InPlaceShape>( this ), base, height ); }
+};
+
+CEREAL_REGISTER_TYPE(InPlaceSquare)
+CEREAL_REGISTER_TYPE(InPlaceTriangle)
+
+struct InPlaceState
+{
+  std::unique_ptr<std::vector<int>> values;
+  std::shared_ptr<std::string> name;
+  std::unique_ptr<InPlaceShape> shape;
+  std::shared_ptr<InPlaceShape> shared;
+  std::unique_ptr<InPlaceSquare> square;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  { ar( values, name, shape, shared, square ); }
+
+  template <class Archive>
+  void load( Archive & ar )
+  {
+    ar( cereal::in_place( values ), cereal::in_place( name ), cereal::in_place( shape ),
+        cereal::in_place( shared ), cereal::in_place( square ) );
+  }
+};
+
+template <class IArchive, class OArchive>
+void reload_state( InPlaceState const & source, InPlaceState & target )
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( source );
+  }
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( target );
+  }
+}
+
+template <class IArchive, class OArchive>
+void test_in_place_pointers()
+{
+  InPlaceState o_state;
+  o_state.values.reset( new std::vector<int>{ 1, 2, 3 } );
+  o_state.name = std::make_shared<std::string>( "first" );
+  o_state.shape.reset( new InPlaceSquare );
+  o_state.shared = std::make_shared<InPlaceTriangle>();
+  o_state.square.reset( new InPlaceSquare );
+
+  InPlaceState i_state;
+  reload_state<IArchive, OArchive>( o_state, i_state );
+  BOOST_REQUIRE( i_state.values && i_state.name && i_state.shape && i_state.shared && i_state.square );
+
+  auto const values = i_state.values.get();
+  auto const name = i_state.name.get();
+  auto const shape = i_state.shape.get();
+  auto const shared = i_state.shared.get();
+  auto const square = i_state.square.get();
+
+  // Objects of the same dynamic type are loaded into
+  o_state.values->push_back( 4 );
+  *o_state.name = "second";
+  o_state.shape->id = 7;
+  static_cast<InPlaceSquare &>( *o_state.shape ).side = 2.5;
+  static_cast<InPlaceTriangle &>( *o_state.shared ).height = 1.5;
+  o_state.square->side = 3.5;
+  reload_state<IArchive, OArchive>( o_state, i_state );
+
+  BOOST_CHECK_EQUAL( i_state.values.get(), values );
+  BOOST_CHECK_EQUAL( i_state.name.get(), name );
+  BOOST_CHECK_EQUAL( i_state.shape.get(), shape );
+  BOOST_CHECK_EQUAL( i_state.shared.get(), shared );
+  BOOST_CHECK_EQUAL( i_state.square.get(), square );
+  BOOST_CHECK( *i_state.values == *o_state.values );
+  BOOST_CHECK_EQUAL( *i_state.name, "second" );
+  BOOST_CHECK_EQUAL( i_state.shape->id, 7 );
+  BOOST_CHECK_EQUAL( static_cast<InPlaceSquare &>( *i_state.shape ).side, 2.5 );
+  BOOST_CHECK_EQUAL( static_cast<InPlaceTriangle &>( *i_state.shared ).height, 1.5 );
+  BOOST_CHECK_EQUAL( i_state.square->side, 3.5 );
+
+  // A different dynamic type, or an object owned elsewhere, is replaced
+  o_state.shape.reset( new InPlaceTriangle );
+  auto const other = i_state.name;
+  *o_state.name = "third";
+  reload_state<IArchive, OArchive>( o_state, i_state );
+
+  BOOST_CHECK_EQUAL( i_state.shape->sides(), 3 );
+  BOOST_CHECK_EQUAL( *i_state.name, "third" );
+  BOOST_CHECK_EQUAL( *other, "second" );
+
+  // Null pointers are loaded as null
+  o_state.values.reset();
+  o_state.name.reset();
+  o_state.shape.reset();
+  o_state.shared.reset();
+  o_state.square.reset();
+  reload_state<IArchive, OArchive>( o_state, i_state );
+  BOOST_CHECK( !i_state.values && !i_state.name && !i_state.shape && !i_state.shared && !i_state.square );
+}
+
+BOOST_AUTO_TEST_CASE( binary_in_place_pointers )
+{
+  test_in_place_pointers<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_in_place_pointers )
+{
+  test_in_place_pointers<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_in_place_pointers )
+{
+  test_in_place_pointers<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_in_place_pointers )
+{
+  test_in_place_pointers<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
@@ -0,0 +1,148 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/indexed_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct IndexedSnapshot
+{
+  int id;
+  cereal::indexed_vector<std::string> names;
+  cereal::indexed_vector<StructInternalSerialize> structs;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( id, names, structs );
+  }
+};
+
+BOOST_AUTO_TEST_CASE( indexed_binary_entries )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::string> o_strings;
+  for( int i = 0; i < 100; ++i )
+    o_strings.push_back( random_basic_string<char>(gen) );
+
+  std::stringstream ss;
+  ss << "prefix";
+  {
+    cereal::IndexedBinaryOutputArchive oar( ss );
+    for( size_t i = 0; i < o_strings.size(); ++i )
+      oar.writeEntry( o_strings[i], std::make_shared<int>( static_cast<int>( i ) ) );
+  }
+
+  std::istringstream is( ss.str() );
+  is.seekg( 6 );
+  cereal::IndexedBinaryInputArchive iar( is );
+  BOOST_REQUIRE_EQUAL( iar.entryCount(), o_strings.size() );
+
+  // entries can be loaded in any order, each on its own
+  for( size_t i = o_strings.size(); i-- > 0; )
+  {
+    std::string str;
+    std::shared_ptr<int> ptr;
+    iar.loadEntry( i, str, ptr );
+    BOOST_CHECK_EQUAL( str, o_strings[i] );
+    BOOST_CHECK_EQUAL( *ptr, static_cast<int>( i ) );
+  }
+
+  std::string str;
+  BOOST_CHECK_THROW( iar.loadEntry( o_strings.size(), str ), cereal::Exception );
+}
+
+BOOST_AUTO_TEST_CASE( indexed_binary_lazy_vector )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  IndexedSnapshot o_snapshot;
+  o_snapshot.id = 3;
+  std::vector<std::string> o_names;
+  std::vector<StructInternalSerialize> o_structs;
+  for( int i = 0; i < 50; ++i )
+  {
+    o_names.push_back( random_basic_string<char>(gen) );
+    o_structs.emplace_back( random_value<int>(gen), random_value<int>(gen) );
+  }
+  o_snapshot.names = o_names;
+  o_snapshot.structs = o_structs;
+
+  std::stringstream ss;
+  {
+    cereal::IndexedBinaryOutputArchive oar( ss );
+    oar.writeEntry( o_snapshot, 17 );
+    oar.finish();
+  }
+
+  cereal::IndexedBinaryInputArchive iar( ss );
+  IndexedSnapshot i_snapshot;
+  int after;
+  iar.loadEntry( 0, i_snapshot, after );
+
+  BOOST_CHECK_EQUAL( i_snapshot.id, 3 );
+  BOOST_CHECK_EQUAL( after, 17 );
+  BOOST_CHECK( i_snapshot.names.lazy() );
+  BOOST_REQUIRE_EQUAL( i_snapshot.names.size(), o_names.size() );
+  BOOST_REQUIRE_EQUAL( i_snapshot.structs.size(), o_structs.size() );
+
+  for( size_t i = 0; i < o_names.size(); i += 7 )
+  {
+    BOOST_CHECK_EQUAL( i_snapshot.names.load( i ), o_names[i] );
+    BOOST_CHECK_EQUAL( i_snapshot.structs.load( o_structs.size() - 1 - i ), o_structs[o_structs.size() - 1 - i] );
+  }
+  BOOST_CHECK_THROW( i_snapshot.names.load( o_names.size() ), cereal::Exception );
+
+  // other archives hold the whole vector, which a lazy vector can be saved to
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar( i_snapshot );
+  }
+
+  IndexedSnapshot b_snapshot;
+  std::istringstream is( os.str() );
+  {
+    cereal::BinaryInputArchive bar( is );
+    bar( b_snapshot );
+  }
+
+  BOOST_CHECK( !b_snapshot.names.lazy() );
+  BOOST_CHECK_EQUAL_COLLECTIONS( o_names.begin(), o_names.end(), b_snapshot.names.values().begin(), b_snapshot.names.values().end() );
+  BOOST_CHECK_EQUAL( b_snapshot.structs.load( 4 ), o_structs[4] );
+}
+
+BOOST_AUTO_TEST_CASE( indexed_binary_invalid )
+{
+  std::istringstream empty( "" );
+  BOOST_CHECK_THROW( cereal::IndexedBinaryInputArchive iar( empty ), cereal::Exception );
+
+  std::istringstream garbage( std::string( 64, 'x' ) );
+  BOOST_CHECK_THROW( cereal::IndexedBinaryInputArchive iar( garbage ), cereal::Exception );
+}
@@ -0,0 +1,163 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/compact_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct InternedTrade
+{
+  std::string symbol;
+  std::string venue;
+  int quantity;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( CEREAL_NVP_("symbol", cereal::interned( symbol )),
+        CEREAL_NVP_("venue", cereal::interned( venue )),
+        CEREAL_NVP(quantity) );
+  }
+
+  bool operator==( InternedTrade const & other ) const
+  {
+    return symbol == other.symbol && venue == other.venue && quantity == other.quantity;
+  }
+};
+
+template <class IArchive, class OArchive>
+void test_interned()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::string> symbols;
+  for(int j=0; j<10; ++j)
+    symbols.push_back( random_basic_string<char>(gen) );
+
+  std::vector<InternedTrade> o_trades;
+  for(int j=0; j<1000; ++j)
+    o_trades.push_back( { symbols[gen() % symbols.size()], j % 3 ? "XNAS" : "XNYS", random_value<int>(gen) } );
+  o_trades.push_back( { "", "", 0 } );
+
+  std::string const o_single = symbols.front();
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_trades );
+    oar( cereal::interned( o_single ) );
+  }
+
+  std::vector<InternedTrade> i_trades;
+  std::string i_single;
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( i_trades );
+    iar( cereal::interned( i_single ) );
+  }
+
+  BOOST_CHECK( i_trades == o_trades );
+  BOOST_CHECK_EQUAL( i_single, o_single );
+}
+
+BOOST_AUTO_TEST_CASE( binary_interned )
+{
+  test_interned<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_interned )
+{
+  test_interned<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( compact_binary_interned )
+{
+  test_interned<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_interned )
+{
+  test_interned<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_interned )
+{
+  test_interned<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_interned_size )
+{
+  std::string const symbol( 100, 's' );
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    for(int j=0; j<10; ++j)
+      oar( cereal::interned( symbol ) );
+  }
+
+  // the string is saved once, followed by nine ids
+  BOOST_CHECK_EQUAL( os.str().size(), 10 * sizeof(std::uint32_t) + sizeof(cereal::size_type) + symbol.size() );
+}
+
+BOOST_AUTO_TEST_CASE( binary_interned_reset )
+{
+  std::string const symbol = "symbol";
+
+  std::ostringstream os1, os2;
+  cereal::BinaryOutputArchive oar(os1);
+  oar( cereal::interned( symbol ) );
+  oar.reset( os2 );
+  oar( cereal::interned( symbol ) );
+
+  // after a reset the string is saved in full again
+  BOOST_CHECK_EQUAL( os1.str(), os2.str() );
+
+  std::istringstream is1(os1.str()), is2(os2.str());
+  std::string loaded;
+  cereal::BinaryInputArchive iar(is1);
+  iar( cereal::interned( loaded ) );
+  iar.reset( is2 );
+  iar( cereal::interned( loaded ) );
+  BOOST_CHECK_EQUAL( loaded, symbol );
+}
+
+BOOST_AUTO_TEST_CASE( binary_interned_unknown_id )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( std::uint32_t( 5 ) );
+  }
+
+  std::string loaded;
+  std::istringstream is(os.str());
+  cereal::BinaryInputArchive iar(is);
+  BOOST_CHECK_THROW( iar( cereal::interned( loaded ) ), cereal::Exception );
+}
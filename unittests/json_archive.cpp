@@ -0,0 +1,319 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+BOOST_AUTO_TEST_CASE( json_compact_output )
+{
+  std::vector<int> const o_vector = { 1, 2, 3 };
+  StructInternalSerialize const o_struct( 4, 5 );
+  std::map<std::string, double> const o_map = { { "a", 0.5 } };
+
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar( os, cereal::JSONOutputArchive::Options::Compact() );
+    oar( cereal::make_nvp("vector", o_vector), cereal::make_nvp("struct", o_struct), cereal::make_nvp("map", o_map),
+         cereal::make_nvp("empty", std::vector<int>()) );
+  }
+
+  BOOST_CHECK_EQUAL( os.str(),
+    "{\"vector\":[1,2,3],\"struct\":{\"value0\":4,\"value1\":5},\"map\":[{\"key\":\"a\",\"value\":0.5}],\"empty\":[]}" );
+
+  std::vector<int> i_vector;
+  StructInternalSerialize i_struct;
+  std::map<std::string, double> i_map;
+
+  std::istringstream is( os.str() );
+  {
+    cereal::JSONInputArchive iar( is );
+    iar( cereal::make_nvp("vector", i_vector), cereal::make_nvp("struct", i_struct), cereal::make_nvp("map", i_map) );
+  }
+
+  BOOST_CHECK_EQUAL_COLLECTIONS( o_vector.begin(), o_vector.end(), i_vector.begin(), i_vector.end() );
+  BOOST_CHECK_EQUAL( o_struct, i_struct );
+  BOOST_CHECK( o_map == i_map );
+}
+
+BOOST_AUTO_TEST_CASE( json_no_indent_output )
+{
+  // without indentation the pretty writer still separates values with newlines
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar( os, cereal::JSONOutputArchive::Options::NoIndent() );
+    oar( cereal::make_nvp("value", 1) );
+  }
+
+  BOOST_CHECK_EQUAL( os.str(), "{\n\"value\": 1\n}" );
+}
+
+BOOST_AUTO_TEST_CASE( json_insitu_input )
+{
+  std::vector<int> const o_vector = { 1, 2, 3 };
+  std::string const o_string = "escaped \"quotes\"\nand lines";
+
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar( os );
+    oar( cereal::make_nvp("vector", o_vector), cereal::make_nvp("string", o_string), cereal::make_nvp("ref", o_string) );
+  }
+
+  std::string const json = os.str();
+  std::vector<char> buffer( json.begin(), json.end() );
+  buffer.push_back( '\0' );
+
+  std::vector<int> i_vector;
+  std::string i_string;
+  const char * ref;
+  size_t refSize;
+  {
+    cereal::JSONInputArchive iar( buffer.data() );
+    iar( cereal::make_nvp("vector", i_vector), cereal::make_nvp("string", i_string) );
+    iar.loadStringRef( ref, refSize, "ref" );
+
+    BOOST_CHECK( ref >= buffer.data() && ref < buffer.data() + buffer.size() );
+    BOOST_CHECK_EQUAL( std::string( ref, refSize ), o_string );
+  }
+
+  BOOST_CHECK_EQUAL_COLLECTIONS( o_vector.begin(), o_vector.end(), i_vector.begin(), i_vector.end() );
+  BOOST_CHECK_EQUAL( i_string, o_string );
+}
+
+BOOST_AUTO_TEST_CASE( json_generated_names )
+{
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar( os, cereal::JSONOutputArchive::Options::Compact() );
+    for( int i = 0; i < 12; ++i )
+      oar( i );
+  }
+
+  BOOST_CHECK_EQUAL( os.str(),
+    "{\"value0\":0,\"value1\":1,\"value2\":2,\"value3\":3,\"value4\":4,\"value5\":5,"
+    "\"value6\":6,\"value7\":7,\"value8\":8,\"value9\":9,\"value10\":10,\"value11\":11}" );
+}
+
+BOOST_AUTO_TEST_CASE( json_string_output )
+{
+  std::mt19937 gen(std::random_device{}());
+
+  // enough output to fill the write chunk many times over
+  std::vector<std::string> o_strings;
+  for( int i = 0; i < 1000; ++i )
+    o_strings.push_back( random_basic_string<char>(gen) );
+  std::map<std::string, int> o_map;
+  for( int i = 0; i < 100; ++i )
+    o_map[random_basic_string<char>(gen)] = random_value<int>(gen);
+
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar( os );
+    oar( o_strings, o_map );
+  }
+
+  // the string is appended to
+  std::string str = "prefix";
+  {
+    cereal::JSONOutputArchive oar( str );
+    oar( o_strings, o_map );
+  }
+
+  BOOST_CHECK_GT( os.str().size(), 4096u * 4 );
+  BOOST_CHECK( str == "prefix" + os.str() );
+
+  std::vector<std::string> i_strings;
+  std::map<std::string, int> i_map;
+  {
+    std::istringstream is( str.substr( 6 ) );
+    cereal::JSONInputArchive iar( is );
+    iar( i_strings, i_map );
+  }
+
+  BOOST_CHECK_EQUAL_COLLECTIONS( o_strings.begin(), o_strings.end(), i_strings.begin(), i_strings.end() );
+  BOOST_CHECK( i_map == o_map );
+
+  // a stream that cannot be written to is marked bad
+  std::filebuf closed;
+  std::ostream bad( &closed );
+  {
+    cereal::JSONOutputArchive oar( bad );
+    oar( o_strings );
+  }
+  BOOST_CHECK( bad.bad() );
+}
+
+BOOST_AUTO_TEST_CASE( json_value_input )
+{
+  std::mt19937 gen(std::random_device{}());
+
+  std::vector<int> o_vector( 10 );
+  for( auto & i : o_vector )
+    i = random_value<int>(gen);
+  std::string o_string = random_basic_string<char>(gen);
+  StructInternalSerialize o_struct( random_value<int>(gen), random_value<int>(gen) );
+
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar( os );
+    oar( cereal::make_nvp("vector", o_vector),
+         cereal::make_nvp("string", o_string),
+         cereal::make_nvp("struct", o_struct) );
+  }
+
+  // the archive's output is one member of a larger document
+  std::string const envelope = "{\"id\": 7, \"payload\": " + os.str() + ", \"tail\": [1, 2]}";
+  rapidjson::Document document;
+  document.Parse<0>( envelope.c_str() );
+  BOOST_REQUIRE( !document.HasParseError() );
+
+  std::vector<int> i_vector;
+  std::string i_string;
+  StructInternalSerialize i_struct;
+  {
+    cereal::JSONInputArchive iar( document["payload"] );
+    iar( cereal::make_nvp("struct", i_struct),
+         cereal::make_nvp("vector", i_vector),
+         cereal::make_nvp("string", i_string) );
+  }
+
+  BOOST_CHECK_EQUAL_COLLECTIONS( o_vector.begin(), o_vector.end(), i_vector.begin(), i_vector.end() );
+  BOOST_CHECK_EQUAL( i_string, o_string );
+  BOOST_CHECK( i_struct == o_struct );
+
+  // a whole document is a value too
+  {
+    cereal::JSONInputArchive iar( document );
+    int id = 0;
+    iar( cereal::make_nvp("id", id) );
+    BOOST_CHECK_EQUAL( id, 7 );
+  }
+
+  rapidjson::Value const & tail = document["tail"];
+  BOOST_CHECK_THROW( cereal::JSONInputArchive iar( tail ), cereal::Exception );
+}
+
+BOOST_AUTO_TEST_CASE( json_binary_arithmetic )
+{
+  std::mt19937 gen(std::random_device{}());
+
+  std::vector<double> o_doubles(100);
+  for( auto & d : o_doubles )
+    d = random_value<double>(gen);
+  std::vector<std::int32_t> o_ints(100);
+  for( auto & i : o_ints )
+    i = random_value<std::int32_t>(gen);
+  std::vector<std::uint8_t> o_empty;
+  std::array<std::uint16_t, 5> o_array = {{ 1, 2, 3, 65535, 0 }};
+
+  for( bool blobs : { false, true } )
+  {
+    std::ostringstream os;
+    {
+      cereal::JSONOutputArchive oar( os, cereal::JSONOutputArchive::Options( 17, cereal::JSONOutputArchive::Options::IndentChar::space, 4, false, blobs ) );
+      oar( cereal::make_nvp("doubles", o_doubles),
+           cereal::make_nvp("ints", o_ints),
+           cereal::make_nvp("empty", o_empty),
+           cereal::make_nvp("array", o_array) );
+    }
+
+    BOOST_CHECK_EQUAL( os.str().find( "\"type\": \"f64\"" ) != std::string::npos, blobs );
+    BOOST_CHECK_EQUAL( os.str().find( "\"type\": \"u16\"" ) != std::string::npos, blobs );
+
+    std::vector<double> i_doubles;
+    std::vector<std::int32_t> i_ints;
+    std::vector<std::uint8_t> i_empty = { 1 };
+    std::array<std::uint16_t, 5> i_array = {{}};
+    {
+      std::istringstream is( os.str() );
+      cereal::JSONInputArchive iar( is );
+      iar( cereal::make_nvp("doubles", i_doubles),
+           cereal::make_nvp("ints", i_ints),
+           cereal::make_nvp("empty", i_empty),
+           cereal::make_nvp("array", i_array) );
+    }
+
+    // blobs hold the exact bytes, numbers only the printed precision
+    if( blobs )
+      BOOST_CHECK_EQUAL_COLLECTIONS( o_doubles.begin(), o_doubles.end(), i_doubles.begin(), i_doubles.end() );
+    else
+      BOOST_CHECK_EQUAL( i_doubles.size(), o_doubles.size() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( o_ints.begin(), o_ints.end(), i_ints.begin(), i_ints.end() );
+    BOOST_CHECK( i_empty.empty() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( o_array.begin(), o_array.end(), i_array.begin(), i_array.end() );
+  }
+
+  // the element type and the size of the blob are checked
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar( os, cereal::JSONOutputArchive::Options( 17, cereal::JSONOutputArchive::Options::IndentChar::space, 4, false, true ) );
+    oar( cereal::make_nvp("ints", o_ints) );
+  }
+
+  {
+    std::istringstream is( os.str() );
+    cereal::JSONInputArchive iar( is );
+    std::vector<float> i_floats;
+    BOOST_CHECK_THROW( iar( cereal::make_nvp("ints", i_floats) ), cereal::Exception );
+  }
+
+  {
+    std::istringstream is( os.str() );
+    cereal::JSONInputArchive iar( is );
+    std::array<std::int32_t, 3> i_short;
+    BOOST_CHECK_THROW( iar( cereal::make_nvp("ints", i_short) ), cereal::Exception );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( json_blob_hostile_size )
+{
+  // a blob claiming far more elements than its data holds is rejected before anything is allocated
+  {
+    std::istringstream is( R"({"values": {"type": "f64", "size": 1000000000000, "data": ""}})" );
+    cereal::JSONInputArchive iar( is );
+    std::vector<double> i_values;
+    BOOST_CHECK_THROW( iar( cereal::make_nvp("values", i_values) ), cereal::Exception );
+    BOOST_CHECK( i_values.capacity() == 0 );
+  }
+
+  // and its size counts against the load limits
+  std::vector<double> const o_values( 20, 1.5 );
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar( os, cereal::JSONOutputArchive::Options( 17, cereal::JSONOutputArchive::Options::IndentChar::space, 4, false, true ) );
+    oar( cereal::make_nvp("values", o_values) );
+  }
+
+  cereal::LoadLimits limits;
+  limits.maxElements = 10;
+
+  std::istringstream is( os.str() );
+  cereal::JSONInputArchive iar( is );
+  iar.setLoadLimits( limits );
+  std::vector<double> i_values;
+  BOOST_CHECK_THROW( iar( cereal::make_nvp("values", i_values) ), cereal::Exception );
+  BOOST_CHECK( i_values.capacity() == 0 );
+}
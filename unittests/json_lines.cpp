@@ -0,0 +1,127 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/json_lines.hpp>
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE( json_lines_round_trip )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::map<std::string, int>> o_maps;
+  std::vector<StructInternalSerialize> o_structs;
+  for( int i = 0; i < 100; ++i )
+  {
+    o_maps.push_back( { { random_basic_string<char>(gen), random_value<int>(gen) } } );
+    o_structs.emplace_back( random_value<int>(gen), random_value<int>(gen) );
+  }
+
+  std::stringstream ss;
+  {
+    cereal::JSONLinesOutputArchive oar( ss );
+    for( size_t i = 0; i < o_maps.size(); ++i )
+      oar.writeRecord( cereal::make_nvp("map", o_maps[i]), cereal::make_nvp("struct", o_structs[i]) );
+  }
+
+  // one line per record, each of which is a document of its own
+  std::string const text = ss.str();
+  BOOST_CHECK_EQUAL( std::count( text.begin(), text.end(), '\n' ), 100 );
+
+  std::string line;
+  std::getline( ss, line );
+  {
+    std::istringstream is( line );
+    cereal::JSONInputArchive iar( is );
+    std::map<std::string, int> i_map;
+    StructInternalSerialize i_struct;
+    iar( cereal::make_nvp("map", i_map), cereal::make_nvp("struct", i_struct) );
+    BOOST_CHECK( i_map == o_maps.front() );
+    BOOST_CHECK_EQUAL( i_struct, o_structs.front() );
+  }
+
+  ss.seekg( 0 );
+  cereal::JSONLinesInputArchive iar( ss );
+  for( size_t i = 0; i < o_maps.size(); ++i )
+  {
+    std::map<std::string, int> i_map;
+    StructInternalSerialize i_struct;
+    BOOST_CHECK( iar.readRecord( cereal::make_nvp("map", i_map), cereal::make_nvp("struct", i_struct) ) );
+    BOOST_CHECK( i_map == o_maps[i] );
+    BOOST_CHECK_EQUAL( i_struct, o_structs[i] );
+  }
+
+  int unused;
+  BOOST_CHECK( !iar.readRecord( unused ) );
+}
+
+BOOST_AUTO_TEST_CASE( json_lines_independent_records )
+{
+  auto const o_shared = std::make_shared<int>( 5 );
+
+  std::stringstream ss;
+  {
+    cereal::JSONLinesOutputArchive oar( ss );
+    oar.writeRecord( o_shared );
+    oar.writeRecord( o_shared );
+    oar.writeRecord( 1, 2.5, std::string("three") );
+  }
+
+  // a shared pointer is written in full by every record saving it
+  std::string first, second;
+  std::getline( ss, first );
+  std::getline( ss, second );
+  BOOST_CHECK_EQUAL( first, second );
+
+  std::istringstream is( "\n" + first + "\n\n" + ss.str().substr( 2 * ( first.size() + 1 ) ) );
+  cereal::JSONLinesInputArchive iar( is );
+
+  std::shared_ptr<int> i_shared;
+  BOOST_CHECK( iar.readRecord( i_shared ) );
+  BOOST_CHECK_EQUAL( *i_shared, 5 );
+
+  int i_int;
+  double i_double;
+  std::string i_string;
+  BOOST_CHECK( iar.readRecord( i_int, i_double, i_string ) );
+  BOOST_CHECK_EQUAL( i_int, 1 );
+  BOOST_CHECK_EQUAL( i_double, 2.5 );
+  BOOST_CHECK_EQUAL( i_string, "three" );
+
+  BOOST_CHECK( !iar.readRecord( i_int ) );
+}
+
+BOOST_AUTO_TEST_CASE( json_lines_invalid_record )
+{
+  std::istringstream is( "{\"value0\": 1}\n[1, 2\n" );
+  cereal::JSONLinesInputArchive iar( is );
+
+  int value;
+  BOOST_CHECK( iar.readRecord( value ) );
+  BOOST_CHECK_EQUAL( value, 1 );
+  BOOST_CHECK_THROW( iar.readRecord( value ), cereal::Exception );
+}
@@ -193,3 +193,73 @@ BOOST_AUTO_TEST_CASE( json_memory_load_construct )
   test_memory_load_construct<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
 }
 
+
+struct CountedLA
+{
+  CountedLA( int xx ) : x( xx ) { ++alive; }
+  CountedLA( CountedLA const & ) = delete;
+  ~CountedLA() { --alive; }
+
+  int x;
+  static int alive;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+
+  template <class Archive>
+  static void load_and_construct( Archive & ar, cereal::construct<CountedLA> & construct )
+  {
+    int xx;
+    ar( xx );
+    if( xx < 0 )
+      throw cereal::Exception( "CountedLA: negative value" );
+    construct( xx );
+  }
+};
+
+int CountedLA::alive = 0;
+
+BOOST_AUTO_TEST_CASE( memory_load_construct_lifetime )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    auto good = std::make_shared<CountedLA>( 3 );
+    auto bad = std::make_shared<CountedLA>( -1 );
+    oar( good, good, bad );
+  }
+  BOOST_REQUIRE_EQUAL( CountedLA::alive, 0 );
+
+  std::istringstream is(os.str());
+  {
+    cereal::BinaryInputArchive iar(is);
+
+    std::shared_ptr<CountedLA> first, second, bad;
+    iar( first, second );
+    BOOST_CHECK_EQUAL( first.get(), second.get() );
+    BOOST_CHECK_EQUAL( first->x, 3 );
+    BOOST_CHECK_EQUAL( CountedLA::alive, 1 );
+
+    std::shared_ptr<CountedLA> untracked;
+    {
+      std::ostringstream uos;
+      {
+        cereal::BinaryOutputArchive oar(uos);
+        oar( cereal::untracked( first ) );
+      }
+      std::istringstream uis(uos.str());
+      cereal::BinaryInputArchive uiar(uis);
+      uiar( cereal::untracked( untracked ) );
+    }
+    BOOST_CHECK( untracked != first );
+    BOOST_CHECK_EQUAL( untracked->x, 3 );
+    BOOST_CHECK_EQUAL( CountedLA::alive, 2 );
+    untracked.reset();
+
+    // the storage for an object that was never constructed must not be destroyed as one
+    BOOST_CHECK_THROW( iar( bad ), cereal::Exception );
+    BOOST_CHECK_EQUAL( CountedLA::alive, 1 );
+  }
+  BOOST_CHECK_EQUAL( CountedLA::alive, 0 );
+}
@@ -0,0 +1,224 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/types/columnar.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  // a linked list whose loading recurses once per node
+  struct LimitsNode
+  {
+    int value;
+    std::unique_ptr<LimitsNode> next;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( value, next ); }
+  };
+
+  struct LimitsRecord
+  {
+    double price;
+    int quantity;
+  };
+
+  inline std::unique_ptr<LimitsNode> make_limits_list( int length )
+  {
+    std::unique_ptr<LimitsNode> head;
+    for( int i = 0; i < length; ++i )
+    {
+      std::unique_ptr<LimitsNode> node( new LimitsNode() );
+      node->value = i;
+      node->next = std::move( head );
+      head = std::move( node );
+    }
+    return head;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( load_limits_hostile_size )
+{
+  // a vector claiming 2^40 elements, with none following
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive ar( os );
+    ar( cereal::make_size_tag( static_cast<cereal::size_type>( 1 ) << 40 ) );
+  }
+
+  cereal::LoadLimits limits;
+  limits.maxElements = 1 << 20;
+
+  std::istringstream is( os.str() );
+  cereal::BinaryInputArchive ar( is );
+  ar.setLoadLimits( limits );
+  BOOST_CHECK_EQUAL( ar.getLoadLimits().maxElements, limits.maxElements );
+
+  std::vector<double> v;
+  BOOST_CHECK_THROW( ar( v ), cereal::Exception );
+  BOOST_CHECK( v.capacity() == 0 );
+}
+
+template <class IArchive, class OArchive> inline
+void test_load_limits()
+{
+  std::vector<int> const values( 100, 1 );
+  std::vector<int> const more( 50, 2 );
+
+  std::ostringstream os;
+  {
+    OArchive ar( os );
+    ar( cereal::make_nvp( "values", values ), cereal::make_nvp( "more", more ), cereal::make_nvp( "list", make_limits_list( 20 ) ) );
+  }
+
+  auto load = [&]( cereal::LoadLimits const & limits )
+  {
+    std::istringstream is( os.str() );
+    IArchive ar( is );
+    ar.setLoadLimits( limits );
+
+    std::vector<int> v, m;
+    std::unique_ptr<LimitsNode> list;
+    ar( cereal::make_nvp( "values", v ), cereal::make_nvp( "more", m ), cereal::make_nvp( "list", list ) );
+  };
+
+  cereal::LoadLimits limits;
+  BOOST_CHECK_NO_THROW( load( limits ) );
+
+  limits.maxElements = 100;
+  BOOST_CHECK_NO_THROW( load( limits ) );
+  limits.maxElements = 99;
+  BOOST_CHECK_THROW( load( limits ), cereal::Exception );
+
+  limits = cereal::LoadLimits();
+  limits.maxTotalElements = 150;
+  BOOST_CHECK_NO_THROW( load( limits ) );
+  limits.maxTotalElements = 149;
+  BOOST_CHECK_THROW( load( limits ), cereal::Exception );
+
+  // every node nests a few levels of wrappers, so 20 nodes need far more than 20 levels
+  limits = cereal::LoadLimits();
+  limits.maxDepth = 20;
+  BOOST_CHECK_THROW( load( limits ), cereal::Exception );
+  limits.maxDepth = 1000;
+  BOOST_CHECK_NO_THROW( load( limits ) );
+}
+
+BOOST_AUTO_TEST_CASE( binary_load_limits )
+{
+  test_load_limits<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_load_limits )
+{
+  test_load_limits<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_load_limits )
+{
+  test_load_limits<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_load_limits )
+{
+  test_load_limits<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( load_limits_reset )
+{
+  std::ostringstream first, second;
+  {
+    cereal::BinaryOutputArchive ar( first );
+    ar( std::string( 60, 'a' ) );
+  }
+  {
+    cereal::BinaryOutputArchive ar( second );
+    ar( std::string( 60, 'b' ) );
+  }
+
+  cereal::LoadLimits limits;
+  limits.maxTotalElements = 100;
+
+  std::istringstream is( first.str() + second.str() );
+  cereal::BinaryInputArchive ar( is );
+  ar.setLoadLimits( limits );
+
+  std::string s;
+  ar( s );
+  BOOST_CHECK_THROW( ar( s ), cereal::Exception );
+
+  // the total starts over for each message
+  std::istringstream is2( second.str() );
+  ar.reset( is2 );
+  BOOST_CHECK_NO_THROW( ar( s ) );
+  BOOST_CHECK_EQUAL( s, std::string( 60, 'b' ) );
+  BOOST_CHECK_EQUAL( ar.getLoadLimits().maxTotalElements, 100 );
+}
+
+BOOST_AUTO_TEST_CASE( load_limits_columns_size )
+{
+  // a record count saved as a named value rather than a size tag, with no columns following
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive ar( os );
+    ar( static_cast<cereal::size_type>( 1000000 ) );
+  }
+
+  cereal::LoadLimits limits;
+  limits.maxElements = 10;
+  limits.maxTotalElements = 10;
+
+  std::istringstream is( os.str() );
+  cereal::BinaryInputArchive ar( is );
+  ar.setLoadLimits( limits );
+
+  std::vector<LimitsRecord> records;
+  BOOST_CHECK_THROW( ar( cereal::columns( records, &LimitsRecord::price, &LimitsRecord::quantity ) ), cereal::Exception );
+  BOOST_CHECK( records.capacity() == 0 );
+}
+
+BOOST_AUTO_TEST_CASE( load_limits_homogeneous_size )
+{
+  // an element count saved as a named value rather than a size tag, with no pointers following
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive ar( os );
+    ar( static_cast<cereal::size_type>( 1000000 ) );
+  }
+
+  cereal::LoadLimits limits;
+  limits.maxElements = 10;
+  limits.maxTotalElements = 10;
+
+  std::istringstream is( os.str() );
+  cereal::BinaryInputArchive ar( is );
+  ar.setLoadLimits( limits );
+
+  std::vector<std::shared_ptr<LimitsNode>> nodes;
+  BOOST_CHECK_THROW( ar( cereal::homogeneous( nodes ) ), cereal::Exception );
+  BOOST_CHECK( nodes.capacity() == 0 );
+}
@@ -204,3 +204,129 @@ BOOST_AUTO_TEST_CASE( json_map_memory )
 {
   test_map_memory<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
 }
+
+struct MapValueMoves
+{
+  static int moves;
+
+  int x = 0;
+
+  MapValueMoves() = default;
+  MapValueMoves( int x_ ) : x( x_ ) {}
+  MapValueMoves( MapValueMoves const & ) = default;
+  MapValueMoves( MapValueMoves && other ) : x( other.x ) { ++moves; }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+};
+
+int MapValueMoves::moves = 0;
+
+struct MapValueNoDefault
+{
+  MapValueNoDefault( int x_ ) : x( x_ ) {}
+  int x;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+
+  template <class Archive>
+  static void load_and_construct( Archive & ar, cereal::construct<MapValueNoDefault> & construct )
+  {
+    int x;
+    ar( x );
+    construct( x );
+  }
+};
+
+template <class IArchive, class OArchive>
+void test_map_direct_values()
+{
+  std::map<int, MapValueMoves> o_movesmap;
+  std::multimap<int, MapValueMoves> o_movesmultimap;
+  std::unordered_map<int, MapValueMoves> o_movesunorderedmap;
+  std::map<int, MapValueNoDefault> o_nodefaultmap;
+  std::unordered_multimap<int, MapValueNoDefault> o_nodefaultunorderedmap;
+  for( int i = 0; i < 50; ++i )
+  {
+    o_movesmap.emplace( i, MapValueMoves( i * 2 ) );
+    o_movesmultimap.emplace( i / 5, MapValueMoves( i * 3 ) );
+    o_movesunorderedmap.emplace( i, MapValueMoves( i * 4 ) );
+    o_nodefaultmap.emplace( i, MapValueNoDefault( i * 5 ) );
+    o_nodefaultunorderedmap.emplace( i / 5, MapValueNoDefault( i * 6 ) );
+  }
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_movesmap, o_movesmultimap, o_movesunorderedmap, o_nodefaultmap, o_nodefaultunorderedmap );
+  }
+
+  decltype( o_movesmap ) i_movesmap;
+  decltype( o_movesmultimap ) i_movesmultimap;
+  decltype( o_movesunorderedmap ) i_movesunorderedmap;
+  decltype( o_nodefaultmap ) i_nodefaultmap;
+  decltype( o_nodefaultunorderedmap ) i_nodefaultunorderedmap;
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    MapValueMoves::moves = 0;
+    iar( i_movesmap, i_movesmultimap, i_movesunorderedmap );
+    // values are loaded where they are stored
+    BOOST_CHECK_EQUAL( MapValueMoves::moves, 0 );
+    iar( i_nodefaultmap, i_nodefaultunorderedmap );
+  }
+
+  BOOST_REQUIRE_EQUAL( i_movesmap.size(), o_movesmap.size() );
+  for( auto const & i : o_movesmap )
+    BOOST_CHECK_EQUAL( i_movesmap.at( i.first ).x, i.second.x );
+
+  BOOST_REQUIRE_EQUAL( i_movesmultimap.size(), o_movesmultimap.size() );
+  auto o_it = o_movesmultimap.begin();
+  for( auto const & i : i_movesmultimap )
+  {
+    BOOST_CHECK_EQUAL( i.first, o_it->first );
+    BOOST_CHECK_EQUAL( i.second.x, o_it->second.x );
+    ++o_it;
+  }
+
+  BOOST_REQUIRE_EQUAL( i_movesunorderedmap.size(), o_movesunorderedmap.size() );
+  for( auto const & i : o_movesunorderedmap )
+    BOOST_CHECK_EQUAL( i_movesunorderedmap.at( i.first ).x, i.second.x );
+
+  BOOST_REQUIRE_EQUAL( i_nodefaultmap.size(), o_nodefaultmap.size() );
+  for( auto const & i : o_nodefaultmap )
+    BOOST_CHECK_EQUAL( i_nodefaultmap.at( i.first ).x, i.second.x );
+
+  BOOST_REQUIRE_EQUAL( i_nodefaultunorderedmap.size(), o_nodefaultunorderedmap.size() );
+  int sum = 0;
+  for( auto const & i : i_nodefaultunorderedmap )
+  {
+    BOOST_CHECK_EQUAL( i.first, i.second.x / 30 );
+    sum += i.second.x;
+  }
+  BOOST_CHECK_EQUAL( sum, 6 * 49 * 50 / 2 );
+}
+
+BOOST_AUTO_TEST_CASE( binary_map_direct_values )
+{
+  test_map_direct_values<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_map_direct_values )
+{
+  test_map_direct_values<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_map_direct_values )
+{
+  test_map_direct_values<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_map_direct_values )
+{
+  test_map_direct_values<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
@@ -0,0 +1,133 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/mapped_binary.hpp>
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include <fstream>
+
+BOOST_AUTO_TEST_CASE( mapped_binary_archive )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  char const * filename = "test_mapped_binary_archive.bin";
+
+  for(int ii=0; ii<10; ++ii)
+  {
+    // large enough to force the output mapping to grow a few times
+    std::vector<double> o_doubles( 500000 );
+    for( auto & d : o_doubles )
+      d = random_value<double>(gen);
+
+    std::map<int, std::string> o_map;
+    for( int j = 0; j < 100; ++j )
+      o_map.emplace( random_value<int>(gen), random_value<std::string>(gen) );
+
+    std::string const o_blob = random_value<std::string>(gen);
+    std::size_t written;
+
+    {
+      cereal::MappedBinaryOutputArchive oar(filename);
+      oar( o_doubles, o_map, o_blob );
+      written = oar.bytesWritten();
+    }
+
+    // readable as a normal binary archive
+    {
+      std::ifstream is( filename, std::ios::binary );
+      is.seekg( 0, std::ios::end );
+      BOOST_CHECK_EQUAL( static_cast<std::size_t>( is.tellg() ), written );
+      is.seekg( 0 );
+
+      std::vector<double> i_doubles;
+      std::map<int, std::string> i_map;
+      std::string i_blob;
+
+      cereal::BinaryInputArchive iar(is);
+      iar( i_doubles, i_map, i_blob );
+
+      BOOST_CHECK( i_doubles == o_doubles );
+      BOOST_CHECK( i_map == o_map );
+      BOOST_CHECK_EQUAL( i_blob, o_blob );
+    }
+
+    // and through a mapping
+    {
+      std::vector<double> i_doubles;
+      std::map<int, std::string> i_map;
+      cereal::BinaryView i_blob;
+
+      cereal::MappedBinaryInputArchive iar(filename);
+      iar( i_doubles, i_map, i_blob );
+
+      BOOST_CHECK( i_doubles == o_doubles );
+      BOOST_CHECK( i_map == o_map );
+      BOOST_CHECK_EQUAL( i_blob.str(), o_blob );
+      BOOST_CHECK_EQUAL( iar.bytesRead(), written );
+      BOOST_CHECK_THROW( iar( i_doubles ), cereal::Exception );
+    }
+  }
+
+  // aligned arrays can be viewed in place
+  {
+    std::vector<float> o_floats( 1000, 1.5f );
+    {
+      cereal::MappedBinaryOutputArchive oar(filename, 0, cereal::MappedBinaryOutputArchive::Options::Aligned( 64 ));
+      oar( std::uint8_t( 1 ), o_floats, std::string( "abc" ), o_floats );
+    }
+
+    cereal::MappedBinaryInputArchive iar(filename, cereal::MappedBinaryInputArchive::AccessHint::normal,
+                                         cereal::MappedBinaryInputArchive::Options::Aligned( 64 ));
+    std::uint8_t i_byte;
+    cereal::ArrayView<float> i_floats;
+    std::string i_string;
+    std::vector<float> i_copy;
+    iar( i_byte, i_floats, i_string, i_copy );
+
+    BOOST_CHECK_EQUAL( reinterpret_cast<std::uintptr_t>( i_floats.data ) % 64, 0 );
+    BOOST_CHECK_EQUAL_COLLECTIONS( i_floats.begin(), i_floats.end(), o_floats.begin(), o_floats.end() );
+    BOOST_CHECK_EQUAL( i_string, "abc" );
+    BOOST_CHECK( i_copy == o_floats );
+    BOOST_CHECK_EQUAL( iar.bytesRemaining(), 0u );
+  }
+
+  // empty files are valid
+  {
+    cereal::MappedBinaryOutputArchive oar(filename);
+  }
+  {
+    cereal::MappedBinaryInputArchive iar(filename, cereal::MappedBinaryInputArchive::AccessHint::random);
+    BOOST_CHECK_EQUAL( iar.bytesRemaining(), 0u );
+    int x;
+    BOOST_CHECK_THROW( iar( x ), cereal::Exception );
+  }
+
+  std::remove( filename );
+
+  BOOST_CHECK_THROW( cereal::MappedBinaryInputArchive( "this/file/does/not/exist" ), cereal::Exception );
+}
@@ -152,3 +152,276 @@ BOOST_AUTO_TEST_CASE( json_default_construction )
 {
   test_default_construction<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
 }
+
+template <class IArchive, class OArchive>
+void test_memory_many_shared()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // enough distinct pointers to force the tracking table to grow several times
+  std::vector<std::shared_ptr<int>> o_ptrs;
+  for( int i = 0; i < 5000; ++i )
+  {
+    if( !o_ptrs.empty() && gen() % 4 == 0 )
+      o_ptrs.push_back( o_ptrs[gen() % o_ptrs.size()] );
+    else
+      o_ptrs.push_back( std::make_shared<int>( i ) );
+  }
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar.reserveSharedPointers( 100 );
+    oar( o_ptrs );
+  }
+
+  std::vector<std::shared_ptr<int>> i_ptrs;
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar.reserveSharedPointers( 100 );
+    iar( i_ptrs );
+  }
+
+  BOOST_REQUIRE_EQUAL( i_ptrs.size(), o_ptrs.size() );
+  for( std::size_t i = 0; i < o_ptrs.size(); ++i )
+  {
+    BOOST_CHECK_EQUAL( *i_ptrs[i], *o_ptrs[i] );
+    for( std::size_t j = i + 1; j < std::min( o_ptrs.size(), i + 20 ); ++j )
+      BOOST_CHECK_EQUAL( i_ptrs[i] == i_ptrs[j], o_ptrs[i] == o_ptrs[j] );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_memory_many_shared )
+{
+  test_memory_many_shared<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_memory_many_shared )
+{
+  test_memory_many_shared<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_memory_bad_id )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    // a new pointer claiming an id that was never handed out
+    std::uint32_t const id = 7 | cereal::detail::msb_32bit;
+    oar( id, 5 );
+  }
+
+  std::shared_ptr<int> i_ptr;
+  std::istringstream is(os.str());
+  cereal::BinaryInputArchive iar(is);
+  BOOST_CHECK_THROW( iar( i_ptr ), cereal::Exception );
+}
+
+template <class IArchive, class OArchive>
+void test_memory_untracked()
+{
+  auto const o_shared = std::make_shared<int>( 3 );
+  std::shared_ptr<int> const o_null;
+  auto const o_private = std::make_shared<TestClass>( 4 );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::untracked( o_shared ), cereal::untracked( o_shared ),
+         cereal::untracked( o_null ), cereal::untracked( o_private ) );
+    // tracked pointers still start from the first id
+    oar( o_shared );
+  }
+
+  std::shared_ptr<int> i_shared1, i_shared2, i_null, i_tracked;
+  std::shared_ptr<TestClass> i_private;
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::untracked( i_shared1 ), cereal::untracked( i_shared2 ),
+         cereal::untracked( i_null ), cereal::untracked( i_private ) );
+    iar( i_tracked );
+  }
+
+  BOOST_CHECK_EQUAL( *i_shared1, 3 );
+  BOOST_CHECK_EQUAL( *i_shared2, 3 );
+  BOOST_CHECK( i_shared1 != i_shared2 );
+  BOOST_CHECK( !i_null );
+  BOOST_CHECK_EQUAL( i_private->x, 4 );
+  BOOST_CHECK_EQUAL( *i_tracked, 3 );
+}
+
+BOOST_AUTO_TEST_CASE( binary_memory_untracked )
+{
+  test_memory_untracked<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+
+  // one byte of flag instead of a four byte id
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    auto const o_ptr = std::make_shared<int>( 5 );
+    oar( cereal::untracked( o_ptr ) );
+  }
+  BOOST_CHECK_EQUAL( os.str().size(), 1u + sizeof(int) );
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_memory_untracked )
+{
+  test_memory_untracked<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_memory_untracked )
+{
+  test_memory_untracked<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_memory_untracked )
+{
+  test_memory_untracked<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+template <class IArchive, class OArchive>
+void test_memory_wide_ids()
+{
+  std::uint64_t const ids[] = { 0, 5, 5 | cereal::detail::msb_64bit,
+                                0x7FFFFFFE | cereal::detail::msb_64bit, 0x7FFFFFFF,
+                                0x7FFFFFFF | cereal::detail::msb_64bit,
+                                0x123456789ULL, 0x123456789ULL | cereal::detail::msb_64bit };
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    for( auto id : ids )
+      cereal::memory_detail::saveSharedPointerId( oar, id );
+  }
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    for( auto id : ids )
+      BOOST_CHECK_EQUAL( cereal::memory_detail::loadSharedPointerId( iar ), id );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_memory_wide_ids )
+{
+  test_memory_wide_ids<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+
+  // ids that fit keep their 32 bit encoding
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    cereal::memory_detail::saveSharedPointerId( oar, 0x7FFFFFFE | cereal::detail::msb_64bit );
+    BOOST_CHECK_EQUAL( os.str().size(), 4u );
+    cereal::memory_detail::saveSharedPointerId( oar, 0x7FFFFFFF | cereal::detail::msb_64bit );
+  }
+  BOOST_CHECK_EQUAL( os.str().size(), 4u + 4u + 8u );
+}
+
+BOOST_AUTO_TEST_CASE( json_memory_wide_ids )
+{
+  test_memory_wide_ids<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+struct ChainNode
+{
+  int value;
+  std::unique_ptr<ChainNode> next;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( value ); }
+};
+
+struct SharedChainNode
+{
+  int value;
+  std::shared_ptr<SharedChainNode> next;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( value ); }
+};
+
+// Destroys a chain one node at a time, since the destructors would recurse
+template <class Ptr>
+void destroy_chain( Ptr & head )
+{
+  while( head )
+  {
+    auto next = std::move( head->next );
+    head = std::move( next );
+  }
+}
+
+template <class IArchive, class OArchive>
+void test_memory_chain( int length )
+{
+  std::unique_ptr<ChainNode> o_head;
+  std::shared_ptr<SharedChainNode> o_shared_head;
+  for( int i = length - 1; i >= 0; --i )
+  {
+    std::unique_ptr<ChainNode> node( new ChainNode{ i, std::move( o_head ) } );
+    o_head = std::move( node );
+    o_shared_head = std::make_shared<SharedChainNode>( SharedChainNode{ i, o_shared_head } );
+  }
+  auto const o_middle = o_shared_head->next;
+  std::unique_ptr<ChainNode> const o_empty;
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::make_chain( o_head, &ChainNode::next ) );
+    oar( cereal::make_chain( o_shared_head, &SharedChainNode::next ), o_middle );
+    oar( cereal::make_chain( o_empty, &ChainNode::next ) );
+  }
+
+  std::unique_ptr<ChainNode> i_head;
+  std::shared_ptr<SharedChainNode> i_shared_head, i_middle;
+  std::unique_ptr<ChainNode> i_empty( new ChainNode{ 1, nullptr } );
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::make_chain( i_head, &ChainNode::next ) );
+    iar( cereal::make_chain( i_shared_head, &SharedChainNode::next ), i_middle );
+    iar( cereal::make_chain( i_empty, &ChainNode::next ) );
+  }
+
+  int count = 0;
+  bool equal = true;
+  auto node = i_head.get();
+  auto shared_node = i_shared_head.get();
+  for( ; node && shared_node; node = node->next.get(), shared_node = shared_node->next.get(), ++count )
+    equal = equal && node->value == count && shared_node->value == count;
+
+  BOOST_CHECK( equal );
+  BOOST_CHECK_EQUAL( count, length );
+  BOOST_CHECK( !node && !shared_node );
+  BOOST_CHECK_EQUAL( i_middle, i_shared_head->next );
+  BOOST_CHECK( !i_empty );
+
+  destroy_chain( o_head );
+  destroy_chain( o_shared_head );
+  destroy_chain( i_head );
+  i_middle.reset();
+  destroy_chain( i_shared_head );
+}
+
+BOOST_AUTO_TEST_CASE( binary_memory_chain )
+{
+  // long enough that serializing the links recursively would overflow the stack
+  test_memory_chain<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>( 1000000 );
+}
+
+BOOST_AUTO_TEST_CASE( json_memory_chain )
+{
+  test_memory_chain<cereal::JSONInputArchive, cereal::JSONOutputArchive>( 1000 );
+}
+
+BOOST_AUTO_TEST_CASE( xml_memory_chain )
+{
+  test_memory_chain<cereal::XMLInputArchive, cereal::XMLOutputArchive>( 1000 );
+}
@@ -0,0 +1,288 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/memory_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct MemoryBinaryData
+{
+  int a;
+  double b;
+  std::string c;
+  std::vector<int> d;
+  std::map<std::string, StructInternalSerialize> e;
+  std::shared_ptr<StructExternalSplit> f;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( CEREAL_NVP(a), CEREAL_NVP(b), CEREAL_NVP(c), CEREAL_NVP(d), CEREAL_NVP(e), CEREAL_NVP(f) );
+  }
+};
+
+inline MemoryBinaryData random_memory_binary_data( std::mt19937 & gen )
+{
+  MemoryBinaryData data;
+  data.a = random_value<int>(gen);
+  data.b = random_value<double>(gen);
+  data.c = random_value<std::string>(gen);
+  data.d.resize( 1000 );
+  for( auto & v : data.d )
+    v = random_value<int>(gen);
+  for( int i = 0; i < 100; ++i )
+    data.e.emplace( random_value<std::string>(gen), StructInternalSerialize( random_value<int>(gen), random_value<int>(gen) ) );
+  data.f = std::make_shared<StructExternalSplit>( random_value<int>(gen), random_value<int>(gen) );
+  return data;
+}
+
+inline void check_memory_binary_data( MemoryBinaryData const & i, MemoryBinaryData const & o )
+{
+  BOOST_CHECK_EQUAL( i.a, o.a );
+  BOOST_CHECK_CLOSE( i.b, o.b, 1e-5 );
+  BOOST_CHECK_EQUAL( i.c, o.c );
+  BOOST_CHECK_EQUAL_COLLECTIONS( i.d.begin(), i.d.end(), o.d.begin(), o.d.end() );
+  BOOST_CHECK_EQUAL( i.e.size(), o.e.size() );
+  for( auto const & kv : o.e )
+    BOOST_CHECK_EQUAL( i.e.at( kv.first ), kv.second );
+  BOOST_CHECK_EQUAL( *i.f, *o.f );
+}
+
+BOOST_AUTO_TEST_CASE( memory_binary_output_matches_binary )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    auto const o_data = random_memory_binary_data( gen );
+
+    std::ostringstream os;
+    {
+      cereal::BinaryOutputArchive oar(os);
+      oar( o_data );
+    }
+
+    std::vector<char> buffer;
+    std::size_t written;
+    {
+      cereal::MemoryBinaryOutputArchive oar(buffer);
+      oar( o_data );
+      written = oar.bytesWritten();
+    }
+
+    BOOST_CHECK_EQUAL( buffer.size(), written );
+    BOOST_CHECK( std::string( buffer.begin(), buffer.end() ) == os.str() );
+
+    MemoryBinaryData i_data;
+    std::istringstream is( std::string( buffer.begin(), buffer.end() ) );
+    {
+      cereal::BinaryInputArchive iar(is);
+      iar( i_data );
+    }
+
+    check_memory_binary_data( i_data, o_data );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( memory_binary_output_appends )
+{
+  std::vector<char> buffer = {'a', 'b', 'c'};
+  {
+    cereal::MemoryBinaryOutputArchive oar(buffer);
+    oar( std::int32_t(7) );
+  }
+
+  BOOST_CHECK_EQUAL( buffer.size(), 3u + sizeof(std::int32_t) );
+  BOOST_CHECK_EQUAL( std::string( buffer.begin(), buffer.begin() + 3 ), "abc" );
+
+  std::int32_t value;
+  std::memcpy( &value, buffer.data() + 3, sizeof(value) );
+  BOOST_CHECK_EQUAL( value, 7 );
+}
+
+BOOST_AUTO_TEST_CASE( memory_binary_output_fixed_span )
+{
+  char buffer[12];
+  {
+    cereal::MemoryBinaryOutputArchive oar(buffer, sizeof(buffer));
+    oar( std::int32_t(1), std::int64_t(2) );
+    BOOST_CHECK_EQUAL( oar.bytesWritten(), sizeof(buffer) );
+    BOOST_CHECK_THROW( oar( std::int8_t(3) ), cereal::Exception );
+  }
+
+  std::int32_t a;
+  std::int64_t b;
+  std::istringstream is( std::string( buffer, sizeof(buffer) ) );
+  {
+    cereal::BinaryInputArchive iar(is);
+    iar( a, b );
+  }
+
+  BOOST_CHECK_EQUAL( a, 1 );
+  BOOST_CHECK_EQUAL( b, 2 );
+}
+
+BOOST_AUTO_TEST_CASE( memory_binary_input )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    auto const o_data = random_memory_binary_data( gen );
+
+    std::ostringstream os;
+    {
+      cereal::BinaryOutputArchive oar(os);
+      oar( o_data );
+    }
+
+    std::string const buffer = os.str();
+    MemoryBinaryData i_data;
+    {
+      cereal::MemoryBinaryInputArchive iar(buffer.data(), buffer.size());
+      iar( i_data );
+      BOOST_CHECK_EQUAL( iar.bytesRead(), buffer.size() );
+      BOOST_CHECK_EQUAL( iar.bytesRemaining(), 0u );
+      BOOST_CHECK_THROW( iar( i_data.a ), cereal::Exception );
+    }
+
+    check_memory_binary_data( i_data, o_data );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( memory_binary_binary_view )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::string const o_string = random_value<std::string>(gen);
+  std::string const o_blob( 100000, 'x' );
+
+  std::vector<char> buffer;
+  {
+    cereal::MemoryBinaryOutputArchive oar(buffer);
+    oar( o_string );
+    oar( cereal::BinaryView( o_blob.data(), o_blob.size() ) );
+  }
+
+  cereal::BinaryView i_view;
+  std::string i_string;
+  {
+    cereal::MemoryBinaryInputArchive iar(buffer.data(), buffer.size());
+    iar( i_view );
+    iar( i_string );
+  }
+
+  BOOST_CHECK_EQUAL( i_view.str(), o_string );
+  BOOST_CHECK( i_view.data > buffer.data() && i_view.data < buffer.data() + buffer.size() );
+  BOOST_CHECK_EQUAL( i_string, o_blob );
+}
+
+//! The offset from ptr to the next 64 byte boundary
+inline std::size_t memory_binary_padding( char const * ptr )
+{
+  return ( 64 - reinterpret_cast<std::uintptr_t>( ptr ) % 64 ) % 64;
+}
+
+BOOST_AUTO_TEST_CASE( memory_binary_aligned_array_view )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<double> o_doubles( 1000 );
+  for( auto & d : o_doubles )
+    d = random_value<double>(gen);
+  std::vector<std::int16_t> o_shorts( 77 );
+  for( auto & s : o_shorts )
+    s = random_value<std::int16_t>(gen);
+  std::string const o_string = random_value<std::string>(gen);
+
+  for( std::size_t alignment : {std::size_t( 1 ), std::size_t( 64 )} )
+  {
+    std::vector<char> buffer;
+    {
+      cereal::MemoryBinaryOutputArchive oar( buffer, cereal::MemoryBinaryOutputArchive::Options::Aligned( alignment ) );
+      oar( std::uint8_t( 1 ), o_doubles, o_string, o_shorts, cereal::ArrayView<double>( o_doubles.data(), 10 ) );
+    }
+
+    // the data is placed in memory aligned to the largest alignment used
+    std::vector<char> storage( buffer.size() + 64 );
+    auto const offset = memory_binary_padding( storage.data() );
+    std::memcpy( storage.data() + offset, buffer.data(), buffer.size() );
+    char const * const data = storage.data() + offset;
+
+    cereal::ArrayView<double> i_doubles, i_tail;
+    std::string i_string;
+    cereal::ArrayView<std::int16_t> i_shorts;
+    std::uint8_t i_byte;
+    {
+      cereal::MemoryBinaryInputArchive iar( data, buffer.size(), cereal::MemoryBinaryInputArchive::Options::Aligned( alignment ) );
+      iar( i_byte, i_doubles, i_string, i_shorts, i_tail );
+      BOOST_CHECK_EQUAL( iar.bytesRemaining(), 0 );
+    }
+
+    BOOST_CHECK_EQUAL( i_byte, 1 );
+    BOOST_CHECK_EQUAL( i_string, o_string );
+    auto const viewed = reinterpret_cast<char const *>( i_doubles.data );
+    BOOST_CHECK( viewed > data && viewed < data + buffer.size() );
+    BOOST_CHECK_EQUAL( reinterpret_cast<std::uintptr_t>( i_doubles.data ) % std::max( alignment, alignof(double) ), 0 );
+    BOOST_CHECK_EQUAL( reinterpret_cast<std::uintptr_t>( i_shorts.data ) % alignment, 0 );
+    BOOST_CHECK_EQUAL_COLLECTIONS( i_doubles.begin(), i_doubles.end(), o_doubles.begin(), o_doubles.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( i_shorts.begin(), i_shorts.end(), o_shorts.begin(), o_shorts.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( i_tail.begin(), i_tail.end(), o_doubles.begin(), o_doubles.begin() + 10 );
+
+    // the padded data can also be loaded into containers
+    std::vector<double> v_doubles, v_tail;
+    std::vector<std::int16_t> v_shorts;
+    {
+      cereal::MemoryBinaryInputArchive iar( buffer.data(), buffer.size(), cereal::MemoryBinaryInputArchive::Options::Aligned( alignment ) );
+      iar( i_byte, v_doubles, i_string, v_shorts, v_tail );
+    }
+    BOOST_CHECK( v_doubles == o_doubles );
+    BOOST_CHECK( v_shorts == o_shorts );
+    BOOST_CHECK_EQUAL( v_tail.size(), 10 );
+  }
+
+  // without alignment, an array after a single byte can not be borrowed
+  std::vector<char> buffer;
+  {
+    cereal::MemoryBinaryOutputArchive oar( buffer );
+    oar( std::uint8_t( 1 ), o_doubles );
+  }
+  std::vector<char> storage( buffer.size() + 64 );
+  auto const data = storage.data() + memory_binary_padding( storage.data() );
+  std::memcpy( data, buffer.data(), buffer.size() );
+
+  cereal::MemoryBinaryInputArchive iar( data, buffer.size() );
+  std::uint8_t i_byte;
+  cereal::ArrayView<double> i_doubles;
+  iar( i_byte );
+  BOOST_CHECK_THROW( iar( i_doubles ), cereal::Exception );
+
+  BOOST_CHECK_THROW( cereal::MemoryBinaryOutputArchive::Options::Aligned( 3 ), cereal::Exception );
+}
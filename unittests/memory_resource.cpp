@@ -0,0 +1,210 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+// Counts the memory handed out by an arena, so tests can tell what was allocated from it
+class CountingArena : public cereal::MonotonicArena
+{
+  public:
+    void * allocate( std::size_t size, std::size_t alignment ) override
+    {
+      ++allocations;
+      live += size;
+      void * ptr = cereal::MonotonicArena::allocate( size, alignment );
+      BOOST_CHECK_EQUAL( reinterpret_cast<std::uintptr_t>( ptr ) % alignment, 0u );
+      return ptr;
+    }
+
+    void deallocate( void * ptr, std::size_t size, std::size_t alignment ) override
+    {
+      live -= size;
+      cereal::MonotonicArena::deallocate( ptr, size, alignment );
+    }
+
+    std::size_t allocations = 0;
+    std::size_t live = 0;
+};
+
+struct ResourceNode
+{
+  ResourceNode() = default;
+  ResourceNode( int v ) : value( v ) {}
+
+  int value = 0;
+  std::vector<std::shared_ptr<ResourceNode>> children;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( value, children ); }
+};
+
+struct ResourceShared : std::enable_shared_from_this<ResourceShared>
+{
+  int value = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( value ); }
+};
+
+struct ResourceLA
+{
+  ResourceLA( int v ) : value( v ) {}
+  int value;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( value ); }
+
+  template <class Archive>
+  static void load_and_construct( Archive & ar, cereal::construct<ResourceLA> & construct )
+  {
+    int v;
+    ar( v );
+    construct( v );
+  }
+};
+
+struct ResourcePolyBase
+{
+  virtual ~ResourcePolyBase() {}
+  virtual int get() const = 0;
+};
+
+struct ResourcePolyDerived : ResourcePolyBase
+{
+  ResourcePolyDerived() = default;
+  ResourcePolyDerived( int v ) : value( v ) {}
+  int value = 0;
+  int get() const override { return value; }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( value ); }
+};
+
+CEREAL_REGISTER_TYPE(ResourcePolyDerived)
+
+template <class IArchive, class OArchive>
+void test_memory_resource()
+{
+  auto o_root = std::make_shared<ResourceNode>( 1 );
+  for( int i = 0; i < 50; ++i )
+    o_root->children.push_back( std::make_shared<ResourceNode>( i ) );
+  o_root->children.push_back( o_root->children.front() );
+
+  auto o_shared = std::make_shared<ResourceShared>();
+  o_shared->value = 7;
+  auto o_la = std::make_shared<ResourceLA>( 8 );
+  cereal::resource_unique_ptr<ResourceNode> o_unique( new ResourceNode( 9 ) );
+  cereal::resource_unique_ptr<ResourceLA> o_uniqueLA( new ResourceLA( 10 ) );
+  std::shared_ptr<ResourcePolyBase> o_poly = std::make_shared<ResourcePolyDerived>( 11 );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_root, o_shared, o_la, o_unique, o_uniqueLA, o_poly );
+  }
+
+  CountingArena arena;
+  {
+    decltype(o_root) i_root;
+    decltype(o_shared) i_shared;
+    decltype(o_la) i_la;
+    decltype(o_unique) i_unique;
+    decltype(o_uniqueLA) i_uniqueLA;
+    decltype(o_poly) i_poly;
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      iar.setMemoryResource( &arena );
+      BOOST_CHECK_EQUAL( iar.getMemoryResource(), &arena );
+      iar( i_root, i_shared, i_la, i_unique, i_uniqueLA, i_poly );
+    }
+
+    // 51 nodes, then one object per remaining pointer, plus a control block for
+    // the enable_shared_from_this type
+    BOOST_CHECK_EQUAL( arena.allocations, 51u + 5u + 1u );
+
+    BOOST_REQUIRE_EQUAL( i_root->children.size(), o_root->children.size() );
+    for( std::size_t i = 0; i < o_root->children.size(); ++i )
+      BOOST_CHECK_EQUAL( i_root->children[i]->value, o_root->children[i]->value );
+    BOOST_CHECK_EQUAL( i_root->children.front(), i_root->children.back() );
+
+    BOOST_CHECK_EQUAL( i_shared->value, 7 );
+    BOOST_CHECK_EQUAL( i_shared->shared_from_this(), i_shared );
+    BOOST_CHECK_EQUAL( i_la->value, 8 );
+    BOOST_CHECK_EQUAL( i_unique->value, 9 );
+    BOOST_CHECK_EQUAL( i_unique.get_deleter().resource(), &arena );
+    BOOST_CHECK_EQUAL( i_uniqueLA->value, 10 );
+    BOOST_CHECK_EQUAL( i_poly->get(), 11 );
+  }
+
+  BOOST_CHECK_EQUAL( arena.live, 0u );
+  BOOST_CHECK( arena.blockBytes() > 0 );
+  arena.release();
+  BOOST_CHECK_EQUAL( arena.blockBytes(), 0u );
+}
+
+BOOST_AUTO_TEST_CASE( binary_memory_resource )
+{
+  test_memory_resource<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_memory_resource )
+{
+  test_memory_resource<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_memory_resource )
+{
+  test_memory_resource<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_memory_resource )
+{
+  test_memory_resource<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( memory_resource_without_resource )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    cereal::resource_unique_ptr<ResourceNode> o_unique( new ResourceNode( 3 ) );
+    oar( o_unique );
+  }
+
+  std::istringstream is(os.str());
+  cereal::BinaryInputArchive iar(is);
+  cereal::resource_unique_ptr<ResourceNode> i_unique;
+  iar( i_unique );
+  BOOST_CHECK_EQUAL( i_unique->value, 3 );
+  BOOST_CHECK( i_unique.get_deleter().resource() == nullptr );
+}
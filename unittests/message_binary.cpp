@@ -0,0 +1,185 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/message_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  struct MessageRecord
+  {
+    std::uint32_t id;
+    std::string text;
+    std::shared_ptr<int> shared;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( id, text, shared ); }
+  };
+
+  struct MessageThrowing
+  {
+    template <class Archive>
+    void save( Archive & ) const
+    { throw std::runtime_error( "failed" ); }
+  };
+}
+
+BOOST_AUTO_TEST_CASE( binary_message_pieces )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<MessageRecord> records;
+  for( std::uint32_t i = 0; i < 50; ++i )
+    records.push_back( { i, random_basic_string<char>( gen ) + std::string( i * 20, 'x' ), std::make_shared<int>( static_cast<int>( i ) ) } );
+
+  cereal::BinaryMessageEncoder encoder;
+  std::vector<char> out;
+  for( auto const & r : records )
+    encoder.encode( out, r );
+
+  // every message holds a complete BinaryOutputArchive output
+  {
+    std::vector<char> single;
+    encoder.encode( single, records[3] );
+
+    std::ostringstream os;
+    {
+      cereal::BinaryOutputArchive ar( os );
+      ar( records[3] );
+    }
+    BOOST_CHECK_EQUAL( static_cast<unsigned char>( single[0] ), os.str().size() );
+    BOOST_CHECK( std::string( single.begin() + 1, single.end() ) == os.str() );
+  }
+
+  // feed the stream in pieces of varying size, including single bytes
+  for( std::size_t piece : {std::size_t( 1 ), std::size_t( 7 ), std::size_t( 100 ), out.size()} )
+  {
+    cereal::BinaryMessageDecoder decoder;
+    std::vector<MessageRecord> loaded;
+
+    for( std::size_t pos = 0; pos < out.size(); pos += piece )
+    {
+      auto const size = std::min( piece, out.size() - pos );
+      if( pos % 2 )
+        decoder.feed( out.data() + pos, size );
+      else
+      {
+        std::memcpy( decoder.prepare( size ), out.data() + pos, size );
+        decoder.commit( size );
+      }
+
+      MessageRecord r;
+      while( decoder.tryLoad( r ) )
+        loaded.push_back( r );
+    }
+
+    BOOST_CHECK_EQUAL( decoder.bytesBuffered(), 0 );
+    BOOST_REQUIRE_EQUAL( loaded.size(), records.size() );
+    for( std::size_t i = 0; i < records.size(); ++i )
+    {
+      BOOST_CHECK_EQUAL( loaded[i].id, records[i].id );
+      BOOST_CHECK_EQUAL( loaded[i].text, records[i].text );
+      BOOST_REQUIRE( loaded[i].shared );
+      BOOST_CHECK_EQUAL( *loaded[i].shared, *records[i].shared );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_message_bytes_needed )
+{
+  std::vector<char> out;
+  cereal::BinaryMessageEncoder encoder;
+  encoder.encode( out, std::string( 300, 'a' ) );
+  // 300 chars and an 8 byte size take a two byte header
+  BOOST_REQUIRE_EQUAL( out.size(), 2 + 8 + 300 );
+
+  cereal::BinaryMessageDecoder decoder;
+  BOOST_CHECK_EQUAL( decoder.bytesNeeded(), 1 );
+  decoder.feed( out.data(), 1 );
+  BOOST_CHECK_EQUAL( decoder.bytesNeeded(), 1 );
+  decoder.feed( out.data() + 1, 1 );
+  BOOST_CHECK_EQUAL( decoder.bytesNeeded(), 308 );
+
+  std::string s = "untouched";
+  BOOST_CHECK( !decoder.tryLoad( s ) );
+  BOOST_CHECK_EQUAL( s, "untouched" );
+
+  decoder.feed( out.data() + 2, 307 );
+  BOOST_CHECK_EQUAL( decoder.bytesNeeded(), 1 );
+  BOOST_CHECK( !decoder.tryLoad( s ) );
+  decoder.feed( out.data() + 309, 1 );
+  BOOST_CHECK_EQUAL( decoder.bytesNeeded(), 0 );
+  BOOST_CHECK( decoder.tryLoad( s ) );
+  BOOST_CHECK_EQUAL( s, std::string( 300, 'a' ) );
+}
+
+BOOST_AUTO_TEST_CASE( binary_message_errors )
+{
+  std::vector<char> out;
+  cereal::BinaryMessageEncoder encoder;
+  encoder.encode( out, std::uint8_t( 1 ) );
+  encoder.encode( out, std::uint32_t( 2 ) );
+
+  // a message that can not be loaded is dropped
+  {
+    cereal::BinaryMessageDecoder decoder;
+    decoder.feed( out.data(), out.size() );
+
+    std::uint32_t value;
+    BOOST_CHECK_THROW( decoder.tryLoad( value ), cereal::Exception );
+    BOOST_CHECK( decoder.tryLoad( value ) );
+    BOOST_CHECK_EQUAL( value, 2 );
+  }
+
+  // a header announcing a message over the limit is rejected as soon as it arrives
+  {
+    std::vector<char> big;
+    encoder.encode( big, std::string( 1000, 'b' ) );
+
+    cereal::BinaryMessageDecoder decoder( 100 );
+    decoder.feed( big.data(), 2 );
+    BOOST_CHECK_THROW( decoder.bytesNeeded(), cereal::Exception );
+    BOOST_CHECK_THROW( decoder.tryLoad( out ), cereal::Exception );
+  }
+
+  // a saving failure leaves the output as it was
+  {
+    auto const size = out.size();
+    BOOST_CHECK_THROW( encoder.encode( out, std::string( 1000, 'c' ), MessageThrowing() ), std::runtime_error );
+    BOOST_CHECK_EQUAL( out.size(), size );
+  }
+
+  {
+    cereal::BinaryMessageDecoder decoder;
+    char overlong[11];
+    std::memset( overlong, 0xFF, sizeof(overlong) );
+    decoder.feed( overlong, sizeof(overlong) );
+    BOOST_CHECK_THROW( decoder.bytesNeeded(), cereal::Exception );
+  }
+}
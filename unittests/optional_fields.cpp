@@ -0,0 +1,138 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/types/optional_fields.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct SparseMessage
+{
+  std::uint32_t id = 0;
+  std::int32_t a = 0, b = 0, c = 0, d = 0, e = 0, f = 0, g = 0, h = 0;
+  double price = 0, stop = 1.5;
+  std::string note;
+  std::vector<int> values;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( CEREAL_NVP(id),
+        cereal::optional_fields( cereal::optional_field( "a", a, 0 ), cereal::optional_field( "b", b, 0 ),
+                                 cereal::optional_field( "c", c, 0 ), cereal::optional_field( "d", d, 0 ),
+                                 cereal::optional_field( "e", e, 0 ), cereal::optional_field( "f", f, 0 ),
+                                 cereal::optional_field( "g", g, 0 ), cereal::optional_field( "h", h, 0 ),
+                                 cereal::optional_field( "price", price, 0.0 ),
+                                 cereal::optional_field( stop, 1.5 ),
+                                 cereal::optional_field( "note", note, std::string() ),
+                                 cereal::optional_field( "values", values, std::vector<int>() ) ) );
+  }
+
+  bool operator==( SparseMessage const & o ) const
+  {
+    return id == o.id && a == o.a && b == o.b && c == o.c && d == o.d && e == o.e && f == o.f &&
+           g == o.g && h == o.h && price == o.price && stop == o.stop && note == o.note && values == o.values;
+  }
+};
+
+template <class IArchive, class OArchive>
+void test_optional_fields()
+{
+  std::vector<SparseMessage> messages( 4 );
+  messages[0].id = 1;
+  messages[1].id = 2;
+  messages[1].c = -7;
+  messages[1].note = "hello";
+  messages[2].id = 3;
+  messages[2].h = 9;
+  messages[2].price = 2.25;
+  messages[2].stop = 0;
+  messages[2].values = { 1, 2, 3 };
+  messages[3] = messages[1];
+  messages[3].a = messages[3].b = messages[3].d = messages[3].e = messages[3].f = messages[3].g = 4;
+
+  std::ostringstream os;
+  {
+    OArchive oar( os );
+    for( auto const & m : messages )
+      oar( m );
+  }
+
+  std::istringstream is( os.str() );
+  {
+    IArchive iar( is );
+    for( auto const & m : messages )
+    {
+      // fields that are left out are reset to their defaults
+      SparseMessage loaded = messages[3];
+      loaded.stop = -1;
+      iar( loaded );
+      BOOST_CHECK( loaded == m );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_optional_fields )
+{
+  test_optional_fields<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_optional_fields )
+{
+  test_optional_fields<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_optional_fields )
+{
+  test_optional_fields<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_optional_fields )
+{
+  test_optional_fields<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_optional_fields_size )
+{
+  SparseMessage m;
+  m.id = 5;
+  m.c = 1;
+  m.price = 3.5;
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar( m );
+  }
+
+  // the id, two bytes of bitmap, and the two fields that differ from their defaults
+  BOOST_CHECK_EQUAL( os.str().size(), sizeof(std::uint32_t) + 2 + sizeof(std::int32_t) + sizeof(double) );
+
+  std::istringstream is( os.str() );
+  cereal::BinaryInputArchive iar( is );
+  SparseMessage loaded;
+  iar( loaded );
+  BOOST_CHECK( loaded == m );
+}
@@ -0,0 +1,156 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct OwnedLabel
+{
+  std::string text;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(text) ); }
+};
+
+template <class IArchive, class OArchive>
+void test_owned_array()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::size_t const o_size = 1000;
+  std::unique_ptr<double[]> o_values( new double[o_size] );
+  for( std::size_t i = 0; i < o_size; ++i )
+    o_values[i] = random_value<double>(gen);
+
+  std::size_t const o_labelCount = 3;
+  std::unique_ptr<OwnedLabel[]> o_labels( new OwnedLabel[o_labelCount] );
+  for( std::size_t i = 0; i < o_labelCount; ++i )
+    o_labels[i].text = random_basic_string<char>(gen);
+
+  std::unique_ptr<int[]> o_empty;
+  std::vector<float> o_vector = { 1.5f, 2.5f, 3.5f };
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::owned_array( o_values, o_size ),
+         cereal::owned_array( o_labels, o_labelCount ),
+         cereal::owned_array( o_empty, 0 ),
+         o_vector );
+  }
+
+  std::unique_ptr<double[]> i_values;
+  std::size_t i_size = 0;
+  // an array of the wrong size is replaced
+  std::unique_ptr<OwnedLabel[]> i_labels( new OwnedLabel[1] );
+  std::size_t i_labelCount = 1;
+  std::unique_ptr<int[]> i_empty( new int[4] );
+  std::size_t i_emptyCount = 4;
+  std::unique_ptr<float[]> i_vector;
+  std::uint32_t i_vectorSize = 0;
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::owned_array( i_values, i_size ),
+         cereal::owned_array( i_labels, i_labelCount ),
+         cereal::owned_array( i_empty, i_emptyCount ),
+         cereal::owned_array( i_vector, i_vectorSize ) );
+  }
+
+  BOOST_REQUIRE_EQUAL( i_size, o_size );
+  for( std::size_t i = 0; i < o_size; ++i )
+    BOOST_CHECK_CLOSE( i_values[i], o_values[i], 1e-5 );
+
+  BOOST_REQUIRE_EQUAL( i_labelCount, o_labelCount );
+  for( std::size_t i = 0; i < o_labelCount; ++i )
+    BOOST_CHECK_EQUAL( i_labels[i].text, o_labels[i].text );
+
+  BOOST_CHECK_EQUAL( i_emptyCount, 0 );
+  BOOST_CHECK( !i_empty );
+
+  // the same format as std::vector
+  BOOST_REQUIRE_EQUAL( i_vectorSize, o_vector.size() );
+  for( std::size_t i = 0; i < o_vector.size(); ++i )
+    BOOST_CHECK_EQUAL( i_vector[i], o_vector[i] );
+}
+
+BOOST_AUTO_TEST_CASE( binary_owned_array )
+{
+  test_owned_array<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_owned_array )
+{
+  test_owned_array<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_owned_array )
+{
+  test_owned_array<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_owned_array )
+{
+  test_owned_array<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( owned_array_reuses_storage )
+{
+  std::size_t const size = 16;
+  std::unique_ptr<std::uint64_t[]> o_values( new std::uint64_t[size] );
+  for( std::size_t i = 0; i < size; ++i )
+    o_values[i] = i;
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( cereal::owned_array( o_values, size ) );
+  }
+
+  std::size_t i_size = size;
+  std::unique_ptr<std::uint64_t[]> i_values( new std::uint64_t[size] );
+  auto const storage = i_values.get();
+
+  std::istringstream is(os.str());
+  {
+    cereal::BinaryInputArchive iar(is);
+    iar( cereal::owned_array( i_values, i_size ) );
+  }
+
+  BOOST_CHECK_EQUAL( i_values.get(), storage );
+  BOOST_CHECK_EQUAL( i_values[size - 1], size - 1 );
+}
+
+BOOST_AUTO_TEST_CASE( owned_array_null_with_size )
+{
+  std::unique_ptr<double[]> values;
+  std::ostringstream os;
+  cereal::BinaryOutputArchive oar(os);
+  BOOST_CHECK_THROW( oar( cereal::owned_array( values, 3 ) ), cereal::Exception );
+}
@@ -0,0 +1,265 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/types/parallel.hpp>
+#include <boost/test/unit_test.hpp>
+
+template <class IArchive, class OArchive>
+void test_parallel( std::size_t chunkSize, std::size_t threads )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<StructInternalSerialize> o_structs;
+  std::vector<std::string> o_strings;
+  for( int i = 0; i < 1000; ++i )
+  {
+    o_structs.emplace_back( random_value<int>(gen), random_value<int>(gen) );
+    o_strings.push_back( random_basic_string<char>(gen) );
+  }
+  std::vector<std::string> const o_empty;
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::parallel( o_structs, chunkSize, threads ) );
+    oar( cereal::parallel( o_strings, chunkSize, threads ) );
+    oar( cereal::parallel( o_empty, chunkSize, threads ) );
+    oar( 5 );
+  }
+
+  std::vector<StructInternalSerialize> i_structs;
+  std::vector<std::string> i_strings;
+  std::vector<std::string> i_empty = { "stale" };
+  int i_after;
+
+  // loading does not need the same chunk size or threads
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::parallel( i_structs, 1, threads + 1 ) );
+    iar( cereal::parallel( i_strings ) );
+    iar( cereal::parallel( i_empty ) );
+    iar( i_after );
+  }
+
+  BOOST_CHECK( i_structs == o_structs );
+  BOOST_CHECK( i_strings == o_strings );
+  BOOST_CHECK( i_empty.empty() );
+  BOOST_CHECK_EQUAL( i_after, 5 );
+}
+
+BOOST_AUTO_TEST_CASE( binary_parallel )
+{
+  test_parallel<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>( 7, 4 );
+  test_parallel<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>( 1000, 0 );
+  test_parallel<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>( 64, 1 );
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_parallel )
+{
+  test_parallel<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>( 100, 3 );
+}
+
+BOOST_AUTO_TEST_CASE( xml_parallel )
+{
+  test_parallel<cereal::XMLInputArchive, cereal::XMLOutputArchive>( 100, 3 );
+}
+
+BOOST_AUTO_TEST_CASE( json_parallel )
+{
+  test_parallel<cereal::JSONInputArchive, cereal::JSONOutputArchive>( 100, 3 );
+}
+
+struct ParallelThrowing
+{
+  int x = 0;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    if( x == 500 )
+      throw cereal::Exception("element failed");
+    ar( x );
+  }
+
+  template <class Archive>
+  void load( Archive & ar ) { ar( x ); }
+};
+
+BOOST_AUTO_TEST_CASE( parallel_exception )
+{
+  std::vector<ParallelThrowing> o_vector( 1000 );
+  for( int i = 0; i < 1000; ++i )
+    o_vector[i].x = i;
+
+  std::ostringstream os;
+  cereal::BinaryOutputArchive oar( os );
+  BOOST_CHECK_THROW( oar( cereal::parallel( o_vector, 10, 4 ) ), cereal::Exception );
+}
+
+struct ParallelUserData
+{
+  int scale;
+};
+
+struct ParallelScaled
+{
+  int x = 0;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    ar( x * ar.template getUserData<ParallelUserData>()->scale );
+  }
+
+  template <class Archive>
+  void load( Archive & ar )
+  {
+    ar( x );
+    x /= ar.template getUserData<ParallelUserData>()->scale;
+  }
+};
+
+BOOST_AUTO_TEST_CASE( parallel_user_data )
+{
+  std::vector<ParallelScaled> o_vector( 100 );
+  for( int i = 0; i < 100; ++i )
+    o_vector[i].x = i;
+
+  ParallelUserData saving{3}, loading{3};
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar.setUserData( &saving );
+    oar( cereal::parallel( o_vector, 10, 4 ) );
+  }
+
+  std::vector<ParallelScaled> i_vector;
+  std::istringstream is( os.str() );
+  {
+    cereal::BinaryInputArchive iar( is );
+    iar.setUserData( &loading );
+    iar( cereal::parallel( i_vector, 10, 4 ) );
+  }
+
+  BOOST_REQUIRE_EQUAL( i_vector.size(), o_vector.size() );
+  for( std::size_t i = 0; i < i_vector.size(); ++i )
+    BOOST_CHECK_EQUAL( i_vector[i].x, o_vector[i].x );
+}
+
+BOOST_AUTO_TEST_CASE( parallel_load_limits )
+{
+  std::vector<std::vector<int>> o_vector( 10, std::vector<int>( 100 ) );
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar( cereal::parallel( o_vector, 2, 4 ) );
+  }
+
+  // the inner vectors are loaded by the chunk archives, one level below the wrapper
+  {
+    std::vector<std::vector<int>> i_vector;
+    std::istringstream is( os.str() );
+    cereal::BinaryInputArchive iar( is );
+    cereal::LoadLimits limits;
+    limits.maxDepth = 2;
+    iar.setLoadLimits( limits );
+    BOOST_CHECK_THROW( iar( cereal::parallel( i_vector ) ), cereal::Exception );
+  }
+
+  // and count against the total of the enclosing archive
+  {
+    std::vector<std::vector<int>> i_vector;
+    std::istringstream is( os.str() );
+    cereal::BinaryInputArchive iar( is );
+    cereal::LoadLimits limits;
+    limits.maxTotalElements = 100000;
+    iar.setLoadLimits( limits );
+    iar( cereal::parallel( i_vector ) );
+    BOOST_CHECK( i_vector == o_vector );
+
+    std::istringstream again( os.str() );
+    cereal::BinaryInputArchive iar2( again );
+    limits.maxTotalElements = os.str().size();
+    iar2.setLoadLimits( limits );
+    BOOST_CHECK_THROW( iar2( cereal::parallel( i_vector ) ), cereal::Exception );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( parallel_corrupt_sizes )
+{
+  std::vector<int> o_vector( 100 );
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar( cereal::parallel( o_vector, 10, 1 ) );
+  }
+  std::string const good = os.str();
+
+  // size, chunk size, chunk count and total bytes come before the chunk sizes
+  std::size_t const headerBytes = sizeof(cereal::size_type) * 3 + sizeof(std::uint64_t);
+
+  auto load = []( std::string const & data )
+  {
+    std::vector<int> i_vector;
+    std::istringstream is( data );
+    cereal::BinaryInputArchive iar( is );
+    iar( cereal::parallel( i_vector ) );
+  };
+
+  BOOST_CHECK_NO_THROW( load( good ) );
+
+  // a chunk that claims far more bytes than the total
+  {
+    std::string bad = good;
+    std::uint64_t const huge = (std::numeric_limits<std::uint64_t>::max)() - 8;
+    std::memcpy( &bad[headerBytes], &huge, sizeof(huge) );
+    BOOST_CHECK_THROW( load( bad ), cereal::Exception );
+  }
+
+  // chunks that do not add up to the total
+  {
+    std::string bad = good;
+    std::uint64_t smaller;
+    std::memcpy( &smaller, &bad[headerBytes], sizeof(smaller) );
+    --smaller;
+    std::memcpy( &bad[headerBytes], &smaller, sizeof(smaller) );
+    BOOST_CHECK_THROW( load( bad ), cereal::Exception );
+  }
+
+  // a chunk count that does not match the size
+  {
+    std::string bad = good;
+    cereal::size_type const chunks = 1000;
+    std::memcpy( &bad[sizeof(cereal::size_type) + sizeof(std::uint64_t)], &chunks, sizeof(chunks) );
+    BOOST_CHECK_THROW( load( bad ), cereal::Exception );
+  }
+}
@@ -26,6 +26,7 @@
 */
 #include "common.hpp"
 #include <boost/test/unit_test.hpp>
+#include <thread>
 
 struct PolyBase
 {
@@ -210,3 +211,301 @@ BOOST_AUTO_TEST_CASE( json_polymorphic )
   test_polymorphic<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
 }
 
+
+struct PolyIdBase
+{
+  virtual ~PolyIdBase() {}
+  virtual int get() const = 0;
+};
+
+struct PolyIdDerived : PolyIdBase
+{
+  PolyIdDerived() : x(0) {}
+  PolyIdDerived( int xx ) : x(xx) {}
+  int x;
+
+  int get() const { return x; }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+};
+
+struct PolyIdDerivedOther : PolyIdBase
+{
+  PolyIdDerivedOther() : x(0) {}
+  PolyIdDerivedOther( int xx ) : x(xx) {}
+  int x;
+
+  int get() const { return -x; }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+};
+
+CEREAL_REGISTER_TYPE_WITH_ID(PolyIdDerived, 42)
+CEREAL_REGISTER_TYPE_WITH_ID(PolyIdDerivedOther, 7)
+
+template <class IArchive, class OArchive>
+std::string test_polymorphic_id()
+{
+  std::vector<std::shared_ptr<PolyIdBase>> o_shared;
+  for( int i = 0; i < 10; ++i )
+  {
+    if( i % 3 )
+      o_shared.push_back( std::make_shared<PolyIdDerived>( i ) );
+    else
+      o_shared.push_back( std::make_shared<PolyIdDerivedOther>( i ) );
+  }
+  std::unique_ptr<PolyIdBase> o_unique( new PolyIdDerived( 99 ) );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_shared, o_unique );
+  }
+
+  std::vector<std::shared_ptr<PolyIdBase>> i_shared;
+  std::unique_ptr<PolyIdBase> i_unique;
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( i_shared, i_unique );
+  }
+
+  BOOST_REQUIRE_EQUAL( i_shared.size(), o_shared.size() );
+  for( std::size_t i = 0; i < o_shared.size(); ++i )
+    BOOST_CHECK_EQUAL( i_shared[i]->get(), o_shared[i]->get() );
+  BOOST_CHECK_EQUAL( i_unique->get(), 99 );
+
+  return os.str();
+}
+
+BOOST_AUTO_TEST_CASE( polymorphic_id )
+{
+  auto const binary = test_polymorphic_id<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+  BOOST_CHECK( binary.find( "PolyIdDerived" ) == std::string::npos );
+
+  auto const portable = test_polymorphic_id<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+  BOOST_CHECK( portable.find( "PolyIdDerived" ) == std::string::npos );
+
+  auto const json = test_polymorphic_id<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+  BOOST_CHECK( json.find( "PolyIdDerived" ) != std::string::npos );
+
+  test_polymorphic_id<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( polymorphic_id_unregistered )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    std::uint32_t const id = 1234 | cereal::detail::msb3_32bit;
+    oar( id );
+  }
+
+  std::shared_ptr<PolyIdBase> i_shared;
+  std::istringstream is(os.str());
+  cereal::BinaryInputArchive iar(is);
+  BOOST_CHECK_THROW( iar( i_shared ), cereal::Exception );
+}
+
+BOOST_AUTO_TEST_CASE( polymorphic_name_ids )
+{
+  // repeated types are found again by their id
+  std::vector<std::shared_ptr<PolyBase>> o_shared;
+  for( int i = 0; i < 10; ++i )
+    o_shared.push_back( std::make_shared<PolyDerived>( i, 1.0f, true, 2.0 ) );
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( o_shared );
+  }
+
+  std::vector<std::shared_ptr<PolyBase>> i_shared;
+  {
+    std::istringstream is(os.str());
+    cereal::BinaryInputArchive iar(is);
+    iar( i_shared );
+  }
+  BOOST_REQUIRE_EQUAL( i_shared.size(), o_shared.size() );
+  for( std::size_t i = 0; i < o_shared.size(); ++i )
+    BOOST_CHECK_EQUAL( *std::dynamic_pointer_cast<PolyDerived>( i_shared[i] ), *std::dynamic_pointer_cast<PolyDerived>( o_shared[i] ) );
+
+  // an id that was never registered, and a name registered out of order
+  for( std::uint32_t const id : { std::uint32_t(3), std::uint32_t(2 | cereal::detail::msb_32bit) } )
+  {
+    std::ostringstream bad;
+    {
+      cereal::BinaryOutputArchive oar(bad);
+      oar( id, std::string("PolyDerived") );
+    }
+
+    std::shared_ptr<PolyBase> ptr;
+    std::istringstream is(bad.str());
+    cereal::BinaryInputArchive iar(is);
+    BOOST_CHECK_THROW( iar( ptr ), cereal::Exception );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( polymorphic_concurrent )
+{
+  std::vector<int> results( 8, 0 );
+  std::vector<std::thread> threads;
+
+  for( std::size_t t = 0; t < results.size(); ++t )
+    threads.emplace_back( [t, &results]()
+    {
+      for( int i = 0; i < 100; ++i )
+      {
+        std::shared_ptr<PolyIdBase> o_shared = std::make_shared<PolyIdDerived>( i );
+        std::shared_ptr<PolyBase> o_named = std::make_shared<PolyDerived>( i, 1.0f, true, 2.0 );
+
+        std::ostringstream os;
+        {
+          cereal::PortableBinaryOutputArchive oar(os);
+          oar( o_shared, o_named );
+        }
+
+        std::shared_ptr<PolyIdBase> i_shared;
+        std::shared_ptr<PolyBase> i_named;
+        std::istringstream is(os.str());
+        {
+          cereal::PortableBinaryInputArchive iar(is);
+          iar( i_shared, i_named );
+        }
+
+        if( i_shared->get() == i && *static_cast<PolyDerived*>( i_named.get() ) == *static_cast<PolyDerived*>( o_named.get() ) )
+          ++results[t];
+      }
+    } );
+
+  for( auto & thread : threads )
+    thread.join();
+
+  for( auto r : results )
+    BOOST_CHECK_EQUAL( r, 100 );
+}
+
+struct PolyFinal final : PolyIdBase
+{
+  PolyFinal() : x(0) {}
+  PolyFinal( int xx ) : x(xx) {}
+  int x;
+
+  int get() const { return x * 2; }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+};
+
+static_assert( cereal::polymorphic_detail::is_final<PolyFinal>::value, "PolyFinal is final" );
+static_assert( !cereal::polymorphic_detail::is_final<PolyIdDerived>::value, "PolyIdDerived is not final" );
+
+BOOST_AUTO_TEST_CASE( polymorphic_final )
+{
+  // a final type needs no registration when saved through a pointer to itself
+  std::shared_ptr<PolyFinal> o_shared = std::make_shared<PolyFinal>( 3 );
+  std::unique_ptr<PolyFinal> o_unique( new PolyFinal( 4 ) );
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( o_shared, o_unique );
+  }
+
+  std::shared_ptr<PolyFinal> i_shared;
+  std::unique_ptr<PolyFinal> i_unique;
+  std::istringstream is(os.str());
+  {
+    cereal::BinaryInputArchive iar(is);
+    iar( i_shared, i_unique );
+  }
+
+  BOOST_CHECK_EQUAL( i_shared->x, 3 );
+  BOOST_CHECK_EQUAL( i_unique->x, 4 );
+}
+
+template <class IArchive, class OArchive>
+void test_polymorphic_homogeneous()
+{
+  std::vector<std::shared_ptr<PolyBase>> o_shared;
+  for( int i = 0; i < 100; ++i )
+    o_shared.push_back( std::make_shared<PolyDerived>( i, 1.5f, i % 2 == 0, i * 0.25 ) );
+  o_shared.push_back( o_shared.front() ); // shared pointers are still tracked
+
+  std::vector<std::unique_ptr<PolyIdBase>> o_unique;
+  for( int i = 0; i < 10; ++i )
+    o_unique.emplace_back( new PolyIdDerivedOther( i ) );
+
+  std::vector<std::shared_ptr<PolyIdDerived>> o_exact( 3, std::make_shared<PolyIdDerived>( 5 ) );
+  std::vector<std::shared_ptr<PolyBase>> o_empty;
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::homogeneous( o_shared ), cereal::homogeneous( o_unique ),
+         cereal::homogeneous( o_exact ), cereal::homogeneous( o_empty ) );
+  }
+
+  std::vector<std::shared_ptr<PolyBase>> i_shared;
+  std::vector<std::unique_ptr<PolyIdBase>> i_unique;
+  std::vector<std::shared_ptr<PolyIdDerived>> i_exact;
+  std::vector<std::shared_ptr<PolyBase>> i_empty( 2 );
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::homogeneous( i_shared ), cereal::homogeneous( i_unique ),
+         cereal::homogeneous( i_exact ), cereal::homogeneous( i_empty ) );
+  }
+
+  BOOST_REQUIRE_EQUAL( i_shared.size(), o_shared.size() );
+  for( std::size_t i = 0; i < o_shared.size(); ++i )
+    BOOST_CHECK_EQUAL( *std::dynamic_pointer_cast<PolyDerived>( i_shared[i] ), *std::dynamic_pointer_cast<PolyDerived>( o_shared[i] ) );
+  BOOST_CHECK( i_shared.back() == i_shared.front() );
+
+  BOOST_REQUIRE_EQUAL( i_unique.size(), o_unique.size() );
+  for( std::size_t i = 0; i < o_unique.size(); ++i )
+    BOOST_CHECK_EQUAL( i_unique[i]->get(), o_unique[i]->get() );
+
+  BOOST_REQUIRE_EQUAL( i_exact.size(), 3u );
+  BOOST_CHECK_EQUAL( i_exact[2]->x, 5 );
+  BOOST_CHECK( i_empty.empty() );
+}
+
+BOOST_AUTO_TEST_CASE( polymorphic_homogeneous )
+{
+  test_polymorphic_homogeneous<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+  test_polymorphic_homogeneous<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+  test_polymorphic_homogeneous<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+  test_polymorphic_homogeneous<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+
+  // the type metadata is only written once
+  std::vector<std::shared_ptr<PolyBase>> shapes;
+  for( int i = 0; i < 10; ++i )
+    shapes.push_back( std::make_shared<PolyDerived>( i, 1.0f, true, 2.0 ) );
+
+  std::ostringstream each, once;
+  {
+    cereal::BinaryOutputArchive oar(each);
+    oar( shapes );
+  }
+  {
+    cereal::BinaryOutputArchive oar(once);
+    oar( cereal::homogeneous( shapes ) );
+  }
+  BOOST_CHECK_EQUAL( each.str().size() - once.str().size(), 9 * sizeof(std::uint32_t) );
+
+  // mixed or null pointers are refused
+  std::vector<std::shared_ptr<PolyIdBase>> mixed = { std::make_shared<PolyIdDerived>( 1 ), std::make_shared<PolyIdDerivedOther>( 2 ) };
+  std::vector<std::shared_ptr<PolyIdBase>> null = { std::make_shared<PolyIdDerived>( 1 ), nullptr };
+  std::ostringstream os;
+  cereal::BinaryOutputArchive oar(os);
+  BOOST_CHECK_THROW( oar( cereal::homogeneous( mixed ) ), cereal::Exception );
+  BOOST_CHECK_THROW( oar( cereal::homogeneous( null ) ), cereal::Exception );
+}
@@ -0,0 +1,87 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#define CEREAL_SHARED_BINDING_REGISTRY
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+// Normally placed in a single library of a program
+CEREAL_DEFINE_SHARED_BINDING_REGISTRY
+
+struct SharedRegistryBase
+{
+  virtual ~SharedRegistryBase() {}
+  virtual int get() const = 0;
+};
+
+struct SharedRegistryDerived : SharedRegistryBase
+{
+  SharedRegistryDerived() : x(0) {}
+  SharedRegistryDerived( int xx ) : x(xx) {}
+  int x;
+
+  int get() const { return x; }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+};
+
+CEREAL_REGISTER_TYPE(SharedRegistryDerived)
+
+BOOST_AUTO_TEST_CASE( polymorphic_shared_registry )
+{
+  typedef cereal::detail::OutputBindingMap<cereal::BinaryOutputArchive> OutputMap;
+  typedef cereal::detail::InputBindingMap<cereal::BinaryInputArchive> InputMap;
+
+  // the registries are the ones held by the shared instance
+  auto & registries = cereal::detail::getSharedBindingRegistries();
+  auto & output = cereal::detail::getBindingRegistry<OutputMap>();
+  BOOST_CHECK_EQUAL( registries.get( typeid(OutputMap), nullptr ), static_cast<void *>( &output ) );
+
+  std::shared_ptr<SharedRegistryBase> o_ptr = std::make_shared<SharedRegistryDerived>( 5 );
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( o_ptr );
+  }
+
+  std::shared_ptr<SharedRegistryBase> i_ptr;
+  std::istringstream is(os.str());
+  {
+    cereal::BinaryInputArchive iar(is);
+    iar( i_ptr );
+  }
+  BOOST_CHECK_EQUAL( i_ptr->get(), 5 );
+
+  // registering a type again, as another library would, is ignored
+  BOOST_CHECK( !output.defer( &cereal::detail::OutputBindingCreator<cereal::BinaryOutputArchive, SharedRegistryDerived>::create,
+                              std::type_index( typeid(SharedRegistryDerived) ) ) );
+  BOOST_CHECK( !cereal::detail::getBindingRegistry<InputMap>().defer(
+                 &cereal::detail::InputBindingCreator<cereal::BinaryInputArchive, SharedRegistryDerived>::create,
+                 "SharedRegistryDerived" ) );
+  BOOST_CHECK_EQUAL( &cereal::detail::getBindingMap<OutputMap>(), &cereal::detail::getBindingMap<OutputMap>() );
+}
@@ -153,3 +153,105 @@ BOOST_AUTO_TEST_CASE( portable_binary_archive )
   }
 }
 
+
+template <class T>
+void test_portable_binary_swapped_vector( std::mt19937 & gen, std::size_t size )
+{
+  std::vector<T> o_data( size );
+  for( auto & v : o_data )
+    v = random_value<T>(gen);
+
+  std::vector<T> swapped = o_data;
+  for( auto & v : swapped )
+    swapBytes(v);
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    // manually insert incorrect endian encoding
+    oar(!cereal::portable_binary_detail::is_little_endian());
+    cereal::size_type swapped_size = size;
+    swapBytes(swapped_size);
+    oar(cereal::make_size_tag(swapped_size));
+    oar(cereal::binary_data(swapped.data(), size * sizeof(T)));
+  }
+
+  std::vector<T> i_data;
+  std::istringstream is(os.str());
+  {
+    cereal::PortableBinaryInputArchive iar(is);
+    iar(i_data);
+  }
+
+  BOOST_CHECK_EQUAL( i_data.size(), o_data.size() );
+  BOOST_CHECK( std::memcmp( i_data.data(), o_data.data(), size * sizeof(T) ) == 0 );
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_archive_bulk_swap )
+{
+  std::mt19937 gen(1234);
+
+  // cover every tail length after whole vector registers
+  for( std::size_t size = 0; size < 70; ++size )
+  {
+    test_portable_binary_swapped_vector<std::uint16_t>( gen, size );
+    test_portable_binary_swapped_vector<std::int32_t>( gen, size );
+    test_portable_binary_swapped_vector<float>( gen, size );
+    test_portable_binary_swapped_vector<std::uint64_t>( gen, size );
+    test_portable_binary_swapped_vector<double>( gen, size );
+    test_portable_binary_swapped_vector<std::uint8_t>( gen, size );
+  }
+
+  test_portable_binary_swapped_vector<double>( gen, 100000 );
+}
+
+void test_portable_binary_endianness( cereal::PortableBinaryOutputArchive::Options const & options, bool little )
+{
+  std::mt19937 gen(5678);
+
+  std::uint32_t const o_word = 0x01020304;
+  std::vector<double> o_doubles( 1000 );
+  for( auto & v : o_doubles )
+    v = random_value<double>(gen);
+  std::vector<std::int16_t> o_shorts( 5000 );
+  for( auto & v : o_shorts )
+    v = random_value<std::int16_t>(gen);
+  std::map<std::string, std::uint64_t> o_map;
+  for( int i = 0; i < 50; ++i )
+    o_map.emplace( random_basic_string<char>(gen), random_value<std::uint64_t>(gen) );
+
+  std::ostringstream os;
+  {
+    cereal::PortableBinaryOutputArchive oar(os, options);
+    oar(o_word, o_doubles, o_shorts, o_map);
+  }
+
+  auto const data = os.str();
+  BOOST_CHECK_EQUAL( static_cast<bool>( data[0] ), little );
+  BOOST_CHECK_EQUAL( static_cast<int>( data[1] ), little ? 4 : 1 );
+  BOOST_CHECK_EQUAL( static_cast<int>( data[4] ), little ? 1 : 4 );
+
+  std::uint32_t i_word;
+  std::vector<double> i_doubles;
+  std::vector<std::int16_t> i_shorts;
+  std::map<std::string, std::uint64_t> i_map;
+
+  std::istringstream is(data);
+  {
+    cereal::PortableBinaryInputArchive iar(is);
+    iar(i_word, i_doubles, i_shorts, i_map);
+  }
+
+  BOOST_CHECK_EQUAL( i_word, o_word );
+  BOOST_CHECK( i_doubles.size() == o_doubles.size() && std::memcmp( i_doubles.data(), o_doubles.data(), o_doubles.size() * sizeof(double) ) == 0 );
+  BOOST_CHECK_EQUAL_COLLECTIONS( i_shorts.begin(), i_shorts.end(), o_shorts.begin(), o_shorts.end() );
+  BOOST_CHECK( i_map == o_map );
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_archive_output_endianness )
+{
+  test_portable_binary_endianness( cereal::PortableBinaryOutputArchive::Options::LittleEndian(), true );
+  test_portable_binary_endianness( cereal::PortableBinaryOutputArchive::Options::BigEndian(), false );
+  test_portable_binary_endianness( cereal::PortableBinaryOutputArchive::Options::Default(),
+                                   cereal::portable_binary_detail::is_little_endian() );
+}
@@ -103,6 +103,45 @@ void test_priority_queue()
   }
 }
 
+template <class IArchive, class OArchive>
+void test_priority_queue_trusted_heap()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::priority_queue<int> o_podpriority_queue;
+  for(int j=0; j<1000; ++j)
+    o_podpriority_queue.push(random_value<int>(gen));
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::trusted_heap( o_podpriority_queue ) );
+  }
+
+  // Existing contents are replaced
+  std::priority_queue<int> i_podpriority_queue;
+  i_podpriority_queue.push(1);
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::trusted_heap( i_podpriority_queue ) );
+  }
+
+  auto & i_podpriority_queue_c = cereal::queue_detail::container(i_podpriority_queue);
+  auto & o_podpriority_queue_c = cereal::queue_detail::container(o_podpriority_queue);
+  BOOST_CHECK_EQUAL_COLLECTIONS(i_podpriority_queue_c.begin(), i_podpriority_queue_c.end(), o_podpriority_queue_c.begin(), o_podpriority_queue_c.end());
+
+  while( !o_podpriority_queue.empty() )
+  {
+    BOOST_CHECK_EQUAL(i_podpriority_queue.top(), o_podpriority_queue.top());
+    i_podpriority_queue.pop();
+    o_podpriority_queue.pop();
+  }
+  BOOST_CHECK(i_podpriority_queue.empty());
+}
+
 BOOST_AUTO_TEST_CASE( binary_priority_queue )
 {
   test_priority_queue<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
@@ -123,3 +162,13 @@ BOOST_AUTO_TEST_CASE( json_priority_queue )
   test_priority_queue<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
 }
 
+
+BOOST_AUTO_TEST_CASE( binary_priority_queue_trusted_heap )
+{
+  test_priority_queue_trusted_heap<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_priority_queue_trusted_heap )
+{
+  test_priority_queue_trusted_heap<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
@@ -0,0 +1,226 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/adapters.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct ProfiledLeg
+{
+  double price = 0;
+  std::string venue;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(price), CEREAL_NVP(venue) ); }
+};
+
+struct ProfiledOrder
+{
+  std::uint64_t id = 0;
+  std::vector<ProfiledLeg> legs;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(id), CEREAL_NVP(legs) ); }
+};
+
+struct ProfiledBook
+{
+  std::vector<ProfiledOrder> orders;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(orders) ); }
+};
+
+static ProfiledBook makeProfiledBook()
+{
+  ProfiledBook book;
+  book.orders.resize( 5 );
+  for( std::size_t i = 0; i < book.orders.size(); ++i )
+  {
+    book.orders[i].id = i;
+    book.orders[i].legs.resize( 3 );
+    for( auto & leg : book.orders[i].legs )
+    {
+      leg.price = 1.5 * static_cast<double>( i );
+      leg.venue = "venue";
+    }
+  }
+  return book;
+}
+
+static cereal::Profile::Node const * findPath( cereal::Profile::Node const & root, std::vector<std::string> const & path )
+{
+  auto node = &root;
+  for( auto const & name : path )
+  {
+    cereal::Profile::Node const * next = nullptr;
+    for( auto const & c : node->children )
+      if( c->name == name )
+        next = c.get();
+    if( !next )
+      return nullptr;
+    node = next;
+  }
+  return node;
+}
+
+template <class IArchive, class OArchive>
+void test_profiling_adapter( bool countsBytes )
+{
+  ProfiledBook const o_book = makeProfiledBook();
+
+  std::ostringstream os;
+  cereal::Profile saved;
+  {
+    cereal::ProfilingAdapter<OArchive> oar( saved, os );
+    oar( cereal::make_nvp( "root", o_book ) );
+  }
+
+  auto price = findPath( saved.root(), { "root", "orders", "[]", "legs", "[]", "price" } );
+  BOOST_REQUIRE( price );
+  BOOST_CHECK_EQUAL( price->entry.count, 15 );
+
+  auto orders = findPath( saved.root(), { "root", "orders" } );
+  BOOST_REQUIRE( orders );
+  BOOST_CHECK_EQUAL( orders->entry.count, 1 );
+  BOOST_CHECK_EQUAL( findPath( saved.root(), { "root", "orders", "[]" } )->entry.count, 5 );
+
+  BOOST_CHECK_EQUAL( saved.types().at( typeid(ProfiledLeg) ).count, 15 );
+  BOOST_CHECK_EQUAL( saved.types().at( typeid(double) ).count, 15 );
+
+  if( countsBytes )
+  {
+    auto root = findPath( saved.root(), { "root" } );
+    BOOST_CHECK_GT( price->entry.bytes, 0 );
+    BOOST_CHECK_GE( orders->entry.bytes, price->entry.bytes );
+    BOOST_CHECK_LE( root->entry.bytes, os.str().size() );
+  }
+
+  std::ostringstream folded;
+  saved.writeFoldedStacks( folded, countsBytes ? cereal::Profile::Metric::bytes : cereal::Profile::Metric::microseconds );
+  if( countsBytes )
+    BOOST_CHECK( folded.str().find( "root;orders[];legs[];price " ) != std::string::npos );
+
+  std::ostringstream report;
+  saved.report( report );
+  BOOST_CHECK( report.str().find( "root.orders[].legs[].price" ) != std::string::npos );
+
+  ProfiledBook i_book;
+  std::istringstream is( os.str() );
+  cereal::Profile loaded;
+  {
+    cereal::ProfilingAdapter<IArchive> iar( loaded, is );
+    iar( cereal::make_nvp( "root", i_book ) );
+  }
+
+  BOOST_REQUIRE_EQUAL( i_book.orders.size(), o_book.orders.size() );
+  BOOST_CHECK_EQUAL( i_book.orders.back().legs.back().price, o_book.orders.back().legs.back().price );
+
+  auto loadedPrice = findPath( loaded.root(), { "root", "orders", "[]", "legs", "[]", "price" } );
+  BOOST_REQUIRE( loadedPrice );
+  BOOST_CHECK_EQUAL( loadedPrice->entry.count, 15 );
+}
+
+BOOST_AUTO_TEST_CASE( binary_profiling_adapter )
+{
+  test_profiling_adapter<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>( true );
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_profiling_adapter )
+{
+  test_profiling_adapter<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>( true );
+}
+
+BOOST_AUTO_TEST_CASE( json_profiling_adapter )
+{
+  test_profiling_adapter<cereal::JSONInputArchive, cereal::JSONOutputArchive>( false );
+}
+
+BOOST_AUTO_TEST_CASE( xml_profiling_adapter )
+{
+  test_profiling_adapter<cereal::XMLInputArchive, cereal::XMLOutputArchive>( false );
+}
+
+BOOST_AUTO_TEST_CASE( profiling_adapter_unnamed_root )
+{
+  std::ostringstream os;
+  cereal::Profile profile;
+  {
+    cereal::ProfilingAdapter<cereal::BinaryOutputArchive> oar( profile, os );
+    oar( makeProfiledBook(), makeProfiledBook() );
+  }
+
+  // unnamed top level values are named after their type and aggregated
+  BOOST_REQUIRE_EQUAL( profile.root().children.size(), 1 );
+  BOOST_CHECK_EQUAL( profile.root().children[0]->entry.count, 2 );
+  BOOST_CHECK_EQUAL( profile.root().children[0]->entry.bytes, os.str().size() );
+
+  profile.clear();
+  BOOST_CHECK( profile.root().children.empty() );
+  BOOST_CHECK( profile.types().empty() );
+}
+
+BOOST_AUTO_TEST_CASE( profiling_adapter_arithmetic_runs )
+{
+  // adjacent arithmetic values are usually packed together by the binary archives,
+  // but each must still be seen by the profile
+  std::ostringstream os;
+  cereal::Profile saved;
+  {
+    cereal::ProfilingAdapter<cereal::BinaryOutputArchive> oar( saved, os );
+    oar( 1, 2.5, std::int16_t( 3 ) );
+    oar( 4, 5 );
+  }
+
+  BOOST_CHECK_EQUAL( os.str().size(), 3 * sizeof(int) + sizeof(double) + sizeof(std::int16_t) );
+  BOOST_CHECK_EQUAL( saved.types().at( typeid(int) ).count, 3 );
+  BOOST_CHECK_EQUAL( saved.types().at( typeid(double) ).count, 1 );
+  BOOST_CHECK_EQUAL( saved.types().at( typeid(std::int16_t) ).count, 1 );
+  BOOST_CHECK_EQUAL( saved.types().at( typeid(int) ).bytes, 3 * sizeof(int) );
+  BOOST_CHECK_EQUAL( saved.types().at( typeid(double) ).bytes, sizeof(double) );
+
+  int a = 0, d = 0, e = 0;
+  double b = 0;
+  std::int16_t c = 0;
+  std::istringstream is( os.str() );
+  cereal::Profile loaded;
+  {
+    cereal::ProfilingAdapter<cereal::BinaryInputArchive> iar( loaded, is );
+    iar( a, b, c );
+    iar( d, e );
+  }
+
+  BOOST_CHECK_EQUAL( a + d + e, 10 );
+  BOOST_CHECK_EQUAL( b, 2.5 );
+  BOOST_CHECK_EQUAL( c, 3 );
+  BOOST_CHECK_EQUAL( loaded.types().at( typeid(int) ).count, 3 );
+  BOOST_CHECK_EQUAL( loaded.types().at( typeid(double) ).count, 1 );
+  BOOST_CHECK_EQUAL( loaded.types().at( typeid(std::int16_t) ).count, 1 );
+  BOOST_CHECK_EQUAL( loaded.types().at( typeid(double) ).bytes, sizeof(double) );
+}
@@ -0,0 +1,173 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/types/quantized.hpp>
+#include <boost/test/unit_test.hpp>
+
+template <class IArchive, class OArchive, class T>
+void test_quantized_roundtrip( std::vector<T> const & o_vector, std::vector<T> & i_f16, std::vector<T> & i_bf16, std::vector<T> & i_int8 )
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::as_float16( o_vector ),
+         cereal::as_bfloat16( o_vector ),
+         cereal::as_scaled_int8( o_vector ) );
+  }
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::as_float16( i_f16 ),
+         cereal::as_bfloat16( i_bf16 ),
+         cereal::as_scaled_int8( i_int8 ) );
+  }
+}
+
+template <class IArchive, class OArchive, class T>
+void test_quantized_type()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_real_distribution<T> dist( -4, 4 );
+
+  for(int ii=0; ii<10; ++ii)
+  {
+    std::vector<T> o_vector;
+    for(int j=0; j<1001; ++j)
+      o_vector.push_back( dist(gen) );
+
+    std::vector<T> i_f16, i_bf16, i_int8;
+    test_quantized_roundtrip<IArchive, OArchive>( o_vector, i_f16, i_bf16, i_int8 );
+
+    BOOST_REQUIRE_EQUAL( i_f16.size(), o_vector.size() );
+    BOOST_REQUIRE_EQUAL( i_bf16.size(), o_vector.size() );
+    BOOST_REQUIRE_EQUAL( i_int8.size(), o_vector.size() );
+
+    auto const range = std::minmax_element( o_vector.begin(), o_vector.end() );
+    auto const step = ( *range.second - *range.first ) / 255;
+
+    for( std::size_t i = 0; i < o_vector.size(); ++i )
+    {
+      auto const x = o_vector[i];
+      BOOST_CHECK_LE( std::abs( i_f16[i] - x ), std::abs( x ) / 2048 + T( 1e-7 ) );
+      BOOST_CHECK_LE( std::abs( i_bf16[i] - x ), std::abs( x ) / 256 );
+      BOOST_CHECK_LE( std::abs( i_int8[i] - x ), step / 2 + T( 1e-5 ) );
+    }
+  }
+
+  // empty and constant vectors
+  std::vector<T> i_f16( 3 ), i_bf16( 3 ), i_int8( 3 );
+  test_quantized_roundtrip<IArchive, OArchive>( std::vector<T>(), i_f16, i_bf16, i_int8 );
+  BOOST_CHECK( i_f16.empty() && i_bf16.empty() && i_int8.empty() );
+
+  std::vector<T> const constant( 10, T( 1.5 ) );
+  test_quantized_roundtrip<IArchive, OArchive>( constant, i_f16, i_bf16, i_int8 );
+  BOOST_CHECK( i_f16 == constant && i_bf16 == constant && i_int8 == constant );
+}
+
+template <class IArchive, class OArchive>
+void test_quantized()
+{
+  test_quantized_type<IArchive, OArchive, float>();
+  test_quantized_type<IArchive, OArchive, double>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_quantized )
+{
+  test_quantized<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_quantized )
+{
+  test_quantized<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_quantized )
+{
+  test_quantized<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_quantized )
+{
+  test_quantized<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_quantized_size )
+{
+  std::vector<float> const values( 1000, 0.5f );
+
+  std::ostringstream f16, int8;
+  {
+    cereal::BinaryOutputArchive oar( f16 );
+    oar( cereal::as_float16( values ) );
+  }
+  {
+    cereal::BinaryOutputArchive oar( int8 );
+    oar( cereal::as_scaled_int8( values ) );
+  }
+
+  BOOST_CHECK_EQUAL( f16.str().size(), sizeof(cereal::size_type) + 2000 );
+  BOOST_CHECK_EQUAL( int8.str().size(), 2 * sizeof(float) + sizeof(cereal::size_type) + 1000 );
+}
+
+BOOST_AUTO_TEST_CASE( quantized_half_conversion )
+{
+  using namespace cereal::quantized_detail;
+
+  BOOST_CHECK_EQUAL( float_to_half( 1.0f ), 0x3C00 );
+  BOOST_CHECK_EQUAL( float_to_half( -2.0f ), 0xC000 );
+  BOOST_CHECK_EQUAL( float_to_half( 65504.0f ), 0x7BFF );
+  BOOST_CHECK_EQUAL( float_to_half( 65520.0f ), 0x7C00 );
+  BOOST_CHECK_EQUAL( float_to_half( std::numeric_limits<float>::infinity() ), 0x7C00 );
+  BOOST_CHECK_EQUAL( float_to_half( std::ldexp( 1.0f, -24 ) ), 0x0001 );
+  BOOST_CHECK_EQUAL( float_to_half( std::ldexp( 1.0f, -26 ) ), 0x0000 );
+  BOOST_CHECK_EQUAL( float_to_half( 1.0f + std::ldexp( 1.0f, -11 ) ), 0x3C00 ); // ties to even
+  BOOST_CHECK( std::isnan( half_to_float( float_to_half( std::numeric_limits<float>::quiet_NaN() ) ) ) );
+
+  // every half precision value converts to float and back exactly
+  for( std::uint32_t h = 0; h < 0x10000; ++h )
+  {
+    auto const f = half_to_float( static_cast<std::uint16_t>( h ) );
+    if( !std::isnan( f ) )
+      BOOST_CHECK_EQUAL( float_to_half( f ), h );
+  }
+
+  // the vectorized conversion, if any, matches the scalar one
+  std::vector<float> values;
+  for( std::uint32_t h = 0; h < 0x10000; h += 7 )
+    if( ( h & 0x7C00 ) != 0x7C00 )
+      values.push_back( half_to_float( static_cast<std::uint16_t>( h ) ) * 1.0001f );
+
+  std::vector<std::uint16_t> halves( values.size() );
+  to_half( values.data(), values.size(), halves.data() );
+  for( std::size_t i = 0; i < values.size(); ++i )
+    BOOST_CHECK_EQUAL( halves[i], float_to_half( values[i] ) );
+
+  BOOST_CHECK_EQUAL( float_to_bfloat16( 1.0f ), 0x3F80 );
+  BOOST_CHECK_EQUAL( bfloat16_to_float( 0xC040 ), -3.0f );
+}
@@ -0,0 +1,209 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/types/range.hpp>
+#include <boost/test/unit_test.hpp>
+#include <iterator>
+
+namespace
+{
+  struct RangeTrivial
+  {
+    std::int32_t a;
+    float b;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( a, b ); }
+
+    bool operator==( RangeTrivial const & other ) const
+    { return a == other.a && b == other.b; }
+
+    bool operator!=( RangeTrivial const & other ) const
+    { return !(*this == other); }
+  };
+
+  inline std::ostream& operator<<(std::ostream& os, RangeTrivial const & t)
+  { return os << "[" << t.a << " " << t.b << "]"; }
+}
+
+CEREAL_TRIVIALLY_SERIALIZABLE( RangeTrivial )
+
+//! Saves a range and a vector holding the same elements, and checks that they match
+//! both as vectors and through consume
+template <class IArchive, class OArchive, class T, class Iterator> inline
+void test_range_matches_vector( std::vector<T> const & expected, Iterator begin, Iterator end )
+{
+  std::ostringstream fromRange, fromVector;
+  {
+    OArchive ar( fromRange );
+    ar( cereal::make_nvp( "values", cereal::range( begin, end ) ) );
+  }
+  {
+    OArchive ar( fromVector );
+    ar( cereal::make_nvp( "values", expected ) );
+  }
+  BOOST_CHECK( fromRange.str() == fromVector.str() );
+
+  std::vector<T> loaded;
+  {
+    std::istringstream is( fromRange.str() );
+    IArchive ar( is );
+    ar( cereal::make_nvp( "values", loaded ) );
+  }
+  BOOST_CHECK_EQUAL_COLLECTIONS( loaded.begin(), loaded.end(), expected.begin(), expected.end() );
+
+  std::vector<T> consumed;
+  {
+    std::istringstream is( fromVector.str() );
+    IArchive ar( is );
+    ar( cereal::make_nvp( "values", cereal::consume<T>( [&]( T && t ) { consumed.push_back( std::move( t ) ); } ) ) );
+  }
+  BOOST_CHECK_EQUAL_COLLECTIONS( consumed.begin(), consumed.end(), expected.begin(), expected.end() );
+
+  std::unique_ptr<T[]> buffer( new T[expected.size() + 1] );
+  std::size_t count = 0;
+  {
+    std::istringstream is( fromVector.str() );
+    IArchive ar( is );
+    ar( cereal::make_nvp( "values", cereal::into( buffer.get(), expected.size() + 1, count ) ) );
+  }
+  BOOST_CHECK_EQUAL_COLLECTIONS( buffer.get(), buffer.get() + count, expected.begin(), expected.end() );
+}
+
+template <class IArchive, class OArchive> inline
+void test_range()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( auto size : {0, 1, 63, 64, 65, 3000} )
+  {
+    std::vector<int> ints;
+    std::vector<RangeTrivial> trivials;
+    std::vector<std::string> strings;
+    std::vector<bool> bools;
+    for( int i = 0; i < size; ++i )
+    {
+      ints.push_back( random_value<int>( gen ) );
+      trivials.push_back( { random_value<std::int32_t>( gen ), random_value<std::int16_t>( gen ) / 4.0f } );
+      strings.push_back( random_basic_string<char>( gen ) );
+      bools.push_back( random_value<int>( gen ) % 2 == 0 );
+    }
+
+    std::list<int> intList( ints.begin(), ints.end() );
+    std::list<RangeTrivial> trivialList( trivials.begin(), trivials.end() );
+    std::list<std::string> stringList( strings.begin(), strings.end() );
+    std::deque<bool> boolDeque( bools.begin(), bools.end() );
+
+    test_range_matches_vector<IArchive, OArchive>( ints, intList.begin(), intList.end() );
+    test_range_matches_vector<IArchive, OArchive>( ints, ints.data(), ints.data() + ints.size() );
+    test_range_matches_vector<IArchive, OArchive>( trivials, trivialList.begin(), trivialList.end() );
+    test_range_matches_vector<IArchive, OArchive>( strings, stringList.begin(), stringList.end() );
+    test_range_matches_vector<IArchive, OArchive>( bools, boolDeque.begin(), boolDeque.end() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_range )
+{
+  test_range<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_range )
+{
+  test_range<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_range )
+{
+  test_range<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_range )
+{
+  test_range<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( range_input_iterator )
+{
+  std::istringstream numbers( "1 2 3 4 5" );
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive ar( os );
+    ar( cereal::range( std::istream_iterator<int>( numbers ), std::istream_iterator<int>(), 5 ) );
+  }
+
+  std::vector<int> loaded;
+  {
+    std::istringstream is( os.str() );
+    cereal::BinaryInputArchive ar( is );
+    ar( loaded );
+  }
+  BOOST_CHECK( loaded == std::vector<int>( {1, 2, 3, 4, 5} ) );
+}
+
+BOOST_AUTO_TEST_CASE( range_count_mismatch )
+{
+  std::list<int> values = {1, 2, 3};
+  std::ostringstream os;
+  cereal::BinaryOutputArchive ar( os );
+  BOOST_CHECK_THROW( ar( cereal::range( values.begin(), values.end(), 4 ) ), cereal::Exception );
+  BOOST_CHECK_THROW( ar( cereal::range( values.begin(), values.end(), 2 ) ), cereal::Exception );
+  BOOST_CHECK_THROW( ar( cereal::range( values.begin(), values.end(), 200 ) ), cereal::Exception );
+}
+
+BOOST_AUTO_TEST_CASE( range_into )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive ar( os );
+    ar( std::vector<int>( {1, 2, 3} ), std::string( "hello" ) );
+  }
+
+  std::array<int, 3> ints;
+  char chars[5];
+  {
+    std::istringstream is( os.str() );
+    cereal::BinaryInputArchive ar( is );
+    ar( cereal::into( ints ), cereal::into( chars, 5 ) );
+  }
+  BOOST_CHECK( ( ints == std::array<int, 3>( {{1, 2, 3}} ) ) );
+  BOOST_CHECK( std::string( chars, 5 ) == "hello" );
+
+  int small[2];
+  std::size_t count;
+  {
+    std::istringstream is( os.str() );
+    cereal::BinaryInputArchive ar( is );
+    BOOST_CHECK_THROW( ar( cereal::into( small, 2, count ) ), cereal::Exception );
+  }
+  {
+    std::istringstream is( os.str() );
+    cereal::BinaryInputArchive ar( is );
+    BOOST_CHECK_THROW( ar( cereal::into( small, 4 ) ), cereal::Exception );
+  }
+}
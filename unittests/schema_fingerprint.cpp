@@ -0,0 +1,169 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct FingerprintedA
+{
+  int x;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const version )
+  {
+    ar( CEREAL_NVP(x) );
+    BOOST_CHECK_EQUAL( version, 3u );
+  }
+};
+
+struct FingerprintedB
+{
+  FingerprintedA a;
+  std::vector<FingerprintedA> more;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const version )
+  {
+    ar( CEREAL_NVP(a), CEREAL_NVP(more) );
+    BOOST_CHECK_EQUAL( version, 5u );
+  }
+};
+
+CEREAL_CLASS_VERSION( FingerprintedA, 3 )
+CEREAL_CLASS_VERSION( FingerprintedB, 5 )
+
+static_assert( cereal::detail::schema_term( "FingerprintedA", 3 ) != cereal::detail::schema_term( "FingerprintedA", 4 ),
+               "the fingerprint covers the version" );
+
+static FingerprintedB makeFingerprinted()
+{
+  FingerprintedB b;
+  b.a.x = 1;
+  for( int i = 2; i < 5; ++i )
+    b.more.push_back( FingerprintedA{ i } );
+  return b;
+}
+
+static void checkFingerprinted( FingerprintedB const & b )
+{
+  BOOST_CHECK_EQUAL( b.a.x, 1 );
+  BOOST_REQUIRE_EQUAL( b.more.size(), 3u );
+  for( int i = 0; i < 3; ++i )
+    BOOST_CHECK_EQUAL( b.more[i].x, i + 2 );
+}
+
+template <class IArchive, class OArchive>
+void test_schema_fingerprint()
+{
+  std::ostringstream os;
+  {
+    OArchive oar( os );
+    oar.useSchemaFingerprint();
+    oar( makeFingerprinted(), makeFingerprinted() );
+  }
+
+  std::istringstream is( os.str() );
+  {
+    IArchive iar( is );
+    iar.useSchemaFingerprint();
+    FingerprintedB b1, b2;
+    iar( b1, b2 );
+    checkFingerprinted( b1 );
+    checkFingerprinted( b2 );
+  }
+
+  BOOST_CHECK_EQUAL( os.str().find( "cereal_class_version" ), std::string::npos );
+}
+
+BOOST_AUTO_TEST_CASE( binary_schema_fingerprint )
+{
+  test_schema_fingerprint<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_schema_fingerprint )
+{
+  test_schema_fingerprint<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_schema_fingerprint )
+{
+  test_schema_fingerprint<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_schema_fingerprint )
+{
+  test_schema_fingerprint<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_schema_fingerprint_size )
+{
+  std::ostringstream withVersions, withFingerprint;
+  {
+    cereal::BinaryOutputArchive oar( withVersions );
+    oar( makeFingerprinted() );
+  }
+  {
+    cereal::BinaryOutputArchive oar( withFingerprint );
+    oar.useSchemaFingerprint();
+    oar( makeFingerprinted() );
+  }
+
+  // two version words are replaced by one fingerprint
+  BOOST_CHECK_EQUAL( withFingerprint.str().size() + 2 * sizeof(std::uint32_t),
+                     withVersions.str().size() + sizeof(std::uint64_t) );
+}
+
+BOOST_AUTO_TEST_CASE( schema_fingerprint_mismatch )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    std::uint64_t const other = cereal::detail::schema_term( "FingerprintedA", 4 );
+    oar( other, makeFingerprinted() );
+  }
+
+  std::istringstream is( os.str() );
+  cereal::BinaryInputArchive iar( is );
+  BOOST_CHECK_THROW( iar.useSchemaFingerprint(), cereal::Exception );
+}
+
+BOOST_AUTO_TEST_CASE( schema_fingerprint_reset )
+{
+  std::ostringstream first, second;
+  cereal::BinaryOutputArchive oar( first );
+  oar.useSchemaFingerprint();
+  oar( makeFingerprinted() );
+
+  // a reset archive writes class versions again
+  oar.reset( second );
+  oar( makeFingerprinted() );
+
+  std::istringstream is( second.str() );
+  cereal::BinaryInputArchive iar( is );
+  FingerprintedB b;
+  iar( b );
+  checkFingerprinted( b );
+}
@@ -0,0 +1,153 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/segmented.hpp>
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/json.hpp>
+#include <boost/test/unit_test.hpp>
+#include <thread>
+
+namespace
+{
+  struct SegmentedShared
+  {
+    int x;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( x ); }
+  };
+}
+
+template <class OArchive, class IArchive> inline
+void test_segmented_threads()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  static const size_t segments = 8;
+  std::vector<std::vector<int>> values( segments );
+  for( auto & v : values )
+    for( size_t j = 0; j < 500; ++j )
+      v.push_back( random_value<int>( gen ) );
+
+  std::stringstream ss;
+  {
+    cereal::SegmentedArchiveWriter<OArchive> writer( ss );
+    std::vector<std::thread> threads;
+    for( size_t i = 0; i < segments; ++i )
+      threads.emplace_back( [&, i]()
+      {
+        auto shared = std::make_shared<SegmentedShared>();
+        shared->x = static_cast<int>( i );
+        writer.saveSegment( "segment" + std::to_string( i ), [&]( OArchive & ar )
+        {
+          // every segment has its own pointer table, so each starts with a fresh id
+          ar( cereal::make_nvp( "values", values[i] ), cereal::make_nvp( "a", shared ), cereal::make_nvp( "b", shared ) );
+        } );
+      } );
+    for( auto & t : threads )
+      t.join();
+  }
+
+  cereal::SegmentedArchiveReader<IArchive> reader( ss );
+  BOOST_CHECK_EQUAL( reader.segmentNames().size(), segments );
+  BOOST_CHECK( !reader.hasSegment( "missing" ) );
+  BOOST_CHECK_THROW( reader.loadSegment( "missing", []( IArchive & ) {} ), cereal::Exception );
+
+  std::vector<std::vector<int>> loaded( segments );
+  std::vector<std::shared_ptr<SegmentedShared>> a( segments ), b( segments );
+  std::vector<std::thread> threads;
+  // load in reverse order to check that segments are independent of each other
+  for( size_t i = segments; i-- > 0; )
+    threads.emplace_back( [&, i]()
+    {
+      reader.loadSegment( "segment" + std::to_string( i ), [&]( IArchive & ar )
+      {
+        ar( cereal::make_nvp( "values", loaded[i] ), cereal::make_nvp( "a", a[i] ), cereal::make_nvp( "b", b[i] ) );
+      } );
+    } );
+  for( auto & t : threads )
+    t.join();
+
+  for( size_t i = 0; i < segments; ++i )
+  {
+    BOOST_CHECK( reader.hasSegment( "segment" + std::to_string( i ) ) );
+    BOOST_CHECK_EQUAL_COLLECTIONS( loaded[i].begin(), loaded[i].end(), values[i].begin(), values[i].end() );
+    BOOST_REQUIRE( a[i] );
+    BOOST_CHECK_EQUAL( a[i], b[i] );
+    BOOST_CHECK_EQUAL( a[i]->x, static_cast<int>( i ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( segmented_binary_threads )
+{
+  test_segmented_threads<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( segmented_json_threads )
+{
+  test_segmented_threads<cereal::JSONOutputArchive, cereal::JSONInputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( segmented_errors )
+{
+  std::stringstream ss;
+  {
+    cereal::SegmentedArchiveWriter<cereal::BinaryOutputArchive> writer( ss );
+    writer.saveSegment( "first", []( cereal::BinaryOutputArchive & ar ) { ar( 1 ); } );
+    BOOST_CHECK_THROW( writer.saveSegment( "first", []( cereal::BinaryOutputArchive & ar ) { ar( 2 ); } ), cereal::Exception );
+
+    // a segment whose save throws leaves nothing behind
+    BOOST_CHECK_THROW( writer.saveSegment( "failed", []( cereal::BinaryOutputArchive & ) { throw std::runtime_error( "failed" ); } ),
+                       std::runtime_error );
+
+    writer.saveSegment( "second", []( cereal::BinaryOutputArchive & ar ) { ar( 2 ); } );
+    writer.finish();
+    BOOST_CHECK_THROW( writer.saveSegment( "third", []( cereal::BinaryOutputArchive & ar ) { ar( 3 ); } ), cereal::Exception );
+  }
+
+  cereal::SegmentedArchiveReader<cereal::BinaryInputArchive> reader( ss );
+  BOOST_REQUIRE_EQUAL( reader.segmentNames().size(), 2 );
+  BOOST_CHECK_EQUAL( reader.segmentNames()[0], "first" );
+  BOOST_CHECK_EQUAL( reader.segmentNames()[1], "second" );
+  BOOST_CHECK( !reader.hasSegment( "failed" ) );
+
+  int i = 0;
+  reader.loadSegment( "second", [&]( cereal::BinaryInputArchive & ar ) { ar( i ); } );
+  BOOST_CHECK_EQUAL( i, 2 );
+  reader.loadSegment( "first", [&]( cereal::BinaryInputArchive & ar ) { ar( i ); } );
+  BOOST_CHECK_EQUAL( i, 1 );
+
+  // reading past the end of a segment does not run into the next one
+  BOOST_CHECK_THROW( reader.loadSegment( "first", [&]( cereal::BinaryInputArchive & ar ) { ar( i, i ); } ), cereal::Exception );
+
+  std::string truncated = ss.str();
+  truncated.resize( truncated.size() - 1 );
+  std::istringstream bad( truncated );
+  BOOST_CHECK_THROW( cereal::SegmentedArchiveReader<cereal::BinaryInputArchive>{ bad }, cereal::Exception );
+}
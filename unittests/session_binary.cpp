@@ -0,0 +1,179 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/session_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct SessionBase
+{
+  virtual ~SessionBase() {}
+  virtual int value() const = 0;
+
+  template <class Archive>
+  void serialize( Archive & ) { }
+};
+
+struct SessionDerived : SessionBase
+{
+  SessionDerived() : x( 0 ) {}
+  SessionDerived( int xx ) : x( xx ) {}
+  int x;
+
+  int value() const { return x; }
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const version )
+  {
+    ar( cereal::base_class<SessionBase>( this ), x );
+    BOOST_CHECK_EQUAL( version, 3u );
+  }
+};
+
+CEREAL_REGISTER_TYPE(SessionDerived)
+CEREAL_CLASS_VERSION(SessionDerived, 3)
+
+struct SessionThrowing
+{
+  template <class Archive>
+  void save( Archive & ) const { throw cereal::Exception("failed"); }
+
+  template <class Archive>
+  void load( Archive & ) { }
+};
+
+BOOST_AUTO_TEST_CASE( session_binary_shared_types )
+{
+  std::ostringstream os;
+  {
+    cereal::SessionBinaryOutputArchive oar( os );
+    for( int i = 0; i < 10; ++i )
+      oar.writeRecord( 1, std::shared_ptr<SessionBase>( std::make_shared<SessionDerived>( i ) ) );
+  }
+
+  std::istringstream is( os.str() );
+  cereal::SessionBinaryInputArchive iar( is );
+
+  std::vector<std::uint64_t> sizes;
+  for( int i = 0; i < 10; ++i )
+  {
+    BOOST_REQUIRE( iar.nextRecord() );
+    BOOST_CHECK_EQUAL( iar.recordTag(), 1u );
+    BOOST_CHECK_EQUAL( iar.recordDefinesTypes(), i == 0 );
+    if( i == 0 )
+      BOOST_CHECK_THROW( iar.skipRecord(), cereal::Exception );
+    sizes.push_back( iar.recordSize() );
+
+    std::shared_ptr<SessionBase> ptr;
+    iar.readRecord( ptr );
+    BOOST_CHECK_EQUAL( ptr->value(), i );
+  }
+  BOOST_CHECK( !iar.nextRecord() );
+
+  // only the first record names the type and has its version
+  BOOST_CHECK_GT( sizes[0], sizes[1] + 4 + std::strlen( "SessionDerived" ) );
+  for( size_t i = 2; i < sizes.size(); ++i )
+    BOOST_CHECK_EQUAL( sizes[i], sizes[1] );
+}
+
+BOOST_AUTO_TEST_CASE( session_binary_dispatch )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::string> o_strings;
+  std::vector<double> o_doubles;
+  for( int i = 0; i < 50; ++i )
+  {
+    o_strings.push_back( random_basic_string<char>(gen) );
+    o_doubles.push_back( random_value<double>(gen) );
+  }
+
+  std::ostringstream os;
+  {
+    cereal::SessionBinaryOutputArchive oar( os );
+    for( size_t i = 0; i < o_strings.size(); ++i )
+    {
+      oar.writeRecord( 7, o_strings[i] );
+      oar.writeRecord( 8, o_doubles[i], o_strings[i] );
+    }
+  }
+
+  std::istringstream is( os.str() );
+  cereal::SessionBinaryInputArchive iar( is );
+
+  std::vector<double> i_doubles;
+  while( iar.nextRecord() )
+  {
+    if( iar.recordTag() == 8 )
+    {
+      // the string is left unread, and skipped with the rest of the record
+      double d;
+      iar.readRecord( d );
+      i_doubles.push_back( d );
+    }
+    else if( i_doubles.size() % 2 )
+      iar.skipRecord();
+  }
+
+  BOOST_CHECK_EQUAL_COLLECTIONS( o_doubles.begin(), o_doubles.end(), i_doubles.begin(), i_doubles.end() );
+}
+
+BOOST_AUTO_TEST_CASE( session_binary_errors )
+{
+  std::ostringstream os;
+  {
+    cereal::SessionBinaryOutputArchive oar( os );
+    oar.writeRecord( 0, std::shared_ptr<SessionBase>( std::make_shared<SessionDerived>( 1 ) ) );
+    BOOST_CHECK_THROW( oar.writeRecord( 0, std::shared_ptr<SessionBase>( std::make_shared<SessionDerived>( 2 ) ), SessionThrowing() ),
+                       cereal::Exception );
+    oar.writeRecord( 0, std::shared_ptr<SessionBase>( std::make_shared<SessionDerived>( 3 ) ) );
+    oar.writeRecord( 0, 5 );
+  }
+
+  std::istringstream is( os.str() );
+  cereal::SessionBinaryInputArchive iar( is );
+
+  std::shared_ptr<SessionBase> ptr;
+  BOOST_CHECK_THROW( iar.readRecord( ptr ), cereal::Exception );
+
+  BOOST_REQUIRE( iar.nextRecord() );
+  auto const firstSize = iar.recordSize();
+  iar.readRecord( ptr );
+  BOOST_CHECK_EQUAL( ptr->value(), 1 );
+
+  // the failed record is not written, and type information is sent again after it
+  BOOST_REQUIRE( iar.nextRecord() );
+  BOOST_CHECK( iar.recordDefinesTypes() );
+  BOOST_CHECK_EQUAL( iar.recordSize(), firstSize );
+  iar.readRecord( ptr );
+  BOOST_CHECK_EQUAL( ptr->value(), 3 );
+
+  BOOST_REQUIRE( iar.nextRecord() );
+  std::int64_t tooLarge;
+  BOOST_CHECK_THROW( iar.readRecord( tooLarge ), cereal::Exception );
+  BOOST_CHECK( !iar.nextRecord() );
+}
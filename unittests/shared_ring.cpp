@@ -0,0 +1,204 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/shared_ring.hpp>
+#include <boost/test/unit_test.hpp>
+#include <thread>
+
+namespace
+{
+  struct RingRecord
+  {
+    std::uint32_t id;
+    std::string text;
+    std::shared_ptr<int> shared;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    { ar( id, text, shared ); }
+  };
+
+  struct RingThrowing
+  {
+    template <class Archive>
+    void save( Archive & ) const
+    { throw cereal::Exception( "failed" ); }
+  };
+
+  //! Memory for a ring with a data area of capacity bytes, aligned as the ring needs
+  struct RingMemory
+  {
+    explicit RingMemory( std::size_t capacity ) :
+      storage( sizeof(cereal::shared_ring_detail::Control) + capacity + 64 ),
+      bytes( storage.data() + ( 64 - reinterpret_cast<std::uintptr_t>( storage.data() ) % 64 ) % 64 ),
+      size( sizeof(cereal::shared_ring_detail::Control) + capacity )
+    { }
+
+    std::vector<char> storage;
+    char * bytes;
+    std::size_t size;
+  };
+}
+
+BOOST_AUTO_TEST_CASE( shared_ring_wraps )
+{
+  RingMemory memory( 256 );
+
+  cereal::SharedRingWriter writer( memory.bytes, memory.size );
+  cereal::SharedRingReader reader( memory.bytes, memory.size );
+  BOOST_CHECK_EQUAL( writer.capacity(), 256 );
+  BOOST_CHECK_EQUAL( reader.capacity(), 256 );
+
+  RingRecord r;
+  BOOST_CHECK( !reader.tryRead( r ) );
+
+  // messages of many sizes go around the ring many times, each written until the ring is full
+  std::uint32_t written = 0, read = 0;
+  for( int round = 0; round < 200; ++round )
+  {
+    std::size_t batch = 0;
+    while( writer.tryWrite( RingRecord{ written, std::string( ( written * 7 ) % 60, 'a' + written % 26 ), std::make_shared<int>( static_cast<int>( written ) ) } ) )
+      ++written, ++batch;
+    BOOST_REQUIRE( batch > 0 );
+
+    while( reader.tryRead( r ) )
+    {
+      BOOST_REQUIRE_EQUAL( r.id, read );
+      BOOST_CHECK_EQUAL( r.text, std::string( ( read * 7 ) % 60, 'a' + read % 26 ) );
+      BOOST_REQUIRE( r.shared );
+      BOOST_CHECK_EQUAL( *r.shared, static_cast<int>( read ) );
+      ++read;
+    }
+    BOOST_REQUIRE_EQUAL( read, written );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( shared_ring_framing )
+{
+  RingMemory memory( 256 );
+  cereal::SharedRingWriter writer( memory.bytes, memory.size );
+  BOOST_REQUIRE( writer.tryWrite( std::string( "hello" ), std::uint16_t( 7 ) ) );
+
+  // a message in the ring can be read by BinaryMessageDecoder, despite its padded header
+  auto const data = memory.bytes + sizeof(cereal::shared_ring_detail::Control);
+  cereal::BinaryMessageDecoder decoder;
+  decoder.feed( data, cereal::shared_ring_detail::header_size + 8 + 5 + 2 );
+
+  std::string text;
+  std::uint16_t number = 0;
+  BOOST_REQUIRE( decoder.tryLoad( text, number ) );
+  BOOST_CHECK_EQUAL( text, "hello" );
+  BOOST_CHECK_EQUAL( number, 7 );
+  BOOST_CHECK_EQUAL( decoder.bytesBuffered(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( shared_ring_borrows )
+{
+  RingMemory memory( 1024 );
+  cereal::SharedRingWriter writer( memory.bytes, memory.size );
+  cereal::SharedRingReader reader( memory.bytes, memory.size );
+
+  std::vector<std::uint8_t> payload( 100 );
+  for( std::size_t i = 0; i < payload.size(); ++i )
+    payload[i] = static_cast<std::uint8_t>( i );
+  BOOST_REQUIRE( writer.tryWrite( cereal::ArrayView<std::uint8_t>( payload.data(), payload.size() ) ) );
+
+  cereal::ArrayView<std::uint8_t> view;
+  BOOST_REQUIRE( reader.tryRead( view ) );
+  BOOST_REQUIRE_EQUAL( view.size, payload.size() );
+  BOOST_CHECK( reinterpret_cast<char const *>( view.data ) > memory.bytes &&
+               reinterpret_cast<char const *>( view.data ) < memory.bytes + memory.size );
+  BOOST_CHECK( std::equal( view.begin(), view.end(), payload.begin() ) );
+
+  // the space is held until the message is released, so the ring can not take a second copy
+  while( writer.tryWrite( std::string( 100, 'x' ) ) ) {}
+  BOOST_CHECK( std::equal( view.begin(), view.end(), payload.begin() ) );
+  reader.release();
+  BOOST_CHECK( writer.tryWrite( std::string( 100, 'x' ) ) );
+}
+
+BOOST_AUTO_TEST_CASE( shared_ring_errors )
+{
+  RingMemory memory( 256 );
+
+  // the reader needs a ring set up by a writer
+  BOOST_CHECK_THROW( cereal::SharedRingReader( memory.bytes, memory.size ), cereal::Exception );
+  BOOST_CHECK_THROW( cereal::SharedRingWriter( memory.bytes + 8, memory.size - 8 ), cereal::Exception );
+  BOOST_CHECK_THROW( cereal::SharedRingWriter( memory.bytes, sizeof(cereal::shared_ring_detail::Control) ), cereal::Exception );
+
+  cereal::SharedRingWriter writer( memory.bytes, memory.size );
+  cereal::SharedRingReader reader( memory.bytes, memory.size );
+
+  // a message that could never fit, and a message that fails to save, leave nothing behind
+  BOOST_CHECK_THROW( writer.tryWrite( std::string( 300, 'a' ) ), cereal::Exception );
+  BOOST_CHECK_THROW( writer.tryWrite( RingThrowing() ), cereal::Exception );
+
+  std::string text;
+  BOOST_CHECK( !reader.tryRead( text ) );
+  BOOST_REQUIRE( writer.tryWrite( std::string( "after" ) ) );
+  BOOST_REQUIRE( reader.tryRead( text ) );
+  BOOST_CHECK_EQUAL( text, "after" );
+
+  // a message that fails to load is dropped
+  BOOST_REQUIRE( writer.tryWrite( std::uint8_t( 1 ) ) );
+  BOOST_REQUIRE( writer.tryWrite( std::string( "next" ) ) );
+  BOOST_CHECK_THROW( reader.tryRead( text ), cereal::Exception );
+  BOOST_REQUIRE( reader.tryRead( text ) );
+  BOOST_CHECK_EQUAL( text, "next" );
+}
+
+BOOST_AUTO_TEST_CASE( shared_ring_threads )
+{
+  RingMemory memory( 4096 );
+  cereal::SharedRingWriter writer( memory.bytes, memory.size );
+  cereal::SharedRingReader reader( memory.bytes, memory.size );
+
+  std::uint32_t const count = 20000;
+  std::thread producer( [&]()
+  {
+    for( std::uint32_t i = 0; i < count; ++i )
+    {
+      writer.write( RingRecord{ i, std::string( i % 200, 'r' ), std::make_shared<int>( static_cast<int>( i ) ) } );
+      // let the reader catch up and go to sleep now and then
+      if( i % 1000 == 0 )
+        std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+    }
+  } );
+
+  bool ordered = true;
+  for( std::uint32_t i = 0; i < count; ++i )
+  {
+    RingRecord r;
+    reader.read( r );
+    ordered = ordered && r.id == i && r.text.size() == i % 200 && r.shared && *r.shared == static_cast<int>( i );
+  }
+  producer.join();
+
+  BOOST_CHECK( ordered );
+  RingRecord r;
+  BOOST_CHECK( !reader.tryRead( r ) );
+}
@@ -0,0 +1,177 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/size_computing.hpp>
+#include <cereal/types/polymorphic.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct SizePolyBase
+{
+  virtual ~SizePolyBase() {}
+  virtual void foo() = 0;
+};
+
+struct SizePolyDerived : SizePolyBase
+{
+  SizePolyDerived() : x(0) {}
+  SizePolyDerived( int xx ) : x(xx) {}
+  int x;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+
+  void foo() {}
+};
+
+CEREAL_REGISTER_TYPE(SizePolyDerived)
+
+template <class Archive, class ... Types>
+std::size_t stream_size( Types && ... args )
+{
+  std::ostringstream os;
+  {
+    Archive ar( os );
+    ar( std::forward<Types>( args )... );
+  }
+  return os.str().size();
+}
+
+BOOST_AUTO_TEST_CASE( size_computing_archive )
+{
+  std::mt19937 gen(1234);
+
+  for(int ii=0; ii<10; ++ii)
+  {
+    std::vector<int> o_ints( gen() % 1000 );
+    for( auto & i : o_ints )
+      i = static_cast<int>( gen() );
+    std::map<std::string, double> o_map;
+    for( int j = 0; j < 20; ++j )
+      o_map.emplace( random_basic_string<char>(gen), static_cast<double>( j ) / 4.0 );
+    std::string o_string = random_basic_string<char>(gen);
+    StructInternalSerialize o_struct( static_cast<int>( gen() ), static_cast<int>( gen() ) );
+
+    BOOST_CHECK_EQUAL( cereal::serialized_size( o_ints, o_map, o_string, o_struct ),
+                       stream_size<cereal::BinaryOutputArchive>( o_ints, o_map, o_string, o_struct ) );
+
+    BOOST_CHECK_EQUAL( cereal::serialized_size<cereal::PortableBinaryOutputArchive>( o_ints, o_map ),
+                       stream_size<cereal::PortableBinaryOutputArchive>( o_ints, o_map ) );
+
+    BOOST_CHECK_EQUAL( cereal::serialized_size<cereal::JSONOutputArchive>( o_ints, o_map, o_struct ),
+                       stream_size<cereal::JSONOutputArchive>( o_ints, o_map, o_struct ) );
+
+    BOOST_CHECK_EQUAL( cereal::serialized_size<cereal::XMLOutputArchive>( o_ints, o_string ),
+                       stream_size<cereal::XMLOutputArchive>( o_ints, o_string ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( size_computing_archive_pointers )
+{
+  auto o_shared = std::make_shared<int>( 5 );
+  std::vector<std::shared_ptr<int>> o_shared_vec( 10, o_shared );
+
+  std::vector<std::shared_ptr<SizePolyBase>> o_poly;
+  for( int i = 0; i < 5; ++i )
+    o_poly.emplace_back( std::make_shared<SizePolyDerived>( i ) );
+  o_poly.push_back( o_poly.front() );
+
+  BOOST_CHECK_EQUAL( cereal::serialized_size( o_shared_vec, o_poly ),
+                     stream_size<cereal::BinaryOutputArchive>( o_shared_vec, o_poly ) );
+
+  // the archive keeps counting across calls
+  cereal::SizeComputingArchive ar;
+  ar( o_shared_vec );
+  auto const first = ar.size();
+  ar( o_shared_vec );
+  BOOST_CHECK_LT( ar.size() - first, first );
+  BOOST_CHECK_EQUAL( ar.size(), stream_size<cereal::BinaryOutputArchive>( o_shared_vec, o_shared_vec ) );
+}
+
+struct FixedSample
+{
+  std::uint32_t id;
+  float x, y;
+  std::array<short, 3> flags;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( id, x, y, flags ); }
+};
+
+CEREAL_FIXED_BINARY_SIZE( FixedSample, std::uint32_t, float, float, std::array<short, 3> )
+
+struct FixedPadded
+{
+  char c;
+  double d;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( c, d ); }
+};
+
+CEREAL_TRIVIALLY_SERIALIZABLE( FixedPadded )
+
+enum class FixedEnum : std::uint16_t { a, b };
+
+BOOST_AUTO_TEST_CASE( size_computing_fixed_binary_size )
+{
+  using cereal::traits::fixed_binary_size;
+  using cereal::traits::has_fixed_binary_size;
+
+  static_assert( fixed_binary_size<double>::value == sizeof(double), "" );
+  static_assert( fixed_binary_size<FixedEnum>::value == 2, "" );
+  static_assert( fixed_binary_size<FixedSample>::value == 18, "" );
+  static_assert( fixed_binary_size<std::array<FixedSample, 2>[3]>::value == 6 * 18, "" );
+
+  static_assert( !has_fixed_binary_size<std::string>::value, "" );
+  static_assert( !has_fixed_binary_size<std::vector<int>>::value, "" );
+  static_assert( !has_fixed_binary_size<std::pair<int, std::string>>::value, "" );
+  static_assert( !has_fixed_binary_size<std::tuple<int, std::shared_ptr<int>>>::value, "" );
+  static_assert( !has_fixed_binary_size<StructInternalSerialize>::value, "" );
+
+  std::mt19937 gen(1234);
+
+  FixedSample sample;
+  sample.id = random_value<std::uint32_t>(gen);
+  sample.x = random_value<float>(gen);
+  sample.y = random_value<float>(gen);
+  sample.flags = {{ 1, 2, 3 }};
+  BOOST_CHECK_EQUAL( fixed_binary_size<FixedSample>::value, cereal::serialized_size( sample ) );
+
+  std::array<FixedSample, 2> samples[3];
+  BOOST_CHECK_EQUAL( fixed_binary_size<decltype(samples)>::value, cereal::serialized_size( samples ) );
+
+  std::tuple<std::pair<char, long double>, std::complex<float>, FixedEnum, bool> mixed;
+  BOOST_CHECK_EQUAL( fixed_binary_size<decltype(mixed)>::value, cereal::serialized_size( mixed ) );
+
+  // trivially serializable elements are saved as a block, padding included
+  std::array<FixedPadded, 4> padded;
+  BOOST_CHECK_EQUAL( fixed_binary_size<decltype(padded)>::value, sizeof(padded) );
+  BOOST_CHECK_EQUAL( fixed_binary_size<decltype(padded)>::value, cereal::serialized_size( padded ) );
+}
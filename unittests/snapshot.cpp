@@ -0,0 +1,230 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  struct SnapshotNode : cereal::SnapshotTracked
+  {
+    std::string label;
+    std::vector<int> values;
+    std::vector<std::shared_ptr<SnapshotNode>> children;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    {
+      ar( label, values, children );
+    }
+  };
+
+  struct SnapshotGraph
+  {
+    std::uint32_t generation;
+    std::vector<std::shared_ptr<SnapshotNode>> roots;
+
+    template <class Archive>
+    void serialize( Archive & ar )
+    {
+      ar( generation, roots );
+    }
+  };
+
+  std::shared_ptr<SnapshotNode> make_snapshot_node( std::mt19937 & gen, std::size_t children )
+  {
+    auto node = std::make_shared<SnapshotNode>();
+    node->label = random_basic_string<char>( gen );
+    for( std::size_t i = 0; i < 64; ++i )
+      node->values.push_back( random_value<int>( gen ) );
+    for( std::size_t i = 0; i < children; ++i )
+      node->children.push_back( make_snapshot_node( gen, 0 ) );
+    return node;
+  }
+
+  void check_snapshot_node( SnapshotNode const & expected, SnapshotNode const & actual )
+  {
+    BOOST_CHECK_EQUAL( expected.label, actual.label );
+    BOOST_CHECK_EQUAL_COLLECTIONS( expected.values.begin(), expected.values.end(), actual.values.begin(), actual.values.end() );
+    BOOST_REQUIRE_EQUAL( expected.children.size(), actual.children.size() );
+    for( std::size_t i = 0; i < expected.children.size(); ++i )
+      check_snapshot_node( *expected.children[i], *actual.children[i] );
+  }
+
+  void check_snapshot_graph( SnapshotGraph const & expected, SnapshotGraph const & actual )
+  {
+    BOOST_CHECK_EQUAL( expected.generation, actual.generation );
+    BOOST_REQUIRE_EQUAL( expected.roots.size(), actual.roots.size() );
+    for( std::size_t i = 0; i < expected.roots.size(); ++i )
+      check_snapshot_node( *expected.roots[i], *actual.roots[i] );
+  }
+
+  template <class OArchive>
+  std::string save_snapshot( cereal::SnapshotWriter<OArchive> & writer, SnapshotGraph const & graph )
+  {
+    std::ostringstream os;
+    {
+      OArchive oar( os );
+      writer.save( oar, graph );
+    }
+    return os.str();
+  }
+
+  template <class IArchive>
+  void load_snapshot( cereal::SnapshotReader<IArchive> & reader, std::string const & data, SnapshotGraph & graph )
+  {
+    std::istringstream is( data );
+    IArchive iar( is );
+    reader.load( iar, graph );
+  }
+
+  template <class IArchive, class OArchive>
+  void test_snapshot_chain()
+  {
+    std::mt19937 gen(std::random_device{}());
+
+    SnapshotGraph graph;
+    graph.generation = 0;
+    for( std::size_t i = 0; i < 50; ++i )
+      graph.roots.push_back( make_snapshot_node( gen, 2 ) );
+    // An object reached through two paths
+    graph.roots[1]->children.push_back( graph.roots[0] );
+
+    cereal::SnapshotWriter<OArchive> writer;
+    cereal::SnapshotReader<IArchive> reader;
+    std::vector<std::string> chain;
+
+    chain.push_back( save_snapshot( writer, graph ) );
+
+    // Change a root, and a child reached only through an unchanged root
+    graph.generation = 1;
+    graph.roots[3]->label = "changed";
+    graph.roots[3]->markChanged();
+    graph.roots[7]->children[1]->values.push_back( 42 );
+    graph.roots[7]->children[1]->markChanged();
+    chain.push_back( save_snapshot( writer, graph ) );
+
+    // Add and remove objects
+    graph.generation = 2;
+    graph.roots.erase( graph.roots.begin() + 10 );
+    graph.roots[5]->children.clear();
+    graph.roots[5]->markChanged();
+    graph.roots.push_back( make_snapshot_node( gen, 3 ) );
+    chain.push_back( save_snapshot( writer, graph ) );
+
+    // Nothing changes
+    chain.push_back( save_snapshot( writer, graph ) );
+
+    BOOST_CHECK_EQUAL( writer.sequence(), 4u );
+    for( std::size_t i = 1; i < chain.size(); ++i )
+      BOOST_CHECK_LT( chain[i].size() * 4, chain[0].size() );
+
+    SnapshotGraph loaded;
+    load_snapshot( reader, chain[0], loaded );
+    auto const unchanged = loaded.roots[2];
+    auto const changed = loaded.roots[3];
+    BOOST_CHECK_EQUAL( reader.size(), 150u );
+
+    for( std::size_t i = 1; i < chain.size(); ++i )
+      load_snapshot( reader, chain[i], loaded );
+
+    check_snapshot_graph( graph, loaded );
+    BOOST_CHECK_EQUAL( loaded.roots[1]->children.back(), loaded.roots[0] );
+
+    // Existing objects are kept and loaded in place
+    BOOST_CHECK_EQUAL( loaded.roots[2], unchanged );
+    BOOST_CHECK_EQUAL( loaded.roots[3], changed );
+    BOOST_CHECK_EQUAL( changed->label, "changed" );
+
+    // The removed root and its children, and the children of roots[5], are gone
+    BOOST_CHECK_EQUAL( reader.size(), 150u - 3 - 2 + 4 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_snapshot_chain )
+{
+  test_snapshot_chain<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_snapshot_chain )
+{
+  test_snapshot_chain<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( snapshot_order )
+{
+  std::mt19937 gen(std::random_device{}());
+
+  SnapshotGraph graph;
+  graph.generation = 0;
+  graph.roots.push_back( make_snapshot_node( gen, 1 ) );
+
+  cereal::SnapshotWriter<cereal::BinaryOutputArchive> writer;
+  auto const full = save_snapshot( writer, graph );
+  graph.roots[0]->markChanged();
+  auto const first = save_snapshot( writer, graph );
+  auto const second = save_snapshot( writer, graph );
+
+  SnapshotGraph loaded;
+
+  // A delta cannot be loaded without the snapshots before it
+  {
+    cereal::SnapshotReader<cereal::BinaryInputArchive> reader;
+    BOOST_CHECK_THROW( load_snapshot( reader, first, loaded ), cereal::Exception );
+
+    load_snapshot( reader, full, loaded );
+    BOOST_CHECK_THROW( load_snapshot( reader, second, loaded ), cereal::Exception );
+    load_snapshot( reader, first, loaded );
+    load_snapshot( reader, second, loaded );
+    check_snapshot_graph( graph, loaded );
+  }
+
+  // After rebase the next snapshot is complete on its own
+  writer.rebase();
+  graph.roots.push_back( make_snapshot_node( gen, 0 ) );
+  auto const rebased = save_snapshot( writer, graph );
+  {
+    cereal::SnapshotReader<cereal::BinaryInputArchive> reader;
+    SnapshotGraph fresh;
+    load_snapshot( reader, rebased, fresh );
+    check_snapshot_graph( graph, fresh );
+  }
+
+  // Outside of a snapshot tracked objects are serialized as usual
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar( graph );
+  }
+  SnapshotGraph plain;
+  {
+    std::istringstream is( os.str() );
+    cereal::BinaryInputArchive iar( is );
+    iar( plain );
+  }
+  check_snapshot_graph( graph, plain );
+  BOOST_CHECK_LT( os.str().size(), rebased.size() );
+}
@@ -0,0 +1,175 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/types/sparse.hpp>
+#include <cereal/archives/compact_binary.hpp>
+#include <boost/test/unit_test.hpp>
+
+template <class IArchive, class OArchive, class T>
+void test_sparse_vector( std::vector<T> const & o_vector )
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::sparse( o_vector ) );
+    oar( cereal::rle( o_vector ) );
+  }
+
+  std::vector<T> i_sparse( 3, T( 1 ) );
+  std::vector<T> i_rle;
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::sparse( i_sparse ) );
+    iar( cereal::rle( i_rle ) );
+  }
+
+  BOOST_CHECK_EQUAL_COLLECTIONS( i_sparse.begin(), i_sparse.end(), o_vector.begin(), o_vector.end() );
+  BOOST_CHECK_EQUAL_COLLECTIONS( i_rle.begin(), i_rle.end(), o_vector.begin(), o_vector.end() );
+}
+
+template <class IArchive, class OArchive>
+void test_sparse()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<10; ++ii)
+  {
+    // scattered non zero values, at a range of densities
+    for( unsigned int density : { 0u, 1u, 5u, 30u, 80u, 100u } )
+    {
+      std::vector<float> features( 1000 );
+      for( auto & f : features )
+        if( gen() % 100 < density )
+          f = random_value<float>(gen) + 1.0f;
+      test_sparse_vector<IArchive, OArchive>( features );
+    }
+
+    // long runs of zeros and of values
+    std::vector<std::uint8_t> occupancy( 2000 );
+    for( std::size_t begin = gen() % 100; begin < occupancy.size(); begin += 200 + gen() % 100 )
+      std::fill( occupancy.begin() + begin, occupancy.begin() + std::min<std::size_t>( begin + gen() % 50, occupancy.size() ), static_cast<std::uint8_t>( 1 + gen() % 255 ) );
+    test_sparse_vector<IArchive, OArchive>( occupancy );
+
+    std::vector<std::int64_t> ends = { 5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -7 };
+    test_sparse_vector<IArchive, OArchive>( ends );
+
+    test_sparse_vector<IArchive, OArchive>( std::vector<double>() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_sparse )
+{
+  test_sparse<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_sparse )
+{
+  test_sparse<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( compact_binary_sparse )
+{
+  test_sparse<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_sparse )
+{
+  test_sparse<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_sparse )
+{
+  test_sparse<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( binary_sparse_size )
+{
+  std::vector<float> features( 1000 );
+  features[10] = 1.0f;
+  features[500] = -0.0f;
+  features[999] = 2.0f;
+
+  std::ostringstream plain, sparse, rle;
+  {
+    cereal::BinaryOutputArchive oar( plain );
+    oar( features );
+  }
+  {
+    cereal::BinaryOutputArchive oar( sparse );
+    oar( cereal::sparse( features ) );
+  }
+  {
+    cereal::BinaryOutputArchive oar( rle );
+    oar( cereal::rle( features ) );
+  }
+
+  // negative zero is kept, and the gaps and runs of zeros of 10, 489 and 498 are varints
+  BOOST_CHECK_EQUAL( plain.str().size(), sizeof(cereal::size_type) + 1000 * sizeof(float) );
+  BOOST_CHECK_EQUAL( sparse.str().size(), 3 * sizeof(cereal::size_type) + 1 + 5 + 3 * sizeof(float) );
+  BOOST_CHECK_EQUAL( rle.str().size(), 3 * sizeof(cereal::size_type) + 1 + 8 + 3 * sizeof(float) );
+
+  // a dense vector is saved as is
+  std::vector<float> dense( 100, 1.0f );
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar( cereal::sparse( dense ) );
+  }
+  BOOST_CHECK_EQUAL( os.str().size(), sizeof(cereal::size_type) + 1 + 100 * sizeof(float) );
+
+  std::vector<float> loaded;
+  {
+    std::istringstream is( sparse.str() );
+    cereal::BinaryInputArchive iar( is );
+    iar( cereal::sparse( loaded ) );
+  }
+  BOOST_REQUIRE_EQUAL( loaded.size(), features.size() );
+  BOOST_CHECK( std::signbit( loaded[500] ) );
+}
+
+BOOST_AUTO_TEST_CASE( binary_sparse_malformed )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+
+    // one value at an index past the size
+    std::uint8_t const gap = 4;
+    float const value = 1.0f;
+    oar( cereal::make_size_tag( static_cast<cereal::size_type>( 4 ) ), std::uint8_t( 1 ),
+         cereal::make_size_tag( static_cast<cereal::size_type>( 1 ) ),
+         cereal::make_size_tag( static_cast<cereal::size_type>( 1 ) ),
+         cereal::binary_data( &gap, 1 ), cereal::binary_data( &value, sizeof(value) ) );
+  }
+
+  std::vector<float> features;
+  std::istringstream is( os.str() );
+  cereal::BinaryInputArchive iar( is );
+  BOOST_CHECK_THROW( iar( cereal::sparse( features ) ), cereal::Exception );
+}
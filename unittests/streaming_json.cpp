@@ -0,0 +1,179 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/streaming_json.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct StreamingRecord
+{
+  int id;
+  std::string name;
+  std::vector<double> values;
+  std::map<std::string, int> tags;
+  StructInternalSerialize nested;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    ar( CEREAL_NVP(id), CEREAL_NVP(name), CEREAL_NVP(values), CEREAL_NVP(tags), CEREAL_NVP(nested) );
+  }
+
+  // loads out of the order saved
+  template <class Archive>
+  void load( Archive & ar )
+  {
+    ar( CEREAL_NVP(nested), CEREAL_NVP(name), CEREAL_NVP(id), values, CEREAL_NVP(tags) );
+  }
+
+  bool operator==( StreamingRecord const & other ) const
+  {
+    return id == other.id && name == other.name && values == other.values &&
+           tags == other.tags && nested == other.nested;
+  }
+};
+
+std::ostream& operator<<(std::ostream& os, StreamingRecord const & r)
+{
+  os << "[id: " << r.id << " name: " << r.name << "]";
+  return os;
+}
+
+BOOST_AUTO_TEST_CASE( streaming_json_records )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<StreamingRecord> o_records(100);
+  for( auto & r : o_records )
+  {
+    r.id = random_value<int>(gen);
+    r.name = random_basic_string<char>(gen) + "\"\\\n\t\xc3\xa9";
+    for( int j = 0; j < 10; ++j )
+    {
+      r.values.push_back( random_value<double>(gen) );
+      r.tags[random_basic_string<char>(gen)] = random_value<int>(gen);
+    }
+    r.nested = StructInternalSerialize( random_value<int>(gen), random_value<int>(gen) );
+  }
+
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar(os);
+    for( auto const & r : o_records )
+      oar( r );
+    oar( cereal::make_nvp( "count", o_records.size() ) );
+  }
+
+  std::istringstream is(os.str());
+  {
+    cereal::StreamingJSONInputArchive iar(is);
+    for( auto const & o_r : o_records )
+    {
+      StreamingRecord i_r;
+      iar( i_r );
+      BOOST_CHECK_EQUAL( o_r, i_r );
+    }
+
+    std::size_t i_count;
+    iar( cereal::make_nvp( "count", i_count ) );
+    BOOST_CHECK_EQUAL( o_records.size(), i_count );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( streaming_json_unordered_loads )
+{
+  int const o_a = 1;
+  std::vector<bool> const o_b = { true, false, true };
+  std::pair<float, std::string> const o_c = { 2.5f, "c" };
+  int const o_d = 4;
+  uint64_t const o_e = std::numeric_limits<uint64_t>::max();
+  long double const o_f = 0.5L;
+
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar(os);
+    oar( cereal::make_nvp( "a", o_a ), cereal::make_nvp( "b", o_b ), cereal::make_nvp( "c", o_c ),
+         cereal::make_nvp( "d", o_d ), cereal::make_nvp( "e", o_e ), cereal::make_nvp( "f", o_f ) );
+  }
+
+  int i_a;
+  std::vector<bool> i_b;
+  std::pair<float, std::string> i_c;
+  int i_d;
+  uint64_t i_e;
+  long double i_f;
+
+  std::istringstream is(os.str());
+  {
+    cereal::StreamingJSONInputArchive iar(is);
+    iar( cereal::make_nvp( "d", i_d ), cereal::make_nvp( "b", i_b ), i_c, cereal::make_nvp( "a", i_a ),
+         cereal::make_nvp( "f", i_f ), cereal::make_nvp( "e", i_e ) );
+
+    int missing;
+    BOOST_CHECK_THROW( iar( cereal::make_nvp( "missing", missing ) ), cereal::Exception );
+  }
+
+  BOOST_CHECK_EQUAL( o_a, i_a );
+  BOOST_CHECK_EQUAL_COLLECTIONS( o_b.begin(), o_b.end(), i_b.begin(), i_b.end() );
+  BOOST_CHECK_EQUAL( o_c.first, i_c.first );
+  BOOST_CHECK_EQUAL( o_c.second, i_c.second );
+  BOOST_CHECK_EQUAL( o_d, i_d );
+  BOOST_CHECK_EQUAL( o_e, i_e );
+  BOOST_CHECK( o_f == i_f );
+}
+
+BOOST_AUTO_TEST_CASE( streaming_json_stream_position )
+{
+  std::stringstream ss;
+  {
+    cereal::JSONOutputArchive oar(ss);
+    oar( cereal::make_nvp( "first", 1 ) );
+  }
+  ss << "trailing";
+
+  {
+    cereal::StreamingJSONInputArchive iar(ss);
+    int first;
+    iar( first );
+    BOOST_CHECK_EQUAL( first, 1 );
+
+    int extra;
+    BOOST_CHECK_THROW( iar( extra ), cereal::Exception );
+  }
+
+  std::string rest;
+  ss >> rest;
+  BOOST_CHECK_EQUAL( rest, "trailing" );
+}
+
+BOOST_AUTO_TEST_CASE( streaming_json_invalid )
+{
+  std::istringstream is( "{\"value0\": [1, 2}" );
+  cereal::StreamingJSONInputArchive iar(is);
+  std::vector<int> v;
+  BOOST_CHECK_THROW( iar( v ), cereal::Exception );
+}
@@ -0,0 +1,165 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+struct TraceEvent
+{
+  bool begin;
+  std::string type;
+  std::uint64_t position;
+};
+
+static std::vector<TraceEvent> traceEvents;
+
+struct RecordingTracer
+{
+  static void begin( std::type_info const & type, std::uint64_t position )
+  { traceEvents.push_back( { true, type.name(), position } ); }
+
+  static void end( std::type_info const & type, std::uint64_t position )
+  { traceEvents.push_back( { false, type.name(), position } ); }
+};
+
+#define CEREAL_TRACE_POLICY ::RecordingTracer
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct TracedPoint
+{
+  float x = 1, y = 2;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(x), CEREAL_NVP(y) ); }
+};
+
+CEREAL_NOT_TRACED( TracedPoint )
+
+struct TracedPath
+{
+  std::vector<TracedPoint> points = std::vector<TracedPoint>( 3 );
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(points) ); }
+};
+
+struct TracedFailure
+{
+  template <class Archive>
+  void serialize( Archive & )
+  { throw std::runtime_error( "failure" ); }
+};
+
+static std::size_t countTraced( std::string const & type )
+{
+  std::size_t count = 0;
+  for( auto const & e : traceEvents )
+    if( e.begin && e.type == type )
+      ++count;
+  return count;
+}
+
+static void checkBalanced()
+{
+  std::vector<std::string> open;
+  for( auto const & e : traceEvents )
+    if( e.begin )
+      open.push_back( e.type );
+    else
+    {
+      BOOST_REQUIRE( !open.empty() );
+      BOOST_CHECK_EQUAL( open.back(), e.type );
+      open.pop_back();
+    }
+  BOOST_CHECK( open.empty() );
+}
+
+template <class IArchive, class OArchive>
+void test_trace_hooks( bool binary )
+{
+  traceEvents.clear();
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::make_nvp( "path", TracedPath() ), std::string( "label" ) );
+  }
+
+  checkBalanced();
+  BOOST_CHECK_EQUAL( countTraced( typeid(TracedPath).name() ), 1 );
+  BOOST_CHECK_EQUAL( countTraced( typeid(std::vector<TracedPoint>).name() ), 1 );
+  BOOST_CHECK_EQUAL( countTraced( typeid(std::string).name() ), 1 );
+  BOOST_CHECK_EQUAL( countTraced( typeid(TracedPoint).name() ), 0 );
+  BOOST_CHECK_EQUAL( countTraced( typeid(float).name() ), 0 );
+
+  // the path ends where the label begins
+  BOOST_REQUIRE( !traceEvents.empty() );
+  BOOST_CHECK_EQUAL( traceEvents.front().position, 0 );
+  if( binary )
+    BOOST_CHECK_GT( traceEvents.back().position, traceEvents.front().position );
+  else
+    BOOST_CHECK_EQUAL( traceEvents.back().position, 0 );
+
+  traceEvents.clear();
+  TracedPath path;
+  std::string label;
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( cereal::make_nvp( "path", path ), label );
+  }
+
+  checkBalanced();
+  BOOST_CHECK_EQUAL( countTraced( typeid(TracedPath).name() ), 1 );
+  BOOST_CHECK_EQUAL( countTraced( typeid(TracedPoint).name() ), 0 );
+  BOOST_CHECK_EQUAL( label, "label" );
+}
+
+BOOST_AUTO_TEST_CASE( binary_trace_hooks )
+{
+  test_trace_hooks<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>( true );
+}
+
+BOOST_AUTO_TEST_CASE( json_trace_hooks )
+{
+  test_trace_hooks<cereal::JSONInputArchive, cereal::JSONOutputArchive>( false );
+}
+
+BOOST_AUTO_TEST_CASE( trace_hooks_balanced_on_exception )
+{
+  traceEvents.clear();
+  std::ostringstream os;
+  cereal::BinaryOutputArchive oar(os);
+  std::vector<TracedFailure> failures( 1 );
+  BOOST_CHECK_THROW( oar( failures ), std::runtime_error );
+
+  checkBalanced();
+  BOOST_CHECK_EQUAL( countTraced( typeid(TracedFailure).name() ), 1 );
+}
@@ -0,0 +1,221 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct ScopedRecord
+{
+  std::shared_ptr<int> a, b, outer;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(a), CEREAL_NVP(b), CEREAL_NVP(outer) ); }
+};
+
+template <class IArchive, class OArchive>
+void test_tracking_scope()
+{
+  auto const outer = std::make_shared<int>( -1 );
+  std::size_t const records = 50;
+
+  std::ostringstream os;
+  {
+    OArchive oar( os );
+    oar( outer );
+    for( std::size_t i = 0; i < records; ++i )
+    {
+      ScopedRecord r;
+      r.a = std::make_shared<int>( static_cast<int>( i ) );
+      r.b = r.a;
+      r.outer = outer;
+
+      oar.beginTrackingScope();
+      oar( r );
+      oar.endTrackingScope();
+    }
+
+    // a pointer first saved in an ended scope is written again in full
+    auto const again = std::make_shared<int>( 7 );
+    oar.beginTrackingScope();
+    oar( again );
+    oar.endTrackingScope();
+    oar( again, again );
+
+    BOOST_CHECK_THROW( oar.endTrackingScope(), cereal::Exception );
+  }
+
+  std::istringstream is( os.str() );
+  {
+    IArchive iar( is );
+    std::shared_ptr<int> loadedOuter;
+    iar( loadedOuter );
+    BOOST_REQUIRE( loadedOuter );
+    BOOST_CHECK_EQUAL( *loadedOuter, -1 );
+
+    std::weak_ptr<int> previous;
+    for( std::size_t i = 0; i < records; ++i )
+    {
+      ScopedRecord r;
+      iar.beginTrackingScope();
+      iar( r );
+      iar.endTrackingScope();
+
+      BOOST_REQUIRE( r.a );
+      BOOST_CHECK_EQUAL( *r.a, static_cast<int>( i ) );
+      BOOST_CHECK( r.a == r.b );
+      BOOST_CHECK( r.outer == loadedOuter );
+
+      // the archive no longer holds the objects of the record
+      BOOST_CHECK_EQUAL( r.a.use_count(), 2 );
+      BOOST_CHECK( previous.expired() );
+      previous = r.a;
+    }
+
+    std::shared_ptr<int> again, first, second;
+    iar.beginTrackingScope();
+    iar( again );
+    iar.endTrackingScope();
+    iar( first, second );
+    BOOST_CHECK_EQUAL( *again, 7 );
+    BOOST_CHECK_EQUAL( *first, 7 );
+    BOOST_CHECK( first == second );
+    BOOST_CHECK( first != again );
+
+    BOOST_CHECK_THROW( iar.endTrackingScope(), cereal::Exception );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_tracking_scope )
+{
+  test_tracking_scope<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_tracking_scope )
+{
+  test_tracking_scope<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_tracking_scope )
+{
+  test_tracking_scope<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_tracking_scope )
+{
+  test_tracking_scope<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( nested_tracking_scopes )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    auto const shared = std::make_shared<int>( 1 );
+    oar.beginTrackingScope();
+    oar( shared );
+    oar.beginTrackingScope();
+    oar( shared, std::make_shared<int>( 2 ) );
+    oar.endTrackingScope();
+    oar( shared );
+    oar.endTrackingScope();
+  }
+
+  std::istringstream is( os.str() );
+  cereal::BinaryInputArchive iar( is );
+  std::shared_ptr<int> a, b, c, d;
+  iar.beginTrackingScope();
+  iar( a );
+  iar.beginTrackingScope();
+  iar( b, c );
+  iar.endTrackingScope();
+  iar( d );
+  iar.endTrackingScope();
+
+  BOOST_CHECK_EQUAL( *a, 1 );
+  BOOST_CHECK_EQUAL( *c, 2 );
+  BOOST_CHECK( a == b );
+  BOOST_CHECK( a == d );
+  BOOST_CHECK_EQUAL( c.use_count(), 1 );
+}
+
+BOOST_AUTO_TEST_CASE( flat_pointer_map_rollback )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // keys closely packed and a small table, so probe sequences overlap and wrap around
+  std::vector<int> storage( 4096 );
+  cereal::detail::FlatPointerMap map;
+  std::map<void const *, std::uint64_t> expected;
+  std::vector<std::vector<void const *>> scopes;
+
+  for( int step = 0; step < 20000; ++step )
+  {
+    auto const action = std::uniform_int_distribution<int>( 0, 9 )( gen );
+    if( action == 0 && scopes.size() < 8 )
+    {
+      map.checkpoint();
+      scopes.emplace_back();
+    }
+    else if( action == 1 && !scopes.empty() )
+    {
+      map.rollback();
+      for( auto key : scopes.back() )
+        expected.erase( key );
+      scopes.pop_back();
+    }
+    else
+    {
+      void const * key = &storage[std::uniform_int_distribution<std::size_t>( 0, storage.size() - 1 )( gen )];
+      auto const value = static_cast<std::uint64_t>( step );
+      auto const result = map.insert( key, value );
+      auto const found = expected.find( key );
+      if( found == expected.end() )
+      {
+        BOOST_REQUIRE( result.second );
+        expected[key] = value;
+        if( !scopes.empty() )
+          scopes.back().push_back( key );
+      }
+      else
+      {
+        BOOST_REQUIRE( !result.second );
+        BOOST_REQUIRE_EQUAL( result.first, found->second );
+      }
+    }
+
+    BOOST_REQUIRE_EQUAL( map.size(), expected.size() );
+  }
+
+  // everything left is still found after all the removals
+  for( auto const & e : expected )
+  {
+    auto const result = map.insert( e.first, 0 );
+    BOOST_REQUIRE( !result.second );
+    BOOST_CHECK_EQUAL( result.first, e.second );
+  }
+}
@@ -0,0 +1,236 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct TrivialTick
+{
+  std::int64_t time;
+  double price;
+  std::int32_t volume;
+  std::int32_t flags;
+
+  static int serializeCount;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ++serializeCount;
+    ar( time, price, volume, flags );
+  }
+
+  bool operator==( TrivialTick const & other ) const
+  { return time == other.time && price == other.price && volume == other.volume && flags == other.flags; }
+
+  bool operator!=( TrivialTick const & other ) const
+  { return !(*this == other); }
+};
+
+int TrivialTick::serializeCount = 0;
+
+inline std::ostream& operator<<(std::ostream& os, TrivialTick const & t)
+{
+  os << "[time: " << t.time << " price: " << t.price << " volume: " << t.volume << " flags: " << t.flags << "]";
+  return os;
+}
+
+CEREAL_TRIVIALLY_SERIALIZABLE( TrivialTick )
+
+static_assert( cereal::traits::is_trivially_serializable<TrivialTick>::value, "TrivialTick should be trivially serializable" );
+static_assert( cereal::traits::is_trivially_serializable<double>::value, "arithmetic types are trivially serializable" );
+static_assert( !cereal::traits::is_trivially_serializable<StructInternalSerialize>::value, "types must opt in" );
+
+inline TrivialTick random_tick( std::mt19937 & gen )
+{
+  TrivialTick t;
+  std::memset( &t, 0, sizeof(t) ); // clear any padding
+  t.time = random_value<std::int64_t>(gen);
+  t.price = random_value<std::int16_t>(gen) / 4.0; // exactly representable in text archives
+  t.volume = random_value<std::int32_t>(gen);
+  t.flags = random_value<std::int32_t>(gen);
+  return t;
+}
+
+template <class IArchive, class OArchive>
+void test_trivially_serializable( bool expectBulk )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    std::vector<TrivialTick> o_vector( 100 );
+    for( auto & t : o_vector )
+      t = random_tick( gen );
+
+    std::array<TrivialTick, 10> o_array;
+    for( auto & t : o_array )
+      t = random_tick( gen );
+
+    TrivialTick o_carray[5];
+    for( auto & t : o_carray )
+      t = random_tick( gen );
+
+    std::valarray<TrivialTick> o_valarray( 20 );
+    for( auto & t : o_valarray )
+      t = random_tick( gen );
+
+    TrivialTick const o_single = random_tick( gen );
+
+    TrivialTick::serializeCount = 0;
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+      oar( o_vector, o_array, o_carray, o_valarray, o_single );
+    }
+
+    if( expectBulk )
+      BOOST_CHECK_EQUAL( TrivialTick::serializeCount, 1 ); // only the single tick
+    else
+      BOOST_CHECK_EQUAL( TrivialTick::serializeCount, 100 + 10 + 5 + 20 + 1 );
+
+    std::vector<TrivialTick> i_vector;
+    std::array<TrivialTick, 10> i_array;
+    TrivialTick i_carray[5];
+    std::valarray<TrivialTick> i_valarray;
+    TrivialTick i_single;
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      iar( i_vector, i_array, i_carray, i_valarray, i_single );
+    }
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( i_vector.begin(), i_vector.end(), o_vector.begin(), o_vector.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( i_array.begin(), i_array.end(), o_array.begin(), o_array.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( std::begin(i_carray), std::end(i_carray), std::begin(o_carray), std::end(o_carray) );
+    BOOST_CHECK_EQUAL_COLLECTIONS( std::begin(i_valarray), std::end(i_valarray), std::begin(o_valarray), std::end(o_valarray) );
+    BOOST_CHECK_EQUAL( i_single, o_single );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_trivially_serializable )
+{
+  test_trivially_serializable<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>( true );
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_trivially_serializable )
+{
+  test_trivially_serializable<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>( false );
+}
+
+BOOST_AUTO_TEST_CASE( xml_trivially_serializable )
+{
+  test_trivially_serializable<cereal::XMLInputArchive, cereal::XMLOutputArchive>( false );
+}
+
+BOOST_AUTO_TEST_CASE( json_trivially_serializable )
+{
+  test_trivially_serializable<cereal::JSONInputArchive, cereal::JSONOutputArchive>( false );
+}
+
+enum class TrivialSide : std::uint16_t { buy = 1, sell = 0x0102 };
+
+static_assert( cereal::traits::is_trivially_serializable<TrivialSide>::value, "enums are trivially serializable" );
+static_assert( cereal::traits::is_trivially_serializable<std::complex<double>>::value, "complex numbers are trivially serializable" );
+
+template <class IArchive, class OArchive, class ... Options>
+void test_trivially_serializable_builtin( bool compareBytes, Options ... options )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<TrivialSide> o_sides( 100 );
+  for( auto & s : o_sides )
+    s = gen() % 2 ? TrivialSide::buy : TrivialSide::sell;
+  std::vector<std::complex<double>> o_samples( 100 );
+  for( auto & c : o_samples )
+    c = { random_value<std::int16_t>(gen) / 4.0, random_value<std::int16_t>(gen) / 4.0 };
+  std::array<TrivialSide, 3> o_array = {{ TrivialSide::sell, TrivialSide::buy, TrivialSide::sell }};
+  std::valarray<std::complex<float>> o_valarray( std::complex<float>( 1.5f, -2.0f ), 10 );
+  std::deque<std::complex<double>> o_deque( o_samples.begin(), o_samples.end() );
+  for( int i = 0; i < 1000; ++i )
+    o_deque.emplace_front( i, -i ); // spans several blocks
+
+  std::ostringstream os;
+  {
+    OArchive oar( os, options... );
+    oar( o_sides, o_samples, o_array, o_valarray, o_deque );
+  }
+
+  std::vector<TrivialSide> i_sides;
+  std::vector<std::complex<double>> i_samples;
+  std::array<TrivialSide, 3> i_array;
+  std::valarray<std::complex<float>> i_valarray;
+  std::deque<std::complex<double>> i_deque;
+  {
+    std::istringstream is( os.str() );
+    IArchive iar( is );
+    iar( i_sides, i_samples, i_array, i_valarray, i_deque );
+  }
+
+  BOOST_CHECK( i_sides == o_sides );
+  BOOST_CHECK( i_samples == o_samples );
+  BOOST_CHECK( i_array == o_array );
+  BOOST_CHECK_EQUAL_COLLECTIONS( std::begin(i_valarray), std::end(i_valarray), std::begin(o_valarray), std::end(o_valarray) );
+  BOOST_CHECK( i_deque == o_deque );
+
+  if( !compareBytes )
+    return;
+
+  // the bulk copy writes the same bytes as the elements would one at a time
+  std::ostringstream each;
+  {
+    OArchive oar( each, options... );
+    oar( cereal::make_size_tag( static_cast<cereal::size_type>( o_sides.size() ) ) );
+    for( auto s : o_sides )
+      oar( s );
+    oar( cereal::make_size_tag( static_cast<cereal::size_type>( o_samples.size() ) ) );
+    for( auto const & c : o_samples )
+      oar( c );
+  }
+  BOOST_CHECK( os.str().compare( 0, each.str().size(), each.str() ) == 0 );
+}
+
+BOOST_AUTO_TEST_CASE( binary_trivially_serializable_builtin )
+{
+  test_trivially_serializable_builtin<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>( true );
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_trivially_serializable_builtin )
+{
+  test_trivially_serializable_builtin<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>(
+      true, cereal::PortableBinaryOutputArchive::Options::LittleEndian() );
+  test_trivially_serializable_builtin<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>(
+      true, cereal::PortableBinaryOutputArchive::Options::BigEndian() );
+}
+
+BOOST_AUTO_TEST_CASE( text_trivially_serializable_builtin )
+{
+  test_trivially_serializable_builtin<cereal::XMLInputArchive, cereal::XMLOutputArchive>( false );
+  test_trivially_serializable_builtin<cereal::JSONInputArchive, cereal::JSONOutputArchive>( false );
+}
@@ -155,3 +155,60 @@ BOOST_AUTO_TEST_CASE( json_unordered_loads )
   test_unordered_loads<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
 }
 
+
+template <class IArchive, class OArchive>
+void test_unordered_loads_wide()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // wide enough that members are found through a name index
+  std::vector<std::string> names;
+  std::vector<int> o_values;
+  for(int j=0; j<200; ++j)
+  {
+    names.push_back( "field" + std::to_string( j ) );
+    o_values.push_back( random_value<int>( gen ) );
+  }
+  names.push_back( "field0" );
+  o_values.push_back( random_value<int>( gen ) );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    for(size_t j=0; j<names.size(); ++j)
+      oar( cereal::make_nvp( names[j], o_values[j] ) );
+  }
+
+  std::vector<int> i_values( o_values.size() );
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+
+    // reverse order, resuming sequential loads after a found member
+    for(size_t j=names.size() - 1; j > 100; --j)
+      iar( cereal::make_nvp( names[j], i_values[j] ) );
+    iar( cereal::make_nvp( names[10], i_values[10] ), i_values[11] );
+
+    int missing;
+    BOOST_CHECK_THROW( iar( cereal::make_nvp( "missing", missing ) ), cereal::Exception );
+  }
+
+  // a repeated name resolves to its first occurrence
+  BOOST_CHECK_EQUAL( o_values.front(), i_values.back() );
+  for(size_t j=101; j < names.size() - 1; ++j)
+    BOOST_CHECK_EQUAL( o_values[j], i_values[j] );
+  BOOST_CHECK_EQUAL( o_values[10], i_values[10] );
+  BOOST_CHECK_EQUAL( o_values[11], i_values[11] );
+}
+
+BOOST_AUTO_TEST_CASE( xml_unordered_loads_wide )
+{
+  test_unordered_loads_wide<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_unordered_loads_wide )
+{
+  test_unordered_loads_wide<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
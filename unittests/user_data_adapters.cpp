@@ -135,3 +135,71 @@ BOOST_AUTO_TEST_CASE( json_user_data_adapters )
   test_user_data_adapters<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
 }
 
+
+struct LoadContext
+{
+  int offset;
+  int constructed;
+};
+
+struct ContextStruct
+{
+  ContextStruct( int xx ) : x( xx ) {}
+  int x;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    ar( x );
+  }
+
+  template <class Archive>
+  static void load_and_construct( Archive & ar, cereal::construct<ContextStruct> & construct )
+  {
+    int xx;
+    ar( xx );
+    auto * context = ar.template getUserData<LoadContext>();
+    ++context->constructed;
+    construct( xx + context->offset );
+  }
+};
+
+BOOST_AUTO_TEST_CASE( archive_user_data )
+{
+  std::vector<std::unique_ptr<ContextStruct>> o_ptrs;
+  for( int i = 0; i < 10; ++i )
+    o_ptrs.emplace_back( new ContextStruct( i ) );
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( o_ptrs );
+  }
+
+  LoadContext context = { 100, 0 };
+  SomeStruct ss;
+  UserData ud( &ss, ss );
+
+  std::vector<std::unique_ptr<ContextStruct>> i_ptrs;
+  std::istringstream is(os.str());
+  {
+    cereal::BinaryInputArchive iar(is);
+    BOOST_CHECK( iar.getUserData<LoadContext>() == nullptr );
+
+    // several types of data can be attached side by side
+    iar.setUserData( &context );
+    iar.setUserData( &ud );
+    BOOST_CHECK( iar.getUserData<LoadContext const>() == &context );
+    BOOST_CHECK( &cereal::get_user_data<UserData>( iar ) == &ud );
+
+    iar( i_ptrs );
+
+    iar.setUserData<UserData>( nullptr );
+    BOOST_CHECK_THROW( cereal::get_user_data<UserData>( iar ), cereal::Exception );
+  }
+
+  BOOST_CHECK_EQUAL( context.constructed, 10 );
+  BOOST_REQUIRE_EQUAL( i_ptrs.size(), o_ptrs.size() );
+  for( std::size_t i = 0; i < o_ptrs.size(); ++i )
+    BOOST_CHECK_EQUAL( i_ptrs[i]->x, o_ptrs[i]->x + 100 );
+}
@@ -127,3 +127,135 @@ BOOST_AUTO_TEST_CASE( json_vector )
 }
 
 
+
+BOOST_AUTO_TEST_CASE( binary_vector_bool_packed )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( std::size_t size : {0, 1, 63, 64, 65, 1000} )
+  {
+    std::vector<bool> o_boolvector( size );
+    for( std::size_t i = 0; i < size; ++i )
+      o_boolvector[i] = (random_value<int>(gen) % 2) == 0;
+
+    std::ostringstream os;
+    {
+      cereal::BinaryOutputArchive oar(os);
+      oar( cereal::packed_bits( o_boolvector ) );
+    }
+
+    // size tag followed by whole 64 bit words
+    BOOST_CHECK_EQUAL( os.str().size(), sizeof(cereal::size_type) + ( size + 63 ) / 64 * sizeof(std::uint64_t) );
+
+    std::vector<bool> i_boolvector;
+    std::istringstream is(os.str());
+    {
+      cereal::BinaryInputArchive iar(is);
+      iar( cereal::packed_bits( i_boolvector ) );
+    }
+
+    BOOST_CHECK( i_boolvector == o_boolvector );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_vector_bool_unpacked )
+{
+  // a bool vector is saved as its size followed by one byte per element unless it is wrapped
+  std::string data( sizeof(cereal::size_type) + 5, '\0' );
+  cereal::size_type const size = 5;
+  std::memcpy( &data[0], &size, sizeof(size) );
+  data[sizeof(size) + 0] = 1;
+  data[sizeof(size) + 3] = 1;
+  data[sizeof(size) + 4] = 1;
+
+  std::vector<bool> i_boolvector;
+  {
+    std::istringstream is(data);
+    cereal::BinaryInputArchive iar(is);
+    iar(i_boolvector);
+  }
+  BOOST_CHECK( i_boolvector == std::vector<bool>( { true, false, false, true, true } ) );
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar(i_boolvector);
+  }
+  BOOST_CHECK( os.str() == data );
+}
+
+BOOST_AUTO_TEST_CASE( json_vector_bool_packed )
+{
+  // archives without binary data save the wrapped vector as usual
+  std::vector<bool> const o_boolvector = { true, false, true };
+
+  std::ostringstream packed, plain;
+  {
+    cereal::JSONOutputArchive oar(packed);
+    oar( cereal::packed_bits( o_boolvector ) );
+  }
+  {
+    cereal::JSONOutputArchive oar(plain);
+    oar( o_boolvector );
+  }
+  BOOST_CHECK_EQUAL( packed.str(), plain.str() );
+
+  std::vector<bool> i_boolvector;
+  {
+    std::istringstream is(packed.str());
+    cereal::JSONInputArchive iar(is);
+    iar( cereal::packed_bits( i_boolvector ) );
+  }
+  BOOST_CHECK( i_boolvector == o_boolvector );
+}
+
+template <class IArchive, class OArchive>
+void test_vector_default_init()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<double, cereal::default_init_allocator<double>> o_doubles( 1000 );
+  for( auto & d : o_doubles )
+    d = random_value<std::int16_t>(gen) / 4.0;
+  std::vector<std::string, cereal::default_init_allocator<std::string>> o_strings( 10, "default" );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_doubles, o_strings );
+  }
+
+  // loads over existing contents as well as into empty vectors
+  std::vector<double, cereal::default_init_allocator<double>> i_doubles( 10, 1.0 );
+  std::vector<std::string, cereal::default_init_allocator<std::string>> i_strings;
+  {
+    std::istringstream is(os.str());
+    IArchive iar(is);
+    iar( i_doubles, i_strings );
+  }
+
+  BOOST_CHECK( i_doubles == o_doubles );
+  BOOST_CHECK( i_strings == o_strings );
+}
+
+BOOST_AUTO_TEST_CASE( binary_vector_default_init )
+{
+  test_vector_default_init<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_vector_default_init )
+{
+  test_vector_default_init<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_vector_default_init )
+{
+  test_vector_default_init<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_vector_default_init )
+{
+  test_vector_default_init<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
@@ -203,3 +203,36 @@ BOOST_AUTO_TEST_CASE( json_versioning )
   test_versioning<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
 }
 
+
+BOOST_AUTO_TEST_CASE( versioning_emitted_once_per_archive )
+{
+  std::vector<VersionStructMSP> o_data( 1000 );
+  for( std::size_t i = 0; i < o_data.size(); ++i )
+    o_data[i].x = static_cast<uint8_t>( i );
+
+  for( int ii = 0; ii < 2; ++ii )
+  {
+    std::ostringstream os;
+    {
+      cereal::BinaryOutputArchive oar(os);
+      oar( o_data );
+    }
+
+    // size tag, one version number, and the elements
+    BOOST_CHECK_EQUAL( os.str().size(), sizeof(cereal::size_type) + sizeof(std::uint32_t) + o_data.size() );
+
+    std::vector<VersionStructMSP> i_data;
+    std::istringstream is(os.str());
+    {
+      cereal::BinaryInputArchive iar(is);
+      iar( i_data );
+    }
+
+    BOOST_REQUIRE_EQUAL( i_data.size(), o_data.size() );
+    for( std::size_t i = 0; i < o_data.size(); ++i )
+    {
+      BOOST_CHECK_EQUAL( i_data[i].x, o_data[i].x );
+      BOOST_CHECK_EQUAL( i_data[i].v, 33u );
+    }
+  }
+}
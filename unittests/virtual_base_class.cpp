@@ -0,0 +1,149 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct VirtualBase
+{
+  VirtualBase() : x(0) {}
+  VirtualBase( int xx ) : x(xx) {}
+  int x;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+};
+
+struct VirtualLeft : virtual VirtualBase
+{
+  VirtualLeft() : y(0) {}
+  int y;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::virtual_base_class<VirtualBase>( this ), y ); }
+};
+
+struct VirtualRight : virtual VirtualBase
+{
+  VirtualRight() : z(0) {}
+  int z;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::virtual_base_class<VirtualBase>( this ), z ); }
+};
+
+struct VirtualDiamond : VirtualLeft, VirtualRight
+{
+  VirtualDiamond() : w(0) {}
+  VirtualDiamond( int i ) : VirtualBase( i ) { y = i + 1; z = i + 2; w = i + 3; }
+  int w;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::base_class<VirtualLeft>( this ), cereal::base_class<VirtualRight>( this ), w ); }
+};
+
+//! Holds diamonds, whose virtual bases are tracked separately from those of the holder
+struct VirtualHolder : virtual VirtualBase
+{
+  std::vector<VirtualDiamond> diamonds;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::virtual_base_class<VirtualBase>( this ), diamonds, cereal::virtual_base_class<VirtualBase>( this ) ); }
+};
+
+template <class IArchive, class OArchive>
+void test_virtual_base_class()
+{
+  VirtualHolder o_holder;
+  o_holder.x = -1;
+  for( int i = 0; i < 100; ++i )
+    o_holder.diamonds.emplace_back( i * 4 );
+  VirtualDiamond o_single( 7 );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    // saving the same object again at the top level saves its virtual base again
+    oar( o_holder, o_single, o_single );
+  }
+
+  VirtualHolder i_holder;
+  VirtualDiamond i_single, i_again;
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( i_holder, i_single, i_again );
+  }
+
+  BOOST_CHECK_EQUAL( i_holder.x, -1 );
+  BOOST_REQUIRE_EQUAL( i_holder.diamonds.size(), o_holder.diamonds.size() );
+  for( std::size_t i = 0; i < o_holder.diamonds.size(); ++i )
+  {
+    BOOST_CHECK_EQUAL( i_holder.diamonds[i].x, o_holder.diamonds[i].x );
+    BOOST_CHECK_EQUAL( i_holder.diamonds[i].y, o_holder.diamonds[i].y );
+    BOOST_CHECK_EQUAL( i_holder.diamonds[i].z, o_holder.diamonds[i].z );
+    BOOST_CHECK_EQUAL( i_holder.diamonds[i].w, o_holder.diamonds[i].w );
+  }
+
+  for( auto const & d : { i_single, i_again } )
+  {
+    BOOST_CHECK_EQUAL( d.x, 7 );
+    BOOST_CHECK_EQUAL( d.w, 10 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_virtual_base_class )
+{
+  test_virtual_base_class<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+
+  // each diamond saves its virtual base once
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( VirtualDiamond( 1 ) );
+  }
+  BOOST_CHECK_EQUAL( os.str().size(), 4 * sizeof(int) );
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_virtual_base_class )
+{
+  test_virtual_base_class<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_virtual_base_class )
+{
+  test_virtual_base_class<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_virtual_base_class )
+{
+  test_virtual_base_class<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
@@ -0,0 +1,218 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct XMLStreamingData
+{
+  std::vector<StructInternalSerialize> structs;
+  std::map<std::string, std::vector<int>> map;
+  std::vector<std::string> strings;
+  std::vector<int> empty;
+  std::shared_ptr<int> pointer;
+  std::array<uint8_t, 4> raw;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    ar( CEREAL_NVP(structs), CEREAL_NVP(map), CEREAL_NVP(strings), CEREAL_NVP(empty), CEREAL_NVP(pointer) );
+    ar.saveBinaryValue( raw.data(), raw.size(), "raw" );
+  }
+
+  template <class Archive>
+  void load( Archive & ar )
+  {
+    ar( CEREAL_NVP(structs), CEREAL_NVP(map), CEREAL_NVP(strings), CEREAL_NVP(empty), CEREAL_NVP(pointer) );
+    ar.loadBinaryValue( raw.data(), raw.size(), "raw" );
+  }
+};
+
+template <class... Args>
+std::string save_xml( XMLStreamingData const & data, Args... args )
+{
+  std::ostringstream os;
+  {
+    cereal::XMLOutputArchive oar( os, cereal::XMLOutputArchive::Options( args... ) );
+    oar( data, cereal::make_nvp( "number", 3.5 ), std::string() );
+  }
+  return os.str();
+}
+
+BOOST_AUTO_TEST_CASE( xml_streaming_matches_document )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  XMLStreamingData data;
+  for( int i = 0; i < 100; ++i )
+    data.structs.emplace_back( random_value<int>(gen), random_value<int>(gen) );
+  data.map["a"] = { 1, 2, 3 };
+  data.map["b"] = {};
+  data.strings = { "plain", " padded ", "<tag attr=\"x\" other='y'> & more", "", random_basic_string<char>(gen) };
+  data.pointer = std::make_shared<int>( 7 );
+  data.raw = {{ 1, 2, 3, 4 }};
+
+  int const precision = std::numeric_limits<double>::max_digits10;
+  for( bool indent : { true, false } )
+    for( bool outputType : { false, true } )
+    {
+      auto const document = save_xml( data, precision, indent, outputType, false );
+      auto const streamed = save_xml( data, precision, indent, outputType, true );
+      BOOST_CHECK_EQUAL( document, streamed );
+    }
+
+  auto const streamed = save_xml( data, precision, true, false, true );
+
+  XMLStreamingData loaded;
+  double number;
+  std::string last;
+  std::istringstream is( streamed );
+  {
+    cereal::XMLInputArchive iar( is );
+    iar( loaded, number, last );
+  }
+
+  BOOST_CHECK_EQUAL_COLLECTIONS( data.structs.begin(), data.structs.end(), loaded.structs.begin(), loaded.structs.end() );
+  BOOST_CHECK( data.map == loaded.map );
+  BOOST_CHECK_EQUAL_COLLECTIONS( data.strings.begin(), data.strings.end(), loaded.strings.begin(), loaded.strings.end() );
+  BOOST_CHECK( loaded.empty.empty() );
+  BOOST_CHECK_EQUAL( *loaded.pointer, 7 );
+  BOOST_CHECK( data.raw == loaded.raw );
+  BOOST_CHECK_EQUAL( number, 3.5 );
+  BOOST_CHECK( last.empty() );
+}
+
+BOOST_AUTO_TEST_CASE( xml_streaming_writes_incrementally )
+{
+  std::ostringstream os;
+  {
+    cereal::XMLOutputArchive oar( os, cereal::XMLOutputArchive::Options::Streaming() );
+
+    // far more than the internal buffer, most of which must have been written already
+    std::vector<int> values( 10000, 42 );
+    oar( values );
+    BOOST_CHECK( os.str().size() > 100000 );
+  }
+
+  std::vector<int> values;
+  std::istringstream is( os.str() );
+  {
+    cereal::XMLInputArchive iar( is );
+    iar( values );
+  }
+
+  BOOST_CHECK_EQUAL( values.size(), 10000u );
+}
+
+BOOST_AUTO_TEST_CASE( xml_input_sources )
+{
+  std::vector<int> const o_values = { 1, 2, 3 };
+
+  std::stringstream ss;
+  ss << "ignored";
+  {
+    cereal::XMLOutputArchive oar( ss );
+    oar( o_values );
+  }
+  auto const xml = ss.str().substr( 7 );
+
+  // a stream read from its current position
+  {
+    ss.seekg( 7 );
+    std::vector<int> i_values;
+    cereal::XMLInputArchive iar( ss );
+    iar( i_values );
+    BOOST_CHECK( o_values == i_values );
+  }
+
+  // an owned buffer, with and without a terminator
+  for( bool terminate : { false, true } )
+  {
+    std::vector<char> data( xml.begin(), xml.end() );
+    if( terminate )
+      data.push_back( '\0' );
+
+    std::vector<int> i_values;
+    cereal::XMLInputArchive iar( std::move( data ) );
+    iar( i_values );
+    BOOST_CHECK( o_values == i_values );
+  }
+
+  // a caller provided buffer
+  {
+    std::vector<char> data( xml.begin(), xml.end() );
+    data.push_back( '\0' );
+
+    std::vector<int> i_values;
+    cereal::XMLInputArchive iar( data.data() );
+    iar( i_values );
+    BOOST_CHECK( o_values == i_values );
+  }
+
+  // an unseekable stream larger than one read block
+  {
+    std::ostringstream os;
+    std::vector<int> large( 100000, 5 );
+    {
+      cereal::XMLOutputArchive oar( os );
+      oar( large );
+    }
+
+    struct unseekable : std::stringbuf
+    {
+      unseekable( std::string const & s ) : std::stringbuf( s ) {}
+      pos_type seekoff( off_type, std::ios_base::seekdir, std::ios_base::openmode ) override { return pos_type( off_type( -1 ) ); }
+    } buffer( os.str() );
+    std::istream is( &buffer );
+
+    std::vector<int> i_values;
+    cereal::XMLInputArchive iar( is );
+    iar( i_values );
+    BOOST_CHECK( large == i_values );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( xml_output_type )
+{
+  BOOST_CHECK_EQUAL( &cereal::util::cachedDemangledName<int>(), &cereal::util::cachedDemangledName<int>() );
+  BOOST_CHECK_EQUAL( cereal::util::cachedDemangledName<int>(), cereal::util::demangledName<int>() );
+
+  for( bool streaming : { false, true } )
+  {
+    std::ostringstream os;
+    {
+      cereal::XMLOutputArchive oar( os, cereal::XMLOutputArchive::Options( 17, true, true, streaming ) );
+      oar( 1, 2, StructInternalSerialize( 3, 4 ) );
+    }
+
+    auto const xml = os.str();
+    auto const intType = "type=\"" + cereal::util::demangledName<int>() + "\"";
+    auto const structType = "type=\"" + cereal::util::demangledName<StructInternalSerialize>() + "\"";
+    BOOST_CHECK( xml.find( "<value1 " + intType + ">2</value1>" ) != std::string::npos );
+    BOOST_CHECK( xml.find( "<value2 " + structType + ">" ) != std::string::npos );
+  }
+}
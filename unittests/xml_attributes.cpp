@@ -0,0 +1,146 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct AttributeLeg
+{
+  std::int32_t id = 0;
+  double price = 0;
+  bool open = false;
+  std::uint8_t flags = 0;
+  std::string venue;
+  std::vector<int> fills;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(id), CEREAL_NVP(price), CEREAL_NVP(open), CEREAL_NVP(flags), CEREAL_NVP(venue), CEREAL_NVP(fills) ); }
+
+  bool operator==( AttributeLeg const & other ) const
+  {
+    return id == other.id && price == other.price && open == other.open &&
+           flags == other.flags && venue == other.venue && fills == other.fills;
+  }
+};
+
+struct AttributeOrder
+{
+  std::uint64_t number = 0;
+  std::vector<AttributeLeg> legs;
+  // saved after a child element, so it cannot be an attribute
+  float late = 0;
+  // the names of attributes cereal writes itself are kept as elements
+  int size = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(number), CEREAL_NVP(legs), CEREAL_NVP(late), CEREAL_NVP(size) ); }
+
+  bool operator==( AttributeOrder const & other ) const
+  { return number == other.number && legs == other.legs && late == other.late && size == other.size; }
+};
+
+static AttributeOrder makeAttributeOrder()
+{
+  AttributeOrder order;
+  order.number = 1234567890123ull;
+  order.late = 0.25f;
+  order.size = 3;
+  for( int i = 0; i < 3; ++i )
+  {
+    AttributeLeg leg;
+    leg.id = -i;
+    leg.price = 100.5 + i;
+    leg.open = i % 2 == 0;
+    leg.flags = static_cast<std::uint8_t>( 200 + i );
+    leg.venue = " spaced ";
+    leg.fills = { i, i + 1 };
+    order.legs.push_back( leg );
+  }
+  return order;
+}
+
+static std::string saveAttributeOrder( cereal::XMLOutputArchive::Options const & options, int scalar )
+{
+  std::ostringstream os;
+  {
+    cereal::XMLOutputArchive oar( os, options );
+    oar( cereal::make_nvp( "scalar", scalar ), cereal::make_nvp( "order", makeAttributeOrder() ), scalar );
+  }
+  return os.str();
+}
+
+BOOST_AUTO_TEST_CASE( xml_scalar_attributes )
+{
+  auto const plain = saveAttributeOrder( cereal::XMLOutputArchive::Options(), 7 );
+  auto const compact = saveAttributeOrder( cereal::XMLOutputArchive::Options::ScalarAttributes(), 7 );
+
+  BOOST_CHECK_LT( compact.size(), plain.size() );
+  BOOST_CHECK( compact.find( "price=\"100.5\"" ) != std::string::npos );
+  BOOST_CHECK( compact.find( "<cereal scalar=\"7\">" ) != std::string::npos );
+  BOOST_CHECK( compact.find( "<venue xml:space=\"preserve\"> spaced </venue>" ) != std::string::npos );
+  BOOST_CHECK( compact.find( "<late>" ) != std::string::npos );
+  BOOST_CHECK( compact.find( "<size>3</size>" ) != std::string::npos );
+
+  // streaming writes exactly the same document
+  auto options = cereal::XMLOutputArchive::Options( std::numeric_limits<double>::max_digits10, true, false, true, true );
+  BOOST_CHECK_EQUAL( saveAttributeOrder( options, 7 ), compact );
+
+  for( auto const & xml : { plain, compact } )
+  {
+    AttributeOrder order;
+    int named = 0, unnamed = 0;
+    std::istringstream is( xml );
+    cereal::XMLInputArchive iar( is );
+    iar( cereal::make_nvp( "scalar", named ), cereal::make_nvp( "order", order ), unnamed );
+
+    BOOST_CHECK( order == makeAttributeOrder() );
+    BOOST_CHECK_EQUAL( named, 7 );
+    BOOST_CHECK_EQUAL( unnamed, 7 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( xml_scalar_attributes_out_of_order )
+{
+  std::ostringstream os;
+  {
+    cereal::XMLOutputArchive oar( os, cereal::XMLOutputArchive::Options::ScalarAttributes() );
+    oar( cereal::make_nvp( "a", 1 ), cereal::make_nvp( "b", 2.5 ), cereal::make_nvp( "c", true ) );
+  }
+
+  int a = 0;
+  double b = 0;
+  bool c = false;
+  std::istringstream is( os.str() );
+  cereal::XMLInputArchive iar( is );
+  iar( cereal::make_nvp( "c", c ), cereal::make_nvp( "b", b ), cereal::make_nvp( "a", a ) );
+
+  BOOST_CHECK_EQUAL( a, 1 );
+  BOOST_CHECK_EQUAL( b, 2.5 );
+  BOOST_CHECK( c );
+  BOOST_CHECK_THROW( iar( cereal::make_nvp( "d", a ) ), cereal::Exception );
+}